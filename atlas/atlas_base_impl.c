@@ -23,3 +23,143 @@
 
 #include "atlas_base_impl.h"
 
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include <dispatch/dispatch.h>
+
+// number of ranges per worker if the grain size is adaptive
+#define ATLAS_RANGES_PER_WORKER 4
+
+// minimal number of indexes in a range if the grain size is adaptive
+#define ATLAS_MIN_GRAIN_SIZE 64
+
+#pragma mark -
+#pragma mark Concurrency
+
+size_t
+atlas_num_cpus(void) {
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return num_cpus > 0 ? num_cpus : 1;
+}
+
+void
+atlas_apply_chunked(size_t count,
+                    size_t grain_size,
+                    void *(^init)(void),
+                    void(^block)(void * state, size_t begin, size_t end),
+                    void(^finish)(void * state)) {
+    assert(block != 0);
+    
+    if (count == 0) {
+        return;
+    }
+    
+    size_t num_cpus = atlas_num_cpus();
+    
+    // choose a grain size which results in a few ranges per worker
+    // to balance the load, but avoid too small ranges
+    if (grain_size == 0) {
+        grain_size = count / (num_cpus * ATLAS_RANGES_PER_WORKER);
+        if (grain_size < ATLAS_MIN_GRAIN_SIZE) {
+            grain_size = ATLAS_MIN_GRAIN_SIZE;
+        }
+    }
+    
+    size_t num_ranges = (count + grain_size - 1) / grain_size;
+    size_t num_workers = num_ranges < num_cpus ? num_ranges : num_cpus;
+    
+    void ** states = malloc(sizeof(void *) * num_workers);
+    assert(states != 0);
+    
+    // the next range which has not been taken by a worker
+    __block size_t next_range = 0;
+    
+    void(^worker)(size_t w) = ^(size_t w){
+        void * state = init ? init() : 0;
+        size_t range;
+        while ((range = __sync_fetch_and_add(&next_range, 1)) < num_ranges) {
+            size_t begin = range * grain_size;
+            size_t end = count - begin > grain_size ? begin + grain_size : count;
+            block(state, begin, end);
+        }
+        states[w] = state;
+    };
+    
+    // avoid the dispatch overhead, if there is only one worker
+    if (num_workers == 1) {
+        worker(0);
+    } else {
+        dispatch_apply(num_workers, dispatch_get_global_queue(0, 0), worker);
+    }
+    
+    // merge the states of all workers sequentially
+    if (finish) {
+        for (size_t w=0; w<num_workers; w++) {
+            finish(states[w]);
+        }
+    }
+    
+    free(states);
+}
+
+void *
+atlas_reduce_chunked(size_t count,
+                     size_t grain_size,
+                     void *(^init)(void),
+                     void *(^block)(void * acc, size_t begin, size_t end),
+                     void *(^combine)(void * acc1, void * acc2)) {
+    assert(init != 0);
+    assert(block != 0);
+    assert(combine != 0);
+    
+    if (count == 0) {
+        return init();
+    }
+    
+    // accumulators of the workers
+    __block size_t num_accs = 0;
+    __block void ** accs = 0;
+    
+    // the state of a worker holds its accumulator, because
+    // the block returns a new accumulator for each range
+    atlas_apply_chunked(count, grain_size, ^{
+        void ** state = malloc(sizeof(void *));
+        assert(state != 0);
+        *state = init();
+        return (void *)state;
+    }, ^(void * state, size_t begin, size_t end){
+        void ** acc = state;
+        *acc = block(*acc, begin, end);
+    }, ^(void * state){
+        void ** acc = state;
+        accs = realloc(accs, sizeof(void *) * (num_accs + 1));
+        assert(accs != 0);
+        accs[num_accs++] = *acc;
+        free(acc);
+    });
+    
+    // merge the accumulators pairwise until one is left
+    void ** merged = malloc(sizeof(void *) * num_accs);
+    assert(merged != 0);
+    while (num_accs > 1) {
+        size_t num_pairs = num_accs / 2;
+        void ** level = accs;
+        void ** next = merged;
+        dispatch_apply(num_pairs, dispatch_get_global_queue(0, 0), ^(size_t i){
+            next[i] = combine(level[2 * i], level[2 * i + 1]);
+        });
+        if (num_accs % 2 == 1) {
+            merged[num_pairs] = accs[num_accs - 1];
+        }
+        num_accs = num_pairs + num_accs % 2;
+        merged = accs;
+        accs = next;
+    }
+    
+    void * result = accs[0];
+    free(accs);
+    free(merged);
+    return result;
+}
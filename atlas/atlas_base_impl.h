@@ -24,5 +24,52 @@
 #ifndef _ATLAS_BASE_IMPL_H_
 #define _ATLAS_BASE_IMPL_H_
 
+#include <stddef.h>
+
+#pragma mark -
+#pragma mark Concurrency
+
+/*! Number of CPUs available.
+ */
+size_t
+atlas_num_cpus(void);
+
+/*! Apply a block to contiguous ranges of the indexes [0, count).
+ *
+ *  The indexes are split into ranges of grain_size indexes (or of an
+ *  adaptive size, if grain_size is 0). The ranges are processed
+ *  concurrently by up to one worker per CPU, each worker takes the
+ *  next unprocessed range until all ranges have been processed.
+ *
+ *  Each worker creates its own state by calling init (if not NULL)
+ *  and passes it to the block for every range it processes. After
+ *  all ranges have been processed, finish (if not NULL) is called
+ *  sequentially with the state of each worker. Therefore a state
+ *  can be updated and merged without locks.
+ */
+void
+atlas_apply_chunked(size_t count,
+                    size_t grain_size,
+                    void *(^init)(void),
+                    void(^block)(void * state, size_t begin, size_t end),
+                    void(^finish)(void * state));
+
+/*! Reduce contiguous ranges of the indexes [0, count) in parallel.
+ *
+ *  Each worker creates a private accumulator with init and passes it
+ *  to the block for every range it processes. The block returns the
+ *  updated accumulator. Afterwards the accumulators of all workers are
+ *  merged pairwise (tree-style, concurrent on each level) with combine,
+ *  which must be associative and commutative.
+ *
+ *  \return The merged accumulator or the result of init,
+ *          if count is 0.
+ */
+void *
+atlas_reduce_chunked(size_t count,
+                     size_t grain_size,
+                     void *(^init)(void),
+                     void *(^block)(void * acc, size_t begin, size_t end),
+                     void *(^combine)(void * acc1, void * acc2));
 
 #endif // _ATLAS_BASE_IMPL_H_
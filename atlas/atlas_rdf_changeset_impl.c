@@ -0,0 +1,271 @@
+/*
+ *  atlas_rdf_changeset_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_changeset_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_graph_builder_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <dispatch/dispatch.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// maximum number of statements in a chunk created for a new version
+#define ATLAS_RDF_CHANGESET_CHUNK_SIZE 4096
+
+// shared parts with fewer statements are repacked with the new
+// statements, which keeps the number of parts bounded
+#define ATLAS_RDF_CHANGESET_MIN_FILL (ATLAS_RDF_CHANGESET_CHUNK_SIZE / 4)
+
+// the references of a changeset are the added and the removed graph
+typedef struct {
+    uint32_t num_added;
+    uint32_t num_removed;
+} __changeset;
+
+#pragma mark -
+#pragma mark Create a RDF Changeset
+
+atlas_rdf_changeset_t
+atlas_rdf_changeset_create(atlas_rdf_graph_t added,
+                           atlas_rdf_graph_t removed,
+                           atlas_error_handler err) {
+    assert(added != 0);
+    assert(removed != 0);
+    
+    int size = sizeof(__changeset);
+    __changeset * changeset = malloc(size);
+    assert(changeset != 0);
+    
+    changeset->num_added = atlas_rdf_graph_length(added);
+    changeset->num_removed = atlas_rdf_graph_length(removed);
+    
+    // create a lazy object
+    return lz_obj_new(changeset, size, ^{
+        free(changeset);
+    }, 2, added, removed);
+}
+
+#pragma mark -
+#pragma mark Access Details of a RDF Changeset
+
+atlas_rdf_graph_t
+atlas_rdf_changeset_added(atlas_rdf_changeset_t changeset) {
+    assert(changeset != 0);
+    return lz_obj_weak_ref(changeset, 0);
+}
+
+atlas_rdf_graph_t
+atlas_rdf_changeset_removed(atlas_rdf_changeset_t changeset) {
+    assert(changeset != 0);
+    return lz_obj_weak_ref(changeset, 1);
+}
+
+#pragma mark -
+#pragma mark Create a new Version of a RDF Graph
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_version(atlas_rdf_graph_t graph,
+                               atlas_rdf_changeset_t changeset,
+                               atlas_error_handler err) {
+    assert(graph != 0);
+    assert(changeset != 0);
+    
+    atlas_rdf_graph_t added = atlas_rdf_changeset_added(changeset);
+    atlas_rdf_graph_t removed = atlas_rdf_changeset_removed(changeset);
+    
+    int num_added = atlas_rdf_graph_length(added);
+    int num_removed = atlas_rdf_graph_length(removed);
+    
+    // an empty changeset does not change the graph
+    if (num_added == 0 && num_removed == 0) {
+        return lz_retain(graph);
+    }
+    
+    // setup hash tables with the statements of the changeset, the
+    // position of a statement in the table is its position in the graph
+    atlas_rdf_graph_builder_t removed_stms = atlas_rdf_graph_builder_create(num_removed);
+    atlas_rdf_graph_builder_t added_stms = atlas_rdf_graph_builder_create(num_added);
+    atlas_rdf_graph_builder_add_graph(removed_stms, removed, 0, 0);
+    atlas_rdf_graph_builder_add_graph(added_stms, added, 0, 0);
+    
+    int num_parts = atlas_rdf_graph_num_parts(graph);
+    
+    // parts of the graph which are shared with the new version
+    char * shared = malloc(sizeof(char) * (num_parts + 1));
+    
+    // positions of the added statements found in each part
+    int * num_found = calloc(num_parts + 1, sizeof(int));
+    int ** found = calloc(num_parts + 1, sizeof(int *));
+    assert(shared != 0);
+    assert(num_found != 0);
+    assert(found != 0);
+    
+    // check the parts concurrently, only the parts using terms
+    // of the changeset have to be scanned
+    dispatch_apply(num_parts, dispatch_get_global_queue(0, 0), ^(size_t p){
+        atlas_rdf_graph_t part = atlas_rdf_graph_part(graph, p);
+        shared[p] = 1;
+        
+        int num_refs = lz_obj_num_ref(part);
+        int32_t * removed_ids = malloc(sizeof(int32_t) * (num_refs + 1));
+        int32_t * added_ids = malloc(sizeof(int32_t) * (num_refs + 1));
+        assert(removed_ids != 0);
+        assert(added_ids != 0);
+        
+        int uses_removed = 0;
+        int uses_added = 0;
+        for (int i=0; i<num_refs; i++) {
+            atlas_rdf_term_t term = lz_obj_weak_ref(part, i);
+            removed_ids[i] = num_removed ? atlas_rdf_graph_builder_term_id(removed_stms, term) : -1;
+            added_ids[i] = num_added ? atlas_rdf_graph_builder_term_id(added_stms, term) : -1;
+            uses_removed |= removed_ids[i] != -1;
+            uses_added |= added_ids[i] != -1;
+        }
+        
+        if (uses_removed || uses_added) {
+            atlas_rdf_graph_scan(part, 0, INT32_MAX, ^(atlas_rdf_graph_t pt,
+                                                       __graph * statements,
+                                                       int number_of_statements){
+                for (int i=0; i<number_of_statements && shared[p]; i++) {
+                    __graph stm = statements[i];
+                    if (uses_removed &&
+                        atlas_rdf_graph_builder_statement_id(removed_stms,
+                                                             removed_ids[stm.subject],
+                                                             removed_ids[stm.predicate],
+                                                             removed_ids[stm.object]) != -1) {
+                        // the part has to be rewritten
+                        shared[p] = 0;
+                    }
+                    if (uses_added) {
+                        int pos = atlas_rdf_graph_builder_statement_id(added_stms,
+                                                                       added_ids[stm.subject],
+                                                                       added_ids[stm.predicate],
+                                                                       added_ids[stm.object]);
+                        if (pos != -1) {
+                            found[p] = realloc(found[p], sizeof(int) * (num_found[p] + 1));
+                            assert(found[p] != 0);
+                            found[p][num_found[p]++] = pos;
+                        }
+                    }
+                }
+            });
+        }
+        
+        free(removed_ids);
+        free(added_ids);
+    });
+    
+    // small shared parts are repacked like the rewritten parts
+    for (int p=0; p<num_parts; p++) {
+        if (shared[p] && atlas_rdf_graph_length(atlas_rdf_graph_part(graph, p)) < ATLAS_RDF_CHANGESET_MIN_FILL) {
+            shared[p] = 0;
+        }
+    }
+    
+    // added statements, which are already in a shared part (the
+    // statements of a rewritten part are added to the new chunks anyway)
+    char * present = calloc(num_added + 1, sizeof(char));
+    assert(present != 0);
+    for (int p=0; p<num_parts; p++) {
+        for (int i=0; shared[p] && i<num_found[p]; i++) {
+            present[found[p][i]] = 1;
+        }
+        free(found[p]);
+    }
+    free(found);
+    free(num_found);
+    
+    // collect the remaining statements of the rewritten parts
+    // and the added statements for the new chunks
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(num_added);
+    
+    int num_chunks = 0;
+    atlas_rdf_graph_t * chunks = malloc(sizeof(atlas_rdf_graph_t) * (num_parts + 1));
+    assert(chunks != 0);
+    
+    for (int p=0; p<num_parts; p++) {
+        atlas_rdf_graph_t part = atlas_rdf_graph_part(graph, p);
+        if (shared[p]) {
+            chunks[num_chunks] = part;
+            num_chunks++;
+        } else {
+            atlas_rdf_graph_builder_add_graph(builder, part, removed_stms, 0);
+        }
+    }
+    
+    __block int position = 0;
+    atlas_rdf_graph_scan(added, 0, INT32_MAX, ^(atlas_rdf_graph_t part,
+                                                __graph * statements,
+                                                int number_of_statements){
+        for (int i=0; i<number_of_statements; i++, position++) {
+            if (!present[position]) {
+                atlas_rdf_graph_builder_add(builder,
+                                            lz_obj_weak_ref(part, statements[i].subject),
+                                            lz_obj_weak_ref(part, statements[i].predicate),
+                                            lz_obj_weak_ref(part, statements[i].object),
+                                            err);
+            }
+        }
+    });
+    
+    // create the new chunks
+    int num_shared = num_chunks;
+    int num_statements = atlas_rdf_graph_builder_length(builder);
+    int num_new = (num_statements + ATLAS_RDF_CHANGESET_CHUNK_SIZE - 1) / ATLAS_RDF_CHANGESET_CHUNK_SIZE;
+    chunks = realloc(chunks, sizeof(atlas_rdf_graph_t) * (num_chunks + num_new + 1));
+    assert(chunks != 0);
+    for (int begin = 0; begin < num_statements; begin += ATLAS_RDF_CHANGESET_CHUNK_SIZE) {
+        int end = begin + ATLAS_RDF_CHANGESET_CHUNK_SIZE;
+        if (end > num_statements) {
+            end = num_statements;
+        }
+        chunks[num_chunks] = atlas_rdf_graph_builder_commit_range(builder, begin, end);
+        num_chunks++;
+    }
+    
+    atlas_rdf_graph_t result;
+    if (num_chunks == 0) {
+        result = atlas_rdf_graph_create_flat(0, 0, 0, 0);
+    } else if (num_chunks == 1) {
+        result = lz_retain(chunks[0]);
+    } else {
+        result = atlas_rdf_graph_create_chunked(num_chunks, chunks);
+    }
+    
+    // release the new chunks, they are retained by the result
+    for (int i=num_shared; i<num_chunks; i++) {
+        lz_release(chunks[i]);
+    }
+    
+    free(chunks);
+    free(shared);
+    free(present);
+    atlas_rdf_graph_builder_free(builder);
+    atlas_rdf_graph_builder_free(added_stms);
+    atlas_rdf_graph_builder_free(removed_stms);
+    
+    return result;
+}
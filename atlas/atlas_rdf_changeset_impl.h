@@ -0,0 +1,26 @@
+/*
+ *  atlas_rdf_changeset_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_CHANGESET_IMPL_H_
+#define _ATLAS_RDF_CHANGESET_IMPL_H_
+
+#include <atlas/rdf/changeset.h>
+
+#endif // _ATLAS_RDF_CHANGESET_IMPL_H_
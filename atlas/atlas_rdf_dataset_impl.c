@@ -0,0 +1,577 @@
+/*
+ *  atlas_rdf_dataset_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_dataset_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// the data of a dataset starts with a header, which is followed by
+// the hash table of the terms, the position of the first quad of each
+// graph, the quads in GSPO order and the positions of the quads in
+// GPOS order; the references are the terms, the names of the graphs
+// first (the id of a graph is the id of its name)
+typedef struct {
+    uint32_t num_quads;
+    uint32_t num_terms;
+    uint32_t num_graphs;
+    uint32_t num_buckets;
+} __dataset;
+
+// the ids of the terms of a quad
+typedef struct {
+    uint32_t graph;
+    uint32_t subject;
+    uint32_t predicate;
+    uint32_t object;
+} __dataset_quad;
+
+typedef struct {
+    __dataset * header;
+    
+    // open addressing with linear probing, a bucket
+    // contains the id of a term + 1 or 0 if it is empty
+    uint32_t * buckets;
+    
+    uint32_t * offsets;
+    __dataset_quad * quads;
+    uint32_t * gpos;
+} __dataset_layout;
+
+// the order of the components compared in a quad
+#define ATLAS_RDF_DATASET_SPO 0
+#define ATLAS_RDF_DATASET_POS 1
+
+static void
+atlas_rdf_dataset_layout(atlas_rdf_dataset_t dataset, __dataset_layout * layout) {
+    lz_obj_sync(dataset, ^(void * data, uint32_t length){
+        __dataset * header = data;
+        layout->header = header;
+        layout->buckets = (uint32_t *)(header + 1);
+        layout->offsets = layout->buckets + header->num_buckets;
+        layout->quads = (__dataset_quad *)(layout->offsets + header->num_graphs + 1);
+        layout->gpos = (uint32_t *)(layout->quads + header->num_quads);
+    });
+}
+
+static int
+atlas_rdf_dataset_term_id(atlas_rdf_dataset_t dataset,
+                          __dataset_layout * layout,
+                          atlas_rdf_term_t term) {
+    uint32_t mask = layout->header->num_buckets - 1;
+    uint32_t b = atlas_rdf_term_hash(term) & mask;
+    while (layout->buckets[b] != 0) {
+        uint32_t id = layout->buckets[b] - 1;
+        if (atlas_rdf_term_eq(lz_obj_weak_ref(dataset, id), term)) {
+            return id;
+        }
+        b = (b + 1) & mask;
+    }
+    return -1;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Dataset
+
+static int
+atlas_rdf_dataset_quad_cmp(const void * a, const void * b) {
+    const __dataset_quad * q1 = a;
+    const __dataset_quad * q2 = b;
+    if (q1->graph != q2->graph) return q1->graph < q2->graph ? -1 : 1;
+    if (q1->subject != q2->subject) return q1->subject < q2->subject ? -1 : 1;
+    if (q1->predicate != q2->predicate) return q1->predicate < q2->predicate ? -1 : 1;
+    if (q1->object != q2->object) return q1->object < q2->object ? -1 : 1;
+    return 0;
+}
+
+// a quad in GPOS order with its position in the GSPO order
+typedef struct {
+    uint32_t graph;
+    uint32_t predicate;
+    uint32_t object;
+    uint32_t subject;
+    uint32_t position;
+} __dataset_gpos;
+
+static int
+atlas_rdf_dataset_gpos_cmp(const void * a, const void * b) {
+    const __dataset_gpos * q1 = a;
+    const __dataset_gpos * q2 = b;
+    if (q1->graph != q2->graph) return q1->graph < q2->graph ? -1 : 1;
+    if (q1->predicate != q2->predicate) return q1->predicate < q2->predicate ? -1 : 1;
+    if (q1->object != q2->object) return q1->object < q2->object ? -1 : 1;
+    if (q1->subject != q2->subject) return q1->subject < q2->subject ? -1 : 1;
+    return 0;
+}
+
+// create a dataset from quads with the ids of the terms in the
+// dictionary, the names of the graphs are the first terms
+static atlas_rdf_dataset_t
+atlas_rdf_dataset_create_ids(atlas_rdf_term_dict_t dict,
+                             uint32_t num_graphs,
+                             uint32_t num_quads,
+                             __dataset_quad * quads) {
+    
+    // sort the quads and remove duplicates
+    qsort(quads, num_quads, sizeof(__dataset_quad), atlas_rdf_dataset_quad_cmp);
+    uint32_t length = 0;
+    for (uint32_t i=0; i<num_quads; i++) {
+        if (length == 0 || atlas_rdf_dataset_quad_cmp(&quads[length - 1], &quads[i]) != 0) {
+            quads[length++] = quads[i];
+        }
+    }
+    num_quads = length;
+    
+    uint32_t num_terms = atlas_rdf_term_dict_length(dict);
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(dict);
+    
+    // keep the load factor below 0.5
+    uint32_t num_buckets = 16;
+    while (num_buckets < num_terms * 2) {
+        num_buckets <<= 1;
+    }
+    
+    int size = sizeof(__dataset) +
+               sizeof(uint32_t) * num_buckets +
+               sizeof(uint32_t) * (num_graphs + 1) +
+               sizeof(__dataset_quad) * num_quads +
+               sizeof(uint32_t) * num_quads;
+    __dataset * header = malloc(size);
+    assert(header != 0);
+    header->num_quads = num_quads;
+    header->num_terms = num_terms;
+    header->num_graphs = num_graphs;
+    header->num_buckets = num_buckets;
+    
+    uint32_t * buckets = (uint32_t *)(header + 1);
+    uint32_t * offsets = buckets + num_buckets;
+    __dataset_quad * sorted = (__dataset_quad *)(offsets + num_graphs + 1);
+    uint32_t * gpos = (uint32_t *)(sorted + num_quads);
+    
+    // the dictionary of the terms
+    memset(buckets, 0, sizeof(uint32_t) * num_buckets);
+    for (uint32_t i=0; i<num_terms; i++) {
+        uint32_t b = atlas_rdf_term_hash(terms[i]) & (num_buckets - 1);
+        while (buckets[b] != 0) {
+            b = (b + 1) & (num_buckets - 1);
+        }
+        buckets[b] = i + 1;
+    }
+    
+    // the position of the first quad of each graph
+    memset(offsets, 0, sizeof(uint32_t) * (num_graphs + 1));
+    for (uint32_t i=0; i<num_quads; i++) {
+        offsets[quads[i].graph + 1]++;
+    }
+    for (uint32_t i=0; i<num_graphs; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    memcpy(sorted, quads, sizeof(__dataset_quad) * num_quads);
+    
+    // the GPOS index
+    __dataset_gpos * index = malloc(sizeof(__dataset_gpos) * (num_quads + 1));
+    assert(index != 0);
+    for (uint32_t i=0; i<num_quads; i++) {
+        index[i].graph = quads[i].graph;
+        index[i].predicate = quads[i].predicate;
+        index[i].object = quads[i].object;
+        index[i].subject = quads[i].subject;
+        index[i].position = i;
+    }
+    qsort(index, num_quads, sizeof(__dataset_gpos), atlas_rdf_dataset_gpos_cmp);
+    for (uint32_t i=0; i<num_quads; i++) {
+        gpos[i] = index[i].position;
+    }
+    free(index);
+    
+    return lz_obj_new_v(header, size, ^{
+        free(header);
+    }, num_terms, terms);
+}
+
+static int
+atlas_rdf_dataset_check(atlas_rdf_term_t term,
+                        int loop,
+                        const char * position,
+                        int iri,
+                        atlas_error_handler err) {
+    if (atlas_rdf_term_is_type(term, iri ? IRI : RESOURCE)) {
+        return 1;
+    }
+    char * repr = atlas_rdf_term_repr(term);
+    char * buff;
+    asprintf(&buff, "%s in quad %d is not %s: %s", position, loop, iri ? "an iri" : "a resource", repr);
+    err(1, buff);
+    free(repr);
+    free(buff);
+    return 0;
+}
+
+atlas_rdf_dataset_t
+atlas_rdf_dataset_create(int number_of_quads,
+                         atlas_rdf_quad_t * quads,
+                         atlas_error_handler err) {
+    assert(number_of_quads >= 0);
+    
+    for (int loop = 0; loop < number_of_quads; loop++) {
+        if (!atlas_rdf_dataset_check(quads[loop].graph, loop, "Graph", 0, err) ||
+            !atlas_rdf_dataset_check(quads[loop].subject, loop, "Subject", 0, err) ||
+            !atlas_rdf_dataset_check(quads[loop].predicate, loop, "Predicate", 1, err)) {
+            return 0;
+        }
+    }
+    
+    // the names of the graphs are inserted first
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(number_of_quads);
+    __dataset_quad * ids = malloc(sizeof(__dataset_quad) * (number_of_quads + 1));
+    assert(ids != 0);
+    for (int i=0; i<number_of_quads; i++) {
+        ids[i].graph = atlas_rdf_term_dict_insert(dict, quads[i].graph);
+    }
+    uint32_t num_graphs = atlas_rdf_term_dict_length(dict);
+    for (int i=0; i<number_of_quads; i++) {
+        ids[i].subject = atlas_rdf_term_dict_insert(dict, quads[i].subject);
+        ids[i].predicate = atlas_rdf_term_dict_insert(dict, quads[i].predicate);
+        ids[i].object = atlas_rdf_term_dict_insert(dict, quads[i].object);
+    }
+    
+    atlas_rdf_dataset_t result = atlas_rdf_dataset_create_ids(dict, num_graphs, number_of_quads, ids);
+    
+    free(ids);
+    atlas_rdf_term_dict_free(dict);
+    return result;
+}
+
+atlas_rdf_dataset_t
+atlas_rdf_dataset_create_from_graphs(int number_of_graphs,
+                                     atlas_rdf_term_t * names,
+                                     atlas_rdf_graph_t * graphs,
+                                     atlas_error_handler err) {
+    assert(number_of_graphs >= 0);
+    
+    uint32_t num_quads = 0;
+    for (int i=0; i<number_of_graphs; i++) {
+        if (!atlas_rdf_term_is_type(names[i], RESOURCE)) {
+            char * repr = atlas_rdf_term_repr(names[i]);
+            char * buff;
+            asprintf(&buff, "Name of graph %d is not a resource: %s", i, repr);
+            err(1, buff);
+            free(repr);
+            free(buff);
+            return 0;
+        }
+        num_quads += atlas_rdf_graph_length(graphs[i]);
+    }
+    
+    // the names of the graphs are inserted first
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(num_quads);
+    uint32_t * graph_ids = malloc(sizeof(uint32_t) * (number_of_graphs + 1));
+    assert(graph_ids != 0);
+    for (int i=0; i<number_of_graphs; i++) {
+        graph_ids[i] = atlas_rdf_term_dict_insert(dict, names[i]);
+    }
+    uint32_t num_graphs = atlas_rdf_term_dict_length(dict);
+    
+    // the terms of each part are inserted once
+    __dataset_quad * quads = malloc(sizeof(__dataset_quad) * (num_quads + 1));
+    assert(quads != 0);
+    __block __dataset_quad * out = quads;
+    for (int g=0; g<number_of_graphs; g++) {
+        uint32_t graph_id = graph_ids[g];
+        atlas_rdf_graph_scan(graphs[g], 0, INT32_MAX, ^(atlas_rdf_graph_t part,
+                                                        __graph * statements,
+                                                        int number_of_statements){
+            int num_refs = lz_obj_num_ref(part);
+            uint32_t * ids = malloc(sizeof(uint32_t) * (num_refs + 1));
+            assert(ids != 0);
+            for (int i=0; i<num_refs; i++) {
+                ids[i] = atlas_rdf_term_dict_insert(dict, lz_obj_weak_ref(part, i));
+            }
+            for (int i=0; i<number_of_statements; i++) {
+                out->graph = graph_id;
+                out->subject = ids[statements[i].subject];
+                out->predicate = ids[statements[i].predicate];
+                out->object = ids[statements[i].object];
+                out++;
+            }
+            free(ids);
+        });
+    }
+    
+    atlas_rdf_dataset_t result = atlas_rdf_dataset_create_ids(dict, num_graphs, num_quads, quads);
+    
+    free(quads);
+    free(graph_ids);
+    atlas_rdf_term_dict_free(dict);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Access Details of a RDF Dataset
+
+int
+atlas_rdf_dataset_length(atlas_rdf_dataset_t dataset) {
+    assert(dataset != 0);
+    __dataset_layout layout;
+    atlas_rdf_dataset_layout(dataset, &layout);
+    return layout.header->num_quads;
+}
+
+int
+atlas_rdf_dataset_num_terms(atlas_rdf_dataset_t dataset) {
+    assert(dataset != 0);
+    __dataset_layout layout;
+    atlas_rdf_dataset_layout(dataset, &layout);
+    return layout.header->num_terms;
+}
+
+int
+atlas_rdf_dataset_num_graphs(atlas_rdf_dataset_t dataset) {
+    assert(dataset != 0);
+    __dataset_layout layout;
+    atlas_rdf_dataset_layout(dataset, &layout);
+    return layout.header->num_graphs;
+}
+
+atlas_rdf_term_t
+atlas_rdf_dataset_graph_name(atlas_rdf_dataset_t dataset,
+                             int index) {
+    assert(dataset != 0);
+    assert(index >= 0 && index < atlas_rdf_dataset_num_graphs(dataset));
+    return lz_obj_weak_ref(dataset, index);
+}
+
+atlas_rdf_graph_t
+atlas_rdf_dataset_graph(atlas_rdf_dataset_t dataset,
+                        atlas_rdf_term_t name) {
+    assert(dataset != 0);
+    assert(name != 0);
+    
+    __dataset_layout layout;
+    atlas_rdf_dataset_layout(dataset, &layout);
+    
+    int id = atlas_rdf_dataset_term_id(dataset, &layout, name);
+    if (id == -1 || (uint32_t)id >= layout.header->num_graphs) {
+        return atlas_rdf_graph_create_flat(0, 0, 0, 0);
+    }
+    
+    uint32_t begin = layout.offsets[id];
+    uint32_t num_statements = layout.offsets[id + 1] - begin;
+    
+    // the graph only refers to the terms it uses
+    __graph * statements = malloc(sizeof(__graph) * (num_statements + 1));
+    assert(statements != 0);
+    for (uint32_t i=0; i<num_statements; i++) {
+        statements[i].subject = layout.quads[begin + i].subject;
+        statements[i].predicate = layout.quads[begin + i].predicate;
+        statements[i].object = layout.quads[begin + i].object;
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_subset(dataset, num_statements, statements);
+    free(statements);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Query a RDF Dataset
+
+void
+atlas_rdf_dataset_apply(atlas_rdf_dataset_t dataset,
+                        void(^iterator)(atlas_rdf_term_t graph,
+                                        atlas_rdf_term_t subject,
+                                        atlas_rdf_term_t predicate,
+                                        atlas_rdf_term_t object)) {
+    assert(dataset != 0);
+    assert(iterator != 0);
+    
+    __dataset_layout layout;
+    atlas_rdf_dataset_layout(dataset, &layout);
+    __dataset_quad * quads = layout.quads;
+    
+    atlas_apply_chunked(layout.header->num_quads, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            iterator(lz_obj_weak_ref(dataset, quads[i].graph),
+                     lz_obj_weak_ref(dataset, quads[i].subject),
+                     lz_obj_weak_ref(dataset, quads[i].predicate),
+                     lz_obj_weak_ref(dataset, quads[i].object));
+        }
+    }, 0);
+}
+
+// compare the first components of a quad (in the given order) with a key
+static inline int
+atlas_rdf_dataset_cmp_key(const __dataset_quad * quad,
+                          const uint32_t * key,
+                          int order,
+                          int length) {
+    uint32_t components[3];
+    if (order == ATLAS_RDF_DATASET_SPO) {
+        components[0] = quad->subject;
+        components[1] = quad->predicate;
+        components[2] = quad->object;
+    } else {
+        components[0] = quad->predicate;
+        components[1] = quad->object;
+        components[2] = quad->subject;
+    }
+    for (int i=0; i<length; i++) {
+        if (components[i] != key[i]) {
+            return components[i] < key[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// the first position in [begin, end), which is not less
+// (upper == 0) or greater (upper != 0) than the key
+static uint32_t
+atlas_rdf_dataset_search(__dataset_layout * layout,
+                         uint32_t begin,
+                         uint32_t end,
+                         const uint32_t * key,
+                         int order,
+                         int length,
+                         int upper) {
+    while (begin < end) {
+        uint32_t mid = begin + (end - begin) / 2;
+        const __dataset_quad * quad = order == ATLAS_RDF_DATASET_SPO ?
+                                      &layout->quads[mid] :
+                                      &layout->quads[layout->gpos[mid]];
+        int c = atlas_rdf_dataset_cmp_key(quad, key, order, length);
+        if (c < 0 || (upper && c == 0)) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+int
+atlas_rdf_dataset_match(atlas_rdf_dataset_t dataset,
+                        atlas_rdf_term_t graph,
+                        atlas_rdf_term_t subject,
+                        atlas_rdf_term_t predicate,
+                        atlas_rdf_term_t object,
+                        void(^iterator)(atlas_rdf_term_t graph,
+                                        atlas_rdf_term_t subject,
+                                        atlas_rdf_term_t predicate,
+                                        atlas_rdf_term_t object)) {
+    assert(dataset != 0);
+    
+    __dataset_layout layout;
+    atlas_rdf_dataset_layout(dataset, &layout);
+    
+    // the ids of the given terms, a term which is
+    // not in the dataset does not match any quad
+    atlas_rdf_term_t pattern[4] = {graph, subject, predicate, object};
+    int ids[4];
+    for (int i=0; i<4; i++) {
+        ids[i] = -1;
+        if (pattern[i]) {
+            ids[i] = atlas_rdf_dataset_term_id(dataset, &layout, pattern[i]);
+            if (ids[i] == -1) {
+                return 0;
+            }
+        }
+    }
+    
+    uint32_t first_graph = 0;
+    uint32_t last_graph = layout.header->num_graphs;
+    if (ids[0] != -1) {
+        if ((uint32_t)ids[0] >= layout.header->num_graphs) {
+            return 0;
+        }
+        first_graph = ids[0];
+        last_graph = ids[0] + 1;
+    }
+    
+    int count = 0;
+    for (uint32_t g=first_graph; g<last_graph; g++) {
+        uint32_t begin = layout.offsets[g];
+        uint32_t end = layout.offsets[g + 1];
+        
+        // use the order in which the given terms are a prefix
+        int order = ATLAS_RDF_DATASET_SPO;
+        int length = 0;
+        uint32_t key[3];
+        if (ids[1] != -1) {
+            key[length++] = ids[1];
+            if (ids[2] != -1) {
+                key[length++] = ids[2];
+                if (ids[3] != -1) {
+                    key[length++] = ids[3];
+                }
+            }
+        } else if (ids[2] != -1) {
+            order = ATLAS_RDF_DATASET_POS;
+            key[length++] = ids[2];
+            if (ids[3] != -1) {
+                key[length++] = ids[3];
+            }
+        }
+        if (length > 0) {
+            uint32_t first = atlas_rdf_dataset_search(&layout, begin, end, key, order, length, 0);
+            end = atlas_rdf_dataset_search(&layout, first, end, key, order, length, 1);
+            begin = first;
+        }
+        
+        for (uint32_t i=begin; i<end; i++) {
+            __dataset_quad * quad = order == ATLAS_RDF_DATASET_SPO ?
+                                    &layout.quads[i] :
+                                    &layout.quads[layout.gpos[i]];
+            if ((ids[2] != -1 && quad->predicate != (uint32_t)ids[2]) ||
+                (ids[3] != -1 && quad->object != (uint32_t)ids[3])) {
+                continue;
+            }
+            if (iterator) {
+                iterator(lz_obj_weak_ref(dataset, quad->graph),
+                         lz_obj_weak_ref(dataset, quad->subject),
+                         lz_obj_weak_ref(dataset, quad->predicate),
+                         lz_obj_weak_ref(dataset, quad->object));
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+int
+atlas_rdf_dataset_contains(atlas_rdf_dataset_t dataset,
+                           atlas_rdf_term_t graph,
+                           atlas_rdf_term_t subject,
+                           atlas_rdf_term_t predicate,
+                           atlas_rdf_term_t object) {
+    assert(graph != 0);
+    assert(subject != 0);
+    assert(predicate != 0);
+    assert(object != 0);
+    return atlas_rdf_dataset_match(dataset, graph, subject, predicate, object, 0) > 0;
+}
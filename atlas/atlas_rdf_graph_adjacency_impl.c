@@ -0,0 +1,184 @@
+/*
+ *  atlas_rdf_graph_adjacency_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_adjacency_impl.h"
+#include "atlas_rdf_graph_range_impl.h"
+#include "atlas_rdf_graph_text_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <dispatch/dispatch.h>
+
+#pragma mark -
+#pragma mark Build the Adjacency Index
+
+static void
+atlas_rdf_graph_adjacency_rows(__adjacency_rows * rows,
+                               int num_terms,
+                               __graph * statements,
+                               int num_statements,
+                               int incoming) {
+    rows->offsets = calloc(num_terms + 1, sizeof(uint32_t));
+    rows->edges = malloc(sizeof(uint32_t) * 2 * (num_statements + 1));
+    uint32_t * next = malloc(sizeof(uint32_t) * (num_terms + 1));
+    assert(rows->offsets != 0);
+    assert(rows->edges != 0);
+    assert(next != 0);
+    
+    // count the edges of each term
+    for (int i=0; i<num_statements; i++) {
+        uint32_t id = incoming ? statements[i].object : statements[i].subject;
+        rows->offsets[id + 1]++;
+    }
+    for (int i=0; i<num_terms; i++) {
+        rows->offsets[i + 1] += rows->offsets[i];
+    }
+    
+    // fill the rows in the order of the statements
+    memcpy(next, rows->offsets, sizeof(uint32_t) * num_terms);
+    for (int i=0; i<num_statements; i++) {
+        __graph stm = statements[i];
+        uint32_t id = incoming ? stm.object : stm.subject;
+        uint32_t * edge = rows->edges + 2 * next[id]++;
+        edge[0] = stm.predicate;
+        edge[1] = incoming ? stm.subject : stm.object;
+    }
+    
+    free(next);
+}
+
+static void
+atlas_rdf_graph_adjacency_dealloc(struct atlas_rdf_graph_adjacency_s * adjacency) {
+    if (adjacency->range) {
+        atlas_rdf_graph_range_free(adjacency->range);
+    }
+    if (adjacency->text) {
+        atlas_rdf_graph_text_free(adjacency->text);
+    }
+    atlas_rdf_term_dict_free(adjacency->dict);
+    free(adjacency->outgoing.offsets);
+    free(adjacency->outgoing.edges);
+    free(adjacency->incoming.offsets);
+    free(adjacency->incoming.edges);
+    free(adjacency);
+}
+
+struct atlas_rdf_graph_adjacency_s *
+atlas_rdf_graph_adjacency(atlas_rdf_graph_t graph) {
+    __block __graph_header * header;
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        header = data;
+    });
+    
+    if (header->adjacency) {
+        return header->adjacency;
+    }
+    
+    struct atlas_rdf_graph_adjacency_s * adjacency = malloc(sizeof(struct atlas_rdf_graph_adjacency_s));
+    assert(adjacency != 0);
+    adjacency->range = 0;
+    adjacency->text = 0;
+    
+    int num_statements = atlas_rdf_graph_length(graph);
+    adjacency->dict = atlas_rdf_term_dict_create(num_statements);
+    __graph * statements = atlas_rdf_graph_flatten(graph, adjacency->dict);
+    int num_terms = atlas_rdf_term_dict_length(adjacency->dict);
+    
+    // both directions are built concurrently
+    dispatch_apply(2, dispatch_get_global_queue(0, 0), ^(size_t incoming){
+        atlas_rdf_graph_adjacency_rows(incoming ? &adjacency->incoming : &adjacency->outgoing,
+                                       num_terms, statements, num_statements, incoming);
+    });
+    free(statements);
+    
+    // the index is built without a lock, if two threads
+    // build it at the same time, the first one is kept
+    if (!__sync_bool_compare_and_swap(&header->adjacency, 0, adjacency)) {
+        atlas_rdf_graph_adjacency_dealloc(adjacency);
+        adjacency = header->adjacency;
+    }
+    return adjacency;
+}
+
+void
+atlas_rdf_graph_adjacency_free(__graph_header * header) {
+    if (header->adjacency) {
+        atlas_rdf_graph_adjacency_dealloc(header->adjacency);
+    }
+}
+
+#pragma mark -
+#pragma mark Describe a Resource in a RDF Graph
+
+// apply the block to the edges of a term and return their number
+static int
+atlas_rdf_graph_adjacency_apply(struct atlas_rdf_graph_adjacency_s * adjacency,
+                                __adjacency_rows * rows,
+                                atlas_rdf_term_t term,
+                                int incoming,
+                                void(^iterator)(atlas_rdf_term_t first,
+                                                atlas_rdf_term_t second)) {
+    int id = atlas_rdf_term_dict_lookup(adjacency->dict, term);
+    if (id == -1) {
+        return 0;
+    }
+    
+    uint32_t begin = rows->offsets[id];
+    uint32_t end = rows->offsets[id + 1];
+    if (iterator) {
+        atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(adjacency->dict);
+        for (uint32_t i=begin; i<end; i++) {
+            uint32_t * edge = rows->edges + 2 * i;
+            if (incoming) {
+                iterator(terms[edge[1]], terms[edge[0]]);
+            } else {
+                iterator(terms[edge[0]], terms[edge[1]]);
+            }
+        }
+    }
+    return end - begin;
+}
+
+int
+atlas_rdf_graph_describe(atlas_rdf_graph_t graph,
+                         atlas_rdf_term_t subject,
+                         void(^iterator)(atlas_rdf_term_t predicate,
+                                         atlas_rdf_term_t object)) {
+    assert(graph != 0);
+    assert(subject != 0);
+    
+    struct atlas_rdf_graph_adjacency_s * adjacency = atlas_rdf_graph_adjacency(graph);
+    return atlas_rdf_graph_adjacency_apply(adjacency, &adjacency->outgoing, subject, 0, iterator);
+}
+
+int
+atlas_rdf_graph_describe_incoming(atlas_rdf_graph_t graph,
+                                  atlas_rdf_term_t object,
+                                  void(^iterator)(atlas_rdf_term_t subject,
+                                                  atlas_rdf_term_t predicate)) {
+    assert(graph != 0);
+    assert(object != 0);
+    
+    struct atlas_rdf_graph_adjacency_s * adjacency = atlas_rdf_graph_adjacency(graph);
+    return atlas_rdf_graph_adjacency_apply(adjacency, &adjacency->incoming, object, 1, iterator);
+}
@@ -0,0 +1,72 @@
+/*
+ *  atlas_rdf_graph_adjacency_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_ADJACENCY_IMPL_H_
+#define _ATLAS_RDF_GRAPH_ADJACENCY_IMPL_H_
+
+#include <atlas/rdf/graph.h>
+
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// compressed sparse rows: the edges of the term with the id i
+// are at the positions [offsets[i], offsets[i + 1]), an edge
+// consists of the predicate and the term at the other end
+typedef struct {
+    uint32_t * offsets;
+    uint32_t * edges;
+} __adjacency_rows;
+
+// the ids are the positions of the terms in the dictionary,
+// the terms are not retained and kept alive by the graph; the
+// range and text indexes are built on demand (s. atlas_rdf_graph_range_impl.h
+// and atlas_rdf_graph_text_impl.h)
+struct atlas_rdf_graph_adjacency_s {
+    atlas_rdf_term_dict_t dict;
+    __adjacency_rows outgoing;
+    __adjacency_rows incoming;
+    struct atlas_rdf_graph_range_s * range;
+    struct atlas_rdf_graph_text_s * text;
+};
+
+#pragma mark -
+#pragma mark Access the Adjacency Index
+
+/*! Adjacency index of a graph.
+ *
+ *  The index is built on first use and kept until
+ *  the graph is removed.
+ */
+struct atlas_rdf_graph_adjacency_s *
+atlas_rdf_graph_adjacency(atlas_rdf_graph_t graph);
+
+/*! Free the adjacency index kept in the header of a graph.
+ *
+ *  Called when the graph is removed.
+ */
+void
+atlas_rdf_graph_adjacency_free(__graph_header * header);
+
+#endif // _ATLAS_RDF_GRAPH_ADJACENCY_IMPL_H_
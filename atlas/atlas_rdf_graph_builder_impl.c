@@ -0,0 +1,427 @@
+/*
+ *  atlas_rdf_graph_builder_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_builder_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+struct atlas_rdf_graph_builder_s {
+    // the terms used in the statements (retained)
+    atlas_rdf_term_dict_t terms;
+    
+    // the distinct statements in the order they have been added
+    int num_statements;
+    int max_statements;
+    __graph * statements;
+    
+    // open addressing with linear probing, a bucket contains
+    // the position of a statement or -1 if the bucket is empty
+    uint32_t num_buckets;
+    int32_t * buckets;
+};
+
+static uint32_t
+atlas_rdf_graph_builder_hash(__graph stm) {
+    uint32_t hash = stm.subject * 0x9e3779b1u;
+    hash = (hash ^ (hash >> 15)) + stm.predicate * 0x85ebca77u;
+    hash = (hash ^ (hash >> 13)) + stm.object * 0xc2b2ae3du;
+    return hash ^ (hash >> 16);
+}
+
+static void
+atlas_rdf_graph_builder_rehash(atlas_rdf_graph_builder_t builder, uint32_t num_buckets) {
+    int32_t * buckets = malloc(sizeof(int32_t) * num_buckets);
+    assert(buckets != 0);
+    memset(buckets, 0xff, sizeof(int32_t) * num_buckets);
+    
+    for (int i=0; i<builder->num_statements; i++) {
+        uint32_t b = atlas_rdf_graph_builder_hash(builder->statements[i]) & (num_buckets - 1);
+        while (buckets[b] != -1) {
+            b = (b + 1) & (num_buckets - 1);
+        }
+        buckets[b] = i;
+    }
+    
+    free(builder->buckets);
+    builder->buckets = buckets;
+    builder->num_buckets = num_buckets;
+}
+
+// find the bucket of the statement, which is either
+// the bucket containing the statement or an empty bucket
+static uint32_t
+atlas_rdf_graph_builder_bucket(atlas_rdf_graph_builder_t builder, __graph stm) {
+    uint32_t b = atlas_rdf_graph_builder_hash(stm) & (builder->num_buckets - 1);
+    while (builder->buckets[b] != -1) {
+        __graph other = builder->statements[builder->buckets[b]];
+        if (other.subject == stm.subject &&
+            other.predicate == stm.predicate &&
+            other.object == stm.object) {
+            break;
+        }
+        b = (b + 1) & (builder->num_buckets - 1);
+    }
+    return b;
+}
+
+static void
+atlas_rdf_graph_builder_add_ids(atlas_rdf_graph_builder_t builder, __graph stm) {
+    
+    // avoid putting the same statement into the graph twice
+    uint32_t b = atlas_rdf_graph_builder_bucket(builder, stm);
+    if (builder->buckets[b] != -1) {
+        return;
+    }
+    
+    // grow the list of statements if needed
+    if (builder->num_statements == builder->max_statements) {
+        builder->max_statements *= 2;
+        builder->statements = realloc(builder->statements, sizeof(__graph) * builder->max_statements);
+        assert(builder->statements != 0);
+    }
+    
+    // append the statement
+    builder->statements[builder->num_statements] = stm;
+    builder->buckets[b] = builder->num_statements;
+    builder->num_statements++;
+    
+    // keep the load factor below 0.5
+    if ((uint32_t)builder->num_statements * 2 > builder->num_buckets) {
+        atlas_rdf_graph_builder_rehash(builder, builder->num_buckets * 2);
+    }
+}
+
+static int
+atlas_rdf_graph_builder_term(atlas_rdf_graph_builder_t builder, atlas_rdf_term_t term) {
+    int num_terms = atlas_rdf_term_dict_length(builder->terms);
+    int id = atlas_rdf_term_dict_insert(builder->terms, term);
+    if (id == num_terms) {
+        // the term is new, keep it until the builder is freed
+        lz_retain(term);
+    }
+    return id;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Graph Builder
+
+atlas_rdf_graph_builder_t
+atlas_rdf_graph_builder_create(int capacity) {
+    atlas_rdf_graph_builder_t builder = malloc(sizeof(struct atlas_rdf_graph_builder_s));
+    assert(builder != 0);
+    
+    if (capacity < 8) {
+        capacity = 8;
+    }
+    
+    builder->terms = atlas_rdf_term_dict_create(capacity);
+    
+    builder->num_statements = 0;
+    builder->max_statements = capacity;
+    builder->statements = malloc(sizeof(__graph) * capacity);
+    assert(builder->statements != 0);
+    
+    // keep the load factor below 0.5
+    uint32_t num_buckets = 16;
+    while (num_buckets < (uint32_t)capacity * 2) {
+        num_buckets <<= 1;
+    }
+    builder->num_buckets = 0;
+    builder->buckets = 0;
+    atlas_rdf_graph_builder_rehash(builder, num_buckets);
+    
+    return builder;
+}
+
+void
+atlas_rdf_graph_builder_free(atlas_rdf_graph_builder_t builder) {
+    if (builder) {
+        int num_terms = atlas_rdf_term_dict_length(builder->terms);
+        atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(builder->terms);
+        for (int i=0; i<num_terms; i++) {
+            lz_release(terms[i]);
+        }
+        atlas_rdf_term_dict_free(builder->terms);
+        free(builder->statements);
+        free(builder->buckets);
+        free(builder);
+    }
+}
+
+#pragma mark -
+#pragma mark Add Statements to a RDF Graph Builder
+
+int
+atlas_rdf_graph_builder_add(atlas_rdf_graph_builder_t builder,
+                            atlas_rdf_term_t subject,
+                            atlas_rdf_term_t predicate,
+                            atlas_rdf_term_t object,
+                            atlas_error_handler err) {
+    assert(builder != 0);
+    
+    // check subject
+    if (!atlas_rdf_term_is_type(subject, RESOURCE)) {
+        char * repr = atlas_rdf_term_repr(subject);
+        char * buff;
+        asprintf(&buff, "Subject is not a resource: %s", repr);
+        err(1, buff);
+        free(repr);
+        free(buff);
+        return 0;
+    }
+    
+    // check predicate
+    if (!atlas_rdf_term_is_type(predicate, IRI)) {
+        char * repr = atlas_rdf_term_repr(predicate);
+        char * buff;
+        asprintf(&buff, "Predicate is not an iri: %s", repr);
+        err(1, buff);
+        free(repr);
+        free(buff);
+        return 0;
+    }
+    
+    __graph stm;
+    stm.subject = atlas_rdf_graph_builder_term(builder, subject);
+    stm.predicate = atlas_rdf_graph_builder_term(builder, predicate);
+    stm.object = atlas_rdf_graph_builder_term(builder, object);
+    
+    atlas_rdf_graph_builder_add_ids(builder, stm);
+    
+    return 1;
+}
+
+int
+atlas_rdf_graph_builder_add_statements(atlas_rdf_graph_builder_t builder,
+                                       int number_of_statements,
+                                       atlas_rdf_statement_t * statements,
+                                       atlas_error_handler err) {
+    assert(builder != 0);
+    
+    for (int loop = 0; loop < number_of_statements; loop++) {
+        atlas_rdf_statement_t stm = statements[loop];
+        if (!atlas_rdf_graph_builder_add(builder, stm.subject, stm.predicate, stm.object, err)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int
+atlas_rdf_graph_builder_length(atlas_rdf_graph_builder_t builder) {
+    assert(builder != 0);
+    return builder->num_statements;
+}
+
+#pragma mark -
+#pragma mark Commit a RDF Graph Builder
+
+atlas_rdf_graph_t
+atlas_rdf_graph_builder_commit(atlas_rdf_graph_builder_t builder,
+                               atlas_error_handler err) {
+    assert(builder != 0);
+    
+    // the statements refer to the position of the terms in the
+    // dictionary, the builder keeps its own list of statements
+    // to be able to add more statements
+    return atlas_rdf_graph_create_flat(builder->num_statements,
+                                       builder->statements,
+                                       atlas_rdf_term_dict_length(builder->terms),
+                                       atlas_rdf_term_dict_terms(builder->terms));
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_builder_commit_range(atlas_rdf_graph_builder_t builder,
+                                     int begin,
+                                     int end) {
+    assert(builder != 0);
+    assert(begin >= 0 && begin <= end && end <= builder->num_statements);
+    
+    int num_terms = atlas_rdf_term_dict_length(builder->terms);
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(builder->terms);
+    
+    // map the ids of the terms used in the range to new
+    // consecutive ids, starting at 0
+    int32_t * map = malloc(sizeof(int32_t) * (num_terms + 1));
+    assert(map != 0);
+    memset(map, 0xff, sizeof(int32_t) * (num_terms + 1));
+    
+    int num_statements = end - begin;
+    __graph * statements = malloc(sizeof(__graph) * (num_statements + 1));
+    atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) * (num_statements * 3 + 1));
+    assert(statements != 0);
+    assert(refs != 0);
+    
+    int num_refs = 0;
+    for (int i=0; i<num_statements; i++) {
+        __graph stm = builder->statements[begin + i];
+        uint32_t * ids[3] = {&stm.subject, &stm.predicate, &stm.object};
+        for (int k=0; k<3; k++) {
+            uint32_t id = *ids[k];
+            if (map[id] == -1) {
+                map[id] = num_refs;
+                refs[num_refs] = terms[id];
+                num_refs++;
+            }
+            *ids[k] = map[id];
+        }
+        statements[i] = stm;
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_flat(num_statements, statements, num_refs, refs);
+    
+    free(map);
+    free(statements);
+    free(refs);
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Internal Access to a RDF Graph Builder
+
+void
+atlas_rdf_graph_builder_add_graph(atlas_rdf_graph_builder_t builder,
+                                  atlas_rdf_graph_t graph,
+                                  atlas_rdf_graph_builder_t filter,
+                                  int contained) {
+    assert(builder != 0);
+    assert(graph != 0);
+    
+    atlas_rdf_graph_scan(graph, 0, INT32_MAX, ^(atlas_rdf_graph_t part,
+                                                __graph * statements,
+                                                int number_of_statements){
+        
+        // map the terms of the part to ids in the builder (and in
+        // the filter) once, instead of hashing them for each statement
+        int num_refs = lz_obj_num_ref(part);
+        uint32_t * ids = malloc(sizeof(uint32_t) * (num_refs + 1));
+        int32_t * filter_ids = filter ? malloc(sizeof(int32_t) * (num_refs + 1)) : 0;
+        assert(ids != 0);
+        for (int i=0; i<num_refs; i++) {
+            atlas_rdf_term_t term = lz_obj_weak_ref(part, i);
+            if (filter) {
+                // the terms are added with the statements passing the filter
+                filter_ids[i] = atlas_rdf_graph_builder_term_id(filter, term);
+            } else {
+                ids[i] = atlas_rdf_graph_builder_term(builder, term);
+            }
+        }
+        
+        for (int i=0; i<number_of_statements; i++) {
+            __graph stm = statements[i];
+            if (filter) {
+                int in_filter = atlas_rdf_graph_builder_statement_id(filter,
+                                                                     filter_ids[stm.subject],
+                                                                     filter_ids[stm.predicate],
+                                                                     filter_ids[stm.object]) != -1;
+                if (in_filter != (contained != 0)) {
+                    continue;
+                }
+                stm.subject = atlas_rdf_graph_builder_term(builder, lz_obj_weak_ref(part, stm.subject));
+                stm.predicate = atlas_rdf_graph_builder_term(builder, lz_obj_weak_ref(part, stm.predicate));
+                stm.object = atlas_rdf_graph_builder_term(builder, lz_obj_weak_ref(part, stm.object));
+            } else {
+                stm.subject = ids[stm.subject];
+                stm.predicate = ids[stm.predicate];
+                stm.object = ids[stm.object];
+            }
+            atlas_rdf_graph_builder_add_ids(builder, stm);
+        }
+        
+        free(ids);
+        free(filter_ids);
+    });
+}
+
+int
+atlas_rdf_graph_builder_add_term(atlas_rdf_graph_builder_t builder,
+                                 atlas_rdf_term_t term) {
+    assert(builder != 0);
+    assert(term != 0);
+    return atlas_rdf_graph_builder_term(builder, term);
+}
+
+void
+atlas_rdf_graph_builder_add_term_ids(atlas_rdf_graph_builder_t builder,
+                                     int subject,
+                                     int predicate,
+                                     int object) {
+    assert(builder != 0);
+    __graph stm;
+    stm.subject = subject;
+    stm.predicate = predicate;
+    stm.object = object;
+    atlas_rdf_graph_builder_add_ids(builder, stm);
+}
+
+int
+atlas_rdf_graph_builder_term_id(atlas_rdf_graph_builder_t builder,
+                                atlas_rdf_term_t term) {
+    assert(builder != 0);
+    return atlas_rdf_term_dict_lookup(builder->terms, term);
+}
+
+int
+atlas_rdf_graph_builder_statement_id(atlas_rdf_graph_builder_t builder,
+                                     int subject,
+                                     int predicate,
+                                     int object) {
+    assert(builder != 0);
+    if (subject < 0 || predicate < 0 || object < 0) {
+        return -1;
+    }
+    __graph stm;
+    stm.subject = subject;
+    stm.predicate = predicate;
+    stm.object = object;
+    return builder->buckets[atlas_rdf_graph_builder_bucket(builder, stm)];
+}
+
+int
+atlas_rdf_graph_builder_num_terms(atlas_rdf_graph_builder_t builder) {
+    assert(builder != 0);
+    return atlas_rdf_term_dict_length(builder->terms);
+}
+
+atlas_rdf_term_t
+atlas_rdf_graph_builder_term_at(atlas_rdf_graph_builder_t builder,
+                                int id) {
+    assert(builder != 0);
+    assert(id >= 0 && id < atlas_rdf_term_dict_length(builder->terms));
+    return atlas_rdf_term_dict_terms(builder->terms)[id];
+}
+
+__graph
+atlas_rdf_graph_builder_statement_at(atlas_rdf_graph_builder_t builder,
+                                     int position) {
+    assert(builder != 0);
+    assert(position >= 0 && position < builder->num_statements);
+    return builder->statements[position];
+}
@@ -0,0 +1,101 @@
+/*
+ *  atlas_rdf_graph_builder_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_BUILDER_IMPL_H_
+#define _ATLAS_RDF_GRAPH_BUILDER_IMPL_H_
+
+#include <atlas/rdf/graph_builder.h>
+
+#include "atlas_rdf_graph_impl.h"
+
+#pragma mark -
+#pragma mark Internal Access to a RDF Graph Builder
+
+/*! Add the statements of a graph to the builder.
+ *
+ *  If a filter is given, only the statements which are
+ *  (contained != 0) or are not (contained == 0) in the
+ *  filter are added.
+ */
+void
+atlas_rdf_graph_builder_add_graph(atlas_rdf_graph_builder_t builder,
+                                  atlas_rdf_graph_t graph,
+                                  atlas_rdf_graph_builder_t filter,
+                                  int contained);
+
+/*! Add a term to the builder (if it is not in the builder) and return its id.
+ */
+int
+atlas_rdf_graph_builder_add_term(atlas_rdf_graph_builder_t builder,
+                                 atlas_rdf_term_t term);
+
+/*! Add a statement with the ids of terms in the builder.
+ *
+ *  The types of the terms are not checked.
+ */
+void
+atlas_rdf_graph_builder_add_term_ids(atlas_rdf_graph_builder_t builder,
+                                     int subject,
+                                     int predicate,
+                                     int object);
+
+/*! Id of a term in the builder or -1 if the term is not in the builder.
+ */
+int
+atlas_rdf_graph_builder_term_id(atlas_rdf_graph_builder_t builder,
+                                atlas_rdf_term_t term);
+
+/*! Position of the statement with the given term ids in the builder
+ *  or -1 if the statement is not in the builder.
+ */
+int
+atlas_rdf_graph_builder_statement_id(atlas_rdf_graph_builder_t builder,
+                                     int subject,
+                                     int predicate,
+                                     int object);
+
+/*! Number of terms in the builder, the ids are [0, number of terms).
+ */
+int
+atlas_rdf_graph_builder_num_terms(atlas_rdf_graph_builder_t builder);
+
+/*! Term with the given id (not retained).
+ */
+atlas_rdf_term_t
+atlas_rdf_graph_builder_term_at(atlas_rdf_graph_builder_t builder,
+                                int id);
+
+/*! Statement at the given position, the positions
+ *  in the statement are the ids of the terms.
+ */
+__graph
+atlas_rdf_graph_builder_statement_at(atlas_rdf_graph_builder_t builder,
+                                     int position);
+
+/*! Create a flat graph from the statements at the positions [begin, end).
+ *
+ *  Only the terms used by these statements are referenced by the graph.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_builder_commit_range(atlas_rdf_graph_builder_t builder,
+                                     int begin,
+                                     int end);
+
+#endif // _ATLAS_RDF_GRAPH_BUILDER_IMPL_H_
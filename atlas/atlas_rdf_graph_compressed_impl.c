@@ -0,0 +1,258 @@
+/*
+ *  atlas_rdf_graph_compressed_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_compressed_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Encoding
+
+// unsigned LEB128: 7 bits per byte, the high bit
+// marks that more bytes follow
+static uint8_t *
+atlas_rdf_graph_put_varint(uint8_t * out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+static const uint8_t *
+atlas_rdf_graph_get_varint(const uint8_t * in, uint32_t * value) {
+    uint32_t result = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        result |= (uint32_t)(*in++ & 0x7f) << shift;
+        shift += 7;
+    }
+    *value = result | ((uint32_t)*in++ << shift);
+    return in;
+}
+
+// the statements are sorted, so a statement is stored relative to
+// its predecessor: a tag (0: same subject and predicate, 1: same
+// subject, else the difference of the subjects + 1) followed by
+// the difference of the objects, the difference of the predicates
+// and the object, or the predicate and the object
+static uint8_t *
+atlas_rdf_graph_encode(uint8_t * out, __graph prev, __graph stm) {
+    if (stm.subject != prev.subject) {
+        out = atlas_rdf_graph_put_varint(out, stm.subject - prev.subject + 1);
+        out = atlas_rdf_graph_put_varint(out, stm.predicate);
+        out = atlas_rdf_graph_put_varint(out, stm.object);
+    } else if (stm.predicate != prev.predicate) {
+        out = atlas_rdf_graph_put_varint(out, 1);
+        out = atlas_rdf_graph_put_varint(out, stm.predicate - prev.predicate);
+        out = atlas_rdf_graph_put_varint(out, stm.object);
+    } else {
+        // the statements are distinct, so the object is greater
+        out = atlas_rdf_graph_put_varint(out, 0);
+        out = atlas_rdf_graph_put_varint(out, stm.object - prev.object - 1);
+    }
+    return out;
+}
+
+static const uint8_t *
+atlas_rdf_graph_decode(const uint8_t * in, __graph prev, __graph * stm) {
+    uint32_t tag, value;
+    in = atlas_rdf_graph_get_varint(in, &tag);
+    if (tag == 0) {
+        in = atlas_rdf_graph_get_varint(in, &value);
+        stm->subject = prev.subject;
+        stm->predicate = prev.predicate;
+        stm->object = prev.object + value + 1;
+    } else if (tag == 1) {
+        in = atlas_rdf_graph_get_varint(in, &value);
+        stm->subject = prev.subject;
+        stm->predicate = prev.predicate + value;
+        in = atlas_rdf_graph_get_varint(in, &stm->object);
+    } else {
+        stm->subject = prev.subject + tag - 1;
+        in = atlas_rdf_graph_get_varint(in, &stm->predicate);
+        in = atlas_rdf_graph_get_varint(in, &stm->object);
+    }
+    return in;
+}
+
+static int
+atlas_rdf_graph_cmp(const void * a, const void * b) {
+    const __graph * s1 = a;
+    const __graph * s2 = b;
+    if (s1->subject != s2->subject) {
+        return s1->subject < s2->subject ? -1 : 1;
+    }
+    if (s1->predicate != s2->predicate) {
+        return s1->predicate < s2->predicate ? -1 : 1;
+    }
+    if (s1->object != s2->object) {
+        return s1->object < s2->object ? -1 : 1;
+    }
+    return 0;
+}
+
+// decode the statements of a block, returns the number of statements
+static int
+atlas_rdf_graph_decode_block(__graph_header * header, uint32_t b, __graph * statements) {
+    __graph_compressed * compressed = (__graph_compressed *)(header + 1);
+    __graph_block * blocks = (__graph_block *)(compressed + 1);
+    const uint8_t * data = (const uint8_t *)(blocks + compressed->num_blocks);
+    
+    int num = header->num_statements - b * ATLAS_RDF_GRAPH_BLOCK_SIZE;
+    if (num > ATLAS_RDF_GRAPH_BLOCK_SIZE) {
+        num = ATLAS_RDF_GRAPH_BLOCK_SIZE;
+    }
+    
+    const uint8_t * in = data + blocks[b].offset;
+    statements[0] = blocks[b].first;
+    for (int i=1; i<num; i++) {
+        in = atlas_rdf_graph_decode(in, statements[i - 1], &statements[i]);
+    }
+    return num;
+}
+
+#pragma mark -
+#pragma mark Create a Compressed RDF Graph
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_compressed(atlas_rdf_graph_t graph,
+                                  atlas_error_handler err) {
+    assert(graph != 0);
+    
+    // number the terms of all parts and sort the statements
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(lz_obj_num_ref(graph));
+    __graph * statements = atlas_rdf_graph_flatten(graph, dict);
+    int num_statements = atlas_rdf_graph_length(graph);
+    qsort(statements, num_statements, sizeof(__graph), atlas_rdf_graph_cmp);
+    
+    // encode the statements into a temporary buffer (worst case:
+    // 5 bytes for each of the 3 positions)
+    uint32_t num_blocks = (num_statements + ATLAS_RDF_GRAPH_BLOCK_SIZE - 1) / ATLAS_RDF_GRAPH_BLOCK_SIZE;
+    __graph_block * blocks = malloc(sizeof(__graph_block) * (num_blocks + 1));
+    uint8_t * buffer = malloc((size_t)num_statements * 15 + 1);
+    assert(blocks != 0);
+    assert(buffer != 0);
+    
+    uint8_t * out = buffer;
+    for (int i=0; i<num_statements; i++) {
+        if (i % ATLAS_RDF_GRAPH_BLOCK_SIZE == 0) {
+            __graph_block * block = &blocks[i / ATLAS_RDF_GRAPH_BLOCK_SIZE];
+            block->first = statements[i];
+            block->offset = out - buffer;
+        } else {
+            out = atlas_rdf_graph_encode(out, statements[i - 1], statements[i]);
+        }
+    }
+    uint32_t data_length = out - buffer;
+    
+    // setup the data of the graph
+    int size = sizeof(__graph_header) + sizeof(__graph_compressed) +
+               sizeof(__graph_block) * num_blocks + data_length;
+    __graph_header * header = malloc(size);
+    assert(header != 0);
+    
+    header->kind = ATLAS_RDF_GRAPH_COMPRESSED;
+    header->num_statements = num_statements;
+    memset(header->reserved, 0, sizeof(header->reserved));
+    __graph_compressed * compressed = (__graph_compressed *)(header + 1);
+    compressed->num_blocks = num_blocks;
+    compressed->data_length = data_length;
+    memcpy(compressed + 1, blocks, sizeof(__graph_block) * num_blocks);
+    memcpy((__graph_block *)(compressed + 1) + num_blocks, buffer, data_length);
+    
+    atlas_rdf_graph_t result = lz_obj_new_v(header, size, ^{
+        atlas_rdf_graph_header_free(header);
+        free(header);
+    }, atlas_rdf_term_dict_length(dict), atlas_rdf_term_dict_terms(dict));
+    
+    free(buffer);
+    free(blocks);
+    free(statements);
+    atlas_rdf_term_dict_free(dict);
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Access a Compressed RDF Graph
+
+void
+atlas_rdf_graph_compressed_scan(atlas_rdf_graph_t graph,
+                                __graph_header * header,
+                                int begin,
+                                int end,
+                                void(^block)(atlas_rdf_graph_t part,
+                                             __graph * statements,
+                                             int number_of_statements)) {
+    __graph statements[ATLAS_RDF_GRAPH_BLOCK_SIZE];
+    
+    // the blocks have a fixed number of statements, so the
+    // first block of the range can be found directly
+    for (uint32_t b = begin / ATLAS_RDF_GRAPH_BLOCK_SIZE; (int)(b * ATLAS_RDF_GRAPH_BLOCK_SIZE) < end; b++) {
+        int num = atlas_rdf_graph_decode_block(header, b, statements);
+        int first = b * ATLAS_RDF_GRAPH_BLOCK_SIZE;
+        int from = begin > first ? begin - first : 0;
+        int to = end < first + num ? end - first : num;
+        block(graph, statements + from, to - from);
+    }
+}
+
+int
+atlas_rdf_graph_compressed_contains(__graph_header * header,
+                                    __graph stm) {
+    __graph_compressed * compressed = (__graph_compressed *)(header + 1);
+    __graph_block * blocks = (__graph_block *)(compressed + 1);
+    
+    if (compressed->num_blocks == 0 || atlas_rdf_graph_cmp(&stm, &blocks[0].first) < 0) {
+        return 0;
+    }
+    
+    // find the last block starting with a statement
+    // which is not greater than the given statement
+    uint32_t lo = 0;
+    uint32_t hi = compressed->num_blocks - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi + 1) / 2;
+        if (atlas_rdf_graph_cmp(&blocks[mid].first, &stm) <= 0) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    
+    __graph statements[ATLAS_RDF_GRAPH_BLOCK_SIZE];
+    int num = atlas_rdf_graph_decode_block(header, lo, statements);
+    for (int i=0; i<num; i++) {
+        int c = atlas_rdf_graph_cmp(&statements[i], &stm);
+        if (c == 0) {
+            return 1;
+        }
+        if (c > 0) {
+            break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ *  atlas_rdf_graph_compressed_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_COMPRESSED_IMPL_H_
+#define _ATLAS_RDF_GRAPH_COMPRESSED_IMPL_H_
+
+#include "atlas_rdf_graph_impl.h"
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// number of statements in a block of a compressed graph
+#define ATLAS_RDF_GRAPH_BLOCK_SIZE 128
+
+// the header of a compressed graph is followed by the block
+// headers and the encoded statements; the statements are sorted
+// by subject, predicate and object
+typedef struct {
+    uint32_t num_blocks;
+    uint32_t data_length;
+} __graph_compressed;
+
+// the first statement of a block is stored in the block header,
+// the other statements are encoded relative to their predecessor
+typedef struct {
+    __graph first;
+    uint32_t offset;
+} __graph_block;
+
+#pragma mark -
+#pragma mark Access a Compressed RDF Graph
+
+/*! Scan the statements at the positions [begin, end) of a compressed graph.
+ *
+ *  The statements are decoded block by block and passed to the block.
+ */
+void
+atlas_rdf_graph_compressed_scan(atlas_rdf_graph_t graph,
+                                __graph_header * header,
+                                int begin,
+                                int end,
+                                void(^block)(atlas_rdf_graph_t part,
+                                             __graph * statements,
+                                             int number_of_statements));
+
+/*! Check if a compressed graph contains a statement.
+ *
+ *  Only the block, which may contain the statement, is decoded.
+ */
+int
+atlas_rdf_graph_compressed_contains(__graph_header * header,
+                                    __graph stm);
+
+#endif // _ATLAS_RDF_GRAPH_COMPRESSED_IMPL_H_
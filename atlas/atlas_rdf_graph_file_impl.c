@@ -0,0 +1,362 @@
+/*
+ *  atlas_rdf_graph_file_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_file_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#pragma mark -
+#pragma mark Error Handling
+
+static void
+atlas_rdf_graph_file_error(atlas_error_handler err, const char * msg, const char * path) {
+    char * buff;
+    if (errno) {
+        asprintf(&buff, "%s %s: %s", msg, path, strerror(errno));
+    } else {
+        asprintf(&buff, "%s %s", msg, path);
+    }
+    err(1, buff);
+    free(buff);
+}
+
+#pragma mark -
+#pragma mark Write a RDF Graph File
+
+int
+atlas_rdf_graph_write_file(atlas_rdf_graph_t graph,
+                           const char * path,
+                           atlas_error_handler err) {
+    assert(graph != 0);
+    assert(path != 0);
+    
+    // number the terms of all parts of the graph and
+    // setup the triples with these numbers
+    int num_statements = atlas_rdf_graph_length(graph);
+    uint64_t triples_length = sizeof(__graph_header) + sizeof(__graph) * num_statements;
+    __graph_header * triples = malloc(triples_length);
+    assert(triples != 0);
+    triples->kind = ATLAS_RDF_GRAPH_FLAT;
+    triples->num_statements = num_statements;
+    memset(triples->reserved, 0, sizeof(triples->reserved));
+    
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(lz_obj_num_ref(graph));
+    
+    __graph * statements = atlas_rdf_graph_flatten(graph, dict);
+    memcpy(triples + 1, statements, sizeof(__graph) * num_statements);
+    free(statements);
+    
+    // add the types of the typed literals, which are
+    // not referenced by the triples
+    int num_graph_terms = atlas_rdf_term_dict_length(dict);
+    uint32_t * types = malloc(sizeof(uint32_t) * (num_graph_terms + 1));
+    assert(types != 0);
+    for (int i=0; i<num_graph_terms; i++) {
+        atlas_rdf_term_t term = atlas_rdf_term_dict_terms(dict)[i];
+        types[i] = UINT32_MAX;
+        if (atlas_rdf_term_type(term) == TYPED_LITERAL) {
+            // the type is kept by the literal
+            atlas_rdf_term_t type = atlas_rdf_term_typed_type(term);
+            types[i] = atlas_rdf_term_dict_insert(dict, type);
+            lz_release(type);
+        }
+    }
+    int num_terms = atlas_rdf_term_dict_length(dict);
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(dict);
+    
+    __block int failed = 0;
+    __block uint64_t offset = 0;
+    
+    errno = 0;
+    FILE * file = fopen(path, "wb");
+    if (file == 0) {
+        atlas_rdf_graph_file_error(err, "Could not create graph file", path);
+        free(types);
+        free(triples);
+        atlas_rdf_term_dict_free(dict);
+        return 0;
+    }
+    
+    void(^write)(const void * data, uint64_t length) = ^(const void * data, uint64_t length){
+        if (!failed && length > 0 && fwrite(data, length, 1, file) != 1) {
+            failed = 1;
+        }
+        offset += length;
+    };
+    
+    void(^pad)(uint64_t alignment) = ^(uint64_t alignment){
+        static const char zeros[ATLAS_RDF_GRAPH_FILE_ALIGNMENT];
+        write(zeros, (alignment - offset % alignment) % alignment);
+    };
+    
+    // the header is written again, after the offsets of the sections are known
+    __graph_file_header header;
+    memset(&header, 0, sizeof(__graph_file_header));
+    memcpy(header.magic, ATLAS_RDF_GRAPH_FILE_MAGIC, 8);
+    header.byte_order = ATLAS_RDF_GRAPH_FILE_BYTE_ORDER;
+    header.version = ATLAS_RDF_GRAPH_FILE_VERSION;
+    header.sizeof_long = sizeof(long);
+    header.sizeof_time = sizeof(time_t);
+    header.sizeof_limb = sizeof(mp_limb_t);
+    header.num_sections = 2;
+    write(&header, sizeof(__graph_file_header));
+    
+    // term section
+    pad(ATLAS_RDF_GRAPH_FILE_ALIGNMENT);
+    header.sections[0].kind = ATLAS_RDF_GRAPH_FILE_TERMS;
+    header.sections[0].offset = offset;
+    
+    __graph_file_terms terms_header;
+    terms_header.num_terms = num_terms;
+    terms_header.num_graph_terms = num_graph_terms;
+    write(&terms_header, sizeof(__graph_file_terms));
+    
+    for (int i=0; i<num_terms; i++) {
+        atlas_rdf_term_serialize(terms[i], ^(const void * data, uint32_t length){
+            __graph_file_term record;
+            record.length = length;
+            record.type = i < num_graph_terms ? types[i] : UINT32_MAX;
+            write(&record, sizeof(__graph_file_term));
+            write(data, length);
+            pad(8);
+        });
+    }
+    header.sections[0].length = offset - header.sections[0].offset;
+    
+    // triple section
+    pad(ATLAS_RDF_GRAPH_FILE_ALIGNMENT);
+    header.sections[1].kind = ATLAS_RDF_GRAPH_FILE_TRIPLES;
+    header.sections[1].offset = offset;
+    header.sections[1].length = triples_length;
+    write(triples, triples_length);
+    
+    if (!failed && fseek(file, 0, SEEK_SET) != 0) {
+        failed = 1;
+    }
+    write(&header, sizeof(__graph_file_header));
+    
+    if (fclose(file) != 0) {
+        failed = 1;
+    }
+    
+    if (failed) {
+        atlas_rdf_graph_file_error(err, "Could not write graph file", path);
+    }
+    
+    free(types);
+    free(triples);
+    atlas_rdf_term_dict_free(dict);
+    
+    return !failed;
+}
+
+#pragma mark -
+#pragma mark Open a RDF Graph File
+
+static atlas_rdf_graph_t
+atlas_rdf_graph_file_create(char * base,
+                            uint64_t size,
+                            const char * path,
+                            atlas_error_handler err) {
+    
+    __graph_file_header * header = (__graph_file_header *)base;
+    
+    errno = 0;
+    if (size < sizeof(__graph_file_header) ||
+        memcmp(header->magic, ATLAS_RDF_GRAPH_FILE_MAGIC, 8) != 0) {
+        atlas_rdf_graph_file_error(err, "Not a graph file", path);
+        return 0;
+    }
+    
+    if (header->byte_order != ATLAS_RDF_GRAPH_FILE_BYTE_ORDER ||
+        header->version != ATLAS_RDF_GRAPH_FILE_VERSION ||
+        header->sizeof_long != sizeof(long) ||
+        header->sizeof_time != sizeof(time_t) ||
+        header->sizeof_limb != sizeof(mp_limb_t)) {
+        atlas_rdf_graph_file_error(err, "Graph file was written on an incompatible machine", path);
+        return 0;
+    }
+    
+    // find the sections
+    __graph_file_section * terms_section = 0;
+    __graph_file_section * triples_section = 0;
+    for (uint32_t i=0; i<header->num_sections && i<ATLAS_RDF_GRAPH_FILE_MAX_SECTIONS; i++) {
+        __graph_file_section * section = &header->sections[i];
+        if (section->offset % 8 != 0 ||
+            section->offset > size ||
+            section->length > size - section->offset) {
+            atlas_rdf_graph_file_error(err, "Corrupt section in graph file", path);
+            return 0;
+        }
+        if (section->kind == ATLAS_RDF_GRAPH_FILE_TERMS) {
+            terms_section = section;
+        } else if (section->kind == ATLAS_RDF_GRAPH_FILE_TRIPLES) {
+            triples_section = section;
+        }
+    }
+    
+    if (terms_section == 0 || triples_section == 0 ||
+        terms_section->length < sizeof(__graph_file_terms) ||
+        triples_section->length < sizeof(__graph_header)) {
+        atlas_rdf_graph_file_error(err, "Missing section in graph file", path);
+        return 0;
+    }
+    
+    __graph_header * triples = (__graph_header *)(base + triples_section->offset);
+    if (triples->kind != ATLAS_RDF_GRAPH_FLAT ||
+        triples_section->length != sizeof(__graph_header) + sizeof(__graph) * (uint64_t)triples->num_statements) {
+        atlas_rdf_graph_file_error(err, "Corrupt triple section in graph file", path);
+        return 0;
+    }
+    
+    // find the term records
+    char * data = base + terms_section->offset;
+    uint64_t length = terms_section->length;
+    __graph_file_terms * terms_header = (__graph_file_terms *)data;
+    uint32_t num_terms = terms_header->num_terms;
+    uint32_t num_graph_terms = terms_header->num_graph_terms;
+    if (num_graph_terms > num_terms || num_terms > length / sizeof(__graph_file_term)) {
+        atlas_rdf_graph_file_error(err, "Corrupt term section in graph file", path);
+        return 0;
+    }
+    
+    __graph_file_term ** records = malloc(sizeof(__graph_file_term *) * (num_terms + 1));
+    atlas_rdf_term_t * terms = calloc(num_terms + 1, sizeof(atlas_rdf_term_t));
+    assert(records != 0);
+    assert(terms != 0);
+    
+    int valid = 1;
+    uint64_t position = sizeof(__graph_file_terms);
+    for (uint32_t i=0; i<num_terms && valid; i++) {
+        __graph_file_term * record = (__graph_file_term *)(data + position);
+        if (length - position < sizeof(__graph_file_term) ||
+            length - position - sizeof(__graph_file_term) < record->length ||
+            (record->type != UINT32_MAX && record->type >= num_terms)) {
+            valid = 0;
+            break;
+        }
+        records[i] = record;
+        position += (sizeof(__graph_file_term) + record->length + 7) & ~(uint64_t)7;
+    }
+    
+    // create the terms, the typed literals need their types
+    for (int pass = 0; pass < 2 && valid; pass++) {
+        for (uint32_t i=0; i<num_terms && valid; i++) {
+            __graph_file_term * record = records[i];
+            atlas_rdf_term_t type = 0;
+            if (record->type != UINT32_MAX) {
+                if (pass == 0) {
+                    continue;
+                }
+                type = terms[record->type];
+                if (type == 0) {
+                    valid = 0;
+                    break;
+                }
+            } else if (pass == 1) {
+                continue;
+            }
+            terms[i] = atlas_rdf_term_deserialize(record + 1, record->length, type, ^(int e, const char * msg){});
+            valid = terms[i] != 0;
+        }
+    }
+    
+    // the positions in the statements must refer to terms of the graph
+    __graph * statements = (__graph *)(triples + 1);
+    for (uint32_t i=0; i<triples->num_statements && valid; i++) {
+        valid = statements[i].subject < num_graph_terms &&
+                statements[i].predicate < num_graph_terms &&
+                statements[i].object < num_graph_terms;
+    }
+    
+    atlas_rdf_graph_t result = 0;
+    if (valid) {
+        // the statements are used directly from the mapping,
+        // which is removed with the graph; the mapping is
+        // private, so the data computed on demand can be kept in the header
+        memset(triples->reserved, 0, sizeof(triples->reserved));
+        result = lz_obj_new_v(triples, triples_section->length, ^{
+            atlas_rdf_graph_header_free(triples);
+            munmap(base, size);
+        }, num_graph_terms, terms);
+    } else {
+        errno = 0;
+        atlas_rdf_graph_file_error(err, "Corrupt graph file", path);
+    }
+    
+    // the terms are retained by the graph
+    for (uint32_t i=0; i<num_terms; i++) {
+        if (terms[i]) {
+            lz_release(terms[i]);
+        }
+    }
+    free(terms);
+    free(records);
+    
+    return result;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_open_file(const char * path,
+                          atlas_error_handler err) {
+    assert(path != 0);
+    
+    errno = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        atlas_rdf_graph_file_error(err, "Could not open graph file", path);
+        return 0;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        atlas_rdf_graph_file_error(err, "Could not open graph file", path);
+        close(fd);
+        return 0;
+    }
+    
+    // the mapping is private, pages are shared with the page
+    // cache (and other processes) as long as they are not written
+    uint64_t size = st.st_size;
+    void * base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        atlas_rdf_graph_file_error(err, "Could not map graph file", path);
+        return 0;
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_file_create(base, size, path, err);
+    if (result == 0) {
+        munmap(base, size);
+    }
+    return result;
+}
@@ -0,0 +1,84 @@
+/*
+ *  atlas_rdf_graph_file_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_FILE_IMPL_H_
+#define _ATLAS_RDF_GRAPH_FILE_IMPL_H_
+
+#include <atlas/rdf/graph_file.h>
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+#define ATLAS_RDF_GRAPH_FILE_MAGIC      "ATLASRDF"
+#define ATLAS_RDF_GRAPH_FILE_BYTE_ORDER 0x01020304
+#define ATLAS_RDF_GRAPH_FILE_VERSION    3
+
+// sections in a graph file are aligned to pages, so that
+// a section can be mapped on its own
+#define ATLAS_RDF_GRAPH_FILE_ALIGNMENT  4096
+
+// kinds of sections
+#define ATLAS_RDF_GRAPH_FILE_TERMS      1
+#define ATLAS_RDF_GRAPH_FILE_TRIPLES    2
+
+// maximum number of sections in a file
+#define ATLAS_RDF_GRAPH_FILE_MAX_SECTIONS 8
+
+typedef struct {
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t length;
+} __graph_file_section;
+
+typedef struct {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    
+    // sizes of the types in the term and triple sections
+    uint16_t sizeof_long;
+    uint16_t sizeof_time;
+    uint16_t sizeof_limb;
+    uint16_t reserved;
+    
+    uint32_t num_sections;
+    uint32_t reserved2;
+    __graph_file_section sections[ATLAS_RDF_GRAPH_FILE_MAX_SECTIONS];
+} __graph_file_header;
+
+// the term section starts with the number of terms, the first
+// num_graph_terms terms are the references of the triples; each
+// term is stored as a record, padded to 8 bytes
+typedef struct {
+    uint32_t num_terms;
+    uint32_t num_graph_terms;
+} __graph_file_terms;
+
+typedef struct {
+    uint32_t length;
+    
+    // position of the type of a typed literal or UINT32_MAX
+    uint32_t type;
+} __graph_file_term;
+
+#endif // _ATLAS_RDF_GRAPH_FILE_IMPL_H_
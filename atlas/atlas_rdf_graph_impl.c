@@ -22,6 +22,13 @@
  */
 
 #include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_graph_compressed_impl.h"
+#include "atlas_rdf_graph_builder_impl.h"
+#include "atlas_rdf_graph_stats_impl.h"
+#include "atlas_rdf_graph_adjacency_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_base_impl.h"
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -31,123 +38,367 @@
 
 #include <dispatch/dispatch.h>
 
-#pragma mark -
-#pragma mark Data Structure
+// minimal number of statements to create a graph in parallel
+#define ATLAS_RDF_GRAPH_PARALLEL_THRESHOLD 16384
 
-typedef struct {
-    uint16_t subject;
-    uint16_t predicate;
-    uint16_t object;
-} __graph;
+// number of partitions (and of chunks of the input) per cpu
+#define ATLAS_RDF_GRAPH_PARTITIONS_PER_CPU 4
 
 #pragma mark -
-#pragma mark Create a RDF Graph
+#pragma mark Create a RDF Graph in Parallel
 
-atlas_rdf_graph_t
-atlas_rdf_graph_create(int number_of_statements,
-                       atlas_rdf_statement_t * statements,
-                       atlas_error_handler err) {
-    
-    // calculate the amount of space needed for the result graph
-    // and allocate memory
-    int size = sizeof(__graph) * number_of_statements;
-    __graph * graph = malloc(size);
-    assert(graph != 0);
-    
-    // setup a temporary list for all tems, which are used in this graph
-    __block int num_refs = 0;
-    __block atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) * number_of_statements * 3);
-    assert(refs);
-    
-    // function to find a term in the temporary list and return its position
-    // if the term is not in the list, append it
-    int(^term_in_refs)(atlas_rdf_term_t term) = ^(atlas_rdf_term_t term){
-        // return the position in the reference list if the term exists
-        for (int i=0; i<num_refs; i++) {
-            if (atlas_rdf_term_eq(refs[i], term) != 0) { return i; }
-        }
-        
-        // term not in list
-        // add term to the list
-        refs[num_refs] = term;
-        num_refs++;
-        return num_refs - 1;
-    };
-    
-    // the number of unique statements in the graph
-    int num_graph_st = 0;
+// check the types of the subject and the predicate of a
+// statement and call the error handler if they are wrong
+static int
+atlas_rdf_graph_check_statement(atlas_rdf_statement_t stm,
+                                int loop,
+                                atlas_error_handler err) {
     
-    int error = 0;
-    
-    for (int loop = 0; loop < number_of_statements; loop++) {
-        atlas_rdf_statement_t stm = statements[loop];
-        
-        // check subject
-        if (!atlas_rdf_term_is_type(stm.subject, RESOURCE)) {
-            error = 1;
+    // check subject
+    if (!atlas_rdf_term_is_type(stm.subject, RESOURCE)) {
+        if (err) {
             char * repr = atlas_rdf_term_repr(stm.subject);
             char * buff;
             asprintf(&buff, "Subject in statement %d is not a resource: %s", loop, repr);
             err(1, buff);
             free(repr);
             free(buff);
-            break;
         }
-        
-        // check predicate
-        if (!atlas_rdf_term_is_type(stm.predicate, IRI)) {
-            error = 1;
+        return 0;
+    }
+    
+    // check predicate
+    if (!atlas_rdf_term_is_type(stm.predicate, IRI)) {
+        if (err) {
             char * repr = atlas_rdf_term_repr(stm.predicate);
             char * buff;
             asprintf(&buff, "Predicate in statement %d is not an iri: %s", loop, repr);
             err(1, buff);
             free(repr);
             free(buff);
-            break;
         }
-        
-        // add position of the terms in the reference list in the graph
-        graph[num_graph_st].subject = term_in_refs(stm.subject);
-        graph[num_graph_st].predicate = term_in_refs(stm.predicate);
-        graph[num_graph_st].object = term_in_refs(stm.object);
-
-        // avoid putting the same statement into the graph twice
-        int st_in_graph = 0;
-        for (int i=0; i < num_graph_st; i++) {
-            if (graph[i].subject == graph[num_graph_st].subject &&
-                graph[i].predicate == graph[num_graph_st].predicate &&
-                graph[i].object == graph[num_graph_st].object) {
-                st_in_graph++;
+        return 0;
+    }
+    
+    return 1;
+}
+
+// the partition of a hash value are its highest bits after
+// mixing, the lowest bits are used for the hash tables
+static inline uint32_t
+atlas_rdf_graph_partition_of(uint32_t hash, int shift) {
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return shift < 32 ? hash >> shift : 0;
+}
+
+static inline uint32_t
+atlas_rdf_graph_statement_hash(__graph stm) {
+    uint32_t hash = stm.subject * 0x9e3779b1u;
+    hash = (hash ^ (hash >> 15)) + stm.predicate * 0x85ebca77u;
+    hash = (hash ^ (hash >> 13)) + stm.object * 0xc2b2ae3du;
+    return hash ^ (hash >> 16);
+}
+
+static inline atlas_rdf_term_t
+atlas_rdf_graph_statement_term(atlas_rdf_statement_t * statements, uint32_t slot) {
+    atlas_rdf_statement_t * stm = &statements[slot / 3];
+    switch (slot % 3) {
+        case 0: return stm->subject;
+        case 1: return stm->predicate;
+        default: return stm->object;
+    }
+}
+
+// stable counting sort of the positions [0, count) by the
+// partition of their hash value, the positions of partition p
+// are at [offsets[p], offsets[p + 1]) in the result
+static uint32_t *
+atlas_rdf_graph_partition(uint32_t count,
+                          const uint32_t * hashes,
+                          int num_partitions,
+                          int shift,
+                          int num_chunks,
+                          uint32_t * offsets) {
+    uint32_t * result = malloc(sizeof(uint32_t) * (count + 1));
+    uint32_t * counts = calloc((size_t)num_chunks * num_partitions, sizeof(uint32_t));
+    assert(result != 0);
+    assert(counts != 0);
+    
+    // count the positions of each partition in each chunk
+    dispatch_apply(num_chunks, dispatch_get_global_queue(0, 0), ^(size_t c){
+        uint32_t begin = (uint64_t)count * c / num_chunks;
+        uint32_t end = (uint64_t)count * (c + 1) / num_chunks;
+        uint32_t * cnt = counts + c * num_partitions;
+        for (uint32_t i=begin; i<end; i++) {
+            cnt[atlas_rdf_graph_partition_of(hashes[i], shift)]++;
+        }
+    });
+    
+    // prefix sum over the partitions and, within a
+    // partition, over the chunks in their order
+    uint32_t pos = 0;
+    for (int p=0; p<num_partitions; p++) {
+        offsets[p] = pos;
+        for (int c=0; c<num_chunks; c++) {
+            uint32_t n = counts[c * num_partitions + p];
+            counts[c * num_partitions + p] = pos;
+            pos += n;
+        }
+    }
+    offsets[num_partitions] = pos;
+    
+    // scatter the positions of each chunk
+    dispatch_apply(num_chunks, dispatch_get_global_queue(0, 0), ^(size_t c){
+        uint32_t begin = (uint64_t)count * c / num_chunks;
+        uint32_t end = (uint64_t)count * (c + 1) / num_chunks;
+        uint32_t * next = counts + c * num_partitions;
+        for (uint32_t i=begin; i<end; i++) {
+            result[next[atlas_rdf_graph_partition_of(hashes[i], shift)]++] = i;
+        }
+    });
+    
+    free(counts);
+    return result;
+}
+
+static atlas_rdf_graph_t
+atlas_rdf_graph_create_parallel(int number_of_statements,
+                                atlas_rdf_statement_t * statements,
+                                atlas_error_handler err) {
+    uint32_t num_statements = number_of_statements;
+    uint32_t num_slots = num_statements * 3;
+    
+    // check the statements concurrently, but report the
+    // first wrong statement like the sequential check
+    __block uint32_t first_error = num_statements;
+    atlas_apply_chunked(num_statements, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end && i<first_error; i++) {
+            if (!atlas_rdf_graph_check_statement(statements[i], i, 0)) {
+                uint32_t current;
+                while ((current = first_error) > i &&
+                       !__sync_bool_compare_and_swap(&first_error, current, i));
                 break;
             }
         }
-        if (!st_in_graph) {
-            num_graph_st++;
+    }, 0);
+    if (first_error < num_statements) {
+        atlas_rdf_graph_check_statement(statements[first_error], first_error, err);
+        return 0;
+    }
+    
+    int num_chunks = atlas_num_cpus() * ATLAS_RDF_GRAPH_PARTITIONS_PER_CPU;
+    int num_partitions = 1;
+    int shift = 32;
+    while (num_partitions < num_chunks) {
+        num_partitions <<= 1;
+        shift--;
+    }
+    
+    // hash the terms of all statements, the term of the slot
+    // 3 * i + k is the k-th term of the i-th statement
+    uint32_t * hashes = malloc(sizeof(uint32_t) * num_slots);
+    uint32_t * ids = malloc(sizeof(uint32_t) * num_slots);
+    uint32_t * offsets = malloc(sizeof(uint32_t) * (num_partitions + 1));
+    assert(hashes != 0);
+    assert(ids != 0);
+    assert(offsets != 0);
+    atlas_apply_chunked(num_slots, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            hashes[i] = atlas_rdf_term_hash(atlas_rdf_graph_statement_term(statements, i));
+        }
+    }, 0);
+    
+    // partition the terms by their hash value, equal terms are in
+    // the same partition and can be deduplicated independently
+    uint32_t * slots = atlas_rdf_graph_partition(num_slots, hashes, num_partitions,
+                                                 shift, num_chunks, offsets);
+    
+    atlas_rdf_term_dict_t * dicts = malloc(sizeof(atlas_rdf_term_dict_t) * num_partitions);
+    assert(dicts != 0);
+    dispatch_apply(num_partitions, dispatch_get_global_queue(0, 0), ^(size_t p){
+        uint32_t begin = offsets[p];
+        uint32_t end = offsets[p + 1];
+        atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create((end - begin) / 4);
+        for (uint32_t i=begin; i<end; i++) {
+            uint32_t slot = slots[i];
+            ids[slot] = atlas_rdf_term_dict_insert_hashed(dict,
+                                                          atlas_rdf_graph_statement_term(statements, slot),
+                                                          hashes[slot]);
+        }
+        dicts[p] = dict;
+    });
+    free(slots);
+    
+    // the terms of the partitions are stitched together in the
+    // order of the partitions, the offset of the first term of
+    // a partition is the prefix sum of the preceding partitions
+    uint32_t num_terms = 0;
+    for (int p=0; p<num_partitions; p++) {
+        offsets[p] = num_terms;
+        num_terms += atlas_rdf_term_dict_length(dicts[p]);
+    }
+    offsets[num_partitions] = num_terms;
+    
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * (num_terms + 1));
+    assert(terms != 0);
+    dispatch_apply(num_partitions, dispatch_get_global_queue(0, 0), ^(size_t p){
+        memcpy(terms + offsets[p],
+               atlas_rdf_term_dict_terms(dicts[p]),
+               sizeof(atlas_rdf_term_t) * (offsets[p + 1] - offsets[p]));
+        atlas_rdf_term_dict_free(dicts[p]);
+    });
+    free(dicts);
+    
+    // map the statements to the final ids of their terms
+    __graph * stms = malloc(sizeof(__graph) * num_statements);
+    assert(stms != 0);
+    atlas_apply_chunked(num_statements, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            uint32_t * slot_ids = ids + 3 * i;
+            uint32_t * slot_hashes = hashes + 3 * i;
+            stms[i].subject = offsets[atlas_rdf_graph_partition_of(slot_hashes[0], shift)] + slot_ids[0];
+            stms[i].predicate = offsets[atlas_rdf_graph_partition_of(slot_hashes[1], shift)] + slot_ids[1];
+            stms[i].object = offsets[atlas_rdf_graph_partition_of(slot_hashes[2], shift)] + slot_ids[2];
+        }
+    }, 0);
+    free(ids);
+    
+    // partition the statements by their hash value, the first
+    // occurrence of each statement is kept (the partitions are
+    // stable, the positions in a partition are ascending)
+    atlas_apply_chunked(num_statements, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            hashes[i] = atlas_rdf_graph_statement_hash(stms[i]);
+        }
+    }, 0);
+    uint32_t * positions = atlas_rdf_graph_partition(num_statements, hashes, num_partitions,
+                                                     shift, num_chunks, offsets);
+    
+    char * keep = malloc(sizeof(char) * num_statements);
+    assert(keep != 0);
+    dispatch_apply(num_partitions, dispatch_get_global_queue(0, 0), ^(size_t p){
+        uint32_t begin = offsets[p];
+        uint32_t end = offsets[p + 1];
+        
+        // open addressing with linear probing, a bucket contains
+        // the position of a statement or -1 if the bucket is empty
+        uint32_t num_buckets = 16;
+        while (num_buckets < (end - begin) * 2) {
+            num_buckets <<= 1;
+        }
+        int32_t * buckets = malloc(sizeof(int32_t) * num_buckets);
+        assert(buckets != 0);
+        memset(buckets, 0xff, sizeof(int32_t) * num_buckets);
+        
+        for (uint32_t i=begin; i<end; i++) {
+            uint32_t pos = positions[i];
+            __graph stm = stms[pos];
+            uint32_t b = hashes[pos] & (num_buckets - 1);
+            keep[pos] = 1;
+            while (buckets[b] != -1) {
+                __graph other = stms[buckets[b]];
+                if (other.subject == stm.subject &&
+                    other.predicate == stm.predicate &&
+                    other.object == stm.object) {
+                    keep[pos] = 0;
+                    break;
+                }
+                b = (b + 1) & (num_buckets - 1);
+            }
+            if (keep[pos]) {
+                buckets[b] = pos;
+            }
+        }
+        
+        free(buckets);
+    });
+    free(positions);
+    free(hashes);
+    
+    // compact the distinct statements in their original order, the
+    // position of the first statement of each chunk is a prefix sum
+    uint32_t * chunk_offsets = calloc(num_chunks + 1, sizeof(uint32_t));
+    assert(chunk_offsets != 0);
+    dispatch_apply(num_chunks, dispatch_get_global_queue(0, 0), ^(size_t c){
+        uint32_t begin = (uint64_t)num_statements * c / num_chunks;
+        uint32_t end = (uint64_t)num_statements * (c + 1) / num_chunks;
+        uint32_t n = 0;
+        for (uint32_t i=begin; i<end; i++) {
+            n += keep[i];
         }
+        chunk_offsets[c + 1] = n;
+    });
+    for (int c=0; c<num_chunks; c++) {
+        chunk_offsets[c + 1] += chunk_offsets[c];
+    }
+    __graph * distinct = malloc(sizeof(__graph) * (chunk_offsets[num_chunks] + 1));
+    assert(distinct != 0);
+    dispatch_apply(num_chunks, dispatch_get_global_queue(0, 0), ^(size_t c){
+        uint32_t begin = (uint64_t)num_statements * c / num_chunks;
+        uint32_t end = (uint64_t)num_statements * (c + 1) / num_chunks;
+        uint32_t out = chunk_offsets[c];
+        for (uint32_t i=begin; i<end; i++) {
+            if (keep[i]) {
+                distinct[out++] = stms[i];
+            }
+        }
+    });
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_flat(chunk_offsets[num_chunks], distinct, num_terms, terms);
+    
+    free(distinct);
+    free(chunk_offsets);
+    free(keep);
+    free(offsets);
+    free(stms);
+    free(terms);
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Graph
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create(int number_of_statements,
+                       atlas_rdf_statement_t * statements,
+                       atlas_error_handler err) {
+    
+    // large graphs are created by one worker per cpu
+    if (number_of_statements >= ATLAS_RDF_GRAPH_PARALLEL_THRESHOLD &&
+        (uint32_t)number_of_statements <= UINT32_MAX / 3 &&
+        atlas_num_cpus() > 1) {
+        return atlas_rdf_graph_create_parallel(number_of_statements, statements, err);
     }
     
-    // resize the graph memory if needed
-    if (number_of_statements > num_graph_st) {
-        size = sizeof(__graph) * num_graph_st;
-        graph = realloc(graph, sizeof(__graph) * num_graph_st);
+    // the builder removes duplicate statements and collects the terms
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(number_of_statements);
+    
+    int error = 0;
+    
+    for (int loop = 0; loop < number_of_statements; loop++) {
+        atlas_rdf_statement_t stm = statements[loop];
+        
+        if (!atlas_rdf_graph_check_statement(stm, loop, err)) {
+            error = 1;
+            break;
+        }
+        
+        atlas_rdf_graph_builder_add(builder, stm.subject, stm.predicate, stm.object, err);
     }
     
     // an error occurred while setting up the graph
-    // free allocated memory and return 0
     // the error handler has already been called
-    if (error) {
-        free(refs);
-        free(graph);
-        return 0;
+    atlas_rdf_graph_t result = 0;
+    if (!error) {
+        result = atlas_rdf_graph_builder_commit(builder, err);
     }
     
-    // create a lazy object
-    lz_obj result = lz_obj_new_v(graph, size, ^{
-        free(graph);
-    }, num_refs, refs);
-    
-    // free the temporary list holding the references
-    free(refs);
+    atlas_rdf_graph_builder_free(builder);
     
     // return the result
     return result; 
@@ -165,95 +416,24 @@ atlas_rdf_graph_create_union(atlas_rdf_graph_t graph1,
         return lz_retain(graph1);
     }
     
-    __block atlas_rdf_graph_t result;
-    lz_obj_sync(graph1, ^(void * data1, uint32_t length1){
-        lz_obj_sync(graph2, ^(void * data2, uint32_t length2){
-            
-            // calculate the amount of space needed for the result graph
-            // and allocate memory (worst case: both graphs are distinct)
-            int size = length1 + length2;
-            __graph * graph = malloc(size);
-            assert(graph != 0);
-            
-            // number of statements in both graphs
-            int num_statements_g1 = length1 / sizeof(__graph);
-            int num_statements_g2 = length2 / sizeof(__graph);
-            
-            // number of statements in the result graph
-            __block int num_statements = 0;
-            
-            // setup a temporary list for all terms
-            // which are used in the result graph
-            __block int num_refs = 0;
-            __block atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) *
-                                                     (lz_obj_num_ref(graph1) + lz_obj_num_ref(graph2)));
-            assert(refs);
-            
-            // function to find a term in the temporary list and return its position
-            // if the term is not in the list, append it
-            int(^term_in_refs)(atlas_rdf_term_t term) = ^(atlas_rdf_term_t term){
-                // return the position in the reference list if the term exists
-                for (int i=0; i<num_refs; i++) {
-                    if (atlas_rdf_term_eq(refs[i], term) != 0) { return i; }
-                }
-                
-                // term not in list
-                // add term to the list
-                refs[num_refs] = term;
-                num_refs++;
-                return num_refs - 1;
-            };
-            
-            // function to iterate over both graphs and inserting all 'new'
-            // statements in to the result set
-            void(^statement_inter)(int num, __graph * data, atlas_rdf_graph_t g) = ^(int num, __graph * data, atlas_rdf_graph_t g){
-                for (int loop = 0; loop < num; loop++) {
-                    __graph stm = data[loop];
-                    
-                    // add position of the terms in the reference list to
-                    // the statement
-                    graph[num_statements].subject = term_in_refs(lz_obj_weak_ref(g, stm.subject));
-                    graph[num_statements].predicate = term_in_refs(lz_obj_weak_ref(g, stm.predicate));
-                    graph[num_statements].object = term_in_refs(lz_obj_weak_ref(g, stm.object));
-                    
-                    // avoid putting the same statement into the graph twice
-                    int st_in_graph = 0;
-                    for (int i=0; i < num_statements; i++) {
-                        if (graph[i].subject == graph[num_statements].subject &&
-                            graph[i].predicate == graph[num_statements].predicate &&
-                            graph[i].object == graph[num_statements].object) {
-                            st_in_graph = 1;
-                            break;
-                        }
-                    }
-                    
-                    // only increment the counter of statements in the result graph,
-                    // if the current statement in not already there
-                    if (!st_in_graph) {
-                        num_statements++;
-                    }
-                }
-            };
-            
-            // calling the iterator with both graphs
-            statement_inter(num_statements_g1, data1, graph1);
-            statement_inter(num_statements_g2, data2, graph2);
-            
-            // resize the graph memory if needed
-            if (num_statements_g1 + num_statements_g2 > num_statements) {
-                size = sizeof(__graph) * num_statements;
-                graph = realloc(graph, sizeof(__graph) * num_statements);
-            }
-            
-            // create a lazy object
-            result = lz_obj_new_v(graph, size, ^{
-                free(graph);
-            }, num_refs, refs);
-            
-            // free the temporary list holding the references
-            free(refs);
-        });
-    });
+    int length1 = atlas_rdf_graph_length(graph1);
+    int length2 = atlas_rdf_graph_length(graph2);
+    
+    // if one of the graphs is empty, return the other graph
+    if (length2 == 0) {
+        return lz_retain(graph1);
+    }
+    if (length1 == 0) {
+        return lz_retain(graph2);
+    }
+    
+    // the builder removes the statements contained in both graphs
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(length1 + length2);
+    atlas_rdf_graph_builder_add_graph(builder, graph1, 0, 0);
+    atlas_rdf_graph_builder_add_graph(builder, graph2, 0, 0);
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_builder_commit(builder, err);
+    atlas_rdf_graph_builder_free(builder);
     return result;
 }
 
@@ -264,106 +444,22 @@ atlas_rdf_graph_create_intersection(atlas_rdf_graph_t graph1,
     assert(graph1 != 0);
     assert(graph2 != 0);
     
-    __block atlas_rdf_graph_t result;
-    lz_obj_sync(graph1, ^(void * data1, uint32_t length1){
-        lz_obj_sync(graph2, ^(void * data2, uint32_t length2){
-            
-            // calculate the amount of space needed for the result garph
-            // and allocate memory (worst case: size of the smallest graph)
-            int size = length1 < length2 ? length1 : length2;
-            __graph * graph = malloc(size);
-            assert(graph != 0);
-            
-            // number of statements in both graphs
-            int num_statements_g1 = length1 / sizeof(__graph);
-            int num_statements_g2 = length2 / sizeof(__graph);
-            int num_statements_min = size / sizeof(__graph);
-            
-            // number of statements in the result graph
-            __block int num_statements = 0;
-            
-            // number of references
-            int num_ref_g1 = lz_obj_num_ref(graph1);
-            int num_ref_g2 = lz_obj_num_ref(graph2);
-            int num_ref_min = num_ref_g1 < num_ref_g2 ? num_ref_g1 : num_ref_g1;
-            
-            // number of references used in the result set
-            __block int num_refs = 0;
-            
-            // setup a temporary list for all terms
-            // which are used in the result graph
-            __block atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) * num_ref_min);
-            assert(refs);
-            
-            // function to find a term in the temporary list and return its position
-            // if the term is not in the list, append it
-            int(^term_in_refs)(atlas_rdf_term_t term) = ^(atlas_rdf_term_t term){
-                // return the position in the reference list if the term exists
-                for (int i=0; i<num_refs; i++) {
-                    if (atlas_rdf_term_eq(refs[i], term) != 0) { return i; }
-                }
-                
-                // term not in list
-                // add term to the list
-                refs[num_refs] = term;
-                num_refs++;
-                return num_refs - 1;
-            };
-            
-            
-            // iterate over the first graph and check for each
-            // statement if it is in the second graph
-            for (int o_loop = 0; o_loop < num_statements_g1; o_loop++) {
-                for (int i_loop = 0; i_loop < num_statements_g2; i_loop++) {
-                    
-                    __graph stm1 = ((__graph *)data1)[o_loop];
-                    __graph stm2 = ((__graph *)data2)[i_loop];
-                    
-                    atlas_rdf_term_t subject1 = lz_obj_weak_ref(graph1, stm1.subject);
-                    atlas_rdf_term_t subject2 = lz_obj_weak_ref(graph2, stm2.subject);
-                    if (0 == atlas_rdf_term_eq(subject1, subject2)) {
-                        break;
-                    } else {
-                        graph[num_statements].subject = term_in_refs(subject1);
-                    }
-                    
-                    atlas_rdf_term_t predicate1 = lz_obj_weak_ref(graph1, stm1.predicate);
-                    atlas_rdf_term_t predicate2 = lz_obj_weak_ref(graph2, stm2.predicate);
-                    if (0 == atlas_rdf_term_eq(predicate1, predicate2)) {
-                        break;
-                    } else {
-                        graph[num_statements].predicate = term_in_refs(predicate1);
-                    }
-                    
-                    atlas_rdf_term_t object1 = lz_obj_weak_ref(graph1, stm1.object);
-                    atlas_rdf_term_t object2 = lz_obj_weak_ref(graph2, stm2.object);
-                    if (0 == atlas_rdf_term_eq(object1, object2)) {
-                        break;
-                    } else {
-                        graph[num_statements].object = term_in_refs(object1);
-                    }
-                    
-                    // statement is in both graphs, we can incremet the
-                    // counter of statements in the result
-                    num_statements++;
-                }
-            }
-            
-            // resize the graph memory if needed
-            if (num_statements_min > num_statements) {
-                size = sizeof(__graph) * num_statements;
-                graph = realloc(graph, sizeof(__graph) * num_statements);
-            }
-            
-            // create a lazy object
-            result = lz_obj_new_v(graph, size, ^{
-                free(graph);
-            }, num_refs, refs);
-            
-            // free the temporary list holding the references
-            free(refs);
-        });
-    });
+    // if both graphs are the same, return the first graph
+    if (lz_obj_same(graph1, graph2) != 0) {
+        return lz_retain(graph1);
+    }
+    
+    // setup a hash table with the statements of the second graph
+    atlas_rdf_graph_builder_t filter = atlas_rdf_graph_builder_create(atlas_rdf_graph_length(graph2));
+    atlas_rdf_graph_builder_add_graph(filter, graph2, 0, 0);
+    
+    // add the statements of the first graph, which are in the second graph
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    atlas_rdf_graph_builder_add_graph(builder, graph1, filter, 1);
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_builder_commit(builder, err);
+    atlas_rdf_graph_builder_free(builder);
+    atlas_rdf_graph_builder_free(filter);
     return result;
 }
 
@@ -374,147 +470,268 @@ atlas_rdf_graph_create_difference(atlas_rdf_graph_t graph1,
     assert(graph1 != 0);
     assert(graph2 != 0);
     
-    __block atlas_rdf_graph_t result;
-    lz_obj_sync(graph1, ^(void * data1, uint32_t length1){
-        lz_obj_sync(graph2, ^(void * data2, uint32_t length2){
-            
-            // calculate the amount of space needed for the result graph
-            // and allocate memory (worst case: size of both graphs)
-            int size = length1 + length2;
-            __graph * graph = malloc(size);
-            assert(graph != 0);
-            
-            // number of statements in both graphs
-            int num_statements_g1 = length1 / sizeof(__graph);
-            int num_statements_g2 = length2 / sizeof(__graph);
-            int num_statements_max = size / sizeof(__graph);
-            
-            // number of statements in the result graph
-            __block int num_statements = 0;
-            
-            // number of references
-            int num_ref_g1 = lz_obj_num_ref(graph1);
-            int num_ref_g2 = lz_obj_num_ref(graph2);
-            int num_ref_max = num_ref_g1 + num_ref_g2;
-            
-            // number of references used in the result set
-            __block int num_refs = 0;
-            
-            // setup a temporary list for all terms
-            // which are used in the result graph
-            __block atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) * num_ref_max);
-            assert(refs);
-            
-            // function to find a term in the temporary list and return its position
-            // if the term is not in the list, append it
-            int(^term_in_refs)(atlas_rdf_term_t term) = ^(atlas_rdf_term_t term){
-                // return the position in the reference list if the term exists
-                for (int i=0; i<num_refs; i++) {
-                    if (atlas_rdf_term_eq(refs[i], term) != 0) { return i; }
-                }
-                
-                // term not in list
-                // add term to the list
-                refs[num_refs] = term;
-                num_refs++;
-                return num_refs - 1;
-            };
-            
-            
-            // iterate over the first graph and check for each
-            // statement if it is in the second graph
-            // if not, put it into the result set
-            // and vice versa
-            // OPTIMIZE: Find a better solution
-            for (int o_loop = 0; o_loop < num_statements_g1; o_loop++) {
-                
-                int st_in_graph2 = 0;
-                
-                __graph stm1 = ((__graph *)data1)[o_loop];
-                
-                atlas_rdf_term_t subject1 = lz_obj_weak_ref(graph1, stm1.subject);
-                atlas_rdf_term_t predicate1 = lz_obj_weak_ref(graph1, stm1.predicate);
-                atlas_rdf_term_t object1 = lz_obj_weak_ref(graph1, stm1.object);
-                
-                for (int i_loop = 0; i_loop < num_statements_g2; i_loop++) {
-                    
-                    __graph stm2 = ((__graph *)data2)[i_loop];
-                    
-                    atlas_rdf_term_t subject2 = lz_obj_weak_ref(graph2, stm2.subject);
-                    atlas_rdf_term_t predicate2 = lz_obj_weak_ref(graph2, stm2.predicate);
-                    atlas_rdf_term_t object2 = lz_obj_weak_ref(graph2, stm2.object);
-                    
-                    if (0 != atlas_rdf_term_eq(subject1, subject2)) {
-                        if (0 != atlas_rdf_term_eq(predicate1, predicate2)) {
-                            if (0 != atlas_rdf_term_eq(object1, object2)) {
-                                st_in_graph2 = 1;
-                                break;
-                            }
-                        }
-                    }
-                }
-                if (st_in_graph2 == 0) {
-                    graph[num_statements].object = term_in_refs(object1);
-                    graph[num_statements].predicate = term_in_refs(predicate1);
-                    graph[num_statements].subject = term_in_refs(subject1);
-                    num_statements++;
-                }
-            }
-            
-            for (int o_loop = 0; o_loop < num_statements_g2; o_loop++) {
-                
-                int st_in_graph1 = 0;
-                
-                __graph stm2 = ((__graph *)data2)[o_loop];
-                
-                atlas_rdf_term_t subject2 = lz_obj_weak_ref(graph2, stm2.subject);
-                atlas_rdf_term_t predicate2 = lz_obj_weak_ref(graph2, stm2.predicate);
-                atlas_rdf_term_t object2 = lz_obj_weak_ref(graph2, stm2.object);
-                
-                for (int i_loop = 0; i_loop < num_statements_g1; i_loop++) {
-                    
-                    __graph stm1 = ((__graph *)data1)[i_loop];
-                    
-                    atlas_rdf_term_t subject1 = lz_obj_weak_ref(graph1, stm1.subject);
-                    atlas_rdf_term_t predicate1 = lz_obj_weak_ref(graph1, stm1.predicate);
-                    atlas_rdf_term_t object1 = lz_obj_weak_ref(graph1, stm1.object);
-                    
-                    if (0 != atlas_rdf_term_eq(subject1, subject2)) {
-                        if (0 != atlas_rdf_term_eq(predicate1, predicate2)) {
-                            if (0 != atlas_rdf_term_eq(object1, object2)) {
-                                st_in_graph1 = 1;
-                                break;
-                            }
-                        }
-                    }
-                }
-                if (st_in_graph1 == 0) {
-                    graph[num_statements].object = term_in_refs(object2);
-                    graph[num_statements].predicate = term_in_refs(predicate2);
-                    graph[num_statements].subject = term_in_refs(subject2);
-                    num_statements++;
-                }
+    // setup a hash table with the statements of each graph
+    int length1 = atlas_rdf_graph_length(graph1);
+    int length2 = atlas_rdf_graph_length(graph2);
+    atlas_rdf_graph_builder_t filter1 = atlas_rdf_graph_builder_create(length1);
+    atlas_rdf_graph_builder_t filter2 = atlas_rdf_graph_builder_create(length2);
+    atlas_rdf_graph_builder_add_graph(filter1, graph1, 0, 0);
+    atlas_rdf_graph_builder_add_graph(filter2, graph2, 0, 0);
+    
+    // add the statements of each graph, which are not in the other graph
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(length1 + length2);
+    atlas_rdf_graph_builder_add_graph(builder, graph1, filter2, 0);
+    atlas_rdf_graph_builder_add_graph(builder, graph2, filter1, 0);
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_builder_commit(builder, err);
+    atlas_rdf_graph_builder_free(builder);
+    atlas_rdf_graph_builder_free(filter1);
+    atlas_rdf_graph_builder_free(filter2);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Graph from its Parts
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_flat(int number_of_statements,
+                            __graph * statements,
+                            int number_of_terms,
+                            atlas_rdf_term_t * terms) {
+    assert(number_of_statements >= 0);
+    
+    int size = sizeof(__graph_header) + sizeof(__graph) * number_of_statements;
+    __graph_header * header = malloc(size);
+    assert(header != 0);
+    
+    header->kind = ATLAS_RDF_GRAPH_FLAT;
+    header->num_statements = number_of_statements;
+    memset(header->reserved, 0, sizeof(header->reserved));
+    memcpy(header + 1, statements, sizeof(__graph) * number_of_statements);
+    
+    return lz_obj_new_v(header, size, ^{
+        atlas_rdf_graph_header_free(header);
+        free(header);
+    }, number_of_terms, terms);
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_chunked(int number_of_chunks,
+                               atlas_rdf_graph_t * chunks) {
+    assert(number_of_chunks >= 0);
+    
+    int size = sizeof(__graph_header) + sizeof(__graph_chunk_offset) * (number_of_chunks + 1);
+    __graph_header * header = malloc(size);
+    assert(header != 0);
+    
+    // calculate the position of the first statement of each chunk
+    __graph_chunk_offset * offsets = (__graph_chunk_offset *)(header + 1);
+    offsets[0] = 0;
+    for (int i=0; i<number_of_chunks; i++) {
+        offsets[i + 1] = offsets[i] + atlas_rdf_graph_length(chunks[i]);
+    }
+    
+    header->kind = ATLAS_RDF_GRAPH_CHUNKED;
+    header->num_statements = offsets[number_of_chunks];
+    memset(header->reserved, 0, sizeof(header->reserved));
+    
+    return lz_obj_new_v(header, size, ^{
+        atlas_rdf_graph_header_free(header);
+        free(header);
+    }, number_of_chunks, chunks);
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_subset(lz_obj owner,
+                              int number_of_statements,
+                              __graph * statements) {
+    assert(owner != 0);
+    assert(number_of_statements >= 0);
+    
+    // the ids of the owner are mapped with a
+    // hash table to consecutive ids of the graph
+    uint32_t num_buckets = 16;
+    while (num_buckets < (uint32_t)number_of_statements * 6) {
+        num_buckets <<= 1;
+    }
+    uint32_t * keys = malloc(sizeof(uint32_t) * num_buckets);
+    uint32_t * values = malloc(sizeof(uint32_t) * num_buckets);
+    __graph * mapped = malloc(sizeof(__graph) * (number_of_statements + 1));
+    atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) * (number_of_statements * 3 + 1));
+    assert(keys != 0);
+    assert(values != 0);
+    assert(mapped != 0);
+    assert(refs != 0);
+    memset(keys, 0xff, sizeof(uint32_t) * num_buckets);
+    
+    uint32_t num_refs = 0;
+    for (int i=0; i<number_of_statements; i++) {
+        uint32_t in[3] = {statements[i].subject, statements[i].predicate, statements[i].object};
+        uint32_t out[3];
+        for (int k=0; k<3; k++) {
+            uint32_t b = (in[k] * 0x9e3779b1u) & (num_buckets - 1);
+            while (keys[b] != UINT32_MAX && keys[b] != in[k]) {
+                b = (b + 1) & (num_buckets - 1);
             }
-            
-            
-            // resize the graph memory if needed
-            if (num_statements_max > num_statements) {
-                size = sizeof(__graph) * num_statements;
-                graph = realloc(graph, sizeof(__graph) * num_statements);
+            if (keys[b] == UINT32_MAX) {
+                keys[b] = in[k];
+                values[b] = num_refs;
+                refs[num_refs++] = lz_obj_weak_ref(owner, in[k]);
             }
-            
-            // create a lazy object
-            result = lz_obj_new_v(graph, size, ^{
-                free(graph);
-            }, num_refs, refs);
-            
-            // free the temporary list holding the references
-            free(refs);
-        });
+            out[k] = values[b];
+        }
+        mapped[i].subject = out[0];
+        mapped[i].predicate = out[1];
+        mapped[i].object = out[2];
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_flat(number_of_statements, mapped, num_refs, refs);
+    
+    free(keys);
+    free(values);
+    free(mapped);
+    free(refs);
+    
+    return result;
+}
+
+// the hooks are only added, a slot is taken with a compare and swap
+static void(* volatile atlas_rdf_graph_dealloc_hooks[ATLAS_RDF_GRAPH_MAX_DEALLOC_HOOKS])(const void * header);
+
+void
+atlas_rdf_graph_add_dealloc_hook(void(*hook)(const void * header)) {
+    assert(hook != 0);
+    for (int i=0; i<ATLAS_RDF_GRAPH_MAX_DEALLOC_HOOKS; i++) {
+        if (atlas_rdf_graph_dealloc_hooks[i] == hook ||
+            __sync_bool_compare_and_swap(&atlas_rdf_graph_dealloc_hooks[i], 0, hook)) {
+            return;
+        }
+    }
+    assert(0);
+}
+
+void
+atlas_rdf_graph_header_free(__graph_header * header) {
+    for (int i=0; i<ATLAS_RDF_GRAPH_MAX_DEALLOC_HOOKS && atlas_rdf_graph_dealloc_hooks[i]; i++) {
+        atlas_rdf_graph_dealloc_hooks[i](header);
+    }
+    atlas_rdf_graph_stats_free(header);
+    atlas_rdf_graph_adjacency_free(header);
+}
+
+__graph *
+atlas_rdf_graph_flatten(atlas_rdf_graph_t graph,
+                        atlas_rdf_term_dict_t dict) {
+    assert(graph != 0);
+    assert(dict != 0);
+    
+    int num_statements = atlas_rdf_graph_length(graph);
+    __graph * result = malloc(sizeof(__graph) * (num_statements + 1));
+    assert(result != 0);
+    
+    __block __graph * out = result;
+    atlas_rdf_graph_scan(graph, 0, INT32_MAX, ^(atlas_rdf_graph_t part,
+                                                __graph * statements,
+                                                int number_of_statements){
+        int num_refs = lz_obj_num_ref(part);
+        uint32_t * ids = malloc(sizeof(uint32_t) * (num_refs + 1));
+        assert(ids != 0);
+        for (int i=0; i<num_refs; i++) {
+            ids[i] = atlas_rdf_term_dict_insert(dict, lz_obj_weak_ref(part, i));
+        }
+        for (int i=0; i<number_of_statements; i++) {
+            out->subject = ids[statements[i].subject];
+            out->predicate = ids[statements[i].predicate];
+            out->object = ids[statements[i].object];
+            out++;
+        }
+        free(ids);
+    });
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Access the Parts of a RDF Graph
+
+int
+atlas_rdf_graph_num_parts(atlas_rdf_graph_t graph) {
+    assert(graph != 0);
+    __block int result;
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        __graph_header * header = data;
+        result = header->kind == ATLAS_RDF_GRAPH_CHUNKED ? lz_obj_num_ref(graph) : 1;
+    });
+    return result;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_part(atlas_rdf_graph_t graph, int index) {
+    assert(graph != 0);
+    __block atlas_rdf_graph_t result;
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        __graph_header * header = data;
+        if (header->kind == ATLAS_RDF_GRAPH_CHUNKED) {
+            result = lz_obj_weak_ref(graph, index);
+        } else {
+            assert(index == 0);
+            result = graph;
+        }
     });
     return result;
 }
 
+void
+atlas_rdf_graph_scan(atlas_rdf_graph_t graph,
+                     int begin,
+                     int end,
+                     void(^block)(atlas_rdf_graph_t part,
+                                  __graph * statements,
+                                  int number_of_statements)) {
+    assert(graph != 0);
+    assert(begin >= 0);
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        __graph_header * header = data;
+        
+        // limit the range to the length of the graph
+        int e = end > (int)header->num_statements ? (int)header->num_statements : end;
+        if (begin >= e) {
+            return;
+        }
+        
+        if (header->kind == ATLAS_RDF_GRAPH_FLAT) {
+            block(graph, (__graph *)(header + 1) + begin, e - begin);
+            return;
+        }
+        
+        if (header->kind == ATLAS_RDF_GRAPH_COMPRESSED) {
+            atlas_rdf_graph_compressed_scan(graph, header, begin, e, block);
+            return;
+        }
+        
+        __graph_chunk_offset * offsets = (__graph_chunk_offset *)(header + 1);
+        int num_chunks = lz_obj_num_ref(graph);
+        
+        // find the chunk containing the first statement of the range
+        int lo = 0;
+        int hi = num_chunks - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if ((int)offsets[mid + 1] <= begin) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        
+        for (int c = lo; c < num_chunks && (int)offsets[c] < e; c++) {
+            int chunk_begin = begin > (int)offsets[c] ? begin - (int)offsets[c] : 0;
+            int chunk_end = (e < (int)offsets[c + 1] ? e : (int)offsets[c + 1]) - (int)offsets[c];
+            atlas_rdf_graph_scan(lz_obj_weak_ref(graph, c), chunk_begin, chunk_end, block);
+        }
+    });
+}
+
 #pragma mark -
 #pragma mark Access Details of a RDF Graph
 
@@ -522,7 +739,24 @@ int
 atlas_rdf_graph_length(atlas_rdf_graph_t graph) {
     __block int result;
     lz_obj_sync(graph, ^(void * data, uint32_t length){
-        result = length / sizeof(__graph);
+        __graph_header * header = data;
+        result = header->num_statements;
+    });
+    return result;
+}
+
+size_t
+atlas_rdf_graph_memory_size(atlas_rdf_graph_t graph) {
+    assert(graph != 0);
+    __block size_t result = 0;
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        __graph_header * header = data;
+        result = length;
+        if (header->kind == ATLAS_RDF_GRAPH_CHUNKED) {
+            for (int i=0; i<lz_obj_num_ref(graph); i++) {
+                result += atlas_rdf_graph_memory_size(lz_obj_weak_ref(graph, i));
+            }
+        }
     });
     return result;
 }
@@ -532,16 +766,189 @@ atlas_rdf_graph_apply(atlas_rdf_graph_t graph,
                       void(^iterator)(atlas_rdf_term_t subject,
                                       atlas_rdf_term_t predicate,
                                       atlas_rdf_term_t object)) {
-    lz_obj_sync(graph, ^(void * data, uint32_t length){
-        __graph * g = data;
-        int num = length / sizeof(__graph);
+    int num = atlas_rdf_graph_length(graph);
+    atlas_apply_chunked(num, 0, 0, ^(void * state, size_t begin, size_t end){
+        atlas_rdf_graph_scan(graph, begin, end, ^(atlas_rdf_graph_t part,
+                                                  __graph * g,
+                                                  int number_of_statements){
+            for (int i=0; i<number_of_statements; i++) {
+                iterator(lz_obj_weak_ref(part, g[i].subject),
+                         lz_obj_weak_ref(part, g[i].predicate),
+                         lz_obj_weak_ref(part, g[i].object));
+            }
+        });
+    }, 0);
+}
+
+void
+atlas_rdf_graph_apply_chunked(atlas_rdf_graph_t graph,
+                              int grain_size,
+                              void *(^init)(void),
+                              void(^iterator)(void * state,
+                                              atlas_rdf_term_t subject,
+                                              atlas_rdf_term_t predicate,
+                                              atlas_rdf_term_t object),
+                              void(^finish)(void * state)) {
+    assert(graph != 0);
+    assert(grain_size >= 0);
+    int num = atlas_rdf_graph_length(graph);
+    atlas_apply_chunked(num, grain_size, init, ^(void * state, size_t begin, size_t end){
+        atlas_rdf_graph_scan(graph, begin, end, ^(atlas_rdf_graph_t part,
+                                                  __graph * g,
+                                                  int number_of_statements){
+            for (int i=0; i<number_of_statements; i++) {
+                iterator(state,
+                         lz_obj_weak_ref(part, g[i].subject),
+                         lz_obj_weak_ref(part, g[i].predicate),
+                         lz_obj_weak_ref(part, g[i].object));
+            }
+        });
+    }, finish);
+}
+
+void *
+atlas_rdf_graph_reduce(atlas_rdf_graph_t graph,
+                       void *(^init)(void),
+                       void *(^accumulate)(void * acc,
+                                           atlas_rdf_term_t subject,
+                                           atlas_rdf_term_t predicate,
+                                           atlas_rdf_term_t object),
+                       void *(^combine)(void * acc1, void * acc2)) {
+    assert(graph != 0);
+    int num = atlas_rdf_graph_length(graph);
+    return atlas_reduce_chunked(num, 0, init, ^(void * acc, size_t begin, size_t end){
+        __block void * result = acc;
+        atlas_rdf_graph_scan(graph, begin, end, ^(atlas_rdf_graph_t part,
+                                                  __graph * g,
+                                                  int number_of_statements){
+            for (int i=0; i<number_of_statements; i++) {
+                result = accumulate(result,
+                                    lz_obj_weak_ref(part, g[i].subject),
+                                    lz_obj_weak_ref(part, g[i].predicate),
+                                    lz_obj_weak_ref(part, g[i].object));
+            }
+        });
+        return result;
+    }, combine);
+}
+
+#pragma mark -
+#pragma mark Iterate a RDF Graph with a Cursor
+
+// number of statements fetched at once by a cursor
+#define ATLAS_RDF_GRAPH_CURSOR_BUFFER_SIZE 64
+
+struct atlas_rdf_graph_cursor_s {
+    atlas_rdf_graph_t graph;
+    
+    // range of the cursor, end is -1 until the length
+    // of the graph is known
+    int begin;
+    int end;
+    
+    // position of the next statement
+    int position;
+    
+    // statements fetched from the graph, starting at
+    // the position buffer_begin
+    int buffer_begin;
+    int buffer_length;
+    atlas_rdf_statement_t buffer[ATLAS_RDF_GRAPH_CURSOR_BUFFER_SIZE];
+};
+
+atlas_rdf_graph_cursor_t
+atlas_rdf_graph_cursor_create(atlas_rdf_graph_t graph) {
+    return atlas_rdf_graph_cursor_create_range(graph, 0, -1);
+}
+
+atlas_rdf_graph_cursor_t
+atlas_rdf_graph_cursor_create_range(atlas_rdf_graph_t graph,
+                                    int begin,
+                                    int end) {
+    assert(graph != 0);
+    assert(begin >= 0);
+    
+    atlas_rdf_graph_cursor_t cursor = malloc(sizeof(struct atlas_rdf_graph_cursor_s));
+    assert(cursor != 0);
+    
+    // the graph is accessed not before the first statement is fetched
+    cursor->graph = lz_retain(graph);
+    cursor->begin = begin;
+    cursor->end = end < begin ? (end < 0 ? -1 : begin) : end;
+    cursor->position = begin;
+    cursor->buffer_begin = 0;
+    cursor->buffer_length = 0;
+    
+    return cursor;
+}
+
+int
+atlas_rdf_graph_cursor_next(atlas_rdf_graph_cursor_t cursor,
+                            atlas_rdf_statement_t * statement) {
+    assert(cursor != 0);
+    assert(statement != 0);
+    
+    // fetch the next statements from the graph, if the
+    // position is not in the buffer
+    if (cursor->position < cursor->buffer_begin ||
+        cursor->position >= cursor->buffer_begin + cursor->buffer_length) {
+        
+        if (cursor->end != -1 && cursor->position >= cursor->end) {
+            return 0;
+        }
+        
+        // limit the range to the length of the graph
+        int num_statements = atlas_rdf_graph_length(cursor->graph);
+        if (cursor->end == -1 || cursor->end > num_statements) {
+            cursor->end = num_statements;
+        }
+        
+        int num = cursor->end - cursor->position;
+        if (num > ATLAS_RDF_GRAPH_CURSOR_BUFFER_SIZE) {
+            num = ATLAS_RDF_GRAPH_CURSOR_BUFFER_SIZE;
+        }
+        if (num < 0) {
+            num = 0;
+        }
         
-        dispatch_apply(num, dispatch_get_global_queue(0, 0), ^(size_t i){
-            iterator(lz_obj_weak_ref(graph, g[i].subject),
-                     lz_obj_weak_ref(graph, g[i].predicate),
-                     lz_obj_weak_ref(graph, g[i].object));
+        // the terms are owned by the parts of the graph,
+        // which is retained by the cursor
+        cursor->buffer_begin = cursor->position;
+        cursor->buffer_length = 0;
+        atlas_rdf_graph_scan(cursor->graph, cursor->position, cursor->position + num, ^(atlas_rdf_graph_t part,
+                                                                                        __graph * g,
+                                                                                        int number_of_statements){
+            for (int i=0; i<number_of_statements; i++) {
+                atlas_rdf_statement_t * stm = &cursor->buffer[cursor->buffer_length++];
+                stm->subject = lz_obj_weak_ref(part, g[i].subject);
+                stm->predicate = lz_obj_weak_ref(part, g[i].predicate);
+                stm->object = lz_obj_weak_ref(part, g[i].object);
+            }
         });
-    });   
+        
+        if (cursor->buffer_length == 0) {
+            return 0;
+        }
+    }
+    
+    *statement = cursor->buffer[cursor->position - cursor->buffer_begin];
+    cursor->position++;
+    
+    return 1;
+}
+
+void
+atlas_rdf_graph_cursor_reset(atlas_rdf_graph_cursor_t cursor) {
+    assert(cursor != 0);
+    cursor->position = cursor->begin;
+}
+
+void
+atlas_rdf_graph_cursor_close(atlas_rdf_graph_cursor_t cursor) {
+    if (cursor) {
+        lz_release(cursor->graph);
+        free(cursor);
+    }
 }
 
 #pragma mark -
@@ -560,25 +967,56 @@ atlas_rdf_graph_contains(atlas_rdf_graph_t graph,
     assert(object != 0);
 	
     __block int result = 0;
-    lz_obj_sync(graph, ^(void * data, uint32_t length){
-		__graph * statements = data;
-		
-		// number of statements in the given graph
-		int num_statements = length / sizeof(__graph);
-		
-		// iteratively check element-wise, whether the
-		// given graph contains a statement containing
-		// the given subject, predicate and object
-		for (int loop = 0; loop < num_statements; loop++) {
-			__graph stm = statements[loop];
-			
-			if (0 != atlas_rdf_term_eq(subject, lz_obj_weak_ref(graph, stm.subject)) &&
-				0 != atlas_rdf_term_eq(predicate, lz_obj_weak_ref(graph, stm.predicate)) &&
-				0 != atlas_rdf_term_eq(object, lz_obj_weak_ref(graph, stm.object))) {
-				result = 1;
-				break;
-			}
-		}		
-	});
-	return result;
+    int num_parts = atlas_rdf_graph_num_parts(graph);
+    for (int p = 0; p < num_parts && !result; p++) {
+        atlas_rdf_graph_t part = atlas_rdf_graph_part(graph, p);
+        
+        // find the terms in the references of the part, if one
+        // of them is not used in the part, skip the statements
+        int ids[3] = {-1, -1, -1};
+        atlas_rdf_term_t terms[3] = {subject, predicate, object};
+        int num_refs = lz_obj_num_ref(part);
+        for (int k = 0; k < 3; k++) {
+            for (int i = 0; i < num_refs; i++) {
+                if (0 != atlas_rdf_term_eq(terms[k], lz_obj_weak_ref(part, i))) {
+                    ids[k] = i;
+                    break;
+                }
+            }
+            if (ids[k] == -1) {
+                break;
+            }
+        }
+        if (ids[0] == -1 || ids[1] == -1 || ids[2] == -1) {
+            continue;
+        }
+        
+        __graph stm;
+        stm.subject = ids[0];
+        stm.predicate = ids[1];
+        stm.object = ids[2];
+        
+        lz_obj_sync(part, ^(void * data, uint32_t length){
+            __graph_header * header = data;
+            
+            // the statements of a compressed graph are sorted
+            if (header->kind == ATLAS_RDF_GRAPH_COMPRESSED) {
+                result = atlas_rdf_graph_compressed_contains(header, stm);
+                return;
+            }
+            
+            // iteratively check element-wise, whether the
+            // part contains a statement with the terms
+            __graph * statements = (__graph *)(header + 1);
+            for (uint32_t loop = 0; loop < header->num_statements; loop++) {
+                if (statements[loop].subject == stm.subject &&
+                    statements[loop].predicate == stm.predicate &&
+                    statements[loop].object == stm.object) {
+                    result = 1;
+                    break;
+                }
+            }
+        });
+    }
+    return result;
 }
@@ -26,4 +26,139 @@
 
 #include <atlas/rdf/graph.h>
 
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// the data of a graph starts with a header, which is followed
+// by the statements (flat graph), the offsets of the chunks
+// (chunked graph) or the encoded statements (compressed graph)
+#define ATLAS_RDF_GRAPH_FLAT       0
+#define ATLAS_RDF_GRAPH_CHUNKED    1
+#define ATLAS_RDF_GRAPH_COMPRESSED 2
+
+typedef struct {
+    uint32_t kind;
+    uint32_t num_statements;
+    
+    // data computed on demand and freed with the graph: the
+    // statistics (exact and estimated) and the adjacency index;
+    // the slots are 64 bit wide, so that the size of the header
+    // does not depend on the size of a pointer
+    union {
+        struct {
+            struct atlas_rdf_graph_stats_s * stats[2];
+            struct atlas_rdf_graph_adjacency_s * adjacency;
+        };
+        uint64_t reserved[3];
+    };
+} __graph_header;
+
+// a statement in the data of a flat graph, each position refers
+// to the term at that position in the references of the graph
+typedef struct {
+    uint32_t subject;
+    uint32_t predicate;
+    uint32_t object;
+} __graph;
+
+// a chunked graph refers to flat graphs (the chunks), which can be
+// shared between graphs; the header is followed by the position of
+// the first statement of each chunk and the total number of statements
+typedef uint32_t __graph_chunk_offset;
+
+#pragma mark -
+#pragma mark Create a RDF Graph from its Parts
+
+/*! Create a flat graph.
+ *
+ *  The statements are copied and refer to the given terms.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_flat(int number_of_statements,
+                            __graph * statements,
+                            int number_of_terms,
+                            atlas_rdf_term_t * terms);
+
+/*! Create a chunked graph from flat graphs.
+ *
+ *  The chunks are retained by the graph and must not
+ *  contain the same statement.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_chunked(int number_of_chunks,
+                               atlas_rdf_graph_t * chunks);
+
+/*! Create a flat graph from statements referring to the terms of an object.
+ *
+ *  The positions in the statements refer to the references of the
+ *  owner (e.g., a dataset). The graph only refers to the terms used by
+ *  the statements, which must be distinct.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_subset(lz_obj owner,
+                              int number_of_statements,
+                              __graph * statements);
+
+/*! Free the data computed on demand, which is kept in the header.
+ *
+ *  Called when the graph is removed. The dealloc hooks are
+ *  called first.
+ */
+void
+atlas_rdf_graph_header_free(__graph_header * header);
+
+#define ATLAS_RDF_GRAPH_MAX_DEALLOC_HOOKS 8
+
+/*! Add a function, which is called with the header of each graph
+ *  when the graph is removed.
+ *
+ *  Used by modules, which keep data of a graph outside of the
+ *  header (e.g., the result cache of queries). A hook is added
+ *  once and can not be removed.
+ */
+void
+atlas_rdf_graph_add_dealloc_hook(void(*hook)(const void * header));
+
+/*! Copy the statements of a graph.
+ *
+ *  The terms of the graph are inserted into the dictionary and
+ *  the positions in the statements refer to the terms in the
+ *  dictionary. The caller must free the result.
+ */
+__graph *
+atlas_rdf_graph_flatten(atlas_rdf_graph_t graph,
+                        atlas_rdf_term_dict_t dict);
+
+#pragma mark -
+#pragma mark Access the Parts of a RDF Graph
+
+/*! Number of flat or compressed graphs the graph consists of.
+ */
+int
+atlas_rdf_graph_num_parts(atlas_rdf_graph_t graph);
+
+/*! Flat or compressed graph at the given index (not retained).
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_part(atlas_rdf_graph_t graph, int index);
+
+/*! Scan the statements at the positions [begin, end) of the graph.
+ *
+ *  The block is called with consecutive runs of statements, one
+ *  for each flat graph in the range (or for each block of a
+ *  compressed graph). The positions in the statements
+ *  refer to the terms in the references of the part.
+ */
+void
+atlas_rdf_graph_scan(atlas_rdf_graph_t graph,
+                     int begin,
+                     int end,
+                     void(^block)(atlas_rdf_graph_t part,
+                                  __graph * statements,
+                                  int number_of_statements));
+
 #endif // _ATLAS_RDF_GRAPH_IMPL_H_
@@ -0,0 +1,314 @@
+/*
+ *  atlas_rdf_graph_range_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_range_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#pragma mark -
+#pragma mark Build the Range Index
+
+// an entry while the index is built
+typedef struct {
+    double value;
+    uint32_t subject;
+    uint32_t object;
+} __range_entry;
+
+static int
+atlas_rdf_graph_range_cmp(const void * a, const void * b) {
+    const __range_entry * e1 = a;
+    const __range_entry * e2 = b;
+    if (e1->value != e2->value) {
+        return e1->value < e2->value ? -1 : 1;
+    }
+    if (e1->subject != e2->subject) {
+        return e1->subject < e2->subject ? -1 : 1;
+    }
+    return e1->object < e2->object ? -1 : (e1->object > e2->object ? 1 : 0);
+}
+
+int
+atlas_rdf_graph_range_value(atlas_rdf_term_t term, double * value) {
+    int64_t integer = 0;
+    double number = 0;
+    switch (atlas_rdf_term_scalar(term, &integer, &number)) {
+        case INTEGER_LITERAL:
+        case DECIMAL_LITERAL:
+        case DOUBLE_LITERAL:
+            // NaN is not ordered and does not satisfy any range
+            if (number != number) {
+                return -1;
+            }
+            *value = number;
+            return ATLAS_RDF_GRAPH_RANGE_NUMERIC;
+        case DATETIME_LITERAL:
+            *value = integer;
+            return ATLAS_RDF_GRAPH_RANGE_DATETIME;
+        default:
+            return -1;
+    }
+}
+
+static void
+atlas_rdf_graph_range_column(__range_column * column,
+                             int domain,
+                             struct atlas_rdf_graph_adjacency_s * adjacency,
+                             uint32_t num_terms,
+                             const int8_t * domains,
+                             const double * values) {
+    __adjacency_rows * rows = &adjacency->outgoing;
+    column->offsets = calloc(num_terms + 1, sizeof(uint32_t));
+    assert(column->offsets != 0);
+    
+    // count the entries of each predicate
+    for (uint32_t s=0; s<num_terms; s++) {
+        for (uint32_t e=rows->offsets[s]; e<rows->offsets[s + 1]; e++) {
+            if (domains[rows->edges[2 * e + 1]] == domain) {
+                column->offsets[rows->edges[2 * e] + 1]++;
+            }
+        }
+    }
+    for (uint32_t i=0; i<num_terms; i++) {
+        column->offsets[i + 1] += column->offsets[i];
+    }
+    uint32_t length = column->offsets[num_terms];
+    
+    __range_entry * entries = malloc(sizeof(__range_entry) * (length + 1));
+    uint32_t * next = malloc(sizeof(uint32_t) * (num_terms + 1));
+    assert(entries != 0);
+    assert(next != 0);
+    memcpy(next, column->offsets, sizeof(uint32_t) * num_terms);
+    for (uint32_t s=0; s<num_terms; s++) {
+        for (uint32_t e=rows->offsets[s]; e<rows->offsets[s + 1]; e++) {
+            uint32_t o = rows->edges[2 * e + 1];
+            if (domains[o] == domain) {
+                __range_entry * entry = &entries[next[rows->edges[2 * e]]++];
+                entry->value = values[o];
+                entry->subject = s;
+                entry->object = o;
+            }
+        }
+    }
+    free(next);
+    
+    // sort the entries of the predicates concurrently
+    atlas_apply_chunked(num_terms, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t p=begin; p<end; p++) {
+            uint32_t first = column->offsets[p];
+            uint32_t last = column->offsets[p + 1];
+            if (last - first > 1) {
+                qsort(entries + first, last - first, sizeof(__range_entry), atlas_rdf_graph_range_cmp);
+            }
+        }
+    }, 0);
+    
+    // store the entries by column
+    uint32_t num_blocks = (length + ATLAS_RDF_GRAPH_RANGE_BLOCK - 1) / ATLAS_RDF_GRAPH_RANGE_BLOCK;
+    column->values = malloc(sizeof(double) * (length + 1));
+    column->subjects = malloc(sizeof(uint32_t) * (length + 1));
+    column->objects = malloc(sizeof(uint32_t) * (length + 1));
+    column->blocks = malloc(sizeof(double) * (num_blocks + 1));
+    assert(column->values != 0);
+    assert(column->subjects != 0);
+    assert(column->objects != 0);
+    assert(column->blocks != 0);
+    for (uint32_t i=0; i<length; i++) {
+        column->values[i] = entries[i].value;
+        column->subjects[i] = entries[i].subject;
+        column->objects[i] = entries[i].object;
+    }
+    for (uint32_t k=0; k<num_blocks; k++) {
+        column->blocks[k] = column->values[k * ATLAS_RDF_GRAPH_RANGE_BLOCK];
+    }
+    free(entries);
+}
+
+struct atlas_rdf_graph_range_s *
+atlas_rdf_graph_range_index(atlas_rdf_graph_t graph) {
+    struct atlas_rdf_graph_adjacency_s * adjacency = atlas_rdf_graph_adjacency(graph);
+    if (adjacency->range) {
+        return adjacency->range;
+    }
+    
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(adjacency->dict);
+    uint32_t num_terms = atlas_rdf_term_dict_length(adjacency->dict);
+    
+    // the domain and value of each term (read once)
+    int8_t * domains = malloc(sizeof(int8_t) * (num_terms + 1));
+    double * values = malloc(sizeof(double) * (num_terms + 1));
+    assert(domains != 0);
+    assert(values != 0);
+    atlas_apply_chunked(num_terms, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            domains[i] = atlas_rdf_graph_range_value(terms[i], &values[i]);
+        }
+    }, 0);
+    
+    struct atlas_rdf_graph_range_s * range = malloc(sizeof(struct atlas_rdf_graph_range_s));
+    assert(range != 0);
+    for (int domain=0; domain<2; domain++) {
+        atlas_rdf_graph_range_column(&range->columns[domain], domain, adjacency, num_terms, domains, values);
+    }
+    free(domains);
+    free(values);
+    
+    // the index is built without a lock, if two threads
+    // build it at the same time, the first one is kept
+    if (!__sync_bool_compare_and_swap(&adjacency->range, 0, range)) {
+        atlas_rdf_graph_range_free(range);
+        range = adjacency->range;
+    }
+    return range;
+}
+
+void
+atlas_rdf_graph_range_free(struct atlas_rdf_graph_range_s * range) {
+    for (int domain=0; domain<2; domain++) {
+        __range_column * column = &range->columns[domain];
+        free(column->offsets);
+        free(column->values);
+        free(column->subjects);
+        free(column->objects);
+        free(column->blocks);
+    }
+    free(range);
+}
+
+#pragma mark -
+#pragma mark Search the Range Index
+
+// the first position in [begin, end) with a value >= value (or > value,
+// if after), the block values narrow the range before the binary search
+static uint32_t
+atlas_rdf_graph_range_bound(__range_column * column,
+                            uint32_t begin,
+                            uint32_t end,
+                            double value,
+                            int after) {
+    uint32_t lo = begin;
+    uint32_t hi = end;
+    
+    // the blocks starting in [begin, end)
+    uint32_t kb = (begin + ATLAS_RDF_GRAPH_RANGE_BLOCK - 1) / ATLAS_RDF_GRAPH_RANGE_BLOCK;
+    uint32_t ke = end > 0 ? (end - 1) / ATLAS_RDF_GRAPH_RANGE_BLOCK + 1 : 0;
+    if (kb < ke) {
+        // the first block with a value >= value
+        uint32_t l = kb;
+        uint32_t h = ke;
+        while (l < h) {
+            uint32_t m = l + (h - l) / 2;
+            double v = column->blocks[m];
+            if (after ? v <= value : v < value) {
+                l = m + 1;
+            } else {
+                h = m;
+            }
+        }
+        if (l < ke) {
+            hi = l * ATLAS_RDF_GRAPH_RANGE_BLOCK;
+        }
+        if (l > kb) {
+            lo = (l - 1) * ATLAS_RDF_GRAPH_RANGE_BLOCK;
+        }
+    }
+    
+    while (lo < hi) {
+        uint32_t m = lo + (hi - lo) / 2;
+        double v = column->values[m];
+        if (after ? v <= value : v < value) {
+            lo = m + 1;
+        } else {
+            hi = m;
+        }
+    }
+    return lo;
+}
+
+void
+atlas_rdf_graph_range_span(struct atlas_rdf_graph_range_s * range,
+                           int domain,
+                           uint32_t predicate,
+                           double min,
+                           double max,
+                           int flags,
+                           uint32_t * begin,
+                           uint32_t * end) {
+    __range_column * column = &range->columns[domain];
+    uint32_t first = column->offsets[predicate];
+    uint32_t last = column->offsets[predicate + 1];
+    *begin = atlas_rdf_graph_range_bound(column, first, last, min, flags & ATLAS_RDF_RANGE_EXCLUDE_MIN);
+    *end = atlas_rdf_graph_range_bound(column, *begin, last, max, !(flags & ATLAS_RDF_RANGE_EXCLUDE_MAX));
+}
+
+#pragma mark -
+#pragma mark Select Statements by the Value of the Object
+
+int
+atlas_rdf_graph_range(atlas_rdf_graph_t graph,
+                      atlas_rdf_term_t predicate,
+                      atlas_rdf_term_t min,
+                      atlas_rdf_term_t max,
+                      int flags,
+                      void(^iterator)(atlas_rdf_term_t subject,
+                                      atlas_rdf_term_t object)) {
+    assert(graph != 0);
+    assert(predicate != 0);
+    assert(min != 0 || max != 0);
+    
+    // the bounds must be of the same domain
+    double lower = -HUGE_VAL;
+    double upper = HUGE_VAL;
+    int domain = min ? atlas_rdf_graph_range_value(min, &lower) : -1;
+    if (max) {
+        int other = atlas_rdf_graph_range_value(max, &upper);
+        if (min && other != domain) {
+            return 0;
+        }
+        domain = other;
+    }
+    if (domain == -1) {
+        return 0;
+    }
+    
+    struct atlas_rdf_graph_adjacency_s * adjacency = atlas_rdf_graph_adjacency(graph);
+    int id = atlas_rdf_term_dict_lookup(adjacency->dict, predicate);
+    if (id == -1) {
+        return 0;
+    }
+    
+    struct atlas_rdf_graph_range_s * range = atlas_rdf_graph_range_index(graph);
+    uint32_t begin, end;
+    atlas_rdf_graph_range_span(range, domain, id, lower, upper, flags, &begin, &end);
+    if (iterator) {
+        __range_column * column = &range->columns[domain];
+        atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(adjacency->dict);
+        for (uint32_t i=begin; i<end; i++) {
+            iterator(terms[column->subjects[i]], terms[column->objects[i]]);
+        }
+    }
+    return end - begin;
+}
@@ -0,0 +1,100 @@
+/*
+ *  atlas_rdf_graph_range_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_RANGE_IMPL_H_
+#define _ATLAS_RDF_GRAPH_RANGE_IMPL_H_
+
+#include <atlas/rdf/graph.h>
+
+#include "atlas_rdf_graph_adjacency_impl.h"
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// the values of literals are indexed in two domains,
+// which can not be compared with each other
+#define ATLAS_RDF_GRAPH_RANGE_NUMERIC  0
+#define ATLAS_RDF_GRAPH_RANGE_DATETIME 1
+
+// number of entries summarized by the first value of a block
+#define ATLAS_RDF_GRAPH_RANGE_BLOCK 64
+
+// the statements with an object of the domain, grouped by their
+// predicate (the entries of the predicate with the id i are at
+// [offsets[i], offsets[i + 1])) and sorted by the value of the object;
+// blocks contains the value of every ATLAS_RDF_GRAPH_RANGE_BLOCK-th entry
+typedef struct {
+    uint32_t * offsets;
+    double * values;
+    uint32_t * subjects;
+    uint32_t * objects;
+    double * blocks;
+} __range_column;
+
+// the ids are the ids of the adjacency index
+struct atlas_rdf_graph_range_s {
+    __range_column columns[2];
+};
+
+#pragma mark -
+#pragma mark Access the Range Index
+
+/*! Range index of a graph.
+ *
+ *  The index is built on first use and kept with
+ *  the adjacency index of the graph.
+ */
+struct atlas_rdf_graph_range_s *
+atlas_rdf_graph_range_index(atlas_rdf_graph_t graph);
+
+/*! Free a range index.
+ *
+ *  Called when the adjacency index is freed.
+ */
+void
+atlas_rdf_graph_range_free(struct atlas_rdf_graph_range_s * range);
+
+/*! The domain and value of a term for the range index.
+ *
+ *  \return The domain or -1, if the term is not a numeric
+ *          or datetime literal.
+ */
+int
+atlas_rdf_graph_range_value(atlas_rdf_term_t term, double * value);
+
+/*! The entries of a predicate with a value in a range.
+ *
+ *  The entries are at the positions [*begin, *end) of the column
+ *  of the domain. The bounds are included unless the flags
+ *  ATLAS_RDF_RANGE_EXCLUDE_MIN or ATLAS_RDF_RANGE_EXCLUDE_MAX are set.
+ */
+void
+atlas_rdf_graph_range_span(struct atlas_rdf_graph_range_s * range,
+                           int domain,
+                           uint32_t predicate,
+                           double min,
+                           double max,
+                           int flags,
+                           uint32_t * begin,
+                           uint32_t * end);
+
+#endif // _ATLAS_RDF_GRAPH_RANGE_IMPL_H_
@@ -0,0 +1,454 @@
+/*
+ *  atlas_rdf_graph_stats_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_stats_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// number of bits of a hash used to select the register of
+// a sketch (the standard error is 1.04 / sqrt(2^bits))
+#define ATLAS_RDF_GRAPH_STATS_SKETCH_BITS 12
+#define ATLAS_RDF_GRAPH_STATS_SKETCH_SIZE (1 << ATLAS_RDF_GRAPH_STATS_SKETCH_BITS)
+
+typedef struct {
+    atlas_rdf_term_t predicate;
+    uint64_t num_statements;
+    uint64_t num_subjects;
+    uint64_t num_objects;
+} __stats_predicate;
+
+struct atlas_rdf_graph_stats_s {
+    int approximate;
+    uint64_t num_statements;
+    uint64_t num_subjects;
+    uint64_t num_objects;
+    
+    // the predicates sorted by the number of statements (and
+    // by the terms), the ids in the dictionary are the positions
+    int num_predicates;
+    __stats_predicate * predicates;
+    atlas_rdf_term_dict_t index;
+};
+
+// distinct terms, either collected in a dictionary or
+// estimated with a HyperLogLog sketch
+typedef struct {
+    atlas_rdf_term_dict_t dict;
+    uint8_t * sketch;
+} __stats_distinct;
+
+// accumulator of a worker, the terms are not retained
+// and kept alive by the graph
+typedef struct {
+    int approximate;
+    uint64_t num_statements;
+    
+    atlas_rdf_term_dict_t predicates;
+    int max_predicates;
+    uint64_t * counts;
+    __stats_distinct * subjects;
+    __stats_distinct * objects;
+    
+    __stats_distinct all_subjects;
+    __stats_distinct all_objects;
+} __stats_acc;
+
+#pragma mark -
+#pragma mark Distinct Terms
+
+static void
+atlas_rdf_graph_stats_distinct_init(__stats_distinct * distinct, int approximate) {
+    if (approximate) {
+        distinct->dict = 0;
+        distinct->sketch = calloc(ATLAS_RDF_GRAPH_STATS_SKETCH_SIZE, 1);
+        assert(distinct->sketch != 0);
+    } else {
+        distinct->dict = atlas_rdf_term_dict_create(0);
+        distinct->sketch = 0;
+    }
+}
+
+static void
+atlas_rdf_graph_stats_distinct_free(__stats_distinct * distinct) {
+    atlas_rdf_term_dict_free(distinct->dict);
+    free(distinct->sketch);
+}
+
+static void
+atlas_rdf_graph_stats_distinct_add(__stats_distinct * distinct,
+                                   atlas_rdf_term_t term,
+                                   uint32_t hash) {
+    if (distinct->dict) {
+        atlas_rdf_term_dict_insert_hashed(distinct->dict, term, hash);
+        return;
+    }
+    
+    // the hash of a term is mixed (murmur3 finalizer), the first bits
+    // select the register, which keeps the maximal position of the
+    // first one in the remaining bits
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    uint32_t index = hash >> (32 - ATLAS_RDF_GRAPH_STATS_SKETCH_BITS);
+    uint32_t rest = hash << ATLAS_RDF_GRAPH_STATS_SKETCH_BITS;
+    uint8_t rank = rest ? __builtin_clz(rest) + 1 : 32 - ATLAS_RDF_GRAPH_STATS_SKETCH_BITS + 1;
+    if (rank > distinct->sketch[index]) {
+        distinct->sketch[index] = rank;
+    }
+}
+
+// merge the second into the first and free the second
+static void
+atlas_rdf_graph_stats_distinct_merge(__stats_distinct * distinct,
+                                     __stats_distinct * other) {
+    if (distinct->dict) {
+        // insert the terms of the smaller dictionary
+        if (atlas_rdf_term_dict_length(other->dict) > atlas_rdf_term_dict_length(distinct->dict)) {
+            atlas_rdf_term_dict_t tmp = distinct->dict;
+            distinct->dict = other->dict;
+            other->dict = tmp;
+        }
+        int num_terms = atlas_rdf_term_dict_length(other->dict);
+        atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(other->dict);
+        for (int i=0; i<num_terms; i++) {
+            atlas_rdf_term_dict_insert(distinct->dict, terms[i]);
+        }
+    } else {
+        for (int i=0; i<ATLAS_RDF_GRAPH_STATS_SKETCH_SIZE; i++) {
+            if (other->sketch[i] > distinct->sketch[i]) {
+                distinct->sketch[i] = other->sketch[i];
+            }
+        }
+    }
+    atlas_rdf_graph_stats_distinct_free(other);
+    other->dict = 0;
+    other->sketch = 0;
+}
+
+static uint64_t
+atlas_rdf_graph_stats_distinct_count(__stats_distinct * distinct) {
+    if (distinct->dict) {
+        return atlas_rdf_term_dict_length(distinct->dict);
+    }
+    
+    double m = ATLAS_RDF_GRAPH_STATS_SKETCH_SIZE;
+    double sum = 0;
+    int zeros = 0;
+    for (int i=0; i<ATLAS_RDF_GRAPH_STATS_SKETCH_SIZE; i++) {
+        sum += ldexp(1.0, -distinct->sketch[i]);
+        zeros += distinct->sketch[i] == 0;
+    }
+    double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+    
+    // use linear counting for small cardinalities
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);
+    }
+    return (uint64_t)(estimate + 0.5);
+}
+
+#pragma mark -
+#pragma mark Accumulator
+
+static __stats_acc *
+atlas_rdf_graph_stats_acc_create(int approximate) {
+    __stats_acc * acc = calloc(1, sizeof(__stats_acc));
+    assert(acc != 0);
+    acc->approximate = approximate;
+    acc->predicates = atlas_rdf_term_dict_create(0);
+    atlas_rdf_graph_stats_distinct_init(&acc->all_subjects, approximate);
+    atlas_rdf_graph_stats_distinct_init(&acc->all_objects, approximate);
+    return acc;
+}
+
+static void
+atlas_rdf_graph_stats_acc_free(__stats_acc * acc) {
+    int num_predicates = atlas_rdf_term_dict_length(acc->predicates);
+    for (int i=0; i<num_predicates; i++) {
+        atlas_rdf_graph_stats_distinct_free(&acc->subjects[i]);
+        atlas_rdf_graph_stats_distinct_free(&acc->objects[i]);
+    }
+    atlas_rdf_graph_stats_distinct_free(&acc->all_subjects);
+    atlas_rdf_graph_stats_distinct_free(&acc->all_objects);
+    atlas_rdf_term_dict_free(acc->predicates);
+    free(acc->counts);
+    free(acc->subjects);
+    free(acc->objects);
+    free(acc);
+}
+
+// position of a predicate in the accumulator, a new
+// predicate is added
+static int
+atlas_rdf_graph_stats_acc_predicate(__stats_acc * acc,
+                                    atlas_rdf_term_t predicate,
+                                    uint32_t hash) {
+    int num_predicates = atlas_rdf_term_dict_length(acc->predicates);
+    int index = atlas_rdf_term_dict_insert_hashed(acc->predicates, predicate, hash);
+    if (index < num_predicates) {
+        return index;
+    }
+    
+    if (index >= acc->max_predicates) {
+        acc->max_predicates = acc->max_predicates ? acc->max_predicates * 2 : 16;
+        acc->counts = realloc(acc->counts, sizeof(uint64_t) * acc->max_predicates);
+        acc->subjects = realloc(acc->subjects, sizeof(__stats_distinct) * acc->max_predicates);
+        acc->objects = realloc(acc->objects, sizeof(__stats_distinct) * acc->max_predicates);
+        assert(acc->counts && acc->subjects && acc->objects);
+    }
+    acc->counts[index] = 0;
+    atlas_rdf_graph_stats_distinct_init(&acc->subjects[index], acc->approximate);
+    atlas_rdf_graph_stats_distinct_init(&acc->objects[index], acc->approximate);
+    return index;
+}
+
+static void
+atlas_rdf_graph_stats_acc_add(__stats_acc * acc,
+                              atlas_rdf_term_t subject,
+                              atlas_rdf_term_t predicate,
+                              atlas_rdf_term_t object) {
+    uint32_t subject_hash = atlas_rdf_term_hash(subject);
+    uint32_t object_hash = atlas_rdf_term_hash(object);
+    int p = atlas_rdf_graph_stats_acc_predicate(acc, predicate, atlas_rdf_term_hash(predicate));
+    
+    acc->num_statements++;
+    acc->counts[p]++;
+    atlas_rdf_graph_stats_distinct_add(&acc->subjects[p], subject, subject_hash);
+    atlas_rdf_graph_stats_distinct_add(&acc->objects[p], object, object_hash);
+    atlas_rdf_graph_stats_distinct_add(&acc->all_subjects, subject, subject_hash);
+    atlas_rdf_graph_stats_distinct_add(&acc->all_objects, object, object_hash);
+}
+
+// merge the second into the first and free the second
+static __stats_acc *
+atlas_rdf_graph_stats_acc_merge(__stats_acc * acc, __stats_acc * other) {
+    int num_predicates = atlas_rdf_term_dict_length(other->predicates);
+    atlas_rdf_term_t * predicates = atlas_rdf_term_dict_terms(other->predicates);
+    for (int i=0; i<num_predicates; i++) {
+        int p = atlas_rdf_graph_stats_acc_predicate(acc, predicates[i], atlas_rdf_term_hash(predicates[i]));
+        acc->counts[p] += other->counts[i];
+        atlas_rdf_graph_stats_distinct_merge(&acc->subjects[p], &other->subjects[i]);
+        atlas_rdf_graph_stats_distinct_merge(&acc->objects[p], &other->objects[i]);
+    }
+    acc->num_statements += other->num_statements;
+    atlas_rdf_graph_stats_distinct_merge(&acc->all_subjects, &other->all_subjects);
+    atlas_rdf_graph_stats_distinct_merge(&acc->all_objects, &other->all_objects);
+    atlas_rdf_graph_stats_acc_free(other);
+    return acc;
+}
+
+#pragma mark -
+#pragma mark Compute the Statistics of a RDF Graph
+
+static int
+atlas_rdf_graph_stats_predicate_cmp(const void * a, const void * b) {
+    const __stats_predicate * p1 = a;
+    const __stats_predicate * p2 = b;
+    if (p1->num_statements != p2->num_statements) {
+        return p1->num_statements > p2->num_statements ? -1 : 1;
+    }
+    // the ids of the accumulated predicates depend on the order
+    // in which the workers are merged, ties are broken by the terms
+    return atlas_rdf_term_order(p1->predicate, p2->predicate);
+}
+
+static struct atlas_rdf_graph_stats_s *
+atlas_rdf_graph_stats_compute(atlas_rdf_graph_t graph, int approximate) {
+    
+    __stats_acc * acc = atlas_rdf_graph_reduce(graph, ^{
+        return (void *)atlas_rdf_graph_stats_acc_create(approximate);
+    }, ^(void * acc, atlas_rdf_term_t subject, atlas_rdf_term_t predicate, atlas_rdf_term_t object){
+        atlas_rdf_graph_stats_acc_add(acc, subject, predicate, object);
+        return acc;
+    }, ^(void * acc1, void * acc2){
+        return (void *)atlas_rdf_graph_stats_acc_merge(acc1, acc2);
+    });
+    
+    struct atlas_rdf_graph_stats_s * stats = malloc(sizeof(struct atlas_rdf_graph_stats_s));
+    assert(stats != 0);
+    stats->approximate = approximate;
+    stats->num_statements = acc->num_statements;
+    stats->num_subjects = atlas_rdf_graph_stats_distinct_count(&acc->all_subjects);
+    stats->num_objects = atlas_rdf_graph_stats_distinct_count(&acc->all_objects);
+    
+    int num_predicates = atlas_rdf_term_dict_length(acc->predicates);
+    atlas_rdf_term_t * predicates = atlas_rdf_term_dict_terms(acc->predicates);
+    stats->num_predicates = num_predicates;
+    stats->predicates = malloc(sizeof(__stats_predicate) * (num_predicates + 1));
+    assert(stats->predicates != 0);
+    for (int i=0; i<num_predicates; i++) {
+        __stats_predicate * p = &stats->predicates[i];
+        p->predicate = predicates[i];
+        p->num_statements = acc->counts[i];
+        p->num_subjects = atlas_rdf_graph_stats_distinct_count(&acc->subjects[i]);
+        p->num_objects = atlas_rdf_graph_stats_distinct_count(&acc->objects[i]);
+    }
+    qsort(stats->predicates, num_predicates, sizeof(__stats_predicate), atlas_rdf_graph_stats_predicate_cmp);
+    
+    stats->index = atlas_rdf_term_dict_create(num_predicates);
+    for (int i=0; i<num_predicates; i++) {
+        atlas_rdf_term_dict_insert(stats->index, stats->predicates[i].predicate);
+    }
+    
+    atlas_rdf_graph_stats_acc_free(acc);
+    return stats;
+}
+
+atlas_rdf_graph_stats_t
+atlas_rdf_graph_stats(atlas_rdf_graph_t graph,
+                      int options) {
+    assert(graph != 0);
+    
+    int approximate = (options & ATLAS_RDF_GRAPH_STATS_APPROXIMATE) != 0;
+    __block __graph_header * header;
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        header = data;
+    });
+    
+    // exact statistics can be used instead of estimated ones
+    if (header->stats[0]) {
+        return header->stats[0];
+    }
+    if (approximate && header->stats[1]) {
+        return header->stats[1];
+    }
+    
+    // the statistics are computed without a lock, if two threads
+    // compute them at the same time, the first result is kept
+    struct atlas_rdf_graph_stats_s * stats = atlas_rdf_graph_stats_compute(graph, approximate);
+    if (!__sync_bool_compare_and_swap(&header->stats[approximate], 0, stats)) {
+        atlas_rdf_term_dict_free(stats->index);
+        free(stats->predicates);
+        free(stats);
+        stats = header->stats[approximate];
+    }
+    return stats;
+}
+
+void
+atlas_rdf_graph_stats_free(__graph_header * header) {
+    for (int i=0; i<2; i++) {
+        struct atlas_rdf_graph_stats_s * stats = header->stats[i];
+        if (stats) {
+            atlas_rdf_term_dict_free(stats->index);
+            free(stats->predicates);
+            free(stats);
+        }
+    }
+}
+
+int
+atlas_rdf_graph_stats_is_approximate(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->approximate;
+}
+
+#pragma mark -
+#pragma mark Access the Statistics of a RDF Graph
+
+uint64_t
+atlas_rdf_graph_stats_num_statements(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->num_statements;
+}
+
+uint64_t
+atlas_rdf_graph_stats_num_subjects(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->num_subjects;
+}
+
+uint64_t
+atlas_rdf_graph_stats_num_predicates(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->num_predicates;
+}
+
+uint64_t
+atlas_rdf_graph_stats_num_objects(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->num_objects;
+}
+
+double
+atlas_rdf_graph_stats_avg_out_degree(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->num_subjects ? (double)stats->num_statements / stats->num_subjects : 0;
+}
+
+double
+atlas_rdf_graph_stats_avg_in_degree(atlas_rdf_graph_stats_t stats) {
+    assert(stats != 0);
+    return stats->num_objects ? (double)stats->num_statements / stats->num_objects : 0;
+}
+
+#pragma mark -
+#pragma mark Access the Statistics of the Predicates
+
+int
+atlas_rdf_graph_stats_predicate_index(atlas_rdf_graph_stats_t stats,
+                                      atlas_rdf_term_t predicate) {
+    assert(stats != 0);
+    assert(predicate != 0);
+    return atlas_rdf_term_dict_lookup(stats->index, predicate);
+}
+
+atlas_rdf_term_t
+atlas_rdf_graph_stats_predicate(atlas_rdf_graph_stats_t stats,
+                                int index) {
+    assert(stats != 0);
+    assert(index >= 0 && index < stats->num_predicates);
+    return stats->predicates[index].predicate;
+}
+
+uint64_t
+atlas_rdf_graph_stats_predicate_statements(atlas_rdf_graph_stats_t stats,
+                                           int index) {
+    assert(stats != 0);
+    assert(index >= 0 && index < stats->num_predicates);
+    return stats->predicates[index].num_statements;
+}
+
+uint64_t
+atlas_rdf_graph_stats_predicate_subjects(atlas_rdf_graph_stats_t stats,
+                                         int index) {
+    assert(stats != 0);
+    assert(index >= 0 && index < stats->num_predicates);
+    return stats->predicates[index].num_subjects;
+}
+
+uint64_t
+atlas_rdf_graph_stats_predicate_objects(atlas_rdf_graph_stats_t stats,
+                                        int index) {
+    assert(stats != 0);
+    assert(index >= 0 && index < stats->num_predicates);
+    return stats->predicates[index].num_objects;
+}
@@ -0,0 +1,35 @@
+/*
+ *  atlas_rdf_graph_stats_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_STATS_IMPL_H_
+#define _ATLAS_RDF_GRAPH_STATS_IMPL_H_
+
+#include <atlas/rdf/graph_stats.h>
+
+#include "atlas_rdf_graph_impl.h"
+
+/*! Free the statistics kept in the header of a graph.
+ *
+ *  Called when the graph is removed.
+ */
+void
+atlas_rdf_graph_stats_free(__graph_header * header);
+
+#endif // _ATLAS_RDF_GRAPH_STATS_IMPL_H_
@@ -0,0 +1,356 @@
+/*
+ *  atlas_rdf_graph_text_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_graph_text_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Trigrams
+
+static inline unsigned char
+atlas_rdf_graph_text_fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+// the trigram at the beginning of a string (at least 3 characters)
+static inline uint32_t
+atlas_rdf_graph_text_gram(const char * s) {
+    return ((uint32_t)atlas_rdf_graph_text_fold(s[0]) << 16) |
+           ((uint32_t)atlas_rdf_graph_text_fold(s[1]) << 8) |
+           (uint32_t)atlas_rdf_graph_text_fold(s[2]);
+}
+
+static int
+atlas_rdf_graph_text_cmp(const void * a, const void * b) {
+    uint64_t k1 = *(const uint64_t *)a;
+    uint64_t k2 = *(const uint64_t *)b;
+    return k1 < k2 ? -1 : (k1 > k2 ? 1 : 0);
+}
+
+#pragma mark -
+#pragma mark Build the Text Index
+
+struct atlas_rdf_graph_text_s *
+atlas_rdf_graph_text_index(atlas_rdf_graph_t graph) {
+    struct atlas_rdf_graph_adjacency_s * adjacency = atlas_rdf_graph_adjacency(graph);
+    if (adjacency->text) {
+        return adjacency->text;
+    }
+    
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(adjacency->dict);
+    uint32_t num_terms = atlas_rdf_term_dict_length(adjacency->dict);
+    
+    // the values and languages of the string literals (read once)
+    char ** values = calloc(num_terms + 1, sizeof(char *));
+    char ** languages = calloc(num_terms + 1, sizeof(char *));
+    assert(values != 0);
+    assert(languages != 0);
+    atlas_apply_chunked(num_terms, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            if (atlas_rdf_term_type(terms[i]) == STRING_LITERAL) {
+                values[i] = atlas_rdf_term_literal_value(terms[i]);
+                languages[i] = atlas_rdf_term_string_lang(terms[i]);
+            }
+        }
+    }, 0);
+    
+    struct atlas_rdf_graph_text_s * text = malloc(sizeof(struct atlas_rdf_graph_text_s));
+    assert(text != 0);
+    
+    uint32_t num_literals = 0;
+    size_t size = 0;
+    uint64_t num_keys = 0;
+    for (uint32_t i=0; i<num_terms; i++) {
+        if (values[i]) {
+            size_t length = strlen(values[i]);
+            size += length + strlen(languages[i]) + 2;
+            num_keys += length > 2 ? length - 2 : 0;
+            num_literals++;
+        }
+    }
+    assert(size < UINT32_MAX);
+    
+    text->num_literals = num_literals;
+    text->ids = malloc(sizeof(uint32_t) * (num_literals + 1));
+    text->values = malloc(sizeof(uint32_t) * (num_literals + 1));
+    text->languages = malloc(sizeof(uint32_t) * (num_literals + 1));
+    text->text = malloc(size + 1);
+    assert(text->ids != 0);
+    assert(text->values != 0);
+    assert(text->languages != 0);
+    assert(text->text != 0);
+    
+    // the trigrams of each literal as (trigram, literal)
+    uint64_t * keys = malloc(sizeof(uint64_t) * (num_keys + 1));
+    assert(keys != 0);
+    
+    uint32_t l = 0;
+    uint32_t position = 0;
+    uint64_t k = 0;
+    for (uint32_t i=0; i<num_terms; i++) {
+        if (values[i] == 0) {
+            continue;
+        }
+        size_t length = strlen(values[i]);
+        text->ids[l] = i;
+        text->values[l] = position;
+        memcpy(text->text + position, values[i], length + 1);
+        for (size_t j=0; j + 2<length; j++) {
+            keys[k++] = ((uint64_t)atlas_rdf_graph_text_gram(values[i] + j) << 32) | l;
+        }
+        position += length + 1;
+        
+        length = strlen(languages[i]);
+        text->languages[l] = position;
+        memcpy(text->text + position, languages[i], length + 1);
+        position += length + 1;
+        
+        free(values[i]);
+        free(languages[i]);
+        l++;
+    }
+    free(values);
+    free(languages);
+    
+    // group the literals by trigram, a literal is
+    // listed once, even if it contains a trigram twice
+    qsort(keys, num_keys, sizeof(uint64_t), atlas_rdf_graph_text_cmp);
+    uint32_t num_grams = 0;
+    uint32_t num_postings = 0;
+    for (uint64_t i=0; i<num_keys; i++) {
+        if (i == 0 || keys[i] != keys[i - 1]) {
+            num_postings++;
+            if (i == 0 || (keys[i] >> 32) != (keys[i - 1] >> 32)) {
+                num_grams++;
+            }
+        }
+    }
+    text->num_grams = num_grams;
+    text->grams = malloc(sizeof(uint32_t) * (num_grams + 1));
+    text->offsets = malloc(sizeof(uint32_t) * (num_grams + 1));
+    text->postings = malloc(sizeof(uint32_t) * (num_postings + 1));
+    assert(text->grams != 0);
+    assert(text->offsets != 0);
+    assert(text->postings != 0);
+    
+    uint32_t g = 0;
+    uint32_t n = 0;
+    for (uint64_t i=0; i<num_keys; i++) {
+        if (i > 0 && keys[i] == keys[i - 1]) {
+            continue;
+        }
+        if (i == 0 || (keys[i] >> 32) != (keys[i - 1] >> 32)) {
+            text->grams[g] = keys[i] >> 32;
+            text->offsets[g] = n;
+            g++;
+        }
+        text->postings[n++] = (uint32_t)keys[i];
+    }
+    text->offsets[num_grams] = n;
+    free(keys);
+    
+    // the index is built without a lock, if two threads
+    // build it at the same time, the first one is kept
+    if (!__sync_bool_compare_and_swap(&adjacency->text, 0, text)) {
+        atlas_rdf_graph_text_free(text);
+        text = adjacency->text;
+    }
+    return text;
+}
+
+void
+atlas_rdf_graph_text_free(struct atlas_rdf_graph_text_s * text) {
+    free(text->ids);
+    free(text->values);
+    free(text->languages);
+    free(text->text);
+    free(text->grams);
+    free(text->offsets);
+    free(text->postings);
+    free(text);
+}
+
+#pragma mark -
+#pragma mark Search the Text Index
+
+// the postings of a trigram or 0, if no literal contains it
+static int
+atlas_rdf_graph_text_postings(struct atlas_rdf_graph_text_s * text, uint32_t gram, uint32_t * begin, uint32_t * end) {
+    uint32_t lo = 0;
+    uint32_t hi = text->num_grams;
+    while (lo < hi) {
+        uint32_t m = lo + (hi - lo) / 2;
+        if (text->grams[m] < gram) {
+            lo = m + 1;
+        } else {
+            hi = m;
+        }
+    }
+    if (lo == text->num_grams || text->grams[lo] != gram) {
+        return 0;
+    }
+    *begin = text->offsets[lo];
+    *end = text->offsets[lo + 1];
+    return 1;
+}
+
+static int
+atlas_rdf_graph_text_match(const char * value, const char * pattern, size_t length, int flags) {
+    if (!(flags & ATLAS_RDF_TEXT_ICASE)) {
+        if (flags & ATLAS_RDF_TEXT_PREFIX) {
+            return strncmp(value, pattern, length) == 0;
+        }
+        return strstr(value, pattern) != 0;
+    }
+    size_t value_length = strlen(value);
+    for (size_t i=0; i + length<=value_length; i++) {
+        size_t j = 0;
+        while (j < length && atlas_rdf_graph_text_fold(value[i + j]) == atlas_rdf_graph_text_fold(pattern[j])) {
+            j++;
+        }
+        if (j == length) {
+            return 1;
+        }
+        if (flags & ATLAS_RDF_TEXT_PREFIX) {
+            break;
+        }
+    }
+    return 0;
+}
+
+uint32_t
+atlas_rdf_graph_text_lookup(struct atlas_rdf_graph_text_s * text,
+                            const char * pattern,
+                            const char * language,
+                            int flags,
+                            uint32_t ** ids) {
+    size_t length = strlen(pattern);
+    uint32_t * candidates;
+    uint32_t num_candidates = 0;
+    
+    if (length < 3) {
+        // all literals are candidates
+        candidates = malloc(sizeof(uint32_t) * (text->num_literals + 1));
+        assert(candidates != 0);
+        for (uint32_t l=0; l<text->num_literals; l++) {
+            candidates[num_candidates++] = l;
+        }
+    } else {
+        // the posting lists of the trigrams, starting with the shortest
+        size_t num_lists = length - 2;
+        uint32_t * begins = malloc(sizeof(uint32_t) * (num_lists + 1));
+        uint32_t * ends = malloc(sizeof(uint32_t) * (num_lists + 1));
+        assert(begins != 0);
+        assert(ends != 0);
+        size_t shortest = 0;
+        for (size_t j=0; j<num_lists; j++) {
+            if (!atlas_rdf_graph_text_postings(text, atlas_rdf_graph_text_gram(pattern + j), &begins[j], &ends[j])) {
+                free(begins);
+                free(ends);
+                *ids = 0;
+                return 0;
+            }
+            if (ends[j] - begins[j] < ends[shortest] - begins[shortest]) {
+                shortest = j;
+            }
+        }
+        
+        // the literals in all lists
+        candidates = malloc(sizeof(uint32_t) * (ends[shortest] - begins[shortest] + 1));
+        assert(candidates != 0);
+        for (uint32_t i=begins[shortest]; i<ends[shortest]; i++) {
+            uint32_t literal = text->postings[i];
+            int found = 1;
+            for (size_t j=0; j<num_lists && found; j++) {
+                // the candidates are increasing, the lists are
+                // searched from the last position onwards
+                uint32_t lo = begins[j];
+                uint32_t hi = ends[j];
+                while (lo < hi) {
+                    uint32_t m = lo + (hi - lo) / 2;
+                    if (text->postings[m] < literal) {
+                        lo = m + 1;
+                    } else {
+                        hi = m;
+                    }
+                }
+                begins[j] = lo;
+                found = lo < ends[j] && text->postings[lo] == literal;
+            }
+            if (found) {
+                candidates[num_candidates++] = literal;
+            }
+        }
+        free(begins);
+        free(ends);
+    }
+    
+    // compare the candidates with the pattern concurrently
+    uint8_t * accept = malloc(sizeof(uint8_t) * (num_candidates + 1));
+    assert(accept != 0);
+    atlas_apply_chunked(num_candidates, 0, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            uint32_t literal = candidates[i];
+            accept[i] = (language == 0 || strcasecmp(text->text + text->languages[literal], language) == 0) &&
+                        atlas_rdf_graph_text_match(text->text + text->values[literal], pattern, length, flags);
+        }
+    }, 0);
+    
+    uint32_t count = 0;
+    for (uint32_t i=0; i<num_candidates; i++) {
+        if (accept[i]) {
+            candidates[count++] = text->ids[candidates[i]];
+        }
+    }
+    free(accept);
+    *ids = candidates;
+    return count;
+}
+
+#pragma mark -
+#pragma mark Select String Literals by their Text
+
+int
+atlas_rdf_graph_text(atlas_rdf_graph_t graph,
+                     const char * pattern,
+                     const char * language,
+                     int flags,
+                     void(^iterator)(atlas_rdf_term_t literal)) {
+    assert(graph != 0);
+    assert(pattern != 0);
+    
+    struct atlas_rdf_graph_text_s * text = atlas_rdf_graph_text_index(graph);
+    uint32_t * ids;
+    uint32_t count = atlas_rdf_graph_text_lookup(text, pattern, language, flags, &ids);
+    if (iterator) {
+        atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(atlas_rdf_graph_adjacency(graph)->dict);
+        for (uint32_t i=0; i<count; i++) {
+            iterator(terms[ids[i]]);
+        }
+    }
+    free(ids);
+    return count;
+}
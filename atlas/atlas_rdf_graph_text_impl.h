@@ -0,0 +1,84 @@
+/*
+ *  atlas_rdf_graph_text_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_TEXT_IMPL_H_
+#define _ATLAS_RDF_GRAPH_TEXT_IMPL_H_
+
+#include <atlas/rdf/graph.h>
+
+#include "atlas_rdf_graph_adjacency_impl.h"
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// the string literals of a graph, sorted by their ids in the adjacency
+// index; values and languages are offsets of NULL terminated strings in
+// text. The trigrams of the values (ASCII letters in lower case) are
+// sorted in grams, the literals containing the trigram grams[k] are the
+// postings at [offsets[k], offsets[k + 1]) (sorted as well)
+struct atlas_rdf_graph_text_s {
+    uint32_t num_literals;
+    uint32_t * ids;
+    uint32_t * values;
+    uint32_t * languages;
+    char * text;
+    
+    uint32_t num_grams;
+    uint32_t * grams;
+    uint32_t * offsets;
+    uint32_t * postings;
+};
+
+#pragma mark -
+#pragma mark Access the Text Index
+
+/*! Text index of a graph.
+ *
+ *  The index is built on first use and kept with
+ *  the adjacency index of the graph.
+ */
+struct atlas_rdf_graph_text_s *
+atlas_rdf_graph_text_index(atlas_rdf_graph_t graph);
+
+/*! Free a text index.
+ *
+ *  Called when the adjacency index is freed.
+ */
+void
+atlas_rdf_graph_text_free(struct atlas_rdf_graph_text_s * text);
+
+/*! The ids of the string literals matching a pattern.
+ *
+ *  The pattern, language and flags are the arguments of
+ *  atlas_rdf_graph_text(). The ids are sorted, the caller
+ *  is responsible to call free() on them.
+ *
+ *  \return The number of ids.
+ */
+uint32_t
+atlas_rdf_graph_text_lookup(struct atlas_rdf_graph_text_s * text,
+                            const char * pattern,
+                            const char * language,
+                            int flags,
+                            uint32_t ** ids);
+
+#endif // _ATLAS_RDF_GRAPH_TEXT_IMPL_H_
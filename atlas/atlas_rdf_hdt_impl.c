@@ -0,0 +1,1267 @@
+/*
+ *  atlas_rdf_hdt_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_hdt_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Buffer
+
+typedef struct {
+    uint8_t * data;
+    size_t length;
+    size_t capacity;
+} __hdt_buffer;
+
+static void
+atlas_rdf_hdt_buffer_append(__hdt_buffer * buffer, const void * data, size_t length) {
+    // keep room for a terminating zero, so that a key can be used as a c string
+    if (buffer->length + length + 1 > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+        while (capacity < buffer->length + length + 1) {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        assert(buffer->data != 0);
+        buffer->capacity = capacity;
+    }
+    if (data) {
+        memcpy(buffer->data + buffer->length, data, length);
+    } else {
+        memset(buffer->data + buffer->length, 0, length);
+    }
+    buffer->length += length;
+    buffer->data[buffer->length] = 0;
+}
+
+static void
+atlas_rdf_hdt_buffer_pad(__hdt_buffer * buffer) {
+    atlas_rdf_hdt_buffer_append(buffer, 0, (8 - buffer->length % 8) % 8);
+}
+
+static void
+atlas_rdf_hdt_buffer_put_varint(__hdt_buffer * buffer, uint32_t value) {
+    uint8_t bytes[5];
+    int length = 0;
+    while (value >= 0x80) {
+        bytes[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t)value;
+    atlas_rdf_hdt_buffer_append(buffer, bytes, length);
+}
+
+static const uint8_t *
+atlas_rdf_hdt_get_varint(const uint8_t * in, const uint8_t * end, uint32_t * value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && in < end; shift += 7) {
+        uint8_t byte = *in++;
+        result |= (uint32_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return in;
+        }
+    }
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Keys of the Terms
+
+// the key of a term is its representation in the section of the
+// dictionary; a typed literal refers to its type by the id
+static int
+atlas_rdf_hdt_key(atlas_rdf_term_t term,
+                  __hdt_buffer * key,
+                  int64_t(^type_id)(atlas_rdf_term_t type)) {
+    key->length = 0;
+    switch (atlas_rdf_term_type(term)) {
+        case IRI:
+        {
+            char * value = atlas_rdf_term_iri_value(term);
+            atlas_rdf_hdt_buffer_append(key, value, strlen(value));
+            free(value);
+            return ATLAS_RDF_HDT_IRI;
+        }
+            
+        case BLANK_NODE:
+        {
+            char * value = atlas_rdf_term_blank_node_value(term);
+            atlas_rdf_hdt_buffer_append(key, value, strlen(value));
+            free(value);
+            return ATLAS_RDF_HDT_BLANK_NODE;
+        }
+            
+        case STRING_LITERAL:
+        {
+            char * value = atlas_rdf_term_literal_value(term);
+            char * lang = atlas_rdf_term_string_lang(term);
+            atlas_rdf_hdt_buffer_append(key, value, strlen(value) + 1);
+            atlas_rdf_hdt_buffer_append(key, lang, strlen(lang));
+            free(value);
+            free(lang);
+            return ATLAS_RDF_HDT_STRING;
+        }
+            
+        case TYPED_LITERAL:
+        {
+            // the lookup of the type may use the buffer
+            atlas_rdf_term_t type = atlas_rdf_term_typed_type(term);
+            int64_t id = type_id(type);
+            lz_release(type);
+            if (id < 0) {
+                return -1;
+            }
+            uint8_t bytes[4] = {id >> 24, id >> 16, id >> 8, id};
+            char * value = atlas_rdf_term_literal_value(term);
+            key->length = 0;
+            atlas_rdf_hdt_buffer_append(key, bytes, 4);
+            atlas_rdf_hdt_buffer_append(key, value, strlen(value));
+            free(value);
+            return ATLAS_RDF_HDT_TYPED;
+        }
+            
+        case BOOLEAN_LITERAL:
+        {
+            uint8_t value = atlas_rdf_term_boolean_value(term) != 0;
+            atlas_rdf_hdt_buffer_append(key, &value, 1);
+            return ATLAS_RDF_HDT_BOOLEAN;
+        }
+            
+        case INTEGER_LITERAL:
+        {
+            // the sign followed by the binary digits (most significant first)
+            mpz_t value;
+            mpz_init(value);
+            atlas_rdf_term_integer_value(term, value);
+            uint8_t sign = mpz_sgn(value) >= 0;
+            size_t count = 0;
+            void * digits = mpz_export(0, &count, 1, 1, 1, 0, value);
+            atlas_rdf_hdt_buffer_append(key, &sign, 1);
+            atlas_rdf_hdt_buffer_append(key, digits, count);
+            free(digits);
+            mpz_clear(value);
+            return ATLAS_RDF_HDT_INTEGER;
+        }
+            
+        case DECIMAL_LITERAL:
+        {
+            mpf_t value;
+            mpf_init(value);
+            atlas_rdf_term_decimal_value(term, value);
+            char * buffer;
+            gmp_asprintf(&buffer, "%.Ff", value);
+            atlas_rdf_hdt_buffer_append(key, buffer, strlen(buffer));
+            free(buffer);
+            mpf_clear(value);
+            return ATLAS_RDF_HDT_DECIMAL;
+        }
+            
+        case DOUBLE_LITERAL:
+        {
+            double value = atlas_rdf_term_double_value(term);
+            atlas_rdf_hdt_buffer_append(key, &value, sizeof(double));
+            return ATLAS_RDF_HDT_DOUBLE;
+        }
+            
+        case DATETIME_LITERAL:
+        {
+            int64_t value = atlas_rdf_term_datetime_value(term);
+            atlas_rdf_hdt_buffer_append(key, &value, sizeof(int64_t));
+            return ATLAS_RDF_HDT_DATETIME;
+        }
+            
+        default:
+            return -1;
+    }
+}
+
+// size of the values in a section or 0 for front coded strings
+static uint32_t
+atlas_rdf_hdt_width(int section) {
+    switch (section) {
+        case ATLAS_RDF_HDT_BOOLEAN:
+            return 1;
+        case ATLAS_RDF_HDT_DOUBLE:
+        case ATLAS_RDF_HDT_DATETIME:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+static int
+atlas_rdf_hdt_cmp(const uint8_t * key1, size_t length1,
+                  const uint8_t * key2, size_t length2) {
+    int result = memcmp(key1, key2, length1 < length2 ? length1 : length2);
+    if (result != 0) {
+        return result;
+    }
+    return length1 < length2 ? -1 : length1 > length2;
+}
+
+#pragma mark -
+#pragma mark Serialize a RDF Graph
+
+typedef struct {
+    int section;
+    uint32_t term;
+    uint32_t length;
+    uint64_t offset;
+    const uint8_t * data;
+} __hdt_key;
+
+static int
+atlas_rdf_hdt_key_cmp(const void * a, const void * b) {
+    const __hdt_key * key1 = a;
+    const __hdt_key * key2 = b;
+    if (key1->section != key2->section) {
+        return key1->section < key2->section ? -1 : 1;
+    }
+    return atlas_rdf_hdt_cmp(key1->data, key1->length, key2->data, key2->length);
+}
+
+static int
+atlas_rdf_hdt_statement_cmp(const void * a, const void * b) {
+    const __graph * stm1 = a;
+    const __graph * stm2 = b;
+    if (stm1->subject != stm2->subject) {
+        return stm1->subject < stm2->subject ? -1 : 1;
+    }
+    if (stm1->predicate != stm2->predicate) {
+        return stm1->predicate < stm2->predicate ? -1 : 1;
+    }
+    if (stm1->object != stm2->object) {
+        return stm1->object < stm2->object ? -1 : 1;
+    }
+    return 0;
+}
+
+// sort the keys and number the terms by their position
+static void
+atlas_rdf_hdt_number(__hdt_key * keys,
+                     int num_terms,
+                     const uint8_t * data,
+                     uint32_t * ids) {
+    for (int i=0; i<num_terms; i++) {
+        keys[i].data = data + keys[i].offset;
+    }
+    qsort(keys, num_terms, sizeof(__hdt_key), atlas_rdf_hdt_key_cmp);
+    for (int i=0; i<num_terms; i++) {
+        ids[keys[i].term] = i;
+    }
+}
+
+static void
+atlas_rdf_hdt_write_section(__hdt_buffer * out,
+                            const __hdt_key * keys,
+                            uint32_t num_terms,
+                            uint32_t width) {
+    uint64_t position = out->length;
+    __hdt_section section;
+    memset(&section, 0, sizeof(__hdt_section));
+    section.num_terms = num_terms;
+    section.width = width;
+    atlas_rdf_hdt_buffer_append(out, 0, sizeof(__hdt_section));
+    
+    if (width > 0) {
+        for (uint32_t i=0; i<num_terms; i++) {
+            assert(keys[i].length == width);
+            atlas_rdf_hdt_buffer_append(out, keys[i].data, width);
+        }
+        section.length = out->length - position - sizeof(__hdt_section);
+    } else {
+        // each string stores the length of the prefix shared with
+        // its predecessor, except for the first string of a block
+        section.num_blocks = (num_terms + ATLAS_RDF_HDT_BLOCK_SIZE - 1) / ATLAS_RDF_HDT_BLOCK_SIZE;
+        uint64_t blocks = out->length;
+        atlas_rdf_hdt_buffer_append(out, 0, sizeof(uint32_t) * section.num_blocks);
+        atlas_rdf_hdt_buffer_pad(out);
+        uint64_t begin = out->length;
+        
+        for (uint32_t i=0; i<num_terms; i++) {
+            const __hdt_key * key = &keys[i];
+            if (i % ATLAS_RDF_HDT_BLOCK_SIZE == 0) {
+                uint32_t offset = out->length - begin;
+                memcpy(out->data + blocks + sizeof(uint32_t) * (i / ATLAS_RDF_HDT_BLOCK_SIZE), &offset, sizeof(uint32_t));
+                atlas_rdf_hdt_buffer_put_varint(out, key->length);
+                atlas_rdf_hdt_buffer_append(out, key->data, key->length);
+            } else {
+                const __hdt_key * prev = &keys[i - 1];
+                uint32_t prefix = 0;
+                while (prefix < key->length && prefix < prev->length &&
+                       key->data[prefix] == prev->data[prefix]) {
+                    prefix++;
+                }
+                atlas_rdf_hdt_buffer_put_varint(out, prefix);
+                atlas_rdf_hdt_buffer_put_varint(out, key->length - prefix);
+                atlas_rdf_hdt_buffer_append(out, key->data + prefix, key->length - prefix);
+            }
+        }
+        section.length = out->length - begin;
+    }
+    
+    atlas_rdf_hdt_buffer_pad(out);
+    memcpy(out->data + position, &section, sizeof(__hdt_section));
+}
+
+static void
+atlas_rdf_hdt_write_array(__hdt_buffer * out,
+                          const uint32_t * values,
+                          uint64_t length) {
+    uint32_t max = 0;
+    for (uint64_t i=0; i<length; i++) {
+        max = values[i] > max ? values[i] : max;
+    }
+    
+    __hdt_array array;
+    memset(&array, 0, sizeof(__hdt_array));
+    array.length = length;
+    array.width = 1;
+    while (array.width < 32 && (max >> array.width) != 0) {
+        array.width++;
+    }
+    atlas_rdf_hdt_buffer_append(out, &array, sizeof(__hdt_array));
+    
+    uint64_t num_words = (length * array.width + 63) / 64;
+    uint64_t position = out->length;
+    atlas_rdf_hdt_buffer_append(out, 0, sizeof(uint64_t) * num_words);
+    uint64_t * words = (uint64_t *)(out->data + position);
+    for (uint64_t i=0; i<length; i++) {
+        uint64_t bit = i * array.width;
+        uint32_t offset = bit % 64;
+        words[bit / 64] |= (uint64_t)values[i] << offset;
+        if (offset + array.width > 64) {
+            words[bit / 64 + 1] |= (uint64_t)values[i] >> (64 - offset);
+        }
+    }
+}
+
+static void
+atlas_rdf_hdt_write_bitmap(__hdt_buffer * out,
+                           const uint64_t * words,
+                           uint64_t num_bits) {
+    uint64_t num_words = (num_bits + 63) / 64;
+    uint64_t num_superblocks = (num_words + ATLAS_RDF_HDT_SUPERBLOCK - 1) / ATLAS_RDF_HDT_SUPERBLOCK;
+    
+    __hdt_bitmap bitmap;
+    bitmap.num_bits = num_bits;
+    bitmap.num_ones = 0;
+    for (uint64_t i=0; i<num_words; i++) {
+        bitmap.num_ones += __builtin_popcountll(words[i]);
+    }
+    atlas_rdf_hdt_buffer_append(out, &bitmap, sizeof(__hdt_bitmap));
+    atlas_rdf_hdt_buffer_append(out, words, sizeof(uint64_t) * num_words);
+    
+    // number of ones before each superblock, used to find the n-th one
+    uint32_t count = 0;
+    for (uint64_t i=0; i<num_superblocks; i++) {
+        atlas_rdf_hdt_buffer_append(out, &count, sizeof(uint32_t));
+        for (uint64_t j=i * ATLAS_RDF_HDT_SUPERBLOCK; j<num_words && j<(i + 1) * ATLAS_RDF_HDT_SUPERBLOCK; j++) {
+            count += __builtin_popcountll(words[j]);
+        }
+    }
+    atlas_rdf_hdt_buffer_pad(out);
+}
+
+void *
+atlas_rdf_graph_serialize_hdt(atlas_rdf_graph_t graph,
+                              size_t * length,
+                              atlas_error_handler err) {
+    assert(graph != 0);
+    assert(length != 0);
+    
+    int num_statements = atlas_rdf_graph_length(graph);
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(lz_obj_num_ref(graph));
+    __graph * statements = atlas_rdf_graph_flatten(graph, dict);
+    
+    // add the types of the typed literals, which are
+    // not referenced by the statements
+    int num_graph_terms = atlas_rdf_term_dict_length(dict);
+    for (int i=0; i<num_graph_terms; i++) {
+        atlas_rdf_term_t term = atlas_rdf_term_dict_terms(dict)[i];
+        if (atlas_rdf_term_type(term) == TYPED_LITERAL) {
+            atlas_rdf_term_t type = atlas_rdf_term_typed_type(term);
+            atlas_rdf_term_dict_insert(dict, type);
+            lz_release(type);
+        }
+    }
+    int num_terms = atlas_rdf_term_dict_length(dict);
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(dict);
+    
+    __hdt_buffer buffer = {0, 0, 0};
+    __hdt_buffer * key = &buffer;
+    __hdt_key * keys = malloc(sizeof(__hdt_key) * (num_terms + 1));
+    uint32_t * ids = malloc(sizeof(uint32_t) * (num_terms + 1));
+    assert(keys != 0);
+    assert(ids != 0);
+    
+    // the keys of the typed literals contain the ids of their types,
+    // so the iris (the first section) are numbered first
+    __hdt_buffer data = {0, 0, 0};
+    for (int i=0; i<num_terms; i++) {
+        keys[i].term = i;
+        keys[i].length = 0;
+        keys[i].offset = 0;
+        if (atlas_rdf_term_type(terms[i]) == TYPED_LITERAL) {
+            keys[i].section = ATLAS_RDF_HDT_TYPED;
+        } else {
+            keys[i].section = atlas_rdf_hdt_key(terms[i], key, 0);
+            assert(keys[i].section >= 0);
+            keys[i].length = key->length;
+            keys[i].offset = data.length;
+            atlas_rdf_hdt_buffer_append(&data, key->data, key->length);
+        }
+    }
+    atlas_rdf_hdt_number(keys, num_terms, data.data, ids);
+    
+    for (int i=0; i<num_terms; i++) {
+        if (keys[i].section == ATLAS_RDF_HDT_TYPED) {
+            atlas_rdf_hdt_key(terms[keys[i].term], key, ^(atlas_rdf_term_t type){
+                return (int64_t)ids[atlas_rdf_term_dict_lookup(dict, type)];
+            });
+            keys[i].length = key->length;
+            keys[i].offset = data.length;
+            atlas_rdf_hdt_buffer_append(&data, key->data, key->length);
+        }
+    }
+    atlas_rdf_hdt_number(keys, num_terms, data.data, ids);
+    
+    // the statements refer to the ids in the dictionary
+    for (int i=0; i<num_statements; i++) {
+        statements[i].subject = ids[statements[i].subject];
+        statements[i].predicate = ids[statements[i].predicate];
+        statements[i].object = ids[statements[i].object];
+    }
+    qsort(statements, num_statements, sizeof(__graph), atlas_rdf_hdt_statement_cmp);
+    
+    // split the statements into the subjects, the predicates
+    // of each subject and the objects of each predicate
+    uint32_t * subjects = malloc(sizeof(uint32_t) * (num_statements + 1));
+    uint32_t * predicates = malloc(sizeof(uint32_t) * (num_statements + 1));
+    uint32_t * objects = malloc(sizeof(uint32_t) * (num_statements + 1));
+    uint64_t * pairs = calloc(num_statements / 64 + 1, sizeof(uint64_t));
+    uint64_t * groups = calloc(num_statements / 64 + 1, sizeof(uint64_t));
+    assert(subjects && predicates && objects && pairs && groups);
+    
+    uint64_t num_subjects = 0, num_pairs = 0, num_objects = 0;
+    for (int i=0; i<num_statements; i++) {
+        __graph stm = statements[i];
+        if (i > 0 && atlas_rdf_hdt_statement_cmp(&stm, &statements[i - 1]) == 0) {
+            continue;
+        }
+        if (num_subjects == 0 || subjects[num_subjects - 1] != stm.subject) {
+            if (num_subjects > 0) {
+                pairs[(num_pairs - 1) / 64] |= 1ULL << ((num_pairs - 1) % 64);
+            }
+            subjects[num_subjects++] = stm.subject;
+            predicates[num_pairs++] = stm.predicate;
+            if (num_objects > 0) {
+                groups[(num_objects - 1) / 64] |= 1ULL << ((num_objects - 1) % 64);
+            }
+        } else if (predicates[num_pairs - 1] != stm.predicate) {
+            predicates[num_pairs++] = stm.predicate;
+            groups[(num_objects - 1) / 64] |= 1ULL << ((num_objects - 1) % 64);
+        }
+        objects[num_objects++] = stm.object;
+    }
+    if (num_objects > 0) {
+        pairs[(num_pairs - 1) / 64] |= 1ULL << ((num_pairs - 1) % 64);
+        groups[(num_objects - 1) / 64] |= 1ULL << ((num_objects - 1) % 64);
+    }
+    
+    // the header is copied, after the offsets of the parts are known
+    __hdt_buffer out = {0, 0, 0};
+    __hdt_header header;
+    memset(&header, 0, sizeof(__hdt_header));
+    memcpy(header.magic, ATLAS_RDF_HDT_MAGIC, 8);
+    header.byte_order = ATLAS_RDF_HDT_BYTE_ORDER;
+    header.version = ATLAS_RDF_HDT_VERSION;
+    header.num_terms = num_terms;
+    header.num_statements = num_objects;
+    atlas_rdf_hdt_buffer_append(&out, 0, sizeof(__hdt_header));
+    
+    int begin = 0;
+    for (int section = 0; section < ATLAS_RDF_HDT_NUM_SECTIONS; section++) {
+        int end = begin;
+        while (end < num_terms && keys[end].section == section) {
+            end++;
+        }
+        header.sections[section] = out.length;
+        atlas_rdf_hdt_write_section(&out, keys + begin, end - begin, atlas_rdf_hdt_width(section));
+        begin = end;
+    }
+    
+    header.subjects = out.length;
+    atlas_rdf_hdt_write_array(&out, subjects, num_subjects);
+    header.predicates = out.length;
+    atlas_rdf_hdt_write_array(&out, predicates, num_pairs);
+    header.pairs = out.length;
+    atlas_rdf_hdt_write_bitmap(&out, pairs, num_pairs);
+    header.objects = out.length;
+    atlas_rdf_hdt_write_array(&out, objects, num_objects);
+    header.groups = out.length;
+    atlas_rdf_hdt_write_bitmap(&out, groups, num_objects);
+    
+    header.length = out.length;
+    memcpy(out.data, &header, sizeof(__hdt_header));
+    *length = out.length;
+    
+    free(subjects);
+    free(predicates);
+    free(objects);
+    free(pairs);
+    free(groups);
+    free(statements);
+    free(keys);
+    free(ids);
+    free(data.data);
+    free(buffer.data);
+    atlas_rdf_term_dict_free(dict);
+    
+    return out.data;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_from_hdt(const void * data,
+                                size_t length,
+                                atlas_error_handler err) {
+    assert(data != 0);
+    
+    atlas_rdf_hdt_t hdt = atlas_rdf_hdt_open(data, length, err);
+    if (hdt == 0) {
+        return 0;
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_hdt_graph(hdt, err);
+    atlas_rdf_hdt_close(hdt);
+    return graph;
+}
+
+#pragma mark -
+#pragma mark Open a Compact Binary RDF Graph
+
+struct atlas_rdf_hdt_s {
+    const uint8_t * data;
+    const __hdt_header * header;
+    
+    // dictionary and the first id of each section
+    const __hdt_section * sections[ATLAS_RDF_HDT_NUM_SECTIONS];
+    uint32_t base[ATLAS_RDF_HDT_NUM_SECTIONS + 1];
+    
+    // decoded terms (by id)
+    atlas_rdf_term_t * terms;
+    
+    // buffers for decoding and looking up keys
+    __hdt_buffer key;
+    __hdt_buffer lookup;
+    
+    const __hdt_array * subjects;
+    const __hdt_array * predicates;
+    const __hdt_array * objects;
+    const __hdt_bitmap * pairs;
+    const __hdt_bitmap * groups;
+};
+
+static uint64_t
+atlas_rdf_hdt_align(uint64_t length) {
+    return (length + 7) & ~(uint64_t)7;
+}
+
+static const __hdt_section *
+atlas_rdf_hdt_open_section(const uint8_t * data, size_t length, uint64_t offset, int kind) {
+    if (offset % 8 != 0 || offset > length || length - offset < sizeof(__hdt_section)) {
+        return 0;
+    }
+    const __hdt_section * section = (const __hdt_section *)(data + offset);
+    uint64_t available = length - offset - sizeof(__hdt_section);
+    uint32_t width = atlas_rdf_hdt_width(kind);
+    if (section->width != width) {
+        return 0;
+    }
+    if (width > 0) {
+        if (section->num_blocks != 0 ||
+            section->length != (uint64_t)section->num_terms * width ||
+            section->length > available) {
+            return 0;
+        }
+    } else {
+        uint64_t blocks = atlas_rdf_hdt_align(sizeof(uint32_t) * (uint64_t)section->num_blocks);
+        if (section->num_blocks != (section->num_terms + (uint64_t)ATLAS_RDF_HDT_BLOCK_SIZE - 1) / ATLAS_RDF_HDT_BLOCK_SIZE ||
+            blocks > available ||
+            section->length > available - blocks) {
+            return 0;
+        }
+    }
+    return section;
+}
+
+static const __hdt_array *
+atlas_rdf_hdt_open_array(const uint8_t * data, size_t length, uint64_t offset) {
+    if (offset % 8 != 0 || offset > length || length - offset < sizeof(__hdt_array)) {
+        return 0;
+    }
+    const __hdt_array * array = (const __hdt_array *)(data + offset);
+    uint64_t available = (length - offset - sizeof(__hdt_array)) / 8;
+    if (array->width == 0 || array->width > 32 ||
+        array->length > available * 64 / array->width ||
+        (array->length * array->width + 63) / 64 > available) {
+        return 0;
+    }
+    return array;
+}
+
+static const __hdt_bitmap *
+atlas_rdf_hdt_open_bitmap(const uint8_t * data, size_t length, uint64_t offset) {
+    if (offset % 8 != 0 || offset > length || length - offset < sizeof(__hdt_bitmap)) {
+        return 0;
+    }
+    const __hdt_bitmap * bitmap = (const __hdt_bitmap *)(data + offset);
+    uint64_t available = length - offset - sizeof(__hdt_bitmap);
+    uint64_t num_words = bitmap->num_bits / 64 + (bitmap->num_bits % 64 != 0);
+    uint64_t num_superblocks = (num_words + ATLAS_RDF_HDT_SUPERBLOCK - 1) / ATLAS_RDF_HDT_SUPERBLOCK;
+    if (bitmap->num_ones > bitmap->num_bits ||
+        sizeof(uint64_t) * num_words + sizeof(uint32_t) * num_superblocks > available) {
+        return 0;
+    }
+    return bitmap;
+}
+
+atlas_rdf_hdt_t
+atlas_rdf_hdt_open(const void * data,
+                   size_t length,
+                   atlas_error_handler err) {
+    assert(data != 0);
+    
+    const __hdt_header * header = data;
+    if (length < sizeof(__hdt_header) ||
+        memcmp(header->magic, ATLAS_RDF_HDT_MAGIC, 8) != 0) {
+        err(1, "Not a compact binary graph.");
+        return 0;
+    }
+    
+    if (header->byte_order != ATLAS_RDF_HDT_BYTE_ORDER ||
+        header->version != ATLAS_RDF_HDT_VERSION) {
+        err(1, "Compact binary graph was written on an incompatible machine.");
+        return 0;
+    }
+    
+    if (header->length > length) {
+        err(1, "Compact binary graph is truncated.");
+        return 0;
+    }
+    length = header->length;
+    
+    atlas_rdf_hdt_t hdt = calloc(1, sizeof(struct atlas_rdf_hdt_s));
+    assert(hdt != 0);
+    hdt->data = data;
+    hdt->header = header;
+    
+    int valid = 1;
+    uint64_t num_terms = 0;
+    for (int i=0; i<ATLAS_RDF_HDT_NUM_SECTIONS && valid; i++) {
+        hdt->sections[i] = atlas_rdf_hdt_open_section(data, length, header->sections[i], i);
+        valid = hdt->sections[i] != 0;
+        if (valid) {
+            hdt->base[i] = num_terms;
+            num_terms += hdt->sections[i]->num_terms;
+        }
+    }
+    hdt->base[ATLAS_RDF_HDT_NUM_SECTIONS] = num_terms;
+    
+    if (valid) {
+        hdt->subjects = atlas_rdf_hdt_open_array(data, length, header->subjects);
+        hdt->predicates = atlas_rdf_hdt_open_array(data, length, header->predicates);
+        hdt->objects = atlas_rdf_hdt_open_array(data, length, header->objects);
+        hdt->pairs = atlas_rdf_hdt_open_bitmap(data, length, header->pairs);
+        hdt->groups = atlas_rdf_hdt_open_bitmap(data, length, header->groups);
+        
+        // each subject has a last predicate and each
+        // predicate of a subject has a last object
+        valid = num_terms == header->num_terms &&
+            hdt->subjects && hdt->predicates && hdt->objects && hdt->pairs && hdt->groups &&
+            hdt->objects->length == header->num_statements &&
+            hdt->pairs->num_bits == hdt->predicates->length &&
+            hdt->pairs->num_ones == hdt->subjects->length &&
+            hdt->groups->num_bits == hdt->objects->length &&
+            hdt->groups->num_ones == hdt->predicates->length;
+    }
+    
+    if (!valid) {
+        err(1, "Corrupt compact binary graph.");
+        free(hdt);
+        return 0;
+    }
+    
+    hdt->terms = calloc(num_terms + 1, sizeof(atlas_rdf_term_t));
+    assert(hdt->terms != 0);
+    return hdt;
+}
+
+void
+atlas_rdf_hdt_close(atlas_rdf_hdt_t hdt) {
+    assert(hdt != 0);
+    for (uint32_t i=0; i<hdt->header->num_terms; i++) {
+        if (hdt->terms[i]) {
+            lz_release(hdt->terms[i]);
+        }
+    }
+    free(hdt->terms);
+    free(hdt->key.data);
+    free(hdt->lookup.data);
+    free(hdt);
+}
+
+int
+atlas_rdf_hdt_length(atlas_rdf_hdt_t hdt) {
+    assert(hdt != 0);
+    return hdt->header->num_statements;
+}
+
+int
+atlas_rdf_hdt_num_terms(atlas_rdf_hdt_t hdt) {
+    assert(hdt != 0);
+    return hdt->header->num_terms;
+}
+
+#pragma mark -
+#pragma mark Dictionary
+
+typedef struct {
+    const uint8_t * position;
+    const uint8_t * end;
+    uint32_t index;
+} __hdt_cursor;
+
+static const uint8_t *
+atlas_rdf_hdt_section_data(const __hdt_section * section) {
+    const uint8_t * data = (const uint8_t *)(section + 1);
+    return data + atlas_rdf_hdt_align(sizeof(uint32_t) * (uint64_t)section->num_blocks);
+}
+
+static int
+atlas_rdf_hdt_seek(const __hdt_section * section,
+                   uint32_t block,
+                   __hdt_cursor * cursor) {
+    const uint32_t * blocks = (const uint32_t *)(section + 1);
+    const uint8_t * data = atlas_rdf_hdt_section_data(section);
+    if (block >= section->num_blocks || blocks[block] >= section->length) {
+        return 0;
+    }
+    cursor->position = data + blocks[block];
+    cursor->end = data + section->length;
+    cursor->index = 0;
+    return 1;
+}
+
+// decode the next string of a block into the buffer
+static int
+atlas_rdf_hdt_next(__hdt_cursor * cursor, __hdt_buffer * key) {
+    uint32_t prefix = 0, suffix;
+    if (cursor->index > 0) {
+        cursor->position = atlas_rdf_hdt_get_varint(cursor->position, cursor->end, &prefix);
+        if (cursor->position == 0 || prefix > key->length) {
+            return 0;
+        }
+    }
+    cursor->position = atlas_rdf_hdt_get_varint(cursor->position, cursor->end, &suffix);
+    if (cursor->position == 0 || suffix > cursor->end - cursor->position) {
+        return 0;
+    }
+    key->length = prefix;
+    atlas_rdf_hdt_buffer_append(key, cursor->position, suffix);
+    cursor->position += suffix;
+    cursor->index++;
+    return 1;
+}
+
+// decode the key at the index of a section
+static int
+atlas_rdf_hdt_section_key(const __hdt_section * section,
+                          uint32_t index,
+                          __hdt_buffer * key) {
+    if (section->width > 0) {
+        key->length = 0;
+        atlas_rdf_hdt_buffer_append(key, atlas_rdf_hdt_section_data(section) + (uint64_t)index * section->width, section->width);
+        return 1;
+    }
+    __hdt_cursor cursor;
+    if (!atlas_rdf_hdt_seek(section, index / ATLAS_RDF_HDT_BLOCK_SIZE, &cursor)) {
+        return 0;
+    }
+    for (uint32_t i=0; i<=index % ATLAS_RDF_HDT_BLOCK_SIZE; i++) {
+        if (!atlas_rdf_hdt_next(&cursor, key)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// decoded term of an id (owned by the handle) or NULL if the data is corrupt
+static atlas_rdf_term_t
+atlas_rdf_hdt_term(atlas_rdf_hdt_t hdt, uint32_t id) {
+    if (id >= hdt->header->num_terms) {
+        return 0;
+    }
+    if (hdt->terms[id]) {
+        return hdt->terms[id];
+    }
+    
+    int section = 0;
+    while (id >= hdt->base[section + 1]) {
+        section++;
+    }
+    __hdt_buffer * key = &hdt->key;
+    if (!atlas_rdf_hdt_section_key(hdt->sections[section], id - hdt->base[section], key)) {
+        return 0;
+    }
+    
+    atlas_error_handler ignore = ^(int e, const char * msg){};
+    const char * value = (const char *)key->data;
+    atlas_rdf_term_t term = 0;
+    switch (section) {
+        case ATLAS_RDF_HDT_IRI:
+            term = atlas_rdf_term_create_iri_trusted(value, key->length);
+            break;
+            
+        case ATLAS_RDF_HDT_BLANK_NODE:
+            term = atlas_rdf_term_create_blank_node_trusted(value, key->length);
+            break;
+            
+        case ATLAS_RDF_HDT_STRING:
+        {
+            size_t length = strlen(value);
+            if (length < key->length) {
+                const char * lang = value + length + 1;
+                term = atlas_rdf_term_create_string(value, *lang ? lang : 0, ignore);
+            }
+            break;
+        }
+            
+        case ATLAS_RDF_HDT_TYPED:
+        {
+            // the type must be an iri and is decoded into the same buffer
+            if (key->length < 4) {
+                break;
+            }
+            uint32_t type_id = (uint32_t)key->data[0] << 24 | (uint32_t)key->data[1] << 16 |
+                               (uint32_t)key->data[2] << 8 | (uint32_t)key->data[3];
+            if (type_id >= hdt->base[ATLAS_RDF_HDT_IRI + 1]) {
+                break;
+            }
+            char * copy = strdup(value + 4);
+            assert(copy != 0);
+            atlas_rdf_term_t type = atlas_rdf_hdt_term(hdt, type_id);
+            if (type) {
+                term = atlas_rdf_term_create_typed(copy, type, ignore);
+            }
+            free(copy);
+            break;
+        }
+            
+        case ATLAS_RDF_HDT_BOOLEAN:
+            term = atlas_rdf_term_create_boolean(key->data[0], ignore);
+            break;
+            
+        case ATLAS_RDF_HDT_INTEGER:
+        {
+            if (key->length < 1) {
+                break;
+            }
+            mpz_t integer;
+            mpz_init(integer);
+            mpz_import(integer, key->length - 1, 1, 1, 1, 0, key->data + 1);
+            if (key->data[0] == 0) {
+                mpz_neg(integer, integer);
+            }
+            term = atlas_rdf_term_create_integer(integer, ignore);
+            mpz_clear(integer);
+            break;
+        }
+            
+        case ATLAS_RDF_HDT_DECIMAL:
+        {
+            mpf_t decimal;
+            mpf_init(decimal);
+            if (mpf_set_str(decimal, value, 10) == 0) {
+                term = atlas_rdf_term_create_decimal(decimal, ignore);
+            }
+            mpf_clear(decimal);
+            break;
+        }
+            
+        case ATLAS_RDF_HDT_DOUBLE:
+        {
+            double d;
+            memcpy(&d, key->data, sizeof(double));
+            term = atlas_rdf_term_create_double(d, ignore);
+            break;
+        }
+            
+        case ATLAS_RDF_HDT_DATETIME:
+        {
+            int64_t t;
+            memcpy(&t, key->data, sizeof(int64_t));
+            term = atlas_rdf_term_create_datetime((time_t)t, ignore);
+            break;
+        }
+    }
+    
+    hdt->terms[id] = term;
+    return term;
+}
+
+// id of a term or -1 if the term is not in the dictionary
+static int64_t
+atlas_rdf_hdt_lookup(atlas_rdf_hdt_t hdt, atlas_rdf_term_t term) {
+    __hdt_buffer * lookup = &hdt->lookup;
+    int kind = atlas_rdf_hdt_key(term, lookup, ^(atlas_rdf_term_t type){
+        return atlas_rdf_hdt_lookup(hdt, type);
+    });
+    if (kind < 0) {
+        return -1;
+    }
+    
+    const __hdt_section * section = hdt->sections[kind];
+    if (section->num_terms == 0) {
+        return -1;
+    }
+    
+    if (section->width > 0) {
+        if (lookup->length != section->width) {
+            return -1;
+        }
+        const uint8_t * data = atlas_rdf_hdt_section_data(section);
+        uint32_t begin = 0, end = section->num_terms;
+        while (begin < end) {
+            uint32_t middle = begin + (end - begin) / 2;
+            int result = memcmp(data + (uint64_t)middle * section->width, lookup->data, section->width);
+            if (result == 0) {
+                return hdt->base[kind] + middle;
+            } else if (result < 0) {
+                begin = middle + 1;
+            } else {
+                end = middle;
+            }
+        }
+        return -1;
+    }
+    
+    // find the last block starting with a key not
+    // greater than the key and search the block
+    __hdt_buffer * key = &hdt->key;
+    __hdt_cursor cursor;
+    uint32_t begin = 0, end = section->num_blocks;
+    while (end - begin > 1) {
+        uint32_t middle = begin + (end - begin) / 2;
+        if (!atlas_rdf_hdt_seek(section, middle, &cursor) || !atlas_rdf_hdt_next(&cursor, key)) {
+            return -1;
+        }
+        if (atlas_rdf_hdt_cmp(key->data, key->length, lookup->data, lookup->length) <= 0) {
+            begin = middle;
+        } else {
+            end = middle;
+        }
+    }
+    
+    if (!atlas_rdf_hdt_seek(section, begin, &cursor)) {
+        return -1;
+    }
+    uint32_t index = begin * ATLAS_RDF_HDT_BLOCK_SIZE;
+    for (; index < section->num_terms && cursor.index < ATLAS_RDF_HDT_BLOCK_SIZE; index++) {
+        if (!atlas_rdf_hdt_next(&cursor, key)) {
+            return -1;
+        }
+        int result = atlas_rdf_hdt_cmp(key->data, key->length, lookup->data, lookup->length);
+        if (result == 0) {
+            return hdt->base[kind] + index;
+        } else if (result > 0) {
+            break;
+        }
+    }
+    return -1;
+}
+
+#pragma mark -
+#pragma mark Statements
+
+static uint32_t
+atlas_rdf_hdt_get(const __hdt_array * array, uint64_t index) {
+    const uint64_t * words = (const uint64_t *)(array + 1);
+    uint64_t bit = index * array->width;
+    uint32_t offset = bit % 64;
+    uint64_t value = words[bit / 64] >> offset;
+    if (offset + array->width > 64) {
+        value |= words[bit / 64 + 1] << (64 - offset);
+    }
+    return (uint32_t)(value & ((1ULL << array->width) - 1));
+}
+
+// position of the value in [begin, end) of a sorted array or -1
+static int64_t
+atlas_rdf_hdt_search(const __hdt_array * array, uint64_t begin, uint64_t end, uint32_t value) {
+    while (begin < end) {
+        uint64_t middle = begin + (end - begin) / 2;
+        uint32_t v = atlas_rdf_hdt_get(array, middle);
+        if (v == value) {
+            return middle;
+        } else if (v < value) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return -1;
+}
+
+static int
+atlas_rdf_hdt_bit(const __hdt_bitmap * bitmap, uint64_t index) {
+    const uint64_t * words = (const uint64_t *)(bitmap + 1);
+    return (words[index / 64] >> (index % 64)) & 1;
+}
+
+// position of the n-th one (starting with 0) or the number of bits
+static uint64_t
+atlas_rdf_hdt_select(const __hdt_bitmap * bitmap, uint64_t n) {
+    const uint64_t * words = (const uint64_t *)(bitmap + 1);
+    uint64_t num_words = (bitmap->num_bits + 63) / 64;
+    uint64_t num_superblocks = (num_words + ATLAS_RDF_HDT_SUPERBLOCK - 1) / ATLAS_RDF_HDT_SUPERBLOCK;
+    const uint32_t * counts = (const uint32_t *)(words + num_words);
+    if (n >= bitmap->num_ones || num_superblocks == 0) {
+        return bitmap->num_bits;
+    }
+    
+    // find the last superblock with less than n ones before it
+    uint64_t begin = 0, end = num_superblocks - 1;
+    while (begin < end) {
+        uint64_t middle = begin + (end - begin + 1) / 2;
+        if (counts[middle] <= n) {
+            begin = middle;
+        } else {
+            end = middle - 1;
+        }
+    }
+    
+    n -= counts[begin] <= n ? counts[begin] : n;
+    for (uint64_t i=begin * ATLAS_RDF_HDT_SUPERBLOCK; i<num_words; i++) {
+        uint64_t word = words[i];
+        uint64_t ones = __builtin_popcountll(word);
+        if (n < ones) {
+            while (n-- > 0) {
+                word &= word - 1;
+            }
+            uint64_t position = i * 64 + __builtin_ctzll(word);
+            return position < bitmap->num_bits ? position : bitmap->num_bits;
+        }
+        n -= ones;
+    }
+    return bitmap->num_bits;
+}
+
+// call the block for the ids of the matching statements,
+// an id of -1 matches any id
+static void
+atlas_rdf_hdt_match_ids(atlas_rdf_hdt_t hdt,
+                        int64_t subject,
+                        int64_t predicate,
+                        int64_t object,
+                        void(^block)(uint32_t s, uint32_t p, uint32_t o)) {
+    uint64_t num_subjects = hdt->subjects->length;
+    uint64_t num_pairs = hdt->predicates->length;
+    uint64_t num_objects = hdt->objects->length;
+    
+    if (subject < 0) {
+        // scan all statements, the ends of the predicates and
+        // objects are read from the bitmaps sequentially
+        uint64_t j = 0, k = 0;
+        for (uint64_t i=0; i<num_subjects && j<num_pairs; i++) {
+            uint32_t s = atlas_rdf_hdt_get(hdt->subjects, i);
+            int last_pair = 0;
+            while (!last_pair && j < num_pairs) {
+                uint32_t p = atlas_rdf_hdt_get(hdt->predicates, j);
+                last_pair = atlas_rdf_hdt_bit(hdt->pairs, j++);
+                int last_object = 0;
+                while (!last_object && k < num_objects) {
+                    uint32_t o = atlas_rdf_hdt_get(hdt->objects, k);
+                    last_object = atlas_rdf_hdt_bit(hdt->groups, k++);
+                    if ((predicate < 0 || p == predicate) &&
+                        (object < 0 || o == object)) {
+                        block(s, p, o);
+                    }
+                }
+            }
+        }
+        return;
+    }
+    
+    int64_t i = atlas_rdf_hdt_search(hdt->subjects, 0, num_subjects, subject);
+    if (i < 0) {
+        return;
+    }
+    
+    // the predicates of the subject
+    uint64_t begin = i == 0 ? 0 : atlas_rdf_hdt_select(hdt->pairs, i - 1) + 1;
+    uint64_t end = atlas_rdf_hdt_select(hdt->pairs, i) + 1;
+    end = end < num_pairs ? end : num_pairs;
+    if (predicate >= 0) {
+        int64_t j = atlas_rdf_hdt_search(hdt->predicates, begin, end, predicate);
+        if (j < 0) {
+            return;
+        }
+        begin = j;
+        end = j + 1;
+    }
+    
+    for (uint64_t j=begin; j<end; j++) {
+        uint32_t p = atlas_rdf_hdt_get(hdt->predicates, j);
+        
+        // the objects of the predicate
+        uint64_t first = j == 0 ? 0 : atlas_rdf_hdt_select(hdt->groups, j - 1) + 1;
+        uint64_t last = atlas_rdf_hdt_select(hdt->groups, j) + 1;
+        last = last < num_objects ? last : num_objects;
+        if (object >= 0) {
+            int64_t k = atlas_rdf_hdt_search(hdt->objects, first, last, object);
+            if (k < 0) {
+                continue;
+            }
+            first = k;
+            last = k + 1;
+        }
+        
+        for (uint64_t k=first; k<last; k++) {
+            block(subject, p, atlas_rdf_hdt_get(hdt->objects, k));
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Query a Compact Binary RDF Graph
+
+int
+atlas_rdf_hdt_contains(atlas_rdf_hdt_t hdt,
+                       atlas_rdf_term_t subject,
+                       atlas_rdf_term_t predicate,
+                       atlas_rdf_term_t object) {
+    assert(hdt != 0);
+    assert(subject != 0);
+    assert(predicate != 0);
+    assert(object != 0);
+    
+    int64_t s = atlas_rdf_hdt_lookup(hdt, subject);
+    int64_t p = atlas_rdf_hdt_lookup(hdt, predicate);
+    int64_t o = atlas_rdf_hdt_lookup(hdt, object);
+    if (s < 0 || p < 0 || o < 0) {
+        return 0;
+    }
+    
+    __block int result = 0;
+    atlas_rdf_hdt_match_ids(hdt, s, p, o, ^(uint32_t s, uint32_t p, uint32_t o){
+        result = 1;
+    });
+    return result;
+}
+
+void
+atlas_rdf_hdt_match(atlas_rdf_hdt_t hdt,
+                    atlas_rdf_term_t subject,
+                    atlas_rdf_term_t predicate,
+                    atlas_rdf_term_t object,
+                    void(^block)(atlas_rdf_term_t subject,
+                                 atlas_rdf_term_t predicate,
+                                 atlas_rdf_term_t object)) {
+    assert(hdt != 0);
+    assert(block != 0);
+    
+    // a term, which is not in the dictionary, matches no statement
+    int64_t s = subject ? atlas_rdf_hdt_lookup(hdt, subject) : -1;
+    int64_t p = predicate ? atlas_rdf_hdt_lookup(hdt, predicate) : -1;
+    int64_t o = object ? atlas_rdf_hdt_lookup(hdt, object) : -1;
+    if ((subject && s < 0) || (predicate && p < 0) || (object && o < 0)) {
+        return;
+    }
+    
+    atlas_rdf_hdt_match_ids(hdt, s, p, o, ^(uint32_t s, uint32_t p, uint32_t o){
+        atlas_rdf_term_t st = atlas_rdf_hdt_term(hdt, s);
+        atlas_rdf_term_t pt = atlas_rdf_hdt_term(hdt, p);
+        atlas_rdf_term_t ot = atlas_rdf_hdt_term(hdt, o);
+        if (st && pt && ot) {
+            block(st, pt, ot);
+        }
+    });
+}
+
+atlas_rdf_graph_t
+atlas_rdf_hdt_graph(atlas_rdf_hdt_t hdt,
+                    atlas_error_handler err) {
+    assert(hdt != 0);
+    
+    // the graph refers only to the terms used by the statements
+    uint32_t num_terms = hdt->header->num_terms;
+    uint32_t num_statements = hdt->header->num_statements;
+    __graph * statements = malloc(sizeof(__graph) * (num_statements + 1));
+    uint32_t * positions = malloc(sizeof(uint32_t) * (num_terms + 1));
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * (num_terms + 1));
+    assert(statements && positions && terms);
+    memset(positions, 0xff, sizeof(uint32_t) * num_terms);
+    
+    __block uint32_t n = 0;
+    __block uint32_t num_graph_terms = 0;
+    __block int valid = 1;
+    uint32_t(^position)(uint32_t id) = ^(uint32_t id){
+        if (id >= num_terms) {
+            valid = 0;
+            return (uint32_t)0;
+        }
+        if (positions[id] == UINT32_MAX) {
+            terms[num_graph_terms] = atlas_rdf_hdt_term(hdt, id);
+            valid = valid && terms[num_graph_terms] != 0;
+            positions[id] = num_graph_terms++;
+        }
+        return positions[id];
+    };
+    
+    atlas_rdf_hdt_match_ids(hdt, -1, -1, -1, ^(uint32_t s, uint32_t p, uint32_t o){
+        if (valid && n < num_statements) {
+            statements[n].subject = position(s);
+            statements[n].predicate = position(p);
+            statements[n].object = position(o);
+            n++;
+        }
+    });
+    
+    atlas_rdf_graph_t graph = 0;
+    if (valid && n == num_statements) {
+        graph = atlas_rdf_graph_create_flat(n, statements, num_graph_terms, terms);
+    } else {
+        err(1, "Corrupt compact binary graph.");
+    }
+    
+    free(statements);
+    free(positions);
+    free(terms);
+    return graph;
+}
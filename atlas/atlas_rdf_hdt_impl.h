@@ -0,0 +1,103 @@
+/*
+ *  atlas_rdf_hdt_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_HDT_IMPL_H_
+#define _ATLAS_RDF_HDT_IMPL_H_
+
+#include <atlas/rdf/hdt.h>
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+#define ATLAS_RDF_HDT_MAGIC      "ATLASHDT"
+#define ATLAS_RDF_HDT_BYTE_ORDER 0x01020304
+#define ATLAS_RDF_HDT_VERSION    1
+
+// number of strings in a front coded block, the first
+// string of a block is stored completely
+#define ATLAS_RDF_HDT_BLOCK_SIZE 16
+
+// number of words of a bitmap counted by an entry
+// of the rank directory
+#define ATLAS_RDF_HDT_SUPERBLOCK 8
+
+// sections of the dictionary, the ids of the terms
+// are numbered in this order
+#define ATLAS_RDF_HDT_IRI        0
+#define ATLAS_RDF_HDT_BLANK_NODE 1
+#define ATLAS_RDF_HDT_STRING     2
+#define ATLAS_RDF_HDT_TYPED      3
+#define ATLAS_RDF_HDT_BOOLEAN    4
+#define ATLAS_RDF_HDT_INTEGER    5
+#define ATLAS_RDF_HDT_DECIMAL    6
+#define ATLAS_RDF_HDT_DOUBLE     7
+#define ATLAS_RDF_HDT_DATETIME   8
+#define ATLAS_RDF_HDT_NUM_SECTIONS 9
+
+// all parts are aligned to 8 bytes, the offsets are
+// relative to the beginning of the data
+typedef struct {
+    char magic[8];
+    uint32_t byte_order;
+    uint32_t version;
+    
+    uint32_t num_terms;
+    uint32_t num_statements;
+    uint64_t length;
+    
+    // dictionary
+    uint64_t sections[ATLAS_RDF_HDT_NUM_SECTIONS];
+    
+    // statements
+    uint64_t subjects;      // packed array of the distinct subjects
+    uint64_t predicates;    // packed array of the predicates of each subject
+    uint64_t pairs;         // bitmap marking the last predicate of a subject
+    uint64_t objects;       // packed array of the objects of each predicate
+    uint64_t groups;        // bitmap marking the last object of a predicate
+} __hdt_header;
+
+// a section is followed by the offsets of the blocks (for front
+// coded strings) and the data; the sections are sorted by the
+// bytes of the keys of the terms
+typedef struct {
+    uint32_t num_terms;
+    uint32_t width;         // size of a value or 0 for front coded strings
+    uint32_t num_blocks;
+    uint32_t reserved;
+    uint64_t length;        // length of the data
+} __hdt_section;
+
+// followed by the values, each with width bits, in 64 bit words
+typedef struct {
+    uint64_t length;
+    uint32_t width;
+    uint32_t reserved;
+} __hdt_array;
+
+// followed by the bits in 64 bit words and the number of ones
+// before each superblock
+typedef struct {
+    uint64_t num_bits;
+    uint64_t num_ones;
+} __hdt_bitmap;
+
+#endif // _ATLAS_RDF_HDT_IMPL_H_
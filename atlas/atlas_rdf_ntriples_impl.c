@@ -0,0 +1,1014 @@
+/*
+ *  atlas_rdf_ntriples_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_ntriples_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_graph_builder_impl.h"
+#include "atlas_rdf_term_cache_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <dispatch/dispatch.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// minimum number of bytes parsed by one worker
+#define ATLAS_RDF_NTRIPLES_MIN_PART_SIZE (256 * 1024)
+
+// maximum length of a language tag
+#define ATLAS_RDF_NTRIPLES_MAX_LANG 64
+
+struct atlas_rdf_ntriples_parser_s {
+    atlas_rdf_graph_builder_t builder;
+    
+    // terms found by their characters in the data
+    atlas_rdf_term_cache_t cache;
+    
+    // buffer for unescaped values
+    char * scratch;
+    size_t scratch_length;
+    
+    // the beginning of a line, which is not complete
+    char * pending;
+    size_t pending_length;
+    size_t pending_capacity;
+    
+    // number of the current line and the
+    // description of a syntax error
+    int line;
+    const char * error;
+};
+
+#pragma mark -
+#pragma mark Unescape
+
+static char *
+atlas_rdf_ntriples_scratch(atlas_rdf_ntriples_parser_t parser, size_t length) {
+    if (parser->scratch_length < length) {
+        parser->scratch_length = length * 2;
+        parser->scratch = realloc(parser->scratch, parser->scratch_length);
+        assert(parser->scratch != 0);
+    }
+    return parser->scratch;
+}
+
+static int
+atlas_rdf_ntriples_hex(const char * p, int num, uint32_t * value) {
+    uint32_t result = 0;
+    for (int i=0; i<num; i++) {
+        char c = p[i];
+        result <<= 4;
+        if (c >= '0' && c <= '9') {
+            result |= c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            result |= c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            result |= c - 'A' + 10;
+        } else {
+            return 0;
+        }
+    }
+    *value = result;
+    return 1;
+}
+
+char *
+atlas_rdf_ntriples_unescape_into(char * out,
+                                 const char * begin,
+                                 const char * end) {
+    const char * p = begin;
+    while (p < end) {
+        if (*p != '\\') {
+            *out++ = *p++;
+            continue;
+        }
+        
+        if (p + 1 >= end) {
+            return 0;
+        }
+        
+        uint32_t c;
+        switch (p[1]) {
+            case 't':  *out++ = '\t'; p += 2; continue;
+            case 'b':  *out++ = '\b'; p += 2; continue;
+            case 'n':  *out++ = '\n'; p += 2; continue;
+            case 'r':  *out++ = '\r'; p += 2; continue;
+            case 'f':  *out++ = '\f'; p += 2; continue;
+            case '"':  *out++ = '"';  p += 2; continue;
+            case '\'': *out++ = '\''; p += 2; continue;
+            case '\\': *out++ = '\\'; p += 2; continue;
+            case 'u':
+                if (end - p < 6 || !atlas_rdf_ntriples_hex(p + 2, 4, &c)) {
+                    return 0;
+                }
+                p += 6;
+                break;
+            case 'U':
+                if (end - p < 10 || !atlas_rdf_ntriples_hex(p + 2, 8, &c)) {
+                    return 0;
+                }
+                p += 10;
+                break;
+            default:
+                return 0;
+        }
+        
+        // encode the code point as UTF-8 (at most 4 bytes,
+        // the escape sequence has at least 6 characters)
+        if (c == 0 || c > 0x10FFFF) {
+            return 0;
+        } else if (c < 0x80) {
+            *out++ = c;
+        } else if (c < 0x800) {
+            *out++ = 0xC0 | (c >> 6);
+            *out++ = 0x80 | (c & 0x3F);
+        } else if (c < 0x10000) {
+            *out++ = 0xE0 | (c >> 12);
+            *out++ = 0x80 | ((c >> 6) & 0x3F);
+            *out++ = 0x80 | (c & 0x3F);
+        } else {
+            *out++ = 0xF0 | (c >> 18);
+            *out++ = 0x80 | ((c >> 12) & 0x3F);
+            *out++ = 0x80 | ((c >> 6) & 0x3F);
+            *out++ = 0x80 | (c & 0x3F);
+        }
+    }
+    return out;
+}
+
+// copy the characters into the scratch buffer (terminated by 0) and
+// replace the escape sequences, returns NULL if an escape sequence
+// is not valid
+static char *
+atlas_rdf_ntriples_unescape(atlas_rdf_ntriples_parser_t parser,
+                            const char * begin,
+                            const char * end) {
+    // the unescaped value is not longer than the escaped value
+    char * result = atlas_rdf_ntriples_scratch(parser, end - begin + 1);
+    char * out = atlas_rdf_ntriples_unescape_into(result, begin, end);
+    if (out == 0) {
+        return 0;
+    }
+    *out = 0;
+    return result;
+}
+
+#pragma mark -
+#pragma mark Parse Terms
+
+static void
+atlas_rdf_ntriples_skip_space(const char ** p, const char * end) {
+    while (*p < end && (**p == ' ' || **p == '\t')) {
+        (*p)++;
+    }
+}
+
+// <iri>, returns the id of the term in the builder or -1
+static int
+atlas_rdf_ntriples_parse_iri(atlas_rdf_ntriples_parser_t parser,
+                             const char ** pos,
+                             const char * end,
+                             atlas_rdf_term_t * term) {
+    const char * begin = *pos;
+    const char * p = begin + 1;
+    int escaped = 0;
+    
+    while (p < end && *p != '>') {
+        unsigned char c = *p;
+        if (c <= 0x20 || c == '<' || c == '"' || c == '{' || c == '}' ||
+            c == '|' || c == '^' || c == '`') {
+            parser->error = "Invalid character in IRI.";
+            return -1;
+        }
+        if (c == '\\') {
+            escaped = 1;
+        }
+        p++;
+    }
+    if (p == end) {
+        parser->error = "IRI is not terminated.";
+        return -1;
+    }
+    p++;
+    *pos = p;
+    
+    size_t length = p - begin;
+    int id = atlas_rdf_term_cache_lookup(parser->cache, begin, length, term);
+    if (id >= 0) {
+        return id;
+    }
+    
+    const char * value = begin + 1;
+    int value_length = length - 2;
+    if (escaped) {
+        value = atlas_rdf_ntriples_unescape(parser, begin + 1, p - 1);
+        if (value == 0) {
+            parser->error = "Invalid escape sequence in IRI.";
+            return -1;
+        }
+        value_length = strlen(value);
+    }
+    
+    // the IRI has to be absolute
+    int i = 0;
+    if (value_length == 0 || !((value[0] >= 'a' && value[0] <= 'z') || (value[0] >= 'A' && value[0] <= 'Z'))) {
+        parser->error = "IRI is not absolute.";
+        return -1;
+    }
+    while (i < value_length && value[i] != ':') {
+        char c = value[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.')) {
+            break;
+        }
+        i++;
+    }
+    if (i == value_length || value[i] != ':') {
+        parser->error = "IRI is not absolute.";
+        return -1;
+    }
+    
+    atlas_rdf_term_t iri = atlas_rdf_term_create_iri_trusted(value, value_length);
+    if (term) {
+        *term = iri;
+    }
+    return atlas_rdf_term_cache_insert(parser->cache, begin, length, iri);
+}
+
+// _:label
+static int
+atlas_rdf_ntriples_parse_blank_node(atlas_rdf_ntriples_parser_t parser,
+                                    const char ** pos,
+                                    const char * end) {
+    const char * begin = *pos;
+    const char * p = begin + 2;
+    
+    if (p > end || begin[1] != ':') {
+        parser->error = "Invalid blank node.";
+        return -1;
+    }
+    
+    while (p < end) {
+        unsigned char c = *p;
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '_' || c == '-' || c == '.' || c >= 0x80)) {
+            break;
+        }
+        p++;
+    }
+    
+    // the label does not end with a dot
+    while (p > begin + 2 && p[-1] == '.') {
+        p--;
+    }
+    if (p == begin + 2) {
+        parser->error = "Invalid blank node.";
+        return -1;
+    }
+    *pos = p;
+    
+    size_t length = p - begin;
+    int id = atlas_rdf_term_cache_lookup(parser->cache, begin, length, 0);
+    if (id >= 0) {
+        return id;
+    }
+    
+    atlas_rdf_term_t term = atlas_rdf_term_create_blank_node_trusted(begin + 2, length - 2);
+    return atlas_rdf_term_cache_insert(parser->cache, begin, length, term);
+}
+
+// "value", "value"@lang or "value"^^<iri>
+static int
+atlas_rdf_ntriples_parse_literal(atlas_rdf_ntriples_parser_t parser,
+                                 const char ** pos,
+                                 const char * end) {
+    const char * begin = *pos;
+    const char * p = begin + 1;
+    
+    while (p < end && *p != '"') {
+        if (*p == '\\') {
+            p++;
+        }
+        p++;
+    }
+    if (p >= end) {
+        parser->error = "Literal is not terminated.";
+        return -1;
+    }
+    const char * value_end = p;
+    p++;
+    
+    // language tag or type
+    const char * lang = 0;
+    size_t lang_length = 0;
+    atlas_rdf_term_t type = 0;
+    if (p < end && *p == '@') {
+        lang = ++p;
+        while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') ||
+                           (*p >= '0' && *p <= '9') || *p == '-')) {
+            p++;
+        }
+        lang_length = p - lang;
+        if (lang_length == 0 || lang_length >= ATLAS_RDF_NTRIPLES_MAX_LANG) {
+            parser->error = "Invalid language tag.";
+            return -1;
+        }
+    } else if (p + 1 < end && p[0] == '^' && p[1] == '^') {
+        p += 2;
+        if (p >= end || *p != '<') {
+            parser->error = "Type of literal is not an IRI.";
+            return -1;
+        }
+        if (atlas_rdf_ntriples_parse_iri(parser, &p, end, &type) < 0) {
+            return -1;
+        }
+    }
+    *pos = p;
+    
+    size_t length = p - begin;
+    int id = atlas_rdf_term_cache_lookup(parser->cache, begin, length, 0);
+    if (id >= 0) {
+        return id;
+    }
+    
+    // the value is copied, because it is not terminated by 0
+    char * value = atlas_rdf_ntriples_unescape(parser, begin + 1, value_end);
+    if (value == 0) {
+        parser->error = "Invalid escape sequence in literal.";
+        return -1;
+    }
+    
+    __block int failed = 0;
+    atlas_error_handler err = ^(int e, const char * msg){
+        failed = 1;
+    };
+    
+    atlas_rdf_term_t term;
+    if (type) {
+        term = atlas_rdf_term_create_typed(value, type, err);
+    } else if (lang) {
+        char tag[ATLAS_RDF_NTRIPLES_MAX_LANG];
+        memcpy(tag, lang, lang_length);
+        tag[lang_length] = 0;
+        term = atlas_rdf_term_create_string(value, tag, err);
+    } else {
+        term = atlas_rdf_term_create_string(value, 0, err);
+    }
+    if (term == 0 || failed) {
+        if (term) {
+            lz_release(term);
+        }
+        parser->error = lang ? "Invalid language tag." : "Invalid literal.";
+        return -1;
+    }
+    
+    return atlas_rdf_term_cache_insert(parser->cache, begin, length, term);
+}
+
+#pragma mark -
+#pragma mark Parse Lines
+
+static int
+atlas_rdf_ntriples_parse_line(atlas_rdf_ntriples_parser_t parser,
+                              const char * p,
+                              const char * end) {
+    parser->line++;
+    
+    // ignore the carriage return of a windows line break
+    if (end > p && end[-1] == '\r') {
+        end--;
+    }
+    
+    // empty lines and comments
+    atlas_rdf_ntriples_skip_space(&p, end);
+    if (p == end || *p == '#') {
+        return 1;
+    }
+    
+    int subject, predicate, object;
+    
+    // subject
+    if (*p == '<') {
+        subject = atlas_rdf_ntriples_parse_iri(parser, &p, end, 0);
+    } else if (*p == '_') {
+        subject = atlas_rdf_ntriples_parse_blank_node(parser, &p, end);
+    } else {
+        parser->error = "Subject is not an IRI or a blank node.";
+        return 0;
+    }
+    if (subject < 0) {
+        return 0;
+    }
+    atlas_rdf_ntriples_skip_space(&p, end);
+    
+    // predicate
+    if (p < end && *p == '<') {
+        predicate = atlas_rdf_ntriples_parse_iri(parser, &p, end, 0);
+    } else {
+        parser->error = "Predicate is not an IRI.";
+        return 0;
+    }
+    if (predicate < 0) {
+        return 0;
+    }
+    atlas_rdf_ntriples_skip_space(&p, end);
+    
+    // object
+    if (p < end && *p == '<') {
+        object = atlas_rdf_ntriples_parse_iri(parser, &p, end, 0);
+    } else if (p < end && *p == '_') {
+        object = atlas_rdf_ntriples_parse_blank_node(parser, &p, end);
+    } else if (p < end && *p == '"') {
+        object = atlas_rdf_ntriples_parse_literal(parser, &p, end);
+    } else {
+        parser->error = "Object is not an IRI, a blank node or a literal.";
+        return 0;
+    }
+    if (object < 0) {
+        return 0;
+    }
+    atlas_rdf_ntriples_skip_space(&p, end);
+    
+    // end of the statement
+    if (p == end || *p != '.') {
+        parser->error = "Statement is not terminated by a dot.";
+        return 0;
+    }
+    p++;
+    atlas_rdf_ntriples_skip_space(&p, end);
+    if (p != end && *p != '#') {
+        parser->error = "Unexpected characters after the statement.";
+        return 0;
+    }
+    
+    // the terms have been checked while parsing
+    atlas_rdf_graph_builder_add_term_ids(parser->builder, subject, predicate, object);
+    return 1;
+}
+
+static void
+atlas_rdf_ntriples_append_pending(atlas_rdf_ntriples_parser_t parser,
+                                  const char * data,
+                                  size_t length) {
+    if (parser->pending_length + length > parser->pending_capacity) {
+        parser->pending_capacity = (parser->pending_length + length) * 2;
+        parser->pending = realloc(parser->pending, parser->pending_capacity);
+        assert(parser->pending != 0);
+    }
+    memcpy(parser->pending + parser->pending_length, data, length);
+    parser->pending_length += length;
+}
+
+// parse the complete lines, returns 0 on a syntax error
+static int
+atlas_rdf_ntriples_parse_data(atlas_rdf_ntriples_parser_t parser,
+                              const char * data,
+                              size_t length) {
+    const char * p = data;
+    const char * end = data + length;
+    
+    // complete the pending line
+    if (parser->pending_length > 0) {
+        const char * nl = memchr(p, '\n', end - p);
+        if (nl == 0) {
+            atlas_rdf_ntriples_append_pending(parser, p, end - p);
+            return 1;
+        }
+        atlas_rdf_ntriples_append_pending(parser, p, nl - p);
+        size_t pending_length = parser->pending_length;
+        parser->pending_length = 0;
+        if (!atlas_rdf_ntriples_parse_line(parser, parser->pending, parser->pending + pending_length)) {
+            return 0;
+        }
+        p = nl + 1;
+    }
+    
+    while (p < end) {
+        const char * nl = memchr(p, '\n', end - p);
+        if (nl == 0) {
+            atlas_rdf_ntriples_append_pending(parser, p, end - p);
+            break;
+        }
+        if (!atlas_rdf_ntriples_parse_line(parser, p, nl)) {
+            return 0;
+        }
+        p = nl + 1;
+    }
+    return 1;
+}
+
+static void
+atlas_rdf_ntriples_report(atlas_rdf_ntriples_parser_t parser,
+                          int line,
+                          atlas_error_handler err) {
+    char * buff;
+    asprintf(&buff, "Syntax error in line %d: %s", line, parser->error);
+    err(1, buff);
+    free(buff);
+}
+
+#pragma mark -
+#pragma mark Create a N-Triples Parser
+
+atlas_rdf_ntriples_parser_t
+atlas_rdf_ntriples_parser_create(atlas_rdf_graph_builder_t builder) {
+    assert(builder != 0);
+    
+    atlas_rdf_ntriples_parser_t parser = malloc(sizeof(struct atlas_rdf_ntriples_parser_s));
+    assert(parser != 0);
+    
+    parser->builder = builder;
+    
+    parser->cache = atlas_rdf_term_cache_create(builder);
+    
+    parser->scratch = 0;
+    parser->scratch_length = 0;
+    
+    parser->pending = 0;
+    parser->pending_length = 0;
+    parser->pending_capacity = 0;
+    
+    parser->line = 0;
+    parser->error = 0;
+    
+    return parser;
+}
+
+void
+atlas_rdf_ntriples_parser_free(atlas_rdf_ntriples_parser_t parser) {
+    if (parser) {
+        atlas_rdf_term_cache_free(parser->cache);
+        free(parser->scratch);
+        free(parser->pending);
+        free(parser);
+    }
+}
+
+#pragma mark -
+#pragma mark Parse N-Triples
+
+int
+atlas_rdf_ntriples_parser_parse(atlas_rdf_ntriples_parser_t parser,
+                                const char * data,
+                                size_t length,
+                                atlas_error_handler err) {
+    assert(parser != 0);
+    if (!atlas_rdf_ntriples_parse_data(parser, data, length)) {
+        atlas_rdf_ntriples_report(parser, parser->line, err);
+        return 0;
+    }
+    return 1;
+}
+
+int
+atlas_rdf_ntriples_parser_finish(atlas_rdf_ntriples_parser_t parser,
+                                 atlas_error_handler err) {
+    assert(parser != 0);
+    if (parser->pending_length > 0) {
+        size_t length = parser->pending_length;
+        parser->pending_length = 0;
+        if (!atlas_rdf_ntriples_parse_line(parser, parser->pending, parser->pending + length)) {
+            atlas_rdf_ntriples_report(parser, parser->line, err);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Graph from N-Triples
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_from_ntriples(const char * data,
+                                     size_t length,
+                                     atlas_error_handler err) {
+    
+    // split the data at line boundaries
+    size_t num_parts = length / ATLAS_RDF_NTRIPLES_MIN_PART_SIZE;
+    if (num_parts > atlas_num_cpus()) {
+        num_parts = atlas_num_cpus();
+    }
+    if (num_parts == 0) {
+        num_parts = 1;
+    }
+    
+    size_t * bounds = malloc(sizeof(size_t) * (num_parts + 1));
+    assert(bounds != 0);
+    bounds[0] = 0;
+    for (size_t i=1; i<num_parts; i++) {
+        size_t pos = length / num_parts * i;
+        if (pos < bounds[i - 1]) {
+            pos = bounds[i - 1];
+        }
+        const char * nl = memchr(data + pos, '\n', length - pos);
+        bounds[i] = nl ? (size_t)(nl - data) + 1 : length;
+    }
+    bounds[num_parts] = length;
+    
+    // parse the parts concurrently, each part with its own builder
+    atlas_rdf_graph_t * graphs = calloc(num_parts, sizeof(atlas_rdf_graph_t));
+    const char ** errors = calloc(num_parts, sizeof(char *));
+    int * lines = calloc(num_parts, sizeof(int));
+    assert(graphs != 0);
+    assert(errors != 0);
+    assert(lines != 0);
+    
+    dispatch_apply(num_parts, dispatch_get_global_queue(0, 0), ^(size_t i){
+        atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+        atlas_rdf_ntriples_parser_t parser = atlas_rdf_ntriples_parser_create(builder);
+        
+        const char * p = data + bounds[i];
+        size_t n = bounds[i + 1] - bounds[i];
+        if (atlas_rdf_ntriples_parse_data(parser, p, n) &&
+            atlas_rdf_ntriples_parser_finish(parser, ^(int e, const char * msg){})) {
+            graphs[i] = atlas_rdf_graph_builder_commit(builder, ^(int e, const char * msg){});
+        } else {
+            errors[i] = parser->error;
+            lines[i] = parser->line;
+        }
+        
+        atlas_rdf_ntriples_parser_free(parser);
+        atlas_rdf_graph_builder_free(builder);
+    });
+    
+    atlas_rdf_graph_t result = 0;
+    int failed = 0;
+    
+    // report the first syntax error, the line is
+    // relative to the beginning of the part
+    for (size_t i=0; i<num_parts && !failed; i++) {
+        if (errors[i]) {
+            int line = lines[i];
+            for (size_t k=0; k<bounds[i]; k++) {
+                if (data[k] == '\n') {
+                    line++;
+                }
+            }
+            char * buff;
+            asprintf(&buff, "Syntax error in line %d: %s", line, errors[i]);
+            err(1, buff);
+            free(buff);
+            failed = 1;
+        }
+    }
+    
+    // merge the graphs of the parts
+    if (!failed) {
+        if (num_parts == 1) {
+            result = lz_retain(graphs[0]);
+        } else {
+            atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+            for (size_t i=0; i<num_parts; i++) {
+                atlas_rdf_graph_builder_add_graph(builder, graphs[i], 0, 0);
+            }
+            result = atlas_rdf_graph_builder_commit(builder, err);
+            atlas_rdf_graph_builder_free(builder);
+        }
+    }
+    
+    for (size_t i=0; i<num_parts; i++) {
+        if (graphs[i]) {
+            lz_release(graphs[i]);
+        }
+    }
+    free(graphs);
+    free(errors);
+    free(lines);
+    free(bounds);
+    
+    return result;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_open_ntriples(const char * path,
+                              atlas_error_handler err) {
+    assert(path != 0);
+    
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        char * buff;
+        asprintf(&buff, "Could not open N-Triples file %s: %s", path, strerror(errno));
+        err(1, buff);
+        free(buff);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+    
+    // an empty file can not be mapped
+    if (st.st_size == 0) {
+        close(fd);
+        return atlas_rdf_graph_create(0, 0, err);
+    }
+    
+    void * data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        char * buff;
+        asprintf(&buff, "Could not map N-Triples file %s: %s", path, strerror(errno));
+        err(1, buff);
+        free(buff);
+        return 0;
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_from_ntriples(data, st.st_size, err);
+    munmap(data, st.st_size);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Write N-Triples and N-Quads
+
+// size of the buffer, which is passed to the sink
+#define ATLAS_RDF_NTRIPLES_WRITE_BUFFER (1024 * 1024)
+
+typedef struct {
+    char * data;
+    size_t length;
+    size_t capacity;
+} __ntriples_table;
+
+typedef struct {
+    atlas_rdf_ntriples_sink_t sink;
+    char * buffer;
+    size_t length;
+    int failed;
+} __ntriples_writer;
+
+typedef struct {
+    const char * repr;
+    size_t length;
+    uint32_t id;
+} __ntriples_sorted_term;
+
+static void
+atlas_rdf_ntriples_table_append(__ntriples_table * table, const char * data, size_t length) {
+    if (table->length + length > table->capacity) {
+        table->capacity = (table->length + length) * 2;
+        table->data = realloc(table->data, table->capacity);
+        assert(table->data != 0);
+    }
+    memcpy(table->data + table->length, data, length);
+    table->length += length;
+}
+
+static void
+atlas_rdf_ntriples_flush(__ntriples_writer * writer) {
+    if (writer->length > 0 && !writer->failed) {
+        writer->failed = !writer->sink(writer->buffer, writer->length);
+    }
+    writer->length = 0;
+}
+
+static void
+atlas_rdf_ntriples_emit(__ntriples_writer * writer, const char * data, size_t length) {
+    if (writer->length + length > ATLAS_RDF_NTRIPLES_WRITE_BUFFER) {
+        atlas_rdf_ntriples_flush(writer);
+        
+        // a piece, which does not fit into the buffer
+        // is passed to the sink directly
+        if (length > ATLAS_RDF_NTRIPLES_WRITE_BUFFER) {
+            if (!writer->failed) {
+                writer->failed = !writer->sink(data, length);
+            }
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->length, data, length);
+    writer->length += length;
+}
+
+static int
+atlas_rdf_ntriples_cmp_term(const void * a, const void * b) {
+    const __ntriples_sorted_term * t1 = a;
+    const __ntriples_sorted_term * t2 = b;
+    int cmp = memcmp(t1->repr, t2->repr, t1->length < t2->length ? t1->length : t2->length);
+    if (cmp != 0) {
+        return cmp;
+    }
+    return t1->length < t2->length ? -1 : (t1->length > t2->length ? 1 : 0);
+}
+
+static int
+atlas_rdf_ntriples_cmp_statement(const void * a, const void * b) {
+    const __graph * s1 = a;
+    const __graph * s2 = b;
+    if (s1->subject != s2->subject) {
+        return s1->subject < s2->subject ? -1 : 1;
+    }
+    if (s1->predicate != s2->predicate) {
+        return s1->predicate < s2->predicate ? -1 : 1;
+    }
+    if (s1->object != s2->object) {
+        return s1->object < s2->object ? -1 : 1;
+    }
+    return 0;
+}
+
+static int
+atlas_rdf_ntriples_write(atlas_rdf_graph_t graph,
+                         atlas_rdf_term_t name,
+                         int options,
+                         atlas_rdf_ntriples_sink_t sink,
+                         atlas_error_handler err) {
+    assert(graph != 0);
+    assert(sink != 0);
+    
+    if (name && atlas_rdf_term_type(name) != IRI && atlas_rdf_term_type(name) != BLANK_NODE) {
+        err(1, "The name of a graph has to be an IRI or a blank node.");
+        return 0;
+    }
+    
+    int num_statements = atlas_rdf_graph_length(graph);
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(1024);
+    __graph * statements = atlas_rdf_graph_flatten(graph, dict);
+    int num_terms = atlas_rdf_term_dict_length(dict);
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(dict);
+    
+    // the representation of each distinct term, one after another
+    __ntriples_table table = {0, 0, 0};
+    __ntriples_table * t = &table;
+    void(^append)(const char * data, size_t length) = ^(const char * data, size_t length){
+        atlas_rdf_ntriples_table_append(t, data, length);
+    };
+    size_t * offsets = malloc(sizeof(size_t) * (num_terms + 1));
+    assert(offsets != 0);
+    for (int i=0; i<num_terms; i++) {
+        offsets[i] = table.length;
+        atlas_rdf_term_ntriples(terms[i], append);
+    }
+    offsets[num_terms] = table.length;
+    
+    // the end of each line, including the name of the graph
+    size_t suffix_begin = table.length;
+    if (name) {
+        append(" ", 1);
+        atlas_rdf_term_ntriples(name, append);
+    }
+    append(" .\n", 3);
+    size_t suffix_length = table.length - suffix_begin;
+    
+    // sort the terms by their representation and the
+    // statements by the positions of their terms
+    uint32_t * order = 0;
+    if (options & ATLAS_RDF_NTRIPLES_SORTED) {
+        __ntriples_sorted_term * sorted = malloc(sizeof(__ntriples_sorted_term) * num_terms);
+        uint32_t * rank = malloc(sizeof(uint32_t) * num_terms);
+        order = malloc(sizeof(uint32_t) * num_terms);
+        assert(sorted != 0 || num_terms == 0);
+        assert(rank != 0 || num_terms == 0);
+        assert(order != 0 || num_terms == 0);
+        
+        for (int i=0; i<num_terms; i++) {
+            sorted[i].repr = table.data + offsets[i];
+            sorted[i].length = offsets[i + 1] - offsets[i];
+            sorted[i].id = i;
+        }
+        qsort(sorted, num_terms, sizeof(__ntriples_sorted_term), atlas_rdf_ntriples_cmp_term);
+        for (int i=0; i<num_terms; i++) {
+            rank[sorted[i].id] = i;
+            order[i] = sorted[i].id;
+        }
+        
+        for (int i=0; i<num_statements; i++) {
+            statements[i].subject = rank[statements[i].subject];
+            statements[i].predicate = rank[statements[i].predicate];
+            statements[i].object = rank[statements[i].object];
+        }
+        qsort(statements, num_statements, sizeof(__graph), atlas_rdf_ntriples_cmp_statement);
+        
+        free(sorted);
+        free(rank);
+    }
+    
+    __ntriples_writer writer;
+    writer.sink = sink;
+    writer.buffer = malloc(ATLAS_RDF_NTRIPLES_WRITE_BUFFER);
+    assert(writer.buffer != 0);
+    writer.length = 0;
+    writer.failed = 0;
+    
+    for (int i=0; i<num_statements && !writer.failed; i++) {
+        uint32_t ids[3] = {statements[i].subject, statements[i].predicate, statements[i].object};
+        for (int k=0; k<3; k++) {
+            uint32_t id = order ? order[ids[k]] : ids[k];
+            atlas_rdf_ntriples_emit(&writer, table.data + offsets[id], offsets[id + 1] - offsets[id]);
+            if (k < 2) {
+                atlas_rdf_ntriples_emit(&writer, " ", 1);
+            }
+        }
+        atlas_rdf_ntriples_emit(&writer, table.data + suffix_begin, suffix_length);
+    }
+    atlas_rdf_ntriples_flush(&writer);
+    
+    if (writer.failed) {
+        err(1, "Could not write the statements.");
+    }
+    
+    free(writer.buffer);
+    free(order);
+    free(offsets);
+    free(table.data);
+    free(statements);
+    atlas_rdf_term_dict_free(dict);
+    
+    return !writer.failed;
+}
+
+static int
+atlas_rdf_ntriples_write_fd(atlas_rdf_graph_t graph,
+                            atlas_rdf_term_t name,
+                            int fd,
+                            int options,
+                            atlas_error_handler err) {
+    __block int error = 0;
+    return atlas_rdf_ntriples_write(graph, name, options, ^(const char * data, size_t length){
+        while (length > 0) {
+            ssize_t n = write(fd, data, length);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = errno;
+                return 0;
+            }
+            data += n;
+            length -= n;
+        }
+        return 1;
+    }, ^(int e, const char * msg){
+        if (error) {
+            char * buff;
+            asprintf(&buff, "%s (%s)", msg, strerror(error));
+            err(e, buff);
+            free(buff);
+        } else {
+            err(e, msg);
+        }
+    });
+}
+
+int
+atlas_rdf_graph_write_ntriples(atlas_rdf_graph_t graph,
+                               int fd,
+                               int options,
+                               atlas_error_handler err) {
+    return atlas_rdf_ntriples_write_fd(graph, 0, fd, options, err);
+}
+
+int
+atlas_rdf_graph_write_ntriples_sink(atlas_rdf_graph_t graph,
+                                    int options,
+                                    atlas_rdf_ntriples_sink_t sink,
+                                    atlas_error_handler err) {
+    return atlas_rdf_ntriples_write(graph, 0, options, sink, err);
+}
+
+int
+atlas_rdf_graph_write_nquads(atlas_rdf_graph_t graph,
+                             atlas_rdf_term_t name,
+                             int fd,
+                             int options,
+                             atlas_error_handler err) {
+    return atlas_rdf_ntriples_write_fd(graph, name, fd, options, err);
+}
+
+int
+atlas_rdf_graph_write_nquads_sink(atlas_rdf_graph_t graph,
+                                  atlas_rdf_term_t name,
+                                  int options,
+                                  atlas_rdf_ntriples_sink_t sink,
+                                  atlas_error_handler err) {
+    return atlas_rdf_ntriples_write(graph, name, options, sink, err);
+}
@@ -0,0 +1,39 @@
+/*
+ *  atlas_rdf_ntriples_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_NTRIPLES_IMPL_H_
+#define _ATLAS_RDF_NTRIPLES_IMPL_H_
+
+#include <atlas/rdf/ntriples.h>
+
+/*! Copy the characters from begin to end and replace the escape
+ *  sequences of N-Triples (\t, \b, \n, \r, \f, \", \', \\, \uXXXX
+ *  and \UXXXXXXXX). The result is not longer than the input and is
+ *  not terminated.
+ *
+ *  \return The end of the copied characters or NULL, if an
+ *          escape sequence is not valid.
+ */
+char *
+atlas_rdf_ntriples_unescape_into(char * out,
+                                 const char * begin,
+                                 const char * end);
+
+#endif // _ATLAS_RDF_NTRIPLES_IMPL_H_
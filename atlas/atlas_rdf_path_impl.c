@@ -0,0 +1,627 @@
+/*
+ *  atlas_rdf_path_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_path_impl.h"
+#include "atlas_rdf_graph_adjacency_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+#define ATLAS_RDF_PATH_PREDICATE    0
+#define ATLAS_RDF_PATH_SEQUENCE     1
+#define ATLAS_RDF_PATH_ALTERNATIVE  2
+#define ATLAS_RDF_PATH_ZERO_OR_MORE 3
+#define ATLAS_RDF_PATH_ONE_OR_MORE  4
+
+// minimal size of a frontier to expand it concurrently
+#define ATLAS_RDF_PATH_PARALLEL_THRESHOLD 4096
+
+// the references of a path are the predicate or the sub paths
+typedef struct {
+    uint32_t kind;
+} __path;
+
+// a path compiled for the adjacency index of a graph, the
+// predicate is the id of the term or -1 if it is not in the graph
+typedef struct __path_node_s {
+    uint32_t kind;
+    int32_t predicate;
+    struct __path_node_s * first;
+    struct __path_node_s * second;
+} __path_node;
+
+// a set of term ids, the bitset tells if an id is in
+// the set and the list contains the ids in the set
+typedef struct {
+    uint64_t * bits;
+    uint32_t * ids;
+    uint32_t length;
+    uint32_t capacity;
+} __path_set;
+
+// sets of a search are reused, because the size of the
+// bitsets depends on the size of the graph
+typedef struct {
+    struct atlas_rdf_graph_adjacency_s * adjacency;
+    uint32_t num_terms;
+    uint32_t num_words;
+    int num_free;
+    __path_set * free[16];
+} __path_context;
+
+#pragma mark -
+#pragma mark Create a RDF Property Path
+
+static atlas_rdf_path_t
+atlas_rdf_path_create(uint32_t kind, int num_refs, lz_obj ref1, lz_obj ref2) {
+    int size = sizeof(__path);
+    __path * path = malloc(size);
+    assert(path != 0);
+    path->kind = kind;
+    
+    if (num_refs == 1) {
+        return lz_obj_new(path, size, ^{
+            free(path);
+        }, 1, ref1);
+    } else {
+        return lz_obj_new(path, size, ^{
+            free(path);
+        }, 2, ref1, ref2);
+    }
+}
+
+atlas_rdf_path_t
+atlas_rdf_path_create_predicate(atlas_rdf_term_t predicate,
+                                atlas_error_handler err) {
+    assert(predicate != 0);
+    
+    if (!atlas_rdf_term_is_type(predicate, IRI)) {
+        char * repr = atlas_rdf_term_repr(predicate);
+        char * buff;
+        asprintf(&buff, "Predicate of a path is not an iri: %s", repr);
+        err(1, buff);
+        free(repr);
+        free(buff);
+        return 0;
+    }
+    
+    return atlas_rdf_path_create(ATLAS_RDF_PATH_PREDICATE, 1, predicate, 0);
+}
+
+atlas_rdf_path_t
+atlas_rdf_path_create_sequence(atlas_rdf_path_t path1,
+                               atlas_rdf_path_t path2) {
+    assert(path1 != 0);
+    assert(path2 != 0);
+    return atlas_rdf_path_create(ATLAS_RDF_PATH_SEQUENCE, 2, path1, path2);
+}
+
+atlas_rdf_path_t
+atlas_rdf_path_create_alternative(atlas_rdf_path_t path1,
+                                  atlas_rdf_path_t path2) {
+    assert(path1 != 0);
+    assert(path2 != 0);
+    return atlas_rdf_path_create(ATLAS_RDF_PATH_ALTERNATIVE, 2, path1, path2);
+}
+
+atlas_rdf_path_t
+atlas_rdf_path_create_zero_or_more(atlas_rdf_path_t path) {
+    assert(path != 0);
+    return atlas_rdf_path_create(ATLAS_RDF_PATH_ZERO_OR_MORE, 1, path, 0);
+}
+
+atlas_rdf_path_t
+atlas_rdf_path_create_one_or_more(atlas_rdf_path_t path) {
+    assert(path != 0);
+    return atlas_rdf_path_create(ATLAS_RDF_PATH_ONE_OR_MORE, 1, path, 0);
+}
+
+#pragma mark -
+#pragma mark Compile a RDF Property Path
+
+static __path_node *
+atlas_rdf_path_compile(atlas_rdf_path_t path,
+                       struct atlas_rdf_graph_adjacency_s * adjacency) {
+    __path_node * node = malloc(sizeof(__path_node));
+    assert(node != 0);
+    
+    lz_obj_sync(path, ^(void * data, uint32_t length){
+        node->kind = ((__path *)data)->kind;
+    });
+    node->predicate = -1;
+    node->first = 0;
+    node->second = 0;
+    
+    switch (node->kind) {
+        case ATLAS_RDF_PATH_PREDICATE:
+            node->predicate = atlas_rdf_term_dict_lookup(adjacency->dict, lz_obj_weak_ref(path, 0));
+            break;
+        case ATLAS_RDF_PATH_SEQUENCE:
+        case ATLAS_RDF_PATH_ALTERNATIVE:
+            node->first = atlas_rdf_path_compile(lz_obj_weak_ref(path, 0), adjacency);
+            node->second = atlas_rdf_path_compile(lz_obj_weak_ref(path, 1), adjacency);
+            break;
+        default:
+            node->first = atlas_rdf_path_compile(lz_obj_weak_ref(path, 0), adjacency);
+            break;
+    }
+    return node;
+}
+
+static void
+atlas_rdf_path_node_free(__path_node * node) {
+    if (node) {
+        atlas_rdf_path_node_free(node->first);
+        atlas_rdf_path_node_free(node->second);
+        free(node);
+    }
+}
+
+// check if the path matches the empty route from a term to itself
+static int
+atlas_rdf_path_node_nullable(__path_node * node) {
+    switch (node->kind) {
+        case ATLAS_RDF_PATH_PREDICATE:
+            return 0;
+        case ATLAS_RDF_PATH_SEQUENCE:
+            return atlas_rdf_path_node_nullable(node->first) &&
+                   atlas_rdf_path_node_nullable(node->second);
+        case ATLAS_RDF_PATH_ALTERNATIVE:
+            return atlas_rdf_path_node_nullable(node->first) ||
+                   atlas_rdf_path_node_nullable(node->second);
+        case ATLAS_RDF_PATH_ZERO_OR_MORE:
+            return 1;
+        default:
+            return atlas_rdf_path_node_nullable(node->first);
+    }
+}
+
+#pragma mark -
+#pragma mark Sets of Terms
+
+static void
+atlas_rdf_path_context_init(__path_context * ctx,
+                            struct atlas_rdf_graph_adjacency_s * adjacency) {
+    ctx->adjacency = adjacency;
+    ctx->num_terms = atlas_rdf_term_dict_length(adjacency->dict);
+    ctx->num_words = (ctx->num_terms + 63) / 64;
+    ctx->num_free = 0;
+}
+
+static void
+atlas_rdf_path_context_free(__path_context * ctx) {
+    for (int i=0; i<ctx->num_free; i++) {
+        free(ctx->free[i]->bits);
+        free(ctx->free[i]->ids);
+        free(ctx->free[i]);
+    }
+    ctx->num_free = 0;
+}
+
+static __path_set *
+atlas_rdf_path_set_get(__path_context * ctx) {
+    if (ctx->num_free > 0) {
+        return ctx->free[--ctx->num_free];
+    }
+    __path_set * set = malloc(sizeof(__path_set));
+    assert(set != 0);
+    set->bits = calloc(ctx->num_words + 1, sizeof(uint64_t));
+    assert(set->bits != 0);
+    set->ids = 0;
+    set->length = 0;
+    set->capacity = 0;
+    return set;
+}
+
+static void
+atlas_rdf_path_set_put(__path_context * ctx, __path_set * set) {
+    
+    // clear the bits of the ids, unless the set is dense
+    if (set->length < ctx->num_words) {
+        for (uint32_t i=0; i<set->length; i++) {
+            set->bits[set->ids[i] >> 6] = 0;
+        }
+    } else {
+        memset(set->bits, 0, sizeof(uint64_t) * ctx->num_words);
+    }
+    set->length = 0;
+    
+    if (ctx->num_free < 16) {
+        ctx->free[ctx->num_free++] = set;
+    } else {
+        free(set->bits);
+        free(set->ids);
+        free(set);
+    }
+}
+
+static void
+atlas_rdf_path_set_append(__path_set * set, uint32_t id) {
+    if (set->length == set->capacity) {
+        set->capacity = set->capacity ? set->capacity * 2 : 16;
+        set->ids = realloc(set->ids, sizeof(uint32_t) * set->capacity);
+        assert(set->ids != 0);
+    }
+    set->ids[set->length++] = id;
+}
+
+static inline int
+atlas_rdf_path_set_contains(__path_set * set, uint32_t id) {
+    return (set->bits[id >> 6] & (1ull << (id & 63))) != 0;
+}
+
+// add an id to the set and return 1 if it has not been in the set
+static inline int
+atlas_rdf_path_set_add(__path_set * set, uint32_t id) {
+    uint64_t mask = 1ull << (id & 63);
+    if (set->bits[id >> 6] & mask) {
+        return 0;
+    }
+    set->bits[id >> 6] |= mask;
+    atlas_rdf_path_set_append(set, id);
+    return 1;
+}
+
+#pragma mark -
+#pragma mark Evaluate a RDF Property Path
+
+typedef struct {
+    uint32_t length;
+    uint32_t capacity;
+    uint32_t * ids;
+} __path_list;
+
+// add the objects of the statements with the predicate
+// and a subject in the frontier to the set
+static void
+atlas_rdf_path_expand(__path_context * ctx,
+                      __path_set * frontier,
+                      int32_t predicate,
+                      __path_set * out) {
+    if (predicate < 0 || frontier->length == 0) {
+        return;
+    }
+    
+    __adjacency_rows * rows = &ctx->adjacency->outgoing;
+    
+    if (frontier->length < ATLAS_RDF_PATH_PARALLEL_THRESHOLD) {
+        for (uint32_t i=0; i<frontier->length; i++) {
+            uint32_t id = frontier->ids[i];
+            for (uint32_t e=rows->offsets[id]; e<rows->offsets[id + 1]; e++) {
+                if (rows->edges[2 * e] == (uint32_t)predicate) {
+                    atlas_rdf_path_set_add(out, rows->edges[2 * e + 1]);
+                }
+            }
+        }
+        return;
+    }
+    
+    // expand a large frontier concurrently, each worker claims
+    // the ids in the bitset atomically and collects them in a
+    // private list, the lists are appended afterwards
+    uint64_t * bits = out->bits;
+    uint32_t * ids = frontier->ids;
+    atlas_apply_chunked(frontier->length, 0, ^{
+        __path_list * list = calloc(1, sizeof(__path_list));
+        assert(list != 0);
+        return (void *)list;
+    }, ^(void * state, size_t begin, size_t end){
+        __path_list * list = state;
+        for (size_t i=begin; i<end; i++) {
+            uint32_t id = ids[i];
+            for (uint32_t e=rows->offsets[id]; e<rows->offsets[id + 1]; e++) {
+                if (rows->edges[2 * e] != (uint32_t)predicate) {
+                    continue;
+                }
+                uint32_t object = rows->edges[2 * e + 1];
+                uint64_t mask = 1ull << (object & 63);
+                if (bits[object >> 6] & mask ||
+                    __sync_fetch_and_or(&bits[object >> 6], mask) & mask) {
+                    continue;
+                }
+                if (list->length == list->capacity) {
+                    list->capacity = list->capacity ? list->capacity * 2 : 64;
+                    list->ids = realloc(list->ids, sizeof(uint32_t) * list->capacity);
+                    assert(list->ids != 0);
+                }
+                list->ids[list->length++] = object;
+            }
+        }
+    }, ^(void * state){
+        __path_list * list = state;
+        for (uint32_t i=0; i<list->length; i++) {
+            atlas_rdf_path_set_append(out, list->ids[i]);
+        }
+        free(list->ids);
+        free(list);
+    });
+}
+
+// the terms reachable from the terms in the set by the path
+static __path_set *
+atlas_rdf_path_eval(__path_context * ctx,
+                    __path_node * node,
+                    __path_set * in) {
+    __path_set * out;
+    switch (node->kind) {
+        case ATLAS_RDF_PATH_PREDICATE:
+            out = atlas_rdf_path_set_get(ctx);
+            atlas_rdf_path_expand(ctx, in, node->predicate, out);
+            return out;
+        
+        case ATLAS_RDF_PATH_SEQUENCE: {
+            __path_set * tmp = atlas_rdf_path_eval(ctx, node->first, in);
+            out = atlas_rdf_path_eval(ctx, node->second, tmp);
+            atlas_rdf_path_set_put(ctx, tmp);
+            return out;
+        }
+        
+        case ATLAS_RDF_PATH_ALTERNATIVE: {
+            out = atlas_rdf_path_eval(ctx, node->first, in);
+            __path_set * tmp = atlas_rdf_path_eval(ctx, node->second, in);
+            for (uint32_t i=0; i<tmp->length; i++) {
+                atlas_rdf_path_set_add(out, tmp->ids[i]);
+            }
+            atlas_rdf_path_set_put(ctx, tmp);
+            return out;
+        }
+        
+        default: {
+            // breadth-first search, only the terms which have not
+            // been visited before are expanded in the next step
+            out = atlas_rdf_path_set_get(ctx);
+            if (node->kind == ATLAS_RDF_PATH_ZERO_OR_MORE) {
+                for (uint32_t i=0; i<in->length; i++) {
+                    atlas_rdf_path_set_add(out, in->ids[i]);
+                }
+            }
+            __path_set * reached = atlas_rdf_path_eval(ctx, node->first, in);
+            while (reached->length > 0) {
+                __path_set * frontier = atlas_rdf_path_set_get(ctx);
+                for (uint32_t i=0; i<reached->length; i++) {
+                    if (atlas_rdf_path_set_add(out, reached->ids[i])) {
+                        atlas_rdf_path_set_add(frontier, reached->ids[i]);
+                    }
+                }
+                atlas_rdf_path_set_put(ctx, reached);
+                reached = atlas_rdf_path_eval(ctx, node->first, frontier);
+                atlas_rdf_path_set_put(ctx, frontier);
+            }
+            atlas_rdf_path_set_put(ctx, reached);
+            return out;
+        }
+    }
+}
+
+// the terms reachable from a term, NULL if the term is not in the graph
+static __path_set *
+atlas_rdf_path_eval_term(__path_context * ctx,
+                         __path_node * node,
+                         atlas_rdf_term_t start) {
+    int id = atlas_rdf_term_dict_lookup(ctx->adjacency->dict, start);
+    if (id == -1) {
+        return 0;
+    }
+    __path_set * in = atlas_rdf_path_set_get(ctx);
+    atlas_rdf_path_set_add(in, id);
+    __path_set * out = atlas_rdf_path_eval(ctx, node, in);
+    atlas_rdf_path_set_put(ctx, in);
+    return out;
+}
+
+int
+atlas_rdf_graph_path_apply(atlas_rdf_graph_t graph,
+                           atlas_rdf_term_t start,
+                           atlas_rdf_path_t path,
+                           void(^iterator)(atlas_rdf_term_t term)) {
+    assert(graph != 0);
+    assert(start != 0);
+    assert(path != 0);
+    
+    __path_context ctx;
+    atlas_rdf_path_context_init(&ctx, atlas_rdf_graph_adjacency(graph));
+    __path_node * node = atlas_rdf_path_compile(path, ctx.adjacency);
+    
+    int result = 0;
+    __path_set * out = atlas_rdf_path_eval_term(&ctx, node, start);
+    if (out) {
+        atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(ctx.adjacency->dict);
+        if (iterator) {
+            for (uint32_t i=0; i<out->length; i++) {
+                iterator(terms[out->ids[i]]);
+            }
+        }
+        result = out->length;
+        atlas_rdf_path_set_put(&ctx, out);
+    } else if (atlas_rdf_path_node_nullable(node)) {
+        // a term, which is not in the graph, reaches itself
+        if (iterator) {
+            iterator(start);
+        }
+        result = 1;
+    }
+    
+    atlas_rdf_path_node_free(node);
+    atlas_rdf_path_context_free(&ctx);
+    return result;
+}
+
+int
+atlas_rdf_graph_path_contains(atlas_rdf_graph_t graph,
+                              atlas_rdf_term_t subject,
+                              atlas_rdf_path_t path,
+                              atlas_rdf_term_t object) {
+    assert(graph != 0);
+    assert(subject != 0);
+    assert(path != 0);
+    assert(object != 0);
+    
+    __path_context ctx;
+    atlas_rdf_path_context_init(&ctx, atlas_rdf_graph_adjacency(graph));
+    __path_node * node = atlas_rdf_path_compile(path, ctx.adjacency);
+    
+    int result = 0;
+    __path_set * out = atlas_rdf_path_eval_term(&ctx, node, subject);
+    if (out) {
+        int id = atlas_rdf_term_dict_lookup(ctx.adjacency->dict, object);
+        result = id != -1 && atlas_rdf_path_set_contains(out, id);
+        atlas_rdf_path_set_put(&ctx, out);
+    } else {
+        result = atlas_rdf_path_node_nullable(node) && atlas_rdf_term_eq(subject, object);
+    }
+    
+    atlas_rdf_path_node_free(node);
+    atlas_rdf_path_context_free(&ctx);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Materialize the Closure of a RDF Property Path
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_path_closure(atlas_rdf_graph_t graph,
+                                    atlas_rdf_path_t path,
+                                    atlas_rdf_term_t predicate,
+                                    atlas_error_handler err) {
+    assert(graph != 0);
+    assert(path != 0);
+    assert(predicate != 0);
+    
+    if (!atlas_rdf_term_is_type(predicate, IRI)) {
+        char * repr = atlas_rdf_term_repr(predicate);
+        char * buff;
+        asprintf(&buff, "Predicate of the closure is not an iri: %s", repr);
+        err(1, buff);
+        free(repr);
+        free(buff);
+        return 0;
+    }
+    
+    struct atlas_rdf_graph_adjacency_s * adjacency = atlas_rdf_graph_adjacency(graph);
+    uint32_t num_terms = atlas_rdf_term_dict_length(adjacency->dict);
+    __path_node * node = atlas_rdf_path_compile(path, adjacency);
+    int nullable = atlas_rdf_path_node_nullable(node);
+    
+    // the nodes are processed concurrently, each worker has its
+    // own sets and collects the reachable terms as pairs of ids
+    __block __path_list pairs = {0, 0, 0};
+    atlas_apply_chunked(num_terms, 0, ^{
+        __path_context * ctx = malloc(sizeof(__path_context));
+        __path_list * list = calloc(1, sizeof(__path_list));
+        assert(ctx != 0);
+        assert(list != 0);
+        atlas_rdf_path_context_init(ctx, adjacency);
+        void ** state = malloc(sizeof(void *) * 2);
+        assert(state != 0);
+        state[0] = ctx;
+        state[1] = list;
+        return (void *)state;
+    }, ^(void * state, size_t begin, size_t end){
+        __path_context * ctx = ((void **)state)[0];
+        __path_list * list = ((void **)state)[1];
+        __path_set * in = atlas_rdf_path_set_get(ctx);
+        for (size_t id=begin; id<end; id++) {
+            // a term without outgoing edges only reaches itself, if it
+            // is a node (not only used as predicate) and the path is nullable
+            if (adjacency->outgoing.offsets[id] == adjacency->outgoing.offsets[id + 1] &&
+                (!nullable || adjacency->incoming.offsets[id] == adjacency->incoming.offsets[id + 1])) {
+                continue;
+            }
+            atlas_rdf_path_set_add(in, id);
+            __path_set * out = atlas_rdf_path_eval(ctx, node, in);
+            for (uint32_t i=0; i<out->length; i++) {
+                if (list->length + 2 > list->capacity) {
+                    list->capacity = list->capacity ? list->capacity * 2 : 64;
+                    list->ids = realloc(list->ids, sizeof(uint32_t) * list->capacity);
+                    assert(list->ids != 0);
+                }
+                list->ids[list->length++] = id;
+                list->ids[list->length++] = out->ids[i];
+            }
+            atlas_rdf_path_set_put(ctx, out);
+            atlas_rdf_path_set_put(ctx, in);
+            in = atlas_rdf_path_set_get(ctx);
+        }
+        atlas_rdf_path_set_put(ctx, in);
+    }, ^(void * state){
+        __path_context * ctx = ((void **)state)[0];
+        __path_list * list = ((void **)state)[1];
+        pairs.ids = realloc(pairs.ids, sizeof(uint32_t) * (pairs.length + list->length + 1));
+        assert(pairs.ids != 0);
+        memcpy(pairs.ids + pairs.length, list->ids, sizeof(uint32_t) * list->length);
+        pairs.length += list->length;
+        atlas_rdf_path_context_free(ctx);
+        free(ctx);
+        free(list->ids);
+        free(list);
+        free(state);
+    });
+    atlas_rdf_path_node_free(node);
+    
+    // only the terms used by the closure are referenced by the
+    // graph, the predicate is the first term and keeps this slot
+    // if it is also a node of the closure
+    atlas_rdf_term_t * terms = atlas_rdf_term_dict_terms(adjacency->dict);
+    int32_t * map = malloc(sizeof(int32_t) * (num_terms + 1));
+    atlas_rdf_term_t * refs = malloc(sizeof(atlas_rdf_term_t) * (num_terms + 2));
+    uint32_t num_statements = pairs.length / 2;
+    __graph * statements = malloc(sizeof(__graph) * (num_statements + 1));
+    assert(map != 0);
+    assert(refs != 0);
+    assert(statements != 0);
+    memset(map, 0xff, sizeof(int32_t) * (num_terms + 1));
+    
+    int num_refs = 1;
+    int pid = atlas_rdf_term_dict_lookup(adjacency->dict, predicate);
+    if (pid != -1) {
+        map[pid] = 0;
+        refs[0] = terms[pid];
+    } else {
+        refs[0] = predicate;
+    }
+    for (uint32_t i=0; i<num_statements; i++) {
+        uint32_t * ids[2] = {&statements[i].subject, &statements[i].object};
+        for (int k=0; k<2; k++) {
+            uint32_t id = pairs.ids[2 * i + k];
+            if (map[id] == -1) {
+                map[id] = num_refs;
+                refs[num_refs++] = terms[id];
+            }
+            *ids[k] = map[id];
+        }
+        statements[i].predicate = 0;
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_flat(num_statements, statements, num_refs, refs);
+    
+    free(pairs.ids);
+    free(statements);
+    free(refs);
+    free(map);
+    
+    return result;
+}
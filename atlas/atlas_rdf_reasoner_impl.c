@@ -0,0 +1,546 @@
+/*
+ *  atlas_rdf_reasoner_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_reasoner_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_graph_builder_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+#define ATLAS_RDF_RDF_NS  "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
+#define ATLAS_RDF_RDFS_NS "http://www.w3.org/2000/01/rdf-schema#"
+#define ATLAS_RDF_OWL_NS  "http://www.w3.org/2002/07/owl#"
+
+// the terms of the vocabulary used by the rules
+#define ATLAS_RDF_REASONER_TYPE                 0
+#define ATLAS_RDF_REASONER_SUB_CLASS_OF         1
+#define ATLAS_RDF_REASONER_SUB_PROPERTY_OF      2
+#define ATLAS_RDF_REASONER_DOMAIN               3
+#define ATLAS_RDF_REASONER_RANGE                4
+#define ATLAS_RDF_REASONER_INVERSE_OF           5
+#define ATLAS_RDF_REASONER_SYMMETRIC_PROPERTY   6
+#define ATLAS_RDF_REASONER_TRANSITIVE_PROPERTY  7
+#define ATLAS_RDF_REASONER_VOCABULARY_SIZE      8
+
+static const char * atlas_rdf_reasoner_vocabulary[ATLAS_RDF_REASONER_VOCABULARY_SIZE] = {
+    ATLAS_RDF_RDF_NS "type",
+    ATLAS_RDF_RDFS_NS "subClassOf",
+    ATLAS_RDF_RDFS_NS "subPropertyOf",
+    ATLAS_RDF_RDFS_NS "domain",
+    ATLAS_RDF_RDFS_NS "range",
+    ATLAS_RDF_OWL_NS "inverseOf",
+    ATLAS_RDF_OWL_NS "SymmetricProperty",
+    ATLAS_RDF_OWL_NS "TransitiveProperty"
+};
+
+// flags of a term
+#define ATLAS_RDF_REASONER_RESOURCE 1
+#define ATLAS_RDF_REASONER_IRI      2
+
+// positions of statements
+typedef struct {
+    uint32_t length;
+    uint32_t capacity;
+    uint32_t * positions;
+} __reasoner_list;
+
+// the statements (given, inferred and derived) are kept in a builder,
+// which removes duplicates; the positions of the statements are indexed
+// by their subject, predicate and object
+typedef struct {
+    int owl;
+    atlas_rdf_graph_builder_t statements;
+    int num_terms;
+    uint32_t vocabulary[ATLAS_RDF_REASONER_VOCABULARY_SIZE];
+    char * flags;
+    __reasoner_list * by_subject;
+    __reasoner_list * by_predicate;
+    __reasoner_list * by_object;
+} __reasoner;
+
+// statements derived by a worker
+typedef struct {
+    uint32_t length;
+    uint32_t capacity;
+    __graph * statements;
+} __reasoner_derived;
+
+#pragma mark -
+#pragma mark Setup a Reasoner
+
+static void
+atlas_rdf_reasoner_list_append(__reasoner_list * list, uint32_t position) {
+    if (list->length == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4;
+        list->positions = realloc(list->positions, sizeof(uint32_t) * list->capacity);
+        assert(list->positions != 0);
+    }
+    list->positions[list->length++] = position;
+}
+
+static void
+atlas_rdf_reasoner_index(__reasoner * reasoner, uint32_t position) {
+    __graph stm = atlas_rdf_graph_builder_statement_at(reasoner->statements, position);
+    atlas_rdf_reasoner_list_append(&reasoner->by_subject[stm.subject], position);
+    atlas_rdf_reasoner_list_append(&reasoner->by_predicate[stm.predicate], position);
+    atlas_rdf_reasoner_list_append(&reasoner->by_object[stm.object], position);
+}
+
+static void
+atlas_rdf_reasoner_init(__reasoner * reasoner, int options) {
+    reasoner->owl = (options & ATLAS_RDF_INFERENCE_OWL) != 0;
+    reasoner->statements = atlas_rdf_graph_builder_create(0);
+    
+    // the terms of the vocabulary are retained by the builder
+    for (int i=0; i<ATLAS_RDF_REASONER_VOCABULARY_SIZE; i++) {
+        atlas_rdf_term_t term = atlas_rdf_term_create_iri(atlas_rdf_reasoner_vocabulary[i],
+                                                          ^(int err, const char * msg){});
+        reasoner->vocabulary[i] = atlas_rdf_graph_builder_add_term(reasoner->statements, term);
+        lz_release(term);
+    }
+    
+    reasoner->num_terms = 0;
+    reasoner->flags = 0;
+    reasoner->by_subject = 0;
+    reasoner->by_predicate = 0;
+    reasoner->by_object = 0;
+}
+
+// index the statements, after all terms have been added
+static void
+atlas_rdf_reasoner_setup(__reasoner * reasoner) {
+    int num_terms = atlas_rdf_graph_builder_num_terms(reasoner->statements);
+    reasoner->num_terms = num_terms;
+    reasoner->flags = malloc(sizeof(char) * (num_terms + 1));
+    reasoner->by_subject = calloc(num_terms + 1, sizeof(__reasoner_list));
+    reasoner->by_predicate = calloc(num_terms + 1, sizeof(__reasoner_list));
+    reasoner->by_object = calloc(num_terms + 1, sizeof(__reasoner_list));
+    assert(reasoner->flags != 0);
+    assert(reasoner->by_subject != 0);
+    assert(reasoner->by_predicate != 0);
+    assert(reasoner->by_object != 0);
+    
+    for (int i=0; i<num_terms; i++) {
+        atlas_rdf_term_t term = atlas_rdf_graph_builder_term_at(reasoner->statements, i);
+        reasoner->flags[i] = 0;
+        if (atlas_rdf_term_is_type(term, RESOURCE)) {
+            reasoner->flags[i] |= ATLAS_RDF_REASONER_RESOURCE;
+        }
+        if (atlas_rdf_term_is_type(term, IRI)) {
+            reasoner->flags[i] |= ATLAS_RDF_REASONER_IRI;
+        }
+    }
+    
+    int num_statements = atlas_rdf_graph_builder_length(reasoner->statements);
+    for (int i=0; i<num_statements; i++) {
+        atlas_rdf_reasoner_index(reasoner, i);
+    }
+}
+
+static void
+atlas_rdf_reasoner_free(__reasoner * reasoner) {
+    for (int i=0; i<reasoner->num_terms; i++) {
+        free(reasoner->by_subject[i].positions);
+        free(reasoner->by_predicate[i].positions);
+        free(reasoner->by_object[i].positions);
+    }
+    free(reasoner->by_subject);
+    free(reasoner->by_predicate);
+    free(reasoner->by_object);
+    free(reasoner->flags);
+    atlas_rdf_graph_builder_free(reasoner->statements);
+}
+
+#pragma mark -
+#pragma mark Apply the Rules
+
+static void
+atlas_rdf_reasoner_derive(__reasoner * reasoner,
+                          __reasoner_derived * derived,
+                          uint32_t subject,
+                          uint32_t predicate,
+                          uint32_t object) {
+    
+    // the statement must be valid and new
+    if (!(reasoner->flags[subject] & ATLAS_RDF_REASONER_RESOURCE) ||
+        !(reasoner->flags[predicate] & ATLAS_RDF_REASONER_IRI) ||
+        atlas_rdf_graph_builder_statement_id(reasoner->statements, subject, predicate, object) != -1) {
+        return;
+    }
+    
+    if (derived->length == derived->capacity) {
+        derived->capacity = derived->capacity ? derived->capacity * 2 : 64;
+        derived->statements = realloc(derived->statements, sizeof(__graph) * derived->capacity);
+        assert(derived->statements != 0);
+    }
+    __graph * stm = &derived->statements[derived->length++];
+    stm->subject = subject;
+    stm->predicate = predicate;
+    stm->object = object;
+}
+
+static inline int
+atlas_rdf_reasoner_has(__reasoner * reasoner,
+                       uint32_t subject,
+                       uint32_t predicate,
+                       uint32_t object) {
+    return atlas_rdf_graph_builder_statement_id(reasoner->statements, subject, predicate, object) != -1;
+}
+
+// join a statement with all statements, the statement takes each of
+// the roles in the body of a rule (as a statement with data and as
+// a statement of the schema)
+static void
+atlas_rdf_reasoner_join(__reasoner * reasoner,
+                        __reasoner_derived * derived,
+                        __graph t) {
+    atlas_rdf_graph_builder_t statements = reasoner->statements;
+    uint32_t * v = reasoner->vocabulary;
+    uint32_t type = v[ATLAS_RDF_REASONER_TYPE];
+    uint32_t sub_class_of = v[ATLAS_RDF_REASONER_SUB_CLASS_OF];
+    uint32_t sub_property_of = v[ATLAS_RDF_REASONER_SUB_PROPERTY_OF];
+    uint32_t domain = v[ATLAS_RDF_REASONER_DOMAIN];
+    uint32_t range = v[ATLAS_RDF_REASONER_RANGE];
+    
+    __reasoner_list * list;
+    
+    // rdfs7: (s p o) (p subPropertyOf q) -> (s q o)
+    // rdfs2: (s p o) (p domain c) -> (s type c)
+    // rdfs3: (s p o) (p range c) -> (o type c)
+    list = &reasoner->by_subject[t.predicate];
+    for (uint32_t i=0; i<list->length; i++) {
+        __graph schema = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+        if (schema.predicate == sub_property_of) {
+            atlas_rdf_reasoner_derive(reasoner, derived, t.subject, schema.object, t.object);
+        } else if (schema.predicate == domain) {
+            atlas_rdf_reasoner_derive(reasoner, derived, t.subject, type, schema.object);
+        } else if (schema.predicate == range) {
+            atlas_rdf_reasoner_derive(reasoner, derived, t.object, type, schema.object);
+        }
+    }
+    
+    // the same rules with the statement in the schema
+    if (t.predicate == sub_property_of || t.predicate == domain || t.predicate == range) {
+        list = &reasoner->by_predicate[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph data = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (t.predicate == sub_property_of) {
+                atlas_rdf_reasoner_derive(reasoner, derived, data.subject, t.object, data.object);
+            } else if (t.predicate == domain) {
+                atlas_rdf_reasoner_derive(reasoner, derived, data.subject, type, t.object);
+            } else {
+                atlas_rdf_reasoner_derive(reasoner, derived, data.object, type, t.object);
+            }
+        }
+    }
+    
+    // rdfs5: (p subPropertyOf q) (q subPropertyOf r) -> (p subPropertyOf r)
+    // rdfs11: (c subClassOf d) (d subClassOf e) -> (c subClassOf e)
+    if (t.predicate == sub_property_of || t.predicate == sub_class_of) {
+        list = &reasoner->by_subject[t.object];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph next = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (next.predicate == t.predicate) {
+                atlas_rdf_reasoner_derive(reasoner, derived, t.subject, t.predicate, next.object);
+            }
+        }
+        list = &reasoner->by_object[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph prev = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (prev.predicate == t.predicate) {
+                atlas_rdf_reasoner_derive(reasoner, derived, prev.subject, t.predicate, t.object);
+            }
+        }
+    }
+    
+    // rdfs9: (s type c) (c subClassOf d) -> (s type d)
+    if (t.predicate == type) {
+        list = &reasoner->by_subject[t.object];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph schema = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (schema.predicate == sub_class_of) {
+                atlas_rdf_reasoner_derive(reasoner, derived, t.subject, type, schema.object);
+            }
+        }
+    }
+    if (t.predicate == sub_class_of) {
+        list = &reasoner->by_object[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph data = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (data.predicate == type) {
+                atlas_rdf_reasoner_derive(reasoner, derived, data.subject, type, t.object);
+            }
+        }
+    }
+    
+    if (!reasoner->owl) {
+        return;
+    }
+    
+    uint32_t inverse_of = v[ATLAS_RDF_REASONER_INVERSE_OF];
+    uint32_t symmetric = v[ATLAS_RDF_REASONER_SYMMETRIC_PROPERTY];
+    uint32_t transitive = v[ATLAS_RDF_REASONER_TRANSITIVE_PROPERTY];
+    
+    // prp-inv: (p inverseOf q) (s p o) -> (o q s) and (s q o) -> (o p s)
+    list = &reasoner->by_subject[t.predicate];
+    for (uint32_t i=0; i<list->length; i++) {
+        __graph schema = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+        if (schema.predicate == inverse_of) {
+            atlas_rdf_reasoner_derive(reasoner, derived, t.object, schema.object, t.subject);
+        }
+    }
+    list = &reasoner->by_object[t.predicate];
+    for (uint32_t i=0; i<list->length; i++) {
+        __graph schema = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+        if (schema.predicate == inverse_of) {
+            atlas_rdf_reasoner_derive(reasoner, derived, t.object, schema.subject, t.subject);
+        }
+    }
+    if (t.predicate == inverse_of) {
+        list = &reasoner->by_predicate[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph data = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            atlas_rdf_reasoner_derive(reasoner, derived, data.object, t.object, data.subject);
+        }
+        list = &reasoner->by_predicate[t.object];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph data = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            atlas_rdf_reasoner_derive(reasoner, derived, data.object, t.subject, data.subject);
+        }
+    }
+    
+    // prp-symp: (p type SymmetricProperty) (s p o) -> (o p s)
+    if (atlas_rdf_reasoner_has(reasoner, t.predicate, type, symmetric)) {
+        atlas_rdf_reasoner_derive(reasoner, derived, t.object, t.predicate, t.subject);
+    }
+    if (t.predicate == type && t.object == symmetric) {
+        list = &reasoner->by_predicate[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph data = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            atlas_rdf_reasoner_derive(reasoner, derived, data.object, data.predicate, data.subject);
+        }
+    }
+    
+    // prp-trp: (p type TransitiveProperty) (s p o) (o p x) -> (s p x)
+    if (atlas_rdf_reasoner_has(reasoner, t.predicate, type, transitive)) {
+        list = &reasoner->by_subject[t.object];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph next = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (next.predicate == t.predicate) {
+                atlas_rdf_reasoner_derive(reasoner, derived, t.subject, t.predicate, next.object);
+            }
+        }
+        list = &reasoner->by_object[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph prev = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            if (prev.predicate == t.predicate) {
+                atlas_rdf_reasoner_derive(reasoner, derived, prev.subject, t.predicate, t.object);
+            }
+        }
+    }
+    if (t.predicate == type && t.object == transitive) {
+        list = &reasoner->by_predicate[t.subject];
+        for (uint32_t i=0; i<list->length; i++) {
+            __graph first = atlas_rdf_graph_builder_statement_at(statements, list->positions[i]);
+            __reasoner_list * next_list = &reasoner->by_subject[first.object];
+            for (uint32_t k=0; k<next_list->length; k++) {
+                __graph next = atlas_rdf_graph_builder_statement_at(statements, next_list->positions[k]);
+                if (next.predicate == t.subject) {
+                    atlas_rdf_reasoner_derive(reasoner, derived, first.subject, t.subject, next.object);
+                }
+            }
+        }
+    }
+}
+
+// semi-naive evaluation: the statements at the positions [begin, end)
+// are new, each round joins only the statements derived in the
+// previous round with all statements until nothing new is derived
+static void
+atlas_rdf_reasoner_run(__reasoner * reasoner, uint32_t begin, uint32_t end) {
+    while (begin < end) {
+        
+        // the statements and the indexes are not modified
+        // during a round, the joins are processed concurrently
+        __block __reasoner_derived all = {0, 0, 0};
+        atlas_apply_chunked(end - begin, 0, ^{
+            __reasoner_derived * derived = calloc(1, sizeof(__reasoner_derived));
+            assert(derived != 0);
+            return (void *)derived;
+        }, ^(void * state, size_t first, size_t last){
+            for (size_t i=first; i<last; i++) {
+                __graph t = atlas_rdf_graph_builder_statement_at(reasoner->statements, begin + i);
+                atlas_rdf_reasoner_join(reasoner, state, t);
+            }
+        }, ^(void * state){
+            __reasoner_derived * derived = state;
+            all.statements = realloc(all.statements, sizeof(__graph) * (all.length + derived->length + 1));
+            assert(all.statements != 0);
+            memcpy(all.statements + all.length, derived->statements, sizeof(__graph) * derived->length);
+            all.length += derived->length;
+            free(derived->statements);
+            free(derived);
+        });
+        
+        // add the derived statements, which are the input of the next round
+        for (uint32_t i=0; i<all.length; i++) {
+            __graph stm = all.statements[i];
+            uint32_t length = atlas_rdf_graph_builder_length(reasoner->statements);
+            atlas_rdf_graph_builder_add_term_ids(reasoner->statements, stm.subject, stm.predicate, stm.object);
+            if (atlas_rdf_graph_builder_length(reasoner->statements) > length) {
+                atlas_rdf_reasoner_index(reasoner, length);
+            }
+        }
+        free(all.statements);
+        
+        begin = end;
+        end = atlas_rdf_graph_builder_length(reasoner->statements);
+    }
+}
+
+#pragma mark -
+#pragma mark Collect the Result
+
+// create a graph with the statements at the positions [begin, end),
+// except the statements marked in skip (if any)
+static atlas_rdf_graph_t
+atlas_rdf_reasoner_result(__reasoner * reasoner,
+                          uint32_t begin,
+                          uint32_t end,
+                          char * skip,
+                          uint32_t num_skip,
+                          atlas_error_handler err) {
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(end - begin);
+    for (uint32_t i=begin; i<end; i++) {
+        if (i < num_skip && skip[i]) {
+            continue;
+        }
+        __graph stm = atlas_rdf_graph_builder_statement_at(reasoner->statements, i);
+        int subject = atlas_rdf_graph_builder_add_term(builder,
+                                                       atlas_rdf_graph_builder_term_at(reasoner->statements, stm.subject));
+        int predicate = atlas_rdf_graph_builder_add_term(builder,
+                                                         atlas_rdf_graph_builder_term_at(reasoner->statements, stm.predicate));
+        int object = atlas_rdf_graph_builder_add_term(builder,
+                                                      atlas_rdf_graph_builder_term_at(reasoner->statements, stm.object));
+        atlas_rdf_graph_builder_add_term_ids(builder, subject, predicate, object);
+    }
+    atlas_rdf_graph_t result = atlas_rdf_graph_builder_commit(builder, err);
+    atlas_rdf_graph_builder_free(builder);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Materialize the Entailments of a RDF Graph
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_inferred(atlas_rdf_graph_t graph,
+                                int options,
+                                atlas_error_handler err) {
+    assert(graph != 0);
+    
+    __reasoner reasoner;
+    atlas_rdf_reasoner_init(&reasoner, options);
+    atlas_rdf_graph_builder_add_graph(reasoner.statements, graph, 0, 0);
+    atlas_rdf_reasoner_setup(&reasoner);
+    
+    // all statements are new in the first round
+    uint32_t num_given = atlas_rdf_graph_builder_length(reasoner.statements);
+    atlas_rdf_reasoner_run(&reasoner, 0, num_given);
+    
+    atlas_rdf_graph_t result = atlas_rdf_reasoner_result(&reasoner, num_given,
+                                                         atlas_rdf_graph_builder_length(reasoner.statements),
+                                                         0, 0, err);
+    atlas_rdf_reasoner_free(&reasoner);
+    return result;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_inferred_incremental(atlas_rdf_graph_t graph,
+                                            atlas_rdf_graph_t inferred,
+                                            atlas_rdf_graph_t added,
+                                            int options,
+                                            atlas_error_handler err) {
+    assert(graph != 0);
+    assert(inferred != 0);
+    assert(added != 0);
+    
+    __reasoner reasoner;
+    atlas_rdf_reasoner_init(&reasoner, options);
+    atlas_rdf_graph_builder_add_graph(reasoner.statements, graph, 0, 0);
+    uint32_t num_given = atlas_rdf_graph_builder_length(reasoner.statements);
+    atlas_rdf_graph_builder_add_graph(reasoner.statements, inferred, 0, 0);
+    uint32_t num_known = atlas_rdf_graph_builder_length(reasoner.statements);
+    
+    // the added statements, which have been inferred before,
+    // are not part of the result; the others are new
+    char * skip = calloc(num_known + 1, sizeof(char));
+    assert(skip != 0);
+    atlas_rdf_graph_builder_t statements = reasoner.statements;
+    atlas_rdf_graph_scan(added, 0, INT32_MAX, ^(atlas_rdf_graph_t part,
+                                                __graph * stms,
+                                                int number_of_statements){
+        int num_refs = lz_obj_num_ref(part);
+        uint32_t * ids = malloc(sizeof(uint32_t) * (num_refs + 1));
+        assert(ids != 0);
+        for (int i=0; i<num_refs; i++) {
+            ids[i] = atlas_rdf_graph_builder_add_term(statements, lz_obj_weak_ref(part, i));
+        }
+        for (int i=0; i<number_of_statements; i++) {
+            int position = atlas_rdf_graph_builder_statement_id(statements,
+                                                                ids[stms[i].subject],
+                                                                ids[stms[i].predicate],
+                                                                ids[stms[i].object]);
+            if (position == -1) {
+                atlas_rdf_graph_builder_add_term_ids(statements,
+                                                     ids[stms[i].subject],
+                                                     ids[stms[i].predicate],
+                                                     ids[stms[i].object]);
+            } else if ((uint32_t)position < num_known) {
+                skip[position] = 1;
+            }
+        }
+        free(ids);
+    });
+    uint32_t num_added = atlas_rdf_graph_builder_length(reasoner.statements);
+    atlas_rdf_reasoner_setup(&reasoner);
+    
+    // only the added statements are new in the first round,
+    // the inferred statements are closed under the rules
+    atlas_rdf_reasoner_run(&reasoner, num_known, num_added);
+    
+    // the result are the inferred and the derived statements
+    skip = realloc(skip, sizeof(char) * (num_added + 1));
+    assert(skip != 0);
+    memset(skip + num_known, 1, num_added - num_known);
+    atlas_rdf_graph_t result = atlas_rdf_reasoner_result(&reasoner, num_given,
+                                                         atlas_rdf_graph_builder_length(reasoner.statements),
+                                                         skip, num_added, err);
+    
+    free(skip);
+    atlas_rdf_reasoner_free(&reasoner);
+    return result;
+}
@@ -0,0 +1,1450 @@
+/*
+ *  atlas_rdf_sparql_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_sparql_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+#include "atlas_rdf_ntriples_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+#define RDF_TYPE "http://www.w3.org/1999/02/22-rdf-syntax-ns#type"
+
+typedef struct {
+    char * name;
+    char * iri;
+} __sparql_prefix;
+
+typedef struct {
+    const char * p;
+    const char * end;
+    
+    // number of the current line and the
+    // description of a syntax error
+    int line;
+    const char * error;
+    
+    int num_prefixes;
+    __sparql_prefix * prefixes;
+    
+    // the names of the variables, blank nodes are
+    // variables with a name starting with "_:"
+    int num_variables;
+    char ** variables;
+    
+    // the constants are owned by the parser until the query is created
+    atlas_rdf_term_dict_t dict;
+    int num_constants;
+    atlas_rdf_term_t * constants;
+} __sparql_parser;
+
+#pragma mark -
+#pragma mark Free the Compiled Query
+
+static void
+atlas_rdf_sparql_expr_free(__sparql_expr * expr) {
+    if (expr) {
+        atlas_rdf_sparql_expr_free(expr->args[0]);
+        atlas_rdf_sparql_expr_free(expr->args[1]);
+        free(expr);
+    }
+}
+
+static void
+atlas_rdf_sparql_pattern_free(__sparql_pattern * pattern) {
+    if (pattern) {
+        for (int i=0; i<pattern->num_elements; i++) {
+            atlas_rdf_sparql_pattern_free(pattern->elements[i]);
+        }
+        for (int i=0; i<pattern->num_filters; i++) {
+            atlas_rdf_sparql_expr_free(pattern->filters[i]);
+        }
+        if (pattern->program) {
+            atlas_rdf_sparql_program_free(pattern->program);
+        }
+        free(pattern->triples);
+        free(pattern->elements);
+        free(pattern->filters);
+        free(pattern);
+    }
+}
+
+static void
+atlas_rdf_sparql_query_free(__sparql_query * query) {
+    for (int i=0; i<query->num_variables; i++) {
+        free(query->variables[i]);
+    }
+    free(query->variables);
+    atlas_rdf_sparql_pattern_free(query->where);
+    free(query->columns);
+    free(query->group);
+    free(query->order);
+    free(query);
+}
+
+#pragma mark -
+#pragma mark Characters
+
+static int
+atlas_rdf_sparql_is_name_char(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '-' || c >= 0x80;
+}
+
+static int
+atlas_rdf_sparql_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// skip white space and comments
+static void
+atlas_rdf_sparql_skip(__sparql_parser * parser) {
+    while (parser->p < parser->end) {
+        char c = *parser->p;
+        if (c == ' ' || c == '\t' || c == '\r') {
+            parser->p++;
+        } else if (c == '\n') {
+            parser->line++;
+            parser->p++;
+        } else if (c == '#') {
+            while (parser->p < parser->end && *parser->p != '\n') {
+                parser->p++;
+            }
+        } else {
+            break;
+        }
+    }
+}
+
+// check if the keyword (case insensitive and not followed by a name
+// character) is next and skip it
+static int
+atlas_rdf_sparql_keyword(__sparql_parser * parser, const char * keyword) {
+    atlas_rdf_sparql_skip(parser);
+    size_t length = strlen(keyword);
+    if ((size_t)(parser->end - parser->p) < length || strncasecmp(parser->p, keyword, length) != 0) {
+        return 0;
+    }
+    if (parser->p + length < parser->end) {
+        char c = parser->p[length];
+        if (atlas_rdf_sparql_is_name_char(c) || c == ':') {
+            return 0;
+        }
+    }
+    parser->p += length;
+    return 1;
+}
+
+// check if the character is next and skip it
+static int
+atlas_rdf_sparql_accept(__sparql_parser * parser, char c) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p < parser->end && *parser->p == c) {
+        parser->p++;
+        return 1;
+    }
+    return 0;
+}
+
+static int
+atlas_rdf_sparql_expect(__sparql_parser * parser, char c, const char * error) {
+    if (!atlas_rdf_sparql_accept(parser, c)) {
+        parser->error = error;
+        return 0;
+    }
+    return 1;
+}
+
+static int
+atlas_rdf_sparql_peek(__sparql_parser * parser, char c) {
+    atlas_rdf_sparql_skip(parser);
+    return parser->p < parser->end && *parser->p == c;
+}
+
+#pragma mark -
+#pragma mark Variables and Constants
+
+static int
+atlas_rdf_sparql_variable_index(__sparql_parser * parser, const char * name, size_t length) {
+    for (int i=0; i<parser->num_variables; i++) {
+        if (strlen(parser->variables[i]) == length && memcmp(parser->variables[i], name, length) == 0) {
+            return i;
+        }
+    }
+    parser->variables = realloc(parser->variables, sizeof(char *) * (parser->num_variables + 1));
+    assert(parser->variables != 0);
+    char * copy = malloc(length + 1);
+    assert(copy != 0);
+    memcpy(copy, name, length);
+    copy[length] = 0;
+    parser->variables[parser->num_variables] = copy;
+    return parser->num_variables++;
+}
+
+// ?name or $name
+static int
+atlas_rdf_sparql_parse_variable(__sparql_parser * parser) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p == parser->end || (*parser->p != '?' && *parser->p != '$')) {
+        parser->error = "Variable expected.";
+        return -1;
+    }
+    const char * begin = ++parser->p;
+    while (parser->p < parser->end && atlas_rdf_sparql_is_name_char(*parser->p) && *parser->p != '-') {
+        parser->p++;
+    }
+    if (parser->p == begin) {
+        parser->error = "Invalid variable.";
+        return -1;
+    }
+    return atlas_rdf_sparql_variable_index(parser, begin, parser->p - begin);
+}
+
+// the parser takes over the reference to the term
+static int
+atlas_rdf_sparql_constant(__sparql_parser * parser, atlas_rdf_term_t term) {
+    if (term == 0) {
+        parser->error = "Invalid term.";
+        return -1;
+    }
+    int index = atlas_rdf_term_dict_insert(parser->dict, term);
+    if (index < parser->num_constants) {
+        lz_release(term);
+        return index;
+    }
+    parser->constants = realloc(parser->constants, sizeof(atlas_rdf_term_t) * (parser->num_constants + 1));
+    assert(parser->constants != 0);
+    parser->constants[parser->num_constants++] = term;
+    return index;
+}
+
+#pragma mark -
+#pragma mark Parse Terms
+
+// <iri>, the IRI must be absolute
+static int
+atlas_rdf_sparql_parse_iriref(__sparql_parser * parser) {
+    const char * begin = parser->p + 1;
+    const char * p = begin;
+    while (p < parser->end && *p != '>') {
+        unsigned char c = *p;
+        if (c <= 0x20 || c == '<' || c == '"' || c == '{' || c == '}' ||
+            c == '|' || c == '^' || c == '`') {
+            parser->error = "Invalid character in IRI.";
+            return -1;
+        }
+        p++;
+    }
+    if (p == parser->end) {
+        parser->error = "IRI is not terminated.";
+        return -1;
+    }
+    parser->p = p + 1;
+    
+    char * iri = malloc(p - begin + 1);
+    assert(iri != 0);
+    char * end = atlas_rdf_ntriples_unescape_into(iri, begin, p);
+    if (end == 0) {
+        free(iri);
+        parser->error = "Invalid escape sequence in IRI.";
+        return -1;
+    }
+    if (memchr(iri, ':', end - iri) == 0) {
+        free(iri);
+        parser->error = "Relative IRIs are not supported.";
+        return -1;
+    }
+    int index = atlas_rdf_sparql_constant(parser, atlas_rdf_term_create_iri_trusted(iri, end - iri));
+    free(iri);
+    return index;
+}
+
+// the name of a prefix (without ':'), which may be empty
+static size_t
+atlas_rdf_sparql_prefix_name(__sparql_parser * parser) {
+    const char * p = parser->p;
+    while (p < parser->end && (atlas_rdf_sparql_is_name_char(*p) || *p == '.')) {
+        p++;
+    }
+    while (p > parser->p && p[-1] == '.') {
+        p--;
+    }
+    return p - parser->p;
+}
+
+// prefix:local
+static int
+atlas_rdf_sparql_parse_prefixed_name(__sparql_parser * parser) {
+    size_t length = atlas_rdf_sparql_prefix_name(parser);
+    if (parser->p + length == parser->end || parser->p[length] != ':') {
+        parser->error = "Invalid prefixed name.";
+        return -1;
+    }
+    __sparql_prefix * prefix = 0;
+    for (int i=parser->num_prefixes-1; i>=0; i--) {
+        if (strlen(parser->prefixes[i].name) == length &&
+            memcmp(parser->prefixes[i].name, parser->p, length) == 0) {
+            prefix = &parser->prefixes[i];
+            break;
+        }
+    }
+    if (prefix == 0) {
+        parser->error = "Prefix is not defined.";
+        return -1;
+    }
+    parser->p += length + 1;
+    
+    // the local name does not end with a dot
+    const char * begin = parser->p;
+    const char * last = begin;
+    while (parser->p < parser->end &&
+           (atlas_rdf_sparql_is_name_char(*parser->p) || *parser->p == '.' || *parser->p == ':')) {
+        if (*parser->p != '.') {
+            last = parser->p + 1;
+        }
+        parser->p++;
+    }
+    parser->p = last;
+    
+    size_t ns_length = strlen(prefix->iri);
+    char * iri = malloc(ns_length + (last - begin) + 1);
+    assert(iri != 0);
+    memcpy(iri, prefix->iri, ns_length);
+    memcpy(iri + ns_length, begin, last - begin);
+    int index = atlas_rdf_sparql_constant(parser, atlas_rdf_term_create_iri_trusted(iri, ns_length + (last - begin)));
+    free(iri);
+    return index;
+}
+
+static int
+atlas_rdf_sparql_parse_iri(__sparql_parser * parser) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p < parser->end && *parser->p == '<') {
+        return atlas_rdf_sparql_parse_iriref(parser);
+    }
+    return atlas_rdf_sparql_parse_prefixed_name(parser);
+}
+
+// "value", 'value', """value""" or '''value''' followed
+// by an optional language tag or type
+static int
+atlas_rdf_sparql_parse_literal(__sparql_parser * parser) {
+    char quote = *parser->p;
+    const char * p = parser->p;
+    const char * begin;
+    const char * end;
+    
+    if (parser->end - p >= 3 && p[1] == quote && p[2] == quote) {
+        p += 3;
+        begin = p;
+        while (p < parser->end && !(*p == quote && parser->end - p >= 3 && p[1] == quote && p[2] == quote)) {
+            if (*p == '\\') {
+                p++;
+            } else if (*p == '\n') {
+                parser->line++;
+            }
+            p++;
+        }
+        if (p >= parser->end) {
+            parser->error = "String is not terminated.";
+            return -1;
+        }
+        end = p;
+        p += 3;
+    } else {
+        p += 1;
+        begin = p;
+        while (p < parser->end && *p != quote && *p != '\n' && *p != '\r') {
+            if (*p == '\\') {
+                p++;
+            }
+            p++;
+        }
+        if (p >= parser->end || *p != quote) {
+            parser->error = "String is not terminated.";
+            return -1;
+        }
+        end = p;
+        p += 1;
+    }
+    parser->p = p;
+    
+    char * value = malloc(end - begin + 1);
+    assert(value != 0);
+    char * out = atlas_rdf_ntriples_unescape_into(value, begin, end);
+    if (out == 0) {
+        free(value);
+        parser->error = "Invalid escape sequence in string.";
+        return -1;
+    }
+    *out = 0;
+    
+    __block int failed = 0;
+    atlas_error_handler err = ^(int e, const char * msg){
+        failed = 1;
+    };
+    
+    atlas_rdf_term_t term = 0;
+    if (parser->p < parser->end && *parser->p == '@') {
+        const char * lang = ++parser->p;
+        while (parser->p < parser->end &&
+               (atlas_rdf_sparql_is_name_char(*parser->p) && *parser->p != '_' && (unsigned char)*parser->p < 0x80)) {
+            parser->p++;
+        }
+        char * tag = strndup(lang, parser->p - lang);
+        assert(tag != 0);
+        term = atlas_rdf_term_create_string(value, tag, err);
+        free(tag);
+    } else if (parser->end - parser->p >= 2 && parser->p[0] == '^' && parser->p[1] == '^') {
+        parser->p += 2;
+        int type = atlas_rdf_sparql_parse_iri(parser);
+        if (type >= 0) {
+            term = atlas_rdf_term_create_typed(value, parser->constants[type], err);
+        }
+    } else {
+        term = atlas_rdf_term_create_string(value, 0, err);
+    }
+    free(value);
+    
+    if (failed) {
+        if (term) {
+            lz_release(term);
+        }
+        parser->error = "Invalid literal.";
+        return -1;
+    }
+    if (term == 0) {
+        return -1;
+    }
+    return atlas_rdf_sparql_constant(parser, term);
+}
+
+// integer, decimal or double with an optional sign
+static int
+atlas_rdf_sparql_parse_number(__sparql_parser * parser) {
+    const char * p = parser->p;
+    const char * begin = p;
+    char kind = 'i';
+    
+    if (*p == '+' || *p == '-') {
+        p++;
+    }
+    int num_digits = 0;
+    while (p < parser->end && atlas_rdf_sparql_is_digit(*p)) {
+        p++;
+        num_digits++;
+    }
+    if (p + 1 < parser->end && *p == '.' && atlas_rdf_sparql_is_digit(p[1])) {
+        kind = 'd';
+        p++;
+        while (p < parser->end && atlas_rdf_sparql_is_digit(*p)) {
+            p++;
+            num_digits++;
+        }
+    }
+    if (num_digits == 0) {
+        parser->error = "Invalid number.";
+        return -1;
+    }
+    if (p < parser->end && (*p == 'e' || *p == 'E')) {
+        kind = 'f';
+        p++;
+        if (p < parser->end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        if (p == parser->end || !atlas_rdf_sparql_is_digit(*p)) {
+            parser->error = "Invalid exponent.";
+            return -1;
+        }
+        while (p < parser->end && atlas_rdf_sparql_is_digit(*p)) {
+            p++;
+        }
+    }
+    parser->p = p;
+    
+    // the sign '+' is not accepted by GMP
+    if (*begin == '+') {
+        begin++;
+    }
+    char * number = strndup(begin, p - begin);
+    assert(number != 0);
+    
+    atlas_error_handler err = ^(int e, const char * msg){};
+    atlas_rdf_term_t term = 0;
+    if (kind == 'i') {
+        mpz_t i;
+        mpz_init_set_str(i, number, 10);
+        term = atlas_rdf_term_create_integer(i, err);
+        mpz_clear(i);
+    } else if (kind == 'd') {
+        mpf_t f;
+        mpf_init_set_str(f, number, 10);
+        term = atlas_rdf_term_create_decimal(f, err);
+        mpf_clear(f);
+    } else {
+        term = atlas_rdf_term_create_double(strtod(number, 0), err);
+    }
+    free(number);
+    return atlas_rdf_sparql_constant(parser, term);
+}
+
+// a constant: IRI, literal, number or boolean
+static int
+atlas_rdf_sparql_parse_constant(__sparql_parser * parser) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p == parser->end) {
+        parser->error = "Unexpected end of the query.";
+        return -1;
+    }
+    char c = *parser->p;
+    if (c == '"' || c == '\'') {
+        return atlas_rdf_sparql_parse_literal(parser);
+    }
+    if (atlas_rdf_sparql_is_digit(c) || c == '+' || c == '-' || c == '.') {
+        return atlas_rdf_sparql_parse_number(parser);
+    }
+    if (atlas_rdf_sparql_keyword(parser, "true")) {
+        return atlas_rdf_sparql_constant(parser, atlas_rdf_term_create_boolean(1, ^(int e, const char * msg){}));
+    }
+    if (atlas_rdf_sparql_keyword(parser, "false")) {
+        return atlas_rdf_sparql_constant(parser, atlas_rdf_term_create_boolean(0, ^(int e, const char * msg){}));
+    }
+    return atlas_rdf_sparql_parse_iri(parser);
+}
+
+// a variable, blank node or constant in a triple pattern
+static int
+atlas_rdf_sparql_parse_slot(__sparql_parser * parser, __sparql_slot * slot) {
+    atlas_rdf_sparql_skip(parser);
+    slot->variable = -1;
+    slot->constant = -1;
+    if (parser->p < parser->end && (*parser->p == '?' || *parser->p == '$')) {
+        slot->variable = atlas_rdf_sparql_parse_variable(parser);
+        return slot->variable >= 0;
+    }
+    if (parser->end - parser->p >= 2 && parser->p[0] == '_' && parser->p[1] == ':') {
+        const char * begin = parser->p;
+        parser->p += 2;
+        while (parser->p < parser->end && atlas_rdf_sparql_is_name_char(*parser->p)) {
+            parser->p++;
+        }
+        if (parser->p == begin + 2) {
+            parser->error = "Invalid blank node.";
+            return 0;
+        }
+        slot->variable = atlas_rdf_sparql_variable_index(parser, begin, parser->p - begin);
+        return 1;
+    }
+    slot->constant = atlas_rdf_sparql_parse_constant(parser);
+    return slot->constant >= 0;
+}
+
+#pragma mark -
+#pragma mark Parse Expressions
+
+static __sparql_expr *
+atlas_rdf_sparql_expr_create(uint32_t op, int32_t index, __sparql_expr * arg1, __sparql_expr * arg2) {
+    __sparql_expr * expr = malloc(sizeof(__sparql_expr));
+    assert(expr != 0);
+    expr->op = op;
+    expr->index = index;
+    expr->args[0] = arg1;
+    expr->args[1] = arg2;
+    return expr;
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_or(__sparql_parser * parser);
+
+// a string literal as argument of a function
+static int
+atlas_rdf_sparql_parse_string(__sparql_parser * parser, const char * error) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p == parser->end || (*parser->p != '"' && *parser->p != '\'')) {
+        parser->error = error;
+        return -1;
+    }
+    int constant = atlas_rdf_sparql_parse_constant(parser);
+    if (constant >= 0 && atlas_rdf_term_type(parser->constants[constant]) != STRING_LITERAL) {
+        parser->error = error;
+        return -1;
+    }
+    return constant;
+}
+
+// REGEX(expression, "pattern"), REGEX(expression, "pattern", "flags")
+static __sparql_expr *
+atlas_rdf_sparql_parse_regex(__sparql_parser * parser) {
+    if (!atlas_rdf_sparql_expect(parser, '(', "Expected '(' after REGEX.")) {
+        return 0;
+    }
+    __sparql_expr * text = atlas_rdf_sparql_parse_or(parser);
+    if (text == 0) {
+        return 0;
+    }
+    int pattern = -1;
+    int flags = 0;
+    if (atlas_rdf_sparql_expect(parser, ',', "Expected ',' after the first argument of REGEX.")) {
+        pattern = atlas_rdf_sparql_parse_string(parser, "The pattern of REGEX must be a string.");
+    }
+    if (pattern >= 0 && atlas_rdf_sparql_accept(parser, ',')) {
+        int constant = atlas_rdf_sparql_parse_string(parser, "The flags of REGEX must be a string.");
+        if (constant < 0) {
+            pattern = -1;
+        } else {
+            char * value = atlas_rdf_term_literal_value(parser->constants[constant]);
+            for (char * c=value; *c && pattern >= 0; c++) {
+                if (*c == 'i') {
+                    flags |= ATLAS_RDF_SPARQL_REGEX_ICASE;
+                } else {
+                    parser->error = "Unsupported flags of REGEX.";
+                    pattern = -1;
+                }
+            }
+            free(value);
+        }
+    }
+    if (pattern < 0 || !atlas_rdf_sparql_expect(parser, ')', "Expected ')' after the arguments of REGEX.")) {
+        atlas_rdf_sparql_expr_free(text);
+        return 0;
+    }
+    __sparql_expr * arg = atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_CONSTANT, pattern, 0, 0);
+    return atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_REGEX, flags, text, arg);
+}
+
+// BOUND(?x), isIRI(...), isURI(...), isBlank(...), isLiteral(...),
+// LANG(...) and REGEX(...)
+static __sparql_expr *
+atlas_rdf_sparql_parse_builtin(__sparql_parser * parser, int * found) {
+    static const struct {
+        const char * name;
+        uint32_t op;
+    } builtins[] = {
+        {"BOUND", ATLAS_RDF_SPARQL_EXPR_BOUND},
+        {"isIRI", ATLAS_RDF_SPARQL_EXPR_IS_IRI},
+        {"isURI", ATLAS_RDF_SPARQL_EXPR_IS_IRI},
+        {"isBlank", ATLAS_RDF_SPARQL_EXPR_IS_BLANK},
+        {"isLiteral", ATLAS_RDF_SPARQL_EXPR_IS_LITERAL},
+        {"LANG", ATLAS_RDF_SPARQL_EXPR_LANG}
+    };
+    
+    *found = atlas_rdf_sparql_keyword(parser, "REGEX");
+    if (*found) {
+        return atlas_rdf_sparql_parse_regex(parser);
+    }
+    for (size_t i=0; i<sizeof(builtins) / sizeof(builtins[0]); i++) {
+        if (!atlas_rdf_sparql_keyword(parser, builtins[i].name)) {
+            continue;
+        }
+        *found = 1;
+        if (!atlas_rdf_sparql_expect(parser, '(', "Expected '(' after the name of a function.")) {
+            return 0;
+        }
+        __sparql_expr * arg;
+        if (builtins[i].op == ATLAS_RDF_SPARQL_EXPR_BOUND) {
+            int variable = atlas_rdf_sparql_parse_variable(parser);
+            if (variable < 0) {
+                return 0;
+            }
+            arg = atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_VARIABLE, variable, 0, 0);
+        } else {
+            arg = atlas_rdf_sparql_parse_or(parser);
+            if (arg == 0) {
+                return 0;
+            }
+        }
+        if (!atlas_rdf_sparql_expect(parser, ')', "Expected ')' after the argument of a function.")) {
+            atlas_rdf_sparql_expr_free(arg);
+            return 0;
+        }
+        return atlas_rdf_sparql_expr_create(builtins[i].op, -1, arg, 0);
+    }
+    return 0;
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_primary(__sparql_parser * parser) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p == parser->end) {
+        parser->error = "Unexpected end of the query.";
+        return 0;
+    }
+    
+    if (atlas_rdf_sparql_accept(parser, '(')) {
+        __sparql_expr * expr = atlas_rdf_sparql_parse_or(parser);
+        if (expr && !atlas_rdf_sparql_expect(parser, ')', "Expected ')' after an expression.")) {
+            atlas_rdf_sparql_expr_free(expr);
+            return 0;
+        }
+        return expr;
+    }
+    
+    if (*parser->p == '?' || *parser->p == '$') {
+        int variable = atlas_rdf_sparql_parse_variable(parser);
+        if (variable < 0) {
+            return 0;
+        }
+        return atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_VARIABLE, variable, 0, 0);
+    }
+    
+    int found;
+    __sparql_expr * expr = atlas_rdf_sparql_parse_builtin(parser, &found);
+    if (found) {
+        return expr;
+    }
+    
+    int constant = atlas_rdf_sparql_parse_constant(parser);
+    if (constant < 0) {
+        return 0;
+    }
+    return atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_CONSTANT, constant, 0, 0);
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_unary(__sparql_parser * parser) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->end - parser->p >= 2 && parser->p[0] == '!' && parser->p[1] != '=') {
+        parser->p++;
+        __sparql_expr * arg = atlas_rdf_sparql_parse_unary(parser);
+        if (arg == 0) {
+            return 0;
+        }
+        return atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_NOT, -1, arg, 0);
+    }
+    if (atlas_rdf_sparql_accept(parser, '-')) {
+        __sparql_expr * arg = atlas_rdf_sparql_parse_unary(parser);
+        if (arg == 0) {
+            return 0;
+        }
+        return atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_NEG, -1, arg, 0);
+    }
+    if (atlas_rdf_sparql_accept(parser, '+')) {
+        return atlas_rdf_sparql_parse_unary(parser);
+    }
+    return atlas_rdf_sparql_parse_primary(parser);
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_multiplicative(__sparql_parser * parser) {
+    __sparql_expr * left = atlas_rdf_sparql_parse_unary(parser);
+    while (left) {
+        uint32_t op;
+        if (atlas_rdf_sparql_accept(parser, '*')) {
+            op = ATLAS_RDF_SPARQL_EXPR_MUL;
+        } else if (atlas_rdf_sparql_accept(parser, '/')) {
+            op = ATLAS_RDF_SPARQL_EXPR_DIV;
+        } else {
+            break;
+        }
+        __sparql_expr * right = atlas_rdf_sparql_parse_unary(parser);
+        if (right == 0) {
+            atlas_rdf_sparql_expr_free(left);
+            return 0;
+        }
+        left = atlas_rdf_sparql_expr_create(op, -1, left, right);
+    }
+    return left;
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_additive(__sparql_parser * parser) {
+    __sparql_expr * left = atlas_rdf_sparql_parse_multiplicative(parser);
+    while (left) {
+        uint32_t op;
+        if (atlas_rdf_sparql_accept(parser, '+')) {
+            op = ATLAS_RDF_SPARQL_EXPR_ADD;
+        } else if (atlas_rdf_sparql_accept(parser, '-')) {
+            op = ATLAS_RDF_SPARQL_EXPR_SUB;
+        } else {
+            break;
+        }
+        __sparql_expr * right = atlas_rdf_sparql_parse_multiplicative(parser);
+        if (right == 0) {
+            atlas_rdf_sparql_expr_free(left);
+            return 0;
+        }
+        left = atlas_rdf_sparql_expr_create(op, -1, left, right);
+    }
+    return left;
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_relational(__sparql_parser * parser) {
+    __sparql_expr * left = atlas_rdf_sparql_parse_additive(parser);
+    if (left == 0) {
+        return 0;
+    }
+    
+    static const struct {
+        const char * token;
+        uint32_t op;
+    } operators[] = {
+        {"!=", ATLAS_RDF_SPARQL_EXPR_NE},
+        {"<=", ATLAS_RDF_SPARQL_EXPR_LE},
+        {">=", ATLAS_RDF_SPARQL_EXPR_GE},
+        {"=", ATLAS_RDF_SPARQL_EXPR_EQ},
+        {"<", ATLAS_RDF_SPARQL_EXPR_LT},
+        {">", ATLAS_RDF_SPARQL_EXPR_GT}
+    };
+    
+    atlas_rdf_sparql_skip(parser);
+    for (size_t i=0; i<sizeof(operators) / sizeof(operators[0]); i++) {
+        size_t length = strlen(operators[i].token);
+        if ((size_t)(parser->end - parser->p) >= length && memcmp(parser->p, operators[i].token, length) == 0) {
+            parser->p += length;
+            __sparql_expr * right = atlas_rdf_sparql_parse_additive(parser);
+            if (right == 0) {
+                atlas_rdf_sparql_expr_free(left);
+                return 0;
+            }
+            return atlas_rdf_sparql_expr_create(operators[i].op, -1, left, right);
+        }
+    }
+    return left;
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_and(__sparql_parser * parser) {
+    __sparql_expr * left = atlas_rdf_sparql_parse_relational(parser);
+    while (left) {
+        atlas_rdf_sparql_skip(parser);
+        if (parser->end - parser->p < 2 || parser->p[0] != '&' || parser->p[1] != '&') {
+            break;
+        }
+        parser->p += 2;
+        __sparql_expr * right = atlas_rdf_sparql_parse_relational(parser);
+        if (right == 0) {
+            atlas_rdf_sparql_expr_free(left);
+            return 0;
+        }
+        left = atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_AND, -1, left, right);
+    }
+    return left;
+}
+
+static __sparql_expr *
+atlas_rdf_sparql_parse_or(__sparql_parser * parser) {
+    __sparql_expr * left = atlas_rdf_sparql_parse_and(parser);
+    while (left) {
+        atlas_rdf_sparql_skip(parser);
+        if (parser->end - parser->p < 2 || parser->p[0] != '|' || parser->p[1] != '|') {
+            break;
+        }
+        parser->p += 2;
+        __sparql_expr * right = atlas_rdf_sparql_parse_and(parser);
+        if (right == 0) {
+            atlas_rdf_sparql_expr_free(left);
+            return 0;
+        }
+        left = atlas_rdf_sparql_expr_create(ATLAS_RDF_SPARQL_EXPR_OR, -1, left, right);
+    }
+    return left;
+}
+
+// FILTER (expression) or FILTER function(...)
+static __sparql_expr *
+atlas_rdf_sparql_parse_constraint(__sparql_parser * parser) {
+    if (atlas_rdf_sparql_peek(parser, '(')) {
+        return atlas_rdf_sparql_parse_primary(parser);
+    }
+    int found;
+    __sparql_expr * expr = atlas_rdf_sparql_parse_builtin(parser, &found);
+    if (!found) {
+        parser->error = "Expected '(' or a function after FILTER.";
+    }
+    return expr;
+}
+
+#pragma mark -
+#pragma mark Parse Graph Patterns
+
+static __sparql_pattern *
+atlas_rdf_sparql_pattern_create(uint32_t kind) {
+    __sparql_pattern * pattern = calloc(1, sizeof(__sparql_pattern));
+    assert(pattern != 0);
+    pattern->kind = kind;
+    return pattern;
+}
+
+static void
+atlas_rdf_sparql_pattern_add(__sparql_pattern * pattern, __sparql_pattern * element) {
+    pattern->elements = realloc(pattern->elements, sizeof(__sparql_pattern *) * (pattern->num_elements + 1));
+    assert(pattern->elements != 0);
+    pattern->elements[pattern->num_elements++] = element;
+}
+
+static void
+atlas_rdf_sparql_pattern_add_triple(__sparql_pattern * pattern, __sparql_slot s, __sparql_slot p, __sparql_slot o) {
+    pattern->triples = realloc(pattern->triples, sizeof(__sparql_triple) * (pattern->num_triples + 1));
+    assert(pattern->triples != 0);
+    __sparql_triple * triple = &pattern->triples[pattern->num_triples++];
+    triple->subject = s;
+    triple->predicate = p;
+    triple->object = o;
+}
+
+// subject predicate object (, object)* (; predicate object ...)*
+static int
+atlas_rdf_sparql_parse_triples(__sparql_parser * parser, __sparql_pattern * pattern) {
+    __sparql_slot subject;
+    if (!atlas_rdf_sparql_parse_slot(parser, &subject)) {
+        return 0;
+    }
+    while (1) {
+        __sparql_slot predicate;
+        if (atlas_rdf_sparql_keyword(parser, "a")) {
+            predicate.variable = -1;
+            predicate.constant = atlas_rdf_sparql_constant(parser, atlas_rdf_term_create_iri_trusted(RDF_TYPE, strlen(RDF_TYPE)));
+        } else if (!atlas_rdf_sparql_parse_slot(parser, &predicate)) {
+            return 0;
+        }
+        do {
+            __sparql_slot object;
+            if (!atlas_rdf_sparql_parse_slot(parser, &object)) {
+                return 0;
+            }
+            atlas_rdf_sparql_pattern_add_triple(pattern, subject, predicate, object);
+        } while (atlas_rdf_sparql_accept(parser, ','));
+        
+        // a predicate object list may end with ';'
+        if (!atlas_rdf_sparql_accept(parser, ';')) {
+            break;
+        }
+        while (atlas_rdf_sparql_accept(parser, ';'));
+        if (atlas_rdf_sparql_peek(parser, '.') || atlas_rdf_sparql_peek(parser, '}')) {
+            break;
+        }
+    }
+    return 1;
+}
+
+static __sparql_pattern *
+atlas_rdf_sparql_parse_group(__sparql_parser * parser);
+
+// { ... } (UNION { ... })*
+static __sparql_pattern *
+atlas_rdf_sparql_parse_union(__sparql_parser * parser) {
+    __sparql_pattern * group = atlas_rdf_sparql_parse_group(parser);
+    if (group == 0 || !atlas_rdf_sparql_keyword(parser, "UNION")) {
+        return group;
+    }
+    __sparql_pattern * alternatives = atlas_rdf_sparql_pattern_create(ATLAS_RDF_SPARQL_UNION);
+    atlas_rdf_sparql_pattern_add(alternatives, group);
+    do {
+        group = atlas_rdf_sparql_parse_group(parser);
+        if (group == 0) {
+            atlas_rdf_sparql_pattern_free(alternatives);
+            return 0;
+        }
+        atlas_rdf_sparql_pattern_add(alternatives, group);
+    } while (atlas_rdf_sparql_keyword(parser, "UNION"));
+    return alternatives;
+}
+
+static __sparql_pattern *
+atlas_rdf_sparql_parse_group(__sparql_parser * parser) {
+    if (!atlas_rdf_sparql_expect(parser, '{', "Expected '{' at the beginning of a group.")) {
+        return 0;
+    }
+    
+    __sparql_pattern * group = atlas_rdf_sparql_pattern_create(ATLAS_RDF_SPARQL_GROUP);
+    while (1) {
+        atlas_rdf_sparql_skip(parser);
+        if (parser->p == parser->end) {
+            parser->error = "Group is not terminated.";
+            break;
+        }
+        if (atlas_rdf_sparql_accept(parser, '}')) {
+            return group;
+        }
+        if (atlas_rdf_sparql_accept(parser, '.')) {
+            continue;
+        }
+        
+        __sparql_pattern * element = 0;
+        if (atlas_rdf_sparql_peek(parser, '{')) {
+            element = atlas_rdf_sparql_parse_union(parser);
+        } else if (atlas_rdf_sparql_keyword(parser, "OPTIONAL")) {
+            __sparql_pattern * optional = atlas_rdf_sparql_parse_group(parser);
+            if (optional) {
+                element = atlas_rdf_sparql_pattern_create(ATLAS_RDF_SPARQL_OPTIONAL);
+                atlas_rdf_sparql_pattern_add(element, optional);
+            }
+        } else if (atlas_rdf_sparql_keyword(parser, "FILTER")) {
+            __sparql_expr * filter = atlas_rdf_sparql_parse_constraint(parser);
+            if (filter == 0) {
+                break;
+            }
+            group->filters = realloc(group->filters, sizeof(__sparql_expr *) * (group->num_filters + 1));
+            assert(group->filters != 0);
+            group->filters[group->num_filters++] = filter;
+            continue;
+        } else {
+            // consecutive triples are one basic graph pattern
+            __sparql_pattern * last = group->num_elements > 0 ? group->elements[group->num_elements - 1] : 0;
+            if (last == 0 || last->kind != ATLAS_RDF_SPARQL_TRIPLES) {
+                last = atlas_rdf_sparql_pattern_create(ATLAS_RDF_SPARQL_TRIPLES);
+                atlas_rdf_sparql_pattern_add(group, last);
+            }
+            if (!atlas_rdf_sparql_parse_triples(parser, last)) {
+                break;
+            }
+            continue;
+        }
+        if (element == 0) {
+            break;
+        }
+        atlas_rdf_sparql_pattern_add(group, element);
+    }
+    
+    atlas_rdf_sparql_pattern_free(group);
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Parse a Query
+
+// PREFIX name: <iri>
+static int
+atlas_rdf_sparql_parse_prologue(__sparql_parser * parser) {
+    while (1) {
+        if (atlas_rdf_sparql_keyword(parser, "BASE")) {
+            parser->error = "BASE is not supported.";
+            return 0;
+        }
+        if (!atlas_rdf_sparql_keyword(parser, "PREFIX")) {
+            return 1;
+        }
+        atlas_rdf_sparql_skip(parser);
+        size_t length = atlas_rdf_sparql_prefix_name(parser);
+        if (parser->p + length == parser->end || parser->p[length] != ':') {
+            parser->error = "Invalid prefix.";
+            return 0;
+        }
+        char * name = strndup(parser->p, length);
+        assert(name != 0);
+        parser->p += length + 1;
+        
+        atlas_rdf_sparql_skip(parser);
+        if (parser->p == parser->end || *parser->p != '<') {
+            free(name);
+            parser->error = "Expected an IRI after the prefix.";
+            return 0;
+        }
+        int index = atlas_rdf_sparql_parse_iriref(parser);
+        if (index < 0) {
+            free(name);
+            return 0;
+        }
+        parser->prefixes = realloc(parser->prefixes, sizeof(__sparql_prefix) * (parser->num_prefixes + 1));
+        assert(parser->prefixes != 0);
+        parser->prefixes[parser->num_prefixes].name = name;
+        parser->prefixes[parser->num_prefixes].iri = atlas_rdf_term_iri_value(parser->constants[index]);
+        parser->num_prefixes++;
+    }
+}
+
+static void
+atlas_rdf_sparql_add_column(__sparql_query * query, __sparql_column column) {
+    query->columns = realloc(query->columns, sizeof(__sparql_column) * (query->num_columns + 1));
+    assert(query->columns != 0);
+    query->columns[query->num_columns++] = column;
+}
+
+// (COUNT(DISTINCT? * | ?x) AS ?y), (SUM(?x) AS ?y), ...
+static int
+atlas_rdf_sparql_parse_aggregate(__sparql_parser * parser, __sparql_query * query) {
+    __sparql_column column;
+    column.distinct = 0;
+    column.argument = -1;
+    if (atlas_rdf_sparql_keyword(parser, "COUNT")) {
+        column.aggregate = ATLAS_RDF_SPARQL_AGGREGATE_COUNT;
+    } else if (atlas_rdf_sparql_keyword(parser, "SUM")) {
+        column.aggregate = ATLAS_RDF_SPARQL_AGGREGATE_SUM;
+    } else if (atlas_rdf_sparql_keyword(parser, "MIN")) {
+        column.aggregate = ATLAS_RDF_SPARQL_AGGREGATE_MIN;
+    } else if (atlas_rdf_sparql_keyword(parser, "MAX")) {
+        column.aggregate = ATLAS_RDF_SPARQL_AGGREGATE_MAX;
+    } else {
+        parser->error = "Expected COUNT, SUM, MIN or MAX.";
+        return 0;
+    }
+    if (!atlas_rdf_sparql_expect(parser, '(', "Expected '(' after the name of an aggregate.")) {
+        return 0;
+    }
+    column.distinct = atlas_rdf_sparql_keyword(parser, "DISTINCT");
+    if (column.aggregate == ATLAS_RDF_SPARQL_AGGREGATE_COUNT && atlas_rdf_sparql_accept(parser, '*')) {
+        column.argument = -1;
+    } else if ((column.argument = atlas_rdf_sparql_parse_variable(parser)) < 0) {
+        return 0;
+    }
+    if (!atlas_rdf_sparql_expect(parser, ')', "Expected ')' after the argument of an aggregate.") ||
+        !atlas_rdf_sparql_keyword(parser, "AS")) {
+        parser->error = parser->error ? parser->error : "Expected AS after an aggregate.";
+        return 0;
+    }
+    if ((column.variable = atlas_rdf_sparql_parse_variable(parser)) < 0) {
+        return 0;
+    }
+    if (!atlas_rdf_sparql_expect(parser, ')', "Expected ')' after an aggregate.")) {
+        return 0;
+    }
+    query->grouped = 1;
+    atlas_rdf_sparql_add_column(query, column);
+    return 1;
+}
+
+// SELECT DISTINCT? (* | (?x | (aggregate AS ?y))+)
+static int
+atlas_rdf_sparql_parse_select(__sparql_parser * parser, __sparql_query * query, int * star) {
+    if (!atlas_rdf_sparql_keyword(parser, "SELECT")) {
+        parser->error = "Expected SELECT.";
+        return 0;
+    }
+    query->distinct = atlas_rdf_sparql_keyword(parser, "DISTINCT") || atlas_rdf_sparql_keyword(parser, "REDUCED");
+    if (atlas_rdf_sparql_accept(parser, '*')) {
+        *star = 1;
+        return 1;
+    }
+    *star = 0;
+    while (1) {
+        atlas_rdf_sparql_skip(parser);
+        if (atlas_rdf_sparql_accept(parser, '(')) {
+            if (!atlas_rdf_sparql_parse_aggregate(parser, query)) {
+                return 0;
+            }
+        } else if (parser->p < parser->end && (*parser->p == '?' || *parser->p == '$')) {
+            __sparql_column column = {atlas_rdf_sparql_parse_variable(parser), ATLAS_RDF_SPARQL_AGGREGATE_NONE, -1, 0};
+            atlas_rdf_sparql_add_column(query, column);
+        } else {
+            break;
+        }
+    }
+    if (query->num_columns == 0) {
+        parser->error = "Expected '*' or variables after SELECT.";
+        return 0;
+    }
+    return 1;
+}
+
+static int
+atlas_rdf_sparql_parse_integer(__sparql_parser * parser, int64_t * value) {
+    atlas_rdf_sparql_skip(parser);
+    if (parser->p == parser->end || !atlas_rdf_sparql_is_digit(*parser->p)) {
+        parser->error = "Expected an integer.";
+        return 0;
+    }
+    *value = 0;
+    while (parser->p < parser->end && atlas_rdf_sparql_is_digit(*parser->p)) {
+        *value = *value * 10 + (*parser->p++ - '0');
+        if (*value > INT32_MAX) {
+            *value = INT32_MAX;
+        }
+    }
+    return 1;
+}
+
+// GROUP BY, ORDER BY, LIMIT and OFFSET
+static int
+atlas_rdf_sparql_parse_modifiers(__sparql_parser * parser, __sparql_query * query) {
+    if (atlas_rdf_sparql_keyword(parser, "GROUP")) {
+        if (!atlas_rdf_sparql_keyword(parser, "BY")) {
+            parser->error = "Expected BY after GROUP.";
+            return 0;
+        }
+        do {
+            int variable = atlas_rdf_sparql_parse_variable(parser);
+            if (variable < 0) {
+                return 0;
+            }
+            query->group = realloc(query->group, sizeof(int32_t) * (query->num_group + 1));
+            assert(query->group != 0);
+            query->group[query->num_group++] = variable;
+        } while (atlas_rdf_sparql_peek(parser, '?') || atlas_rdf_sparql_peek(parser, '$'));
+        query->grouped = 1;
+    }
+    
+    if (atlas_rdf_sparql_keyword(parser, "ORDER")) {
+        if (!atlas_rdf_sparql_keyword(parser, "BY")) {
+            parser->error = "Expected BY after ORDER.";
+            return 0;
+        }
+        while (1) {
+            __sparql_order order = {-1, 0};
+            int function = 0;
+            if (atlas_rdf_sparql_keyword(parser, "ASC")) {
+                function = 1;
+            } else if (atlas_rdf_sparql_keyword(parser, "DESC")) {
+                function = 1;
+                order.descending = 1;
+            } else if (!atlas_rdf_sparql_peek(parser, '?') && !atlas_rdf_sparql_peek(parser, '$')) {
+                break;
+            }
+            if (function && !atlas_rdf_sparql_expect(parser, '(', "Expected '(' after ASC or DESC.")) {
+                return 0;
+            }
+            if ((order.variable = atlas_rdf_sparql_parse_variable(parser)) < 0) {
+                return 0;
+            }
+            if (function && !atlas_rdf_sparql_expect(parser, ')', "Expected ')' after the variable.")) {
+                return 0;
+            }
+            query->order = realloc(query->order, sizeof(__sparql_order) * (query->num_order + 1));
+            assert(query->order != 0);
+            query->order[query->num_order++] = order;
+        }
+        if (query->num_order == 0) {
+            parser->error = "Expected variables after ORDER BY.";
+            return 0;
+        }
+    }
+    
+    // LIMIT and OFFSET in any order
+    for (int i=0; i<2; i++) {
+        if (atlas_rdf_sparql_keyword(parser, "LIMIT")) {
+            if (!atlas_rdf_sparql_parse_integer(parser, &query->limit)) {
+                return 0;
+            }
+        } else if (atlas_rdf_sparql_keyword(parser, "OFFSET")) {
+            if (!atlas_rdf_sparql_parse_integer(parser, &query->offset)) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// mark the variables used in a pattern
+static void
+atlas_rdf_sparql_used_variables(__sparql_pattern * pattern, char * used) {
+    for (int i=0; i<pattern->num_triples; i++) {
+        __sparql_triple * t = &pattern->triples[i];
+        if (t->subject.variable >= 0) used[t->subject.variable] = 1;
+        if (t->predicate.variable >= 0) used[t->predicate.variable] = 1;
+        if (t->object.variable >= 0) used[t->object.variable] = 1;
+    }
+    for (int i=0; i<pattern->num_elements; i++) {
+        atlas_rdf_sparql_used_variables(pattern->elements[i], used);
+    }
+}
+
+// check the columns, groups and order of a query
+static int
+atlas_rdf_sparql_check(__sparql_parser * parser, __sparql_query * query, int star) {
+    char * used = calloc(parser->num_variables + 1, 1);
+    assert(used != 0);
+    atlas_rdf_sparql_used_variables(query->where, used);
+    
+    int result = 1;
+    if (star) {
+        if (query->grouped) {
+            parser->error = "SELECT * is not allowed with GROUP BY.";
+            result = 0;
+        }
+        for (int i=0; i<parser->num_variables && result; i++) {
+            if (used[i] && strncmp(parser->variables[i], "_:", 2) != 0) {
+                __sparql_column column = {i, ATLAS_RDF_SPARQL_AGGREGATE_NONE, -1, 0};
+                atlas_rdf_sparql_add_column(query, column);
+            }
+        }
+    }
+    
+    for (int i=0; i<query->num_columns && result; i++) {
+        __sparql_column * column = &query->columns[i];
+        if (column->aggregate != ATLAS_RDF_SPARQL_AGGREGATE_NONE) {
+            if (used[column->variable]) {
+                parser->error = "The variable of an aggregate is already used.";
+                result = 0;
+            }
+            continue;
+        }
+        if (query->grouped) {
+            int grouped = 0;
+            for (int k=0; k<query->num_group; k++) {
+                grouped |= query->group[k] == column->variable;
+            }
+            if (!grouped) {
+                parser->error = "A selected variable is not in GROUP BY.";
+                result = 0;
+            }
+        }
+    }
+    
+    // after grouping, only the columns can be used to order the solutions
+    for (int i=0; i<query->num_order && result && query->grouped; i++) {
+        int found = 0;
+        for (int k=0; k<query->num_columns; k++) {
+            found |= query->columns[k].variable == query->order[i].variable;
+        }
+        for (int k=0; k<query->num_group; k++) {
+            found |= query->group[k] == query->order[i].variable;
+        }
+        if (!found) {
+            parser->error = "A variable in ORDER BY is not in GROUP BY.";
+            result = 0;
+        }
+    }
+    
+    free(used);
+    return result;
+}
+
+// compile the filters of the groups
+static int
+atlas_rdf_sparql_compile(__sparql_parser * parser, __sparql_pattern * pattern) {
+    if (pattern->num_filters > 0) {
+        pattern->program = atlas_rdf_sparql_program_create(pattern->num_filters,
+                                                           pattern->filters,
+                                                           parser->constants,
+                                                           &parser->error);
+        if (pattern->program == 0) {
+            return 0;
+        }
+    }
+    for (int i=0; i<pattern->num_elements; i++) {
+        if (!atlas_rdf_sparql_compile(parser, pattern->elements[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static __sparql_query *
+atlas_rdf_sparql_parse_query(__sparql_parser * parser) {
+    __sparql_query * query = calloc(1, sizeof(__sparql_query));
+    assert(query != 0);
+    query->limit = -1;
+    
+    int star = 0;
+    int result = atlas_rdf_sparql_parse_prologue(parser) &&
+                 atlas_rdf_sparql_parse_select(parser, query, &star);
+    if (result) {
+        atlas_rdf_sparql_keyword(parser, "WHERE");
+        query->where = atlas_rdf_sparql_parse_group(parser);
+        result = query->where != 0 &&
+                 atlas_rdf_sparql_parse_modifiers(parser, query);
+    }
+    if (result) {
+        atlas_rdf_sparql_skip(parser);
+        if (parser->p != parser->end) {
+            parser->error = "Unexpected characters after the query.";
+            result = 0;
+        }
+    }
+    if (result) {
+        result = atlas_rdf_sparql_check(parser, query, star) &&
+                 atlas_rdf_sparql_compile(parser, query->where);
+    }
+    
+    // the query takes over the variables
+    query->num_variables = parser->num_variables;
+    query->variables = parser->variables;
+    parser->num_variables = 0;
+    parser->variables = 0;
+    
+    if (!result) {
+        atlas_rdf_sparql_query_free(query);
+        return 0;
+    }
+    return query;
+}
+
+#pragma mark -
+#pragma mark Create a SPARQL Query
+
+atlas_rdf_query_t
+atlas_rdf_query_create(const char * query,
+                       atlas_error_handler err) {
+    assert(query != 0);
+    
+    __sparql_parser parser;
+    memset(&parser, 0, sizeof(__sparql_parser));
+    parser.p = query;
+    parser.end = query + strlen(query);
+    parser.line = 1;
+    parser.dict = atlas_rdf_term_dict_create(16);
+    
+    __sparql_query * compiled = atlas_rdf_sparql_parse_query(&parser);
+    
+    atlas_rdf_query_t result = 0;
+    if (compiled == 0) {
+        char * buff;
+        asprintf(&buff, "Syntax error in line %d: %s", parser.line,
+                 parser.error ? parser.error : "Invalid query.");
+        err(1, buff);
+        free(buff);
+    } else {
+        result = lz_obj_new_v(compiled, sizeof(__sparql_query), ^{
+            atlas_rdf_sparql_query_free(compiled);
+        }, parser.num_constants, parser.constants);
+    }
+    
+    for (int i=0; i<parser.num_prefixes; i++) {
+        free(parser.prefixes[i].name);
+        free(parser.prefixes[i].iri);
+    }
+    free(parser.prefixes);
+    for (int i=0; i<parser.num_variables; i++) {
+        free(parser.variables[i]);
+    }
+    free(parser.variables);
+    for (int i=0; i<parser.num_constants; i++) {
+        lz_release(parser.constants[i]);
+    }
+    free(parser.constants);
+    atlas_rdf_term_dict_free(parser.dict);
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Access Details of a SPARQL Query
+
+__sparql_query *
+atlas_rdf_sparql_query(atlas_rdf_query_t query) {
+    __block __sparql_query * result;
+    lz_obj_sync(query, ^(void * data, uint32_t length){
+        result = data;
+    });
+    return result;
+}
+
+int
+atlas_rdf_query_num_columns(atlas_rdf_query_t query) {
+    assert(query != 0);
+    return atlas_rdf_sparql_query(query)->num_columns;
+}
+
+const char *
+atlas_rdf_query_column_name(atlas_rdf_query_t query,
+                            int index) {
+    assert(query != 0);
+    __sparql_query * compiled = atlas_rdf_sparql_query(query);
+    assert(index >= 0 && index < compiled->num_columns);
+    return compiled->variables[compiled->columns[index].variable];
+}
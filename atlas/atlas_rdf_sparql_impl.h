@@ -0,0 +1,285 @@
+/*
+ *  atlas_rdf_sparql_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_SPARQL_IMPL_H_
+#define _ATLAS_RDF_SPARQL_IMPL_H_
+
+#include <atlas/rdf/sparql.h>
+
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// the parser compiles a query into the structures below, which are
+// executed by atlas_rdf_sparql_impl_exec.c; variables are referred to
+// by their index, constants by their index in the references of the query
+
+// a variable or a constant in a triple pattern
+typedef struct {
+    int32_t variable; // index of the variable or -1
+    int32_t constant; // index of the constant or -1
+} __sparql_slot;
+
+typedef struct {
+    __sparql_slot subject;
+    __sparql_slot predicate;
+    __sparql_slot object;
+} __sparql_triple;
+
+// operators of an expression
+#define ATLAS_RDF_SPARQL_EXPR_VARIABLE    0
+#define ATLAS_RDF_SPARQL_EXPR_CONSTANT    1
+#define ATLAS_RDF_SPARQL_EXPR_OR          2
+#define ATLAS_RDF_SPARQL_EXPR_AND         3
+#define ATLAS_RDF_SPARQL_EXPR_NOT         4
+#define ATLAS_RDF_SPARQL_EXPR_EQ          5
+#define ATLAS_RDF_SPARQL_EXPR_NE          6
+#define ATLAS_RDF_SPARQL_EXPR_LT          7
+#define ATLAS_RDF_SPARQL_EXPR_GT          8
+#define ATLAS_RDF_SPARQL_EXPR_LE          9
+#define ATLAS_RDF_SPARQL_EXPR_GE          10
+#define ATLAS_RDF_SPARQL_EXPR_BOUND       11
+#define ATLAS_RDF_SPARQL_EXPR_IS_IRI      12
+#define ATLAS_RDF_SPARQL_EXPR_IS_BLANK    13
+#define ATLAS_RDF_SPARQL_EXPR_IS_LITERAL  14
+#define ATLAS_RDF_SPARQL_EXPR_ADD         15
+#define ATLAS_RDF_SPARQL_EXPR_SUB         16
+#define ATLAS_RDF_SPARQL_EXPR_MUL         17
+#define ATLAS_RDF_SPARQL_EXPR_DIV         18
+#define ATLAS_RDF_SPARQL_EXPR_NEG         19
+#define ATLAS_RDF_SPARQL_EXPR_REGEX       20
+#define ATLAS_RDF_SPARQL_EXPR_LANG        21
+
+// the pattern of REGEX is a constant (args[1]), the
+// flags are stored in the index of the expression
+#define ATLAS_RDF_SPARQL_REGEX_ICASE      1
+
+typedef struct __sparql_expr_s {
+    uint32_t op;
+    int32_t index; // variable, constant or flags
+    struct __sparql_expr_s * args[2];
+} __sparql_expr;
+
+// the filters of a group compiled into one program (s. below)
+typedef struct __sparql_program_s __sparql_program;
+
+// kinds of a pattern: a group joins its elements (from left to
+// right) and applies its filters to the result, the element of
+// an optional pattern is a group, the elements of an union are
+// the alternatives (groups)
+#define ATLAS_RDF_SPARQL_TRIPLES  0
+#define ATLAS_RDF_SPARQL_GROUP    1
+#define ATLAS_RDF_SPARQL_OPTIONAL 2
+#define ATLAS_RDF_SPARQL_UNION    3
+
+typedef struct __sparql_pattern_s {
+    uint32_t kind;
+    int num_triples;
+    __sparql_triple * triples;
+    int num_elements;
+    struct __sparql_pattern_s ** elements;
+    int num_filters;
+    __sparql_expr ** filters;
+    __sparql_program * program; // the filters or NULL
+} __sparql_pattern;
+
+// aggregates of a column
+#define ATLAS_RDF_SPARQL_AGGREGATE_NONE   0
+#define ATLAS_RDF_SPARQL_AGGREGATE_COUNT  1
+#define ATLAS_RDF_SPARQL_AGGREGATE_SUM    2
+#define ATLAS_RDF_SPARQL_AGGREGATE_MIN    3
+#define ATLAS_RDF_SPARQL_AGGREGATE_MAX    4
+
+// a column of the result is a variable or the
+// aggregate of a variable (-1 for COUNT(*))
+typedef struct {
+    int32_t variable;
+    uint32_t aggregate;
+    int32_t argument;
+    int distinct;
+} __sparql_column;
+
+typedef struct {
+    int32_t variable;
+    int descending;
+} __sparql_order;
+
+typedef struct {
+    int num_variables;
+    char ** variables;
+    
+    __sparql_pattern * where;
+    
+    int distinct;
+    int num_columns;
+    __sparql_column * columns;
+    
+    // the solutions are grouped if there are aggregates
+    int grouped;
+    int num_group;
+    int32_t * group;
+    
+    int num_order;
+    __sparql_order * order;
+    
+    int64_t offset;
+    int64_t limit; // -1 if there is no limit
+} __sparql_query;
+
+#pragma mark -
+#pragma mark Execution Context
+
+// value of a variable, which is not bound
+#define ATLAS_RDF_SPARQL_UNBOUND UINT32_MAX
+
+// number of solutions processed at once
+#define ATLAS_RDF_SPARQL_BATCH_SIZE 1024
+
+// solutions are stored by column, a column contains the ids of
+// the values of a variable (there is a column for each variable)
+typedef struct {
+    uint32_t num_columns;
+    uint32_t length;
+    uint32_t capacity;
+    uint32_t ** columns;
+} __sparql_table;
+
+// the ids of the terms of the graph are the ids in the adjacency
+// index, terms created during the execution (i.e., the results of
+// aggregates) get the ids following the terms of the graph
+typedef struct {
+    __sparql_query * query;
+    atlas_rdf_query_t handle;
+    
+    atlas_rdf_graph_t graph;
+    struct atlas_rdf_graph_adjacency_s * adjacency;
+    struct atlas_rdf_graph_range_s * range; // built on first use
+    atlas_rdf_term_t * terms;
+    uint32_t num_terms;
+    uint32_t num_edges;
+    
+    // the id of each constant of the query or UNBOUND,
+    // if the constant is not in the graph
+    uint32_t * constants;
+    
+    atlas_rdf_term_dict_t created_dict;
+    int num_created;
+    atlas_rdf_term_t * created;
+} __sparql_context;
+
+static inline atlas_rdf_term_t
+atlas_rdf_sparql_term(__sparql_context * context, uint32_t id) {
+    if (id == ATLAS_RDF_SPARQL_UNBOUND) {
+        return 0;
+    }
+    if (id < context->num_terms) {
+        return context->terms[id];
+    }
+    return context->created[id - context->num_terms];
+}
+
+#pragma mark -
+#pragma mark Filter Programs
+
+// filters are compiled into a program for a stack machine, which
+// is evaluated for a batch of solutions at once (one instruction
+// for all solutions of the batch), s. atlas_rdf_sparql_impl_filter.c
+
+/*! Compile the filters of a group.
+ *
+ *  \param constants The constants of the query.
+ *
+ *  \return NULL on failure (the description is stored in error).
+ */
+__sparql_program *
+atlas_rdf_sparql_program_create(int num_filters,
+                                __sparql_expr ** filters,
+                                atlas_rdf_term_t * constants,
+                                const char ** error);
+
+void
+atlas_rdf_sparql_program_free(__sparql_program * program);
+
+/*! Evaluate a program for the solutions [begin, end) of a table.
+ *
+ *  The result of each solution is stored in accept[i - begin] (1 if
+ *  all filters are true, else 0).
+ */
+void
+atlas_rdf_sparql_program_eval(__sparql_context * context,
+                              __sparql_program * program,
+                              __sparql_table * table,
+                              uint32_t begin,
+                              uint32_t end,
+                              uint8_t * accept);
+
+#pragma mark -
+#pragma mark Access the Compiled Query
+
+/*! The compiled query of a SPARQL Query handle.
+ *
+ *  The query is owned by the handle, the constants
+ *  are the references of the handle.
+ */
+__sparql_query *
+atlas_rdf_sparql_query(atlas_rdf_query_t query);
+
+#pragma mark -
+#pragma mark Result Cache
+
+// a result, which is collected during the execution of a
+// query and added to the cache afterwards, s. atlas_rdf_sparql_impl_cache.c
+typedef struct __sparql_cache_entry_s __sparql_cache_entry;
+
+/*! Find the result of a query on a graph in the cache.
+ *
+ *  If the result is cached, the block is called for each solution like
+ *  in atlas_rdf_query_execute() (it may be NULL). Otherwise, entry is
+ *  set to a new entry for the result or NULL, if the cache is disabled.
+ *
+ *  \return The number of solutions or -1, if the result is not cached.
+ */
+int
+atlas_rdf_sparql_cache_lookup(atlas_rdf_query_t query,
+                              atlas_rdf_graph_t graph,
+                              void(^iterator)(atlas_rdf_term_t * values),
+                              __sparql_cache_entry ** entry);
+
+/*! Append a solution to a new entry.
+ *
+ *  The terms are retained. The solutions are dropped, if the
+ *  entry exceeds the limit of the cache.
+ */
+void
+atlas_rdf_sparql_cache_append(__sparql_cache_entry * entry,
+                              atlas_rdf_term_t * values);
+
+/*! Add a new entry with all solutions to the cache.
+ *
+ *  The cache takes over the entry (it is freed, if it
+ *  exceeds the limit).
+ */
+void
+atlas_rdf_sparql_cache_insert(__sparql_cache_entry * entry);
+
+#endif // _ATLAS_RDF_SPARQL_IMPL_H_
@@ -0,0 +1,470 @@
+/*
+ *  atlas_rdf_sparql_impl_cache.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_sparql_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// an entry is found by the header of the graph, the canonical form of the
+// compiled query (without the names of the variables) and the constants;
+// the entries are in a hash table and in a list from the most recently
+// to the least recently used entry. Readers hold a reference to an entry,
+// which is freed after it has been removed and the last reader is done.
+struct __sparql_cache_entry_s {
+    struct __sparql_cache_entry_s * next;
+    struct __sparql_cache_entry_s * newer;
+    struct __sparql_cache_entry_s * older;
+    int refs;
+    
+    const void * graph;
+    uint32_t hash;
+    uint32_t * pattern;
+    size_t pattern_length;
+    int num_constants;
+    atlas_rdf_term_t * constants;
+    
+    int num_columns;
+    int num_solutions;
+    int capacity;
+    atlas_rdf_term_t * values;
+    int overflow;
+    
+    size_t size;
+};
+
+#define ATLAS_RDF_SPARQL_CACHE_BUCKETS 256
+
+// the cache is modified on a serial queue
+static dispatch_queue_t atlas_rdf_sparql_cache_queue;
+static __sparql_cache_entry * atlas_rdf_sparql_cache_buckets[ATLAS_RDF_SPARQL_CACHE_BUCKETS];
+static __sparql_cache_entry * atlas_rdf_sparql_cache_newest;
+static __sparql_cache_entry * atlas_rdf_sparql_cache_oldest;
+static int atlas_rdf_sparql_cache_num_entries;
+static size_t atlas_rdf_sparql_cache_size;
+static volatile size_t atlas_rdf_sparql_cache_max_size;
+
+static void
+atlas_rdf_sparql_cache_invalidate(const void * graph);
+
+// the results of a graph are removed, before the graph is removed
+static dispatch_queue_t
+atlas_rdf_sparql_cache_get_queue(void) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        atlas_rdf_sparql_cache_queue = dispatch_queue_create("atlas.rdf.sparql.cache", 0);
+        atlas_rdf_graph_add_dealloc_hook(atlas_rdf_sparql_cache_invalidate);
+    });
+    return atlas_rdf_sparql_cache_queue;
+}
+
+// the memory of a term retained by an entry; a term used by
+// several values is counted for each of them
+static size_t
+atlas_rdf_sparql_cache_term_size(atlas_rdf_term_t term) {
+    __block size_t result = 0;
+    lz_obj_sync(term, ^(void * data, uint32_t length){
+        result = length;
+    });
+    return result;
+}
+
+#pragma mark -
+#pragma mark Canonical Form of a Query
+
+typedef struct {
+    uint32_t * data;
+    size_t length;
+    size_t capacity;
+} __sparql_cache_buffer;
+
+static void
+atlas_rdf_sparql_cache_put(__sparql_cache_buffer * buffer, uint32_t value) {
+    if (buffer->length == buffer->capacity) {
+        buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 64;
+        buffer->data = realloc(buffer->data, sizeof(uint32_t) * buffer->capacity);
+        assert(buffer->data != 0);
+    }
+    buffer->data[buffer->length++] = value;
+}
+
+static void
+atlas_rdf_sparql_cache_put_expr(__sparql_cache_buffer * buffer, __sparql_expr * expr) {
+    if (expr == 0) {
+        atlas_rdf_sparql_cache_put(buffer, UINT32_MAX);
+        return;
+    }
+    atlas_rdf_sparql_cache_put(buffer, expr->op);
+    atlas_rdf_sparql_cache_put(buffer, expr->index);
+    atlas_rdf_sparql_cache_put_expr(buffer, expr->args[0]);
+    atlas_rdf_sparql_cache_put_expr(buffer, expr->args[1]);
+}
+
+static void
+atlas_rdf_sparql_cache_put_pattern(__sparql_cache_buffer * buffer, __sparql_pattern * pattern) {
+    atlas_rdf_sparql_cache_put(buffer, pattern->kind);
+    atlas_rdf_sparql_cache_put(buffer, pattern->num_triples);
+    for (int i=0; i<pattern->num_triples; i++) {
+        __sparql_slot slots[3] = {pattern->triples[i].subject, pattern->triples[i].predicate, pattern->triples[i].object};
+        for (int k=0; k<3; k++) {
+            atlas_rdf_sparql_cache_put(buffer, slots[k].variable);
+            atlas_rdf_sparql_cache_put(buffer, slots[k].constant);
+        }
+    }
+    atlas_rdf_sparql_cache_put(buffer, pattern->num_elements);
+    for (int i=0; i<pattern->num_elements; i++) {
+        atlas_rdf_sparql_cache_put_pattern(buffer, pattern->elements[i]);
+    }
+    atlas_rdf_sparql_cache_put(buffer, pattern->num_filters);
+    for (int i=0; i<pattern->num_filters; i++) {
+        atlas_rdf_sparql_cache_put_expr(buffer, pattern->filters[i]);
+    }
+}
+
+// the variables are referred to by their index, the
+// names do not change the result and are left out
+static void
+atlas_rdf_sparql_cache_put_query(__sparql_cache_buffer * buffer, __sparql_query * query) {
+    atlas_rdf_sparql_cache_put(buffer, query->num_variables);
+    atlas_rdf_sparql_cache_put_pattern(buffer, query->where);
+    atlas_rdf_sparql_cache_put(buffer, query->distinct);
+    atlas_rdf_sparql_cache_put(buffer, query->num_columns);
+    for (int i=0; i<query->num_columns; i++) {
+        atlas_rdf_sparql_cache_put(buffer, query->columns[i].variable);
+        atlas_rdf_sparql_cache_put(buffer, query->columns[i].aggregate);
+        atlas_rdf_sparql_cache_put(buffer, query->columns[i].argument);
+        atlas_rdf_sparql_cache_put(buffer, query->columns[i].distinct);
+    }
+    atlas_rdf_sparql_cache_put(buffer, query->grouped);
+    atlas_rdf_sparql_cache_put(buffer, query->num_group);
+    for (int i=0; i<query->num_group; i++) {
+        atlas_rdf_sparql_cache_put(buffer, query->group[i]);
+    }
+    atlas_rdf_sparql_cache_put(buffer, query->num_order);
+    for (int i=0; i<query->num_order; i++) {
+        atlas_rdf_sparql_cache_put(buffer, query->order[i].variable);
+        atlas_rdf_sparql_cache_put(buffer, query->order[i].descending);
+    }
+    atlas_rdf_sparql_cache_put(buffer, (uint32_t)query->offset);
+    atlas_rdf_sparql_cache_put(buffer, (uint32_t)((uint64_t)query->offset >> 32));
+    atlas_rdf_sparql_cache_put(buffer, (uint32_t)query->limit);
+    atlas_rdf_sparql_cache_put(buffer, (uint32_t)((uint64_t)query->limit >> 32));
+}
+
+#pragma mark -
+#pragma mark Entries
+
+static void
+atlas_rdf_sparql_cache_entry_release(__sparql_cache_entry * entry) {
+    if (__sync_sub_and_fetch(&entry->refs, 1) > 0) {
+        return;
+    }
+    for (int i=0; i<entry->num_constants; i++) {
+        lz_release(entry->constants[i]);
+    }
+    for (int i=0; i<entry->num_solutions * entry->num_columns; i++) {
+        if (entry->values[i]) {
+            lz_release(entry->values[i]);
+        }
+    }
+    free(entry->pattern);
+    free(entry->constants);
+    free(entry->values);
+    free(entry);
+}
+
+// the constants are compared by type and value, terms of different
+// types can be equal (e.g., 1 and 1.0), but are not the same constant
+static int
+atlas_rdf_sparql_cache_entry_eq(__sparql_cache_entry * entry1, __sparql_cache_entry * entry2) {
+    if (entry1->hash != entry2->hash ||
+        entry1->graph != entry2->graph ||
+        entry1->pattern_length != entry2->pattern_length ||
+        entry1->num_constants != entry2->num_constants ||
+        memcmp(entry1->pattern, entry2->pattern, sizeof(uint32_t) * entry1->pattern_length) != 0) {
+        return 0;
+    }
+    for (int i=0; i<entry1->num_constants; i++) {
+        atlas_rdf_term_t c1 = entry1->constants[i];
+        atlas_rdf_term_t c2 = entry2->constants[i];
+        if (!lz_obj_same(c1, c2) &&
+            (atlas_rdf_term_type(c1) != atlas_rdf_term_type(c2) || !atlas_rdf_term_eq(c1, c2))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// remove an entry from the table and the list (on the queue)
+static void
+atlas_rdf_sparql_cache_remove(__sparql_cache_entry * entry) {
+    __sparql_cache_entry ** link = &atlas_rdf_sparql_cache_buckets[entry->hash % ATLAS_RDF_SPARQL_CACHE_BUCKETS];
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    
+    if (entry->newer) {
+        entry->newer->older = entry->older;
+    } else {
+        atlas_rdf_sparql_cache_newest = entry->older;
+    }
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        atlas_rdf_sparql_cache_oldest = entry->newer;
+    }
+    
+    atlas_rdf_sparql_cache_num_entries--;
+    atlas_rdf_sparql_cache_size -= entry->size;
+    atlas_rdf_sparql_cache_entry_release(entry);
+}
+
+// make an entry the most recently used one (on the queue)
+static void
+atlas_rdf_sparql_cache_touch(__sparql_cache_entry * entry) {
+    if (atlas_rdf_sparql_cache_newest == entry) {
+        return;
+    }
+    entry->newer->older = entry->older;
+    if (entry->older) {
+        entry->older->newer = entry->newer;
+    } else {
+        atlas_rdf_sparql_cache_oldest = entry->newer;
+    }
+    entry->newer = 0;
+    entry->older = atlas_rdf_sparql_cache_newest;
+    atlas_rdf_sparql_cache_newest->newer = entry;
+    atlas_rdf_sparql_cache_newest = entry;
+}
+
+// remove the least recently used entries (on the queue)
+static void
+atlas_rdf_sparql_cache_evict(size_t limit) {
+    while (atlas_rdf_sparql_cache_oldest && atlas_rdf_sparql_cache_size > limit) {
+        atlas_rdf_sparql_cache_remove(atlas_rdf_sparql_cache_oldest);
+    }
+}
+
+#pragma mark -
+#pragma mark Find and Add Results
+
+int
+atlas_rdf_sparql_cache_lookup(atlas_rdf_query_t query,
+                              atlas_rdf_graph_t graph,
+                              void(^iterator)(atlas_rdf_term_t * values),
+                              __sparql_cache_entry ** entry) {
+    *entry = 0;
+    if (atlas_rdf_sparql_cache_max_size == 0) {
+        return -1;
+    }
+    
+    __sparql_cache_entry * key = calloc(1, sizeof(__sparql_cache_entry));
+    assert(key != 0);
+    key->refs = 1;
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        key->graph = data;
+    });
+    
+    __sparql_query * compiled = atlas_rdf_sparql_query(query);
+    __sparql_cache_buffer buffer = {0, 0, 0};
+    atlas_rdf_sparql_cache_put_query(&buffer, compiled);
+    key->pattern = buffer.data;
+    key->pattern_length = buffer.length;
+    key->num_constants = lz_obj_num_ref(query);
+    key->constants = malloc(sizeof(atlas_rdf_term_t) * (key->num_constants + 1));
+    assert(key->constants != 0);
+    
+    // FNV-1a of the canonical form and the hashes of the constants
+    uint32_t hash = 2166136261u;
+    for (size_t i=0; i<buffer.length; i++) {
+        hash = (hash ^ buffer.data[i]) * 16777619u;
+    }
+    size_t constants_size = 0;
+    for (int i=0; i<key->num_constants; i++) {
+        key->constants[i] = lz_retain(lz_obj_weak_ref(query, i));
+        hash = (hash ^ atlas_rdf_term_hash(key->constants[i])) * 16777619u;
+        constants_size += atlas_rdf_sparql_cache_term_size(key->constants[i]);
+    }
+    hash = (hash ^ (uint32_t)(uintptr_t)key->graph) * 16777619u;
+    key->hash = hash;
+    key->num_columns = compiled->num_columns;
+    
+    __block __sparql_cache_entry * found = 0;
+    dispatch_sync(atlas_rdf_sparql_cache_get_queue(), ^{
+        for (found = atlas_rdf_sparql_cache_buckets[hash % ATLAS_RDF_SPARQL_CACHE_BUCKETS]; found; found = found->next) {
+            if (atlas_rdf_sparql_cache_entry_eq(found, key)) {
+                atlas_rdf_sparql_cache_touch(found);
+                __sync_add_and_fetch(&found->refs, 1);
+                return;
+            }
+        }
+    });
+    
+    if (found == 0) {
+        key->size = sizeof(__sparql_cache_entry) +
+                    sizeof(uint32_t) * key->pattern_length +
+                    sizeof(atlas_rdf_term_t) * key->num_constants +
+                    constants_size;
+        *entry = key;
+        return -1;
+    }
+    atlas_rdf_sparql_cache_entry_release(key);
+    
+    // the block is called without holding the queue
+    int num_solutions = found->num_solutions;
+    if (iterator) {
+        atlas_rdf_term_t * values = malloc(sizeof(atlas_rdf_term_t) * (found->num_columns + 1));
+        assert(values != 0);
+        for (int i=0; i<num_solutions; i++) {
+            memcpy(values, found->values + i * found->num_columns, sizeof(atlas_rdf_term_t) * found->num_columns);
+            iterator(values);
+        }
+        free(values);
+    }
+    atlas_rdf_sparql_cache_entry_release(found);
+    return num_solutions;
+}
+
+void
+atlas_rdf_sparql_cache_append(__sparql_cache_entry * entry,
+                              atlas_rdf_term_t * values) {
+    if (entry->overflow) {
+        return;
+    }
+    size_t row_size = sizeof(atlas_rdf_term_t) * entry->num_columns;
+    size_t size = row_size;
+    for (int i=0; i<entry->num_columns; i++) {
+        if (values[i]) {
+            size += atlas_rdf_sparql_cache_term_size(values[i]);
+        }
+    }
+    if (entry->size + size > atlas_rdf_sparql_cache_max_size) {
+        // the result is not cached, the solutions are dropped
+        for (int i=0; i<entry->num_solutions * entry->num_columns; i++) {
+            if (entry->values[i]) {
+                lz_release(entry->values[i]);
+            }
+        }
+        entry->num_solutions = 0;
+        entry->overflow = 1;
+        return;
+    }
+    if (entry->num_solutions == entry->capacity) {
+        entry->capacity = entry->capacity ? entry->capacity * 2 : 16;
+        entry->values = realloc(entry->values, row_size * entry->capacity + 1);
+        assert(entry->values != 0);
+    }
+    atlas_rdf_term_t * row = entry->values + entry->num_solutions * entry->num_columns;
+    for (int i=0; i<entry->num_columns; i++) {
+        row[i] = values[i] ? lz_retain(values[i]) : 0;
+    }
+    entry->num_solutions++;
+    entry->size += size;
+}
+
+void
+atlas_rdf_sparql_cache_insert(__sparql_cache_entry * entry) {
+    if (entry->overflow || entry->size > atlas_rdf_sparql_cache_max_size) {
+        atlas_rdf_sparql_cache_entry_release(entry);
+        return;
+    }
+    dispatch_sync(atlas_rdf_sparql_cache_get_queue(), ^{
+        // the result may have been added concurrently
+        __sparql_cache_entry ** bucket = &atlas_rdf_sparql_cache_buckets[entry->hash % ATLAS_RDF_SPARQL_CACHE_BUCKETS];
+        for (__sparql_cache_entry * other = *bucket; other; other = other->next) {
+            if (atlas_rdf_sparql_cache_entry_eq(other, entry)) {
+                atlas_rdf_sparql_cache_entry_release(entry);
+                return;
+            }
+        }
+        entry->next = *bucket;
+        *bucket = entry;
+        entry->newer = 0;
+        entry->older = atlas_rdf_sparql_cache_newest;
+        if (atlas_rdf_sparql_cache_newest) {
+            atlas_rdf_sparql_cache_newest->newer = entry;
+        } else {
+            atlas_rdf_sparql_cache_oldest = entry;
+        }
+        atlas_rdf_sparql_cache_newest = entry;
+        atlas_rdf_sparql_cache_num_entries++;
+        atlas_rdf_sparql_cache_size += entry->size;
+        atlas_rdf_sparql_cache_evict(atlas_rdf_sparql_cache_max_size);
+    });
+}
+
+static void
+atlas_rdf_sparql_cache_invalidate(const void * graph) {
+    dispatch_sync(atlas_rdf_sparql_cache_queue, ^{
+        __sparql_cache_entry * entry = atlas_rdf_sparql_cache_newest;
+        while (entry) {
+            __sparql_cache_entry * older = entry->older;
+            if (entry->graph == graph) {
+                atlas_rdf_sparql_cache_remove(entry);
+            }
+            entry = older;
+        }
+    });
+}
+
+#pragma mark -
+#pragma mark Configure the Result Cache
+
+void
+atlas_rdf_query_cache_set_limit(size_t limit) {
+    dispatch_sync(atlas_rdf_sparql_cache_get_queue(), ^{
+        atlas_rdf_sparql_cache_max_size = limit;
+        atlas_rdf_sparql_cache_evict(limit);
+    });
+}
+
+size_t
+atlas_rdf_query_cache_memory_size(void) {
+    __block size_t result;
+    dispatch_sync(atlas_rdf_sparql_cache_get_queue(), ^{
+        result = atlas_rdf_sparql_cache_size;
+    });
+    return result;
+}
+
+int
+atlas_rdf_query_cache_length(void) {
+    __block int result;
+    dispatch_sync(atlas_rdf_sparql_cache_get_queue(), ^{
+        result = atlas_rdf_sparql_cache_num_entries;
+    });
+    return result;
+}
+
+void
+atlas_rdf_query_cache_clear(void) {
+    dispatch_sync(atlas_rdf_sparql_cache_get_queue(), ^{
+        atlas_rdf_sparql_cache_evict(0);
+    });
+}
@@ -0,0 +1,1331 @@
+/*
+ *  atlas_rdf_sparql_impl_exec.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_sparql_impl.h"
+#include "atlas_rdf_graph_adjacency_impl.h"
+#include "atlas_rdf_graph_range_impl.h"
+#include "atlas_rdf_graph_text_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+#include "atlas_base_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <ctype.h>
+
+#pragma mark -
+#pragma mark Tables
+
+static __sparql_table *
+atlas_rdf_sparql_table_create(uint32_t num_columns, uint32_t capacity) {
+    __sparql_table * table = malloc(sizeof(__sparql_table));
+    assert(table != 0);
+    table->num_columns = num_columns;
+    table->length = 0;
+    table->capacity = capacity > 0 ? capacity : 1;
+    table->columns = malloc(sizeof(uint32_t *) * (num_columns + 1));
+    assert(table->columns != 0);
+    for (uint32_t i=0; i<num_columns; i++) {
+        table->columns[i] = malloc(sizeof(uint32_t) * table->capacity);
+        assert(table->columns[i] != 0);
+    }
+    return table;
+}
+
+static void
+atlas_rdf_sparql_table_free(__sparql_table * table) {
+    for (uint32_t i=0; i<table->num_columns; i++) {
+        free(table->columns[i]);
+    }
+    free(table->columns);
+    free(table);
+}
+
+static void
+atlas_rdf_sparql_table_reserve(__sparql_table * table, uint32_t length) {
+    if (table->length + length > table->capacity) {
+        table->capacity = (table->length + length) * 2;
+        for (uint32_t i=0; i<table->num_columns; i++) {
+            table->columns[i] = realloc(table->columns[i], sizeof(uint32_t) * table->capacity);
+            assert(table->columns[i] != 0);
+        }
+    }
+}
+
+static void
+atlas_rdf_sparql_table_append(__sparql_table * table, const uint32_t * row) {
+    atlas_rdf_sparql_table_reserve(table, 1);
+    for (uint32_t i=0; i<table->num_columns; i++) {
+        table->columns[i][table->length] = row[i];
+    }
+    table->length++;
+}
+
+static void
+atlas_rdf_sparql_table_row(__sparql_table * table, uint32_t index, uint32_t * row) {
+    for (uint32_t i=0; i<table->num_columns; i++) {
+        row[i] = table->columns[i][index];
+    }
+}
+
+// a table with one solution, which does not bind any variable
+static __sparql_table *
+atlas_rdf_sparql_table_unit(uint32_t num_columns) {
+    __sparql_table * table = atlas_rdf_sparql_table_create(num_columns, 1);
+    for (uint32_t i=0; i<num_columns; i++) {
+        table->columns[i][0] = ATLAS_RDF_SPARQL_UNBOUND;
+    }
+    table->length = 1;
+    return table;
+}
+
+// append the solutions of the second table to the first
+static void
+atlas_rdf_sparql_table_concat(__sparql_table * table, __sparql_table * other) {
+    atlas_rdf_sparql_table_reserve(table, other->length);
+    for (uint32_t i=0; i<table->num_columns; i++) {
+        memcpy(table->columns[i] + table->length, other->columns[i], sizeof(uint32_t) * other->length);
+    }
+    table->length += other->length;
+}
+
+// check if the variable of a column is bound in all solutions
+static int
+atlas_rdf_sparql_table_bound(__sparql_table * table, uint32_t column) {
+    for (uint32_t i=0; i<table->length; i++) {
+        if (table->columns[column][i] == ATLAS_RDF_SPARQL_UNBOUND) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// apply the block to batches of [0, length) concurrently, each batch
+// appends its solutions to its own table, the results are concatenated
+// in the order of the batches
+static __sparql_table *
+atlas_rdf_sparql_map(uint32_t num_columns,
+                     uint32_t length,
+                     void(^block)(__sparql_table * output, uint32_t begin, uint32_t end)) {
+    uint32_t num_batches = (length + ATLAS_RDF_SPARQL_BATCH_SIZE - 1) / ATLAS_RDF_SPARQL_BATCH_SIZE;
+    __sparql_table ** outputs = malloc(sizeof(__sparql_table *) * (num_batches + 1));
+    assert(outputs != 0);
+    
+    atlas_apply_chunked(num_batches, 1, 0, ^(void * state, size_t begin, size_t end){
+        for (size_t b=begin; b<end; b++) {
+            uint32_t first = b * ATLAS_RDF_SPARQL_BATCH_SIZE;
+            uint32_t last = first + ATLAS_RDF_SPARQL_BATCH_SIZE < length ? first + ATLAS_RDF_SPARQL_BATCH_SIZE : length;
+            outputs[b] = atlas_rdf_sparql_table_create(num_columns, last - first);
+            block(outputs[b], first, last);
+        }
+    }, 0);
+    
+    uint32_t total = 0;
+    for (uint32_t b=0; b<num_batches; b++) {
+        total += outputs[b]->length;
+    }
+    __sparql_table * result = atlas_rdf_sparql_table_create(num_columns, total);
+    for (uint32_t b=0; b<num_batches; b++) {
+        atlas_rdf_sparql_table_concat(result, outputs[b]);
+        atlas_rdf_sparql_table_free(outputs[b]);
+    }
+    free(outputs);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Row Sets
+
+// a hash set of solutions, which are compared by the values of the
+// given columns; the buckets contain the index of a solution + 1
+typedef struct {
+    __sparql_table * table;
+    int num_keys;
+    const int32_t * keys;
+    uint32_t * buckets;
+    uint32_t capacity;
+    uint32_t length;
+} __sparql_row_set;
+
+static uint32_t
+atlas_rdf_sparql_row_hash(__sparql_table * table, int num_keys, const int32_t * keys, uint32_t row) {
+    uint32_t hash = 2166136261u;
+    for (int i=0; i<num_keys; i++) {
+        hash = (hash ^ table->columns[keys[i]][row]) * 16777619u;
+        hash ^= hash >> 15;
+    }
+    return hash;
+}
+
+static int
+atlas_rdf_sparql_row_eq(__sparql_table * table, int num_keys, const int32_t * keys, uint32_t row1, uint32_t row2) {
+    for (int i=0; i<num_keys; i++) {
+        if (table->columns[keys[i]][row1] != table->columns[keys[i]][row2]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void
+atlas_rdf_sparql_row_set_init(__sparql_row_set * set, __sparql_table * table, int num_keys, const int32_t * keys) {
+    set->table = table;
+    set->num_keys = num_keys;
+    set->keys = keys;
+    set->capacity = 16;
+    set->length = 0;
+    set->buckets = calloc(set->capacity, sizeof(uint32_t));
+    assert(set->buckets != 0);
+}
+
+static void
+atlas_rdf_sparql_row_set_free(__sparql_row_set * set) {
+    free(set->buckets);
+}
+
+// insert a solution, if there is no equal solution in the set
+// \return The index of the equal solution in the set or -1
+static int64_t
+atlas_rdf_sparql_row_set_insert(__sparql_row_set * set, uint32_t row) {
+    if (set->length * 2 >= set->capacity) {
+        uint32_t capacity = set->capacity * 2;
+        uint32_t * buckets = calloc(capacity, sizeof(uint32_t));
+        assert(buckets != 0);
+        for (uint32_t i=0; i<set->capacity; i++) {
+            if (set->buckets[i]) {
+                uint32_t b = atlas_rdf_sparql_row_hash(set->table, set->num_keys, set->keys, set->buckets[i] - 1) & (capacity - 1);
+                while (buckets[b]) {
+                    b = (b + 1) & (capacity - 1);
+                }
+                buckets[b] = set->buckets[i];
+            }
+        }
+        free(set->buckets);
+        set->buckets = buckets;
+        set->capacity = capacity;
+    }
+    
+    uint32_t b = atlas_rdf_sparql_row_hash(set->table, set->num_keys, set->keys, row) & (set->capacity - 1);
+    while (set->buckets[b]) {
+        uint32_t other = set->buckets[b] - 1;
+        if (atlas_rdf_sparql_row_eq(set->table, set->num_keys, set->keys, other, row)) {
+            return other;
+        }
+        b = (b + 1) & (set->capacity - 1);
+    }
+    set->buckets[b] = row + 1;
+    set->length++;
+    return -1;
+}
+
+#pragma mark -
+#pragma mark Terms
+
+// the id of a term created during the execution,
+// the context takes over the reference to the term
+static uint32_t
+atlas_rdf_sparql_created_id(__sparql_context * context, atlas_rdf_term_t term) {
+    int id = atlas_rdf_term_dict_lookup(context->adjacency->dict, term);
+    if (id >= 0) {
+        lz_release(term);
+        return id;
+    }
+    id = atlas_rdf_term_dict_insert(context->created_dict, term);
+    if (id < context->num_created) {
+        lz_release(term);
+    } else {
+        context->created = realloc(context->created, sizeof(atlas_rdf_term_t) * (context->num_created + 1));
+        assert(context->created != 0);
+        context->created[context->num_created++] = term;
+    }
+    return context->num_terms + id;
+}
+
+#pragma mark -
+#pragma mark Evaluate Filters
+
+static __sparql_table *
+atlas_rdf_sparql_filter(__sparql_context * context, __sparql_table * input, __sparql_program * program) {
+    if (program == 0) {
+        return input;
+    }
+    uint32_t num_columns = input->num_columns;
+    __sparql_table * result = atlas_rdf_sparql_map(num_columns, input->length, ^(__sparql_table * output, uint32_t begin, uint32_t end){
+        uint8_t * accept = malloc(end - begin + 1);
+        uint32_t * row = malloc(sizeof(uint32_t) * (num_columns + 1));
+        assert(accept != 0);
+        assert(row != 0);
+        atlas_rdf_sparql_program_eval(context, program, input, begin, end, accept);
+        for (uint32_t i=begin; i<end; i++) {
+            if (accept[i - begin]) {
+                atlas_rdf_sparql_table_row(input, i, row);
+                atlas_rdf_sparql_table_append(output, row);
+            }
+        }
+        free(row);
+        free(accept);
+    });
+    atlas_rdf_sparql_table_free(input);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Constraints of Variables
+
+// the values of a variable, which can satisfy the filters of a group: a
+// closed range of numeric or datetime values and a set of string literals
+// (s. REGEX and LANG); the statements matching a triple pattern can be read
+// from the range or text index instead of a scan (the filters are still
+// applied, both indexes return a superset)
+typedef struct {
+    int domain; // -1 if there is no range
+    double min;
+    double max;
+    
+    __sparql_expr * regex;   // the first REGEX of the variable or NULL
+    int32_t language;        // the constant compared with LANG or -1
+    
+    int has_candidates;
+    uint32_t num_candidates;
+    uint32_t * candidates;   // sorted ids of the literals
+    uint32_t num_statements; // statements with a candidate as object
+} __sparql_constraint;
+
+// the text of a regular expression, if the expression matches exactly
+// the strings containing the text (or starting with it), else NULL
+static char *
+atlas_rdf_sparql_regex_text(const char * pattern, int * flags) {
+    char * text = malloc(strlen(pattern) + 1);
+    assert(text != 0);
+    size_t length = 0;
+    const char * c = pattern;
+    if (*c == '^') {
+        *flags |= ATLAS_RDF_TEXT_PREFIX;
+        c++;
+    }
+    for (; *c; c++) {
+        // non-ASCII letters may be case-insensitive in the regex
+        if ((*flags & ATLAS_RDF_TEXT_ICASE) && (unsigned char)*c >= 0x80) {
+            free(text);
+            return 0;
+        }
+        if (*c == '\\' && c[1] != 0 && ispunct((unsigned char)c[1])) {
+            text[length++] = *++c;
+        } else if (strchr(".[]()*+?{}|\\^$", *c)) {
+            free(text);
+            return 0;
+        } else {
+            text[length++] = *c;
+        }
+    }
+    text[length] = 0;
+    return text;
+}
+
+static void
+atlas_rdf_sparql_constraint_add(__sparql_context * context, __sparql_constraint * constraints, __sparql_expr * expr) {
+    if (expr->op == ATLAS_RDF_SPARQL_EXPR_AND) {
+        atlas_rdf_sparql_constraint_add(context, constraints, expr->args[0]);
+        atlas_rdf_sparql_constraint_add(context, constraints, expr->args[1]);
+        return;
+    }
+    if (expr->op == ATLAS_RDF_SPARQL_EXPR_REGEX) {
+        if (expr->args[0]->op == ATLAS_RDF_SPARQL_EXPR_VARIABLE && constraints[expr->args[0]->index].regex == 0) {
+            constraints[expr->args[0]->index].regex = expr;
+        }
+        return;
+    }
+    uint32_t op = expr->op;
+    if (op != ATLAS_RDF_SPARQL_EXPR_EQ && (op < ATLAS_RDF_SPARQL_EXPR_LT || op > ATLAS_RDF_SPARQL_EXPR_GE)) {
+        return;
+    }
+    __sparql_expr * variable = expr->args[0];
+    __sparql_expr * constant = expr->args[1];
+    if (variable->op == ATLAS_RDF_SPARQL_EXPR_CONSTANT) {
+        variable = expr->args[1];
+        constant = expr->args[0];
+        switch (op) {
+            case ATLAS_RDF_SPARQL_EXPR_LT: op = ATLAS_RDF_SPARQL_EXPR_GT; break;
+            case ATLAS_RDF_SPARQL_EXPR_GT: op = ATLAS_RDF_SPARQL_EXPR_LT; break;
+            case ATLAS_RDF_SPARQL_EXPR_LE: op = ATLAS_RDF_SPARQL_EXPR_GE; break;
+            case ATLAS_RDF_SPARQL_EXPR_GE: op = ATLAS_RDF_SPARQL_EXPR_LE; break;
+        }
+    }
+    if (constant->op != ATLAS_RDF_SPARQL_EXPR_CONSTANT) {
+        return;
+    }
+    atlas_rdf_term_t term = lz_obj_weak_ref(context->handle, constant->index);
+    
+    // LANG(?x) = "language"
+    if (op == ATLAS_RDF_SPARQL_EXPR_EQ &&
+        variable->op == ATLAS_RDF_SPARQL_EXPR_LANG &&
+        variable->args[0]->op == ATLAS_RDF_SPARQL_EXPR_VARIABLE) {
+        __sparql_constraint * constraint = &constraints[variable->args[0]->index];
+        if (constraint->language == -1 && atlas_rdf_term_type(term) == STRING_LITERAL) {
+            char * value = atlas_rdf_term_literal_value(term);
+            char * lang = atlas_rdf_term_string_lang(term);
+            // literals without a language are not only string literals
+            if (value[0] != 0 && lang[0] == 0) {
+                constraint->language = constant->index;
+            }
+            free(value);
+            free(lang);
+        }
+        return;
+    }
+    if (variable->op != ATLAS_RDF_SPARQL_EXPR_VARIABLE) {
+        return;
+    }
+    double value;
+    int domain = atlas_rdf_graph_range_value(term, &value);
+    if (domain == -1) {
+        return;
+    }
+    
+    // strict comparisons are widened to closed ranges,
+    // the values are compared as doubles in the index
+    double min = op == ATLAS_RDF_SPARQL_EXPR_LT || op == ATLAS_RDF_SPARQL_EXPR_LE ? -HUGE_VAL : value;
+    double max = op == ATLAS_RDF_SPARQL_EXPR_GT || op == ATLAS_RDF_SPARQL_EXPR_GE ? HUGE_VAL : value;
+    
+    __sparql_constraint * constraint = &constraints[variable->index];
+    if (constraint->domain == -1) {
+        constraint->domain = domain;
+        constraint->min = min;
+        constraint->max = max;
+    } else if (constraint->domain != domain) {
+        // no value satisfies both comparisons
+        constraint->min = HUGE_VAL;
+        constraint->max = -HUGE_VAL;
+    } else {
+        constraint->min = min > constraint->min ? min : constraint->min;
+        constraint->max = max < constraint->max ? max : constraint->max;
+    }
+}
+
+// the candidates of a variable with a REGEX with a literal
+// pattern or a language, looked up in the text index
+static void
+atlas_rdf_sparql_constraint_text(__sparql_context * context, __sparql_constraint * constraint) {
+    char * pattern = 0;
+    int flags = 0;
+    if (constraint->regex) {
+        if (constraint->regex->index & ATLAS_RDF_SPARQL_REGEX_ICASE) {
+            flags |= ATLAS_RDF_TEXT_ICASE;
+        }
+        char * regex = atlas_rdf_term_literal_value(lz_obj_weak_ref(context->handle, constraint->regex->args[1]->index));
+        pattern = atlas_rdf_sparql_regex_text(regex, &flags);
+        free(regex);
+    }
+    if (pattern == 0 && constraint->language == -1) {
+        return;
+    }
+    char * language = 0;
+    if (constraint->language != -1) {
+        language = atlas_rdf_term_literal_value(lz_obj_weak_ref(context->handle, constraint->language));
+    }
+    
+    struct atlas_rdf_graph_text_s * text = atlas_rdf_graph_text_index(context->graph);
+    constraint->has_candidates = 1;
+    constraint->num_candidates = atlas_rdf_graph_text_lookup(text, pattern ? pattern : "", language, flags, &constraint->candidates);
+    constraint->num_statements = 0;
+    __adjacency_rows * rows = &context->adjacency->incoming;
+    for (uint32_t i=0; i<constraint->num_candidates; i++) {
+        uint32_t id = constraint->candidates[i];
+        constraint->num_statements += rows->offsets[id + 1] - rows->offsets[id];
+    }
+    free(pattern);
+    free(language);
+}
+
+// the constraints of the variables of a group or NULL
+static __sparql_constraint *
+atlas_rdf_sparql_constraints(__sparql_context * context, __sparql_pattern * group) {
+    if (group->num_filters == 0) {
+        return 0;
+    }
+    int num_variables = context->query->num_variables;
+    __sparql_constraint * constraints = calloc(num_variables + 1, sizeof(__sparql_constraint));
+    assert(constraints != 0);
+    for (int i=0; i<num_variables; i++) {
+        constraints[i].domain = -1;
+        constraints[i].language = -1;
+    }
+    for (int i=0; i<group->num_filters; i++) {
+        atlas_rdf_sparql_constraint_add(context, constraints, group->filters[i]);
+    }
+    for (int i=0; i<num_variables; i++) {
+        atlas_rdf_sparql_constraint_text(context, &constraints[i]);
+    }
+    return constraints;
+}
+
+static void
+atlas_rdf_sparql_constraints_free(__sparql_constraint * constraints, int num_variables) {
+    if (constraints) {
+        for (int i=0; i<num_variables; i++) {
+            free(constraints[i].candidates);
+        }
+        free(constraints);
+    }
+}
+
+// the statements matching a triple pattern, if neither the subject nor
+// the object is bound: the entries [begin, end) of a column of the range
+// index, the objects [begin, end) in a set of candidates or the subjects
+// [begin, end) of the graph
+typedef struct {
+    __range_column * column;
+    const uint32_t * candidates;
+    uint32_t begin;
+    uint32_t end;
+    double estimate;
+} __sparql_access;
+
+static void
+atlas_rdf_sparql_access(__sparql_context * context,
+                        __sparql_triple * triple,
+                        const __sparql_constraint * constraints,
+                        __sparql_access * access) {
+    memset(access, 0, sizeof(__sparql_access));
+    access->end = context->num_terms;
+    access->estimate = context->num_edges;
+    if (constraints == 0 || triple->object.variable < 0) {
+        return;
+    }
+    const __sparql_constraint * constraint = &constraints[triple->object.variable];
+    if (constraint->domain != -1 && triple->predicate.constant >= 0) {
+        if (context->range == 0) {
+            context->range = atlas_rdf_graph_range_index(context->graph);
+        }
+        uint32_t p = context->constants[triple->predicate.constant];
+        atlas_rdf_graph_range_span(context->range, constraint->domain, p, constraint->min, constraint->max, 0, &access->begin, &access->end);
+        access->column = &context->range->columns[constraint->domain];
+        access->estimate = access->end - access->begin;
+    } else if (constraint->has_candidates) {
+        access->candidates = constraint->candidates;
+        access->end = constraint->num_candidates;
+        access->estimate = constraint->num_statements;
+    }
+}
+
+#pragma mark -
+#pragma mark Evaluate Basic Graph Patterns
+
+// the id of a slot in a solution or UNBOUND
+static inline uint32_t
+atlas_rdf_sparql_slot(__sparql_context * context, __sparql_slot slot, const uint32_t * row) {
+    if (slot.variable >= 0) {
+        return row[slot.variable];
+    }
+    return context->constants[slot.constant];
+}
+
+// bind the variables of a triple pattern to the terms of a statement
+static inline int
+atlas_rdf_sparql_bind(__sparql_triple * triple, uint32_t * row, uint32_t s, uint32_t p, uint32_t o) {
+    const __sparql_slot * slots[3] = {&triple->subject, &triple->predicate, &triple->object};
+    uint32_t ids[3] = {s, p, o};
+    for (int k=0; k<3; k++) {
+        int32_t variable = slots[k]->variable;
+        if (variable >= 0) {
+            if (row[variable] == ATLAS_RDF_SPARQL_UNBOUND) {
+                row[variable] = ids[k];
+            } else if (row[variable] != ids[k]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+// extend a solution with the statements matching a triple pattern, if
+// neither the subject nor the object is bound, the statements at the
+// positions [first, last) of the access path are used
+static void
+atlas_rdf_sparql_extend_row(__sparql_context * context,
+                            __sparql_triple * triple,
+                            const uint32_t * row,
+                            uint32_t * out,
+                            const __sparql_access * access,
+                            uint32_t first,
+                            uint32_t last,
+                            __sparql_table * output) {
+    uint32_t num_columns = output->num_columns;
+    uint32_t s = atlas_rdf_sparql_slot(context, triple->subject, row);
+    uint32_t p = atlas_rdf_sparql_slot(context, triple->predicate, row);
+    uint32_t o = atlas_rdf_sparql_slot(context, triple->object, row);
+    
+    // the entries of the range index
+    if (s == ATLAS_RDF_SPARQL_UNBOUND && o == ATLAS_RDF_SPARQL_UNBOUND && access->column) {
+        __range_column * column = access->column;
+        for (uint32_t i=first; i<last; i++) {
+            memcpy(out, row, sizeof(uint32_t) * num_columns);
+            if (atlas_rdf_sparql_bind(triple, out, column->subjects[i], p, column->objects[i])) {
+                atlas_rdf_sparql_table_append(output, out);
+            }
+        }
+        return;
+    }
+    
+    __adjacency_rows * rows;
+    const uint32_t * ids = 0;
+    int incoming = 0;
+    if (s != ATLAS_RDF_SPARQL_UNBOUND) {
+        rows = &context->adjacency->outgoing;
+        first = s;
+        last = s + 1;
+    } else if (o != ATLAS_RDF_SPARQL_UNBOUND) {
+        rows = &context->adjacency->incoming;
+        incoming = 1;
+        first = o;
+        last = o + 1;
+    } else if (access->candidates) {
+        // the statements with a candidate as object
+        rows = &context->adjacency->incoming;
+        incoming = 1;
+        ids = access->candidates;
+    } else {
+        rows = &context->adjacency->outgoing;
+    }
+    
+    for (uint32_t i=first; i<last; i++) {
+        uint32_t id = ids ? ids[i] : i;
+        for (uint32_t e=rows->offsets[id]; e<rows->offsets[id + 1]; e++) {
+            uint32_t * edge = rows->edges + 2 * e;
+            if (p != ATLAS_RDF_SPARQL_UNBOUND && edge[0] != p) {
+                continue;
+            }
+            uint32_t es = incoming ? edge[1] : id;
+            uint32_t eo = incoming ? id : edge[1];
+            if ((s != ATLAS_RDF_SPARQL_UNBOUND && es != s) || (o != ATLAS_RDF_SPARQL_UNBOUND && eo != o)) {
+                continue;
+            }
+            memcpy(out, row, sizeof(uint32_t) * num_columns);
+            if (atlas_rdf_sparql_bind(triple, out, es, edge[0], eo)) {
+                atlas_rdf_sparql_table_append(output, out);
+            }
+        }
+    }
+}
+
+static __sparql_table *
+atlas_rdf_sparql_extend(__sparql_context * context,
+                        __sparql_table * input,
+                        __sparql_triple * triple,
+                        const __sparql_constraint * constraints) {
+    uint32_t num_columns = input->num_columns;
+    __sparql_access access;
+    atlas_rdf_sparql_access(context, triple, constraints, &access);
+    
+    // a single solution, which needs a scan of all statements, is
+    // extended concurrently for parts of the access path
+    if (input->length == 1) {
+        uint32_t * row = malloc(sizeof(uint32_t) * (num_columns + 1));
+        assert(row != 0);
+        atlas_rdf_sparql_table_row(input, 0, row);
+        if (atlas_rdf_sparql_slot(context, triple->subject, row) == ATLAS_RDF_SPARQL_UNBOUND &&
+            atlas_rdf_sparql_slot(context, triple->object, row) == ATLAS_RDF_SPARQL_UNBOUND) {
+            __sparql_table * result = atlas_rdf_sparql_map(num_columns, access.end - access.begin, ^(__sparql_table * output, uint32_t begin, uint32_t end){
+                uint32_t * out = malloc(sizeof(uint32_t) * (num_columns + 1));
+                assert(out != 0);
+                atlas_rdf_sparql_extend_row(context, triple, row, out, &access, access.begin + begin, access.begin + end, output);
+                free(out);
+            });
+            free(row);
+            atlas_rdf_sparql_table_free(input);
+            return result;
+        }
+        free(row);
+    }
+    
+    __sparql_table * result = atlas_rdf_sparql_map(num_columns, input->length, ^(__sparql_table * output, uint32_t begin, uint32_t end){
+        uint32_t * row = malloc(sizeof(uint32_t) * (num_columns + 1));
+        uint32_t * out = malloc(sizeof(uint32_t) * (num_columns + 1));
+        assert(row != 0);
+        assert(out != 0);
+        for (uint32_t i=begin; i<end; i++) {
+            atlas_rdf_sparql_table_row(input, i, row);
+            atlas_rdf_sparql_extend_row(context, triple, row, out, &access, access.begin, access.end, output);
+        }
+        free(row);
+        free(out);
+    });
+    atlas_rdf_sparql_table_free(input);
+    return result;
+}
+
+// estimated number of statements matching a triple pattern
+// for each solution, if the given variables are bound
+static double
+atlas_rdf_sparql_estimate(__sparql_context * context,
+                          __sparql_triple * triple,
+                          const __sparql_constraint * constraints,
+                          const char * bound) {
+    double average = context->num_terms > 0 ? (double)context->num_edges / context->num_terms : 0;
+    double result = context->num_edges;
+    __sparql_slot s = triple->subject;
+    __sparql_slot o = triple->object;
+    
+    if (s.constant >= 0) {
+        uint32_t id = context->constants[s.constant];
+        __adjacency_rows * rows = &context->adjacency->outgoing;
+        result = rows->offsets[id + 1] - rows->offsets[id];
+    } else if (bound[s.variable]) {
+        result = average;
+    }
+    if (o.constant >= 0) {
+        uint32_t id = context->constants[o.constant];
+        __adjacency_rows * rows = &context->adjacency->incoming;
+        double count = rows->offsets[id + 1] - rows->offsets[id];
+        result = count < result ? count : result;
+    } else if (bound[o.variable] && average < result) {
+        result = average;
+    }
+    
+    // a bound predicate reduces the number of matching statements
+    if (triple->predicate.constant >= 0 || bound[triple->predicate.variable]) {
+        result /= 2;
+    }
+    
+    // the statements in the access path of an unbound object
+    if (s.constant < 0 && !bound[s.variable] && o.constant < 0 && !bound[o.variable]) {
+        __sparql_access access;
+        atlas_rdf_sparql_access(context, triple, constraints, &access);
+        if (access.column || access.candidates) {
+            result = access.estimate;
+        }
+    }
+    return result;
+}
+
+static __sparql_table *
+atlas_rdf_sparql_bgp(__sparql_context * context,
+                     __sparql_pattern * pattern,
+                     const __sparql_constraint * constraints,
+                     __sparql_table * input) {
+    
+    // a constant, which is not in the graph, does not match any statement
+    for (int i=0; i<pattern->num_triples; i++) {
+        __sparql_slot slots[3] = {pattern->triples[i].subject, pattern->triples[i].predicate, pattern->triples[i].object};
+        for (int k=0; k<3; k++) {
+            if (slots[k].constant >= 0 && context->constants[slots[k].constant] == ATLAS_RDF_SPARQL_UNBOUND) {
+                input->length = 0;
+                return input;
+            }
+        }
+    }
+    
+    // the variables bound in all solutions
+    char * bound = calloc(input->num_columns + 1, 1);
+    char * done = calloc(pattern->num_triples + 1, 1);
+    assert(bound != 0);
+    assert(done != 0);
+    for (uint32_t i=0; i<input->num_columns; i++) {
+        bound[i] = atlas_rdf_sparql_table_bound(input, i);
+    }
+    
+    // join the triple patterns greedily, starting
+    // with the pattern with the fewest matches
+    __sparql_table * table = input;
+    for (int n=0; n<pattern->num_triples && table->length > 0; n++) {
+        int best = -1;
+        double best_estimate = 0;
+        for (int i=0; i<pattern->num_triples; i++) {
+            if (done[i]) {
+                continue;
+            }
+            double estimate = atlas_rdf_sparql_estimate(context, &pattern->triples[i], constraints, bound);
+            if (best == -1 || estimate < best_estimate) {
+                best = i;
+                best_estimate = estimate;
+            }
+        }
+        __sparql_triple * triple = &pattern->triples[best];
+        done[best] = 1;
+        if (triple->subject.variable >= 0) bound[triple->subject.variable] = 1;
+        if (triple->predicate.variable >= 0) bound[triple->predicate.variable] = 1;
+        if (triple->object.variable >= 0) bound[triple->object.variable] = 1;
+        
+        table = atlas_rdf_sparql_extend(context, table, triple, constraints);
+    }
+    
+    free(bound);
+    free(done);
+    return table;
+}
+
+#pragma mark -
+#pragma mark Join Solutions
+
+// join the solutions of two tables, the program (if any) filters the
+// joined solutions; if optional, the solutions of the left table
+// without a compatible solution in the right table are kept
+static __sparql_table *
+atlas_rdf_sparql_join(__sparql_context * context,
+                      __sparql_table * left,
+                      __sparql_table * right,
+                      __sparql_program * program,
+                      int optional) {
+    uint32_t num_columns = left->num_columns;
+    
+    // the variables bound in all solutions of both tables are the keys
+    int32_t * keys = malloc(sizeof(int32_t) * (num_columns + 1));
+    assert(keys != 0);
+    int num_keys = 0;
+    for (uint32_t i=0; i<num_columns; i++) {
+        if (right->length > 0 && left->length > 0 &&
+            atlas_rdf_sparql_table_bound(left, i) && atlas_rdf_sparql_table_bound(right, i)) {
+            keys[num_keys++] = i;
+        }
+    }
+    
+    // hash the solutions of the right table by the keys, solutions
+    // with the same hash value are chained (in their order)
+    uint32_t capacity = 16;
+    while (capacity < right->length * 2) {
+        capacity <<= 1;
+    }
+    uint32_t * heads = malloc(sizeof(uint32_t) * capacity);
+    uint32_t * next = malloc(sizeof(uint32_t) * (right->length + 1));
+    assert(heads != 0);
+    assert(next != 0);
+    memset(heads, 0xff, sizeof(uint32_t) * capacity);
+    for (uint32_t i=right->length; i>0; i--) {
+        uint32_t b = atlas_rdf_sparql_row_hash(right, num_keys, keys, i - 1) & (capacity - 1);
+        next[i - 1] = heads[b];
+        heads[b] = i - 1;
+    }
+    
+    __sparql_table * result = atlas_rdf_sparql_map(num_columns, left->length, ^(__sparql_table * output, uint32_t begin, uint32_t end){
+        uint32_t * row = malloc(sizeof(uint32_t) * (num_columns + 1));
+        uint32_t * out = malloc(sizeof(uint32_t) * (num_columns + 1));
+        assert(row != 0);
+        assert(out != 0);
+        
+        // the compatible pairs of solutions of the batch (in the order
+        // of the left solutions) and the left solution of each pair
+        __sparql_table * candidates = atlas_rdf_sparql_table_create(num_columns, end - begin);
+        uint32_t * owners = malloc(sizeof(uint32_t) * (end - begin));
+        uint32_t num_owners = end - begin;
+        assert(owners != 0);
+        for (uint32_t i=begin; i<end; i++) {
+            atlas_rdf_sparql_table_row(left, i, row);
+            uint32_t b = atlas_rdf_sparql_row_hash(left, num_keys, keys, i) & (capacity - 1);
+            for (uint32_t r=heads[b]; r != UINT32_MAX; r=next[r]) {
+                
+                // the solutions are compatible, if the values of all
+                // variables bound in both solutions are equal
+                int compatible = 1;
+                for (uint32_t c=0; c<num_columns && compatible; c++) {
+                    uint32_t v = right->columns[c][r];
+                    if (row[c] == ATLAS_RDF_SPARQL_UNBOUND) {
+                        out[c] = v;
+                    } else {
+                        out[c] = row[c];
+                        compatible = v == ATLAS_RDF_SPARQL_UNBOUND || v == row[c];
+                    }
+                }
+                if (compatible) {
+                    if (candidates->length == num_owners) {
+                        num_owners *= 2;
+                        owners = realloc(owners, sizeof(uint32_t) * num_owners);
+                        assert(owners != 0);
+                    }
+                    owners[candidates->length] = i;
+                    atlas_rdf_sparql_table_append(candidates, out);
+                }
+            }
+        }
+        
+        uint8_t * accept = malloc(candidates->length + 1);
+        assert(accept != 0);
+        if (program) {
+            atlas_rdf_sparql_program_eval(context, program, candidates, 0, candidates->length, accept);
+        } else {
+            memset(accept, 1, candidates->length);
+        }
+        
+        uint32_t k = 0;
+        for (uint32_t i=begin; i<end; i++) {
+            int matched = 0;
+            for (; k<candidates->length && owners[k] == i; k++) {
+                if (accept[k]) {
+                    atlas_rdf_sparql_table_row(candidates, k, out);
+                    atlas_rdf_sparql_table_append(output, out);
+                    matched = 1;
+                }
+            }
+            if (optional && !matched) {
+                atlas_rdf_sparql_table_row(left, i, row);
+                atlas_rdf_sparql_table_append(output, row);
+            }
+        }
+        
+        free(accept);
+        free(owners);
+        atlas_rdf_sparql_table_free(candidates);
+        free(row);
+        free(out);
+    });
+    
+    free(heads);
+    free(next);
+    free(keys);
+    atlas_rdf_sparql_table_free(left);
+    atlas_rdf_sparql_table_free(right);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Evaluate Graph Patterns
+
+static __sparql_table *
+atlas_rdf_sparql_group(__sparql_context * context, __sparql_pattern * group, int apply_filters);
+
+static __sparql_table *
+atlas_rdf_sparql_group_input(__sparql_context * context,
+                             __sparql_pattern * group,
+                             __sparql_table * table,
+                             int apply_filters) {
+    uint32_t num_columns = table->num_columns;
+    __sparql_constraint * constraints = atlas_rdf_sparql_constraints(context, group);
+    for (int i=0; i<group->num_elements; i++) {
+        __sparql_pattern * element = group->elements[i];
+        switch (element->kind) {
+            case ATLAS_RDF_SPARQL_TRIPLES:
+                table = atlas_rdf_sparql_bgp(context, element, constraints, table);
+                break;
+                
+            case ATLAS_RDF_SPARQL_GROUP:
+                table = atlas_rdf_sparql_join(context, table, atlas_rdf_sparql_group(context, element, 1), 0, 0);
+                break;
+                
+            case ATLAS_RDF_SPARQL_UNION:
+            {
+                __sparql_table * alternatives = atlas_rdf_sparql_table_create(num_columns, 16);
+                for (int k=0; k<element->num_elements; k++) {
+                    __sparql_table * alternative = atlas_rdf_sparql_group(context, element->elements[k], 1);
+                    atlas_rdf_sparql_table_concat(alternatives, alternative);
+                    atlas_rdf_sparql_table_free(alternative);
+                }
+                table = atlas_rdf_sparql_join(context, table, alternatives, 0, 0);
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OPTIONAL:
+            {
+                // the filters of the optional group are the
+                // condition of the join (s. LeftJoin)
+                __sparql_pattern * optional = element->elements[0];
+                __sparql_table * right = atlas_rdf_sparql_group(context, optional, 0);
+                table = atlas_rdf_sparql_join(context, table, right, optional->program, 1);
+                break;
+            }
+        }
+    }
+    atlas_rdf_sparql_constraints_free(constraints, context->query->num_variables);
+    if (apply_filters) {
+        table = atlas_rdf_sparql_filter(context, table, group->program);
+    }
+    return table;
+}
+
+static __sparql_table *
+atlas_rdf_sparql_group(__sparql_context * context, __sparql_pattern * group, int apply_filters) {
+    __sparql_table * unit = atlas_rdf_sparql_table_unit(context->query->num_variables);
+    return atlas_rdf_sparql_group_input(context, group, unit, apply_filters);
+}
+
+#pragma mark -
+#pragma mark Aggregates
+
+// the result of an aggregate over the solutions of a group (the
+// positions in the table) or UNBOUND, if it is not defined
+static uint32_t
+atlas_rdf_sparql_aggregate(__sparql_context * context,
+                           __sparql_table * table,
+                           __sparql_column * column,
+                           uint32_t * members,
+                           uint32_t num_members) {
+    
+    // the values of the argument (ignoring unbound and duplicate values)
+    uint32_t * values = malloc(sizeof(uint32_t) * (num_members + 1));
+    assert(values != 0);
+    uint32_t num_values = 0;
+    
+    __sparql_row_set set;
+    int32_t * keys = 0;
+    int num_keys = 0;
+    if (column->argument >= 0) {
+        keys = &column->argument;
+        num_keys = 1;
+    } else {
+        // COUNT(DISTINCT *) compares all variables
+        num_keys = table->num_columns;
+        keys = malloc(sizeof(int32_t) * (num_keys + 1));
+        assert(keys != 0);
+        for (int i=0; i<num_keys; i++) {
+            keys[i] = i;
+        }
+    }
+    atlas_rdf_sparql_row_set_init(&set, table, num_keys, keys);
+    for (uint32_t i=0; i<num_members; i++) {
+        uint32_t row = members[i];
+        uint32_t value = column->argument >= 0 ? table->columns[column->argument][row] : 0;
+        if (value == ATLAS_RDF_SPARQL_UNBOUND) {
+            continue;
+        }
+        if (column->distinct && atlas_rdf_sparql_row_set_insert(&set, row) != -1) {
+            continue;
+        }
+        values[num_values++] = value;
+    }
+    atlas_rdf_sparql_row_set_free(&set);
+    if (column->argument < 0) {
+        free(keys);
+    }
+    
+    uint32_t result = ATLAS_RDF_SPARQL_UNBOUND;
+    atlas_error_handler err = ^(int e, const char * msg){};
+    switch (column->aggregate) {
+        case ATLAS_RDF_SPARQL_AGGREGATE_COUNT:
+        {
+            mpz_t count;
+            mpz_init_set_ui(count, num_values);
+            result = atlas_rdf_sparql_created_id(context, atlas_rdf_term_create_integer(count, err));
+            mpz_clear(count);
+            break;
+        }
+            
+        case ATLAS_RDF_SPARQL_AGGREGATE_SUM:
+        {
+            // the sum of integers is an integer, else a double
+            mpz_t sum;
+            mpz_init(sum);
+            double dsum = 0;
+            int integer = 1;
+            int numeric = 1;
+            for (uint32_t i=0; i<num_values && numeric; i++) {
+                atlas_rdf_term_t term = atlas_rdf_sparql_term(context, values[i]);
+                if (atlas_rdf_term_type(term) == INTEGER_LITERAL) {
+                    mpz_t z;
+                    mpz_init(z);
+                    atlas_rdf_term_integer_value(term, z);
+                    mpz_add(sum, sum, z);
+                    dsum += mpz_get_d(z);
+                    mpz_clear(z);
+                } else if (atlas_rdf_term_type(term) == DECIMAL_LITERAL) {
+                    mpf_t f;
+                    mpf_init(f);
+                    atlas_rdf_term_decimal_value(term, f);
+                    dsum += mpf_get_d(f);
+                    mpf_clear(f);
+                    integer = 0;
+                } else if (atlas_rdf_term_type(term) == DOUBLE_LITERAL) {
+                    dsum += atlas_rdf_term_double_value(term);
+                    integer = 0;
+                } else {
+                    numeric = 0;
+                }
+            }
+            if (numeric) {
+                atlas_rdf_term_t term = integer ? atlas_rdf_term_create_integer(sum, err) :
+                                                  atlas_rdf_term_create_double(dsum, err);
+                result = atlas_rdf_sparql_created_id(context, term);
+            }
+            mpz_clear(sum);
+            break;
+        }
+            
+        case ATLAS_RDF_SPARQL_AGGREGATE_MIN:
+        case ATLAS_RDF_SPARQL_AGGREGATE_MAX:
+        {
+            int sign = column->aggregate == ATLAS_RDF_SPARQL_AGGREGATE_MIN ? 1 : -1;
+            for (uint32_t i=0; i<num_values; i++) {
+                if (result == ATLAS_RDF_SPARQL_UNBOUND ||
+                    (values[i] != result &&
+                     sign * atlas_rdf_term_order(atlas_rdf_sparql_term(context, values[i]),
+                                                 atlas_rdf_sparql_term(context, result)) < 0)) {
+                    result = values[i];
+                }
+            }
+            break;
+        }
+    }
+    
+    free(values);
+    return result;
+}
+
+// group the solutions by the values of the variables in GROUP BY,
+// the result contains a solution with the group variables and the
+// results of the aggregates for each group
+static __sparql_table *
+atlas_rdf_sparql_group_by(__sparql_context * context, __sparql_table * table) {
+    __sparql_query * query = context->query;
+    uint32_t num_columns = table->num_columns;
+    
+    // the group of each solution (in the order of their first solution)
+    uint32_t * group_of = malloc(sizeof(uint32_t) * (table->length + 1));
+    uint32_t * first = malloc(sizeof(uint32_t) * (table->length + 1));
+    assert(group_of != 0);
+    assert(first != 0);
+    uint32_t num_groups = 0;
+    
+    __sparql_row_set set;
+    atlas_rdf_sparql_row_set_init(&set, table, query->num_group, query->group);
+    for (uint32_t i=0; i<table->length; i++) {
+        int64_t other = atlas_rdf_sparql_row_set_insert(&set, i);
+        if (other == -1) {
+            first[num_groups] = i;
+            group_of[i] = num_groups++;
+        } else {
+            group_of[i] = group_of[other];
+        }
+    }
+    atlas_rdf_sparql_row_set_free(&set);
+    
+    // without GROUP BY, all solutions (maybe none) are one group
+    if (query->num_group == 0 && num_groups == 0) {
+        num_groups = 1;
+        first[0] = UINT32_MAX;
+    }
+    
+    // the solutions of each group
+    uint32_t * offsets = calloc(num_groups + 1, sizeof(uint32_t));
+    uint32_t * members = malloc(sizeof(uint32_t) * (table->length + 1));
+    assert(offsets != 0);
+    assert(members != 0);
+    for (uint32_t i=0; i<table->length; i++) {
+        offsets[group_of[i] + 1]++;
+    }
+    for (uint32_t g=0; g<num_groups; g++) {
+        offsets[g + 1] += offsets[g];
+    }
+    uint32_t * fill = malloc(sizeof(uint32_t) * (num_groups + 1));
+    assert(fill != 0);
+    memcpy(fill, offsets, sizeof(uint32_t) * num_groups);
+    for (uint32_t i=0; i<table->length; i++) {
+        members[fill[group_of[i]]++] = i;
+    }
+    free(fill);
+    
+    __sparql_table * result = atlas_rdf_sparql_table_create(num_columns, num_groups);
+    uint32_t * row = malloc(sizeof(uint32_t) * (num_columns + 1));
+    assert(row != 0);
+    for (uint32_t g=0; g<num_groups; g++) {
+        for (uint32_t c=0; c<num_columns; c++) {
+            row[c] = ATLAS_RDF_SPARQL_UNBOUND;
+        }
+        for (int k=0; k<query->num_group; k++) {
+            row[query->group[k]] = table->columns[query->group[k]][first[g]];
+        }
+        for (int k=0; k<query->num_columns; k++) {
+            __sparql_column * column = &query->columns[k];
+            if (column->aggregate != ATLAS_RDF_SPARQL_AGGREGATE_NONE) {
+                row[column->variable] = atlas_rdf_sparql_aggregate(context, table, column,
+                                                                   members + offsets[g],
+                                                                   offsets[g + 1] - offsets[g]);
+            }
+        }
+        atlas_rdf_sparql_table_append(result, row);
+    }
+    
+    free(row);
+    free(offsets);
+    free(members);
+    free(first);
+    free(group_of);
+    atlas_rdf_sparql_table_free(table);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Order Solutions
+
+static int
+atlas_rdf_sparql_order_cmp(__sparql_context * context, __sparql_table * table, uint32_t row1, uint32_t row2) {
+    __sparql_query * query = context->query;
+    for (int i=0; i<query->num_order; i++) {
+        uint32_t * column = table->columns[query->order[i].variable];
+        uint32_t id1 = column[row1];
+        uint32_t id2 = column[row2];
+        if (id1 == id2) {
+            continue;
+        }
+        
+        // unbound values are ordered first
+        int cmp;
+        if (id1 == ATLAS_RDF_SPARQL_UNBOUND) {
+            cmp = -1;
+        } else if (id2 == ATLAS_RDF_SPARQL_UNBOUND) {
+            cmp = 1;
+        } else {
+            cmp = atlas_rdf_term_order(atlas_rdf_sparql_term(context, id1),
+                                       atlas_rdf_sparql_term(context, id2));
+        }
+        if (cmp != 0) {
+            return query->order[i].descending ? -cmp : cmp;
+        }
+    }
+    return 0;
+}
+
+// the positions of the solutions in the order of ORDER BY (stable)
+static uint32_t *
+atlas_rdf_sparql_order(__sparql_context * context, __sparql_table * table) {
+    uint32_t length = table->length;
+    uint32_t * order = malloc(sizeof(uint32_t) * (length + 1));
+    uint32_t * buffer = malloc(sizeof(uint32_t) * (length + 1));
+    assert(order != 0);
+    assert(buffer != 0);
+    for (uint32_t i=0; i<length; i++) {
+        order[i] = i;
+    }
+    
+    // bottom-up merge sort
+    for (uint32_t width=1; width<length && context->query->num_order > 0; width*=2) {
+        for (uint32_t begin=0; begin<length; begin+=2*width) {
+            uint32_t mid = begin + width < length ? begin + width : length;
+            uint32_t end = begin + 2 * width < length ? begin + 2 * width : length;
+            uint32_t i = begin, j = mid, k = begin;
+            while (i < mid && j < end) {
+                if (atlas_rdf_sparql_order_cmp(context, table, order[j], order[i]) < 0) {
+                    buffer[k++] = order[j++];
+                } else {
+                    buffer[k++] = order[i++];
+                }
+            }
+            while (i < mid) buffer[k++] = order[i++];
+            while (j < end) buffer[k++] = order[j++];
+        }
+        uint32_t * tmp = order;
+        order = buffer;
+        buffer = tmp;
+    }
+    
+    free(buffer);
+    return order;
+}
+
+#pragma mark -
+#pragma mark Execute a SPARQL Query
+
+int
+atlas_rdf_query_execute(atlas_rdf_query_t query,
+                        atlas_rdf_graph_t graph,
+                        void(^iterator)(atlas_rdf_term_t * values)) {
+    assert(query != 0);
+    assert(graph != 0);
+    
+    // the result of the same query on the same graph may be cached
+    __sparql_cache_entry * entry;
+    int cached = atlas_rdf_sparql_cache_lookup(query, graph, iterator, &entry);
+    if (cached >= 0) {
+        return cached;
+    }
+    
+    __sparql_context context;
+    memset(&context, 0, sizeof(__sparql_context));
+    context.query = atlas_rdf_sparql_query(query);
+    context.handle = query;
+    context.graph = graph;
+    context.adjacency = atlas_rdf_graph_adjacency(graph);
+    context.terms = atlas_rdf_term_dict_terms(context.adjacency->dict);
+    context.num_terms = atlas_rdf_term_dict_length(context.adjacency->dict);
+    context.num_edges = context.adjacency->outgoing.offsets[context.num_terms];
+    context.created_dict = atlas_rdf_term_dict_create(16);
+    
+    int num_constants = lz_obj_num_ref(query);
+    context.constants = malloc(sizeof(uint32_t) * (num_constants + 1));
+    assert(context.constants != 0);
+    for (int i=0; i<num_constants; i++) {
+        int id = atlas_rdf_term_dict_lookup(context.adjacency->dict, lz_obj_weak_ref(query, i));
+        context.constants[i] = id >= 0 ? (uint32_t)id : ATLAS_RDF_SPARQL_UNBOUND;
+    }
+    
+    __sparql_query * compiled = context.query;
+    __sparql_table * table = atlas_rdf_sparql_group(&context, compiled->where, 1);
+    if (compiled->grouped) {
+        table = atlas_rdf_sparql_group_by(&context, table);
+    }
+    uint32_t * order = atlas_rdf_sparql_order(&context, table);
+    
+    // project the solutions and remove duplicates
+    int32_t * projection = malloc(sizeof(int32_t) * (compiled->num_columns + 1));
+    atlas_rdf_term_t * values = malloc(sizeof(atlas_rdf_term_t) * (compiled->num_columns + 1));
+    assert(projection != 0);
+    assert(values != 0);
+    for (int i=0; i<compiled->num_columns; i++) {
+        projection[i] = compiled->columns[i].variable;
+    }
+    __sparql_row_set set;
+    atlas_rdf_sparql_row_set_init(&set, table, compiled->num_columns, projection);
+    
+    int64_t skipped = 0;
+    int count = 0;
+    for (uint32_t i=0; i<table->length; i++) {
+        if (compiled->limit >= 0 && count >= compiled->limit) {
+            break;
+        }
+        uint32_t row = order[i];
+        if (compiled->distinct && atlas_rdf_sparql_row_set_insert(&set, row) != -1) {
+            continue;
+        }
+        if (skipped < compiled->offset) {
+            skipped++;
+            continue;
+        }
+        if (iterator || entry) {
+            for (int c=0; c<compiled->num_columns; c++) {
+                values[c] = atlas_rdf_sparql_term(&context, table->columns[projection[c]][row]);
+            }
+            if (entry) {
+                atlas_rdf_sparql_cache_append(entry, values);
+            }
+            if (iterator) {
+                iterator(values);
+            }
+        }
+        count++;
+    }
+    if (entry) {
+        atlas_rdf_sparql_cache_insert(entry);
+    }
+    
+    atlas_rdf_sparql_row_set_free(&set);
+    free(projection);
+    free(values);
+    free(order);
+    atlas_rdf_sparql_table_free(table);
+    
+    for (int i=0; i<context.num_created; i++) {
+        lz_release(context.created[i]);
+    }
+    free(context.created);
+    atlas_rdf_term_dict_free(context.created_dict);
+    free(context.constants);
+    
+    return count;
+}
@@ -0,0 +1,915 @@
+/*
+ *  atlas_rdf_sparql_impl_filter.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_sparql_impl.h"
+#include "atlas_rdf_term_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <regex.h>
+#include <math.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// kinds of values, the numeric kinds are
+// ordered by the type promotion
+#define ATLAS_RDF_SPARQL_VALUE_ERROR     0
+#define ATLAS_RDF_SPARQL_VALUE_BOOLEAN   1
+#define ATLAS_RDF_SPARQL_VALUE_INTEGER   2
+#define ATLAS_RDF_SPARQL_VALUE_DECIMAL   3
+#define ATLAS_RDF_SPARQL_VALUE_DOUBLE    4
+#define ATLAS_RDF_SPARQL_VALUE_DATETIME  5
+#define ATLAS_RDF_SPARQL_VALUE_STRING    6
+#define ATLAS_RDF_SPARQL_VALUE_TERM      7
+
+#define ATLAS_RDF_SPARQL_IS_NUMERIC(kind) ((kind) >= ATLAS_RDF_SPARQL_VALUE_INTEGER && \
+                                           (kind) <= ATLAS_RDF_SPARQL_VALUE_DOUBLE)
+
+// the value of an expression: literals of the graph are decoded (the term
+// is kept), computed values (e.g., the result of an arithmetic operation)
+// have no term; the kind STRING is a computed simple literal and all other
+// terms (IRIs, blank nodes, strings and other literals) are of kind TERM
+typedef struct {
+    uint8_t kind;
+    uint8_t owned; // the string has to be freed
+    uint32_t id;   // the id of the term or UNBOUND
+    union {
+        int64_t integer; // INTEGER, DATETIME and BOOLEAN
+        double number;   // DECIMAL and DOUBLE
+        char * string;   // STRING
+    } v;
+    atlas_rdf_term_t term;
+} __sparql_value;
+
+// instructions of a program
+#define ATLAS_RDF_SPARQL_OP_VARIABLE        0  // push the value of a variable
+#define ATLAS_RDF_SPARQL_OP_CONSTANT        1  // push a constant
+#define ATLAS_RDF_SPARQL_OP_BOUND           2  // push if a variable is bound
+#define ATLAS_RDF_SPARQL_OP_COMPARE_ID      3  // push ?x = c or ?x != c (by id, c is not a scalar)
+#define ATLAS_RDF_SPARQL_OP_COMPARE_SCALAR  4  // push ?x < c, ... (numeric, datetime or boolean)
+#define ATLAS_RDF_SPARQL_OP_COMPARE         5  // replace the top values by their comparison
+#define ATLAS_RDF_SPARQL_OP_ARITHMETIC      6  // replace the top values by their sum, ...
+#define ATLAS_RDF_SPARQL_OP_AND             7
+#define ATLAS_RDF_SPARQL_OP_OR              8
+#define ATLAS_RDF_SPARQL_OP_NOT             9
+#define ATLAS_RDF_SPARQL_OP_NEG             10
+#define ATLAS_RDF_SPARQL_OP_IS              11 // replace the top value by isIRI(...), ...
+#define ATLAS_RDF_SPARQL_OP_REGEX           12
+#define ATLAS_RDF_SPARQL_OP_LANG            13
+#define ATLAS_RDF_SPARQL_OP_ACCEPT          14 // pop the result of a filter
+
+typedef struct {
+    uint8_t op;
+    uint8_t operator; // operator of the expression (EQ, ADD, IS_IRI, ...)
+    int32_t variable;
+    int32_t constant; // index of the constant or the regular expression
+    __sparql_value value; // the decoded constant
+} __sparql_instruction;
+
+struct __sparql_program_s {
+    int num_instructions;
+    __sparql_instruction * instructions;
+    
+    // the maximal number of values on the stack
+    int depth;
+    
+    int num_regex;
+    regex_t * regex;
+};
+
+static const char * atlas_rdf_sparql_empty = "";
+
+#pragma mark -
+#pragma mark Values
+
+static inline void
+atlas_rdf_sparql_value_error(__sparql_value * value) {
+    value->kind = ATLAS_RDF_SPARQL_VALUE_ERROR;
+    value->owned = 0;
+    value->id = ATLAS_RDF_SPARQL_UNBOUND;
+    value->term = 0;
+}
+
+static inline void
+atlas_rdf_sparql_value_boolean(__sparql_value * value, int b) {
+    value->kind = ATLAS_RDF_SPARQL_VALUE_BOOLEAN;
+    value->owned = 0;
+    value->id = ATLAS_RDF_SPARQL_UNBOUND;
+    value->v.integer = b != 0;
+    value->term = 0;
+}
+
+static inline void
+atlas_rdf_sparql_value_clear(__sparql_value * value) {
+    if (value->owned) {
+        free(value->v.string);
+        value->owned = 0;
+    }
+}
+
+static void
+atlas_rdf_sparql_value_decode(__sparql_value * value, atlas_rdf_term_t term, uint32_t id) {
+    int64_t integer = 0;
+    double number = 0;
+    value->owned = 0;
+    value->id = id;
+    value->term = term;
+    switch (atlas_rdf_term_scalar(term, &integer, &number)) {
+        case BOOLEAN_LITERAL:
+            value->kind = ATLAS_RDF_SPARQL_VALUE_BOOLEAN;
+            value->v.integer = integer;
+            break;
+        case INTEGER_LITERAL:
+            value->kind = ATLAS_RDF_SPARQL_VALUE_INTEGER;
+            value->v.integer = integer;
+            break;
+        case DECIMAL_LITERAL:
+            value->kind = ATLAS_RDF_SPARQL_VALUE_DECIMAL;
+            value->v.number = number;
+            break;
+        case DOUBLE_LITERAL:
+            value->kind = ATLAS_RDF_SPARQL_VALUE_DOUBLE;
+            value->v.number = number;
+            break;
+        case DATETIME_LITERAL:
+            value->kind = ATLAS_RDF_SPARQL_VALUE_DATETIME;
+            value->v.integer = integer;
+            break;
+        default:
+            value->kind = ATLAS_RDF_SPARQL_VALUE_TERM;
+            break;
+    }
+}
+
+static inline double
+atlas_rdf_sparql_value_number(__sparql_value * value) {
+    return value->kind == ATLAS_RDF_SPARQL_VALUE_INTEGER ? (double)value->v.integer : value->v.number;
+}
+
+// effective boolean value: 1, 0 or -1 for an error
+static int
+atlas_rdf_sparql_value_ebv(__sparql_value * value) {
+    switch (value->kind) {
+        case ATLAS_RDF_SPARQL_VALUE_BOOLEAN:
+        case ATLAS_RDF_SPARQL_VALUE_INTEGER:
+            return value->v.integer != 0;
+        case ATLAS_RDF_SPARQL_VALUE_DECIMAL:
+        case ATLAS_RDF_SPARQL_VALUE_DOUBLE:
+            return value->v.number != 0 && !isnan(value->v.number);
+        case ATLAS_RDF_SPARQL_VALUE_STRING:
+            return value->v.string[0] != 0;
+        case ATLAS_RDF_SPARQL_VALUE_TERM:
+            return atlas_rdf_term_ebv(value->term);
+        default:
+            return -1;
+    }
+}
+
+// lexical value and language of a string literal,
+// the caller has to free the results
+static int
+atlas_rdf_sparql_value_string(__sparql_value * value, char ** lexical, char ** lang) {
+    if (value->kind == ATLAS_RDF_SPARQL_VALUE_STRING) {
+        *lexical = strdup(value->v.string);
+        *lang = strdup("");
+        return 1;
+    }
+    if (value->kind == ATLAS_RDF_SPARQL_VALUE_TERM && atlas_rdf_term_type(value->term) == STRING_LITERAL) {
+        *lexical = atlas_rdf_term_literal_value(value->term);
+        *lang = atlas_rdf_term_string_lang(value->term);
+        return 1;
+    }
+    return 0;
+}
+
+#pragma mark -
+#pragma mark Compare Values
+
+static inline int
+atlas_rdf_sparql_apply_order(uint8_t operator, int cmp) {
+    switch (operator) {
+        case ATLAS_RDF_SPARQL_EXPR_EQ: return cmp == 0;
+        case ATLAS_RDF_SPARQL_EXPR_NE: return cmp != 0;
+        case ATLAS_RDF_SPARQL_EXPR_LT: return cmp < 0;
+        case ATLAS_RDF_SPARQL_EXPR_GT: return cmp > 0;
+        case ATLAS_RDF_SPARQL_EXPR_LE: return cmp <= 0;
+        default:                       return cmp >= 0;
+    }
+}
+
+// doubles are compared directly, because NaN is not ordered
+static inline int
+atlas_rdf_sparql_apply_double(uint8_t operator, double x, double y) {
+    switch (operator) {
+        case ATLAS_RDF_SPARQL_EXPR_EQ: return x == y;
+        case ATLAS_RDF_SPARQL_EXPR_NE: return x != y;
+        case ATLAS_RDF_SPARQL_EXPR_LT: return x < y;
+        case ATLAS_RDF_SPARQL_EXPR_GT: return x > y;
+        case ATLAS_RDF_SPARQL_EXPR_LE: return x <= y;
+        default:                       return x >= y;
+    }
+}
+
+static inline int
+atlas_rdf_sparql_apply_integer(uint8_t operator, int64_t x, int64_t y) {
+    return atlas_rdf_sparql_apply_order(operator, x < y ? -1 : (x > y ? 1 : 0));
+}
+
+// compare two values and store the result in the first
+static void
+atlas_rdf_sparql_compare(uint8_t operator, __sparql_value * a, __sparql_value * b) {
+    int equality = operator == ATLAS_RDF_SPARQL_EXPR_EQ || operator == ATLAS_RDF_SPARQL_EXPR_NE;
+    int result = -1;
+    
+    if (a->kind == ATLAS_RDF_SPARQL_VALUE_ERROR || b->kind == ATLAS_RDF_SPARQL_VALUE_ERROR) {
+        result = -1;
+    } else if (a->id != ATLAS_RDF_SPARQL_UNBOUND && a->id == b->id) {
+        // equal ids are equal terms
+        result = atlas_rdf_sparql_apply_order(operator, 0);
+    } else if (ATLAS_RDF_SPARQL_IS_NUMERIC(a->kind) && ATLAS_RDF_SPARQL_IS_NUMERIC(b->kind)) {
+        if (a->kind == ATLAS_RDF_SPARQL_VALUE_INTEGER && b->kind == ATLAS_RDF_SPARQL_VALUE_INTEGER) {
+            result = atlas_rdf_sparql_apply_integer(operator, a->v.integer, b->v.integer);
+        } else {
+            result = atlas_rdf_sparql_apply_double(operator,
+                                                   atlas_rdf_sparql_value_number(a),
+                                                   atlas_rdf_sparql_value_number(b));
+        }
+    } else if (a->kind == b->kind && (a->kind == ATLAS_RDF_SPARQL_VALUE_DATETIME ||
+                                      a->kind == ATLAS_RDF_SPARQL_VALUE_BOOLEAN)) {
+        result = atlas_rdf_sparql_apply_integer(operator, a->v.integer, b->v.integer);
+    } else if (a->kind == ATLAS_RDF_SPARQL_VALUE_TERM && b->kind == ATLAS_RDF_SPARQL_VALUE_TERM) {
+        atlas_rdf_term_type_t type = atlas_rdf_term_type(a->term);
+        if (equality) {
+            int eq = (a->id == ATLAS_RDF_SPARQL_UNBOUND || b->id == ATLAS_RDF_SPARQL_UNBOUND) ?
+                     atlas_rdf_term_eq(a->term, b->term) : 0;
+            result = atlas_rdf_sparql_apply_order(operator, eq ? 0 : 1);
+        } else if (type == STRING_LITERAL && atlas_rdf_term_type(b->term) == STRING_LITERAL) {
+            result = atlas_rdf_sparql_apply_order(operator, atlas_rdf_term_order(a->term, b->term));
+        }
+    } else {
+        // computed strings are compared by their lexical value and language
+        char * lexical1, * lang1, * lexical2, * lang2;
+        if (atlas_rdf_sparql_value_string(a, &lexical1, &lang1)) {
+            if (atlas_rdf_sparql_value_string(b, &lexical2, &lang2)) {
+                int cmp = strcmp(lexical1, lexical2);
+                cmp = cmp != 0 ? cmp : strcmp(lang1, lang2);
+                result = atlas_rdf_sparql_apply_order(operator, cmp);
+                free(lexical2);
+                free(lang2);
+            } else if (equality) {
+                result = operator == ATLAS_RDF_SPARQL_EXPR_NE;
+            }
+            free(lexical1);
+            free(lang1);
+        } else if (equality) {
+            // different kinds of terms are not equal
+            result = operator == ATLAS_RDF_SPARQL_EXPR_NE;
+        }
+    }
+    
+    atlas_rdf_sparql_value_clear(a);
+    atlas_rdf_sparql_value_clear(b);
+    if (result == -1) {
+        atlas_rdf_sparql_value_error(a);
+    } else {
+        atlas_rdf_sparql_value_boolean(a, result);
+    }
+}
+
+#pragma mark -
+#pragma mark Arithmetic
+
+// apply an arithmetic operator with type promotion (integer, decimal,
+// double) and store the result in the first value; the quotient of
+// integers is a decimal, integers which overflow become decimals
+static void
+atlas_rdf_sparql_arithmetic(uint8_t operator, __sparql_value * a, __sparql_value * b) {
+    if (!ATLAS_RDF_SPARQL_IS_NUMERIC(a->kind) || !ATLAS_RDF_SPARQL_IS_NUMERIC(b->kind)) {
+        atlas_rdf_sparql_value_clear(a);
+        atlas_rdf_sparql_value_clear(b);
+        atlas_rdf_sparql_value_error(a);
+        return;
+    }
+    
+    uint8_t kind = a->kind > b->kind ? a->kind : b->kind;
+    if (kind == ATLAS_RDF_SPARQL_VALUE_INTEGER) {
+        int64_t x = a->v.integer;
+        int64_t y = b->v.integer;
+        int overflow = 0;
+        int64_t r = 0;
+        switch (operator) {
+            case ATLAS_RDF_SPARQL_EXPR_ADD:
+                overflow = (y > 0 && x > INT64_MAX - y) || (y < 0 && x < INT64_MIN - y);
+                r = overflow ? 0 : x + y;
+                break;
+            case ATLAS_RDF_SPARQL_EXPR_SUB:
+                overflow = (y < 0 && x > INT64_MAX + y) || (y > 0 && x < INT64_MIN + y);
+                r = overflow ? 0 : x - y;
+                break;
+            case ATLAS_RDF_SPARQL_EXPR_MUL:
+                overflow = fabs((double)x * (double)y) >= 9.0e18;
+                r = overflow ? 0 : x * y;
+                break;
+            default:
+                overflow = 1;
+                break;
+        }
+        if (!overflow) {
+            a->v.integer = r;
+            a->id = ATLAS_RDF_SPARQL_UNBOUND;
+            a->term = 0;
+            return;
+        }
+        kind = ATLAS_RDF_SPARQL_VALUE_DECIMAL;
+    }
+    
+    double x = atlas_rdf_sparql_value_number(a);
+    double y = atlas_rdf_sparql_value_number(b);
+    double r;
+    switch (operator) {
+        case ATLAS_RDF_SPARQL_EXPR_ADD: r = x + y; break;
+        case ATLAS_RDF_SPARQL_EXPR_SUB: r = x - y; break;
+        case ATLAS_RDF_SPARQL_EXPR_MUL: r = x * y; break;
+        default:
+            // only doubles can be divided by zero
+            if (y == 0 && kind != ATLAS_RDF_SPARQL_VALUE_DOUBLE) {
+                atlas_rdf_sparql_value_error(a);
+                return;
+            }
+            r = x / y;
+            break;
+    }
+    a->kind = kind;
+    a->v.number = r;
+    a->id = ATLAS_RDF_SPARQL_UNBOUND;
+    a->term = 0;
+}
+
+#pragma mark -
+#pragma mark Compile a Program
+
+static void
+atlas_rdf_sparql_program_add(__sparql_program * program, __sparql_instruction instruction) {
+    program->instructions = realloc(program->instructions, sizeof(__sparql_instruction) * (program->num_instructions + 1));
+    assert(program->instructions != 0);
+    program->instructions[program->num_instructions++] = instruction;
+}
+
+static uint8_t
+atlas_rdf_sparql_flip(uint32_t operator) {
+    switch (operator) {
+        case ATLAS_RDF_SPARQL_EXPR_LT: return ATLAS_RDF_SPARQL_EXPR_GT;
+        case ATLAS_RDF_SPARQL_EXPR_GT: return ATLAS_RDF_SPARQL_EXPR_LT;
+        case ATLAS_RDF_SPARQL_EXPR_LE: return ATLAS_RDF_SPARQL_EXPR_GE;
+        case ATLAS_RDF_SPARQL_EXPR_GE: return ATLAS_RDF_SPARQL_EXPR_LE;
+        default:                       return operator;
+    }
+}
+
+// compile an expression, which pushes one value on the stack
+static int
+atlas_rdf_sparql_program_compile(__sparql_program * program,
+                                 __sparql_expr * expr,
+                                 atlas_rdf_term_t * constants,
+                                 int depth,
+                                 const char ** error) {
+    __sparql_instruction instruction;
+    memset(&instruction, 0, sizeof(__sparql_instruction));
+    instruction.variable = -1;
+    instruction.constant = -1;
+    instruction.operator = expr->op;
+    
+    if (depth + 1 > program->depth) {
+        program->depth = depth + 1;
+    }
+    
+    switch (expr->op) {
+        case ATLAS_RDF_SPARQL_EXPR_VARIABLE:
+            instruction.op = ATLAS_RDF_SPARQL_OP_VARIABLE;
+            instruction.variable = expr->index;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_CONSTANT:
+            instruction.op = ATLAS_RDF_SPARQL_OP_CONSTANT;
+            instruction.constant = expr->index;
+            atlas_rdf_sparql_value_decode(&instruction.value, constants[expr->index], ATLAS_RDF_SPARQL_UNBOUND);
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_BOUND:
+            instruction.op = ATLAS_RDF_SPARQL_OP_BOUND;
+            instruction.variable = expr->args[0]->index;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_EQ:
+        case ATLAS_RDF_SPARQL_EXPR_NE:
+        case ATLAS_RDF_SPARQL_EXPR_LT:
+        case ATLAS_RDF_SPARQL_EXPR_GT:
+        case ATLAS_RDF_SPARQL_EXPR_LE:
+        case ATLAS_RDF_SPARQL_EXPR_GE:
+        {
+            // a variable is compared with a constant without the term of
+            // the variable (=, !=) or only with its numeric, datetime or
+            // boolean value; numeric values of other types can be equal,
+            // so the ids are only compared for the other constants
+            __sparql_expr * variable = expr->args[0];
+            __sparql_expr * constant = expr->args[1];
+            if (variable->op == ATLAS_RDF_SPARQL_EXPR_CONSTANT) {
+                variable = expr->args[1];
+                constant = expr->args[0];
+                instruction.operator = atlas_rdf_sparql_flip(expr->op);
+            }
+            if (variable->op == ATLAS_RDF_SPARQL_EXPR_VARIABLE && constant->op == ATLAS_RDF_SPARQL_EXPR_CONSTANT) {
+                instruction.variable = variable->index;
+                instruction.constant = constant->index;
+                atlas_rdf_sparql_value_decode(&instruction.value, constants[constant->index], ATLAS_RDF_SPARQL_UNBOUND);
+                int equality = expr->op == ATLAS_RDF_SPARQL_EXPR_EQ || expr->op == ATLAS_RDF_SPARQL_EXPR_NE;
+                int scalar = ATLAS_RDF_SPARQL_IS_NUMERIC(instruction.value.kind) ||
+                             instruction.value.kind == ATLAS_RDF_SPARQL_VALUE_DATETIME;
+                if (scalar || (equality && instruction.value.kind == ATLAS_RDF_SPARQL_VALUE_BOOLEAN)) {
+                    instruction.op = ATLAS_RDF_SPARQL_OP_COMPARE_SCALAR;
+                    break;
+                }
+                if (equality) {
+                    instruction.op = ATLAS_RDF_SPARQL_OP_COMPARE_ID;
+                    break;
+                }
+                instruction.variable = -1;
+                instruction.constant = -1;
+            }
+            instruction.op = ATLAS_RDF_SPARQL_OP_COMPARE;
+            instruction.operator = expr->op;
+            break;
+        }
+            
+        case ATLAS_RDF_SPARQL_EXPR_ADD:
+        case ATLAS_RDF_SPARQL_EXPR_SUB:
+        case ATLAS_RDF_SPARQL_EXPR_MUL:
+        case ATLAS_RDF_SPARQL_EXPR_DIV:
+            instruction.op = ATLAS_RDF_SPARQL_OP_ARITHMETIC;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_AND:
+            instruction.op = ATLAS_RDF_SPARQL_OP_AND;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_OR:
+            instruction.op = ATLAS_RDF_SPARQL_OP_OR;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_NOT:
+            instruction.op = ATLAS_RDF_SPARQL_OP_NOT;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_NEG:
+            instruction.op = ATLAS_RDF_SPARQL_OP_NEG;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_IS_IRI:
+        case ATLAS_RDF_SPARQL_EXPR_IS_BLANK:
+        case ATLAS_RDF_SPARQL_EXPR_IS_LITERAL:
+            instruction.op = ATLAS_RDF_SPARQL_OP_IS;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_LANG:
+            instruction.op = ATLAS_RDF_SPARQL_OP_LANG;
+            break;
+            
+        case ATLAS_RDF_SPARQL_EXPR_REGEX:
+        {
+            char * pattern = atlas_rdf_term_literal_value(constants[expr->args[1]->index]);
+            int flags = REG_EXTENDED | REG_NOSUB;
+            if (expr->index & ATLAS_RDF_SPARQL_REGEX_ICASE) {
+                flags |= REG_ICASE;
+            }
+            program->regex = realloc(program->regex, sizeof(regex_t) * (program->num_regex + 1));
+            assert(program->regex != 0);
+            int status = regcomp(&program->regex[program->num_regex], pattern, flags);
+            free(pattern);
+            if (status != 0) {
+                *error = "Invalid regular expression in REGEX.";
+                return 0;
+            }
+            instruction.op = ATLAS_RDF_SPARQL_OP_REGEX;
+            instruction.constant = program->num_regex++;
+            
+            // only the text is evaluated
+            if (!atlas_rdf_sparql_program_compile(program, expr->args[0], constants, depth, error)) {
+                return 0;
+            }
+            atlas_rdf_sparql_program_add(program, instruction);
+            return 1;
+        }
+            
+        default:
+            *error = "Unsupported expression.";
+            return 0;
+    }
+    
+    // the operands are evaluated first (except for the fused comparisons)
+    if (instruction.op != ATLAS_RDF_SPARQL_OP_COMPARE_ID && instruction.op != ATLAS_RDF_SPARQL_OP_COMPARE_SCALAR) {
+        for (int i=0; i<2 && expr->op != ATLAS_RDF_SPARQL_EXPR_BOUND; i++) {
+            if (expr->args[i] && !atlas_rdf_sparql_program_compile(program, expr->args[i], constants, depth + i, error)) {
+                return 0;
+            }
+        }
+    }
+    atlas_rdf_sparql_program_add(program, instruction);
+    return 1;
+}
+
+__sparql_program *
+atlas_rdf_sparql_program_create(int num_filters,
+                                __sparql_expr ** filters,
+                                atlas_rdf_term_t * constants,
+                                const char ** error) {
+    __sparql_program * program = calloc(1, sizeof(__sparql_program));
+    assert(program != 0);
+    
+    __sparql_instruction accept;
+    memset(&accept, 0, sizeof(__sparql_instruction));
+    accept.op = ATLAS_RDF_SPARQL_OP_ACCEPT;
+    accept.variable = -1;
+    accept.constant = -1;
+    
+    for (int i=0; i<num_filters; i++) {
+        if (!atlas_rdf_sparql_program_compile(program, filters[i], constants, 0, error)) {
+            atlas_rdf_sparql_program_free(program);
+            return 0;
+        }
+        atlas_rdf_sparql_program_add(program, accept);
+    }
+    return program;
+}
+
+void
+atlas_rdf_sparql_program_free(__sparql_program * program) {
+    for (int i=0; i<program->num_regex; i++) {
+        regfree(&program->regex[i]);
+    }
+    free(program->regex);
+    free(program->instructions);
+    free(program);
+}
+
+#pragma mark -
+#pragma mark Evaluate a Program
+
+// the kind of all values of a slot or -1
+#define ATLAS_RDF_SPARQL_MIXED -1
+
+static void
+atlas_rdf_sparql_program_run(__sparql_context * context,
+                             __sparql_program * program,
+                             __sparql_table * table,
+                             uint32_t begin,
+                             uint32_t length,
+                             __sparql_value * stack,
+                             int * uniform,
+                             uint8_t * accept) {
+    int sp = 0;
+    for (int k=0; k<program->num_instructions; k++) {
+        __sparql_instruction * instruction = &program->instructions[k];
+        __sparql_value * top = stack + (sp - 1) * ATLAS_RDF_SPARQL_BATCH_SIZE;
+        __sparql_value * push = stack + sp * ATLAS_RDF_SPARQL_BATCH_SIZE;
+        uint32_t * column = instruction->variable >= 0 ? table->columns[instruction->variable] + begin : 0;
+        
+        switch (instruction->op) {
+            case ATLAS_RDF_SPARQL_OP_VARIABLE:
+            {
+                int kind = -2;
+                for (uint32_t i=0; i<length; i++) {
+                    if (column[i] == ATLAS_RDF_SPARQL_UNBOUND) {
+                        atlas_rdf_sparql_value_error(&push[i]);
+                    } else {
+                        atlas_rdf_sparql_value_decode(&push[i], atlas_rdf_sparql_term(context, column[i]), column[i]);
+                    }
+                    kind = kind == -2 || kind == push[i].kind ? push[i].kind : ATLAS_RDF_SPARQL_MIXED;
+                }
+                uniform[sp++] = kind;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_CONSTANT:
+            {
+                __sparql_value value = instruction->value;
+                value.id = context->constants[instruction->constant];
+                for (uint32_t i=0; i<length; i++) {
+                    push[i] = value;
+                }
+                uniform[sp++] = value.kind;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_BOUND:
+            {
+                for (uint32_t i=0; i<length; i++) {
+                    atlas_rdf_sparql_value_boolean(&push[i], column[i] != ATLAS_RDF_SPARQL_UNBOUND);
+                }
+                uniform[sp++] = ATLAS_RDF_SPARQL_VALUE_BOOLEAN;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_COMPARE_ID:
+            {
+                // equal terms have the same id; a constant, which is not
+                // in the graph, is not equal to any term of the graph
+                uint32_t id = context->constants[instruction->constant];
+                int ne = instruction->operator == ATLAS_RDF_SPARQL_EXPR_NE;
+                int kind = ATLAS_RDF_SPARQL_VALUE_BOOLEAN;
+                for (uint32_t i=0; i<length; i++) {
+                    if (column[i] == ATLAS_RDF_SPARQL_UNBOUND) {
+                        atlas_rdf_sparql_value_error(&push[i]);
+                        kind = ATLAS_RDF_SPARQL_MIXED;
+                    } else {
+                        atlas_rdf_sparql_value_boolean(&push[i], (column[i] == id) != ne);
+                    }
+                }
+                uniform[sp++] = kind;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_COMPARE_SCALAR:
+            {
+                // only the numeric, datetime or boolean value of the terms is
+                // read; for =, != terms of another kind are not equal
+                __sparql_value * c = &instruction->value;
+                int datetime = c->kind == ATLAS_RDF_SPARQL_VALUE_DATETIME;
+                int boolean = c->kind == ATLAS_RDF_SPARQL_VALUE_BOOLEAN;
+                int integer = c->kind == ATLAS_RDF_SPARQL_VALUE_INTEGER;
+                int numeric = !datetime && !boolean;
+                int equality = instruction->operator == ATLAS_RDF_SPARQL_EXPR_EQ ||
+                               instruction->operator == ATLAS_RDF_SPARQL_EXPR_NE;
+                double number = atlas_rdf_sparql_value_number(c);
+                for (uint32_t i=0; i<length; i++) {
+                    if (column[i] == ATLAS_RDF_SPARQL_UNBOUND) {
+                        atlas_rdf_sparql_value_error(&push[i]);
+                        continue;
+                    }
+                    int64_t x = 0;
+                    double y = 0;
+                    atlas_rdf_term_type_t type = atlas_rdf_term_scalar(atlas_rdf_sparql_term(context, column[i]), &x, &y);
+                    if ((datetime && type == DATETIME_LITERAL) || (boolean && type == BOOLEAN_LITERAL)) {
+                        atlas_rdf_sparql_value_boolean(&push[i], atlas_rdf_sparql_apply_integer(instruction->operator, x, c->v.integer));
+                    } else if (numeric && integer && type == INTEGER_LITERAL) {
+                        atlas_rdf_sparql_value_boolean(&push[i], atlas_rdf_sparql_apply_integer(instruction->operator, x, c->v.integer));
+                    } else if (numeric && (type == INTEGER_LITERAL || type == DECIMAL_LITERAL || type == DOUBLE_LITERAL)) {
+                        atlas_rdf_sparql_value_boolean(&push[i], atlas_rdf_sparql_apply_double(instruction->operator, y, number));
+                    } else if (equality) {
+                        atlas_rdf_sparql_value_boolean(&push[i], instruction->operator == ATLAS_RDF_SPARQL_EXPR_NE);
+                    } else {
+                        atlas_rdf_sparql_value_error(&push[i]);
+                    }
+                }
+                uniform[sp++] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_COMPARE:
+            {
+                __sparql_value * a = top - ATLAS_RDF_SPARQL_BATCH_SIZE;
+                __sparql_value * b = top;
+                int ka = uniform[sp - 2];
+                int kb = uniform[sp - 1];
+                uint8_t operator = instruction->operator;
+                if (ka == ATLAS_RDF_SPARQL_VALUE_DOUBLE && kb == ATLAS_RDF_SPARQL_VALUE_DOUBLE) {
+                    for (uint32_t i=0; i<length; i++) {
+                        atlas_rdf_sparql_value_boolean(&a[i], atlas_rdf_sparql_apply_double(operator, a[i].v.number, b[i].v.number));
+                    }
+                } else if ((ka == ATLAS_RDF_SPARQL_VALUE_DATETIME && kb == ATLAS_RDF_SPARQL_VALUE_DATETIME) ||
+                           (ka == ATLAS_RDF_SPARQL_VALUE_INTEGER && kb == ATLAS_RDF_SPARQL_VALUE_INTEGER)) {
+                    for (uint32_t i=0; i<length; i++) {
+                        atlas_rdf_sparql_value_boolean(&a[i], atlas_rdf_sparql_apply_integer(operator, a[i].v.integer, b[i].v.integer));
+                    }
+                } else {
+                    for (uint32_t i=0; i<length; i++) {
+                        atlas_rdf_sparql_compare(operator, &a[i], &b[i]);
+                    }
+                }
+                sp--;
+                uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_ARITHMETIC:
+            {
+                __sparql_value * a = top - ATLAS_RDF_SPARQL_BATCH_SIZE;
+                __sparql_value * b = top;
+                int ka = uniform[sp - 2];
+                int kb = uniform[sp - 1];
+                if (ka == ATLAS_RDF_SPARQL_VALUE_DOUBLE && kb == ATLAS_RDF_SPARQL_VALUE_DOUBLE) {
+                    for (uint32_t i=0; i<length; i++) {
+                        double x = a[i].v.number;
+                        double y = b[i].v.number;
+                        switch (instruction->operator) {
+                            case ATLAS_RDF_SPARQL_EXPR_ADD: a[i].v.number = x + y; break;
+                            case ATLAS_RDF_SPARQL_EXPR_SUB: a[i].v.number = x - y; break;
+                            case ATLAS_RDF_SPARQL_EXPR_MUL: a[i].v.number = x * y; break;
+                            default:                        a[i].v.number = x / y; break;
+                        }
+                        a[i].id = ATLAS_RDF_SPARQL_UNBOUND;
+                        a[i].term = 0;
+                    }
+                } else {
+                    int kind = -2;
+                    for (uint32_t i=0; i<length; i++) {
+                        atlas_rdf_sparql_arithmetic(instruction->operator, &a[i], &b[i]);
+                        kind = kind == -2 || kind == a[i].kind ? a[i].kind : ATLAS_RDF_SPARQL_MIXED;
+                    }
+                    ka = kind;
+                }
+                sp--;
+                uniform[sp - 1] = ka;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_AND:
+            case ATLAS_RDF_SPARQL_OP_OR:
+            {
+                // an error is ignored, if the other operand decides the result
+                __sparql_value * a = top - ATLAS_RDF_SPARQL_BATCH_SIZE;
+                __sparql_value * b = top;
+                int decisive = instruction->op == ATLAS_RDF_SPARQL_OP_OR ? 1 : 0;
+                for (uint32_t i=0; i<length; i++) {
+                    int b1 = atlas_rdf_sparql_value_ebv(&a[i]);
+                    int b2 = atlas_rdf_sparql_value_ebv(&b[i]);
+                    atlas_rdf_sparql_value_clear(&a[i]);
+                    atlas_rdf_sparql_value_clear(&b[i]);
+                    if (b1 == decisive || b2 == decisive) {
+                        atlas_rdf_sparql_value_boolean(&a[i], decisive);
+                    } else if (b1 == -1 || b2 == -1) {
+                        atlas_rdf_sparql_value_error(&a[i]);
+                    } else {
+                        atlas_rdf_sparql_value_boolean(&a[i], !decisive);
+                    }
+                }
+                sp--;
+                uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_NOT:
+            {
+                for (uint32_t i=0; i<length; i++) {
+                    int b = atlas_rdf_sparql_value_ebv(&top[i]);
+                    atlas_rdf_sparql_value_clear(&top[i]);
+                    if (b == -1) {
+                        atlas_rdf_sparql_value_error(&top[i]);
+                    } else {
+                        atlas_rdf_sparql_value_boolean(&top[i], !b);
+                    }
+                }
+                uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_NEG:
+            {
+                for (uint32_t i=0; i<length; i++) {
+                    if (top[i].kind == ATLAS_RDF_SPARQL_VALUE_INTEGER && top[i].v.integer != INT64_MIN) {
+                        top[i].v.integer = -top[i].v.integer;
+                    } else if (top[i].kind == ATLAS_RDF_SPARQL_VALUE_INTEGER) {
+                        top[i].kind = ATLAS_RDF_SPARQL_VALUE_DECIMAL;
+                        top[i].v.number = -(double)INT64_MIN;
+                    } else if (top[i].kind == ATLAS_RDF_SPARQL_VALUE_DECIMAL || top[i].kind == ATLAS_RDF_SPARQL_VALUE_DOUBLE) {
+                        top[i].v.number = -top[i].v.number;
+                    } else {
+                        atlas_rdf_sparql_value_clear(&top[i]);
+                        atlas_rdf_sparql_value_error(&top[i]);
+                        uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                        continue;
+                    }
+                    top[i].id = ATLAS_RDF_SPARQL_UNBOUND;
+                    top[i].term = 0;
+                }
+                if (uniform[sp - 1] == ATLAS_RDF_SPARQL_VALUE_INTEGER) {
+                    uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                }
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_IS:
+            {
+                for (uint32_t i=0; i<length; i++) {
+                    __sparql_value * value = &top[i];
+                    if (value->kind == ATLAS_RDF_SPARQL_VALUE_ERROR) {
+                        continue;
+                    }
+                    int result;
+                    if (instruction->operator == ATLAS_RDF_SPARQL_EXPR_IS_LITERAL) {
+                        // computed values are literals
+                        result = value->term == 0 || atlas_rdf_term_is_type(value->term, LITERAL);
+                    } else {
+                        atlas_rdf_term_type_t type = instruction->operator == ATLAS_RDF_SPARQL_EXPR_IS_IRI ? IRI : BLANK_NODE;
+                        result = value->term != 0 && atlas_rdf_term_is_type(value->term, type);
+                    }
+                    atlas_rdf_sparql_value_clear(value);
+                    atlas_rdf_sparql_value_boolean(value, result);
+                }
+                uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_REGEX:
+            {
+                regex_t * regex = &program->regex[instruction->constant];
+                for (uint32_t i=0; i<length; i++) {
+                    char * lexical, * lang;
+                    if (!atlas_rdf_sparql_value_string(&top[i], &lexical, &lang)) {
+                        atlas_rdf_sparql_value_clear(&top[i]);
+                        atlas_rdf_sparql_value_error(&top[i]);
+                        continue;
+                    }
+                    int match = regexec(regex, lexical, 0, 0, 0) == 0;
+                    free(lexical);
+                    free(lang);
+                    atlas_rdf_sparql_value_clear(&top[i]);
+                    atlas_rdf_sparql_value_boolean(&top[i], match);
+                }
+                uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_LANG:
+            {
+                // the language of a literal is a simple literal
+                for (uint32_t i=0; i<length; i++) {
+                    __sparql_value * value = &top[i];
+                    if (value->kind == ATLAS_RDF_SPARQL_VALUE_ERROR) {
+                        continue;
+                    }
+                    if (value->term != 0 && !atlas_rdf_term_is_type(value->term, LITERAL)) {
+                        atlas_rdf_sparql_value_error(value);
+                        continue;
+                    }
+                    char * lang = 0;
+                    if (value->term != 0 && atlas_rdf_term_type(value->term) == STRING_LITERAL) {
+                        lang = atlas_rdf_term_string_lang(value->term);
+                    }
+                    atlas_rdf_sparql_value_clear(value);
+                    value->kind = ATLAS_RDF_SPARQL_VALUE_STRING;
+                    value->id = ATLAS_RDF_SPARQL_UNBOUND;
+                    value->term = 0;
+                    value->owned = lang != 0;
+                    value->v.string = lang ? lang : (char *)atlas_rdf_sparql_empty;
+                }
+                uniform[sp - 1] = ATLAS_RDF_SPARQL_MIXED;
+                break;
+            }
+                
+            case ATLAS_RDF_SPARQL_OP_ACCEPT:
+            {
+                for (uint32_t i=0; i<length; i++) {
+                    if (atlas_rdf_sparql_value_ebv(&top[i]) != 1) {
+                        accept[i] = 0;
+                    }
+                    atlas_rdf_sparql_value_clear(&top[i]);
+                }
+                sp--;
+                break;
+            }
+        }
+    }
+}
+
+void
+atlas_rdf_sparql_program_eval(__sparql_context * context,
+                              __sparql_program * program,
+                              __sparql_table * table,
+                              uint32_t begin,
+                              uint32_t end,
+                              uint8_t * accept) {
+    __sparql_value * stack = malloc(sizeof(__sparql_value) * (program->depth * ATLAS_RDF_SPARQL_BATCH_SIZE + 1));
+    int * uniform = malloc(sizeof(int) * (program->depth + 1));
+    assert(stack != 0);
+    assert(uniform != 0);
+    
+    for (uint32_t first=begin; first<end; first+=ATLAS_RDF_SPARQL_BATCH_SIZE) {
+        uint32_t length = end - first < ATLAS_RDF_SPARQL_BATCH_SIZE ? end - first : ATLAS_RDF_SPARQL_BATCH_SIZE;
+        memset(accept + (first - begin), 1, length);
+        atlas_rdf_sparql_program_run(context, program, table, first, length, stack, uniform, accept + (first - begin));
+    }
+    
+    free(uniform);
+    free(stack);
+}
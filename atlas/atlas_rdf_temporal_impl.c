@@ -0,0 +1,408 @@
+/*
+ *  atlas_rdf_temporal_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_temporal_impl.h"
+#include "atlas_rdf_graph_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+// the data of a temporal graph starts with a header, which is followed
+// by the nodes of a centered interval tree, the statements and the
+// positions of the statements ordered by the end of their interval;
+// the references are the terms
+typedef struct {
+    uint32_t num_statements;
+    uint32_t num_nodes;
+} __temporal;
+
+// a node contains the statements [begin, end), which are valid at
+// its center; the statements of the left subtree end before or at the
+// center, those of the right subtree start after the center; the
+// statements of a node are ordered by the start of their interval,
+// the positions [begin, end) by the end (descending)
+typedef struct {
+    int64_t center;
+    uint32_t left;  // index + 1 or 0
+    uint32_t right; // index + 1 or 0
+    uint32_t begin;
+    uint32_t end;
+} __temporal_node;
+
+typedef struct {
+    uint32_t subject;
+    uint32_t predicate;
+    uint32_t object;
+    uint32_t reserved;
+    int64_t valid_from;
+    int64_t valid_to;
+} __temporal_statement;
+
+typedef struct {
+    __temporal * header;
+    __temporal_node * nodes;
+    __temporal_statement * statements;
+    uint32_t * by_end;
+} __temporal_layout;
+
+static void
+atlas_rdf_temporal_graph_layout(atlas_rdf_temporal_graph_t graph, __temporal_layout * layout) {
+    lz_obj_sync(graph, ^(void * data, uint32_t length){
+        __temporal * header = data;
+        layout->header = header;
+        layout->nodes = (__temporal_node *)(header + 1);
+        layout->statements = (__temporal_statement *)(layout->nodes + header->num_nodes);
+        layout->by_end = (uint32_t *)(layout->statements + header->num_statements);
+    });
+}
+
+#pragma mark -
+#pragma mark Create a Temporal RDF Graph
+
+static int
+atlas_rdf_temporal_statement_cmp(const void * a, const void * b) {
+    const __temporal_statement * s1 = a;
+    const __temporal_statement * s2 = b;
+    if (s1->valid_from != s2->valid_from) return s1->valid_from < s2->valid_from ? -1 : 1;
+    if (s1->valid_to != s2->valid_to) return s1->valid_to < s2->valid_to ? -1 : 1;
+    if (s1->subject != s2->subject) return s1->subject < s2->subject ? -1 : 1;
+    if (s1->predicate != s2->predicate) return s1->predicate < s2->predicate ? -1 : 1;
+    if (s1->object != s2->object) return s1->object < s2->object ? -1 : 1;
+    return 0;
+}
+
+typedef struct {
+    __temporal_node * nodes;
+    __temporal_statement * statements;
+    uint32_t * by_end;
+    uint32_t num_nodes;
+    uint32_t num_statements;
+} __temporal_build;
+
+// the end of the interval of a statement and its position
+typedef struct {
+    int64_t valid_to;
+    uint32_t position;
+} __temporal_end;
+
+static int
+atlas_rdf_temporal_end_cmp(const void * a, const void * b) {
+    const __temporal_end * e1 = a;
+    const __temporal_end * e2 = b;
+    if (e1->valid_to != e2->valid_to) return e1->valid_to > e2->valid_to ? -1 : 1;
+    return 0;
+}
+
+// build the subtree for the statements (ordered by the start of their
+// interval) and return the index of its root + 1 or 0 if it is empty
+static uint32_t
+atlas_rdf_temporal_build(__temporal_build * build,
+                         __temporal_statement * statements,
+                         uint32_t number_of_statements) {
+    if (number_of_statements == 0) {
+        return 0;
+    }
+    
+    // the start of the median interval is the center, the statement
+    // of the median is contained in the node, thus the tree is
+    // balanced and each subtree contains at most half of the statements
+    int64_t center = statements[number_of_statements / 2].valid_from;
+    
+    __temporal_statement * left = malloc(sizeof(__temporal_statement) * number_of_statements);
+    __temporal_statement * right = malloc(sizeof(__temporal_statement) * number_of_statements);
+    assert(left != 0);
+    assert(right != 0);
+    uint32_t num_left = 0;
+    uint32_t num_right = 0;
+    
+    uint32_t index = build->num_nodes++;
+    __temporal_node * node = &build->nodes[index];
+    node->center = center;
+    node->begin = build->num_statements;
+    for (uint32_t i=0; i<number_of_statements; i++) {
+        if (statements[i].valid_to <= center) {
+            left[num_left++] = statements[i];
+        } else if (statements[i].valid_from > center) {
+            right[num_right++] = statements[i];
+        } else {
+            build->statements[build->num_statements++] = statements[i];
+        }
+    }
+    node->end = build->num_statements;
+    
+    uint32_t num_contained = node->end - node->begin;
+    __temporal_end * ends = malloc(sizeof(__temporal_end) * num_contained);
+    assert(ends != 0);
+    for (uint32_t i=0; i<num_contained; i++) {
+        ends[i].valid_to = build->statements[node->begin + i].valid_to;
+        ends[i].position = node->begin + i;
+    }
+    qsort(ends, num_contained, sizeof(__temporal_end), atlas_rdf_temporal_end_cmp);
+    for (uint32_t i=0; i<num_contained; i++) {
+        build->by_end[node->begin + i] = ends[i].position;
+    }
+    free(ends);
+    
+    uint32_t l = atlas_rdf_temporal_build(build, left, num_left);
+    uint32_t r = atlas_rdf_temporal_build(build, right, num_right);
+    
+    // the array of nodes is not reallocated
+    build->nodes[index].left = l;
+    build->nodes[index].right = r;
+    
+    free(left);
+    free(right);
+    
+    return index + 1;
+}
+
+atlas_rdf_temporal_graph_t
+atlas_rdf_temporal_graph_create(int number_of_statements,
+                                atlas_rdf_temporal_statement_t * statements,
+                                atlas_error_handler err) {
+    assert(number_of_statements >= 0);
+    
+    for (int loop = 0; loop < number_of_statements; loop++) {
+        const char * msg = 0;
+        atlas_rdf_term_t term = 0;
+        if (!atlas_rdf_term_is_type(statements[loop].subject, RESOURCE)) {
+            msg = "Subject in statement %d is not a resource: %s";
+            term = statements[loop].subject;
+        } else if (!atlas_rdf_term_is_type(statements[loop].predicate, IRI)) {
+            msg = "Predicate in statement %d is not an iri: %s";
+            term = statements[loop].predicate;
+        }
+        if (msg) {
+            char * repr = atlas_rdf_term_repr(term);
+            char * buff;
+            asprintf(&buff, msg, loop, repr);
+            err(1, buff);
+            free(repr);
+            free(buff);
+            return 0;
+        }
+        if (statements[loop].valid_from >= statements[loop].valid_to) {
+            char * buff;
+            asprintf(&buff, "Interval of statement %d is empty.", loop);
+            err(1, buff);
+            free(buff);
+            return 0;
+        }
+    }
+    
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(number_of_statements);
+    __temporal_statement * sorted = malloc(sizeof(__temporal_statement) * (number_of_statements + 1));
+    assert(sorted != 0);
+    for (int i=0; i<number_of_statements; i++) {
+        sorted[i].subject = atlas_rdf_term_dict_insert(dict, statements[i].subject);
+        sorted[i].predicate = atlas_rdf_term_dict_insert(dict, statements[i].predicate);
+        sorted[i].object = atlas_rdf_term_dict_insert(dict, statements[i].object);
+        sorted[i].reserved = 0;
+        sorted[i].valid_from = statements[i].valid_from;
+        sorted[i].valid_to = statements[i].valid_to;
+    }
+    
+    // sort the statements by the start of their interval and remove duplicates
+    qsort(sorted, number_of_statements, sizeof(__temporal_statement), atlas_rdf_temporal_statement_cmp);
+    uint32_t num_statements = 0;
+    for (int i=0; i<number_of_statements; i++) {
+        if (num_statements == 0 || atlas_rdf_temporal_statement_cmp(&sorted[num_statements - 1], &sorted[i]) != 0) {
+            sorted[num_statements++] = sorted[i];
+        }
+    }
+    
+    // each node contains at least one statement
+    int size = sizeof(__temporal) +
+               sizeof(__temporal_node) * num_statements +
+               sizeof(__temporal_statement) * num_statements +
+               sizeof(uint32_t) * num_statements;
+    __temporal * header = malloc(size);
+    assert(header != 0);
+    
+    __temporal_build build;
+    build.nodes = (__temporal_node *)(header + 1);
+    build.statements = (__temporal_statement *)(build.nodes + num_statements);
+    build.by_end = malloc(sizeof(uint32_t) * (num_statements + 1));
+    assert(build.by_end != 0);
+    build.num_nodes = 0;
+    build.num_statements = 0;
+    atlas_rdf_temporal_build(&build, sorted, num_statements);
+    
+    // move the statements and positions behind the used nodes
+    header->num_statements = num_statements;
+    header->num_nodes = build.num_nodes;
+    __temporal_statement * moved = (__temporal_statement *)(build.nodes + build.num_nodes);
+    memmove(moved, build.statements, sizeof(__temporal_statement) * num_statements);
+    memcpy(moved + num_statements, build.by_end, sizeof(uint32_t) * num_statements);
+    size -= sizeof(__temporal_node) * (num_statements - build.num_nodes);
+    
+    atlas_rdf_temporal_graph_t result = lz_obj_new_v(header, size, ^{
+        free(header);
+    }, atlas_rdf_term_dict_length(dict), atlas_rdf_term_dict_terms(dict));
+    
+    free(build.by_end);
+    free(sorted);
+    atlas_rdf_term_dict_free(dict);
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Access Details of a Temporal RDF Graph
+
+int
+atlas_rdf_temporal_graph_length(atlas_rdf_temporal_graph_t graph) {
+    assert(graph != 0);
+    __temporal_layout layout;
+    atlas_rdf_temporal_graph_layout(graph, &layout);
+    return layout.header->num_statements;
+}
+
+#pragma mark -
+#pragma mark Query a Temporal RDF Graph
+
+// call the block with the position of each statement, which
+// is valid during [begin, end], in the subtree of the node
+static void
+atlas_rdf_temporal_query(__temporal_layout * layout,
+                         uint32_t node,
+                         int64_t begin,
+                         int64_t end,
+                         void(^block)(uint32_t position)) {
+    while (node != 0) {
+        __temporal_node * n = &layout->nodes[node - 1];
+        if (n->center < begin) {
+            // all statements of the node start before the end of the
+            // period, those of the left subtree end before its begin
+            for (uint32_t i=n->begin; i<n->end; i++) {
+                uint32_t position = layout->by_end[i];
+                if (layout->statements[position].valid_to <= begin) break;
+                block(position);
+            }
+            node = n->right;
+        } else if (n->center > end) {
+            // all statements of the node end after the end of the
+            // period, those of the right subtree start after its end
+            for (uint32_t i=n->begin; i<n->end; i++) {
+                if (layout->statements[i].valid_from > end) break;
+                block(i);
+            }
+            node = n->left;
+        } else {
+            // the center is in the period
+            for (uint32_t i=n->begin; i<n->end; i++) {
+                block(i);
+            }
+            atlas_rdf_temporal_query(layout, n->left, begin, end, block);
+            node = n->right;
+        }
+    }
+}
+
+static int
+atlas_rdf_temporal_statement_cmp(const void * a, const void * b) {
+    const __graph * s1 = a;
+    const __graph * s2 = b;
+    if (s1->subject != s2->subject) return s1->subject < s2->subject ? -1 : 1;
+    if (s1->predicate != s2->predicate) return s1->predicate < s2->predicate ? -1 : 1;
+    if (s1->object != s2->object) return s1->object < s2->object ? -1 : 1;
+    return 0;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_temporal_graph_at(atlas_rdf_temporal_graph_t graph,
+                            time_t time) {
+    assert(graph != 0);
+    
+    __temporal_layout layout;
+    atlas_rdf_temporal_graph_layout(graph, &layout);
+    
+    __block uint32_t capacity = 64;
+    __block uint32_t length = 0;
+    __block __graph * statements = malloc(sizeof(__graph) * capacity);
+    assert(statements != 0);
+    
+    __temporal_statement * all = layout.statements;
+    atlas_rdf_temporal_query(&layout, layout.header->num_nodes > 0 ? 1 : 0, time, time, ^(uint32_t position){
+        if (length == capacity) {
+            capacity *= 2;
+            statements = realloc(statements, sizeof(__graph) * capacity);
+            assert(statements != 0);
+        }
+        statements[length].subject = all[position].subject;
+        statements[length].predicate = all[position].predicate;
+        statements[length].object = all[position].object;
+        length++;
+    });
+    
+    // a statement can be valid in more than one interval
+    qsort(statements, length, sizeof(__graph), atlas_rdf_temporal_statement_cmp);
+    uint32_t num_statements = 0;
+    for (uint32_t i=0; i<length; i++) {
+        if (num_statements == 0 || atlas_rdf_temporal_statement_cmp(&statements[num_statements - 1], &statements[i]) != 0) {
+            statements[num_statements++] = statements[i];
+        }
+    }
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_subset(graph, num_statements, statements);
+    free(statements);
+    return result;
+}
+
+int
+atlas_rdf_temporal_graph_during(atlas_rdf_temporal_graph_t graph,
+                                time_t begin,
+                                time_t end,
+                                void(^iterator)(atlas_rdf_term_t subject,
+                                                atlas_rdf_term_t predicate,
+                                                atlas_rdf_term_t object,
+                                                time_t valid_from,
+                                                time_t valid_to)) {
+    assert(graph != 0);
+    
+    if (begin > end) {
+        return 0;
+    }
+    
+    __temporal_layout layout;
+    atlas_rdf_temporal_graph_layout(graph, &layout);
+    
+    __block int count = 0;
+    __temporal_statement * all = layout.statements;
+    atlas_rdf_temporal_query(&layout, layout.header->num_nodes > 0 ? 1 : 0, begin, end, ^(uint32_t position){
+        if (iterator) {
+            iterator(lz_obj_weak_ref(graph, all[position].subject),
+                     lz_obj_weak_ref(graph, all[position].predicate),
+                     lz_obj_weak_ref(graph, all[position].object),
+                     all[position].valid_from,
+                     all[position].valid_to);
+        }
+        count++;
+    });
+    return count;
+}
@@ -0,0 +1,189 @@
+/*
+ *  atlas_rdf_term_cache_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_term_cache_impl.h"
+#include "atlas_rdf_graph_builder_impl.h"
+
+#include <lazy.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+typedef struct {
+    uint32_t hash;
+    uint32_t length;
+    char * key;
+    atlas_rdf_term_t term;
+    int id;
+} __term_cache_entry;
+
+struct atlas_rdf_term_cache_s {
+    atlas_rdf_graph_builder_t builder;
+    
+    // open addressing with linear probing, a bucket contains
+    // the position of an entry or -1 if the bucket is empty
+    int num_entries;
+    int max_entries;
+    __term_cache_entry * entries;
+    uint32_t num_buckets;
+    int32_t * buckets;
+};
+
+static uint32_t
+atlas_rdf_term_cache_hash(const char * key, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i=0; i<length; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void
+atlas_rdf_term_cache_rehash(atlas_rdf_term_cache_t cache, uint32_t num_buckets) {
+    int32_t * buckets = malloc(sizeof(int32_t) * num_buckets);
+    assert(buckets != 0);
+    memset(buckets, 0xff, sizeof(int32_t) * num_buckets);
+    
+    for (int i=0; i<cache->num_entries; i++) {
+        uint32_t b = cache->entries[i].hash & (num_buckets - 1);
+        while (buckets[b] != -1) {
+            b = (b + 1) & (num_buckets - 1);
+        }
+        buckets[b] = i;
+    }
+    
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->num_buckets = num_buckets;
+}
+
+// find the bucket, which either contains the entry
+// for the key or is empty
+static uint32_t
+atlas_rdf_term_cache_bucket(atlas_rdf_term_cache_t cache,
+                            const char * key,
+                            size_t length,
+                            uint32_t hash) {
+    uint32_t b = hash & (cache->num_buckets - 1);
+    while (cache->buckets[b] != -1) {
+        __term_cache_entry * entry = &cache->entries[cache->buckets[b]];
+        if (entry->hash == hash &&
+            entry->length == length &&
+            memcmp(entry->key, key, length) == 0) {
+            break;
+        }
+        b = (b + 1) & (cache->num_buckets - 1);
+    }
+    return b;
+}
+
+#pragma mark -
+#pragma mark Create a Term Cache
+
+atlas_rdf_term_cache_t
+atlas_rdf_term_cache_create(atlas_rdf_graph_builder_t builder) {
+    assert(builder != 0);
+    
+    atlas_rdf_term_cache_t cache = malloc(sizeof(struct atlas_rdf_term_cache_s));
+    assert(cache != 0);
+    
+    cache->builder = builder;
+    cache->num_entries = 0;
+    cache->max_entries = 64;
+    cache->entries = malloc(sizeof(__term_cache_entry) * cache->max_entries);
+    assert(cache->entries != 0);
+    cache->num_buckets = 0;
+    cache->buckets = 0;
+    atlas_rdf_term_cache_rehash(cache, 128);
+    
+    return cache;
+}
+
+void
+atlas_rdf_term_cache_free(atlas_rdf_term_cache_t cache) {
+    if (cache) {
+        for (int i=0; i<cache->num_entries; i++) {
+            lz_release(cache->entries[i].term);
+            free(cache->entries[i].key);
+        }
+        free(cache->entries);
+        free(cache->buckets);
+        free(cache);
+    }
+}
+
+#pragma mark -
+#pragma mark Lookup and Insert
+
+int
+atlas_rdf_term_cache_lookup(atlas_rdf_term_cache_t cache,
+                            const char * key,
+                            size_t length,
+                            atlas_rdf_term_t * term) {
+    uint32_t hash = atlas_rdf_term_cache_hash(key, length);
+    uint32_t b = atlas_rdf_term_cache_bucket(cache, key, length, hash);
+    if (cache->buckets[b] == -1) {
+        return -1;
+    }
+    __term_cache_entry * entry = &cache->entries[cache->buckets[b]];
+    if (term) {
+        *term = entry->term;
+    }
+    return entry->id;
+}
+
+int
+atlas_rdf_term_cache_insert(atlas_rdf_term_cache_t cache,
+                            const char * key,
+                            size_t length,
+                            atlas_rdf_term_t term) {
+    uint32_t hash = atlas_rdf_term_cache_hash(key, length);
+    uint32_t b = atlas_rdf_term_cache_bucket(cache, key, length, hash);
+    assert(cache->buckets[b] == -1);
+    
+    if (cache->num_entries == cache->max_entries) {
+        cache->max_entries *= 2;
+        cache->entries = realloc(cache->entries, sizeof(__term_cache_entry) * cache->max_entries);
+        assert(cache->entries != 0);
+    }
+    
+    __term_cache_entry * entry = &cache->entries[cache->num_entries];
+    entry->hash = hash;
+    entry->length = length;
+    entry->key = malloc(length + 1);
+    assert(entry->key != 0);
+    memcpy(entry->key, key, length);
+    entry->term = term;
+    entry->id = atlas_rdf_graph_builder_add_term(cache->builder, term);
+    cache->buckets[b] = cache->num_entries;
+    cache->num_entries++;
+    
+    // keep the load factor below 0.5
+    if ((uint32_t)cache->num_entries * 2 > cache->num_buckets) {
+        atlas_rdf_term_cache_rehash(cache, cache->num_buckets * 2);
+    }
+    
+    return entry->id;
+}
@@ -0,0 +1,77 @@
+/*
+ *  atlas_rdf_term_cache_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_TERM_CACHE_IMPL_H_
+#define _ATLAS_RDF_TERM_CACHE_IMPL_H_
+
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph_builder.h>
+
+#include <stddef.h>
+
+/*! Handle for a Term Cache
+ *
+ *  A term cache is used by the parsers to find terms, which have
+ *  been created before, by a key (e.g., the characters of the term
+ *  in the parsed data). Each term is added to a graph builder once;
+ *  the cache maps the key to the id of the term in the builder.
+ *
+ *  A term cache is not thread safe.
+ */
+typedef struct atlas_rdf_term_cache_s * atlas_rdf_term_cache_t;
+
+/*! Create a term cache for the builder.
+ *
+ *  The builder is not retained and must not be freed before the cache.
+ */
+atlas_rdf_term_cache_t
+atlas_rdf_term_cache_create(atlas_rdf_graph_builder_t builder);
+
+/*! Free a term cache and release the terms.
+ */
+void
+atlas_rdf_term_cache_free(atlas_rdf_term_cache_t cache);
+
+/*! Find the term for the key.
+ *
+ *  If term is not NULL, it is set to the term (not retained).
+ *
+ *  \return The id of the term in the builder or -1, if
+ *          the key is not in the cache.
+ */
+int
+atlas_rdf_term_cache_lookup(atlas_rdf_term_cache_t cache,
+                            const char * key,
+                            size_t length,
+                            atlas_rdf_term_t * term);
+
+/*! Add a term to the cache and to the builder.
+ *
+ *  The cache takes over the reference to the term.
+ *
+ *  \return The id of the term in the builder.
+ */
+int
+atlas_rdf_term_cache_insert(atlas_rdf_term_cache_t cache,
+                            const char * key,
+                            size_t length,
+                            atlas_rdf_term_t term);
+
+#endif // _ATLAS_RDF_TERM_CACHE_IMPL_H_
@@ -0,0 +1,182 @@
+/*
+ *  atlas_rdf_term_dict_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_term_dict_impl.h"
+#include "atlas_rdf_term_impl.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+struct atlas_rdf_term_dict_s {
+    // terms in the order they have been inserted
+    int num_terms;
+    int max_terms;
+    atlas_rdf_term_t * terms;
+    uint32_t * hashes;
+    
+    // open addressing with linear probing, a bucket contains
+    // the id of a term or -1 if the bucket is empty
+    uint32_t num_buckets;
+    int32_t * buckets;
+};
+
+static void
+atlas_rdf_term_dict_rehash(atlas_rdf_term_dict_t dict, uint32_t num_buckets) {
+    int32_t * buckets = malloc(sizeof(int32_t) * num_buckets);
+    assert(buckets != 0);
+    memset(buckets, 0xff, sizeof(int32_t) * num_buckets);
+    
+    for (int i=0; i<dict->num_terms; i++) {
+        uint32_t b = dict->hashes[i] & (num_buckets - 1);
+        while (buckets[b] != -1) {
+            b = (b + 1) & (num_buckets - 1);
+        }
+        buckets[b] = i;
+    }
+    
+    free(dict->buckets);
+    dict->buckets = buckets;
+    dict->num_buckets = num_buckets;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Term Dictionary
+
+atlas_rdf_term_dict_t
+atlas_rdf_term_dict_create(int capacity) {
+    atlas_rdf_term_dict_t dict = malloc(sizeof(struct atlas_rdf_term_dict_s));
+    assert(dict != 0);
+    
+    if (capacity < 8) {
+        capacity = 8;
+    }
+    
+    dict->num_terms = 0;
+    dict->max_terms = capacity;
+    dict->terms = malloc(sizeof(atlas_rdf_term_t) * capacity);
+    dict->hashes = malloc(sizeof(uint32_t) * capacity);
+    assert(dict->terms != 0);
+    assert(dict->hashes != 0);
+    
+    // keep the load factor below 0.5
+    uint32_t num_buckets = 16;
+    while (num_buckets < (uint32_t)capacity * 2) {
+        num_buckets <<= 1;
+    }
+    dict->num_buckets = 0;
+    dict->buckets = 0;
+    atlas_rdf_term_dict_rehash(dict, num_buckets);
+    
+    return dict;
+}
+
+void
+atlas_rdf_term_dict_free(atlas_rdf_term_dict_t dict) {
+    if (dict) {
+        free(dict->terms);
+        free(dict->hashes);
+        free(dict->buckets);
+        free(dict);
+    }
+}
+
+#pragma mark -
+#pragma mark Access a RDF Term Dictionary
+
+int
+atlas_rdf_term_dict_insert(atlas_rdf_term_dict_t dict,
+                           atlas_rdf_term_t term) {
+    return atlas_rdf_term_dict_insert_hashed(dict, term, atlas_rdf_term_hash(term));
+}
+
+int
+atlas_rdf_term_dict_insert_hashed(atlas_rdf_term_dict_t dict,
+                                  atlas_rdf_term_t term,
+                                  uint32_t hash) {
+    assert(dict != 0);
+    assert(term != 0);
+    
+    // return the id if the term is already in the dictionary
+    uint32_t b = hash & (dict->num_buckets - 1);
+    while (dict->buckets[b] != -1) {
+        int32_t id = dict->buckets[b];
+        if (dict->hashes[id] == hash && atlas_rdf_term_eq(dict->terms[id], term) != 0) {
+            return id;
+        }
+        b = (b + 1) & (dict->num_buckets - 1);
+    }
+    
+    // grow the list of terms if needed
+    if (dict->num_terms == dict->max_terms) {
+        dict->max_terms *= 2;
+        dict->terms = realloc(dict->terms, sizeof(atlas_rdf_term_t) * dict->max_terms);
+        dict->hashes = realloc(dict->hashes, sizeof(uint32_t) * dict->max_terms);
+        assert(dict->terms != 0);
+        assert(dict->hashes != 0);
+    }
+    
+    // append the term
+    int id = dict->num_terms;
+    dict->terms[id] = term;
+    dict->hashes[id] = hash;
+    dict->num_terms++;
+    dict->buckets[b] = id;
+    
+    // keep the load factor below 0.5
+    if ((uint32_t)dict->num_terms * 2 > dict->num_buckets) {
+        atlas_rdf_term_dict_rehash(dict, dict->num_buckets * 2);
+    }
+    
+    return id;
+}
+
+int
+atlas_rdf_term_dict_lookup(atlas_rdf_term_dict_t dict,
+                           atlas_rdf_term_t term) {
+    assert(dict != 0);
+    assert(term != 0);
+    
+    uint32_t hash = atlas_rdf_term_hash(term);
+    uint32_t b = hash & (dict->num_buckets - 1);
+    while (dict->buckets[b] != -1) {
+        int32_t id = dict->buckets[b];
+        if (dict->hashes[id] == hash && atlas_rdf_term_eq(dict->terms[id], term) != 0) {
+            return id;
+        }
+        b = (b + 1) & (dict->num_buckets - 1);
+    }
+    return -1;
+}
+
+int
+atlas_rdf_term_dict_length(atlas_rdf_term_dict_t dict) {
+    assert(dict != 0);
+    return dict->num_terms;
+}
+
+atlas_rdf_term_t *
+atlas_rdf_term_dict_terms(atlas_rdf_term_dict_t dict) {
+    assert(dict != 0);
+    return dict->terms;
+}
@@ -0,0 +1,97 @@
+/*
+ *  atlas_rdf_term_dict_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_TERM_DICT_IMPL_H_
+#define _ATLAS_RDF_TERM_DICT_IMPL_H_
+
+#include <atlas/rdf/term.h>
+
+#include <stdint.h>
+
+/*! Handle for a RDF Term Dictionary
+ *
+ *  A term dictionary is a mutable hash table which maps
+ *  RDF Terms (compared by atlas_rdf_term_eq()) to consecutive
+ *  ids, starting at 0. The terms are not retained.
+ *
+ *  A term dictionary is not thread safe.
+ */
+typedef struct atlas_rdf_term_dict_s * atlas_rdf_term_dict_t;
+
+#pragma mark -
+#pragma mark Create a RDF Term Dictionary
+
+/*! Create an empty term dictionary.
+ *
+ *  \param capacity Number of terms expected to be
+ *                  added (the dictionary grows if needed).
+ */
+atlas_rdf_term_dict_t
+atlas_rdf_term_dict_create(int capacity);
+
+/*! Free a term dictionary.
+ */
+void
+atlas_rdf_term_dict_free(atlas_rdf_term_dict_t dict);
+
+#pragma mark -
+#pragma mark Access a RDF Term Dictionary
+
+/*! Insert a term into the dictionary.
+ *
+ *  \return The id of the term. If an equal term is already in
+ *          the dictionary, the id of that term is returned.
+ */
+int
+atlas_rdf_term_dict_insert(atlas_rdf_term_dict_t dict,
+                           atlas_rdf_term_t term);
+
+/*! Insert a term with a precalculated hash value into the dictionary.
+ *
+ *  Same as atlas_rdf_term_dict_insert(), but the hash value has
+ *  already been calculated with atlas_rdf_term_hash().
+ */
+int
+atlas_rdf_term_dict_insert_hashed(atlas_rdf_term_dict_t dict,
+                                  atlas_rdf_term_t term,
+                                  uint32_t hash);
+
+/*! Lookup a term in the dictionary.
+ *
+ *  \return The id of the term or -1 if the term is not in the dictionary.
+ */
+int
+atlas_rdf_term_dict_lookup(atlas_rdf_term_dict_t dict,
+                           atlas_rdf_term_t term);
+
+/*! Number of terms in the dictionary.
+ */
+int
+atlas_rdf_term_dict_length(atlas_rdf_term_dict_t dict);
+
+/*! The terms in the dictionary.
+ *
+ *  The term with the id i is at position i. The array is owned
+ *  by the dictionary and is only valid until the next insert.
+ */
+atlas_rdf_term_t *
+atlas_rdf_term_dict_terms(atlas_rdf_term_dict_t dict);
+
+#endif // _ATLAS_RDF_TERM_DICT_IMPL_H_
@@ -29,6 +29,9 @@
 #include <string.h>
 #include <assert.h>
 #include <regex.h>
+#include <math.h>
+
+#include <dispatch/dispatch.h>
 
 #pragma mark -
 #pragma mark Data Structure
@@ -44,6 +47,15 @@ struct atlas_rdf_term_value_s {
     char value[];
 };
 
+#pragma mark IRI
+
+// an iri is stored as the id of its namespace and the local name
+struct atlas_rdf_term_iri_s {
+    ATLAS_RDF_TERM_HEADER;
+    uint32_t ns;
+    char local[];
+};
+
 #pragma mark Boolean
 
 struct atlas_rdf_term_boolean_s {
@@ -79,37 +91,219 @@ struct atlas_rdf_term_decimal_s {
     __mpf_struct value;
 };
 
+#pragma mark -
+#pragma mark Namespaces
+
+// The namespace of an iri is the part up to and including the last
+// '#', '/' or ':'. The namespaces are shared by all iris and never
+// removed; id 0 is the empty namespace, which is used for iris without
+// a namespace and for all new namespaces after the table is full.
+// Since an iri is split the same way every time, equal iris always
+// have the same namespace.
+
+#define ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE 1024
+#define ATLAS_RDF_TERM_MAX_NAMESPACES (64 * ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE)
+
+typedef struct {
+    uint32_t length;
+    uint32_t hash;
+    char value[];
+} __term_namespace;
+
+// the pages are never moved, so that a namespace can be
+// read without synchronization once its id is known
+static __term_namespace ** atlas_rdf_term_namespaces[ATLAS_RDF_TERM_MAX_NAMESPACES / ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE];
+static uint32_t atlas_rdf_term_num_namespaces;
+
+// hash table of the ids (+ 1) of the namespaces, used on the queue
+static uint32_t * atlas_rdf_term_namespace_index;
+static uint32_t atlas_rdf_term_namespace_capacity;
+static dispatch_queue_t atlas_rdf_term_namespace_queue;
+
+static inline const __term_namespace *
+atlas_rdf_term_namespace(uint32_t id) {
+    return atlas_rdf_term_namespaces[id / ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE][id % ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE];
+}
+
+static uint32_t
+atlas_rdf_term_namespace_hash(const char * value, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i=0; i<length; i++) {
+        hash ^= (unsigned char)value[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// add a namespace to the table, must be called on the queue
+static uint32_t
+atlas_rdf_term_namespace_add(const char * value, int length, uint32_t hash) {
+    uint32_t id = atlas_rdf_term_num_namespaces;
+    if (id % ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE == 0) {
+        __term_namespace ** page = calloc(ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE, sizeof(__term_namespace *));
+        assert(page != 0);
+        atlas_rdf_term_namespaces[id / ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE] = page;
+    }
+    
+    __term_namespace * ns = malloc(sizeof(__term_namespace) + length + 1);
+    assert(ns != 0);
+    ns->length = length;
+    ns->hash = hash;
+    memcpy(ns->value, value, length);
+    ns->value[length] = 0;
+    atlas_rdf_term_namespaces[id / ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE][id % ATLAS_RDF_TERM_NAMESPACE_PAGE_SIZE] = ns;
+    
+    // grow the index, if it is half full
+    if (2 * (id + 1) > atlas_rdf_term_namespace_capacity) {
+        uint32_t capacity = atlas_rdf_term_namespace_capacity * 2;
+        uint32_t * index = calloc(capacity, sizeof(uint32_t));
+        assert(index != 0);
+        for (uint32_t i=0; i<id; i++) {
+            uint32_t slot = atlas_rdf_term_namespace(i)->hash & (capacity - 1);
+            while (index[slot] != 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            index[slot] = i + 1;
+        }
+        free(atlas_rdf_term_namespace_index);
+        atlas_rdf_term_namespace_index = index;
+        atlas_rdf_term_namespace_capacity = capacity;
+    }
+    
+    uint32_t slot = hash & (atlas_rdf_term_namespace_capacity - 1);
+    while (atlas_rdf_term_namespace_index[slot] != 0) {
+        slot = (slot + 1) & (atlas_rdf_term_namespace_capacity - 1);
+    }
+    atlas_rdf_term_namespace_index[slot] = id + 1;
+    
+    // publish the namespace after it has been written
+    __sync_synchronize();
+    atlas_rdf_term_num_namespaces = id + 1;
+    return id;
+}
+
+// id of a namespace, the namespace is added if it is new
+static uint32_t
+atlas_rdf_term_namespace_id(const char * value, int length) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        atlas_rdf_term_namespace_queue = dispatch_queue_create("atlas.rdf.term.namespaces", 0);
+        atlas_rdf_term_namespace_capacity = 256;
+        atlas_rdf_term_namespace_index = calloc(atlas_rdf_term_namespace_capacity, sizeof(uint32_t));
+        assert(atlas_rdf_term_namespace_index != 0);
+        atlas_rdf_term_namespace_add("", 0, atlas_rdf_term_namespace_hash("", 0));
+    });
+    
+    if (length == 0) {
+        return 0;
+    }
+    
+    uint32_t hash = atlas_rdf_term_namespace_hash(value, length);
+    __block uint32_t result = 0;
+    dispatch_sync(atlas_rdf_term_namespace_queue, ^{
+        uint32_t slot = hash & (atlas_rdf_term_namespace_capacity - 1);
+        while (atlas_rdf_term_namespace_index[slot] != 0) {
+            uint32_t id = atlas_rdf_term_namespace_index[slot] - 1;
+            const __term_namespace * ns = atlas_rdf_term_namespace(id);
+            if (ns->hash == hash && ns->length == length && memcmp(ns->value, value, length) == 0) {
+                result = id;
+                return;
+            }
+            slot = (slot + 1) & (atlas_rdf_term_namespace_capacity - 1);
+        }
+        if (atlas_rdf_term_num_namespaces < ATLAS_RDF_TERM_MAX_NAMESPACES) {
+            result = atlas_rdf_term_namespace_add(value, length, hash);
+        }
+    });
+    return result;
+}
+
+// length of the namespace of an iri
+static int
+atlas_rdf_term_namespace_split(const char * value, int length) {
+    const char * separators = "#/:";
+    for (const char * separator = separators; *separator; separator++) {
+        for (int k=length - 1; k>=0; k--) {
+            if (value[k] == *separator) {
+                return k + 1;
+            }
+        }
+    }
+    return 0;
+}
+
 #pragma mark -
 #pragma mark Create a RDF Term
 
+// the regular expressions are compiled once and
+// used concurrently (regexec does not modify them)
+static regex_t atlas_rdf_term_iri_regex;
+static regex_t atlas_rdf_term_blank_node_regex;
+static regex_t atlas_rdf_term_lang_regex;
+
+static void
+atlas_rdf_term_compile_regex(void) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        // Validate value via a regular expression as a
+        // respresentation of the ABNF for IRIs as defined in RFC3987.
+        regcomp(&atlas_rdf_term_iri_regex,
+                "^[a-zA-Z]([a-zA-Z0-9]|\\+|-|\\.)*:((//([^[:cntrl:]\x20<>\"{}|^`\\]*@)?[^[:cntrl:]\x20<>\"{}|^`\\]*(:\\d*)?(/[^[:cntrl:]\x20<>\"{}|^`\\]*)*)|(/([^[:cntrl:]\x20<>\"{}|^`\\]+(/[^[:cntrl:]\x20<>\"{}|^`\\]*)*)?)|([^[:cntrl:]\x20<>\"{}|^`\\]+(/[^[:cntrl:]\x20<>\"{}|^`\\]*)*)|(.{0}))(\\?[^[:cntrl:]\x20<>\"{}|^`\\]*)?(#[^[:cntrl:]\x20<>\"{}|^`\\]*)?$",
+                REG_EXTENDED|REG_NOSUB);
+        
+        // Validate value via a regular expression as a
+        // representation of the ABNF for blank node labels as defined in 
+        // http://www.w3.org/TR/rdf-sparql-query/#rPN_LOCAL
+        regcomp(&atlas_rdf_term_blank_node_regex,
+                "^([a-zA-Z0-9_\xC0-\xD6\xD8-\xF6\xF8-\xFF])([a-zA-Z0-9_\xC0-\xD6\xD8-\xF6\xF8-\xFF\\-\xB7\\.]*[a-zA-Z0-9_\xC0-\xD6\xD8-\xF6\xF8-\xFF\\-\xB7])?$",
+                REG_EXTENDED|REG_NOSUB);
+        
+        // Validate lang via a regular expression as a
+        // respresentation of the ABNF for language tags as defined in
+        // http://www.w3.org/TR/rdf-sparql-query/#rLANGTAG.
+        regcomp(&atlas_rdf_term_lang_regex,
+                "^[a-zA-Z]+(-[a-zA-Z0-9]+)*$",
+                REG_EXTENDED|REG_NOSUB);
+    });
+}
+
 atlas_rdf_term_t
 atlas_rdf_term_create_iri(const char * value,
                           atlas_error_handler err) {
     
-	// Validate value via a regular expression as a
-	// respresentation of the ABNF for IRIs as defined in RFC3987.
-    regex_t regex;
-	regcomp(&regex,
-	   	    "^[a-zA-Z]([a-zA-Z0-9]|\\+|-|\\.)*:((//([^[:cntrl:]\x20<>\"{}|^`\\]*@)?[^[:cntrl:]\x20<>\"{}|^`\\]*(:\\d*)?(/[^[:cntrl:]\x20<>\"{}|^`\\]*)*)|(/([^[:cntrl:]\x20<>\"{}|^`\\]+(/[^[:cntrl:]\x20<>\"{}|^`\\]*)*)?)|([^[:cntrl:]\x20<>\"{}|^`\\]+(/[^[:cntrl:]\x20<>\"{}|^`\\]*)*)|(.{0}))(\\?[^[:cntrl:]\x20<>\"{}|^`\\]*)?(#[^[:cntrl:]\x20<>\"{}|^`\\]*)?$",
-			REG_EXTENDED|REG_NOSUB);
-	if (regexec(&regex, value, 0, 0, 0) != 0) {
+    atlas_rdf_term_compile_regex();
+	if (regexec(&atlas_rdf_term_iri_regex, value, 0, 0, 0) != 0) {
 		// TODO: define error constants
 		err(0, "Pattern matching not succeeded. Value is not a valid IRI.");
 		return 0;
 	}
 	
-    // get the length of the value
-    int length = strlen(value);
+    return atlas_rdf_term_create_iri_trusted(value, strlen(value));
+}
+
+atlas_rdf_term_t
+atlas_rdf_term_create_iri_trusted(const char * value,
+                                  int length) {
+    
+    // the complete value is stored, if the namespace
+    // could not be added to the table
+    int split = atlas_rdf_term_namespace_split(value, length);
+    uint32_t ns = atlas_rdf_term_namespace_id(value, split);
+    if (ns == 0) {
+        split = 0;
+    }
     
     // calculate the amount of space needed to store this type
     // and allocate memory
-    int size = sizeof(struct atlas_rdf_term_value_s) + length + 1;
-    struct atlas_rdf_term_value_s * iri = malloc(size);
+    int size = sizeof(struct atlas_rdf_term_iri_s) + length - split + 1;
+    struct atlas_rdf_term_iri_s * iri = malloc(size);
     assert(iri != 0);
     
-    // copy the value to the allocated memory
+    // copy the local name to the allocated memory
     iri->type = IRI;
-    memcpy(iri->value, value, length + 1);
+    iri->ns = ns;
+    memcpy(iri->local, value + split, length - split);
+    iri->local[length - split] = 0;
     
     // create a lazy object
     return lz_obj_new(iri, size, ^{
@@ -122,21 +316,19 @@ atlas_rdf_term_t
 atlas_rdf_term_create_blank_node(const char * value,
                                  atlas_error_handler err) {
     
-    // Validate value via a regular expression as a
-	// representation of the ABNF for blank node labels as defined in 
-	// http://www.w3.org/TR/rdf-sparql-query/#rPN_LOCAL
-    regex_t regex;
-	int a = regcomp(&regex,
-	   	    "^([a-zA-Z0-9_\xC0-\xD6\xD8-\xF6\xF8-\xFF])([a-zA-Z0-9_\xC0-\xD6\xD8-\xF6\xF8-\xFF\\-\xB7\\.]*[a-zA-Z0-9_\xC0-\xD6\xD8-\xF6\xF8-\xFF\\-\xB7])?$",
-			REG_EXTENDED|REG_NOSUB);
-	if (regexec(&regex, value, 0, 0, 0) != 0) {
+    atlas_rdf_term_compile_regex();
+	if (regexec(&atlas_rdf_term_blank_node_regex, value, 0, 0, 0) != 0) {
 		// TODO: define error constants
 		err(0, "Pattern matching not succeeded. Value is not a valid Blank Node Label.");
 		return 0;
 	}
 	
-    // get the length of the value
-    int length = strlen(value);
+    return atlas_rdf_term_create_blank_node_trusted(value, strlen(value));
+}
+
+atlas_rdf_term_t
+atlas_rdf_term_create_blank_node_trusted(const char * value,
+                                         int length) {
     
     // calculate the amount of space needed to store this type
     // and allocate memory
@@ -146,7 +338,8 @@ atlas_rdf_term_create_blank_node(const char * value,
     
     // copy the value to the allocated memory
     bn->type = BLANK_NODE;
-    memcpy(bn->value, value, length + 1);
+    memcpy(bn->value, value, length);
+    bn->value[length] = 0;
     
     // create a lazy object
     return lz_obj_new(bn, size, ^{
@@ -168,11 +361,8 @@ atlas_rdf_term_create_string(const char * value,
 		// Validate lang via a regular expression as a
 		// respresentation of the ABNF for language tags as defined in
 		// http://www.w3.org/TR/rdf-sparql-query/#rLANGTAG.
-		regex_t regex;
-		regcomp(&regex,
-				"^[a-zA-Z]+(-[a-zA-Z0-9]+)*$",
-				REG_EXTENDED|REG_NOSUB);
-		if (regexec(&regex, lang, 0, 0, 0) != 0) {
+		atlas_rdf_term_compile_regex();
+		if (regexec(&atlas_rdf_term_lang_regex, lang, 0, 0, 0) != 0) {
 			// TODO: define error constants
 			err(0, "Pattern matching not succeeded. Lang is not a valid language tag.");
 			return 0;
@@ -210,6 +400,34 @@ atlas_rdf_term_create_string(const char * value,
 }
 
 
+// parse a xsd:dateTime (e.g., 2010-04-28T10:00:00+00:00), a
+// value with digits only is the number of seconds since 1970
+static time_t
+atlas_rdf_term_parse_datetime(const char * value) {
+    struct tm t;
+    int n = 0;
+    memset(&t, 0, sizeof(struct tm));
+    if (sscanf(value, "%d-%d-%dT%d:%d:%d%n", &t.tm_year, &t.tm_mon, &t.tm_mday,
+               &t.tm_hour, &t.tm_min, &t.tm_sec, &n) != 6) {
+        return atoi(value);
+    }
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    time_t result = timegm(&t);
+    
+    // skip the fraction of the seconds and apply the time zone
+    const char * p = value + n;
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++);
+    }
+    int hours, minutes;
+    if ((*p == '+' || *p == '-') && sscanf(p + 1, "%d:%d", &hours, &minutes) == 2) {
+        int offset = hours * 3600 + minutes * 60;
+        result += *p == '+' ? -offset : offset;
+    }
+    return result;
+}
+
 atlas_rdf_term_t
 atlas_rdf_term_create_typed(const char * value,
                             atlas_rdf_term_t type,
@@ -246,13 +464,13 @@ atlas_rdf_term_create_typed(const char * value,
 			}
 		}
 		if (atlas_rdf_term_cmp_iri_value(type, BOOLEAN_DATATYPE_IRI) != 0) {
-			term = atlas_rdf_term_create_boolean(atoi(value), err);
+			term = atlas_rdf_term_create_boolean(strcmp(value, "true") == 0 || atoi(value) != 0, err);
 			if (term) {
 				return term;
 			}
 		}
 		if (atlas_rdf_term_cmp_iri_value(type, DATETIME_DATATYPE_IRI) != 0) {
-			term = atlas_rdf_term_create_datetime(atoi(value), err);
+			term = atlas_rdf_term_create_datetime(atlas_rdf_term_parse_datetime(value), err);
 			if (term) {
 				return term;
 			}
@@ -444,9 +662,9 @@ atlas_rdf_term_repr(atlas_rdf_term_t term) {
         switch (t->type) {
             case IRI:
             {
-                struct atlas_rdf_term_value_s *t = data;  
+                struct atlas_rdf_term_iri_s *t = data;
                 char * buffer;
-                asprintf(&buffer, "<%s>", t->value);
+                asprintf(&buffer, "<%s%s>", atlas_rdf_term_namespace(t->ns)->value, t->local);
                 result = buffer;
                 break;
             }
@@ -551,6 +769,179 @@ atlas_rdf_term_repr(atlas_rdf_term_t term) {
 }
 
 
+static void
+atlas_rdf_term_ntriples_escape_iri(const char * value,
+                                   void(^append)(const char * data, size_t length)) {
+    const char * begin = value;
+    const char * p = value;
+    for (; *p; p++) {
+        unsigned char c = *p;
+        if (c <= 0x20 || strchr("<>\"{}|^`\\", c)) {
+            char escaped[7];
+            append(begin, p - begin);
+            snprintf(escaped, 7, "\\u%04X", c);
+            append(escaped, 6);
+            begin = p + 1;
+        }
+    }
+    append(begin, p - begin);
+}
+
+static void
+atlas_rdf_term_ntriples_iri(const char * ns,
+                            const char * local,
+                            void(^append)(const char * data, size_t length)) {
+    append("<", 1);
+    atlas_rdf_term_ntriples_escape_iri(ns, append);
+    atlas_rdf_term_ntriples_escape_iri(local, append);
+    append(">", 1);
+}
+
+static void
+atlas_rdf_term_ntriples_string(const char * value,
+                               void(^append)(const char * data, size_t length)) {
+    append("\"", 1);
+    const char * begin = value;
+    const char * p = value;
+    for (; *p; p++) {
+        const char * escaped;
+        switch (*p) {
+            case '"':  escaped = "\\\""; break;
+            case '\\': escaped = "\\\\"; break;
+            case '\n': escaped = "\\n"; break;
+            case '\r': escaped = "\\r"; break;
+            default:   continue;
+        }
+        append(begin, p - begin);
+        append(escaped, 2);
+        begin = p + 1;
+    }
+    append(begin, p - begin);
+    append("\"", 1);
+}
+
+static void
+atlas_rdf_term_ntriples_typed(const char * value,
+                              const char * type,
+                              void(^append)(const char * data, size_t length)) {
+    atlas_rdf_term_ntriples_string(value, append);
+    append("^^", 2);
+    atlas_rdf_term_ntriples_iri("", type, append);
+}
+
+void
+atlas_rdf_term_ntriples(atlas_rdf_term_t term,
+                        void(^append)(const char * data, size_t length)) {
+    assert(term != 0);
+    
+    lz_obj_sync(term, ^(void * data, uint32_t length){
+        
+        struct atlas_rdf_term_s * t = data;
+        
+        switch (t->type) {
+            case IRI:
+            {
+                struct atlas_rdf_term_iri_s * iri = data;
+                atlas_rdf_term_ntriples_iri(atlas_rdf_term_namespace(iri->ns)->value, iri->local, append);
+                break;
+            }
+                
+            case BLANK_NODE:
+            {
+                struct atlas_rdf_term_value_s * bn = data;
+                append("_:", 2);
+                append(bn->value, strlen(bn->value));
+                break;
+            }
+                
+            case STRING_LITERAL:
+            {
+                struct atlas_rdf_term_value_s * sl = data;
+                atlas_rdf_term_ntriples_string(sl->value, append);
+                const char * lang = sl->value + strlen(sl->value) + 1;
+                if (*lang) {
+                    append("@", 1);
+                    append(lang, strlen(lang));
+                }
+                break;
+            }
+                
+            case TYPED_LITERAL:
+            {
+                struct atlas_rdf_term_value_s * tl = data;
+                atlas_rdf_term_ntriples_string(tl->value, append);
+                append("^^", 2);
+                lz_obj_sync(lz_obj_weak_ref(term, 0), ^(void * data, uint32_t length){
+                    struct atlas_rdf_term_iri_s * type = data;
+                    atlas_rdf_term_ntriples_iri(atlas_rdf_term_namespace(type->ns)->value, type->local, append);
+                });
+                break;
+            }
+                
+            case BOOLEAN_LITERAL:
+            {
+                struct atlas_rdf_term_boolean_s * b = data;
+                atlas_rdf_term_ntriples_typed(b->value ? "true" : "false", BOOLEAN_DATATYPE_IRI, append);
+                break;
+            }
+                
+            case DOUBLE_LITERAL:
+            {
+                // enough digits to read the same value again
+                struct atlas_rdf_term_double_s * d = data;
+                char buffer[32];
+                if (isnan(d->value)) {
+                    strcpy(buffer, "NaN");
+                } else if (isinf(d->value)) {
+                    strcpy(buffer, d->value > 0 ? "INF" : "-INF");
+                } else {
+                    snprintf(buffer, 32, "%.17g", d->value);
+                }
+                atlas_rdf_term_ntriples_typed(buffer, DOUBLE_DATATYPE_IRI, append);
+                break;
+            }
+                
+            case DATETIME_LITERAL:
+            {
+                struct atlas_rdf_term_datetime_s * dt = data;
+                char buffer[32];
+                struct tm time_tmp;
+                gmtime_r(&(dt->value), &time_tmp);
+                strftime(buffer, 32, "%Y-%m-%dT%H:%M:%S+00:00", &time_tmp);
+                atlas_rdf_term_ntriples_typed(buffer, DATETIME_DATATYPE_IRI, append);
+                break;
+            }
+                
+            case DECIMAL_LITERAL:
+            {
+                struct atlas_rdf_term_decimal_s * decimal = data;
+                char * buffer;
+                mpf_t f = { decimal->value };
+                gmp_asprintf(&buffer, "%.Ff", f);
+                atlas_rdf_term_ntriples_typed(buffer, DECIMAL_DATATYPE_IRI, append);
+                free(buffer);
+                break;
+            }
+                
+            case INTEGER_LITERAL:
+            {
+                struct atlas_rdf_term_integer_s * integer = data;
+                char * buffer;
+                mpz_t z = { integer->value };
+                gmp_asprintf(&buffer, "%Zd", z);
+                atlas_rdf_term_ntriples_typed(buffer, INTEGER_DATATYPE_IRI, append);
+                free(buffer);
+                break;
+            }
+                
+            default:
+                assert(0);
+                break;
+        }
+    });
+}
+
+
 #pragma mark -
 #pragma mark Access Details of a RDF Literal Term
 
@@ -560,11 +951,15 @@ atlas_rdf_term_iri_value(atlas_rdf_term_t term) {
     __block char * result;
     lz_obj_sync(term, ^(void * data, uint32_t length){
         
-        struct atlas_rdf_term_value_s * iri = data;
+        struct atlas_rdf_term_iri_s * iri = data;
         assert(iri->type == IRI);
         
-        result = strdup(iri->value);
+        const __term_namespace * ns = atlas_rdf_term_namespace(iri->ns);
+        size_t local_length = strlen(iri->local);
+        result = malloc(ns->length + local_length + 1);
         assert(result);
+        memcpy(result, ns->value, ns->length);
+        memcpy(result + ns->length, iri->local, local_length + 1);
     });
     return result;
 }
@@ -767,81 +1162,121 @@ atlas_rdf_term_boolean_value(atlas_rdf_term_t term) {
     return result;
 }
 
-
-#pragma mark -
-#pragma mark Effective Boolean Value
-
-int atlas_rdf_term_ebv(atlas_rdf_term_t term) {
+atlas_rdf_term_type_t
+atlas_rdf_term_scalar(atlas_rdf_term_t term, int64_t * integer, double * number) {
     assert(term != 0);
-    __block int result;
+    __block atlas_rdf_term_type_t result;
     lz_obj_sync(term, ^(void * data, uint32_t length){
         
         struct atlas_rdf_term_s * literal = data;
+        result = literal->type;
         
         switch (literal->type) {
-            case IRI:
+            case BOOLEAN_LITERAL:
             {
-                struct atlas_rdf_term_value_s * iri = data;  
+                struct atlas_rdf_term_boolean_s * bool = data;
+                *integer = bool->value;
                 break;
             }
                 
-            case BLANK_NODE:
+            case DATETIME_LITERAL:
             {
-                struct atlas_rdf_term_value_s * bn = data;  
+                struct atlas_rdf_term_datetime_s * dt = data;
+                *integer = dt->value;
                 break;
-            }  
+            }
                 
-            case STRING_LITERAL:
+            case DOUBLE_LITERAL:
             {
-                struct atlas_rdf_term_value_s * sl = data;
+                struct atlas_rdf_term_double_s * dl = data;
+                *number = dl->value;
                 break;
             }
                 
-            case TYPED_LITERAL:
+            case DECIMAL_LITERAL:
             {
+                struct atlas_rdf_term_decimal_s * decimal = data;
+                *number = mpf_get_d(&decimal->value);
+                break;
+            }
+                
+            case INTEGER_LITERAL:
+            {
+                struct atlas_rdf_term_integer_s * i = data;
+                *number = mpz_get_d(&i->value);
+                if (mpz_sizeinbase(&i->value, 2) < 64) {
+                    *integer = mpz_get_si(&i->value);
+                } else {
+                    result = DECIMAL_LITERAL;
+                }
+                break;
+            }
+                
+            default:
+                break;
+        }
+    });
+    return result;
+}
+
+
+#pragma mark -
+#pragma mark Effective Boolean Value
+
+int atlas_rdf_term_ebv(atlas_rdf_term_t term) {
+    assert(term != 0);
+    __block int result = -1;
+    lz_obj_sync(term, ^(void * data, uint32_t length){
+        
+        struct atlas_rdf_term_s * literal = data;
+        
+        switch (literal->type) {
+            case STRING_LITERAL:
+            {
+                // the language tag does not matter
                 struct atlas_rdf_term_value_s * sl = data;
+                result = sl->value[0] != 0;
                 break;
             }
                 
             case BOOLEAN_LITERAL:
             {
                 struct atlas_rdf_term_boolean_s * bool = data;
+                result = bool->value != 0;
                 break;
             }
                 
             case DOUBLE_LITERAL:
             {
                 struct atlas_rdf_term_double_s * dl = data;
-                break;
-            }
-                
-            case DATETIME_LITERAL:
-            {
-                struct atlas_rdf_term_datetime_s * dt = data;
+                result = dl->value != 0 && !isnan(dl->value);
                 break;
             }
                 
             case DECIMAL_LITERAL:
             {
                 struct atlas_rdf_term_decimal_s *decimal = data;
+                result = mpf_sgn(&decimal->value) != 0;
                 break;
             }
                 
             case INTEGER_LITERAL:
             {
                 struct atlas_rdf_term_integer_s *integer = data;
+                result = mpz_sgn(&integer->value) != 0;
                 break;
             }
                 
             default:
-                assert(0);
+                // IRIs, blank nodes, datetimes and
+                // other typed literals have no ebv
+                result = -1;
                 break;
         }
     });
     return result;
 }
 
-
 #pragma mark -
 #pragma mark Operation
 
@@ -856,12 +1291,13 @@ int atlas_rdf_term_eq(atlas_rdf_term_t term1,
             switch (t1->type) {
                 case IRI:
                 {
-                    struct atlas_rdf_term_value_s * t1 = data;
+                    // iris in different namespaces are not equal
+                    struct atlas_rdf_term_iri_s * t1 = data;
                     lz_obj_sync(term2, ^(void * data, uint32_t length){
-                        struct atlas_rdf_term_value_s * t2 = data;
+                        struct atlas_rdf_term_iri_s * t2 = data;
                         switch (t2->type) {
                             case IRI:
-                                result = strcmp(t1->value, t2->value) == 0 ? 1 : 0;
+                                result = t1->ns == t2->ns && strcmp(t1->local, t2->local) == 0 ? 1 : 0;
                                 break;
                                 
                             default:
@@ -1102,12 +1538,418 @@ int atlas_rdf_term_cmp_iri_value(atlas_rdf_term_t term,
     if (term && atlas_rdf_term_type(term) == IRI) {
 		__block int result;
 		lz_obj_sync(term, ^(void * data, uint32_t length){			
-			struct atlas_rdf_term_value_s * iri = data;
-			result = strcmp(iri->value, value) == 0 ? 1 : 0;
+			struct atlas_rdf_term_iri_s * iri = data;
+			const __term_namespace * ns = atlas_rdf_term_namespace(iri->ns);
+			result = strncmp(ns->value, value, ns->length) == 0 &&
+			         strcmp(iri->local, value + ns->length) == 0 ? 1 : 0;
 		});
 		return result;		
 	}
 	return 0;
 }
 
+// rank of the type of a term in the order of terms
+static int
+atlas_rdf_term_order_rank(atlas_rdf_term_type_t type) {
+    switch (type) {
+        case BLANK_NODE:        return 0;
+        case IRI:               return 1;
+        case INTEGER_LITERAL:
+        case DECIMAL_LITERAL:
+        case DOUBLE_LITERAL:    return 2;
+        case BOOLEAN_LITERAL:   return 3;
+        case DATETIME_LITERAL:  return 4;
+        case STRING_LITERAL:    return 5;
+        default:                return 6;
+    }
+}
 
+static double
+atlas_rdf_term_numeric_double(struct atlas_rdf_term_s * term) {
+    switch (term->type) {
+        case INTEGER_LITERAL:
+        {
+            mpz_t z = { ((struct atlas_rdf_term_integer_s *)term)->value };
+            return mpz_get_d(z);
+        }
+        case DECIMAL_LITERAL:
+        {
+            mpf_t f = { ((struct atlas_rdf_term_decimal_s *)term)->value };
+            return mpf_get_d(f);
+        }
+        default:
+            return ((struct atlas_rdf_term_double_s *)term)->value;
+    }
+}
+
+// compare the iris (namespace followed by the local name)
+static int
+atlas_rdf_term_order_iri(struct atlas_rdf_term_iri_s * iri1,
+                         struct atlas_rdf_term_iri_s * iri2) {
+    if (iri1->ns == iri2->ns) {
+        return strcmp(iri1->local, iri2->local);
+    }
+    const __term_namespace * ns1 = atlas_rdf_term_namespace(iri1->ns);
+    const __term_namespace * ns2 = atlas_rdf_term_namespace(iri2->ns);
+    size_t i = 0;
+    while (1) {
+        unsigned char c1 = i < ns1->length ? ns1->value[i] : iri1->local[i - ns1->length];
+        unsigned char c2 = i < ns2->length ? ns2->value[i] : iri2->local[i - ns2->length];
+        if (c1 != c2 || c1 == 0) {
+            return c1 - c2;
+        }
+        i++;
+    }
+}
+
+int atlas_rdf_term_order(atlas_rdf_term_t term1,
+                         atlas_rdf_term_t term2) {
+    if (lz_obj_same(term1, term2)) {
+        return 0;
+    }
+    __block int result;
+    lz_obj_sync(term1, ^(void * data1, uint32_t length1){
+        lz_obj_sync(term2, ^(void * data2, uint32_t length2){
+            struct atlas_rdf_term_s * t1 = data1;
+            struct atlas_rdf_term_s * t2 = data2;
+            int rank1 = atlas_rdf_term_order_rank(t1->type);
+            int rank2 = atlas_rdf_term_order_rank(t2->type);
+            if (rank1 != rank2) {
+                result = rank1 - rank2;
+                return;
+            }
+            switch (rank1) {
+                case 1:
+                    result = atlas_rdf_term_order_iri(data1, data2);
+                    break;
+                    
+                case 2:
+                {
+                    // numbers of the same type are compared exactly
+                    if (t1->type == INTEGER_LITERAL && t2->type == INTEGER_LITERAL) {
+                        mpz_t z1 = { ((struct atlas_rdf_term_integer_s *)t1)->value };
+                        mpz_t z2 = { ((struct atlas_rdf_term_integer_s *)t2)->value };
+                        result = mpz_cmp(z1, z2);
+                    } else if (t1->type == DECIMAL_LITERAL && t2->type == DECIMAL_LITERAL) {
+                        mpf_t f1 = { ((struct atlas_rdf_term_decimal_s *)t1)->value };
+                        mpf_t f2 = { ((struct atlas_rdf_term_decimal_s *)t2)->value };
+                        result = mpf_cmp(f1, f2);
+                    } else {
+                        double d1 = atlas_rdf_term_numeric_double(t1);
+                        double d2 = atlas_rdf_term_numeric_double(t2);
+                        result = d1 < d2 ? -1 : (d1 > d2 ? 1 : 0);
+                    }
+                    break;
+                }
+                    
+                case 3:
+                {
+                    int b1 = ((struct atlas_rdf_term_boolean_s *)t1)->value != 0;
+                    int b2 = ((struct atlas_rdf_term_boolean_s *)t2)->value != 0;
+                    result = b1 - b2;
+                    break;
+                }
+                    
+                case 4:
+                {
+                    time_t v1 = ((struct atlas_rdf_term_datetime_s *)t1)->value;
+                    time_t v2 = ((struct atlas_rdf_term_datetime_s *)t2)->value;
+                    result = v1 < v2 ? -1 : (v1 > v2 ? 1 : 0);
+                    break;
+                }
+                    
+                case 5:
+                {
+                    // the value followed by the language tag
+                    const char * v1 = ((struct atlas_rdf_term_value_s *)t1)->value;
+                    const char * v2 = ((struct atlas_rdf_term_value_s *)t2)->value;
+                    result = strcmp(v1, v2);
+                    if (result == 0) {
+                        result = strcmp(v1 + strlen(v1) + 1, v2 + strlen(v2) + 1);
+                    }
+                    break;
+                }
+                    
+                case 6:
+                {
+                    // the value followed by the type
+                    result = strcmp(((struct atlas_rdf_term_value_s *)t1)->value,
+                                    ((struct atlas_rdf_term_value_s *)t2)->value);
+                    if (result == 0) {
+                        result = atlas_rdf_term_order(lz_obj_weak_ref(term1, 0),
+                                                      lz_obj_weak_ref(term2, 0));
+                    }
+                    break;
+                }
+                    
+                default:
+                    result = strcmp(((struct atlas_rdf_term_value_s *)t1)->value,
+                                    ((struct atlas_rdf_term_value_s *)t2)->value);
+            }
+        });
+    });
+    return result;
+}
+
+#pragma mark -
+#pragma mark Hash Functions
+
+#define ATLAS_RDF_TERM_HASH_BASIS 2166136261u
+#define ATLAS_RDF_TERM_HASH_PRIME 16777619u
+
+static inline uint32_t
+atlas_rdf_term_hash_bytes(uint32_t hash, const void * bytes, size_t length) {
+    // FNV-1a over the given bytes
+    const unsigned char * b = bytes;
+    for (size_t i=0; i<length; i++) {
+        hash ^= b[i];
+        hash *= ATLAS_RDF_TERM_HASH_PRIME;
+    }
+    return hash;
+}
+
+uint32_t
+atlas_rdf_term_hash(atlas_rdf_term_t term) {
+    assert(term != 0);
+    __block uint32_t result = ATLAS_RDF_TERM_HASH_BASIS;
+    lz_obj_sync(term, ^(void * data, uint32_t length){
+        
+        struct atlas_rdf_term_s * t = data;
+        
+        switch (t->type) {
+            case IRI:
+            {
+                // equal iris have the same namespace
+                struct atlas_rdf_term_iri_s * iri = data;
+                result = atlas_rdf_term_hash_bytes(result, &(iri->type), sizeof(iri->type));
+                result = atlas_rdf_term_hash_bytes(result, &(iri->ns), sizeof(iri->ns));
+                result = atlas_rdf_term_hash_bytes(result, iri->local, strlen(iri->local));
+                break;
+            }
+                
+            case BLANK_NODE:
+            {
+                struct atlas_rdf_term_value_s * v = data;
+                result = atlas_rdf_term_hash_bytes(result, &(v->type), sizeof(v->type));
+                result = atlas_rdf_term_hash_bytes(result, v->value, strlen(v->value));
+                break;
+            }
+                
+            case STRING_LITERAL:
+            {
+                // the value and the language tag are separated by
+                // the terminating null byte of the value
+                struct atlas_rdf_term_value_s * v = data;
+                int offset = strlen(v->value) + 1;
+                result = atlas_rdf_term_hash_bytes(result, &(v->type), sizeof(v->type));
+                result = atlas_rdf_term_hash_bytes(result, v->value, offset + strlen(v->value + offset));
+                break;
+            }
+                
+            case TYPED_LITERAL:
+            {
+                struct atlas_rdf_term_value_s * v = data;
+                uint32_t type = atlas_rdf_term_hash(lz_obj_weak_ref(term, 0));
+                result = atlas_rdf_term_hash_bytes(result, &(v->type), sizeof(v->type));
+                result = atlas_rdf_term_hash_bytes(result, v->value, strlen(v->value));
+                result = atlas_rdf_term_hash_bytes(result, &type, sizeof(type));
+                break;
+            }
+                
+            case BOOLEAN_LITERAL:
+            {
+                // all values != 0 are equal
+                struct atlas_rdf_term_boolean_s * b = data;
+                uint8_t value = b->value != 0 ? 1 : 0;
+                result = atlas_rdf_term_hash_bytes(result, &(b->type), sizeof(b->type));
+                result = atlas_rdf_term_hash_bytes(result, &value, sizeof(value));
+                break;
+            }
+                
+            case DATETIME_LITERAL:
+            {
+                struct atlas_rdf_term_datetime_s * dt = data;
+                result = atlas_rdf_term_hash_bytes(result, &(dt->type), sizeof(dt->type));
+                result = atlas_rdf_term_hash_bytes(result, &(dt->value), sizeof(dt->value));
+                break;
+            }
+                
+            case DOUBLE_LITERAL:
+            case DECIMAL_LITERAL:
+            case INTEGER_LITERAL:
+            {
+                // numeric literals of different types can be equal,
+                // therefore the hash is calculated on the value as a double
+                double value;
+                if (t->type == DOUBLE_LITERAL) {
+                    value = ((struct atlas_rdf_term_double_s *)data)->value;
+                } else if (t->type == DECIMAL_LITERAL) {
+                    mpf_t f = { ((struct atlas_rdf_term_decimal_s *)data)->value };
+                    value = mpf_get_d(f);
+                } else {
+                    mpz_t z = { ((struct atlas_rdf_term_integer_s *)data)->value };
+                    value = mpz_get_d(z);
+                }
+                
+                // 0.0 and -0.0 are equal
+                if (value == 0) {
+                    value = 0;
+                }
+                
+                atlas_rdf_term_type_t type = NUMERIC_LITERAL;
+                result = atlas_rdf_term_hash_bytes(result, &type, sizeof(type));
+                result = atlas_rdf_term_hash_bytes(result, &value, sizeof(value));
+                break;
+            }
+                
+            default:
+                assert(0);
+                break;
+        }
+    });
+    return result;
+}
+
+
+
+#pragma mark -
+#pragma mark Serialize a RDF Term
+
+void
+atlas_rdf_term_serialize(atlas_rdf_term_t term,
+                         void(^block)(const void * data, uint32_t length)) {
+    assert(term != 0);
+    lz_obj_sync(term, ^(void * data, uint32_t length){
+        struct atlas_rdf_term_s * t = data;
+        if (t->type == IRI) {
+            // the ids of the namespaces are only valid in this
+            // process, so the complete value is written
+            struct atlas_rdf_term_iri_s * iri = data;
+            const __term_namespace * ns = atlas_rdf_term_namespace(iri->ns);
+            size_t local_length = strlen(iri->local);
+            uint32_t size = sizeof(struct atlas_rdf_term_value_s) + ns->length + local_length + 1;
+            struct atlas_rdf_term_value_s * value = malloc(size);
+            assert(value != 0);
+            value->type = IRI;
+            memcpy(value->value, ns->value, ns->length);
+            memcpy(value->value + ns->length, iri->local, local_length + 1);
+            block(value, size);
+            free(value);
+        } else {
+            // the payload of a term does not contain pointers, except the
+            // limbs of integers and decimals, which are stored after the
+            // value and are restored while deserializing
+            block(data, length);
+        }
+    });
+}
+
+static int
+atlas_rdf_term_count_strings(const char * data, uint32_t length) {
+    int result = 0;
+    for (uint32_t i=0; i<length; i++) {
+        if (data[i] == 0) {
+            result++;
+        }
+    }
+    return result;
+}
+
+atlas_rdf_term_t
+atlas_rdf_term_deserialize(const void * data,
+                           uint32_t length,
+                           atlas_rdf_term_t type,
+                           atlas_error_handler err) {
+    
+    if (length < sizeof(struct atlas_rdf_term_s)) {
+        err(1, "Serialized term is too short.");
+        return 0;
+    }
+    
+    // check the size of the payload depending on the type of the term
+    int valid = 0;
+    const struct atlas_rdf_term_s * t = data;
+    switch (t->type) {
+        case IRI:
+        case BLANK_NODE:
+        case TYPED_LITERAL:
+            valid = length > sizeof(struct atlas_rdf_term_value_s) &&
+                    ((const char *)data)[length - 1] == 0;
+            break;
+            
+        case STRING_LITERAL:
+            // value and language tag
+            valid = length > sizeof(struct atlas_rdf_term_value_s) + 1 &&
+                    ((const char *)data)[length - 1] == 0 &&
+                    atlas_rdf_term_count_strings((const char *)data + sizeof(struct atlas_rdf_term_value_s),
+                                                 length - sizeof(struct atlas_rdf_term_value_s)) >= 2;
+            break;
+            
+        case BOOLEAN_LITERAL:
+            valid = length == sizeof(struct atlas_rdf_term_boolean_s);
+            break;
+            
+        case DATETIME_LITERAL:
+            valid = length == sizeof(struct atlas_rdf_term_datetime_s);
+            break;
+            
+        case DOUBLE_LITERAL:
+            valid = length == sizeof(struct atlas_rdf_term_double_s);
+            break;
+            
+        case INTEGER_LITERAL:
+            valid = length >= sizeof(struct atlas_rdf_term_integer_s) &&
+                    length == sizeof(struct atlas_rdf_term_integer_s) +
+                              sizeof(mp_limb_t) * abs(((const struct atlas_rdf_term_integer_s *)data)->value._mp_size);
+            break;
+            
+        case DECIMAL_LITERAL:
+            valid = length >= sizeof(struct atlas_rdf_term_decimal_s) &&
+                    length == sizeof(struct atlas_rdf_term_decimal_s) +
+                              sizeof(mp_limb_t) * (((const struct atlas_rdf_term_decimal_s *)data)->value._mp_prec + 1);
+            break;
+            
+        default:
+            break;
+    }
+    
+    if (!valid) {
+        err(1, "Serialized term is not valid.");
+        return 0;
+    }
+    
+    if (t->type == TYPED_LITERAL && (type == 0 || atlas_rdf_term_type(type) != IRI)) {
+        err(1, "The type of a typed literal is either NULL or not an IRI");
+        return 0;
+    }
+    
+    if (t->type == IRI) {
+        const struct atlas_rdf_term_value_s * iri = data;
+        return atlas_rdf_term_create_iri_trusted(iri->value, strlen(iri->value));
+    }
+    
+    // copy the payload to the allocated memory
+    void * term = malloc(length);
+    assert(term != 0);
+    memcpy(term, data, length);
+    
+    // let the limbs point to the copy
+    if (t->type == INTEGER_LITERAL) {
+        struct atlas_rdf_term_integer_s * integer = term;
+        integer->value._mp_d = (mp_limb_t *)((char *)integer + sizeof(struct atlas_rdf_term_integer_s));
+    } else if (t->type == DECIMAL_LITERAL) {
+        struct atlas_rdf_term_decimal_s * decimal = term;
+        decimal->value._mp_d = (mp_limb_t *)((char *)decimal + sizeof(struct atlas_rdf_term_decimal_s));
+    }
+    
+    // create a lazy object
+    if (t->type == TYPED_LITERAL) {
+        return lz_obj_new(term, length, ^{
+            free(term);
+        }, 1, type);
+    } else {
+        return lz_obj_new(term, length, ^{
+            free(term);
+        }, 0);
+    }
+}
@@ -26,6 +26,44 @@
 
 #include <atlas/rdf/term.h>
 
+#pragma mark -
+#pragma mark Create a RDF Term
+
+/*! Create a RDF Term of type IRI without validating the value.
+ *
+ *  This function is used by parsers, which have already checked
+ *  the syntax. The value does not need to be terminated by 0.
+ */
+atlas_rdf_term_t
+atlas_rdf_term_create_iri_trusted(const char * value,
+                                  int length);
+
+/*! Create a RDF Term of type BLANK_NODE without validating the value.
+ *
+ *  This function is used by parsers, which have already checked
+ *  the syntax. The value does not need to be terminated by 0.
+ */
+atlas_rdf_term_t
+atlas_rdf_term_create_blank_node_trusted(const char * value,
+                                         int length);
+
+#pragma mark -
+#pragma mark Access the Value of a RDF Literal Term
+
+/*! Numeric, temporal or boolean value of a RDF Term.
+ *
+ *  This function reads the value of a literal with one access to the
+ *  term: numeric values are stored in number (approximated), integers
+ *  additionally in integer, datetimes and booleans in integer. Integers,
+ *  which do not fit into 64 bit, are reported as DECIMAL_LITERAL.
+ *
+ *  \return The type of the term.
+ */
+atlas_rdf_term_type_t
+atlas_rdf_term_scalar(atlas_rdf_term_t term,
+                      int64_t * integer,
+                      double * number);
+
 #pragma mark -
 #pragma mark Compare Functions
 
@@ -38,4 +76,71 @@ int
 atlas_rdf_term_cmp_iri_value(atlas_rdf_term_t term,
 							 const char * value);
 
+/*! Order of RDF Terms.
+ *
+ *  Blank nodes are ordered before IRIs, IRIs before literals. Numeric
+ *  literals are ordered by their value, booleans, datetimes and strings
+ *  by their value and the language tag; other literals by the lexical
+ *  value and the type. Terms, which are equal by atlas_rdf_term_eq(),
+ *  have the same position.
+ *
+ *  \return < 0, 0 or > 0 if the first term is ordered before,
+ *          at the same position or after the second term.
+ */
+int
+atlas_rdf_term_order(atlas_rdf_term_t term1,
+                     atlas_rdf_term_t term2);
+
+#pragma mark -
+#pragma mark Hash Functions
+
+/*! Hash value of a RDF Term.
+ *
+ *  This function returns a hash value which is consistent with
+ *  atlas_rdf_term_eq(): terms which are equal have the same hash
+ *  value (e.g., the integer 1 and the double 1.0).
+ */
+uint32_t
+atlas_rdf_term_hash(atlas_rdf_term_t term);
+
+#pragma mark -
+#pragma mark Representation of a RDF Term in N-Triples
+
+/*! Representation of a RDF Term in N-Triples.
+ *
+ *  Unlike atlas_rdf_term_repr(), the characters of literals and IRIs
+ *  are escaped and literals of the types, which are represented
+ *  directly (e.g., INTEGER_LITERAL), are written as typed literals.
+ *  The block is called with consecutive pieces of the representation.
+ */
+void
+atlas_rdf_term_ntriples(atlas_rdf_term_t term,
+                        void(^append)(const char * data, size_t length));
+
+#pragma mark -
+#pragma mark Serialize a RDF Term
+
+/*! Serialize a RDF Term.
+ *
+ *  This function calls the block with a representation of the term,
+ *  which does not depend on the address of the term in memory. The
+ *  type of a typed literal is not part of the representation.
+ */
+void
+atlas_rdf_term_serialize(atlas_rdf_term_t term,
+                         void(^block)(const void * data, uint32_t length));
+
+/*! Create a RDF Term from its serialized representation.
+ *
+ *  \param type The type of a typed literal (ignored for other terms).
+ *
+ *  \return NULL on failure (the data is not a valid representation)
+ *          or a RDF Term with a reference count of 1.
+ */
+atlas_rdf_term_t
+atlas_rdf_term_deserialize(const void * data,
+                           uint32_t length,
+                           atlas_rdf_term_t type,
+                           atlas_error_handler err);
+
 #endif // _ATLAS_RDF_TERM_IMPL_H_
@@ -22,6 +22,8 @@
  */
 
 #include "atlas_rdf_term_set_impl.h"
+#include "atlas_rdf_term_dict_impl.h"
+#include "atlas_base_impl.h"
 
 #include <stdlib.h>
 #include <assert.h>
@@ -253,6 +255,129 @@ atlas_rdf_term_set_create_difference(atlas_rdf_term_set_t set1,
 	return result;	
 }
 
+atlas_rdf_term_set_t
+atlas_rdf_term_set_create_union_n(int number_of_sets,
+                                  atlas_rdf_term_set_t * sets,
+                                  atlas_error_handler err) {
+    assert(number_of_sets == 0 || sets != 0);
+    
+    // the union of a single set is the set itself
+    if (number_of_sets == 1) {
+        assert(sets[0] != 0);
+        return lz_retain(sets[0]);
+    }
+    
+    // number of terms in the union, if all sets are disjoint
+    int num_terms = 0;
+    for (int i=0; i<number_of_sets; i++) {
+        assert(sets[i] != 0);
+        num_terms += atlas_rdf_term_set_length(sets[i]);
+    }
+    
+    // insert the terms of all sets into one hash table,
+    // which ignores terms already contained in it
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(num_terms);
+    for (int i=0; i<number_of_sets; i++) {
+        int length = atlas_rdf_term_set_length(sets[i]);
+        for (int j=0; j<length; j++) {
+            atlas_rdf_term_dict_insert(dict, lz_obj_weak_ref(sets[i], j));
+        }
+    }
+    
+    // create a lazy object
+    atlas_rdf_term_set_t result = lz_obj_new_v(0, 0, ^{},
+                                               atlas_rdf_term_dict_length(dict),
+                                               atlas_rdf_term_dict_terms(dict));
+    
+    atlas_rdf_term_dict_free(dict);
+    
+    return result;
+}
+
+atlas_rdf_term_set_t
+atlas_rdf_term_set_create_intersection_n(int number_of_sets,
+                                         atlas_rdf_term_set_t * sets,
+                                         atlas_error_handler err) {
+    assert(number_of_sets == 0 || sets != 0);
+    
+    if (number_of_sets == 0) {
+        return lz_obj_new_v(0, 0, ^{}, 0, 0);
+    }
+    
+    // the intersection of a single set is the set itself
+    if (number_of_sets == 1) {
+        assert(sets[0] != 0);
+        return lz_retain(sets[0]);
+    }
+    
+    // order the sets by their length (smallest first)
+    atlas_rdf_term_set_t * ordered = malloc(sizeof(atlas_rdf_term_set_t) * number_of_sets);
+    int * lengths = malloc(sizeof(int) * number_of_sets);
+    assert(ordered != 0);
+    assert(lengths != 0);
+    for (int i=0; i<number_of_sets; i++) {
+        assert(sets[i] != 0);
+        atlas_rdf_term_set_t set = sets[i];
+        int length = atlas_rdf_term_set_length(set);
+        int j = i;
+        while (j > 0 && lengths[j - 1] > length) {
+            ordered[j] = ordered[j - 1];
+            lengths[j] = lengths[j - 1];
+            j--;
+        }
+        ordered[j] = set;
+        lengths[j] = length;
+    }
+    
+    // the terms of the smallest set are the candidates
+    // for the intersection
+    atlas_rdf_term_dict_t dict = atlas_rdf_term_dict_create(lengths[0]);
+    for (int i=0; i<lengths[0]; i++) {
+        atlas_rdf_term_dict_insert(dict, lz_obj_weak_ref(ordered[0], i));
+    }
+    int num_candidates = atlas_rdf_term_dict_length(dict);
+    
+    // index of the last set in which a candidate has been found
+    int * found = calloc(num_candidates + 1, sizeof(int));
+    assert(found != 0);
+    
+    // probe the remaining sets (in ascending order of their length)
+    // and stop as soon as no candidate is left
+    int num_alive = num_candidates;
+    for (int i=1; i<number_of_sets && num_alive > 0; i++) {
+        num_alive = 0;
+        for (int j=0; j<lengths[i]; j++) {
+            int id = atlas_rdf_term_dict_lookup(dict, lz_obj_weak_ref(ordered[i], j));
+            if (id != -1 && found[id] == i - 1) {
+                found[id] = i;
+                num_alive++;
+            }
+        }
+    }
+    
+    // collect the candidates which have been found in all sets
+    atlas_rdf_term_t * candidates = atlas_rdf_term_dict_terms(dict);
+    atlas_rdf_term_t * set = malloc(sizeof(atlas_rdf_term_t) * (num_candidates + 1));
+    assert(set != 0);
+    int num_set = 0;
+    for (int id=0; id<num_candidates; id++) {
+        if (found[id] == number_of_sets - 1) {
+            set[num_set++] = candidates[id];
+        }
+    }
+    
+    // create a lazy object
+    atlas_rdf_term_set_t result = lz_obj_new_v(0, 0, ^{}, num_set, set);
+    
+    free(set);
+    free(found);
+    free(lengths);
+    free(ordered);
+    atlas_rdf_term_dict_free(dict);
+    
+    return result;
+}
+
 #pragma mark -
 #pragma mark Access Details of a RDF Term Set
 
@@ -264,11 +389,43 @@ atlas_rdf_term_set_length(atlas_rdf_term_set_t set) {
 void
 atlas_rdf_term_set_apply(atlas_rdf_term_set_t set,
                          void(^iterator)(atlas_rdf_term_t term)) {
-    dispatch_apply(atlas_rdf_term_set_length(set),
-                   dispatch_get_global_queue(0, 0),
-                   ^(size_t i){
-        iterator(lz_obj_weak_ref(set, i));
-    });
+    atlas_apply_chunked(atlas_rdf_term_set_length(set), 0, 0,
+                        ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            iterator(lz_obj_weak_ref(set, i));
+        }
+    }, 0);
+}
+
+void
+atlas_rdf_term_set_apply_chunked(atlas_rdf_term_set_t set,
+                                 int grain_size,
+                                 void *(^init)(void),
+                                 void(^iterator)(void * state, atlas_rdf_term_t term),
+                                 void(^finish)(void * state)) {
+    assert(set != 0);
+    assert(grain_size >= 0);
+    atlas_apply_chunked(atlas_rdf_term_set_length(set), grain_size, init,
+                        ^(void * state, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            iterator(state, lz_obj_weak_ref(set, i));
+        }
+    }, finish);
+}
+
+void *
+atlas_rdf_term_set_reduce(atlas_rdf_term_set_t set,
+                          void *(^init)(void),
+                          void *(^accumulate)(void * acc, atlas_rdf_term_t term),
+                          void *(^combine)(void * acc1, void * acc2)) {
+    assert(set != 0);
+    return atlas_reduce_chunked(atlas_rdf_term_set_length(set), 0, init,
+                                ^(void * acc, size_t begin, size_t end){
+        for (size_t i=begin; i<end; i++) {
+            acc = accumulate(acc, lz_obj_weak_ref(set, i));
+        }
+        return acc;
+    }, combine);
 }
 
 void
@@ -0,0 +1,1260 @@
+/*
+ *  atlas_rdf_turtle_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atlas_rdf_turtle_impl.h"
+#include "atlas_rdf_term_impl.h"
+#include "atlas_rdf_term_cache_impl.h"
+#include "atlas_rdf_graph_builder_impl.h"
+#include "atlas_rdf_ntriples_impl.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#pragma mark -
+#pragma mark Data Structure
+
+#define RDF_NS "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
+
+typedef struct {
+    char * data;
+    size_t length;
+    size_t capacity;
+} __turtle_buffer;
+
+typedef struct {
+    char * name;
+    size_t name_length;
+    char * iri;
+    size_t iri_length;
+} __turtle_prefix;
+
+typedef struct {
+    atlas_rdf_graph_builder_t builder;
+    atlas_rdf_term_cache_t cache;
+    
+    const char * p;
+    const char * end;
+    
+    // number of the current line and the
+    // description of a syntax error
+    int line;
+    const char * error;
+    
+    // the base IRI and the prefixes
+    char * base;
+    int num_prefixes;
+    int max_prefixes;
+    __turtle_prefix * prefixes;
+    
+    // the unescaped characters of an IRI reference or a label,
+    // the resolved IRI (starting with '<', which makes it a key
+    // of the term cache) and the value of a literal
+    __turtle_buffer ref;
+    __turtle_buffer iri;
+    __turtle_buffer value;
+    
+    // number of blank nodes without a label
+    int num_blank_nodes;
+    
+    // ids of rdf:type, rdf:first, rdf:rest and rdf:nil
+    int rdf_type;
+    int rdf_first;
+    int rdf_rest;
+    int rdf_nil;
+} __turtle_parser;
+
+#pragma mark -
+#pragma mark Buffer
+
+static void
+atlas_rdf_turtle_reserve(__turtle_buffer * buffer, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        buffer->capacity = (buffer->length + length) * 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        assert(buffer->data != 0);
+    }
+}
+
+static void
+atlas_rdf_turtle_append(__turtle_buffer * buffer, const char * data, size_t length) {
+    atlas_rdf_turtle_reserve(buffer, length);
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+}
+
+static void
+atlas_rdf_turtle_append_char(__turtle_buffer * buffer, char c) {
+    atlas_rdf_turtle_reserve(buffer, 1);
+    buffer->data[buffer->length++] = c;
+}
+
+#pragma mark -
+#pragma mark Characters
+
+static int
+atlas_rdf_turtle_is_base_char(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+static int
+atlas_rdf_turtle_is_name_char(unsigned char c) {
+    return atlas_rdf_turtle_is_base_char(c) || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+static int
+atlas_rdf_turtle_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static int
+atlas_rdf_turtle_is_hex(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// skip white space and comments
+static void
+atlas_rdf_turtle_skip(__turtle_parser * parser) {
+    while (parser->p < parser->end) {
+        char c = *parser->p;
+        if (c == ' ' || c == '\t' || c == '\r') {
+            parser->p++;
+        } else if (c == '\n') {
+            parser->line++;
+            parser->p++;
+        } else if (c == '#') {
+            while (parser->p < parser->end && *parser->p != '\n') {
+                parser->p++;
+            }
+        } else {
+            break;
+        }
+    }
+}
+
+// check if the keyword (not followed by a name character) is next
+static int
+atlas_rdf_turtle_keyword(__turtle_parser * parser, const char * keyword, int ignore_case) {
+    size_t length = strlen(keyword);
+    if ((size_t)(parser->end - parser->p) < length) {
+        return 0;
+    }
+    if (ignore_case ? strncasecmp(parser->p, keyword, length) != 0 : strncmp(parser->p, keyword, length) != 0) {
+        return 0;
+    }
+    if (parser->p + length < parser->end) {
+        char c = parser->p[length];
+        if (atlas_rdf_turtle_is_name_char(c) || c == ':' || c == '.') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int
+atlas_rdf_turtle_expect(__turtle_parser * parser, char c, const char * error) {
+    atlas_rdf_turtle_skip(parser);
+    if (parser->p == parser->end || *parser->p != c) {
+        parser->error = error;
+        return 0;
+    }
+    parser->p++;
+    return 1;
+}
+
+#pragma mark -
+#pragma mark Resolve IRIs
+
+static int
+atlas_rdf_turtle_has_scheme(const char * iri, size_t length) {
+    if (length == 0 || !((iri[0] >= 'a' && iri[0] <= 'z') || (iri[0] >= 'A' && iri[0] <= 'Z'))) {
+        return 0;
+    }
+    for (size_t i=1; i<length; i++) {
+        char c = iri[i];
+        if (c == ':') {
+            return 1;
+        }
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+              (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.')) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// remove the segments "." and ".." from a path (RFC 3986, 5.2.4),
+// returns the new length of the path
+static size_t
+atlas_rdf_turtle_remove_dots(char * path, size_t length) {
+    char * in = path;
+    char * end = path + length;
+    char * out = path;
+    
+    while (in < end) {
+        size_t n = end - in;
+        if (n >= 3 && memcmp(in, "../", 3) == 0) {
+            in += 3;
+        } else if (n >= 2 && memcmp(in, "./", 2) == 0) {
+            in += 2;
+        } else if (n >= 3 && memcmp(in, "/./", 3) == 0) {
+            in += 2;
+        } else if (n == 2 && memcmp(in, "/.", 2) == 0) {
+            in += 1;
+            *in = '/';
+        } else if ((n >= 4 && memcmp(in, "/../", 4) == 0) ||
+                   (n == 3 && memcmp(in, "/..", 3) == 0)) {
+            if (n == 3) {
+                in += 2;
+                *in = '/';
+            } else {
+                in += 3;
+            }
+            while (out > path && out[-1] != '/') {
+                out--;
+            }
+            if (out > path) {
+                out--;
+            }
+        } else if ((n == 1 && in[0] == '.') || (n == 2 && in[0] == '.' && in[1] == '.')) {
+            in = end;
+        } else {
+            do {
+                *out++ = *in++;
+            } while (in < end && *in != '/');
+        }
+    }
+    return out - path;
+}
+
+// resolve the reference against the base IRI (RFC 3986, 5.2.2)
+// and store the result in the IRI buffer
+static int
+atlas_rdf_turtle_resolve(__turtle_parser * parser, const char * ref, size_t length) {
+    __turtle_buffer * iri = &parser->iri;
+    iri->length = 0;
+    atlas_rdf_turtle_append_char(iri, '<');
+    
+    if (atlas_rdf_turtle_has_scheme(ref, length)) {
+        atlas_rdf_turtle_append(iri, ref, length);
+        return 1;
+    }
+    
+    const char * base = parser->base;
+    if (base == 0) {
+        parser->error = "Relative IRI without a base IRI.";
+        return 0;
+    }
+    
+    // the components of the base IRI
+    size_t base_length = strlen(base);
+    size_t scheme_end = strchr(base, ':') - base + 1;
+    size_t authority_end = scheme_end;
+    if (base_length - scheme_end >= 2 && base[scheme_end] == '/' && base[scheme_end + 1] == '/') {
+        authority_end += 2;
+        while (authority_end < base_length && base[authority_end] != '/' &&
+               base[authority_end] != '?' && base[authority_end] != '#') {
+            authority_end++;
+        }
+    }
+    size_t path_end = authority_end;
+    while (path_end < base_length && base[path_end] != '?' && base[path_end] != '#') {
+        path_end++;
+    }
+    size_t query_end = path_end;
+    while (query_end < base_length && base[query_end] != '#') {
+        query_end++;
+    }
+    
+    if (length >= 2 && ref[0] == '/' && ref[1] == '/') {
+        atlas_rdf_turtle_append(iri, base, scheme_end);
+        atlas_rdf_turtle_append(iri, ref, length);
+    } else if (length == 0 || ref[0] == '#') {
+        atlas_rdf_turtle_append(iri, base, query_end);
+        atlas_rdf_turtle_append(iri, ref, length);
+    } else if (ref[0] == '?') {
+        atlas_rdf_turtle_append(iri, base, path_end);
+        atlas_rdf_turtle_append(iri, ref, length);
+    } else {
+        atlas_rdf_turtle_append(iri, base, authority_end);
+        size_t path_begin = iri->length;
+        
+        // merge the paths
+        if (ref[0] != '/') {
+            size_t slash = path_end;
+            while (slash > authority_end && base[slash - 1] != '/') {
+                slash--;
+            }
+            if (slash > authority_end) {
+                atlas_rdf_turtle_append(iri, base + authority_end, slash - authority_end);
+            } else if (authority_end > scheme_end) {
+                atlas_rdf_turtle_append_char(iri, '/');
+            }
+        }
+        atlas_rdf_turtle_append(iri, ref, length);
+        
+        // the query and the fragment of the reference are kept
+        size_t path_length = 0;
+        while (path_begin + path_length < iri->length &&
+               iri->data[path_begin + path_length] != '?' &&
+               iri->data[path_begin + path_length] != '#') {
+            path_length++;
+        }
+        size_t rest = iri->length - path_begin - path_length;
+        size_t new_length = atlas_rdf_turtle_remove_dots(iri->data + path_begin, path_length);
+        memmove(iri->data + path_begin + new_length, iri->data + path_begin + path_length, rest);
+        iri->length = path_begin + new_length + rest;
+    }
+    return 1;
+}
+
+#pragma mark -
+#pragma mark Terms
+
+// get the term for the IRI in the IRI buffer
+static int
+atlas_rdf_turtle_iri_term(__turtle_parser * parser, atlas_rdf_term_t * term) {
+    __turtle_buffer * iri = &parser->iri;
+    int id = atlas_rdf_term_cache_lookup(parser->cache, iri->data, iri->length, term);
+    if (id < 0) {
+        atlas_rdf_term_t t = atlas_rdf_term_create_iri_trusted(iri->data + 1, iri->length - 1);
+        if (term) {
+            *term = t;
+        }
+        id = atlas_rdf_term_cache_insert(parser->cache, iri->data, iri->length, t);
+    }
+    return id;
+}
+
+static int
+atlas_rdf_turtle_constant(__turtle_parser * parser, int * id, const char * value) {
+    if (*id < 0) {
+        parser->iri.length = 0;
+        atlas_rdf_turtle_append_char(&parser->iri, '<');
+        atlas_rdf_turtle_append(&parser->iri, value, strlen(value));
+        *id = atlas_rdf_turtle_iri_term(parser, 0);
+    }
+    return *id;
+}
+
+// create a blank node, which has no label
+static int
+atlas_rdf_turtle_new_blank_node(__turtle_parser * parser) {
+    char label[32];
+    int length = snprintf(label, 32, "genid%d", ++parser->num_blank_nodes);
+    atlas_rdf_term_t term = atlas_rdf_term_create_blank_node_trusted(label, length);
+    int id = atlas_rdf_graph_builder_add_term(parser->builder, term);
+    lz_release(term);
+    return id;
+}
+
+static void
+atlas_rdf_turtle_add(__turtle_parser * parser, int subject, int predicate, int object) {
+    atlas_rdf_graph_builder_add_term_ids(parser->builder, subject, predicate, object);
+}
+
+#pragma mark -
+#pragma mark Parse IRIs
+
+// <iri>, the resolved IRI is stored in the IRI buffer
+static int
+atlas_rdf_turtle_parse_iriref(__turtle_parser * parser) {
+    const char * p = parser->p + 1;
+    const char * begin = p;
+    int escaped = 0;
+    
+    while (p < parser->end && *p != '>') {
+        unsigned char c = *p;
+        if (c <= 0x20 || c == '<' || c == '"' || c == '{' || c == '}' ||
+            c == '|' || c == '^' || c == '`') {
+            parser->error = "Invalid character in IRI.";
+            return 0;
+        }
+        if (c == '\\') {
+            if (p + 1 == parser->end || (p[1] != 'u' && p[1] != 'U')) {
+                parser->error = "Invalid escape sequence in IRI.";
+                return 0;
+            }
+            escaped = 1;
+        }
+        p++;
+    }
+    if (p == parser->end) {
+        parser->error = "IRI is not terminated.";
+        return 0;
+    }
+    parser->p = p + 1;
+    
+    if (escaped) {
+        __turtle_buffer * ref = &parser->ref;
+        ref->length = 0;
+        atlas_rdf_turtle_reserve(ref, p - begin);
+        char * end = atlas_rdf_ntriples_unescape_into(ref->data, begin, p);
+        if (end == 0) {
+            parser->error = "Invalid escape sequence in IRI.";
+            return 0;
+        }
+        ref->length = end - ref->data;
+        return atlas_rdf_turtle_resolve(parser, ref->data, ref->length);
+    }
+    return atlas_rdf_turtle_resolve(parser, begin, p - begin);
+}
+
+// prefix: or prefix:local, returns the prefix or NULL
+static __turtle_prefix *
+atlas_rdf_turtle_parse_prefix(__turtle_parser * parser) {
+    const char * begin = parser->p;
+    const char * p = begin;
+    
+    if (p < parser->end && atlas_rdf_turtle_is_base_char(*p)) {
+        const char * last = p;
+        while (p < parser->end && (atlas_rdf_turtle_is_name_char(*p) || *p == '.')) {
+            if (*p != '.') {
+                last = p;
+            }
+            p++;
+        }
+        p = last + 1;
+    }
+    if (p == parser->end || *p != ':') {
+        parser->error = "Invalid prefixed name.";
+        return 0;
+    }
+    parser->p = p + 1;
+    
+    size_t length = p - begin;
+    for (int i=parser->num_prefixes-1; i>=0; i--) {
+        __turtle_prefix * prefix = &parser->prefixes[i];
+        if (prefix->name_length == length && memcmp(prefix->name, begin, length) == 0) {
+            return prefix;
+        }
+    }
+    parser->error = "Prefix is not defined.";
+    return 0;
+}
+
+// prefix:local, the IRI is stored in the IRI buffer
+static int
+atlas_rdf_turtle_parse_prefixed_name(__turtle_parser * parser) {
+    __turtle_prefix * prefix = atlas_rdf_turtle_parse_prefix(parser);
+    if (prefix == 0) {
+        return 0;
+    }
+    
+    __turtle_buffer * iri = &parser->iri;
+    iri->length = 0;
+    atlas_rdf_turtle_append_char(iri, '<');
+    atlas_rdf_turtle_append(iri, prefix->iri, prefix->iri_length);
+    
+    // the local name does not end with a dot, which is not escaped
+    const char * p = parser->p;
+    const char * last = p;
+    size_t last_length = iri->length;
+    
+    if (p < parser->end && (atlas_rdf_turtle_is_name_char(*p) || *p == ':' || *p == '%' || *p == '\\')) {
+        while (p < parser->end) {
+            char c = *p;
+            if (atlas_rdf_turtle_is_name_char(c) || c == ':' || c == '.') {
+                atlas_rdf_turtle_append_char(iri, c);
+                p++;
+            } else if (c == '%') {
+                if (parser->end - p < 3 || !atlas_rdf_turtle_is_hex(p[1]) || !atlas_rdf_turtle_is_hex(p[2])) {
+                    parser->error = "Invalid percent encoding in local name.";
+                    return 0;
+                }
+                atlas_rdf_turtle_append(iri, p, 3);
+                p += 3;
+            } else if (c == '\\') {
+                if (p + 1 == parser->end || !strchr("_~.-!$&'()*+,;=/?#@%", p[1]) || p[1] == 0) {
+                    parser->error = "Invalid escape sequence in local name.";
+                    return 0;
+                }
+                atlas_rdf_turtle_append_char(iri, p[1]);
+                p += 2;
+            } else {
+                break;
+            }
+            if (c != '.') {
+                last = p;
+                last_length = iri->length;
+            }
+        }
+    }
+    parser->p = last;
+    iri->length = last_length;
+    return 1;
+}
+
+static int
+atlas_rdf_turtle_parse_iri(__turtle_parser * parser, atlas_rdf_term_t * term) {
+    int result;
+    if (*parser->p == '<') {
+        result = atlas_rdf_turtle_parse_iriref(parser);
+    } else {
+        result = atlas_rdf_turtle_parse_prefixed_name(parser);
+    }
+    if (!result) {
+        return -1;
+    }
+    return atlas_rdf_turtle_iri_term(parser, term);
+}
+
+#pragma mark -
+#pragma mark Parse Blank Nodes
+
+// _:label
+static int
+atlas_rdf_turtle_parse_blank_node(__turtle_parser * parser) {
+    const char * begin = parser->p + 2;
+    const char * p = begin;
+    
+    if (parser->end - parser->p < 3 || parser->p[1] != ':' ||
+        !(atlas_rdf_turtle_is_name_char(*p) || atlas_rdf_turtle_is_digit(*p))) {
+        parser->error = "Invalid blank node.";
+        return -1;
+    }
+    
+    const char * last = p;
+    while (p < parser->end && (atlas_rdf_turtle_is_name_char(*p) || *p == '.')) {
+        if (*p != '.') {
+            last = p;
+        }
+        p++;
+    }
+    parser->p = last + 1;
+    
+    // the key is the label with a leading '_'
+    __turtle_buffer * ref = &parser->ref;
+    ref->length = 0;
+    atlas_rdf_turtle_append_char(ref, '_');
+    atlas_rdf_turtle_append(ref, begin, parser->p - begin);
+    
+    int id = atlas_rdf_term_cache_lookup(parser->cache, ref->data, ref->length, 0);
+    if (id < 0) {
+        // labels starting with "genid" are renamed to avoid a
+        // conflict with the blank nodes without a label
+        atlas_rdf_term_t term;
+        if (ref->length > 5 && memcmp(ref->data + 1, "genid", 5) == 0) {
+            char * label;
+            int length = asprintf(&label, "genid-%.*s", (int)(ref->length - 1), ref->data + 1);
+            term = atlas_rdf_term_create_blank_node_trusted(label, length);
+            free(label);
+        } else {
+            term = atlas_rdf_term_create_blank_node_trusted(ref->data + 1, ref->length - 1);
+        }
+        id = atlas_rdf_term_cache_insert(parser->cache, ref->data, ref->length, term);
+    }
+    return id;
+}
+
+#pragma mark -
+#pragma mark Parse Literals
+
+// "...", '...', """...""" or '''...''', the value is stored in
+// the value buffer, starting with '"' and terminated by 0
+static int
+atlas_rdf_turtle_parse_string(__turtle_parser * parser) {
+    char quote = *parser->p;
+    const char * p = parser->p;
+    const char * begin;
+    const char * end;
+    
+    if (parser->end - p >= 3 && p[1] == quote && p[2] == quote) {
+        p += 3;
+        begin = p;
+        while (1) {
+            if (p >= parser->end) {
+                parser->error = "String is not terminated.";
+                return 0;
+            }
+            if (*p == '\\') {
+                p += 2;
+                continue;
+            }
+            if (*p == quote && parser->end - p >= 3 && p[1] == quote && p[2] == quote) {
+                break;
+            }
+            if (*p == '\n') {
+                parser->line++;
+            }
+            p++;
+        }
+        end = p;
+        p += 3;
+    } else {
+        p += 1;
+        begin = p;
+        while (p < parser->end && *p != quote) {
+            if (*p == '\n' || *p == '\r') {
+                break;
+            }
+            if (*p == '\\') {
+                p++;
+            }
+            p++;
+        }
+        if (p >= parser->end || *p != quote) {
+            parser->error = "String is not terminated.";
+            return 0;
+        }
+        end = p;
+        p += 1;
+    }
+    parser->p = p;
+    
+    __turtle_buffer * value = &parser->value;
+    value->length = 0;
+    atlas_rdf_turtle_reserve(value, end - begin + 2);
+    value->data[0] = '"';
+    char * out = atlas_rdf_ntriples_unescape_into(value->data + 1, begin, end);
+    if (out == 0) {
+        parser->error = "Invalid escape sequence in string.";
+        return 0;
+    }
+    *out = 0;
+    value->length = out - value->data + 1;
+    return 1;
+}
+
+// "value", "value"@lang or "value"^^type
+static int
+atlas_rdf_turtle_parse_rdf_literal(__turtle_parser * parser) {
+    if (!atlas_rdf_turtle_parse_string(parser)) {
+        return -1;
+    }
+    
+    __turtle_buffer * value = &parser->value;
+    size_t value_length = value->length;
+    atlas_rdf_term_t type = 0;
+    const char * lang = 0;
+    
+    // the key is the value followed by the language tag or the type
+    if (parser->p < parser->end && *parser->p == '@') {
+        const char * begin = ++parser->p;
+        while (parser->p < parser->end) {
+            char c = *parser->p;
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '-')) {
+                break;
+            }
+            parser->p++;
+        }
+        if (parser->p == begin || !((*begin >= 'a' && *begin <= 'z') || (*begin >= 'A' && *begin <= 'Z'))) {
+            parser->error = "Invalid language tag.";
+            return -1;
+        }
+        atlas_rdf_turtle_append_char(value, '@');
+        atlas_rdf_turtle_append(value, begin, parser->p - begin);
+        atlas_rdf_turtle_append_char(value, 0);
+        lang = value->data + value_length + 1;
+    } else if (parser->end - parser->p >= 2 && parser->p[0] == '^' && parser->p[1] == '^') {
+        parser->p += 2;
+        if (parser->p == parser->end) {
+            parser->error = "Type of literal is not an IRI.";
+            return -1;
+        }
+        int type_id = atlas_rdf_turtle_parse_iri(parser, &type);
+        if (type_id < 0) {
+            return -1;
+        }
+        atlas_rdf_turtle_append_char(value, '^');
+        atlas_rdf_turtle_append(value, (const char *)&type_id, sizeof(int));
+    }
+    
+    int id = atlas_rdf_term_cache_lookup(parser->cache, value->data, value->length, 0);
+    if (id >= 0) {
+        return id;
+    }
+    
+    __block int failed = 0;
+    atlas_error_handler err = ^(int e, const char * msg){
+        failed = 1;
+    };
+    
+    atlas_rdf_term_t term;
+    if (type) {
+        term = atlas_rdf_term_create_typed(value->data + 1, type, err);
+    } else {
+        term = atlas_rdf_term_create_string(value->data + 1, lang, err);
+    }
+    if (term == 0 || failed) {
+        if (term) {
+            lz_release(term);
+        }
+        parser->error = lang ? "Invalid language tag." : "Invalid literal.";
+        return -1;
+    }
+    return atlas_rdf_term_cache_insert(parser->cache, value->data, value->length, term);
+}
+
+// integer, decimal or double
+static int
+atlas_rdf_turtle_parse_numeric_literal(__turtle_parser * parser) {
+    const char * p = parser->p;
+    const char * begin = p;
+    char kind = 'i';
+    
+    if (*p == '+' || *p == '-') {
+        p++;
+    }
+    const char * digits = p;
+    while (p < parser->end && atlas_rdf_turtle_is_digit(*p)) {
+        p++;
+    }
+    int num_digits = p - digits;
+    
+    // a dot is only a part of the number, if it is followed
+    // by digits or an exponent
+    if (p < parser->end && *p == '.' && p + 1 < parser->end &&
+        (atlas_rdf_turtle_is_digit(p[1]) || ((p[1] == 'e' || p[1] == 'E') && num_digits > 0))) {
+        kind = 'd';
+        p++;
+        while (p < parser->end && atlas_rdf_turtle_is_digit(*p)) {
+            p++;
+            num_digits++;
+        }
+    }
+    if (num_digits == 0) {
+        parser->error = "Invalid number.";
+        return -1;
+    }
+    if (p < parser->end && (*p == 'e' || *p == 'E')) {
+        kind = 'f';
+        p++;
+        if (p < parser->end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        if (p == parser->end || !atlas_rdf_turtle_is_digit(*p)) {
+            parser->error = "Invalid exponent.";
+            return -1;
+        }
+        while (p < parser->end && atlas_rdf_turtle_is_digit(*p)) {
+            p++;
+        }
+    }
+    parser->p = p;
+    
+    // the key is the kind followed by the number, the
+    // sign '+' is not accepted by GMP
+    if (*begin == '+') {
+        begin++;
+    }
+    __turtle_buffer * value = &parser->value;
+    value->length = 0;
+    atlas_rdf_turtle_append_char(value, kind);
+    atlas_rdf_turtle_append(value, begin, p - begin);
+    atlas_rdf_turtle_append_char(value, 0);
+    
+    int id = atlas_rdf_term_cache_lookup(parser->cache, value->data, value->length, 0);
+    if (id >= 0) {
+        return id;
+    }
+    
+    atlas_error_handler err = ^(int e, const char * msg){};
+    atlas_rdf_term_t term = 0;
+    const char * number = value->data + 1;
+    if (kind == 'i') {
+        mpz_t i;
+        mpz_init_set_str(i, number, 10);
+        term = atlas_rdf_term_create_integer(i, err);
+        mpz_clear(i);
+    } else if (kind == 'd') {
+        mpf_t f;
+        mpf_init_set_str(f, number, 10);
+        term = atlas_rdf_term_create_decimal(f, err);
+        mpf_clear(f);
+    } else {
+        term = atlas_rdf_term_create_double(strtod(number, 0), err);
+    }
+    if (term == 0) {
+        parser->error = "Invalid number.";
+        return -1;
+    }
+    return atlas_rdf_term_cache_insert(parser->cache, value->data, value->length, term);
+}
+
+// true or false, the key is the keyword with a leading 'b'
+static int
+atlas_rdf_turtle_boolean(__turtle_parser * parser, int b) {
+    const char * key = b ? "btrue" : "bfalse";
+    size_t length = strlen(key);
+    parser->p += strlen(key + 1);
+    
+    int id = atlas_rdf_term_cache_lookup(parser->cache, key, length, 0);
+    if (id < 0) {
+        atlas_rdf_term_t term = atlas_rdf_term_create_boolean(b, ^(int e, const char * msg){});
+        id = atlas_rdf_term_cache_insert(parser->cache, key, length, term);
+    }
+    return id;
+}
+
+#pragma mark -
+#pragma mark Parse Triples
+
+static int
+atlas_rdf_turtle_parse_object(__turtle_parser * parser);
+
+static int
+atlas_rdf_turtle_parse_predicate_object_list(__turtle_parser * parser, int subject);
+
+// [ predicate object ; ... ]
+static int
+atlas_rdf_turtle_parse_blank_node_property_list(__turtle_parser * parser, int * empty) {
+    parser->p++;
+    int node = atlas_rdf_turtle_new_blank_node(parser);
+    
+    atlas_rdf_turtle_skip(parser);
+    if (parser->p < parser->end && *parser->p == ']') {
+        parser->p++;
+        if (empty) {
+            *empty = 1;
+        }
+        return node;
+    }
+    if (empty) {
+        *empty = 0;
+    }
+    
+    if (!atlas_rdf_turtle_parse_predicate_object_list(parser, node) ||
+        !atlas_rdf_turtle_expect(parser, ']', "Blank node property list is not terminated.")) {
+        return -1;
+    }
+    return node;
+}
+
+// ( object ... )
+static int
+atlas_rdf_turtle_parse_collection(__turtle_parser * parser) {
+    parser->p++;
+    
+    int first = atlas_rdf_turtle_constant(parser, &parser->rdf_first, RDF_NS "first");
+    int rest = atlas_rdf_turtle_constant(parser, &parser->rdf_rest, RDF_NS "rest");
+    int nil = atlas_rdf_turtle_constant(parser, &parser->rdf_nil, RDF_NS "nil");
+    
+    int head = nil;
+    int node = -1;
+    while (1) {
+        atlas_rdf_turtle_skip(parser);
+        if (parser->p == parser->end) {
+            parser->error = "Collection is not terminated.";
+            return -1;
+        }
+        if (*parser->p == ')') {
+            parser->p++;
+            break;
+        }
+        
+        int next = atlas_rdf_turtle_new_blank_node(parser);
+        if (node < 0) {
+            head = next;
+        } else {
+            atlas_rdf_turtle_add(parser, node, rest, next);
+        }
+        node = next;
+        
+        int object = atlas_rdf_turtle_parse_object(parser);
+        if (object < 0) {
+            return -1;
+        }
+        atlas_rdf_turtle_add(parser, node, first, object);
+    }
+    if (node >= 0) {
+        atlas_rdf_turtle_add(parser, node, rest, nil);
+    }
+    return head;
+}
+
+static int
+atlas_rdf_turtle_parse_object(__turtle_parser * parser) {
+    atlas_rdf_turtle_skip(parser);
+    if (parser->p == parser->end) {
+        parser->error = "Object is missing.";
+        return -1;
+    }
+    
+    char c = *parser->p;
+    if (c == '<') {
+        return atlas_rdf_turtle_parse_iri(parser, 0);
+    } else if (c == '_' && parser->p + 1 < parser->end && parser->p[1] == ':') {
+        return atlas_rdf_turtle_parse_blank_node(parser);
+    } else if (c == '[') {
+        return atlas_rdf_turtle_parse_blank_node_property_list(parser, 0);
+    } else if (c == '(') {
+        return atlas_rdf_turtle_parse_collection(parser);
+    } else if (c == '"' || c == '\'') {
+        return atlas_rdf_turtle_parse_rdf_literal(parser);
+    } else if (atlas_rdf_turtle_is_digit(c) || c == '+' || c == '-' || c == '.') {
+        return atlas_rdf_turtle_parse_numeric_literal(parser);
+    } else if (atlas_rdf_turtle_keyword(parser, "true", 0)) {
+        return atlas_rdf_turtle_boolean(parser, 1);
+    } else if (atlas_rdf_turtle_keyword(parser, "false", 0)) {
+        return atlas_rdf_turtle_boolean(parser, 0);
+    } else if (atlas_rdf_turtle_is_base_char(c) || c == ':') {
+        return atlas_rdf_turtle_parse_iri(parser, 0);
+    }
+    parser->error = "Invalid object.";
+    return -1;
+}
+
+static int
+atlas_rdf_turtle_parse_object_list(__turtle_parser * parser, int subject, int predicate) {
+    while (1) {
+        int object = atlas_rdf_turtle_parse_object(parser);
+        if (object < 0) {
+            return 0;
+        }
+        atlas_rdf_turtle_add(parser, subject, predicate, object);
+        
+        atlas_rdf_turtle_skip(parser);
+        if (parser->p == parser->end || *parser->p != ',') {
+            return 1;
+        }
+        parser->p++;
+    }
+}
+
+static int
+atlas_rdf_turtle_parse_predicate_object_list(__turtle_parser * parser, int subject) {
+    while (1) {
+        atlas_rdf_turtle_skip(parser);
+        if (parser->p == parser->end) {
+            parser->error = "Predicate is missing.";
+            return 0;
+        }
+        
+        // the verb
+        int predicate;
+        if (atlas_rdf_turtle_keyword(parser, "a", 0)) {
+            parser->p++;
+            predicate = atlas_rdf_turtle_constant(parser, &parser->rdf_type, RDF_NS "type");
+        } else if (*parser->p == '<' || *parser->p == ':' || atlas_rdf_turtle_is_base_char(*parser->p)) {
+            predicate = atlas_rdf_turtle_parse_iri(parser, 0);
+        } else {
+            parser->error = "Predicate is not an IRI.";
+            return 0;
+        }
+        if (predicate < 0) {
+            return 0;
+        }
+        
+        if (!atlas_rdf_turtle_parse_object_list(parser, subject, predicate)) {
+            return 0;
+        }
+        
+        // the list can end with one or more ';'
+        atlas_rdf_turtle_skip(parser);
+        if (parser->p == parser->end || *parser->p != ';') {
+            return 1;
+        }
+        while (parser->p < parser->end && *parser->p == ';') {
+            parser->p++;
+            atlas_rdf_turtle_skip(parser);
+        }
+        if (parser->p == parser->end || *parser->p == '.' || *parser->p == ']') {
+            return 1;
+        }
+    }
+}
+
+static int
+atlas_rdf_turtle_parse_triples(__turtle_parser * parser) {
+    char c = *parser->p;
+    int subject;
+    
+    if (c == '[') {
+        int empty;
+        subject = atlas_rdf_turtle_parse_blank_node_property_list(parser, &empty);
+        if (subject < 0) {
+            return 0;
+        }
+        
+        // the predicates are optional after a blank node property list
+        atlas_rdf_turtle_skip(parser);
+        if (!empty && parser->p < parser->end && *parser->p == '.') {
+            return 1;
+        }
+    } else {
+        if (c == '<' || c == ':' || atlas_rdf_turtle_is_base_char(c)) {
+            subject = atlas_rdf_turtle_parse_iri(parser, 0);
+        } else if (c == '_' && parser->p + 1 < parser->end && parser->p[1] == ':') {
+            subject = atlas_rdf_turtle_parse_blank_node(parser);
+        } else if (c == '(') {
+            subject = atlas_rdf_turtle_parse_collection(parser);
+        } else {
+            parser->error = "Subject is not an IRI or a blank node.";
+            return 0;
+        }
+        if (subject < 0) {
+            return 0;
+        }
+    }
+    
+    return atlas_rdf_turtle_parse_predicate_object_list(parser, subject);
+}
+
+#pragma mark -
+#pragma mark Parse Directives
+
+static int
+atlas_rdf_turtle_parse_prefix_directive(__turtle_parser * parser) {
+    atlas_rdf_turtle_skip(parser);
+    
+    // the name of the prefix
+    const char * begin = parser->p;
+    const char * p = begin;
+    if (p < parser->end && atlas_rdf_turtle_is_base_char(*p)) {
+        while (p < parser->end && (atlas_rdf_turtle_is_name_char(*p) || *p == '.')) {
+            p++;
+        }
+    }
+    if (p == parser->end || *p != ':' || (p > begin && p[-1] == '.')) {
+        parser->error = "Invalid prefix name.";
+        return 0;
+    }
+    size_t name_length = p - begin;
+    parser->p = p + 1;
+    
+    atlas_rdf_turtle_skip(parser);
+    if (parser->p == parser->end || *parser->p != '<') {
+        parser->error = "Prefix is not followed by an IRI.";
+        return 0;
+    }
+    if (!atlas_rdf_turtle_parse_iriref(parser)) {
+        return 0;
+    }
+    
+    // a prefix can be redefined
+    __turtle_prefix * prefix = 0;
+    for (int i=0; i<parser->num_prefixes; i++) {
+        if (parser->prefixes[i].name_length == name_length &&
+            memcmp(parser->prefixes[i].name, begin, name_length) == 0) {
+            prefix = &parser->prefixes[i];
+            free(prefix->iri);
+            break;
+        }
+    }
+    if (prefix == 0) {
+        if (parser->num_prefixes == parser->max_prefixes) {
+            parser->max_prefixes = parser->max_prefixes ? parser->max_prefixes * 2 : 16;
+            parser->prefixes = realloc(parser->prefixes, sizeof(__turtle_prefix) * parser->max_prefixes);
+            assert(parser->prefixes != 0);
+        }
+        prefix = &parser->prefixes[parser->num_prefixes++];
+        prefix->name = malloc(name_length + 1);
+        assert(prefix->name != 0);
+        memcpy(prefix->name, begin, name_length);
+        prefix->name_length = name_length;
+    }
+    
+    // the IRI is stored without the leading '<'
+    prefix->iri_length = parser->iri.length - 1;
+    prefix->iri = malloc(prefix->iri_length + 1);
+    assert(prefix->iri != 0);
+    memcpy(prefix->iri, parser->iri.data + 1, prefix->iri_length);
+    return 1;
+}
+
+static int
+atlas_rdf_turtle_parse_base_directive(__turtle_parser * parser) {
+    atlas_rdf_turtle_skip(parser);
+    if (parser->p == parser->end || *parser->p != '<') {
+        parser->error = "Base is not followed by an IRI.";
+        return 0;
+    }
+    if (!atlas_rdf_turtle_parse_iriref(parser)) {
+        return 0;
+    }
+    
+    free(parser->base);
+    parser->base = malloc(parser->iri.length);
+    assert(parser->base != 0);
+    memcpy(parser->base, parser->iri.data + 1, parser->iri.length - 1);
+    parser->base[parser->iri.length - 1] = 0;
+    return 1;
+}
+
+static int
+atlas_rdf_turtle_parse_statement(__turtle_parser * parser) {
+    if (*parser->p == '@') {
+        parser->p++;
+        int result;
+        if (atlas_rdf_turtle_keyword(parser, "prefix", 0)) {
+            parser->p += 6;
+            result = atlas_rdf_turtle_parse_prefix_directive(parser);
+        } else if (atlas_rdf_turtle_keyword(parser, "base", 0)) {
+            parser->p += 4;
+            result = atlas_rdf_turtle_parse_base_directive(parser);
+        } else {
+            parser->error = "Unknown directive.";
+            return 0;
+        }
+        return result && atlas_rdf_turtle_expect(parser, '.', "Directive is not terminated by a dot.");
+    }
+    
+    // SPARQL style directives are not terminated by a dot
+    if (atlas_rdf_turtle_keyword(parser, "PREFIX", 1)) {
+        parser->p += 6;
+        return atlas_rdf_turtle_parse_prefix_directive(parser);
+    }
+    if (atlas_rdf_turtle_keyword(parser, "BASE", 1)) {
+        parser->p += 4;
+        return atlas_rdf_turtle_parse_base_directive(parser);
+    }
+    
+    return atlas_rdf_turtle_parse_triples(parser) &&
+        atlas_rdf_turtle_expect(parser, '.', "Statement is not terminated by a dot.");
+}
+
+#pragma mark -
+#pragma mark Parse Turtle
+
+int
+atlas_rdf_turtle_parse(atlas_rdf_graph_builder_t builder,
+                       const char * data,
+                       size_t length,
+                       const char * base,
+                       atlas_error_handler err) {
+    assert(builder != 0);
+    
+    if (base && !atlas_rdf_turtle_has_scheme(base, strlen(base))) {
+        char * buff;
+        asprintf(&buff, "The base IRI (%s) is not absolute.", base);
+        err(1, buff);
+        free(buff);
+        return 0;
+    }
+    
+    __turtle_parser parser;
+    memset(&parser, 0, sizeof(__turtle_parser));
+    parser.builder = builder;
+    parser.cache = atlas_rdf_term_cache_create(builder);
+    parser.p = data;
+    parser.end = data + length;
+    parser.line = 1;
+    parser.base = base ? strdup(base) : 0;
+    parser.rdf_type = -1;
+    parser.rdf_first = -1;
+    parser.rdf_rest = -1;
+    parser.rdf_nil = -1;
+    
+    int result = 1;
+    while (1) {
+        atlas_rdf_turtle_skip(&parser);
+        if (parser.p == parser.end) {
+            break;
+        }
+        if (!atlas_rdf_turtle_parse_statement(&parser)) {
+            char * buff;
+            asprintf(&buff, "Syntax error in line %d: %s", parser.line, parser.error);
+            err(1, buff);
+            free(buff);
+            result = 0;
+            break;
+        }
+    }
+    
+    for (int i=0; i<parser.num_prefixes; i++) {
+        free(parser.prefixes[i].name);
+        free(parser.prefixes[i].iri);
+    }
+    free(parser.prefixes);
+    free(parser.base);
+    free(parser.ref.data);
+    free(parser.iri.data);
+    free(parser.value.data);
+    atlas_rdf_term_cache_free(parser.cache);
+    
+    return result;
+}
+
+#pragma mark -
+#pragma mark Create a RDF Graph from Turtle
+
+atlas_rdf_graph_t
+atlas_rdf_graph_create_from_turtle(const char * data,
+                                   size_t length,
+                                   const char * base,
+                                   atlas_error_handler err) {
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    atlas_rdf_graph_t result = 0;
+    if (atlas_rdf_turtle_parse(builder, data, length, base, err)) {
+        result = atlas_rdf_graph_builder_commit(builder, err);
+    }
+    atlas_rdf_graph_builder_free(builder);
+    return result;
+}
+
+atlas_rdf_graph_t
+atlas_rdf_graph_open_turtle(const char * path,
+                            const char * base,
+                            atlas_error_handler err) {
+    assert(path != 0);
+    
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        char * buff;
+        asprintf(&buff, "Could not open Turtle file %s: %s", path, strerror(errno));
+        err(1, buff);
+        free(buff);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return 0;
+    }
+    
+    // the IRI of the file is the default base IRI
+    char * file_base = 0;
+    if (base == 0) {
+        char resolved[PATH_MAX];
+        if (realpath(path, resolved)) {
+            asprintf(&file_base, "file://%s", resolved);
+        }
+        base = file_base;
+    }
+    
+    atlas_rdf_graph_t result = 0;
+    if (st.st_size == 0) {
+        result = atlas_rdf_graph_create(0, 0, err);
+    } else {
+        void * data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            char * buff;
+            asprintf(&buff, "Could not map Turtle file %s: %s", path, strerror(errno));
+            err(1, buff);
+            free(buff);
+        } else {
+            result = atlas_rdf_graph_create_from_turtle(data, st.st_size, base, err);
+            munmap(data, st.st_size);
+        }
+    }
+    
+    close(fd);
+    free(file_base);
+    return result;
+}
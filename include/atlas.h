@@ -27,5 +27,17 @@
 #include <atlas/rdf/term.h>
 #include <atlas/rdf/term_set.h>
 #include <atlas/rdf/graph.h>
+#include <atlas/rdf/graph_builder.h>
+#include <atlas/rdf/changeset.h>
+#include <atlas/rdf/graph_file.h>
+#include <atlas/rdf/ntriples.h>
+#include <atlas/rdf/turtle.h>
+#include <atlas/rdf/hdt.h>
+#include <atlas/rdf/graph_stats.h>
+#include <atlas/rdf/path.h>
+#include <atlas/rdf/reasoner.h>
+#include <atlas/rdf/dataset.h>
+#include <atlas/rdf/temporal.h>
+#include <atlas/rdf/sparql.h>
 
 #endif // _ATLAS_H_
@@ -0,0 +1,90 @@
+/*
+ *  changeset.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_CHANGESET_H_
+#define _ATLAS_RDF_CHANGESET_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/graph.h>
+
+#include <lazy.h>
+
+/*! Handle for a RDF Changeset
+ *
+ *  A changeset consists of a graph with the statements to
+ *  add and a graph with the statements to remove. It is
+ *  applied to a graph to create a new version of that graph.
+ */
+typedef lz_obj atlas_rdf_changeset_t;
+
+#pragma mark -
+#pragma mark Create a RDF Changeset
+
+/*! Create a changeset.
+ *
+ *  \param added A graph with the statements to add.
+ *  \param removed A graph with the statements to remove.
+ *  \param err An error handler which is called in case
+ *             of an error with the error message.
+ *
+ *  \return NULL on failure or a RDF Changeset handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_changeset_t
+atlas_rdf_changeset_create(atlas_rdf_graph_t added,
+                           atlas_rdf_graph_t removed,
+                           atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Access Details of a RDF Changeset
+
+/*! The graph with the statements to add (not retained).
+ */
+atlas_rdf_graph_t
+atlas_rdf_changeset_added(atlas_rdf_changeset_t changeset);
+
+/*! The graph with the statements to remove (not retained).
+ */
+atlas_rdf_graph_t
+atlas_rdf_changeset_removed(atlas_rdf_changeset_t changeset);
+
+#pragma mark -
+#pragma mark Create a new Version of a RDF Graph
+
+/*! Create a new version of a graph by applying a changeset.
+ *
+ *  The statements to remove are removed from the graph, then the
+ *  statements to add are added. The given graph is not modified,
+ *  so readers of it keep a consistent snapshot.
+ *
+ *  The new version is split into chunks. Chunks of the given graph,
+ *  which are not affected by the changeset, are shared with the new
+ *  version instead of being copied. The affected chunks and the added
+ *  statements are stored in new chunks at the end of the graph.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_version(atlas_rdf_graph_t graph,
+                               atlas_rdf_changeset_t changeset,
+                               atlas_error_handler err);
+
+#endif // _ATLAS_RDF_CHANGESET_H_
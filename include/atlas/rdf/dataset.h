@@ -0,0 +1,157 @@
+/*
+ *  dataset.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_DATASET_H_
+#define _ATLAS_RDF_DATASET_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+#include <lazy.h>
+
+/*! Handle for a RDF Dataset
+ *
+ *  A dataset is an immutable set of named graphs. It stores the
+ *  statements of all graphs as quads (graph name, subject, predicate
+ *  and object) over one dictionary, each term is referenced once.
+ *  The quads are sorted by graph, subject, predicate and object
+ *  (GSPO) and indexed by graph, predicate, object and subject (GPOS).
+ */
+typedef lz_obj atlas_rdf_dataset_t;
+
+/*! A Quad in a RDF Dataset.
+ */
+typedef struct atlas_rdf_quad_s {
+    atlas_rdf_term_t graph;
+    atlas_rdf_term_t subject;
+    atlas_rdf_term_t predicate;
+    atlas_rdf_term_t object;
+} atlas_rdf_quad_t;
+
+#pragma mark -
+#pragma mark Create a RDF Dataset
+
+/*! Create a dataset with the given quads.
+ *
+ *  Duplicate quads are removed. The name of a graph must be a resource.
+ *
+ *  \return NULL on failure or a RDF Dataset handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_dataset_t
+atlas_rdf_dataset_create(int number_of_quads,
+                         atlas_rdf_quad_t * quads,
+                         atlas_error_handler err);
+
+/*! Create a dataset with the given graphs.
+ *
+ *  The statements of graphs with the same name are merged.
+ *
+ *  \return NULL on failure or a RDF Dataset handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_dataset_t
+atlas_rdf_dataset_create_from_graphs(int number_of_graphs,
+                                     atlas_rdf_term_t * names,
+                                     atlas_rdf_graph_t * graphs,
+                                     atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Access Details of a RDF Dataset
+
+/*! Number of quads in the dataset.
+ */
+int
+atlas_rdf_dataset_length(atlas_rdf_dataset_t dataset);
+
+/*! Number of distinct terms in the dataset (including the names).
+ */
+int
+atlas_rdf_dataset_num_terms(atlas_rdf_dataset_t dataset);
+
+/*! Number of graphs in the dataset.
+ */
+int
+atlas_rdf_dataset_num_graphs(atlas_rdf_dataset_t dataset);
+
+/*! Name of the graph at the given index (not retained).
+ */
+atlas_rdf_term_t
+atlas_rdf_dataset_graph_name(atlas_rdf_dataset_t dataset,
+                             int index);
+
+/*! Graph with the given name.
+ *
+ *  The graph refers to the terms of the dataset and can be used like
+ *  any other graph. The costs are proportional to the size of the graph.
+ *
+ *  \return A RDF Graph handle with a reference count of 1, which
+ *          is empty if the dataset has no graph with the name.
+ */
+atlas_rdf_graph_t
+atlas_rdf_dataset_graph(atlas_rdf_dataset_t dataset,
+                        atlas_rdf_term_t name);
+
+#pragma mark -
+#pragma mark Query a RDF Dataset
+
+/*! Apply a block to all quads in the dataset.
+ *
+ *  The quads of all graphs are processed in one scan,
+ *  the block is called concurrent.
+ */
+void
+atlas_rdf_dataset_apply(atlas_rdf_dataset_t dataset,
+                        void(^iterator)(atlas_rdf_term_t graph,
+                                        atlas_rdf_term_t subject,
+                                        atlas_rdf_term_t predicate,
+                                        atlas_rdf_term_t object));
+
+/*! Apply a block to the quads matching a pattern.
+ *
+ *  Each of the terms may be NULL, which matches any term. The GSPO
+ *  order is used if the subject is given, the GPOS index if the
+ *  predicate is given. The block is called sequentially, the terms
+ *  are not retained.
+ *
+ *  \return The number of matching quads.
+ */
+int
+atlas_rdf_dataset_match(atlas_rdf_dataset_t dataset,
+                        atlas_rdf_term_t graph,
+                        atlas_rdf_term_t subject,
+                        atlas_rdf_term_t predicate,
+                        atlas_rdf_term_t object,
+                        void(^iterator)(atlas_rdf_term_t graph,
+                                        atlas_rdf_term_t subject,
+                                        atlas_rdf_term_t predicate,
+                                        atlas_rdf_term_t object));
+
+/*! Check if the dataset contains a quad.
+ */
+int
+atlas_rdf_dataset_contains(atlas_rdf_dataset_t dataset,
+                           atlas_rdf_term_t graph,
+                           atlas_rdf_term_t subject,
+                           atlas_rdf_term_t predicate,
+                           atlas_rdf_term_t object);
+
+#endif // _ATLAS_RDF_DATASET_H_
@@ -48,6 +48,10 @@ typedef struct atlas_rdf_statement_s {
  *
  *  This function creates a RDF Graph with the given statements.
  *  Duplicates statements are removed.
+ *
+ *  Large graphs are created by one worker per CPU: the terms and
+ *  the statements are partitioned by their hash values and the
+ *  partitions are deduplicated concurrently.
  *  
  *  \param number_of_statements Number of statements
  *  \param statements An array containing the statements for the graph.
@@ -82,13 +86,33 @@ atlas_rdf_graph_create_intersection(atlas_rdf_graph_t graph1,
 
 /*! Create the difference of two graphs.
  *
- *  This function creates the difference of two graphs.
+ *  This function creates the symmetric difference of two graphs
+ *  (the statements, which are only in one of the graphs).
  */
 atlas_rdf_graph_t
 atlas_rdf_graph_create_difference(atlas_rdf_graph_t graph1,
                                   atlas_rdf_graph_t graph2,
                                   atlas_error_handler err);
 
+/*! Create a compressed copy of a graph.
+ *
+ *  The statements are sorted by subject, predicate and object and
+ *  stored in blocks. Each block starts with a statement; the other
+ *  statements in the block are stored as (mostly small) differences
+ *  to their predecessor with a variable number of bytes. The statements
+ *  are decoded block by block while the graph is accessed, checking if
+ *  the graph contains a statement only decodes one block.
+ *
+ *  The order of the statements in the compressed graph differs from
+ *  the order in the given graph.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_compressed(atlas_rdf_graph_t graph,
+                                  atlas_error_handler err);
+
 #pragma mark -
 #pragma mark Access Details of a RDF Graph
 
@@ -97,6 +121,13 @@ atlas_rdf_graph_create_difference(atlas_rdf_graph_t graph1,
 int
 atlas_rdf_graph_length(atlas_rdf_graph_t graph);
 
+/*! Number of bytes used to store the statements of the graph.
+ *
+ *  The memory used by the terms is not included.
+ */
+size_t
+atlas_rdf_graph_memory_size(atlas_rdf_graph_t graph);
+
 /*! Apply a block to all statements in the graph.
  * 
  *  This function calls the given block for each
@@ -110,6 +141,243 @@ atlas_rdf_graph_apply(atlas_rdf_graph_t graph,
                                       atlas_rdf_term_t predicate,
                                       atlas_rdf_term_t object));
 
+/*! Apply a block to all statements in the graph, processing ranges of statements.
+ *
+ *  This function splits the graph into contiguous ranges of statements
+ *  and processes the ranges concurrently. Each worker processing ranges
+ *  has its own state, which is created by the block init and passed
+ *  to each call of the iterator. After all statements have been
+ *  processed, the block finish is called sequentially for each state,
+ *  which makes reductions (e.g., counting or collecting statements)
+ *  possible without locks.
+ *
+ *  \param grain_size Number of statements in a range or 0 to choose the
+ *                    size depending on the size of the graph and the
+ *                    number of CPUs.
+ *
+ *  \param init A block returning a new state or NULL.
+ *
+ *  \param iterator The block which is called for each statement, with
+ *                  the state of the worker.
+ *
+ *  \param finish A block which is called for each state or NULL.
+ */
+void
+atlas_rdf_graph_apply_chunked(atlas_rdf_graph_t graph,
+                              int grain_size,
+                              void *(^init)(void),
+                              void(^iterator)(void * state,
+                                              atlas_rdf_term_t subject,
+                                              atlas_rdf_term_t predicate,
+                                              atlas_rdf_term_t object),
+                              void(^finish)(void * state));
+
+/*! Reduce the statements in the graph in parallel.
+ *
+ *  This function aggregates the statements in the graph (e.g., counts,
+ *  sums or collects them). Each worker keeps a private accumulator, which
+ *  is created by the block init and updated by the block accumulate
+ *  for each statement. Afterwards the accumulators of the workers are
+ *  merged pairwise (tree-style) by the block combine.
+ *
+ *  \code
+ *  intptr_t count = (intptr_t)atlas_rdf_graph_reduce(graph, ^{
+ *      return (void *)0;
+ *  }, ^(void * acc, atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+ *      return (void *)((intptr_t)acc + 1);
+ *  }, ^(void * acc1, void * acc2){
+ *      return (void *)((intptr_t)acc1 + (intptr_t)acc2);
+ *  });
+ *  \endcode
+ *
+ *  \param init A block returning a new accumulator.
+ *
+ *  \param accumulate A block which is called for each statement with the
+ *                    accumulator of the worker and returns the
+ *                    updated accumulator.
+ *
+ *  \param combine A block which merges two accumulators and returns
+ *                 the result. It must be associative and commutative
+ *                 and is responsible to free the accumulators which
+ *                 are not returned.
+ *
+ *  \return The final accumulator, or the result of init, if the
+ *          graph is empty.
+ */
+void *
+atlas_rdf_graph_reduce(atlas_rdf_graph_t graph,
+                       void *(^init)(void),
+                       void *(^accumulate)(void * acc,
+                                           atlas_rdf_term_t subject,
+                                           atlas_rdf_term_t predicate,
+                                           atlas_rdf_term_t object),
+                       void *(^combine)(void * acc1, void * acc2));
+
+#pragma mark -
+#pragma mark Describe a Resource in a RDF Graph
+
+/*! Apply a block to the statements with the given subject.
+ *
+ *  The first call builds an adjacency index of the graph (the
+ *  statements grouped by their subject and by their object), which
+ *  is kept until the graph is removed. Afterwards the cost is
+ *  proportional to the number of statements with the subject.
+ *
+ *  The block is called sequentially, in the order of the statements
+ *  in the graph. The terms are not retained.
+ *
+ *  \param iterator The block which is called for each statement or NULL.
+ *
+ *  \return The number of statements with the subject.
+ */
+int
+atlas_rdf_graph_describe(atlas_rdf_graph_t graph,
+                         atlas_rdf_term_t subject,
+                         void(^iterator)(atlas_rdf_term_t predicate,
+                                         atlas_rdf_term_t object));
+
+/*! Apply a block to the statements with the given object.
+ *
+ *  Same as atlas_rdf_graph_describe() for the incoming statements.
+ *
+ *  \return The number of statements with the object.
+ */
+int
+atlas_rdf_graph_describe_incoming(atlas_rdf_graph_t graph,
+                                  atlas_rdf_term_t object,
+                                  void(^iterator)(atlas_rdf_term_t subject,
+                                                  atlas_rdf_term_t predicate));
+
+#pragma mark -
+#pragma mark Select Statements by the Value of the Object
+
+// flags of atlas_rdf_graph_range()
+#define ATLAS_RDF_RANGE_EXCLUDE_MIN 1
+#define ATLAS_RDF_RANGE_EXCLUDE_MAX 2
+
+/*! Apply a block to the statements with a literal object in a range.
+ *
+ *  This function selects the statements with the given predicate and
+ *  a numeric or datetime object between min and max (included, unless
+ *  excluded by the flags). The bounds are numeric or datetime literals
+ *  of the same domain, a NULL bound is not limited, but at least one
+ *  bound must be given. Numeric values are compared as doubles.
+ *
+ *  The first call builds a range index of the graph (the statements
+ *  of each predicate sorted by the value of the object), which is kept
+ *  with the adjacency index (s. atlas_rdf_graph_describe()). Afterwards
+ *  the matching statements are found by binary search.
+ *
+ *  The block is called sequentially, in the order of the values.
+ *  The terms are not retained.
+ *
+ *  \param iterator The block which is called for each statement or NULL.
+ *
+ *  \return The number of statements in the range.
+ */
+int
+atlas_rdf_graph_range(atlas_rdf_graph_t graph,
+                      atlas_rdf_term_t predicate,
+                      atlas_rdf_term_t min,
+                      atlas_rdf_term_t max,
+                      int flags,
+                      void(^iterator)(atlas_rdf_term_t subject,
+                                      atlas_rdf_term_t object));
+
+#pragma mark -
+#pragma mark Select String Literals by their Text
+
+// flags of atlas_rdf_graph_text()
+#define ATLAS_RDF_TEXT_PREFIX 1
+#define ATLAS_RDF_TEXT_ICASE  2
+
+/*! Apply a block to the string literals containing a text.
+ *
+ *  This function selects the string literals in the graph, which contain
+ *  the pattern (or start with it, if ATLAS_RDF_TEXT_PREFIX is set). With
+ *  ATLAS_RDF_TEXT_ICASE, ASCII letters are compared case-insensitively.
+ *  If a language is given, only literals with this language (compared
+ *  case-insensitively) are selected, "" selects literals without a language.
+ *
+ *  The first call builds a text index of the graph (the trigrams of the
+ *  string literals), which is kept with the adjacency index. Afterwards
+ *  the candidates are the literals containing all trigrams of the pattern,
+ *  only the candidates are compared with the pattern.
+ *
+ *  The block is called sequentially for each literal. The
+ *  terms are not retained.
+ *
+ *  \param language The language or NULL for all literals.
+ *  \param iterator The block which is called for each literal or NULL.
+ *
+ *  \return The number of matching literals.
+ */
+int
+atlas_rdf_graph_text(atlas_rdf_graph_t graph,
+                     const char * pattern,
+                     const char * language,
+                     int flags,
+                     void(^iterator)(atlas_rdf_term_t literal));
+
+#pragma mark -
+#pragma mark Iterate a RDF Graph with a Cursor
+
+/*! Handle for a Cursor over the statements of a RDF Graph
+ *
+ *  A cursor yields the statements of a graph one by one in the order
+ *  they are stored in the graph. The caller decides when to fetch the
+ *  next statement and can stop at any time (e.g., after the first
+ *  matching statement), without touching the remaining statements.
+ *
+ *  A cursor is not thread safe.
+ */
+typedef struct atlas_rdf_graph_cursor_s * atlas_rdf_graph_cursor_t;
+
+/*! Create a cursor over all statements in the graph.
+ *
+ *  The graph is retained by the cursor until it is closed.
+ *
+ *  \return A cursor, which must be closed with atlas_rdf_graph_cursor_close().
+ */
+atlas_rdf_graph_cursor_t
+atlas_rdf_graph_cursor_create(atlas_rdf_graph_t graph);
+
+/*! Create a cursor over a range of statements in the graph.
+ *
+ *  The cursor yields the statements at the positions [begin, end).
+ *  The range is limited to the length of the graph.
+ *
+ *  \return A cursor, which must be closed with atlas_rdf_graph_cursor_close().
+ */
+atlas_rdf_graph_cursor_t
+atlas_rdf_graph_cursor_create_range(atlas_rdf_graph_t graph,
+                                    int begin,
+                                    int end);
+
+/*! Fetch the next statement.
+ *
+ *  The terms in the statement are not retained. They are valid
+ *  as long as the cursor is not closed.
+ *
+ *  \return 0 if there are no more statements, else != 0 and the
+ *          statement is stored in the given statement.
+ */
+int
+atlas_rdf_graph_cursor_next(atlas_rdf_graph_cursor_t cursor,
+                            atlas_rdf_statement_t * statement);
+
+/*! Reset the cursor to the first statement of its range.
+ */
+void
+atlas_rdf_graph_cursor_reset(atlas_rdf_graph_cursor_t cursor);
+
+/*! Close the cursor.
+ *
+ *  This function releases the graph and frees the cursor.
+ */
+void
+atlas_rdf_graph_cursor_close(atlas_rdf_graph_cursor_t cursor);
+
 #pragma mark -
 #pragma mark Graph Predicates
 
@@ -0,0 +1,113 @@
+/*
+ *  graph_builder.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_BUILDER_H_
+#define _ATLAS_RDF_GRAPH_BUILDER_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+/*! Handle for a RDF Graph Builder
+ *
+ *  A graph builder collects statements one by one or in batches
+ *  and creates an immutable RDF Graph from them. Duplicate statements
+ *  are removed while they are added. The terms of the statements
+ *  are retained by the builder until it is freed.
+ *
+ *  A graph builder is not thread safe.
+ */
+typedef struct atlas_rdf_graph_builder_s * atlas_rdf_graph_builder_t;
+
+#pragma mark -
+#pragma mark Create a RDF Graph Builder
+
+/*! Create an empty graph builder.
+ *
+ *  \param capacity Number of statements expected to be
+ *                  added (the builder grows if needed).
+ *
+ *  \return A graph builder, which must be freed with
+ *          atlas_rdf_graph_builder_free().
+ */
+atlas_rdf_graph_builder_t
+atlas_rdf_graph_builder_create(int capacity);
+
+/*! Free a graph builder.
+ *
+ *  This function releases all terms added to the builder. Graphs
+ *  created with atlas_rdf_graph_builder_commit() are not affected.
+ */
+void
+atlas_rdf_graph_builder_free(atlas_rdf_graph_builder_t builder);
+
+#pragma mark -
+#pragma mark Add Statements to a RDF Graph Builder
+
+/*! Add a statement to the builder.
+ *
+ *  If the statement is already in the builder, it is not added again.
+ *
+ *  \return 0 on failure (the subject is not a resource or the
+ *          predicate is not an iri), else != 0.
+ */
+int
+atlas_rdf_graph_builder_add(atlas_rdf_graph_builder_t builder,
+                            atlas_rdf_term_t subject,
+                            atlas_rdf_term_t predicate,
+                            atlas_rdf_term_t object,
+                            atlas_error_handler err);
+
+/*! Add a batch of statements to the builder.
+ *
+ *  The statements are added in the given order. If a statement
+ *  is not valid, the error handler is called and the remaining
+ *  statements are not added.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_graph_builder_add_statements(atlas_rdf_graph_builder_t builder,
+                                       int number_of_statements,
+                                       atlas_rdf_statement_t * statements,
+                                       atlas_error_handler err);
+
+/*! Number of distinct statements in the builder.
+ */
+int
+atlas_rdf_graph_builder_length(atlas_rdf_graph_builder_t builder);
+
+#pragma mark -
+#pragma mark Commit a RDF Graph Builder
+
+/*! Create a RDF Graph from the statements in the builder.
+ *
+ *  The statements are stored in the graph in the order they have
+ *  been added first. The builder can be used to add more statements
+ *  afterwards; the graph is not affected by that.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_builder_commit(atlas_rdf_graph_builder_t builder,
+                               atlas_error_handler err);
+
+#endif // _ATLAS_RDF_GRAPH_BUILDER_H_
@@ -0,0 +1,80 @@
+/*
+ *  graph_file.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_FILE_H_
+#define _ATLAS_RDF_GRAPH_FILE_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/graph.h>
+
+/*! Binary Graph Files
+ *
+ *  A graph file starts with a header containing a table of the
+ *  sections in the file. The term section contains the terms of
+ *  the graph; the triple section contains the statements in the
+ *  same layout as they are kept in memory.
+ *
+ *  When a graph file is opened, the file is mapped into memory and
+ *  the statements are used directly from the mapping: they are not
+ *  copied or decoded, the pages are shared between processes using
+ *  the same file. The positions of the statements are checked once
+ *  while opening the file, so a corrupt file is rejected.
+ *
+ *  The terms are not used from the mapping. The graph references its
+ *  terms as lazy objects, so each term of the file is decoded and
+ *  created while opening the file, and the term section is read
+ *  completely. The terms take the same memory as in a graph created
+ *  in memory.
+ *
+ *  Graph files are written in the byte order and with the type sizes
+ *  of the writing machine and can only be opened on compatible machines.
+ */
+
+#pragma mark -
+#pragma mark Write a RDF Graph File
+
+/*! Write a graph to a file.
+ *
+ *  An existing file is replaced.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_graph_write_file(atlas_rdf_graph_t graph,
+                           const char * path,
+                           atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Open a RDF Graph File
+
+/*! Open a graph file.
+ *
+ *  The file must not be modified while the graph exists. If the
+ *  file is not a graph file, was written on an incompatible machine
+ *  or is corrupt, the error handler is called.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_open_file(const char * path,
+                          atlas_error_handler err);
+
+#endif // _ATLAS_RDF_GRAPH_FILE_H_
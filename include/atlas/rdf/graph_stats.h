@@ -0,0 +1,138 @@
+/*
+ *  graph_stats.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_GRAPH_STATS_H_
+#define _ATLAS_RDF_GRAPH_STATS_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+#include <stdint.h>
+
+/*! Statistics of a RDF Graph
+ *
+ *  The statistics contain the number of statements and of the distinct
+ *  subjects, predicates and objects of a graph and, for each predicate,
+ *  the number of statements and of the distinct subjects and objects
+ *  (e.g., for the estimation of the cardinality of a join).
+ *
+ *  The statistics are computed in one parallel pass over the graph on
+ *  first use and kept by the graph; they are freed with the graph.
+ *
+ *  The distinct subjects and objects are either counted exactly (which
+ *  needs memory for the distinct terms) or estimated with HyperLogLog
+ *  sketches (with a standard error of about 1.6%). The number of
+ *  statements and of the distinct predicates is always exact.
+ */
+typedef struct atlas_rdf_graph_stats_s * atlas_rdf_graph_stats_t;
+
+// estimate the distinct subjects and objects
+#define ATLAS_RDF_GRAPH_STATS_APPROXIMATE 1
+
+#pragma mark -
+#pragma mark Compute the Statistics of a RDF Graph
+
+/*! Statistics of a graph.
+ *
+ *  Exact statistics are also returned, if approximate
+ *  statistics are requested and have been computed before.
+ *
+ *  \param options 0 or ATLAS_RDF_GRAPH_STATS_APPROXIMATE.
+ *
+ *  \return The statistics, which are valid as long as the graph.
+ */
+atlas_rdf_graph_stats_t
+atlas_rdf_graph_stats(atlas_rdf_graph_t graph,
+                      int options);
+
+/*! Check if the distinct subjects and objects are estimated.
+ */
+int
+atlas_rdf_graph_stats_is_approximate(atlas_rdf_graph_stats_t stats);
+
+#pragma mark -
+#pragma mark Access the Statistics of a RDF Graph
+
+uint64_t
+atlas_rdf_graph_stats_num_statements(atlas_rdf_graph_stats_t stats);
+
+uint64_t
+atlas_rdf_graph_stats_num_subjects(atlas_rdf_graph_stats_t stats);
+
+uint64_t
+atlas_rdf_graph_stats_num_predicates(atlas_rdf_graph_stats_t stats);
+
+uint64_t
+atlas_rdf_graph_stats_num_objects(atlas_rdf_graph_stats_t stats);
+
+/*! Average number of statements per subject.
+ */
+double
+atlas_rdf_graph_stats_avg_out_degree(atlas_rdf_graph_stats_t stats);
+
+/*! Average number of statements per object.
+ */
+double
+atlas_rdf_graph_stats_avg_in_degree(atlas_rdf_graph_stats_t stats);
+
+#pragma mark -
+#pragma mark Access the Statistics of the Predicates
+
+/*! Position of a predicate in the statistics.
+ *
+ *  The predicates are sorted by their number of
+ *  statements (the most frequent first). Predicates
+ *  with the same number of statements are sorted by
+ *  their value, so the positions do not depend on the
+ *  order, in which the statements have been counted.
+ *
+ *  \return The position or -1, if the graph does
+ *          not contain the predicate.
+ */
+int
+atlas_rdf_graph_stats_predicate_index(atlas_rdf_graph_stats_t stats,
+                                      atlas_rdf_term_t predicate);
+
+/*! Predicate at a position (not retained).
+ */
+atlas_rdf_term_t
+atlas_rdf_graph_stats_predicate(atlas_rdf_graph_stats_t stats,
+                                int index);
+
+/*! Number of statements with the predicate at a position.
+ */
+uint64_t
+atlas_rdf_graph_stats_predicate_statements(atlas_rdf_graph_stats_t stats,
+                                           int index);
+
+/*! Number of distinct subjects with the predicate at a position.
+ */
+uint64_t
+atlas_rdf_graph_stats_predicate_subjects(atlas_rdf_graph_stats_t stats,
+                                         int index);
+
+/*! Number of distinct objects with the predicate at a position.
+ */
+uint64_t
+atlas_rdf_graph_stats_predicate_objects(atlas_rdf_graph_stats_t stats,
+                                        int index);
+
+#endif // _ATLAS_RDF_GRAPH_STATS_H_
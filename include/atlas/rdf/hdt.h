@@ -0,0 +1,153 @@
+/*
+ *  hdt.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_HDT_H_
+#define _ATLAS_RDF_HDT_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+#include <stddef.h>
+
+/*! Compact Binary RDF
+ *
+ *  A compact binary representation of a graph for snapshots and for
+ *  the transfer between processes, similar to HDT
+ *  (http://www.w3.org/Submission/HDT/).
+ *
+ *  The dictionary contains the terms of the graph, split by their type
+ *  and sorted. IRIs, blank nodes and literals are stored with front
+ *  coding (each string only stores the characters, which differ from
+ *  its predecessor); booleans, doubles and datetimes are stored as
+ *  values and integers as their binary digits. The position of a term
+ *  in the dictionary is its id.
+ *
+ *  The statements are sorted by subject, predicate and object and
+ *  stored as three arrays of ids (the subjects, the predicates of each
+ *  subject and the objects of each subject and predicate); two bitmaps
+ *  mark the ends of the predicates of a subject and the objects of a
+ *  predicate. The ids are stored with as few bits as needed.
+ *
+ *  The representation can be queried directly: only the terms, which
+ *  are part of a result, are decoded.
+ *
+ *  The data is written in the byte order of the writing machine.
+ */
+
+/*! Handle for a Compact Binary RDF Graph
+ *
+ *  A handle is not thread safe.
+ */
+typedef struct atlas_rdf_hdt_s * atlas_rdf_hdt_t;
+
+#pragma mark -
+#pragma mark Serialize a RDF Graph
+
+/*! Create the compact binary representation of a graph.
+ *
+ *  \param length Is set to the length of the representation.
+ *
+ *  \return NULL on failure or the representation, which
+ *          must be freed by the caller.
+ */
+void *
+atlas_rdf_graph_serialize_hdt(atlas_rdf_graph_t graph,
+                              size_t * length,
+                              atlas_error_handler err);
+
+/*! Create a RDF Graph from its compact binary representation.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_from_hdt(const void * data,
+                                size_t length,
+                                atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Query a Compact Binary RDF Graph
+
+/*! Open the compact binary representation of a graph.
+ *
+ *  The data is not copied and must not be freed or
+ *  modified before the handle is closed.
+ *
+ *  \return NULL on failure or a handle.
+ */
+atlas_rdf_hdt_t
+atlas_rdf_hdt_open(const void * data,
+                   size_t length,
+                   atlas_error_handler err);
+
+/*! Close a handle and release the decoded terms.
+ */
+void
+atlas_rdf_hdt_close(atlas_rdf_hdt_t hdt);
+
+/*! Number of statements.
+ */
+int
+atlas_rdf_hdt_length(atlas_rdf_hdt_t hdt);
+
+/*! Number of terms in the dictionary.
+ */
+int
+atlas_rdf_hdt_num_terms(atlas_rdf_hdt_t hdt);
+
+/*! Check if the graph contains a statement.
+ *
+ *  \return 0 if the statement is not in the graph, else != 0.
+ */
+int
+atlas_rdf_hdt_contains(atlas_rdf_hdt_t hdt,
+                       atlas_rdf_term_t subject,
+                       atlas_rdf_term_t predicate,
+                       atlas_rdf_term_t object);
+
+/*! Call the block for the statements matching the pattern.
+ *
+ *  A term, which is NULL, matches any term. If the subject is given,
+ *  only the statements of the subject are decoded; else all
+ *  statements are scanned. The statements are passed sorted by
+ *  subject, predicate and object (in the order of the dictionary).
+ *
+ *  The terms passed to the block are owned by the handle.
+ */
+void
+atlas_rdf_hdt_match(atlas_rdf_hdt_t hdt,
+                    atlas_rdf_term_t subject,
+                    atlas_rdf_term_t predicate,
+                    atlas_rdf_term_t object,
+                    void(^block)(atlas_rdf_term_t subject,
+                                 atlas_rdf_term_t predicate,
+                                 atlas_rdf_term_t object));
+
+/*! Create a RDF Graph with all statements.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_hdt_graph(atlas_rdf_hdt_t hdt,
+                    atlas_error_handler err);
+
+#endif // _ATLAS_RDF_HDT_H_
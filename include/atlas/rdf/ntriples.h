@@ -0,0 +1,180 @@
+/*
+ *  ntriples.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_NTRIPLES_H_
+#define _ATLAS_RDF_NTRIPLES_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/graph.h>
+#include <atlas/rdf/graph_builder.h>
+
+#include <stddef.h>
+
+/*! Handle for a N-Triples Parser
+ *
+ *  A N-Triples parser reads statements in the N-Triples format
+ *  (http://www.w3.org/TR/rdf-testcases/#ntriples) from a stream of
+ *  data, which is passed in pieces of any size, and adds them to a
+ *  graph builder. The lines are parsed in place; strings are only
+ *  copied to create new terms. Terms, which appear several times,
+ *  are created only once.
+ *
+ *  A N-Triples parser is not thread safe.
+ */
+typedef struct atlas_rdf_ntriples_parser_s * atlas_rdf_ntriples_parser_t;
+
+#pragma mark -
+#pragma mark Create a N-Triples Parser
+
+/*! Create a parser, which adds the statements to the builder.
+ *
+ *  The builder is not retained and must not be freed before the parser.
+ */
+atlas_rdf_ntriples_parser_t
+atlas_rdf_ntriples_parser_create(atlas_rdf_graph_builder_t builder);
+
+/*! Free a parser.
+ */
+void
+atlas_rdf_ntriples_parser_free(atlas_rdf_ntriples_parser_t parser);
+
+#pragma mark -
+#pragma mark Parse N-Triples
+
+/*! Parse the next piece of data.
+ *
+ *  A line, which is not complete, is kept until the next
+ *  piece of data is parsed or the parser is finished.
+ *
+ *  \return 0 on failure (a syntax error, which is reported with
+ *          the line number), else != 0.
+ */
+int
+atlas_rdf_ntriples_parser_parse(atlas_rdf_ntriples_parser_t parser,
+                                const char * data,
+                                size_t length,
+                                atlas_error_handler err);
+
+/*! Parse the last line, if it is not terminated by a line break.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_ntriples_parser_finish(atlas_rdf_ntriples_parser_t parser,
+                                 atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Create a RDF Graph from N-Triples
+
+/*! Create a RDF Graph from N-Triples data.
+ *
+ *  The data is split at line boundaries and the parts are
+ *  parsed concurrently.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_from_ntriples(const char * data,
+                                     size_t length,
+                                     atlas_error_handler err);
+
+/*! Create a RDF Graph from a N-Triples file.
+ *
+ *  The file is mapped into memory and parsed like
+ *  atlas_rdf_graph_create_from_ntriples().
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_open_ntriples(const char * path,
+                              atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Write N-Triples and N-Quads
+
+/*! Options for writing a RDF Graph.
+ */
+#define ATLAS_RDF_NTRIPLES_SORTED 1   // write the statements in the order of their representation
+
+/*! Block, which receives the written data.
+ *
+ *  \return 0 on failure (the writing is aborted), else != 0.
+ */
+typedef int(^atlas_rdf_ntriples_sink_t)(const char * data, size_t length);
+
+/*! Write a RDF Graph as N-Triples to a file descriptor.
+ *
+ *  Each term of the graph is converted to its representation once,
+ *  then the statements are written in large blocks. Without the
+ *  option ATLAS_RDF_NTRIPLES_SORTED, the statements are written in
+ *  the order of the graph.
+ *
+ *  \param options 0 or ATLAS_RDF_NTRIPLES_SORTED.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_graph_write_ntriples(atlas_rdf_graph_t graph,
+                               int fd,
+                               int options,
+                               atlas_error_handler err);
+
+/*! Write a RDF Graph as N-Triples to a sink.
+ *
+ *  Same as atlas_rdf_graph_write_ntriples(), but the data
+ *  is passed to the block.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_graph_write_ntriples_sink(atlas_rdf_graph_t graph,
+                                    int options,
+                                    atlas_rdf_ntriples_sink_t sink,
+                                    atlas_error_handler err);
+
+/*! Write a RDF Graph as N-Quads to a file descriptor.
+ *
+ *  Each statement is written with the name of the graph (an IRI
+ *  or a blank node) as fourth term. If name is NULL, the statements
+ *  are in the default graph and written without fourth term.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_graph_write_nquads(atlas_rdf_graph_t graph,
+                             atlas_rdf_term_t name,
+                             int fd,
+                             int options,
+                             atlas_error_handler err);
+
+/*! Write a RDF Graph as N-Quads to a sink.
+ *
+ *  \return 0 on failure, else != 0.
+ */
+int
+atlas_rdf_graph_write_nquads_sink(atlas_rdf_graph_t graph,
+                                  atlas_rdf_term_t name,
+                                  int options,
+                                  atlas_rdf_ntriples_sink_t sink,
+                                  atlas_error_handler err);
+
+#endif // _ATLAS_RDF_NTRIPLES_H_
@@ -0,0 +1,117 @@
+/*
+ *  path.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_PATH_H_
+#define _ATLAS_RDF_PATH_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+#include <lazy.h>
+
+/*! Handle for a RDF Property Path
+ *
+ *  A property path describes the routes between two terms in a
+ *  graph, like the property paths of SPARQL 1.1 (e.g., ex:partOf+
+ *  or ex:locatedIn* / ex:name). A path is immutable and can be
+ *  evaluated on any graph.
+ */
+typedef lz_obj atlas_rdf_path_t;
+
+#pragma mark -
+#pragma mark Create a RDF Property Path
+
+/*! Path of length one with the given predicate.
+ */
+atlas_rdf_path_t
+atlas_rdf_path_create_predicate(atlas_rdf_term_t predicate,
+                                atlas_error_handler err);
+
+/*! Path which is the first path followed by the second path.
+ */
+atlas_rdf_path_t
+atlas_rdf_path_create_sequence(atlas_rdf_path_t path1,
+                               atlas_rdf_path_t path2);
+
+/*! Path which is either the first or the second path.
+ */
+atlas_rdf_path_t
+atlas_rdf_path_create_alternative(atlas_rdf_path_t path1,
+                                  atlas_rdf_path_t path2);
+
+/*! Path which is the given path repeated zero or more times.
+ */
+atlas_rdf_path_t
+atlas_rdf_path_create_zero_or_more(atlas_rdf_path_t path);
+
+/*! Path which is the given path repeated one or more times.
+ */
+atlas_rdf_path_t
+atlas_rdf_path_create_one_or_more(atlas_rdf_path_t path);
+
+#pragma mark -
+#pragma mark Evaluate a RDF Property Path
+
+/*! Apply a block to the terms reachable from a term by the path.
+ *
+ *  The path is evaluated with a breadth-first search over the
+ *  adjacency index of the graph (see atlas_rdf_graph_describe()),
+ *  large frontiers are expanded concurrently. Each reachable term
+ *  is passed once to the block, which is called sequentially. The
+ *  terms are not retained.
+ *
+ *  \param iterator The block which is called for each term or NULL.
+ *
+ *  \return The number of reachable terms.
+ */
+int
+atlas_rdf_graph_path_apply(atlas_rdf_graph_t graph,
+                           atlas_rdf_term_t start,
+                           atlas_rdf_path_t path,
+                           void(^iterator)(atlas_rdf_term_t term));
+
+/*! Check if a term is reachable from another term by the path.
+ */
+int
+atlas_rdf_graph_path_contains(atlas_rdf_graph_t graph,
+                              atlas_rdf_term_t subject,
+                              atlas_rdf_path_t path,
+                              atlas_rdf_term_t object);
+
+/*! Create a graph with the closure of the path.
+ *
+ *  The graph contains the statement (s, predicate, o) for each
+ *  node s (subject or object) of the given graph and each term o,
+ *  which is reachable from s by the path. If the path admits the
+ *  empty path (e.g. p*), each node is related to itself.
+ *  Terms, which are only used as predicates, are not nodes. The
+ *  nodes are processed concurrently.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_path_closure(atlas_rdf_graph_t graph,
+                                    atlas_rdf_path_t path,
+                                    atlas_rdf_term_t predicate,
+                                    atlas_error_handler err);
+
+#endif // _ATLAS_RDF_PATH_H_
@@ -0,0 +1,82 @@
+/*
+ *  reasoner.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_REASONER_H_
+#define _ATLAS_RDF_REASONER_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/graph.h>
+
+/*! RDFS Materialization
+ *
+ *  The reasoner derives the statements entailed by a graph with the
+ *  RDFS rules for rdfs:subPropertyOf (rdfs5, rdfs7), rdfs:domain
+ *  (rdfs2), rdfs:range (rdfs3) and rdfs:subClassOf (rdfs9, rdfs11)
+ *  and, optionally, with the OWL RL rules for owl:inverseOf,
+ *  owl:SymmetricProperty and owl:TransitiveProperty.
+ *
+ *  The rules are applied with semi-naive forward chaining until no
+ *  new statements are derived: each round joins only the statements
+ *  derived in the previous round with all statements, the joins of
+ *  a round are processed concurrently.
+ */
+
+// also apply the rules of the OWL RL subset
+#define ATLAS_RDF_INFERENCE_OWL 1
+
+#pragma mark -
+#pragma mark Materialize the Entailments of a RDF Graph
+
+/*! Create a graph with the statements entailed by a graph.
+ *
+ *  \param options 0 or ATLAS_RDF_INFERENCE_OWL.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a reference
+ *          count of 1, which contains the entailed statements, which
+ *          are not in the given graph.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_inferred(atlas_rdf_graph_t graph,
+                                int options,
+                                atlas_error_handler err);
+
+/*! Update the entailed statements after statements have been added.
+ *
+ *  Only the consequences of the added statements are derived,
+ *  the inferred graph is taken as already materialized.
+ *
+ *  \param graph The graph.
+ *  \param inferred The statements entailed by the graph (created
+ *                  with the same options).
+ *  \param added The statements added to the graph.
+ *  \param options 0 or ATLAS_RDF_INFERENCE_OWL.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a reference
+ *          count of 1, which contains the statements entailed by the
+ *          union of both graphs, which are not in one of them.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_inferred_incremental(atlas_rdf_graph_t graph,
+                                            atlas_rdf_graph_t inferred,
+                                            atlas_rdf_graph_t added,
+                                            int options,
+                                            atlas_error_handler err);
+
+#endif // _ATLAS_RDF_REASONER_H_
@@ -0,0 +1,144 @@
+/*
+ *  sparql.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_SPARQL_H_
+#define _ATLAS_RDF_SPARQL_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+#include <lazy.h>
+
+/*! Handle for a SPARQL Query
+ *
+ *  A query is an immutable, compiled SPARQL SELECT query
+ *  (http://www.w3.org/TR/rdf-sparql-query/), which can be executed
+ *  on any graph. The following subset of SPARQL is supported:
+ *
+ *  - PREFIX declarations (BASE and relative IRIs are not supported)
+ *  - SELECT with DISTINCT, * or a list of variables and aggregates
+ *    (COUNT, SUM, MIN and MAX of a variable or COUNT(*))
+ *  - basic graph patterns (with ';', ',' and 'a'), FILTER,
+ *    OPTIONAL, UNION and nested groups
+ *  - GROUP BY, ORDER BY (ASC, DESC), LIMIT and OFFSET
+ *
+ *  Filters support the logical, comparison and arithmetic operators
+ *  (with numeric type promotion) and the functions BOUND, isIRI, isURI,
+ *  isBlank, isLiteral, LANG and REGEX (with a constant pattern and the
+ *  flag "i"; POSIX extended regular expressions). The filters are
+ *  compiled once and evaluated for a batch of solutions at once.
+ *
+ *  The query is evaluated on the ids of the terms in the adjacency
+ *  index of the graph (s. atlas_rdf_graph_describe()) and processes
+ *  the solutions in batches. Terms are only looked up to evaluate
+ *  filters, to sort and aggregate the solutions and for the result.
+ *  Comparisons of a variable with a numeric or datetime constant, REGEX
+ *  with a literal pattern and LANG(?x) = "..." restrict the statements
+ *  of the variable with the range and text index of the graph
+ *  (s. atlas_rdf_graph_range() and atlas_rdf_graph_text()).
+ */
+typedef lz_obj atlas_rdf_query_t;
+
+#pragma mark -
+#pragma mark Create a SPARQL Query
+
+/*! Parse and compile a SPARQL SELECT query.
+ *
+ *  \return NULL on failure (a syntax error, which is reported with
+ *          the line number) or a SPARQL Query handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_query_t
+atlas_rdf_query_create(const char * query,
+                       atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Access Details of a SPARQL Query
+
+/*! Number of columns (selected variables) of the result.
+ */
+int
+atlas_rdf_query_num_columns(atlas_rdf_query_t query);
+
+/*! Name of the variable of a column (without '?').
+ *
+ *  The name is owned by the query.
+ */
+const char *
+atlas_rdf_query_column_name(atlas_rdf_query_t query,
+                            int index);
+
+#pragma mark -
+#pragma mark Execute a SPARQL Query
+
+/*! Execute a query on a graph.
+ *
+ *  The block is called sequentially for each solution in the order of
+ *  the result with the values of the columns. A value is NULL if the
+ *  variable is unbound. The terms are not retained and the array
+ *  is only valid during the call. The block may be NULL.
+ *
+ *  \return The number of solutions.
+ */
+int
+atlas_rdf_query_execute(atlas_rdf_query_t query,
+                        atlas_rdf_graph_t graph,
+                        void(^iterator)(atlas_rdf_term_t * values));
+
+#pragma mark -
+#pragma mark Cache the Results of SPARQL Queries
+
+/*! Set the memory limit of the result cache in bytes.
+ *
+ *  The results of atlas_rdf_query_execute() are kept in a cache, which
+ *  is shared by all queries and graphs. A result is found again for the
+ *  same graph (s. lz_obj_same()) and a query with the same compiled form
+ *  and equal constants, even if the text or the names of the variables
+ *  differ. Graphs are immutable, the results of a graph are removed
+ *  when the graph is freed.
+ *
+ *  If the cache exceeds the limit, the least recently used results are
+ *  removed; a result larger than the limit is not cached. The cache is
+ *  disabled by default (a limit of 0).
+ */
+void
+atlas_rdf_query_cache_set_limit(size_t limit);
+
+/*! Memory used by the result cache in bytes.
+ *
+ *  The terms of the results are retained and counted, a term used
+ *  by several values is counted for each of them (even if it is kept
+ *  alive by the graph anyway).
+ */
+size_t
+atlas_rdf_query_cache_memory_size(void);
+
+/*! Number of results in the cache.
+ */
+int
+atlas_rdf_query_cache_length(void);
+
+/*! Remove all results from the cache.
+ */
+void
+atlas_rdf_query_cache_clear(void);
+
+#endif // _ATLAS_RDF_SPARQL_H_
@@ -0,0 +1,112 @@
+/*
+ *  temporal.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_TEMPORAL_H_
+#define _ATLAS_RDF_TEMPORAL_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/term.h>
+#include <atlas/rdf/graph.h>
+
+#include <lazy.h>
+#include <stdint.h>
+#include <time.h>
+
+/*! Handle for a Temporal RDF Graph
+ *
+ *  A temporal graph is an immutable set of statements, each valid
+ *  during the interval [valid_from, valid_to). The statements are
+ *  indexed with an interval tree, the statements valid at a point
+ *  in time or during a period are found in logarithmic time (plus
+ *  the number of results).
+ */
+typedef lz_obj atlas_rdf_temporal_graph_t;
+
+/*! End of a validity interval, which is not bounded.
+ */
+#define ATLAS_RDF_TIME_MAX ((time_t)INT64_MAX)
+
+/*! A Statement with a Validity Interval.
+ */
+typedef struct atlas_rdf_temporal_statement_s {
+    atlas_rdf_term_t subject;
+    atlas_rdf_term_t predicate;
+    atlas_rdf_term_t object;
+    time_t valid_from;
+    time_t valid_to;
+} atlas_rdf_temporal_statement_t;
+
+#pragma mark -
+#pragma mark Create a Temporal RDF Graph
+
+/*! Create a temporal graph with the given statements.
+ *
+ *  The interval of a statement must not be empty (valid_from <
+ *  valid_to). Duplicate statements with the same interval are removed.
+ *
+ *  \return NULL on failure or a Temporal RDF Graph handle
+ *          with a reference count of 1.
+ */
+atlas_rdf_temporal_graph_t
+atlas_rdf_temporal_graph_create(int number_of_statements,
+                                atlas_rdf_temporal_statement_t * statements,
+                                atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Access Details of a Temporal RDF Graph
+
+/*! Number of statements in the temporal graph.
+ */
+int
+atlas_rdf_temporal_graph_length(atlas_rdf_temporal_graph_t graph);
+
+#pragma mark -
+#pragma mark Query a Temporal RDF Graph
+
+/*! State of the graph at a point in time.
+ *
+ *  The result contains the statements valid at the given time and
+ *  refers to the terms of the temporal graph.
+ *
+ *  \return A RDF Graph handle with a reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_temporal_graph_at(atlas_rdf_temporal_graph_t graph,
+                            time_t time);
+
+/*! Apply a block to the statements valid during a period.
+ *
+ *  A statement is valid during [begin, end], if its interval
+ *  overlaps with the period. The block is called sequentially,
+ *  the terms are not retained. The block may be NULL.
+ *
+ *  \return The number of statements valid during the period.
+ */
+int
+atlas_rdf_temporal_graph_during(atlas_rdf_temporal_graph_t graph,
+                                time_t begin,
+                                time_t end,
+                                void(^iterator)(atlas_rdf_term_t subject,
+                                                atlas_rdf_term_t predicate,
+                                                atlas_rdf_term_t object,
+                                                time_t valid_from,
+                                                time_t valid_to));
+
+#endif // _ATLAS_RDF_TEMPORAL_H_
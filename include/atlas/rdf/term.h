@@ -392,7 +392,9 @@ atlas_rdf_term_boolean_value(atlas_rdf_term_t term);
 
 /*! EBV of a RDF Term
  *
- *  This function returns the rbv of a RDF Term.
+ *  This function returns the ebv of a RDF Term: 1 if it is true,
+ *  0 if it is false and -1 if the term has no ebv (a type error,
+ *  e.g., for IRIs, blank nodes and datetimes).
  *
  *  See <http://www.w3.org/TR/rdf-sparql-query/#ebv>.
  */
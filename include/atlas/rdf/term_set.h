@@ -91,6 +91,51 @@ atlas_rdf_term_set_create_difference(atlas_rdf_term_set_t set1,
                                      atlas_rdf_term_set_t set2,
                                      atlas_error_handler err);
 
+/*! Create the union of many RDF Term Sets
+ *
+ *  This function creates the union of all given sets at once,
+ *  without creating intermediate sets. The terms of all sets are
+ *  collected in one shared hash table. If no set is given, the
+ *  result is the empty set.
+ *
+ *  \param number_of_sets Number of sets in the array.
+ *
+ *  \param sets An array of RDF Term Sets.
+ *
+ *  \param err An error handler which is called in case
+ *             of an error with the error message.
+ *
+ *  \return NULL on failure or a RDF Term Set handle
+ *          with a reference count of 1.
+ */
+atlas_rdf_term_set_t
+atlas_rdf_term_set_create_union_n(int number_of_sets,
+                                  atlas_rdf_term_set_t * sets,
+                                  atlas_error_handler err);
+
+/*! Create the intersection of many RDF Term Sets
+ *
+ *  This function creates the intersection of all given sets at once,
+ *  without creating intermediate sets. The sets are processed
+ *  smallest first and the computation stops as soon as the
+ *  intersection is empty. If no set is given, the result is
+ *  the empty set.
+ *
+ *  \param number_of_sets Number of sets in the array.
+ *
+ *  \param sets An array of RDF Term Sets.
+ *
+ *  \param err An error handler which is called in case
+ *             of an error with the error message.
+ *
+ *  \return NULL on failure or a RDF Term Set handle
+ *          with a reference count of 1.
+ */
+atlas_rdf_term_set_t
+atlas_rdf_term_set_create_intersection_n(int number_of_sets,
+                                         atlas_rdf_term_set_t * sets,
+                                         atlas_error_handler err);
+
 #pragma mark -
 #pragma mark Access Details of a RDF Term Set
 
@@ -110,6 +155,62 @@ void
 atlas_rdf_term_set_apply(atlas_rdf_term_set_t set,
                          void(^iterator)(atlas_rdf_term_t term));
 
+/*! Apply a block to each term in the set, processing ranges of terms.
+ *
+ *  This function splits the set into contiguous ranges of terms and
+ *  processes the ranges concurrently. Each worker processing ranges
+ *  has its own state, which is created by the block init and passed
+ *  to each call of the iterator. After all terms have been processed,
+ *  the block finish is called sequentially for each state, which makes
+ *  reductions (e.g., counting or collecting terms) possible without
+ *  locks.
+ *
+ *  \param grain_size Number of terms in a range or 0 to choose the
+ *                    size depending on the size of the set and the
+ *                    number of CPUs.
+ *
+ *  \param init A block returning a new state or NULL.
+ *
+ *  \param iterator The block which is called for each term, with the
+ *                  state of the worker.
+ *
+ *  \param finish A block which is called for each state or NULL.
+ */
+void
+atlas_rdf_term_set_apply_chunked(atlas_rdf_term_set_t set,
+                                 int grain_size,
+                                 void *(^init)(void),
+                                 void(^iterator)(void * state, atlas_rdf_term_t term),
+                                 void(^finish)(void * state));
+
+/*! Reduce the terms in the set in parallel.
+ *
+ *  This function aggregates the terms in the set (e.g., counts
+ *  or collects them). Each worker keeps a private accumulator, which
+ *  is created by the block init and updated by the block accumulate
+ *  for each term. Afterwards the accumulators of the workers are
+ *  merged pairwise (tree-style) by the block combine.
+ *
+ *  \param init A block returning a new accumulator.
+ *
+ *  \param accumulate A block which is called for each term with the
+ *                    accumulator of the worker and returns the
+ *                    updated accumulator.
+ *
+ *  \param combine A block which merges two accumulators and returns
+ *                 the result. It must be associative and commutative
+ *                 and is responsible to free the accumulators which
+ *                 are not returned.
+ *
+ *  \return The final accumulator, or the result of init, if the
+ *          set is empty.
+ */
+void *
+atlas_rdf_term_set_reduce(atlas_rdf_term_set_t set,
+                          void *(^init)(void),
+                          void *(^accumulate)(void * acc, atlas_rdf_term_t term),
+                          void *(^combine)(void * acc1, void * acc2));
+
 /*! Apply a block to each term in the set.
  *
  *  This function calls the given block for each
@@ -0,0 +1,94 @@
+/*
+ *  turtle.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ATLAS_RDF_TURTLE_H_
+#define _ATLAS_RDF_TURTLE_H_
+
+#include <atlas/base.h>
+#include <atlas/rdf/graph.h>
+#include <atlas/rdf/graph_builder.h>
+
+#include <stddef.h>
+
+/*! Turtle
+ *
+ *  The functions in this file read statements in the Turtle format
+ *  (http://www.w3.org/TeamSubmission/turtle/). Prefixes, base IRIs,
+ *  predicate and object lists, blank node property lists, collections
+ *  and the shorthand for numeric and boolean literals are supported.
+ *
+ *  Numeric and boolean literals are created with the constructors of
+ *  the corresponding literal types (e.g., atlas_rdf_term_create_integer()).
+ *  IRIs with a prefix are created by appending the local name to the
+ *  prefix, without checking the resulting IRI again.
+ *
+ *  Blank nodes with a label keep the label, blank nodes without a label
+ *  (i.e., [] and collections) get the label "genid" followed by a number.
+ *  A label, which already starts with "genid", is prefixed with "genid-".
+ */
+
+#pragma mark -
+#pragma mark Parse Turtle
+
+/*! Parse Turtle data and add the statements to the builder.
+ *
+ *  Relative IRIs are resolved against the base IRI, which can be
+ *  changed in the data with @base. If base is NULL, the data must
+ *  not contain relative IRIs before the first @base.
+ *
+ *  \return 0 on failure (a syntax error, which is reported with
+ *          the line number), else != 0. On failure, the builder
+ *          contains the statements up to the error.
+ */
+int
+atlas_rdf_turtle_parse(atlas_rdf_graph_builder_t builder,
+                       const char * data,
+                       size_t length,
+                       const char * base,
+                       atlas_error_handler err);
+
+#pragma mark -
+#pragma mark Create a RDF Graph from Turtle
+
+/*! Create a RDF Graph from Turtle data.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_create_from_turtle(const char * data,
+                                   size_t length,
+                                   const char * base,
+                                   atlas_error_handler err);
+
+/*! Create a RDF Graph from a Turtle file.
+ *
+ *  If base is NULL, the IRI of the file (file://...) is used
+ *  as base IRI.
+ *
+ *  \return NULL on failure or a RDF Graph handle with a
+ *          reference count of 1.
+ */
+atlas_rdf_graph_t
+atlas_rdf_graph_open_turtle(const char * path,
+                            const char * base,
+                            atlas_error_handler err);
+
+#endif // _ATLAS_RDF_TURTLE_H_
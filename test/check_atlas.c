@@ -27,6 +27,18 @@
 #include "test_atlas_rdf_term_impl.h"
 #include "test_atlas_rdf_term_set_impl.h"
 #include "test_atlas_rdf_graph_impl.h"
+#include "test_atlas_rdf_graph_builder_impl.h"
+#include "test_atlas_rdf_changeset_impl.h"
+#include "test_atlas_rdf_graph_file_impl.h"
+#include "test_atlas_rdf_ntriples_impl.h"
+#include "test_atlas_rdf_turtle_impl.h"
+#include "test_atlas_rdf_hdt_impl.h"
+#include "test_atlas_rdf_graph_stats_impl.h"
+#include "test_atlas_rdf_path_impl.h"
+#include "test_atlas_rdf_reasoner_impl.h"
+#include "test_atlas_rdf_dataset_impl.h"
+#include "test_atlas_rdf_temporal_impl.h"
+#include "test_atlas_rdf_sparql_impl.h"
 
 #include "test_atlas_shape_impl.h"
 #include "test_atlas_shape_impl_geometry.h"
@@ -70,6 +82,18 @@ int main(int argc, char ** argv) {
     srunner_add_suite(sr, rdf_term_suite());
     srunner_add_suite(sr, rdf_term_set_suite());
 	srunner_add_suite(sr, rdf_graph_suite());
+	srunner_add_suite(sr, rdf_graph_builder_suite());
+	srunner_add_suite(sr, rdf_changeset_suite());
+	srunner_add_suite(sr, rdf_graph_file_suite());
+	srunner_add_suite(sr, rdf_ntriples_suite());
+	srunner_add_suite(sr, rdf_turtle_suite());
+	srunner_add_suite(sr, rdf_hdt_suite());
+	srunner_add_suite(sr, rdf_graph_stats_suite());
+	srunner_add_suite(sr, rdf_path_suite());
+	srunner_add_suite(sr, rdf_reasoner_suite());
+	srunner_add_suite(sr, rdf_dataset_suite());
+	srunner_add_suite(sr, rdf_temporal_suite());
+	srunner_add_suite(sr, rdf_sparql_suite());
 	
 	srunner_add_suite(sr, shape_impl_suite());
     srunner_add_suite(sr, shape_impl_geometry_suite());
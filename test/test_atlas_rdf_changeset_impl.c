@@ -0,0 +1,349 @@
+/*
+ *  test_atlas_rdf_changeset_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_changeset_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+#include "atlas_rdf_graph_impl.h"
+
+
+#pragma mark -
+#pragma mark Test Create RDF Changeset
+
+#pragma mark test_create_rdf_changeset
+
+START_TEST (test_create_rdf_changeset) {
+    
+    atlas_rdf_term_t sub1, pred1, obj1;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[1];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj1;
+    
+    atlas_rdf_graph_t added = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+    atlas_rdf_graph_t removed = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    
+    atlas_rdf_changeset_t changeset = atlas_rdf_changeset_create(added, removed, ^(int err, const char * msg){});
+    fail_if(changeset == 0);
+    if (changeset) {
+        fail_unless(lz_obj_same(atlas_rdf_changeset_added(changeset), added));
+        fail_unless(lz_obj_same(atlas_rdf_changeset_removed(changeset), removed));
+        lz_release(changeset);
+    }
+    
+    lz_release(added);
+    lz_release(removed);
+    
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(obj1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Test Create a new Version of a RDF Graph
+
+#pragma mark test_create_rdf_graph_version
+
+START_TEST (test_create_rdf_graph_version) {
+    
+    atlas_rdf_term_t sub1, pred1, pred2;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/position", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/speed", ^(int err, const char * msg){});
+    
+    // create a graph, which is larger than a chunk
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<10000; i++) {
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(i, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, sub1, pred1, obj, ^(int err, const char * msg){});
+        lz_release(obj);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    fail_unless(atlas_rdf_graph_length(graph) == 10000);
+    
+    atlas_rdf_term_t obj5 = atlas_rdf_term_create_double(5, ^(int err, const char * msg){});
+    atlas_rdf_term_t obj7 = atlas_rdf_term_create_double(7, ^(int err, const char * msg){});
+    atlas_rdf_term_t obj9000 = atlas_rdf_term_create_double(9000, ^(int err, const char * msg){});
+    atlas_rdf_term_t speed = atlas_rdf_term_create_double(42.5, ^(int err, const char * msg){});
+    
+    // first version: remove a statement, add a new one and
+    // one which is already in the graph
+    atlas_rdf_statement_t statements[2];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj5;
+    atlas_rdf_graph_t removed = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+    statements[0].subject = sub1;
+    statements[0].predicate = pred2;
+    statements[0].object = speed;
+    statements[1].subject = sub1;
+    statements[1].predicate = pred1;
+    statements[1].object = obj7;
+    atlas_rdf_graph_t added = atlas_rdf_graph_create(2, statements, ^(int err, const char * msg){});
+    
+    atlas_rdf_changeset_t changeset = atlas_rdf_changeset_create(added, removed, ^(int err, const char * msg){});
+    atlas_rdf_graph_t version1 = atlas_rdf_graph_create_version(graph, changeset, ^(int err, const char * msg){});
+    fail_if(version1 == 0);
+    lz_release(changeset);
+    lz_release(added);
+    lz_release(removed);
+    
+    fail_unless(atlas_rdf_graph_length(version1) == 10000);
+    fail_if(atlas_rdf_graph_contains(version1, sub1, pred1, obj5));
+    fail_unless(atlas_rdf_graph_contains(version1, sub1, pred1, obj7));
+    fail_unless(atlas_rdf_graph_contains(version1, sub1, pred2, speed));
+    fail_unless(atlas_rdf_graph_contains(version1, sub1, pred1, obj9000));
+    
+    // the original graph is not modified
+    fail_unless(atlas_rdf_graph_length(graph) == 10000);
+    fail_unless(atlas_rdf_graph_contains(graph, sub1, pred1, obj5));
+    fail_if(atlas_rdf_graph_contains(graph, sub1, pred2, speed));
+    
+    // second version: remove a statement of the first version
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj9000;
+    removed = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+    added = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    changeset = atlas_rdf_changeset_create(added, removed, ^(int err, const char * msg){});
+    atlas_rdf_graph_t version2 = atlas_rdf_graph_create_version(version1, changeset, ^(int err, const char * msg){});
+    fail_if(version2 == 0);
+    lz_release(changeset);
+    lz_release(added);
+    lz_release(removed);
+    
+    // the first version is still a consistent snapshot,
+    // even if the graph it is based on is released
+    lz_release(graph);
+    fail_unless(atlas_rdf_graph_length(version2) == 9999);
+    fail_if(atlas_rdf_graph_contains(version2, sub1, pred1, obj9000));
+    fail_unless(atlas_rdf_graph_contains(version2, sub1, pred2, speed));
+    fail_unless(atlas_rdf_graph_length(version1) == 10000);
+    fail_unless(atlas_rdf_graph_contains(version1, sub1, pred1, obj9000));
+    
+    // iterate over all statements of the chunked version
+    __block int num_pred1 = 0;
+    atlas_rdf_graph_apply_chunked(version2, 0, ^{
+        return (void *)calloc(1, sizeof(int));
+    }, ^(void * state,
+         atlas_rdf_term_t subject,
+         atlas_rdf_term_t predicate,
+         atlas_rdf_term_t object){
+        if (atlas_rdf_term_eq(predicate, pred1)) {
+            (*(int *)state)++;
+        }
+    }, ^(void * state){
+        num_pred1 += *(int *)state;
+        free(state);
+    });
+    fail_unless(num_pred1 == 9998);
+    
+    atlas_rdf_graph_cursor_t cursor = atlas_rdf_graph_cursor_create_range(version2, 4090, 4100);
+    atlas_rdf_statement_t stm;
+    int num_statements = 0;
+    while (atlas_rdf_graph_cursor_next(cursor, &stm)) {
+        fail_unless(atlas_rdf_graph_contains(version2, stm.subject, stm.predicate, stm.object));
+        num_statements++;
+    }
+    fail_unless(num_statements == 10);
+    atlas_rdf_graph_cursor_close(cursor);
+    
+    lz_release(version1);
+    lz_release(version2);
+    
+    lz_release(obj5);
+    lz_release(obj7);
+    lz_release(obj9000);
+    lz_release(speed);
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(pred2);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_create_rdf_graph_version_remove_and_add
+
+START_TEST (test_create_rdf_graph_version_remove_and_add) {
+    
+    atlas_rdf_term_t sub1, pred1, obj1;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[1];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj1;
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+    
+    // a statement which is removed and added is in the new version
+    atlas_rdf_changeset_t changeset = atlas_rdf_changeset_create(graph, graph, ^(int err, const char * msg){});
+    atlas_rdf_graph_t version = atlas_rdf_graph_create_version(graph, changeset, ^(int err, const char * msg){});
+    fail_if(version == 0);
+    fail_unless(atlas_rdf_graph_length(version) == 1);
+    fail_unless(atlas_rdf_graph_contains(version, sub1, pred1, obj1));
+    lz_release(version);
+    lz_release(changeset);
+    
+    // removing all statements results in an empty graph
+    atlas_rdf_graph_t empty = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    changeset = atlas_rdf_changeset_create(empty, graph, ^(int err, const char * msg){});
+    version = atlas_rdf_graph_create_version(graph, changeset, ^(int err, const char * msg){});
+    fail_if(version == 0);
+    fail_unless(atlas_rdf_graph_length(version) == 0);
+    lz_release(version);
+    lz_release(changeset);
+    
+    // an empty changeset returns the same graph
+    changeset = atlas_rdf_changeset_create(empty, empty, ^(int err, const char * msg){});
+    version = atlas_rdf_graph_create_version(graph, changeset, ^(int err, const char * msg){});
+    fail_unless(lz_obj_same(version, graph));
+    lz_release(version);
+    lz_release(changeset);
+    
+    lz_release(empty);
+    lz_release(graph);
+    
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(obj1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_create_rdf_graph_version_many
+
+START_TEST (test_create_rdf_graph_version_many) {
+    
+    atlas_rdf_term_t sub1, pred1, pred2;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/position", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/speed", ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<10000; i++) {
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(i, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, sub1, pred1, obj, ^(int err, const char * msg){});
+        lz_release(obj);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    // each version replaces the speed and adds a position
+    atlas_rdf_term_t speed = 0;
+    atlas_rdf_statement_t statements[2];
+    for (int i=0; i<500; i++) {
+        atlas_rdf_graph_t removed;
+        if (speed) {
+            statements[0].subject = sub1;
+            statements[0].predicate = pred2;
+            statements[0].object = speed;
+            removed = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+            lz_release(speed);
+        } else {
+            removed = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+        }
+        speed = atlas_rdf_term_create_double(0.5 + i, ^(int err, const char * msg){});
+        atlas_rdf_term_t position = atlas_rdf_term_create_double(10000 + i, ^(int err, const char * msg){});
+        statements[0].subject = sub1;
+        statements[0].predicate = pred2;
+        statements[0].object = speed;
+        statements[1].subject = sub1;
+        statements[1].predicate = pred1;
+        statements[1].object = position;
+        atlas_rdf_graph_t added = atlas_rdf_graph_create(2, statements, ^(int err, const char * msg){});
+        lz_release(position);
+        
+        atlas_rdf_changeset_t changeset = atlas_rdf_changeset_create(added, removed, ^(int err, const char * msg){});
+        atlas_rdf_graph_t version = atlas_rdf_graph_create_version(graph, changeset, ^(int err, const char * msg){});
+        fail_if(version == 0);
+        lz_release(changeset);
+        lz_release(added);
+        lz_release(removed);
+        lz_release(graph);
+        graph = version;
+        
+        // small parts are merged, all other parts are at
+        // least filled to a quarter of a chunk (1024 statements)
+        fail_unless(atlas_rdf_graph_length(graph) == 10001 + i);
+        fail_unless(atlas_rdf_graph_num_parts(graph) <= atlas_rdf_graph_length(graph) / 1024 + 1);
+    }
+    fail_unless(atlas_rdf_graph_contains(graph, sub1, pred2, speed));
+    
+    lz_release(graph);
+    lz_release(speed);
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(pred2);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Changeset Suites
+
+Suite * rdf_changeset_suite(void) {
+    Suite *s = suite_create("RDF Changeset");
+    
+    TCase *tc_create = tcase_create("Create");
+    tcase_add_checked_fixture (tc_create, setup, teardown);
+    tcase_add_test(tc_create, test_create_rdf_changeset);
+    
+    TCase *tc_version = tcase_create("Version");
+    tcase_add_checked_fixture (tc_version, setup, teardown);
+    tcase_add_test(tc_version, test_create_rdf_graph_version);
+    tcase_add_test(tc_version, test_create_rdf_graph_version_remove_and_add);
+    tcase_add_test(tc_version, test_create_rdf_graph_version_many);
+    
+    suite_add_tcase(s, tc_create);
+    suite_add_tcase(s, tc_version);
+    
+    return s;
+}
@@ -0,0 +1,259 @@
+/*
+ *  test_atlas_rdf_dataset_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_dataset_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+#define EX "http://example.com/"
+
+// create a dataset from quads with iris, the array contains
+// the graph, subject, predicate and object of each quad
+static atlas_rdf_dataset_t
+create_dataset(int num_quads, const char ** iris) {
+    atlas_rdf_quad_t * quads = malloc(sizeof(atlas_rdf_quad_t) * num_quads);
+    assert(quads != 0);
+    for (int i=0; i<num_quads; i++) {
+        quads[i].graph = atlas_rdf_term_create_iri(iris[4 * i + 0], ^(int err, const char * msg){});
+        quads[i].subject = atlas_rdf_term_create_iri(iris[4 * i + 1], ^(int err, const char * msg){});
+        quads[i].predicate = atlas_rdf_term_create_iri(iris[4 * i + 2], ^(int err, const char * msg){});
+        quads[i].object = atlas_rdf_term_create_iri(iris[4 * i + 3], ^(int err, const char * msg){});
+    }
+    atlas_rdf_dataset_t dataset = atlas_rdf_dataset_create(num_quads, quads, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    for (int i=0; i<num_quads; i++) {
+        lz_release(quads[i].graph);
+        lz_release(quads[i].subject);
+        lz_release(quads[i].predicate);
+        lz_release(quads[i].object);
+    }
+    free(quads);
+    return dataset;
+}
+
+// match a pattern of iris, a NULL iri is a wildcard
+static int
+match(atlas_rdf_dataset_t dataset, const char * g, const char * s, const char * p, const char * o) {
+    const char * iris[4] = {g, s, p, o};
+    atlas_rdf_term_t terms[4];
+    for (int i=0; i<4; i++) {
+        terms[i] = iris[i] ? atlas_rdf_term_create_iri(iris[i], ^(int err, const char * msg){}) : 0;
+    }
+    atlas_rdf_term_t * pattern = terms;
+    __block int calls = 0;
+    int result = atlas_rdf_dataset_match(dataset, terms[0], terms[1], terms[2], terms[3],
+                                         ^(atlas_rdf_term_t graph,
+                                           atlas_rdf_term_t subject,
+                                           atlas_rdf_term_t predicate,
+                                           atlas_rdf_term_t object){
+        for (int i=0; i<4; i++) {
+            atlas_rdf_term_t term = i == 0 ? graph : i == 1 ? subject : i == 2 ? predicate : object;
+            fail_unless(pattern[i] == 0 || atlas_rdf_term_eq(pattern[i], term));
+        }
+        calls++;
+    });
+    fail_unless(result == calls);
+    for (int i=0; i<4; i++) {
+        if (terms[i]) lz_release(terms[i]);
+    }
+    return result;
+}
+
+static const char * quads[] = {
+    EX "g1", EX "a", EX "knows", EX "b",
+    EX "g1", EX "a", EX "knows", EX "c",
+    EX "g1", EX "b", EX "knows", EX "c",
+    EX "g1", EX "a", EX "name", EX "A",
+    EX "g2", EX "a", EX "knows", EX "b",
+    EX "g2", EX "c", EX "likes", EX "a",
+    EX "g1", EX "a", EX "knows", EX "b"
+};
+
+#pragma mark -
+#pragma mark Test RDF Dataset
+
+#pragma mark test_rdf_dataset_create
+
+START_TEST (test_rdf_dataset_create) {
+    
+    atlas_rdf_dataset_t dataset = create_dataset(7, quads);
+    fail_if(dataset == 0);
+    
+    // the duplicate is removed and the terms are shared
+    fail_unless(atlas_rdf_dataset_length(dataset) == 6);
+    fail_unless(atlas_rdf_dataset_num_graphs(dataset) == 2);
+    fail_unless(atlas_rdf_dataset_num_terms(dataset) == 9);
+    
+    __block int count = 0;
+    atlas_rdf_dataset_apply(dataset, ^(atlas_rdf_term_t graph,
+                                       atlas_rdf_term_t subject,
+                                       atlas_rdf_term_t predicate,
+                                       atlas_rdf_term_t object){
+        __sync_add_and_fetch(&count, 1);
+    });
+    fail_unless(count == 6);
+    
+    // an invalid quad
+    atlas_rdf_term_t iri = atlas_rdf_term_create_iri(EX "a", ^(int err, const char * msg){});
+    atlas_rdf_term_t literal = atlas_rdf_term_create_string("a", 0, ^(int err, const char * msg){});
+    atlas_rdf_quad_t invalid = {literal, iri, iri, iri};
+    __block int errors = 0;
+    fail_unless(atlas_rdf_dataset_create(1, &invalid, ^(int err, const char * msg){
+        errors++;
+    }) == 0);
+    fail_unless(errors == 1);
+    
+    lz_release(iri);
+    lz_release(literal);
+    lz_release(dataset);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_dataset_match
+
+START_TEST (test_rdf_dataset_match) {
+    
+    atlas_rdf_dataset_t dataset = create_dataset(7, quads);
+    
+    fail_unless(match(dataset, 0, 0, 0, 0) == 6);
+    fail_unless(match(dataset, EX "g1", 0, 0, 0) == 4);
+    fail_unless(match(dataset, EX "g2", 0, 0, 0) == 2);
+    fail_unless(match(dataset, EX "g3", 0, 0, 0) == 0);
+    
+    // subject bound (GSPO)
+    fail_unless(match(dataset, 0, EX "a", 0, 0) == 4);
+    fail_unless(match(dataset, EX "g1", EX "a", EX "knows", 0) == 2);
+    fail_unless(match(dataset, EX "g1", EX "a", EX "knows", EX "c") == 1);
+    fail_unless(match(dataset, EX "g1", EX "a", 0, EX "b") == 1);
+    
+    // predicate bound (GPOS)
+    fail_unless(match(dataset, 0, 0, EX "knows", 0) == 4);
+    fail_unless(match(dataset, EX "g1", 0, EX "knows", EX "c") == 2);
+    fail_unless(match(dataset, EX "g2", 0, EX "likes", EX "a") == 1);
+    
+    // only the object bound
+    fail_unless(match(dataset, 0, 0, 0, EX "b") == 2);
+    
+    // a graph name is not a graph in an other position
+    fail_unless(match(dataset, EX "a", 0, 0, 0) == 0);
+    fail_unless(match(dataset, 0, EX "g1", 0, 0) == 0);
+    
+    atlas_rdf_term_t g2 = atlas_rdf_term_create_iri(EX "g2", ^(int err, const char * msg){});
+    atlas_rdf_term_t c = atlas_rdf_term_create_iri(EX "c", ^(int err, const char * msg){});
+    atlas_rdf_term_t likes = atlas_rdf_term_create_iri(EX "likes", ^(int err, const char * msg){});
+    atlas_rdf_term_t a = atlas_rdf_term_create_iri(EX "a", ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_dataset_contains(dataset, g2, c, likes, a));
+    fail_if(atlas_rdf_dataset_contains(dataset, g2, a, likes, c));
+    lz_release(g2);
+    lz_release(c);
+    lz_release(likes);
+    lz_release(a);
+    
+    lz_release(dataset);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_dataset_graph
+
+START_TEST (test_rdf_dataset_graph) {
+    
+    atlas_rdf_dataset_t dataset = create_dataset(7, quads);
+    
+    atlas_rdf_term_t g1 = atlas_rdf_term_create_iri(EX "g1", ^(int err, const char * msg){});
+    atlas_rdf_term_t g3 = atlas_rdf_term_create_iri(EX "g3", ^(int err, const char * msg){});
+    atlas_rdf_term_t a = atlas_rdf_term_create_iri(EX "a", ^(int err, const char * msg){});
+    atlas_rdf_term_t knows = atlas_rdf_term_create_iri(EX "knows", ^(int err, const char * msg){});
+    atlas_rdf_term_t c = atlas_rdf_term_create_iri(EX "c", ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_t graph = atlas_rdf_dataset_graph(dataset, g1);
+    fail_unless(atlas_rdf_graph_length(graph) == 4);
+    fail_unless(atlas_rdf_graph_contains(graph, a, knows, c));
+    
+    // the view is a graph with only the terms it uses
+    atlas_rdf_graph_t empty = atlas_rdf_dataset_graph(dataset, g3);
+    fail_unless(atlas_rdf_graph_length(empty) == 0);
+    
+    // a dataset created from the views is the same dataset
+    atlas_rdf_term_t names[2] = {g1, g3};
+    atlas_rdf_graph_t graphs[2] = {graph, empty};
+    atlas_rdf_dataset_t copy = atlas_rdf_dataset_create_from_graphs(2, names, graphs, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(copy == 0);
+    fail_unless(atlas_rdf_dataset_length(copy) == 4);
+    fail_unless(atlas_rdf_dataset_num_graphs(copy) == 2);
+    fail_unless(atlas_rdf_dataset_num_terms(copy) == 8);
+    fail_unless(match(copy, EX "g1", EX "a", EX "knows", 0) == 2);
+    fail_unless(match(copy, EX "g3", 0, 0, 0) == 0);
+    
+    lz_release(copy);
+    lz_release(graph);
+    lz_release(empty);
+    lz_release(g1);
+    lz_release(g3);
+    lz_release(a);
+    lz_release(knows);
+    lz_release(c);
+    lz_release(dataset);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Dataset Suites
+
+Suite * rdf_dataset_suite(void) {
+    Suite *s = suite_create("RDF Dataset");
+    
+    TCase *tc_dataset = tcase_create("Quads");
+    tcase_add_checked_fixture (tc_dataset, setup, teardown);
+    tcase_add_test(tc_dataset, test_rdf_dataset_create);
+    tcase_add_test(tc_dataset, test_rdf_dataset_match);
+    tcase_add_test(tc_dataset, test_rdf_dataset_graph);
+    
+    suite_add_tcase(s, tc_dataset);
+    
+    return s;
+}
@@ -0,0 +1,192 @@
+/*
+ *  test_atlas_rdf_graph_builder_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_graph_builder_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Add Statements
+
+#pragma mark test_rdf_graph_builder_add
+
+START_TEST (test_rdf_graph_builder_add) {
+    
+    // create some terms to store in the graph
+    atlas_rdf_term_t sub1, sub2, pred1, pred2, obj1;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    sub2 = atlas_rdf_term_create_blank_node("bar", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    fail_if(builder == 0);
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 0);
+    
+    // add statements one by one
+    fail_unless(atlas_rdf_graph_builder_add(builder, sub1, pred1, obj1, ^(int err, const char * msg){}));
+    fail_unless(atlas_rdf_graph_builder_add(builder, sub1, pred2, obj1, ^(int err, const char * msg){}));
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 2);
+    
+    // duplicates are not added
+    fail_unless(atlas_rdf_graph_builder_add(builder, sub1, pred1, obj1, ^(int err, const char * msg){}));
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 2);
+    
+    // a literal is not a valid subject
+    __block int error_called = 0;
+    fail_if(atlas_rdf_graph_builder_add(builder, obj1, pred1, sub1, ^(int err, const char * msg){
+        error_called = 1;
+    }));
+    fail_unless(error_called);
+    
+    // a blank node is not a valid predicate
+    error_called = 0;
+    fail_if(atlas_rdf_graph_builder_add(builder, sub1, sub2, obj1, ^(int err, const char * msg){
+        error_called = 1;
+    }));
+    fail_unless(error_called);
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 2);
+    
+    // add a batch of statements
+    atlas_rdf_statement_t statements[3];
+    statements[0].subject = sub2;
+    statements[0].predicate = pred1;
+    statements[0].object = obj1;
+    statements[1].subject = sub1;
+    statements[1].predicate = pred2;
+    statements[1].object = obj1;
+    statements[2].subject = sub2;
+    statements[2].predicate = pred2;
+    statements[2].object = sub1;
+    fail_unless(atlas_rdf_graph_builder_add_statements(builder, 3, statements, ^(int err, const char * msg){}));
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 4);
+    
+    atlas_rdf_graph_builder_free(builder);
+    
+    lz_release(sub1);
+    lz_release(sub2);
+    lz_release(pred1);
+    lz_release(pred2);
+    lz_release(obj1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Test Commit
+
+#pragma mark test_rdf_graph_builder_commit
+
+START_TEST (test_rdf_graph_builder_commit) {
+    
+    // create some terms to store in the graph
+    atlas_rdf_term_t sub1, pred1, pred2;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(4);
+    
+    // an empty builder results in an empty graph
+    atlas_rdf_graph_t graph0 = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    fail_if(graph0 == 0);
+    fail_unless(atlas_rdf_graph_length(graph0) == 0);
+    
+    // add more statements than the initial capacity, the
+    // terms are released by the caller before the commit
+    for (int i=0; i<1000; i++) {
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(i % 500, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, sub1, pred1, obj, ^(int err, const char * msg){});
+        lz_release(obj);
+    }
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 500);
+    
+    atlas_rdf_graph_t graph1 = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    fail_if(graph1 == 0);
+    fail_unless(atlas_rdf_graph_length(graph1) == 500);
+    
+    // the builder can be used after the commit, the
+    // committed graph is not affected
+    atlas_rdf_graph_builder_add(builder, sub1, pred2, sub1, ^(int err, const char * msg){});
+    atlas_rdf_graph_t graph2 = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    fail_if(graph2 == 0);
+    fail_unless(atlas_rdf_graph_length(graph1) == 500);
+    fail_unless(atlas_rdf_graph_length(graph2) == 501);
+    fail_unless(atlas_rdf_graph_contains(graph2, sub1, pred2, sub1));
+    fail_if(atlas_rdf_graph_contains(graph1, sub1, pred2, sub1));
+    
+    atlas_rdf_graph_builder_free(builder);
+    
+    // the graph keeps its terms
+    atlas_rdf_term_t obj = atlas_rdf_term_create_double(42, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_contains(graph1, sub1, pred1, obj));
+    lz_release(obj);
+    
+    lz_release(graph0);
+    lz_release(graph1);
+    lz_release(graph2);
+    
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(pred2);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Graph Builder Suites
+
+Suite * rdf_graph_builder_suite(void) {
+    Suite *s = suite_create("RDF Graph Builder");
+    
+    TCase *tc_add = tcase_create("Add");
+    tcase_add_checked_fixture (tc_add, setup, teardown);
+    tcase_add_test(tc_add, test_rdf_graph_builder_add);
+    
+    TCase *tc_commit = tcase_create("Commit");
+    tcase_add_checked_fixture (tc_commit, setup, teardown);
+    tcase_add_test(tc_commit, test_rdf_graph_builder_commit);
+    
+    suite_add_tcase(s, tc_add);
+    suite_add_tcase(s, tc_commit);
+    
+    return s;
+}
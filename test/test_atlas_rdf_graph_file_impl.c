@@ -0,0 +1,341 @@
+/*
+ *  test_atlas_rdf_graph_file_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_graph_file_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Write and Open RDF Graph Files
+
+#pragma mark test_rdf_graph_file
+
+START_TEST (test_rdf_graph_file) {
+    
+    // create terms of all kinds
+    atlas_rdf_term_t sub1, pred1, type, obj[7];
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    type = atlas_rdf_term_create_iri("http://example.com/type", ^(int err, const char * msg){});
+    
+    mpz_t i;
+    mpz_init_set_str(i, "123456789012345678901234567890", 10);
+    obj[0] = atlas_rdf_term_create_integer(i, ^(int err, const char * msg){});
+    mpz_clear(i);
+    
+    obj[1] = atlas_rdf_term_create_string("foo", "de", ^(int err, const char * msg){});
+    obj[2] = atlas_rdf_term_create_typed("foo", type, ^(int err, const char * msg){});
+    obj[3] = atlas_rdf_term_create_double(42.5, ^(int err, const char * msg){});
+    obj[4] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    obj[5] = atlas_rdf_term_create_datetime(1272448800, ^(int err, const char * msg){});
+    obj[6] = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[7];
+    for (int k=0; k<7; k++) {
+        statements[k].subject = sub1;
+        statements[k].predicate = pred1;
+        statements[k].object = obj[k];
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(7, statements, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    
+    char path[] = "/tmp/atlas_test_graph_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    close(fd);
+    
+    fail_unless(atlas_rdf_graph_write_file(graph, path, ^(int err, const char * msg){}));
+    
+    atlas_rdf_graph_t opened = atlas_rdf_graph_open_file(path, ^(int err, const char * msg){});
+    fail_if(opened == 0);
+    if (opened) {
+        fail_unless(atlas_rdf_graph_length(opened) == 7);
+        for (int k=0; k<7; k++) {
+            fail_unless(atlas_rdf_graph_contains(opened, sub1, pred1, obj[k]));
+        }
+        
+        // the type of the typed literal is restored
+        __block int num_typed = 0;
+        atlas_rdf_graph_apply_chunked(opened, 1, 0, ^(void * state,
+                                                      atlas_rdf_term_t subject,
+                                                      atlas_rdf_term_t predicate,
+                                                      atlas_rdf_term_t object){
+            if (atlas_rdf_term_type(object) == TYPED_LITERAL) {
+                atlas_rdf_term_t t = atlas_rdf_term_typed_type(object);
+                fail_unless(atlas_rdf_term_eq(t, type));
+                lz_release(t);
+                __sync_fetch_and_add(&num_typed, 1);
+            }
+        }, 0);
+        fail_unless(num_typed == 1);
+        
+        // an opened graph can be used like any other graph
+        atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(opened, graph, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff) == 0);
+        lz_release(diff);
+        
+        lz_release(opened);
+    }
+    
+    unlink(path);
+    lz_release(graph);
+    
+    for (int k=0; k<7; k++) {
+        lz_release(obj[k]);
+    }
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(type);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_file_chunked
+
+START_TEST (test_rdf_graph_file_chunked) {
+    
+    atlas_rdf_term_t sub1, pred1;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<10000; i++) {
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(i, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, sub1, pred1, obj, ^(int err, const char * msg){});
+        lz_release(obj);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    // create a chunked version of the graph
+    atlas_rdf_term_t obj = atlas_rdf_term_create_double(5, ^(int err, const char * msg){});
+    atlas_rdf_statement_t statements[1];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj;
+    atlas_rdf_graph_t removed = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+    atlas_rdf_graph_t added = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    atlas_rdf_changeset_t changeset = atlas_rdf_changeset_create(added, removed, ^(int err, const char * msg){});
+    atlas_rdf_graph_t version = atlas_rdf_graph_create_version(graph, changeset, ^(int err, const char * msg){});
+    lz_release(changeset);
+    lz_release(added);
+    lz_release(removed);
+    
+    char path[] = "/tmp/atlas_test_graph_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    close(fd);
+    
+    fail_unless(atlas_rdf_graph_write_file(version, path, ^(int err, const char * msg){}));
+    atlas_rdf_graph_t opened = atlas_rdf_graph_open_file(path, ^(int err, const char * msg){});
+    fail_if(opened == 0);
+    if (opened) {
+        fail_unless(atlas_rdf_graph_length(opened) == 9999);
+        fail_if(atlas_rdf_graph_contains(opened, sub1, pred1, obj));
+        
+        atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(version, opened, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff) == 0);
+        lz_release(diff);
+        lz_release(opened);
+    }
+    
+    unlink(path);
+    lz_release(version);
+    lz_release(graph);
+    lz_release(obj);
+    lz_release(sub1);
+    lz_release(pred1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_file_invalid
+
+START_TEST (test_rdf_graph_file_invalid) {
+    
+    // a file which does not exist
+    __block int error_called = 0;
+    atlas_rdf_graph_t graph = atlas_rdf_graph_open_file("/tmp/atlas_test_graph_does_not_exist", ^(int err, const char * msg){
+        error_called = 1;
+    });
+    fail_unless(graph == 0);
+    fail_unless(error_called);
+    
+    // a file which is not a graph file
+    char path[] = "/tmp/atlas_test_graph_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    const char * text = "<http://example.com/a> <http://example.com/b> <http://example.com/c> .\n";
+    write(fd, text, strlen(text));
+    close(fd);
+    
+    error_called = 0;
+    graph = atlas_rdf_graph_open_file(path, ^(int err, const char * msg){
+        error_called = 1;
+    });
+    fail_unless(graph == 0);
+    fail_unless(error_called);
+    
+    // a statement, which refers to a term not in the file; the triple
+    // section is the last section and ends with the last object
+    atlas_rdf_term_t term = atlas_rdf_term_create_iri("http://example.com/a", ^(int err, const char * msg){});
+    atlas_rdf_statement_t statements[1] = {{term, term, term}};
+    graph = atlas_rdf_graph_create(1, statements, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_write_file(graph, path, ^(int err, const char * msg){}));
+    lz_release(graph);
+    lz_release(term);
+    
+    uint32_t position = 7;
+    fd = open(path, O_WRONLY);
+    fail_if(fd < 0);
+    fail_unless(lseek(fd, -(off_t)sizeof(uint32_t), SEEK_END) >= 0);
+    fail_unless(write(fd, &position, sizeof(uint32_t)) == sizeof(uint32_t));
+    close(fd);
+    
+    error_called = 0;
+    graph = atlas_rdf_graph_open_file(path, ^(int err, const char * msg){
+        error_called = 1;
+    });
+    fail_unless(graph == 0);
+    fail_unless(error_called);
+    
+    unlink(path);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_file_open
+
+// write the graph to a file, open it again and check that the opened
+// graph has the same terms and statements
+static void
+test_rdf_graph_file_reopen(atlas_rdf_graph_t graph) {
+    char path[] = "/tmp/atlas_test_graph_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    close(fd);
+    fail_unless(atlas_rdf_graph_write_file(graph, path, ^(int err, const char * msg){}));
+    
+    atlas_rdf_graph_t opened = atlas_rdf_graph_open_file(path, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(opened == 0);
+    if (opened) {
+        fail_unless(lz_obj_num_ref(opened) == lz_obj_num_ref(graph));
+        fail_unless(atlas_rdf_graph_length(opened) == atlas_rdf_graph_length(graph));
+        atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(opened, graph, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff) == 0);
+        lz_release(diff);
+        lz_release(opened);
+    }
+    unlink(path);
+}
+
+START_TEST (test_rdf_graph_file_open) {
+    
+    // two graphs with the same number of statements, the first
+    // has 151 terms, the second has a distinct object in each statement
+    atlas_rdf_term_t pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    atlas_rdf_term_t subjects[50];
+    atlas_rdf_term_t objects[100];
+    for (int i=0; i<50; i++) {
+        char buffer[64];
+        snprintf(buffer, 64, "http://example.com/subject/%d", i);
+        subjects[i] = atlas_rdf_term_create_iri(buffer, ^(int err, const char * msg){});
+    }
+    for (int i=0; i<100; i++) {
+        objects[i] = atlas_rdf_term_create_double(i, ^(int err, const char * msg){});
+    }
+    
+    atlas_rdf_graph_builder_t builder1 = atlas_rdf_graph_builder_create(0);
+    atlas_rdf_graph_builder_t builder2 = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<50; i++) {
+        for (int k=0; k<100; k++) {
+            atlas_rdf_graph_builder_add(builder1, subjects[i], pred1, objects[k], ^(int err, const char * msg){});
+            atlas_rdf_term_t obj = atlas_rdf_term_create_double(i * 100 + k + 0.5, ^(int err, const char * msg){});
+            atlas_rdf_graph_builder_add(builder2, subjects[i], pred1, obj, ^(int err, const char * msg){});
+            lz_release(obj);
+        }
+    }
+    atlas_rdf_graph_t few_terms = atlas_rdf_graph_builder_commit(builder1, ^(int err, const char * msg){});
+    atlas_rdf_graph_t many_terms = atlas_rdf_graph_builder_commit(builder2, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder1);
+    atlas_rdf_graph_builder_free(builder2);
+    fail_unless(lz_obj_num_ref(few_terms) == 151);
+    fail_unless(lz_obj_num_ref(many_terms) == 5051);
+    
+    test_rdf_graph_file_reopen(few_terms);
+    test_rdf_graph_file_reopen(many_terms);
+    
+    lz_release(few_terms);
+    lz_release(many_terms);
+    for (int i=0; i<50; i++) {
+        lz_release(subjects[i]);
+    }
+    for (int i=0; i<100; i++) {
+        lz_release(objects[i]);
+    }
+    lz_release(pred1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Graph File Suites
+
+Suite * rdf_graph_file_suite(void) {
+    Suite *s = suite_create("RDF Graph File");
+    
+    TCase *tc_file = tcase_create("File");
+    tcase_add_checked_fixture (tc_file, setup, teardown);
+    tcase_add_test(tc_file, test_rdf_graph_file);
+    tcase_add_test(tc_file, test_rdf_graph_file_chunked);
+    tcase_add_test(tc_file, test_rdf_graph_file_invalid);
+    tcase_add_test(tc_file, test_rdf_graph_file_open);
+    
+    suite_add_tcase(s, tc_file);
+    
+    return s;
+}
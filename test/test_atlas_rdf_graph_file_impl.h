@@ -0,0 +1,28 @@
+/*
+ *  test_atlas_rdf_graph_file_impl.h
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TEST_ATLAS_RDF_GRAPH_FILE_IMPL_H_
+#define _TEST_ATLAS_RDF_GRAPH_FILE_IMPL_H_
+
+#include <check.h>
+
+Suite * rdf_graph_file_suite(void);
+
+#endif // _TEST_ATLAS_RDF_GRAPH_FILE_IMPL_H_
@@ -26,6 +26,7 @@
 #include <lazy.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <dispatch/dispatch.h>
 
@@ -141,6 +142,88 @@ START_TEST (test_create_rdf_graph) {
     
 } END_TEST
 
+#pragma mark test_create_rdf_graph_parallel
+
+START_TEST (test_create_rdf_graph_parallel) {
+    
+    // enough statements to create the graph in parallel,
+    // every statement is in the input twice
+    int num_statements = 60000;
+    atlas_rdf_term_t preds[3];
+    preds[0] = atlas_rdf_term_create_iri("http://example.com/p0", ^(int err, const char * msg){});
+    preds[1] = atlas_rdf_term_create_iri("http://example.com/p1", ^(int err, const char * msg){});
+    preds[2] = atlas_rdf_term_create_iri("http://example.com/p2", ^(int err, const char * msg){});
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * num_statements);
+    atlas_rdf_statement_t * statements = malloc(sizeof(atlas_rdf_statement_t) * num_statements);
+    assert(terms);
+    assert(statements);
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<num_statements; i++) {
+        char name[32];
+        snprintf(name, 32, "http://example.com/s%d", i % 10000);
+        terms[i] = atlas_rdf_term_create_iri(name, ^(int err, const char * msg){});
+        statements[i].subject = terms[i];
+        statements[i].predicate = preds[(i / 10000) % 3];
+        statements[i].object = preds[i % 2];
+        atlas_rdf_graph_builder_add(builder, statements[i].subject, statements[i].predicate,
+                                    statements[i].object, ^(int err, const char * msg){});
+    }
+    atlas_rdf_graph_t expected = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(num_statements, statements, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    if (graph) {
+        fail_unless(atlas_rdf_graph_length(graph) == num_statements / 2);
+        fail_unless(lz_obj_num_ref(graph) == 10003);
+        
+        atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(graph, expected, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff) == 0);
+        lz_release(diff);
+        
+        // the first occurrence of each statement is kept in order
+        atlas_rdf_graph_cursor_t cursor = atlas_rdf_graph_cursor_create(graph);
+        atlas_rdf_statement_t stm;
+        for (int i=0; i<10; i++) {
+            fail_unless(atlas_rdf_graph_cursor_next(cursor, &stm));
+            fail_unless(atlas_rdf_term_eq(stm.subject, statements[i].subject));
+            fail_unless(atlas_rdf_term_eq(stm.object, statements[i].object));
+        }
+        atlas_rdf_graph_cursor_close(cursor);
+        
+        lz_release(graph);
+    }
+    
+    // the first wrong statement is reported
+    atlas_rdf_term_t literal = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    statements[50000].predicate = literal;
+    statements[40000].subject = literal;
+    __block int num_errors = 0;
+    graph = atlas_rdf_graph_create(num_statements, statements, ^(int err, const char * msg){
+        fail_unless(strstr(msg, "statement 40000") != 0);
+        num_errors++;
+    });
+    fail_unless(graph == 0);
+    fail_unless(num_errors == 1);
+    lz_release(literal);
+    
+    lz_release(expected);
+    for (int i=0; i<num_statements; i++) {
+        lz_release(terms[i]);
+    }
+    for (int i=0; i<3; i++) {
+        lz_release(preds[i]);
+    }
+    free(terms);
+    free(statements);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
 #pragma mark test_create_rdf_graph_union
 
 START_TEST (test_create_rdf_graph_union) {
@@ -645,6 +728,616 @@ START_TEST (test_rdf_graph_contains) {
 } END_TEST
 
 
+#pragma mark -
+#pragma mark Test Access RDF Graph
+
+#pragma mark test_rdf_graph_apply_chunked
+
+START_TEST (test_rdf_graph_apply_chunked) {
+    
+    // create some terms to store in the graph
+    atlas_rdf_term_t sub1, sub2, pred1, pred2, obj1;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    sub2 = atlas_rdf_term_create_blank_node("bar", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    // setup the statements
+    atlas_rdf_statement_t statements[4];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj1;
+    statements[1].subject = sub1;
+    statements[1].predicate = pred2;
+    statements[1].object = obj1;
+    statements[2].subject = sub2;
+    statements[2].predicate = pred1;
+    statements[2].object = obj1;
+    statements[3].subject = sub2;
+    statements[3].predicate = pred2;
+    statements[3].object = sub1;
+    
+    // create the graph
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(4, statements, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    if (graph) {
+        
+        // count the statements with the predicate pred1 with different
+        // grain sizes, each worker counts in its own state and the
+        // states are summed up sequentially
+        for (int grain_size=0; grain_size<6; grain_size++) {
+            __block int num_statements = 0;
+            __block int num_pred1 = 0;
+            atlas_rdf_graph_apply_chunked(graph, grain_size, ^{
+                return (void *)calloc(2, sizeof(int));
+            }, ^(void * state,
+                 atlas_rdf_term_t subject,
+                 atlas_rdf_term_t predicate,
+                 atlas_rdf_term_t object){
+                int * count = state;
+                count[0]++;
+                if (atlas_rdf_term_eq(predicate, pred1)) {
+                    count[1]++;
+                }
+            }, ^(void * state){
+                int * count = state;
+                num_statements += count[0];
+                num_pred1 += count[1];
+                free(state);
+            });
+            
+            fail_unless(num_statements == 4);
+            fail_unless(num_pred1 == 2);
+        }
+        
+        lz_release(graph);
+    }
+    
+    lz_release(sub1);
+    lz_release(sub2);
+    lz_release(pred1);
+    lz_release(pred2);
+    lz_release(obj1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_reduce
+
+START_TEST (test_rdf_graph_reduce) {
+    
+    // create some terms to store in the graph
+    atlas_rdf_term_t sub1, sub2, pred1, pred2, obj1, obj2;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    sub2 = atlas_rdf_term_create_blank_node("bar", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/speed", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/name", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_double(42.5, ^(int err, const char * msg){});
+    obj2 = atlas_rdf_term_create_double(7.5, ^(int err, const char * msg){});
+    
+    // setup the statements
+    atlas_rdf_statement_t statements[3];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj1;
+    statements[1].subject = sub2;
+    statements[1].predicate = pred1;
+    statements[1].object = obj2;
+    statements[2].subject = sub2;
+    statements[2].predicate = pred2;
+    statements[2].object = sub1;
+    
+    // create the graph
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(3, statements, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    if (graph) {
+        
+        // count the statements
+        intptr_t count = (intptr_t)atlas_rdf_graph_reduce(graph, ^{
+            return (void *)0;
+        }, ^(void * acc,
+             atlas_rdf_term_t subject,
+             atlas_rdf_term_t predicate,
+             atlas_rdf_term_t object){
+            return (void *)((intptr_t)acc + 1);
+        }, ^(void * acc1, void * acc2){
+            return (void *)((intptr_t)acc1 + (intptr_t)acc2);
+        });
+        fail_unless(count == 3);
+        
+        // sum up the speed
+        double * sum = atlas_rdf_graph_reduce(graph, ^{
+            double * acc = malloc(sizeof(double));
+            *acc = 0;
+            return (void *)acc;
+        }, ^(void * acc,
+             atlas_rdf_term_t subject,
+             atlas_rdf_term_t predicate,
+             atlas_rdf_term_t object){
+            if (atlas_rdf_term_eq(predicate, pred1)) {
+                *(double *)acc += atlas_rdf_term_double_value(object);
+            }
+            return acc;
+        }, ^(void * acc1, void * acc2){
+            *(double *)acc1 += *(double *)acc2;
+            free(acc2);
+            return acc1;
+        });
+        fail_if(sum == 0);
+        fail_unless(*sum == 50.0);
+        free(sum);
+        
+        lz_release(graph);
+    }
+    
+    // the result of an empty graph is the initial accumulator
+    graph = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    if (graph) {
+        intptr_t count = (intptr_t)atlas_rdf_graph_reduce(graph, ^{
+            return (void *)42;
+        }, ^(void * acc,
+             atlas_rdf_term_t subject,
+             atlas_rdf_term_t predicate,
+             atlas_rdf_term_t object){
+            return (void *)((intptr_t)acc + 1);
+        }, ^(void * acc1, void * acc2){
+            return (void *)((intptr_t)acc1 + (intptr_t)acc2);
+        });
+        fail_unless(count == 42);
+        lz_release(graph);
+    }
+    
+    lz_release(sub1);
+    lz_release(sub2);
+    lz_release(pred1);
+    lz_release(pred2);
+    lz_release(obj1);
+    lz_release(obj2);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_describe
+
+START_TEST (test_rdf_graph_describe) {
+    
+    // a chain of 100 subjects, each with a name
+    atlas_rdf_term_t next = atlas_rdf_term_create_iri("http://example.com/next", ^(int err, const char * msg){});
+    atlas_rdf_term_t name = atlas_rdf_term_create_iri("http://example.com/name", ^(int err, const char * msg){});
+    atlas_rdf_term_t * subjects = malloc(sizeof(atlas_rdf_term_t) * 100);
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<100; i++) {
+        char buffer[32];
+        snprintf(buffer, 32, "s%d", i);
+        subjects[i] = atlas_rdf_term_create_blank_node(buffer, ^(int err, const char * msg){});
+        atlas_rdf_term_t literal = atlas_rdf_term_create_string(buffer, 0, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subjects[i], name, literal, ^(int err, const char * msg){});
+        if (i > 0) {
+            atlas_rdf_graph_builder_add(builder, subjects[i - 1], next, subjects[i], ^(int err, const char * msg){});
+        }
+        lz_release(literal);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    atlas_rdf_graph_t compressed = atlas_rdf_graph_create_compressed(graph, ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_t graphs[2] = {graph, compressed};
+    for (int g=0; g<2; g++) {
+        atlas_rdf_term_t subject = subjects[10];
+        atlas_rdf_term_t object = subjects[11];
+        
+        __block int num_names = 0;
+        __block int num_next = 0;
+        int count = atlas_rdf_graph_describe(graphs[g], subject, ^(atlas_rdf_term_t p, atlas_rdf_term_t o){
+            if (atlas_rdf_term_eq(p, name)) {
+                num_names++;
+            } else {
+                fail_unless(atlas_rdf_term_eq(p, next));
+                fail_unless(atlas_rdf_term_eq(o, object));
+                num_next++;
+            }
+        });
+        fail_unless(count == 2);
+        fail_unless(num_names == 1);
+        fail_unless(num_next == 1);
+        
+        __block int num_incoming = 0;
+        count = atlas_rdf_graph_describe_incoming(graphs[g], object, ^(atlas_rdf_term_t s, atlas_rdf_term_t p){
+            fail_unless(atlas_rdf_term_eq(s, subject));
+            fail_unless(atlas_rdf_term_eq(p, next));
+            num_incoming++;
+        });
+        fail_unless(count == 1);
+        fail_unless(num_incoming == 1);
+        
+        // the ends of the chain
+        fail_unless(atlas_rdf_graph_describe(graphs[g], subjects[99], 0) == 1);
+        fail_unless(atlas_rdf_graph_describe_incoming(graphs[g], subjects[0], 0) == 0);
+        
+        // terms which are not in the graph
+        fail_unless(atlas_rdf_graph_describe(graphs[g], name, 0) == 0);
+        fail_unless(atlas_rdf_graph_describe(graphs[g], next, 0) == 0);
+    }
+    
+    lz_release(compressed);
+    lz_release(graph);
+    for (int i=0; i<100; i++) {
+        lz_release(subjects[i]);
+    }
+    free(subjects);
+    lz_release(next);
+    lz_release(name);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_range
+
+START_TEST (test_rdf_graph_range) {
+    
+    // 200 subjects with a name, an age (in reverse order) and a date
+    atlas_rdf_term_t name = atlas_rdf_term_create_iri("http://example.com/name", ^(int err, const char * msg){});
+    atlas_rdf_term_t age = atlas_rdf_term_create_iri("http://example.com/age", ^(int err, const char * msg){});
+    atlas_rdf_term_t date = atlas_rdf_term_create_iri("http://example.com/date", ^(int err, const char * msg){});
+    atlas_rdf_term_t unknown = atlas_rdf_term_create_iri("http://example.com/unknown", ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<200; i++) {
+        char buffer[32];
+        snprintf(buffer, 32, "s%d", i);
+        atlas_rdf_term_t subject = atlas_rdf_term_create_blank_node(buffer, ^(int err, const char * msg){});
+        atlas_rdf_term_t literal = atlas_rdf_term_create_string(buffer, 0, ^(int err, const char * msg){});
+        mpz_t value;
+        mpz_init_set_si(value, 199 - i);
+        atlas_rdf_term_t integer = atlas_rdf_term_create_integer(value, ^(int err, const char * msg){});
+        mpz_clear(value);
+        atlas_rdf_term_t datetime = atlas_rdf_term_create_datetime(1000 * i, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subject, name, literal, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subject, age, integer, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subject, date, datetime, ^(int err, const char * msg){});
+        lz_release(subject);
+        lz_release(literal);
+        lz_release(integer);
+        lz_release(datetime);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    atlas_rdf_graph_t compressed = atlas_rdf_graph_create_compressed(graph, ^(int err, const char * msg){});
+    
+    atlas_rdf_term_t min = atlas_rdf_term_create_double(50, ^(int err, const char * msg){});
+    atlas_rdf_term_t max = atlas_rdf_term_create_double(59.5, ^(int err, const char * msg){});
+    atlas_rdf_term_t min_date = atlas_rdf_term_create_datetime(10000, ^(int err, const char * msg){});
+    atlas_rdf_term_t max_date = atlas_rdf_term_create_datetime(20000, ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_t graphs[2] = {graph, compressed};
+    for (int g=0; g<2; g++) {
+        
+        // the objects are reported in the order of their values
+        __block double last = -1;
+        __block int num_objects = 0;
+        int count = atlas_rdf_graph_range(graphs[g], age, min, max, 0, ^(atlas_rdf_term_t s, atlas_rdf_term_t o){
+            mpz_t x;
+            mpz_init(x);
+            atlas_rdf_term_integer_value(o, x);
+            double value = mpz_get_d(x);
+            mpz_clear(x);
+            fail_unless(value >= 50 && value <= 59);
+            fail_unless(value > last);
+            last = value;
+            num_objects++;
+        });
+        fail_unless(count == 10);
+        fail_unless(num_objects == 10);
+        
+        // open bounds
+        fail_unless(atlas_rdf_graph_range(graphs[g], age, min, max, ATLAS_RDF_RANGE_EXCLUDE_MIN, 0) == 9);
+        fail_unless(atlas_rdf_graph_range(graphs[g], age, min, 0, 0, 0) == 150);
+        fail_unless(atlas_rdf_graph_range(graphs[g], age, 0, min, ATLAS_RDF_RANGE_EXCLUDE_MAX, 0) == 50);
+        
+        // datetimes
+        fail_unless(atlas_rdf_graph_range(graphs[g], date, min_date, max_date, 0, 0) == 11);
+        fail_unless(atlas_rdf_graph_range(graphs[g], date, min_date, max_date, ATLAS_RDF_RANGE_EXCLUDE_MIN | ATLAS_RDF_RANGE_EXCLUDE_MAX, 0) == 9);
+        
+        // bounds of different domains, other literals and unknown predicates
+        fail_unless(atlas_rdf_graph_range(graphs[g], age, min, max_date, 0, 0) == 0);
+        fail_unless(atlas_rdf_graph_range(graphs[g], date, min, max, 0, 0) == 0);
+        fail_unless(atlas_rdf_graph_range(graphs[g], name, min, max, 0, 0) == 0);
+        fail_unless(atlas_rdf_graph_range(graphs[g], unknown, min, max, 0, 0) == 0);
+    }
+    
+    lz_release(min);
+    lz_release(max);
+    lz_release(min_date);
+    lz_release(max_date);
+    lz_release(compressed);
+    lz_release(graph);
+    lz_release(name);
+    lz_release(age);
+    lz_release(date);
+    lz_release(unknown);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_text
+
+START_TEST (test_rdf_graph_text) {
+    
+    // 100 subjects with a description in english and german
+    atlas_rdf_term_t description = atlas_rdf_term_create_iri("http://example.com/description", ^(int err, const char * msg){});
+    atlas_rdf_term_t number = atlas_rdf_term_create_iri("http://example.com/number", ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<100; i++) {
+        char buffer[64];
+        snprintf(buffer, 64, "s%d", i);
+        atlas_rdf_term_t subject = atlas_rdf_term_create_blank_node(buffer, ^(int err, const char * msg){});
+        snprintf(buffer, 64, "Vehicle %d, %s", i, i % 2 ? "red" : "blue");
+        atlas_rdf_term_t en = atlas_rdf_term_create_string(buffer, "en", ^(int err, const char * msg){});
+        snprintf(buffer, 64, "Fahrzeug %d, %s", i, i % 2 ? "rot" : "blau");
+        atlas_rdf_term_t de = atlas_rdf_term_create_string(buffer, "de", ^(int err, const char * msg){});
+        snprintf(buffer, 64, "%d", i);
+        atlas_rdf_term_t plain = atlas_rdf_term_create_string(buffer, 0, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subject, description, en, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subject, description, de, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, subject, number, plain, ^(int err, const char * msg){});
+        lz_release(subject);
+        lz_release(en);
+        lz_release(de);
+        lz_release(plain);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    atlas_rdf_graph_t compressed = atlas_rdf_graph_create_compressed(graph, ^(int err, const char * msg){});
+    
+    atlas_rdf_graph_t graphs[2] = {graph, compressed};
+    for (int g=0; g<2; g++) {
+        
+        // substrings
+        __block int num_literals = 0;
+        int count = atlas_rdf_graph_text(graphs[g], "le 4", 0, 0, ^(atlas_rdf_term_t literal){
+            char * value = atlas_rdf_term_literal_value(literal);
+            fail_unless(strncmp(value, "Vehicle 4", 9) == 0);
+            free(value);
+            num_literals++;
+        });
+        fail_unless(count == 11);
+        fail_unless(num_literals == 11);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "red", 0, 0, 0) == 50);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "RED", 0, 0, 0) == 0);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "RED", 0, ATLAS_RDF_TEXT_ICASE, 0) == 50);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "vehicle", 0, 0, 0) == 0);
+        
+        // prefixes
+        fail_unless(atlas_rdf_graph_text(graphs[g], "ehicle", 0, ATLAS_RDF_TEXT_PREFIX, 0) == 0);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "fahrzeug 1", 0, ATLAS_RDF_TEXT_PREFIX | ATLAS_RDF_TEXT_ICASE, 0) == 11);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "9", 0, ATLAS_RDF_TEXT_PREFIX, 0) == 11);
+        
+        // languages and short patterns
+        fail_unless(atlas_rdf_graph_text(graphs[g], "", "DE", 0, 0) == 100);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "5", "", 0, 0) == 19);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "99", "en", 0, 0) == 1);
+        fail_unless(atlas_rdf_graph_text(graphs[g], "", 0, 0, 0) == 300);
+    }
+    
+    lz_release(compressed);
+    lz_release(graph);
+    lz_release(description);
+    lz_release(number);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_cursor
+
+START_TEST (test_rdf_graph_cursor) {
+    
+    // create some terms to store in the graph
+    atlas_rdf_term_t sub1, sub2, pred1, pred2, obj1;
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    sub2 = atlas_rdf_term_create_blank_node("bar", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    // setup the statements
+    atlas_rdf_statement_t statements[3];
+    statements[0].subject = sub1;
+    statements[0].predicate = pred1;
+    statements[0].object = obj1;
+    statements[1].subject = sub2;
+    statements[1].predicate = pred2;
+    statements[1].object = obj1;
+    statements[2].subject = sub2;
+    statements[2].predicate = pred1;
+    statements[2].object = sub1;
+    
+    // create the graph
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(3, statements, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    if (graph) {
+        atlas_rdf_statement_t stm;
+        
+        // iterate over all statements
+        atlas_rdf_graph_cursor_t cursor = atlas_rdf_graph_cursor_create(graph);
+        fail_if(cursor == 0);
+        int num_statements = 0;
+        while (atlas_rdf_graph_cursor_next(cursor, &stm)) {
+            fail_unless(atlas_rdf_graph_contains(graph, stm.subject, stm.predicate, stm.object));
+            num_statements++;
+        }
+        fail_unless(num_statements == 3);
+        
+        // the cursor stays at the end
+        fail_if(atlas_rdf_graph_cursor_next(cursor, &stm));
+        
+        // stop at the first statement with the predicate pred2
+        atlas_rdf_graph_cursor_reset(cursor);
+        int found = 0;
+        while (atlas_rdf_graph_cursor_next(cursor, &stm)) {
+            if (atlas_rdf_term_eq(stm.predicate, pred2)) {
+                found = 1;
+                break;
+            }
+        }
+        fail_unless(found);
+        fail_unless(atlas_rdf_term_eq(stm.subject, sub2));
+        fail_unless(atlas_rdf_term_eq(stm.object, obj1));
+        atlas_rdf_graph_cursor_close(cursor);
+        
+        // iterate over a range of statements
+        cursor = atlas_rdf_graph_cursor_create_range(graph, 1, 3);
+        num_statements = 0;
+        while (atlas_rdf_graph_cursor_next(cursor, &stm)) {
+            num_statements++;
+        }
+        fail_unless(num_statements == 2);
+        atlas_rdf_graph_cursor_close(cursor);
+        
+        // the range is limited to the length of the graph
+        cursor = atlas_rdf_graph_cursor_create_range(graph, 2, 100);
+        num_statements = 0;
+        while (atlas_rdf_graph_cursor_next(cursor, &stm)) {
+            num_statements++;
+        }
+        fail_unless(num_statements == 1);
+        atlas_rdf_graph_cursor_close(cursor);
+        
+        cursor = atlas_rdf_graph_cursor_create_range(graph, 5, 10);
+        fail_if(atlas_rdf_graph_cursor_next(cursor, &stm));
+        atlas_rdf_graph_cursor_close(cursor);
+        
+        lz_release(graph);
+    }
+    
+    // a cursor over an empty graph
+    graph = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    if (graph) {
+        atlas_rdf_statement_t stm;
+        atlas_rdf_graph_cursor_t cursor = atlas_rdf_graph_cursor_create(graph);
+        fail_if(atlas_rdf_graph_cursor_next(cursor, &stm));
+        atlas_rdf_graph_cursor_close(cursor);
+        lz_release(graph);
+    }
+    
+    lz_release(sub1);
+    lz_release(sub2);
+    lz_release(pred1);
+    lz_release(pred2);
+    lz_release(obj1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_create_rdf_graph_compressed
+
+START_TEST (test_create_rdf_graph_compressed) {
+    
+    // create a graph with 100 subjects and 100 objects
+    atlas_rdf_term_t pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    atlas_rdf_term_t * subjects = malloc(sizeof(atlas_rdf_term_t) * 100);
+    atlas_rdf_term_t * objects = malloc(sizeof(atlas_rdf_term_t) * 100);
+    for (int i=0; i<100; i++) {
+        char name[16];
+        snprintf(name, 16, "s%d", i);
+        subjects[i] = atlas_rdf_term_create_blank_node(name, ^(int err, const char * msg){});
+        objects[i] = atlas_rdf_term_create_double(i, ^(int err, const char * msg){});
+    }
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(10000);
+    for (int i=0; i<100; i++) {
+        for (int k=0; k<100; k++) {
+            // leave out some statements
+            if ((i + k) % 7 != 0) {
+                atlas_rdf_graph_builder_add(builder, subjects[i], pred1, objects[k], ^(int err, const char * msg){});
+            }
+        }
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    int length = atlas_rdf_graph_length(graph);
+    
+    atlas_rdf_graph_t compressed = atlas_rdf_graph_create_compressed(graph, ^(int err, const char * msg){});
+    fail_if(compressed == 0);
+    if (compressed) {
+        fail_unless(atlas_rdf_graph_length(compressed) == length);
+        
+        // the compressed graph uses less memory
+        fail_unless(atlas_rdf_graph_memory_size(compressed) * 3 < atlas_rdf_graph_memory_size(graph));
+        
+        // check each statement
+        for (int i=0; i<100; i++) {
+            for (int k=0; k<100; k++) {
+                int contained = atlas_rdf_graph_contains(compressed, subjects[i], pred1, objects[k]);
+                fail_unless(contained == ((i + k) % 7 != 0));
+            }
+        }
+        
+        // both graphs contain the same statements
+        atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(graph, compressed, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff) == 0);
+        lz_release(diff);
+        diff = atlas_rdf_graph_create_difference(compressed, graph, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff) == 0);
+        lz_release(diff);
+        
+        // access a range of statements across blocks
+        atlas_rdf_graph_cursor_t cursor = atlas_rdf_graph_cursor_create_range(compressed, 100, 300);
+        atlas_rdf_statement_t stm;
+        int num_statements = 0;
+        while (atlas_rdf_graph_cursor_next(cursor, &stm)) {
+            fail_unless(atlas_rdf_graph_contains(graph, stm.subject, stm.predicate, stm.object));
+            num_statements++;
+        }
+        fail_unless(num_statements == 200);
+        atlas_rdf_graph_cursor_close(cursor);
+        
+        intptr_t count = (intptr_t)atlas_rdf_graph_reduce(compressed, ^{
+            return (void *)0;
+        }, ^(void * acc,
+             atlas_rdf_term_t subject,
+             atlas_rdf_term_t predicate,
+             atlas_rdf_term_t object){
+            return (void *)((intptr_t)acc + 1);
+        }, ^(void * acc1, void * acc2){
+            return (void *)((intptr_t)acc1 + (intptr_t)acc2);
+        });
+        fail_unless(count == length);
+        
+        lz_release(compressed);
+    }
+    lz_release(graph);
+    
+    // compress an empty graph
+    graph = atlas_rdf_graph_create(0, 0, ^(int err, const char * msg){});
+    compressed = atlas_rdf_graph_create_compressed(graph, ^(int err, const char * msg){});
+    fail_if(compressed == 0);
+    if (compressed) {
+        fail_unless(atlas_rdf_graph_length(compressed) == 0);
+        fail_if(atlas_rdf_graph_contains(compressed, subjects[0], pred1, objects[0]));
+        lz_release(compressed);
+    }
+    lz_release(graph);
+    
+    for (int i=0; i<100; i++) {
+        lz_release(subjects[i]);
+        lz_release(objects[i]);
+    }
+    free(subjects);
+    free(objects);
+    lz_release(pred1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
 #pragma mark -
 #pragma mark Fixtures
 
@@ -670,13 +1363,25 @@ Suite * rdf_graph_suite(void) {
     
     tcase_add_test(tc_create, test_create_rdf_graph);
     tcase_add_test(tc_create, test_create_rdf_graph_empty);
+    tcase_add_test(tc_create, test_create_rdf_graph_parallel);
     tcase_add_test(tc_create, test_create_rdf_graph_union);
     tcase_add_test(tc_create, test_create_rdf_graph_intersection);
     tcase_add_test(tc_create, test_create_rdf_graph_difference);
+    tcase_add_test(tc_create, test_create_rdf_graph_compressed);
 
     tcase_add_test(tc_predicates, test_rdf_graph_contains);
     
+    TCase *tc_access = tcase_create("Access");
+    tcase_add_checked_fixture (tc_access, setup, teardown);
+    tcase_add_test(tc_access, test_rdf_graph_apply_chunked);
+    tcase_add_test(tc_access, test_rdf_graph_reduce);
+    tcase_add_test(tc_access, test_rdf_graph_cursor);
+    tcase_add_test(tc_access, test_rdf_graph_describe);
+    tcase_add_test(tc_access, test_rdf_graph_range);
+    tcase_add_test(tc_access, test_rdf_graph_text);
+    
     suite_add_tcase(s, tc_create);
+    suite_add_tcase(s, tc_access);
     suite_add_tcase(s, tc_predicates);
     
     return s;
@@ -0,0 +1,196 @@
+/*
+ *  test_atlas_rdf_graph_stats_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_graph_stats_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Graph Statistics
+
+#pragma mark test_rdf_graph_stats_exact
+
+START_TEST (test_rdf_graph_stats_exact) {
+    
+    atlas_rdf_term_t sub1, sub2, pred1, pred2, obj1, obj2, other;
+    sub1 = atlas_rdf_term_create_iri("http://example.com/s1", ^(int err, const char * msg){});
+    sub2 = atlas_rdf_term_create_blank_node("s2", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/p1", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/p2", ^(int err, const char * msg){});
+    obj1 = atlas_rdf_term_create_string("foo", 0, ^(int err, const char * msg){});
+    obj2 = atlas_rdf_term_create_double(1.5, ^(int err, const char * msg){});
+    other = atlas_rdf_term_create_iri("http://example.com/other", ^(int err, const char * msg){});
+    
+    // p1: 3 statements with 2 subjects and 2 objects
+    // p2: 1 statement with 1 subject and 1 object
+    atlas_rdf_statement_t statements[4] = {
+        {sub1, pred1, obj1},
+        {sub1, pred1, obj2},
+        {sub2, pred1, obj1},
+        {sub2, pred2, sub1}
+    };
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(4, statements, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    
+    atlas_rdf_graph_stats_t stats = atlas_rdf_graph_stats(graph, 0);
+    fail_if(stats == 0);
+    fail_if(atlas_rdf_graph_stats_is_approximate(stats));
+    
+    fail_unless(atlas_rdf_graph_stats_num_statements(stats) == 4);
+    fail_unless(atlas_rdf_graph_stats_num_subjects(stats) == 2);
+    fail_unless(atlas_rdf_graph_stats_num_predicates(stats) == 2);
+    fail_unless(atlas_rdf_graph_stats_num_objects(stats) == 3);
+    fail_unless(atlas_rdf_graph_stats_avg_out_degree(stats) == 2.0);
+    
+    // the most frequent predicate first
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats, pred1) == 0);
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats, pred2) == 1);
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats, other) == -1);
+    fail_unless(atlas_rdf_term_eq(atlas_rdf_graph_stats_predicate(stats, 0), pred1));
+    
+    fail_unless(atlas_rdf_graph_stats_predicate_statements(stats, 0) == 3);
+    fail_unless(atlas_rdf_graph_stats_predicate_subjects(stats, 0) == 2);
+    fail_unless(atlas_rdf_graph_stats_predicate_objects(stats, 0) == 2);
+    fail_unless(atlas_rdf_graph_stats_predicate_statements(stats, 1) == 1);
+    fail_unless(atlas_rdf_graph_stats_predicate_subjects(stats, 1) == 1);
+    fail_unless(atlas_rdf_graph_stats_predicate_objects(stats, 1) == 1);
+    
+    // the statistics are kept by the graph
+    fail_unless(atlas_rdf_graph_stats(graph, 0) == stats);
+    fail_unless(atlas_rdf_graph_stats(graph, ATLAS_RDF_GRAPH_STATS_APPROXIMATE) == stats);
+    
+    // predicates with the same number of statements are sorted by their value
+    atlas_rdf_statement_t ties[3] = {
+        {sub1, pred2, obj1},
+        {sub1, other, obj1},
+        {sub1, pred1, obj1}
+    };
+    atlas_rdf_graph_t graph2 = atlas_rdf_graph_create(3, ties, ^(int err, const char * msg){});
+    atlas_rdf_graph_stats_t stats2 = atlas_rdf_graph_stats(graph2, 0);
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats2, other) == 0);
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats2, pred1) == 1);
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats2, pred2) == 2);
+    lz_release(graph2);
+    
+    lz_release(graph);
+    lz_release(sub1);
+    lz_release(sub2);
+    lz_release(pred1);
+    lz_release(pred2);
+    lz_release(obj1);
+    lz_release(obj2);
+    lz_release(other);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_graph_stats_approximate
+
+START_TEST (test_rdf_graph_stats_approximate) {
+    
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    atlas_rdf_term_t pred1 = atlas_rdf_term_create_iri("http://example.com/p1", ^(int err, const char * msg){});
+    atlas_rdf_term_t pred2 = atlas_rdf_term_create_iri("http://example.com/p2", ^(int err, const char * msg){});
+    for (int i=0; i<20000; i++) {
+        char buffer[64];
+        snprintf(buffer, 64, "http://example.com/item/%d", i);
+        atlas_rdf_term_t sub = atlas_rdf_term_create_iri(buffer, ^(int err, const char * msg){});
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(i % 100, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, sub, i % 4 ? pred1 : pred2, obj, ^(int err, const char * msg){});
+        lz_release(sub);
+        lz_release(obj);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    atlas_rdf_graph_stats_t stats = atlas_rdf_graph_stats(graph, ATLAS_RDF_GRAPH_STATS_APPROXIMATE);
+    fail_if(stats == 0);
+    fail_unless(atlas_rdf_graph_stats_is_approximate(stats));
+    fail_unless(atlas_rdf_graph_stats(graph, ATLAS_RDF_GRAPH_STATS_APPROXIMATE) == stats);
+    
+    // exact counts
+    fail_unless(atlas_rdf_graph_stats_num_statements(stats) == 20000);
+    fail_unless(atlas_rdf_graph_stats_num_predicates(stats) == 2);
+    fail_unless(atlas_rdf_graph_stats_predicate_index(stats, pred1) == 0);
+    fail_unless(atlas_rdf_graph_stats_predicate_statements(stats, 0) == 15000);
+    fail_unless(atlas_rdf_graph_stats_predicate_statements(stats, 1) == 5000);
+    
+    // estimates within 10%
+    uint64_t n = atlas_rdf_graph_stats_num_subjects(stats);
+    fail_unless(n > 18000 && n < 22000);
+    n = atlas_rdf_graph_stats_predicate_subjects(stats, 1);
+    fail_unless(n > 4500 && n < 5500);
+    n = atlas_rdf_graph_stats_num_objects(stats);
+    fail_unless(n >= 95 && n <= 105);
+    n = atlas_rdf_graph_stats_predicate_objects(stats, 1);
+    fail_unless(n >= 23 && n <= 27);
+    
+    // exact statistics can be computed in addition
+    atlas_rdf_graph_stats_t exact = atlas_rdf_graph_stats(graph, 0);
+    fail_if(exact == stats);
+    fail_if(atlas_rdf_graph_stats_is_approximate(exact));
+    fail_unless(atlas_rdf_graph_stats_num_subjects(exact) == 20000);
+    fail_unless(atlas_rdf_graph_stats_num_objects(exact) == 100);
+    fail_unless(atlas_rdf_graph_stats_predicate_objects(exact, 1) == 25);
+    
+    lz_release(graph);
+    lz_release(pred1);
+    lz_release(pred2);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Graph Statistics Suites
+
+Suite * rdf_graph_stats_suite(void) {
+    Suite *s = suite_create("RDF Graph Statistics");
+    
+    TCase *tc_stats = tcase_create("Graph Statistics");
+    tcase_add_checked_fixture (tc_stats, setup, teardown);
+    tcase_add_test(tc_stats, test_rdf_graph_stats_exact);
+    tcase_add_test(tc_stats, test_rdf_graph_stats_approximate);
+    
+    suite_add_tcase(s, tc_stats);
+    
+    return s;
+}
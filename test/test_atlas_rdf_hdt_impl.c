@@ -0,0 +1,294 @@
+/*
+ *  test_atlas_rdf_hdt_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_hdt_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Compact Binary RDF Graphs
+
+#pragma mark test_rdf_hdt_roundtrip
+
+START_TEST (test_rdf_hdt_roundtrip) {
+    
+    // create terms of all kinds
+    atlas_rdf_term_t sub1, sub2, pred1, pred2, type, obj[9];
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    sub2 = atlas_rdf_term_create_iri("http://example.com/sub", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    pred2 = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    type = atlas_rdf_term_create_iri("http://example.com/type", ^(int err, const char * msg){});
+    
+    mpz_t i;
+    mpz_init_set_str(i, "-123456789012345678901234567890", 10);
+    obj[0] = atlas_rdf_term_create_integer(i, ^(int err, const char * msg){});
+    mpz_clear(i);
+    
+    mpf_t f;
+    mpf_init_set_str(f, "1.5", 10);
+    obj[1] = atlas_rdf_term_create_decimal(f, ^(int err, const char * msg){});
+    mpf_clear(f);
+    
+    obj[2] = atlas_rdf_term_create_string("foo", "de", ^(int err, const char * msg){});
+    obj[3] = atlas_rdf_term_create_string("foo", 0, ^(int err, const char * msg){});
+    obj[4] = atlas_rdf_term_create_typed("foo", type, ^(int err, const char * msg){});
+    obj[5] = atlas_rdf_term_create_double(42.5, ^(int err, const char * msg){});
+    obj[6] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    obj[7] = atlas_rdf_term_create_datetime(1272448800, ^(int err, const char * msg){});
+    obj[8] = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[19];
+    for (int k=0; k<9; k++) {
+        statements[k].subject = sub1;
+        statements[k].predicate = pred1;
+        statements[k].object = obj[k];
+        statements[k + 9].subject = sub2;
+        statements[k + 9].predicate = k % 2 ? pred1 : pred2;
+        statements[k + 9].object = obj[k];
+    }
+    statements[18].subject = sub2;
+    statements[18].predicate = pred2;
+    statements[18].object = sub1;
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(19, statements, ^(int err, const char * msg){});
+    fail_if(graph == 0);
+    
+    size_t length = 0;
+    void * data = atlas_rdf_graph_serialize_hdt(graph, &length, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(data == 0);
+    fail_unless(length > 0);
+    
+    atlas_rdf_graph_t result = atlas_rdf_graph_create_from_hdt(data, length, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(result == 0);
+    if (result) {
+        fail_unless(atlas_rdf_graph_length(result) == 19);
+        atlas_rdf_graph_t diff1 = atlas_rdf_graph_create_difference(result, graph, ^(int err, const char * msg){});
+        atlas_rdf_graph_t diff2 = atlas_rdf_graph_create_difference(graph, result, ^(int err, const char * msg){});
+        fail_unless(atlas_rdf_graph_length(diff1) == 0);
+        fail_unless(atlas_rdf_graph_length(diff2) == 0);
+        lz_release(diff1);
+        lz_release(diff2);
+        lz_release(result);
+    }
+    
+    // query the representation without creating a graph
+    atlas_rdf_hdt_t hdt = atlas_rdf_hdt_open(data, length, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(hdt == 0);
+    if (hdt) {
+        fail_unless(atlas_rdf_hdt_length(hdt) == 19);
+        
+        // the type of the typed literal is part of the dictionary
+        fail_unless(atlas_rdf_hdt_num_terms(hdt) == 13);
+        
+        for (int k=0; k<9; k++) {
+            fail_unless(atlas_rdf_hdt_contains(hdt, sub1, pred1, obj[k]));
+            fail_if(atlas_rdf_hdt_contains(hdt, sub1, pred2, obj[k]));
+        }
+        fail_if(atlas_rdf_hdt_contains(hdt, sub1, type, obj[0]));
+        
+        __block int count = 0;
+        atlas_rdf_hdt_match(hdt, sub2, 0, 0, ^(atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+            fail_unless(atlas_rdf_term_eq(s, sub2));
+            count++;
+        });
+        fail_unless(count == 10);
+        
+        count = 0;
+        atlas_rdf_hdt_match(hdt, sub2, pred2, 0, ^(atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+            fail_unless(atlas_rdf_term_eq(p, pred2));
+            count++;
+        });
+        fail_unless(count == 6);
+        
+        count = 0;
+        atlas_rdf_term_t typed = obj[4];
+        atlas_rdf_hdt_match(hdt, 0, 0, typed, ^(atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+            fail_unless(atlas_rdf_term_eq(o, typed));
+            atlas_rdf_term_t t = atlas_rdf_term_typed_type(o);
+            fail_unless(atlas_rdf_term_eq(t, type));
+            lz_release(t);
+            count++;
+        });
+        fail_unless(count == 2);
+        
+        count = 0;
+        atlas_rdf_hdt_match(hdt, 0, 0, 0, ^(atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+            count++;
+        });
+        fail_unless(count == 19);
+        
+        count = 0;
+        atlas_rdf_hdt_match(hdt, type, 0, 0, ^(atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+            count++;
+        });
+        fail_unless(count == 0);
+        
+        atlas_rdf_hdt_close(hdt);
+    }
+    
+    free(data);
+    lz_release(graph);
+    
+    for (int k=0; k<9; k++) {
+        lz_release(obj[k]);
+    }
+    lz_release(sub1);
+    lz_release(sub2);
+    lz_release(pred1);
+    lz_release(pred2);
+    lz_release(type);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_hdt_large
+
+START_TEST (test_rdf_hdt_large) {
+    
+    // many similar iris span several blocks of the dictionary
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    atlas_rdf_term_t pred = atlas_rdf_term_create_iri("http://example.com/p", ^(int err, const char * msg){});
+    for (int i=0; i<1000; i++) {
+        char buffer[64];
+        snprintf(buffer, 64, "http://example.com/item/%d", i);
+        atlas_rdf_term_t sub = atlas_rdf_term_create_iri(buffer, ^(int err, const char * msg){});
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(i % 100, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, sub, pred, obj, ^(int err, const char * msg){});
+        lz_release(sub);
+        lz_release(obj);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    size_t length = 0;
+    void * data = atlas_rdf_graph_serialize_hdt(graph, &length, ^(int err, const char * msg){});
+    fail_if(data == 0);
+    
+    atlas_rdf_hdt_t hdt = atlas_rdf_hdt_open(data, length, ^(int err, const char * msg){});
+    fail_if(hdt == 0);
+    if (hdt) {
+        fail_unless(atlas_rdf_hdt_length(hdt) == 1000);
+        fail_unless(atlas_rdf_hdt_num_terms(hdt) == 1101);
+        for (int i=0; i<1000; i += 37) {
+            char buffer[64];
+            snprintf(buffer, 64, "http://example.com/item/%d", i);
+            atlas_rdf_term_t sub = atlas_rdf_term_create_iri(buffer, ^(int err, const char * msg){});
+            atlas_rdf_term_t obj = atlas_rdf_term_create_double(i % 100, ^(int err, const char * msg){});
+            fail_unless(atlas_rdf_hdt_contains(hdt, sub, pred, obj));
+            lz_release(sub);
+            lz_release(obj);
+        }
+        
+        __block int count = 0;
+        atlas_rdf_term_t obj = atlas_rdf_term_create_double(7, ^(int err, const char * msg){});
+        atlas_rdf_hdt_match(hdt, 0, pred, obj, ^(atlas_rdf_term_t s, atlas_rdf_term_t p, atlas_rdf_term_t o){
+            count++;
+        });
+        fail_unless(count == 10);
+        lz_release(obj);
+        
+        atlas_rdf_hdt_close(hdt);
+    }
+    
+    free(data);
+    lz_release(graph);
+    lz_release(pred);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_hdt_invalid
+
+START_TEST (test_rdf_hdt_invalid) {
+    
+    atlas_rdf_term_t sub = atlas_rdf_term_create_iri("http://example.com/a", ^(int err, const char * msg){});
+    atlas_rdf_statement_t statement = {sub, sub, sub};
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(1, &statement, ^(int err, const char * msg){});
+    
+    size_t length = 0;
+    char * data = atlas_rdf_graph_serialize_hdt(graph, &length, ^(int err, const char * msg){});
+    fail_if(data == 0);
+    
+    __block int num_errors = 0;
+    atlas_error_handler err = ^(int e, const char * msg){
+        num_errors++;
+    };
+    
+    // truncated data
+    fail_unless(atlas_rdf_hdt_open(data, 16, err) == 0);
+    fail_unless(atlas_rdf_hdt_open(data, length - 8, err) == 0);
+    
+    // wrong magic
+    data[0] = 'X';
+    fail_unless(atlas_rdf_graph_create_from_hdt(data, length, err) == 0);
+    fail_unless(num_errors == 3);
+    
+    free(data);
+    lz_release(graph);
+    lz_release(sub);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF HDT Suites
+
+Suite * rdf_hdt_suite(void) {
+    Suite *s = suite_create("RDF HDT");
+    
+    TCase *tc_hdt = tcase_create("Compact Binary Graph");
+    tcase_add_checked_fixture (tc_hdt, setup, teardown);
+    tcase_add_test(tc_hdt, test_rdf_hdt_roundtrip);
+    tcase_add_test(tc_hdt, test_rdf_hdt_large);
+    tcase_add_test(tc_hdt, test_rdf_hdt_invalid);
+    
+    suite_add_tcase(s, tc_hdt);
+    
+    return s;
+}
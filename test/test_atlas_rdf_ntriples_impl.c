@@ -0,0 +1,402 @@
+/*
+ *  test_atlas_rdf_ntriples_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_ntriples_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Parse N-Triples
+
+#pragma mark test_rdf_ntriples_parse
+
+START_TEST (test_rdf_ntriples_parse) {
+    
+    const char * data =
+        "# a comment\n"
+        "<http://example.com/a> <http://example.com/p> <http://example.com/b> .\n"
+        "\n"
+        "_:foo <http://example.com/p> \"bar\" . # another comment\n"
+        "_:foo\t<http://example.com/p>\t\"bar\"@de .\r\n"
+        "_:foo <http://example.com/p> \"bar\"^^<http://example.com/type> .\n"
+        "_:foo <http://example.com/p> \"a\\tb\\\"c\\u00E4\" .\n"
+        "<http://example.com/a> <http://example.com/p> <http://example.com/b> .\n";
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_ntriples(data, strlen(data), ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    // the duplicate is removed
+    fail_unless(atlas_rdf_graph_length(graph) == 5);
+    
+    atlas_rdf_term_t a, b, p, foo, type, obj[4];
+    a = atlas_rdf_term_create_iri("http://example.com/a", ^(int err, const char * msg){});
+    b = atlas_rdf_term_create_iri("http://example.com/b", ^(int err, const char * msg){});
+    p = atlas_rdf_term_create_iri("http://example.com/p", ^(int err, const char * msg){});
+    foo = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    type = atlas_rdf_term_create_iri("http://example.com/type", ^(int err, const char * msg){});
+    obj[0] = atlas_rdf_term_create_string("bar", 0, ^(int err, const char * msg){});
+    obj[1] = atlas_rdf_term_create_string("bar", "de", ^(int err, const char * msg){});
+    obj[2] = atlas_rdf_term_create_typed("bar", type, ^(int err, const char * msg){});
+    obj[3] = atlas_rdf_term_create_string("a\tb\"c\xC3\xA4", 0, ^(int err, const char * msg){});
+    
+    fail_unless(atlas_rdf_graph_contains(graph, a, p, b));
+    for (int k=0; k<4; k++) {
+        fail_unless(atlas_rdf_graph_contains(graph, foo, p, obj[k]));
+    }
+    
+    lz_release(graph);
+    for (int k=0; k<4; k++) {
+        lz_release(obj[k]);
+    }
+    lz_release(a);
+    lz_release(b);
+    lz_release(p);
+    lz_release(foo);
+    lz_release(type);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_ntriples_stream
+
+START_TEST (test_rdf_ntriples_stream) {
+    
+    const char * data =
+        "<http://example.com/a> <http://example.com/p> \"1\" .\n"
+        "<http://example.com/a> <http://example.com/p> \"2\" .\n"
+        "<http://example.com/a> <http://example.com/p> \"3\" .";
+    
+    // feed the data in small pieces, which split lines and terms
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    atlas_rdf_ntriples_parser_t parser = atlas_rdf_ntriples_parser_create(builder);
+    size_t length = strlen(data);
+    for (size_t pos=0; pos<length; pos+=7) {
+        size_t n = length - pos < 7 ? length - pos : 7;
+        fail_unless(atlas_rdf_ntriples_parser_parse(parser, data + pos, n, ^(int err, const char * msg){
+            fail_if(1, msg);
+        }));
+    }
+    
+    // the last line is not terminated by a line break
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 2);
+    fail_unless(atlas_rdf_ntriples_parser_finish(parser, ^(int err, const char * msg){
+        fail_if(1, msg);
+    }));
+    fail_unless(atlas_rdf_graph_builder_length(builder) == 3);
+    
+    atlas_rdf_ntriples_parser_free(parser);
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    fail_unless(atlas_rdf_graph_length(graph) == 3);
+    lz_release(graph);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_ntriples_large
+
+START_TEST (test_rdf_ntriples_large) {
+    
+    // large enough to be parsed in several parts
+    int num = 40000;
+    size_t capacity = num * 128;
+    char * data = malloc(capacity);
+    size_t length = 0;
+    for (int i=0; i<num; i++) {
+        length += snprintf(data + length, capacity - length,
+                           "<http://example.com/s%d> <http://example.com/p%d> \"value %d\" .\n",
+                           i % 1000, i % 7, i);
+    }
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_ntriples(data, length, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    fail_unless(atlas_rdf_graph_length(graph) == num);
+    
+    atlas_rdf_term_t s = atlas_rdf_term_create_iri("http://example.com/s234", ^(int err, const char * msg){});
+    atlas_rdf_term_t p = atlas_rdf_term_create_iri("http://example.com/p1", ^(int err, const char * msg){});
+    atlas_rdf_term_t o = atlas_rdf_term_create_string("value 39234", 0, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_contains(graph, s, p, o));
+    lz_release(s);
+    lz_release(p);
+    lz_release(o);
+    
+    // a syntax error in a later part reports the absolute line
+    memcpy(data + length - 2, "!\n", 2);
+    __block int error_called = 0;
+    atlas_rdf_graph_t invalid = atlas_rdf_graph_create_from_ntriples(data, length, ^(int err, const char * msg){
+        char expected[64];
+        snprintf(expected, 64, "Syntax error in line %d:", num);
+        fail_unless(strncmp(msg, expected, strlen(expected)) == 0, msg);
+        error_called = 1;
+    });
+    fail_unless(invalid == 0);
+    fail_unless(error_called);
+    
+    lz_release(graph);
+    free(data);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_ntriples_invalid
+
+START_TEST (test_rdf_ntriples_invalid) {
+    
+    const char * invalid[] = {
+        "<http://example.com/a> <http://example.com/p> <http://example.com/b>\n",
+        "<relative> <http://example.com/p> <http://example.com/b> .\n",
+        "\"literal\" <http://example.com/p> <http://example.com/b> .\n",
+        "<http://example.com/a> _:p <http://example.com/b> .\n",
+        "<http://example.com/a> <http://example.com/p> \"foo .\n",
+        "<http://example.com/a> <http://example.com/p> \"\\q\" .\n",
+        "<http://example.com/a> <http://example.com/p> <http://example.com/b> . x\n",
+        "<http://example.com/a b> <http://example.com/p> <http://example.com/b> .\n"
+    };
+    
+    for (int k=0; k<8; k++) {
+        __block int error_called = 0;
+        atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_ntriples(invalid[k], strlen(invalid[k]), ^(int err, const char * msg){
+            fail_unless(strncmp(msg, "Syntax error in line 1:", 23) == 0, msg);
+            error_called = 1;
+        });
+        fail_unless(graph == 0, invalid[k]);
+        fail_unless(error_called, invalid[k]);
+    }
+    
+    // a file which does not exist
+    __block int error_called = 0;
+    atlas_rdf_graph_t graph = atlas_rdf_graph_open_ntriples("/tmp/atlas_test_ntriples_does_not_exist", ^(int err, const char * msg){
+        error_called = 1;
+    });
+    fail_unless(graph == 0);
+    fail_unless(error_called);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_ntriples_file
+
+START_TEST (test_rdf_ntriples_file) {
+    
+    char path[] = "/tmp/atlas_test_ntriples_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    const char * text =
+        "<http://example.com/a> <http://example.com/b> <http://example.com/c> .\n"
+        "<http://example.com/a> <http://example.com/b> _:c .\n";
+    write(fd, text, strlen(text));
+    close(fd);
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_open_ntriples(path, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    fail_unless(atlas_rdf_graph_length(graph) == 2);
+    lz_release(graph);
+    
+    unlink(path);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Test Write N-Triples
+
+#pragma mark test_rdf_ntriples_write
+
+START_TEST (test_rdf_ntriples_write) {
+    
+    atlas_rdf_term_t sub1, pred1, type, obj[8];
+    sub1 = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    pred1 = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    type = atlas_rdf_term_create_iri("http://example.com/type", ^(int err, const char * msg){});
+    
+    mpz_t i;
+    mpz_init_set_str(i, "123456789012345678901234567890", 10);
+    obj[0] = atlas_rdf_term_create_integer(i, ^(int err, const char * msg){});
+    mpz_clear(i);
+    
+    obj[1] = atlas_rdf_term_create_string("a \"quoted\"\nline", "de", ^(int err, const char * msg){});
+    obj[2] = atlas_rdf_term_create_typed("foo", type, ^(int err, const char * msg){});
+    obj[3] = atlas_rdf_term_create_double(0.1, ^(int err, const char * msg){});
+    obj[4] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    obj[5] = atlas_rdf_term_create_datetime(1272448800, ^(int err, const char * msg){});
+    obj[6] = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    obj[7] = atlas_rdf_term_create_string("back\\slash", 0, ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[8];
+    for (int k=0; k<8; k++) {
+        statements[k].subject = sub1;
+        statements[k].predicate = pred1;
+        statements[k].object = obj[k];
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(8, statements, ^(int err, const char * msg){});
+    
+    // write the graph sorted into a buffer
+    __block char * data = 0;
+    __block size_t length = 0;
+    int result = atlas_rdf_graph_write_ntriples_sink(graph, ATLAS_RDF_NTRIPLES_SORTED, ^(const char * d, size_t l){
+        data = realloc(data, length + l + 1);
+        memcpy(data + length, d, l);
+        length += l;
+        data[length] = 0;
+        return 1;
+    }, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_unless(result);
+    
+    // the lines are sorted
+    char * line = data;
+    char * prev = 0;
+    int num_lines = 0;
+    while (*line) {
+        char * nl = strchr(line, '\n');
+        fail_if(nl == 0);
+        *nl = 0;
+        if (prev) {
+            fail_unless(strcmp(prev, line) < 0);
+        }
+        prev = line;
+        line = nl + 1;
+        num_lines++;
+        *nl = '\n';
+    }
+    fail_unless(num_lines == 8);
+    
+    // the written graph can be read again
+    atlas_rdf_graph_t parsed = atlas_rdf_graph_create_from_ntriples(data, length, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(parsed == 0);
+    atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(graph, parsed, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_length(diff) == 0);
+    fail_unless(atlas_rdf_graph_length(parsed) == 8);
+    lz_release(diff);
+    lz_release(parsed);
+    free(data);
+    
+    // write to a file
+    char path[] = "/tmp/atlas_test_ntriples_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    fail_unless(atlas_rdf_graph_write_ntriples(graph, fd, 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    }));
+    close(fd);
+    parsed = atlas_rdf_graph_open_ntriples(path, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_unless(atlas_rdf_graph_length(parsed) == 8);
+    lz_release(parsed);
+    unlink(path);
+    
+    // N-Quads contain the name of the graph
+    data = 0;
+    length = 0;
+    result = atlas_rdf_graph_write_nquads_sink(graph, type, 0, ^(const char * d, size_t l){
+        data = realloc(data, length + l + 1);
+        memcpy(data + length, d, l);
+        length += l;
+        data[length] = 0;
+        return 1;
+    }, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_unless(result);
+    const char * suffix = " <http://example.com/type> .\n";
+    fail_unless(strcmp(data + length - strlen(suffix), suffix) == 0);
+    free(data);
+    
+    // a sink, which fails, aborts the writing
+    __block int error_called = 0;
+    result = atlas_rdf_graph_write_ntriples_sink(graph, 0, ^(const char * d, size_t l){
+        return 0;
+    }, ^(int err, const char * msg){
+        error_called = 1;
+    });
+    fail_unless(result == 0);
+    fail_unless(error_called);
+    
+    lz_release(graph);
+    for (int k=0; k<8; k++) {
+        lz_release(obj[k]);
+    }
+    lz_release(sub1);
+    lz_release(pred1);
+    lz_release(type);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF N-Triples Suites
+
+Suite * rdf_ntriples_suite(void) {
+    Suite *s = suite_create("RDF N-Triples");
+    
+    TCase *tc_parse = tcase_create("Parse");
+    tcase_add_checked_fixture (tc_parse, setup, teardown);
+    tcase_add_test(tc_parse, test_rdf_ntriples_parse);
+    tcase_add_test(tc_parse, test_rdf_ntriples_stream);
+    tcase_add_test(tc_parse, test_rdf_ntriples_large);
+    tcase_add_test(tc_parse, test_rdf_ntriples_invalid);
+    tcase_add_test(tc_parse, test_rdf_ntriples_file);
+    
+    suite_add_tcase(s, tc_parse);
+    
+    TCase *tc_write = tcase_create("Write");
+    tcase_add_checked_fixture (tc_write, setup, teardown);
+    tcase_add_test(tc_write, test_rdf_ntriples_write);
+    suite_add_tcase(s, tc_write);
+    
+    return s;
+}
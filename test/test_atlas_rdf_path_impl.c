@@ -0,0 +1,265 @@
+/*
+ *  test_atlas_rdf_path_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_path_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Property Paths
+
+#pragma mark test_rdf_path_hierarchy
+
+START_TEST (test_rdf_path_hierarchy) {
+    
+    atlas_rdf_term_t part_of = atlas_rdf_term_create_iri("http://example.com/partOf", ^(int err, const char * msg){});
+    atlas_rdf_term_t located_in = atlas_rdf_term_create_iri("http://example.com/locatedIn", ^(int err, const char * msg){});
+    atlas_rdf_term_t building = atlas_rdf_term_create_iri("http://example.com/building", ^(int err, const char * msg){});
+    atlas_rdf_term_t city = atlas_rdf_term_create_iri("http://example.com/city", ^(int err, const char * msg){});
+    atlas_rdf_term_t county = atlas_rdf_term_create_iri("http://example.com/county", ^(int err, const char * msg){});
+    atlas_rdf_term_t state = atlas_rdf_term_create_iri("http://example.com/state", ^(int err, const char * msg){});
+    atlas_rdf_term_t country = atlas_rdf_term_create_iri("http://example.com/country", ^(int err, const char * msg){});
+    atlas_rdf_term_t other = atlas_rdf_term_create_iri("http://example.com/other", ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[4] = {
+        {building, located_in, city},
+        {city, part_of, county},
+        {county, part_of, state},
+        {state, part_of, country}
+    };
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(4, statements, ^(int err, const char * msg){});
+    
+    atlas_rdf_path_t p1 = atlas_rdf_path_create_predicate(part_of, ^(int err, const char * msg){});
+    atlas_rdf_path_t p2 = atlas_rdf_path_create_predicate(located_in, ^(int err, const char * msg){});
+    atlas_rdf_path_t plus = atlas_rdf_path_create_one_or_more(p1);
+    atlas_rdf_path_t star = atlas_rdf_path_create_zero_or_more(p1);
+    atlas_rdf_path_t seq = atlas_rdf_path_create_sequence(p2, star);
+    atlas_rdf_path_t alt = atlas_rdf_path_create_alternative(p1, p2);
+    
+    // one or more
+    __block int found = 0;
+    int count = atlas_rdf_graph_path_apply(graph, city, plus, ^(atlas_rdf_term_t term){
+        fail_if(atlas_rdf_term_eq(term, city));
+        found++;
+    });
+    fail_unless(count == 3);
+    fail_unless(found == 3);
+    fail_unless(atlas_rdf_graph_path_contains(graph, city, plus, country));
+    fail_if(atlas_rdf_graph_path_contains(graph, country, plus, city));
+    fail_if(atlas_rdf_graph_path_contains(graph, city, plus, city));
+    
+    // zero or more
+    fail_unless(atlas_rdf_graph_path_apply(graph, city, star, 0) == 4);
+    fail_unless(atlas_rdf_graph_path_contains(graph, city, star, city));
+    fail_unless(atlas_rdf_graph_path_apply(graph, country, star, 0) == 1);
+    
+    // a term which is not in the graph reaches only itself
+    fail_unless(atlas_rdf_graph_path_contains(graph, other, star, other));
+    fail_unless(atlas_rdf_graph_path_apply(graph, other, star, 0) == 1);
+    fail_unless(atlas_rdf_graph_path_apply(graph, other, plus, 0) == 0);
+    
+    // sequence and alternative
+    fail_unless(atlas_rdf_graph_path_apply(graph, building, seq, 0) == 4);
+    fail_unless(atlas_rdf_graph_path_contains(graph, building, seq, state));
+    fail_if(atlas_rdf_graph_path_contains(graph, building, seq, building));
+    fail_unless(atlas_rdf_graph_path_apply(graph, building, alt, 0) == 1);
+    fail_unless(atlas_rdf_graph_path_contains(graph, city, alt, county));
+    
+    // materialize the closure
+    atlas_rdf_term_t ancestor = atlas_rdf_term_create_iri("http://example.com/ancestor", ^(int err, const char * msg){});
+    atlas_rdf_graph_t closure = atlas_rdf_graph_create_path_closure(graph, plus, ancestor, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(closure == 0);
+    if (closure) {
+        fail_unless(atlas_rdf_graph_length(closure) == 6);
+        fail_unless(atlas_rdf_graph_contains(closure, city, ancestor, country));
+        fail_unless(atlas_rdf_graph_contains(closure, state, ancestor, country));
+        fail_if(atlas_rdf_graph_contains(closure, building, ancestor, city));
+        lz_release(closure);
+    }
+    
+    // the predicate of a path must be an iri
+    __block int num_errors = 0;
+    atlas_rdf_term_t literal = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_path_create_predicate(literal, ^(int err, const char * msg){
+        num_errors++;
+    }) == 0);
+    fail_unless(num_errors == 1);
+    lz_release(literal);
+    
+    lz_release(p1);
+    lz_release(p2);
+    lz_release(plus);
+    lz_release(star);
+    lz_release(seq);
+    lz_release(alt);
+    lz_release(graph);
+    lz_release(part_of);
+    lz_release(located_in);
+    lz_release(building);
+    lz_release(city);
+    lz_release(county);
+    lz_release(state);
+    lz_release(country);
+    lz_release(other);
+    lz_release(ancestor);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_path_large
+
+START_TEST (test_rdf_path_large) {
+    
+    // a tree with a root, 5000 children and 10000 grandchildren,
+    // the grandchildren point back to the root
+    atlas_rdf_term_t child = atlas_rdf_term_create_iri("http://example.com/child", ^(int err, const char * msg){});
+    atlas_rdf_term_t root = atlas_rdf_term_create_iri("http://example.com/root", ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<5000; i++) {
+        char buffer[64];
+        snprintf(buffer, 64, "http://example.com/node/%d", i);
+        atlas_rdf_term_t node = atlas_rdf_term_create_iri(buffer, ^(int err, const char * msg){});
+        atlas_rdf_graph_builder_add(builder, root, child, node, ^(int err, const char * msg){});
+        for (int k=0; k<2; k++) {
+            snprintf(buffer, 64, "http://example.com/node/%d/%d", i, k);
+            atlas_rdf_term_t leaf = atlas_rdf_term_create_iri(buffer, ^(int err, const char * msg){});
+            atlas_rdf_graph_builder_add(builder, node, child, leaf, ^(int err, const char * msg){});
+            atlas_rdf_graph_builder_add(builder, leaf, child, root, ^(int err, const char * msg){});
+            lz_release(leaf);
+        }
+        lz_release(node);
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    
+    atlas_rdf_path_t p = atlas_rdf_path_create_predicate(child, ^(int err, const char * msg){});
+    atlas_rdf_path_t plus = atlas_rdf_path_create_one_or_more(p);
+    
+    // each term is reported once, although the graph has cycles
+    fail_unless(atlas_rdf_graph_path_apply(graph, root, plus, 0) == 15001);
+    
+    atlas_rdf_term_t leaf = atlas_rdf_term_create_iri("http://example.com/node/4711/1", ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_path_contains(graph, root, plus, leaf));
+    fail_unless(atlas_rdf_graph_path_contains(graph, leaf, plus, leaf));
+    lz_release(leaf);
+    
+    lz_release(p);
+    lz_release(plus);
+    lz_release(graph);
+    lz_release(child);
+    lz_release(root);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_path_closure
+
+START_TEST (test_rdf_path_closure) {
+    
+    // the predicate of the closure is also a node of the graph and
+    // the term d has only incoming edges
+    atlas_rdf_term_t sp = atlas_rdf_term_create_iri("http://example.com/subPropertyOf", ^(int err, const char * msg){});
+    atlas_rdf_term_t other = atlas_rdf_term_create_iri("http://example.com/other", ^(int err, const char * msg){});
+    atlas_rdf_term_t a = atlas_rdf_term_create_iri("http://example.com/a", ^(int err, const char * msg){});
+    atlas_rdf_term_t b = atlas_rdf_term_create_iri("http://example.com/b", ^(int err, const char * msg){});
+    atlas_rdf_term_t c = atlas_rdf_term_create_iri("http://example.com/c", ^(int err, const char * msg){});
+    atlas_rdf_term_t d = atlas_rdf_term_create_iri("http://example.com/d", ^(int err, const char * msg){});
+    
+    atlas_rdf_statement_t statements[3] = {
+        {a, sp, b},
+        {b, sp, sp},
+        {c, other, d}
+    };
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create(3, statements, ^(int err, const char * msg){});
+    
+    atlas_rdf_path_t p = atlas_rdf_path_create_predicate(sp, ^(int err, const char * msg){});
+    atlas_rdf_path_t star = atlas_rdf_path_create_zero_or_more(p);
+    
+    atlas_rdf_graph_t closure = atlas_rdf_graph_create_path_closure(graph, star, sp, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(closure == 0);
+    if (closure) {
+        // a: {a, b, sp}, b: {b, sp}, sp: {sp}, c: {c}, d: {d}
+        fail_unless(atlas_rdf_graph_length(closure) == 8);
+        fail_unless(atlas_rdf_graph_contains(closure, a, sp, sp));
+        fail_unless(atlas_rdf_graph_contains(closure, b, sp, sp));
+        fail_unless(atlas_rdf_graph_contains(closure, sp, sp, sp));
+        fail_unless(atlas_rdf_graph_contains(closure, c, sp, c));
+        fail_unless(atlas_rdf_graph_contains(closure, d, sp, d));
+        fail_if(atlas_rdf_graph_contains(closure, other, sp, other));
+        fail_if(atlas_rdf_graph_contains(closure, sp, sp, a));
+        lz_release(closure);
+    }
+    
+    lz_release(p);
+    lz_release(star);
+    lz_release(graph);
+    lz_release(sp);
+    lz_release(other);
+    lz_release(a);
+    lz_release(b);
+    lz_release(c);
+    lz_release(d);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Property Path Suites
+
+Suite * rdf_path_suite(void) {
+    Suite *s = suite_create("RDF Property Path");
+    
+    TCase *tc_path = tcase_create("Property Path");
+    tcase_add_checked_fixture (tc_path, setup, teardown);
+    tcase_add_test(tc_path, test_rdf_path_hierarchy);
+    tcase_add_test(tc_path, test_rdf_path_large);
+    tcase_add_test(tc_path, test_rdf_path_closure);
+    
+    suite_add_tcase(s, tc_path);
+    
+    return s;
+}
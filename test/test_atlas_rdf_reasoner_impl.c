@@ -0,0 +1,203 @@
+/*
+ *  test_atlas_rdf_reasoner_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_reasoner_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+#define RDF "http://www.w3.org/1999/02/22-rdf-syntax-ns#"
+#define RDFS "http://www.w3.org/2000/01/rdf-schema#"
+#define OWL "http://www.w3.org/2002/07/owl#"
+#define EX "http://example.com/"
+
+// create a graph from statements with iris, the array
+// contains the subject, predicate and object of each statement
+static atlas_rdf_graph_t
+create_graph(int num_statements, const char ** iris) {
+    atlas_rdf_graph_builder_t builder = atlas_rdf_graph_builder_create(0);
+    for (int i=0; i<num_statements; i++) {
+        atlas_rdf_term_t terms[3];
+        for (int k=0; k<3; k++) {
+            terms[k] = atlas_rdf_term_create_iri(iris[3 * i + k], ^(int err, const char * msg){});
+        }
+        atlas_rdf_graph_builder_add(builder, terms[0], terms[1], terms[2], ^(int err, const char * msg){});
+        for (int k=0; k<3; k++) {
+            lz_release(terms[k]);
+        }
+    }
+    atlas_rdf_graph_t graph = atlas_rdf_graph_builder_commit(builder, ^(int err, const char * msg){});
+    atlas_rdf_graph_builder_free(builder);
+    return graph;
+}
+
+static int
+contains(atlas_rdf_graph_t graph, const char * s, const char * p, const char * o) {
+    atlas_rdf_term_t subject = atlas_rdf_term_create_iri(s, ^(int err, const char * msg){});
+    atlas_rdf_term_t predicate = atlas_rdf_term_create_iri(p, ^(int err, const char * msg){});
+    atlas_rdf_term_t object = atlas_rdf_term_create_iri(o, ^(int err, const char * msg){});
+    int result = atlas_rdf_graph_contains(graph, subject, predicate, object);
+    lz_release(subject);
+    lz_release(predicate);
+    lz_release(object);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Test RDFS Materialization
+
+#pragma mark test_rdf_reasoner_rdfs
+
+START_TEST (test_rdf_reasoner_rdfs) {
+    
+    const char * schema[] = {
+        EX "Dog", RDFS "subClassOf", EX "Mammal",
+        EX "Mammal", RDFS "subClassOf", EX "Animal",
+        EX "hasPet", RDFS "domain", EX "Person",
+        EX "hasPet", RDFS "range", EX "Animal",
+        EX "hasDog", RDFS "subPropertyOf", EX "hasPet",
+        EX "alice", EX "hasDog", EX "rex",
+        EX "rex", RDF "type", EX "Dog"
+    };
+    atlas_rdf_graph_t graph = create_graph(7, schema);
+    
+    atlas_rdf_graph_t inferred = atlas_rdf_graph_create_inferred(graph, 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(inferred == 0);
+    fail_unless(atlas_rdf_graph_length(inferred) == 5);
+    fail_unless(contains(inferred, EX "Dog", RDFS "subClassOf", EX "Animal"));
+    fail_unless(contains(inferred, EX "alice", EX "hasPet", EX "rex"));
+    fail_unless(contains(inferred, EX "alice", RDF "type", EX "Person"));
+    fail_unless(contains(inferred, EX "rex", RDF "type", EX "Mammal"));
+    fail_unless(contains(inferred, EX "rex", RDF "type", EX "Animal"));
+    
+    // the given statements are not in the result
+    fail_if(contains(inferred, EX "rex", RDF "type", EX "Dog"));
+    
+    // incremental materialization, one of the added
+    // statements has been inferred before
+    const char * delta[] = {
+        EX "bob", EX "hasDog", EX "fido",
+        EX "rex", RDF "type", EX "Mammal"
+    };
+    atlas_rdf_graph_t added = create_graph(2, delta);
+    atlas_rdf_graph_t updated = atlas_rdf_graph_create_inferred_incremental(graph, inferred, added, 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(updated == 0);
+    fail_unless(atlas_rdf_graph_length(updated) == 7);
+    fail_unless(contains(updated, EX "bob", RDF "type", EX "Person"));
+    fail_unless(contains(updated, EX "fido", RDF "type", EX "Animal"));
+    fail_if(contains(updated, EX "rex", RDF "type", EX "Mammal"));
+    
+    // the same as the materialization of the union
+    atlas_rdf_graph_t all = atlas_rdf_graph_create_union(graph, added, ^(int err, const char * msg){});
+    atlas_rdf_graph_t expected = atlas_rdf_graph_create_inferred(all, 0, ^(int err, const char * msg){});
+    atlas_rdf_graph_t diff = atlas_rdf_graph_create_difference(expected, updated, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_length(diff) == 0);
+    lz_release(diff);
+    diff = atlas_rdf_graph_create_difference(updated, expected, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_length(diff) == 0);
+    lz_release(diff);
+    
+    lz_release(expected);
+    lz_release(all);
+    lz_release(updated);
+    lz_release(added);
+    lz_release(inferred);
+    lz_release(graph);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_reasoner_owl
+
+START_TEST (test_rdf_reasoner_owl) {
+    
+    const char * statements[] = {
+        EX "knows", RDF "type", OWL "SymmetricProperty",
+        EX "ancestorOf", RDF "type", OWL "TransitiveProperty",
+        EX "parentOf", OWL "inverseOf", EX "childOf",
+        EX "a", EX "knows", EX "b",
+        EX "x", EX "ancestorOf", EX "y",
+        EX "y", EX "ancestorOf", EX "z",
+        EX "z", EX "ancestorOf", EX "w",
+        EX "p", EX "parentOf", EX "c"
+    };
+    atlas_rdf_graph_t graph = create_graph(8, statements);
+    
+    // the rules are only applied if requested
+    atlas_rdf_graph_t inferred = atlas_rdf_graph_create_inferred(graph, 0, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_length(inferred) == 0);
+    lz_release(inferred);
+    
+    inferred = atlas_rdf_graph_create_inferred(graph, ATLAS_RDF_INFERENCE_OWL, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(inferred == 0);
+    fail_unless(atlas_rdf_graph_length(inferred) == 5);
+    fail_unless(contains(inferred, EX "b", EX "knows", EX "a"));
+    fail_unless(contains(inferred, EX "x", EX "ancestorOf", EX "z"));
+    fail_unless(contains(inferred, EX "y", EX "ancestorOf", EX "w"));
+    fail_unless(contains(inferred, EX "x", EX "ancestorOf", EX "w"));
+    fail_unless(contains(inferred, EX "c", EX "childOf", EX "p"));
+    
+    lz_release(inferred);
+    lz_release(graph);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Reasoner Suites
+
+Suite * rdf_reasoner_suite(void) {
+    Suite *s = suite_create("RDF Reasoner");
+    
+    TCase *tc_reasoner = tcase_create("RDFS Materialization");
+    tcase_add_checked_fixture (tc_reasoner, setup, teardown);
+    tcase_add_test(tc_reasoner, test_rdf_reasoner_rdfs);
+    tcase_add_test(tc_reasoner, test_rdf_reasoner_owl);
+    
+    suite_add_tcase(s, tc_reasoner);
+    
+    return s;
+}
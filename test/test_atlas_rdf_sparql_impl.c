@@ -0,0 +1,468 @@
+/*
+ *  test_atlas_rdf_sparql_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_sparql_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+#define EX "http://example.com/"
+
+static const char * turtle =
+    "@prefix ex: <http://example.com/> .\n"
+    "ex:alice ex:name \"Alice\" ; ex:age 30 ; ex:knows ex:bob , ex:carol ; ex:city ex:berlin .\n"
+    "ex:bob ex:name \"Bob\" ; ex:age 25 ; ex:knows ex:carol ; ex:city ex:berlin .\n"
+    "ex:carol ex:name \"Carol\" ; ex:age 35 ; ex:city ex:paris .\n"
+    "ex:dave ex:name \"Dave\" .\n";
+
+// the results of a query as lines of values separated by spaces,
+// IRIs are written without the namespace and unbound values as '-'
+static char *
+execute(atlas_rdf_graph_t graph, const char * sparql) {
+    atlas_rdf_query_t query = atlas_rdf_query_create(sparql, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(query == 0);
+    
+    __block char * result = calloc(1, 1);
+    __block size_t length = 0;
+    int num_columns = atlas_rdf_query_num_columns(query);
+    int count = atlas_rdf_query_execute(query, graph, ^(atlas_rdf_term_t * values){
+        for (int i=0; i<num_columns; i++) {
+            char * value;
+            if (values[i] == 0) {
+                value = strdup("-");
+            } else if (atlas_rdf_term_is_type(values[i], IRI)) {
+                char * iri = atlas_rdf_term_iri_value(values[i]);
+                value = strdup(strncmp(iri, EX, strlen(EX)) == 0 ? iri + strlen(EX) : iri);
+                free(iri);
+            } else {
+                value = atlas_rdf_term_literal_value(values[i]);
+            }
+            result = realloc(result, length + strlen(value) + 2);
+            length += sprintf(result + length, "%s%s", value, i + 1 < num_columns ? " " : "\n");
+            free(value);
+        }
+    });
+    fail_unless(count == 0 || length > 0 || num_columns == 0);
+    lz_release(query);
+    return result;
+}
+
+#define assert_query(graph, sparql, expected) do {                  \
+    char * __result = execute(graph, sparql);                       \
+    fail_unless(strcmp(__result, expected) == 0, __result);         \
+    free(__result);                                                 \
+} while (0)
+
+#define PREFIX "PREFIX ex: <http://example.com/>\n"
+
+#pragma mark -
+#pragma mark Test SPARQL Queries
+
+#pragma mark test_rdf_sparql_bgp
+
+START_TEST (test_rdf_sparql_bgp) {
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    atlas_rdf_query_t query = atlas_rdf_query_create(PREFIX "SELECT ?name ?x WHERE { ?x ex:name ?name }", ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_unless(atlas_rdf_query_num_columns(query) == 2);
+    fail_unless(strcmp(atlas_rdf_query_column_name(query, 0), "name") == 0);
+    fail_unless(strcmp(atlas_rdf_query_column_name(query, 1), "x") == 0);
+    fail_unless(atlas_rdf_query_execute(query, graph, 0) == 4);
+    lz_release(query);
+    
+    // joins over shared variables
+    assert_query(graph, PREFIX "SELECT ?n WHERE { ?x ex:knows ?y . ?y ex:city ex:berlin . ?x ex:name ?n }",
+                 "Alice\n");
+    assert_query(graph, PREFIX "SELECT ?a ?c WHERE { ?a ex:knows ?b . ?b ex:knows ?c } ",
+                 "alice carol\n");
+    
+    // constants, which are not in the graph
+    assert_query(graph, PREFIX "SELECT * WHERE { ?x ex:unknown ?y }", "");
+    
+    // repeated variables and blank nodes
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:knows ?x }", "");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:knows _:c ; ex:age 25 . _:c ex:city ex:paris }", "bob\n");
+    
+    // the type of the literals is compared
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age 30 }", "alice\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:name 'Carol' }", "carol\n");
+    
+    lz_release(graph);
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_sparql_filter
+
+START_TEST (test_rdf_sparql_filter) {
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 28) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age >= 25 && ?age < 35 && ?x != ex:alice) }",
+                 "bob\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (!(?age <= 30) || ?x = ex:bob) } ORDER BY ?x",
+                 "bob\ncarol\n");
+    
+    // comparing incompatible values is an error
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:name ?n FILTER (?n < 10) }", "");
+    
+    // optional patterns and BOUND
+    assert_query(graph, PREFIX "SELECT ?n ?age WHERE { ?x ex:name ?n OPTIONAL { ?x ex:age ?age FILTER (?age > 26) } } ORDER BY ?n",
+                 "Alice 30\nBob -\nCarol 35\nDave -\n");
+    assert_query(graph, PREFIX "SELECT ?n WHERE { ?x ex:name ?n OPTIONAL { ?x ex:age ?age } FILTER (!BOUND(?age)) }",
+                 "Dave\n");
+    
+    // alternatives
+    assert_query(graph, PREFIX "SELECT ?x ?y WHERE { { ?x ex:city ex:paris } UNION { ?x ex:knows ?y } } ORDER BY ?x ?y",
+                 "alice bob\nalice carol\nbob carol\ncarol -\n");
+    
+    assert_query(graph, PREFIX "SELECT ?o WHERE { ex:alice ?p ?o FILTER (isLiteral(?o)) } ORDER BY ?o",
+                 "30\nAlice\n");
+    
+    lz_release(graph);
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_sparql_expressions
+
+START_TEST (test_rdf_sparql_expressions) {
+    
+    const char * data =
+        "@prefix ex: <http://example.com/> .\n"
+        "@prefix xsd: <http://www.w3.org/2001/XMLSchema#> .\n"
+        "ex:a ex:price 10 ; ex:weight 2.5e0 ; ex:label \"Apple\"@en , \"Apfel\"@de ; ex:date \"2010-05-01T00:00:00Z\"^^xsd:dateTime .\n"
+        "ex:b ex:price 4 ; ex:weight 0.5e0 ; ex:label \"Banana\"@en ; ex:date \"2010-06-01T00:00:00Z\"^^xsd:dateTime .\n"
+        "ex:c ex:price 7.5 ; ex:label \"cherry\" .\n";
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(data, strlen(data), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    // arithmetic with numeric type promotion
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p * 2 >= 15) } ORDER BY ?x",
+                 "a\nc\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p / 2 = 2) }",
+                 "b\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (-?p < -5 && ?p - 1 != 9) }",
+                 "c\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:weight ?w FILTER (?w + ?w > 2.0e0) }",
+                 "a\n");
+    
+    // a division by zero is an error
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p / 0 > 1 || ?p / 0 <= 1) }",
+                 "");
+    
+    // LANG and REGEX
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER (LANG(?l) = \"en\") } ORDER BY ?l",
+                 "Apple\nBanana\n");
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER (LANG(?l) = \"\") }",
+                 "cherry\n");
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER REGEX(?l, \"^a\", \"i\") } ORDER BY ?l",
+                 "Apfel\nApple\n");
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER (REGEX(?l, \"an\") && isLiteral(?l)) }",
+                 "Banana\n");
+    
+    // literal patterns and languages, which are looked up in the text index
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:label ?l FILTER REGEX(?l, \"ppl\") }",
+                 "a\n");
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER (REGEX(?l, \"^APF\", \"i\") && LANG(?l) = \"de\") }",
+                 "Apfel\n");
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER (\"en\" = LANG(?l) && REGEX(?l, \"nana\\\\.\")) }",
+                 "");
+    assert_query(graph, PREFIX "SELECT ?l WHERE { ?x ex:label ?l FILTER REGEX(?l, \"err.\") }",
+                 "cherry\n");
+    
+    // datetimes and the error of an unbound variable
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:date ?d FILTER (?d > \"2010-05-15T00:00:00Z\"^^<http://www.w3.org/2001/XMLSchema#dateTime>) }",
+                 "b\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p OPTIONAL { ?x ex:date ?d } "
+                               "FILTER (!BOUND(?d) || ?d < \"2010-05-15T00:00:00Z\"^^<http://www.w3.org/2001/XMLSchema#dateTime>) } ORDER BY ?x",
+                 "a\nc\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p OPTIONAL { ?x ex:date ?d } FILTER (?d < ?d + 1) }",
+                 "");
+    
+    // comparisons with constants, which are answered with the range index
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p >= 4 && 7.5 >= ?p) } ORDER BY ?x",
+                 "b\nc\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p = 10.0e0) }",
+                 "a\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p > 5 && ?p < 5) }",
+                 "");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:price ?p FILTER (?p > 5 && ?p < \"2010-05-15T00:00:00Z\"^^<http://www.w3.org/2001/XMLSchema#dateTime>) }",
+                 "");
+    
+    // the pattern of REGEX must be a valid constant
+    __block int errors = 0;
+    fail_unless(atlas_rdf_query_create("SELECT ?x WHERE { ?x ?p ?l FILTER REGEX(?l, ?x) }", ^(int err, const char * msg){
+        errors++;
+    }) == 0);
+    fail_unless(atlas_rdf_query_create("SELECT ?x WHERE { ?x ?p ?l FILTER REGEX(?l, \"(\") }", ^(int err, const char * msg){
+        errors++;
+    }) == 0);
+    fail_unless(errors == 2);
+    
+    lz_release(graph);
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_sparql_equality
+
+START_TEST (test_rdf_sparql_equality) {
+    
+    // numeric terms of different types can be equal
+    const char * data =
+        "@prefix ex: <http://example.com/> .\n"
+        "ex:a ex:v 10 .\n"
+        "ex:b ex:v 10.0 .\n"
+        "ex:c ex:v 1.0e1 .\n"
+        "ex:d ex:v 11 .\n"
+        "ex:e ex:v true .\n"
+        "ex:f ex:v ex:ten .\n";
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(data, strlen(data), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:v ?v FILTER (?v = 10) } ORDER BY ?x",
+                 "a\nb\nc\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:v ?v FILTER (?v = 5 + 5) } ORDER BY ?x",
+                 "a\nb\nc\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:v ?v FILTER (10.0 = ?v) } ORDER BY ?x",
+                 "a\nb\nc\n");
+    
+    // terms, which are not numeric, are not equal to a number
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:v ?v FILTER (?v != 10) } ORDER BY ?x",
+                 "d\ne\nf\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:v ?v FILTER (?v = true) }",
+                 "e\n");
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:v ?v FILTER (?v != ex:ten) } ORDER BY ?x",
+                 "a\nb\nc\nd\ne\n");
+    
+    lz_release(graph);
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_sparql_modifiers
+
+START_TEST (test_rdf_sparql_modifiers) {
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    assert_query(graph, PREFIX "SELECT ?n WHERE { ?x ex:name ?n } ORDER BY DESC(?n)",
+                 "Dave\nCarol\nBob\nAlice\n");
+    assert_query(graph, PREFIX "SELECT ?n WHERE { ?x ex:name ?n } ORDER BY ?n LIMIT 2 OFFSET 1",
+                 "Bob\nCarol\n");
+    assert_query(graph, PREFIX "SELECT DISTINCT ?c WHERE { ?x ex:city ?c } ORDER BY ?c",
+                 "berlin\nparis\n");
+    assert_query(graph, PREFIX "SELECT ?c WHERE { ?x ex:city ?c } ORDER BY ?c",
+                 "berlin\nberlin\nparis\n");
+    
+    // aggregates
+    assert_query(graph, PREFIX "SELECT ?c (COUNT(*) AS ?n) (SUM(?age) AS ?sum) (MIN(?age) AS ?min) (MAX(?age) AS ?max) "
+                               "WHERE { ?x ex:city ?c ; ex:age ?age } GROUP BY ?c ORDER BY ?c",
+                 "berlin 2 55 25 30\nparis 1 35 35 35\n");
+    assert_query(graph, PREFIX "SELECT (COUNT(DISTINCT ?c) AS ?n) WHERE { ?x ex:city ?c }", "2\n");
+    assert_query(graph, PREFIX "SELECT (COUNT(*) AS ?n) (SUM(?a) AS ?s) WHERE { ?x ex:unknown ?a }", "0 0\n");
+    assert_query(graph, PREFIX "SELECT ?c (COUNT(?y) AS ?n) WHERE { ?x ex:city ?c OPTIONAL { ?x ex:knows ?y } } "
+                               "GROUP BY ?c ORDER BY DESC(?n)",
+                 "berlin 3\nparis 0\n");
+    
+    lz_release(graph);
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_sparql_errors
+
+START_TEST (test_rdf_sparql_errors) {
+    
+    const char * invalid[] = {
+        "SELECT ?x WHERE { ?x ex:p ?y }",
+        "SELECT ?x WHERE { ?x <http://example.com/p> }",
+        "SELECT ?x WHERE { ?x <http://example.com/p> ?y ",
+        "SELECT ?x WHERE { ?x <http://example.com/p> ?y } LIMIT x",
+        "SELECT * WHERE { ?x <http://example.com/p> ?y } GROUP BY ?x",
+        "SELECT ?x (COUNT(*) AS ?n) WHERE { ?x <http://example.com/p> ?y } GROUP BY ?y",
+        "SELECT (COUNT(*) AS ?y) WHERE { ?x <http://example.com/p> ?y }",
+        "SELECT ?x WHERE { ?x <p> ?y }"
+    };
+    
+    for (int k=0; k<8; k++) {
+        __block int error_called = 0;
+        atlas_rdf_query_t query = atlas_rdf_query_create(invalid[k], ^(int err, const char * msg){
+            error_called = 1;
+        });
+        fail_unless(query == 0, invalid[k]);
+        fail_unless(error_called, invalid[k]);
+    }
+    
+    // the line of the error is reported
+    __block char * message = 0;
+    atlas_rdf_query_t query = atlas_rdf_query_create("SELECT ?x\nWHERE {\n ?x ?y }", ^(int err, const char * msg){
+        message = strdup(msg);
+    });
+    fail_unless(query == 0);
+    fail_unless(message != 0 && strstr(message, "line 3") != 0, message);
+    free(message);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark Test the Result Cache
+
+#pragma mark test_rdf_sparql_cache
+
+START_TEST (test_rdf_sparql_cache) {
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    atlas_rdf_query_cache_set_limit(1 << 20);
+    fail_unless(atlas_rdf_query_cache_length() == 0);
+    
+    // the second execution is answered by the cache
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 28) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 1);
+    size_t size = atlas_rdf_query_cache_memory_size();
+    fail_unless(size > 0);
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 28) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 1);
+    
+    // other names of the variables and other whitespace
+    assert_query(graph, PREFIX "SELECT ?s WHERE {?s ex:age ?a FILTER(?a>28)} ORDER BY ?s",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 1);
+    fail_unless(atlas_rdf_query_cache_memory_size() == size);
+    
+    // other constants, created terms and a graph with the same statements
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 28.0) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 2);
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 26) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 3);
+    assert_query(graph, PREFIX "SELECT (SUM(?age) AS ?sum) WHERE { ?x ex:age ?age }",
+                 "90\n");
+    assert_query(graph, PREFIX "SELECT (SUM(?age) AS ?sum) WHERE { ?x ex:age ?age }",
+                 "90\n");
+    fail_unless(atlas_rdf_query_cache_length() == 4);
+    
+    atlas_rdf_graph_t other = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    assert_query(other, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 28) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 5);
+    
+    // the results of a graph are removed with the graph
+    lz_release(other);
+    lz_wait_for_completion();
+    fail_unless(atlas_rdf_query_cache_length() == 4);
+    
+    // the least recently used results are removed
+    atlas_rdf_query_cache_set_limit(size);
+    fail_unless(atlas_rdf_query_cache_length() == 1);
+    fail_unless(atlas_rdf_query_cache_memory_size() <= size);
+    assert_query(graph, PREFIX "SELECT (SUM(?age) AS ?sum) WHERE { ?x ex:age ?age }",
+                 "90\n");
+    
+    atlas_rdf_query_cache_clear();
+    fail_unless(atlas_rdf_query_cache_length() == 0);
+    fail_unless(atlas_rdf_query_cache_memory_size() == 0);
+    
+    // a disabled cache does not keep results
+    atlas_rdf_query_cache_set_limit(0);
+    assert_query(graph, PREFIX "SELECT ?x WHERE { ?x ex:age ?age FILTER (?age > 28) } ORDER BY ?x",
+                 "alice\ncarol\n");
+    fail_unless(atlas_rdf_query_cache_length() == 0);
+    
+    lz_release(graph);
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark SPARQL Suites
+
+Suite * rdf_sparql_suite(void) {
+    Suite *s = suite_create("SPARQL");
+    
+    TCase *tc_query = tcase_create("Select Queries");
+    tcase_add_checked_fixture (tc_query, setup, teardown);
+    tcase_add_test(tc_query, test_rdf_sparql_bgp);
+    tcase_add_test(tc_query, test_rdf_sparql_filter);
+    tcase_add_test(tc_query, test_rdf_sparql_expressions);
+    tcase_add_test(tc_query, test_rdf_sparql_equality);
+    tcase_add_test(tc_query, test_rdf_sparql_modifiers);
+    tcase_add_test(tc_query, test_rdf_sparql_errors);
+    suite_add_tcase(s, tc_query);
+    
+    TCase *tc_cache = tcase_create("Result Cache");
+    tcase_add_checked_fixture (tc_cache, setup, teardown);
+    tcase_add_test(tc_cache, test_rdf_sparql_cache);
+    suite_add_tcase(s, tc_cache);
+    
+    return s;
+}
@@ -0,0 +1,203 @@
+/*
+ *  test_atlas_rdf_temporal_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_temporal_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+#define EX "http://example.com/"
+
+static int
+contains(atlas_rdf_graph_t graph, const char * s, const char * p, const char * o) {
+    atlas_rdf_term_t subject = atlas_rdf_term_create_iri(s, ^(int err, const char * msg){});
+    atlas_rdf_term_t predicate = atlas_rdf_term_create_iri(p, ^(int err, const char * msg){});
+    atlas_rdf_term_t object = atlas_rdf_term_create_iri(o, ^(int err, const char * msg){});
+    int result = atlas_rdf_graph_contains(graph, subject, predicate, object);
+    lz_release(subject);
+    lz_release(predicate);
+    lz_release(object);
+    return result;
+}
+
+#pragma mark -
+#pragma mark Test Temporal RDF Graph
+
+#pragma mark test_rdf_temporal_graph
+
+START_TEST (test_rdf_temporal_graph) {
+    
+    atlas_rdf_term_t a = atlas_rdf_term_create_iri(EX "a", ^(int err, const char * msg){});
+    atlas_rdf_term_t b = atlas_rdf_term_create_iri(EX "b", ^(int err, const char * msg){});
+    atlas_rdf_term_t x = atlas_rdf_term_create_iri(EX "x", ^(int err, const char * msg){});
+    atlas_rdf_term_t y = atlas_rdf_term_create_iri(EX "y", ^(int err, const char * msg){});
+    atlas_rdf_term_t knows = atlas_rdf_term_create_iri(EX "knows", ^(int err, const char * msg){});
+    atlas_rdf_term_t lives = atlas_rdf_term_create_iri(EX "livesIn", ^(int err, const char * msg){});
+    
+    atlas_rdf_temporal_statement_t statements[] = {
+        {a, knows, b, 10, 20},
+        {a, knows, b, 30, ATLAS_RDF_TIME_MAX},
+        {a, lives, x, 0, 15},
+        {a, lives, y, 15, ATLAS_RDF_TIME_MAX},
+        {a, knows, b, 10, 20}
+    };
+    
+    atlas_rdf_temporal_graph_t graph = atlas_rdf_temporal_graph_create(5, statements, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    fail_unless(atlas_rdf_temporal_graph_length(graph) == 4);
+    
+    // state of the graph at a point in time
+    atlas_rdf_graph_t state = atlas_rdf_temporal_graph_at(graph, 12);
+    fail_unless(atlas_rdf_graph_length(state) == 2);
+    fail_unless(contains(state, EX "a", EX "knows", EX "b"));
+    fail_unless(contains(state, EX "a", EX "livesIn", EX "x"));
+    lz_release(state);
+    
+    state = atlas_rdf_temporal_graph_at(graph, 20);
+    fail_unless(atlas_rdf_graph_length(state) == 1);
+    fail_unless(contains(state, EX "a", EX "livesIn", EX "y"));
+    lz_release(state);
+    
+    state = atlas_rdf_temporal_graph_at(graph, -1);
+    fail_unless(atlas_rdf_graph_length(state) == 0);
+    lz_release(state);
+    
+    // statements valid during a period
+    fail_unless(atlas_rdf_temporal_graph_during(graph, 18, 31, 0) == 3);
+    fail_unless(atlas_rdf_temporal_graph_during(graph, 20, 29, 0) == 1);
+    fail_unless(atlas_rdf_temporal_graph_during(graph, 0, 100, 0) == 4);
+    __block int count = 0;
+    fail_unless(atlas_rdf_temporal_graph_during(graph, 14, 14, ^(atlas_rdf_term_t subject,
+                                                                 atlas_rdf_term_t predicate,
+                                                                 atlas_rdf_term_t object,
+                                                                 time_t valid_from,
+                                                                 time_t valid_to){
+        fail_unless(valid_from <= 14 && valid_to > 14);
+        count++;
+    }) == 2);
+    fail_unless(count == 2);
+    
+    // an empty interval
+    atlas_rdf_temporal_statement_t invalid = {a, knows, b, 20, 20};
+    __block int errors = 0;
+    fail_unless(atlas_rdf_temporal_graph_create(1, &invalid, ^(int err, const char * msg){
+        errors++;
+    }) == 0);
+    fail_unless(errors == 1);
+    
+    lz_release(graph);
+    lz_release(a);
+    lz_release(b);
+    lz_release(x);
+    lz_release(y);
+    lz_release(knows);
+    lz_release(lives);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_temporal_graph_random
+
+START_TEST (test_rdf_temporal_graph_random) {
+    
+    atlas_rdf_term_t a = atlas_rdf_term_create_iri(EX "a", ^(int err, const char * msg){});
+    atlas_rdf_term_t p = atlas_rdf_term_create_iri(EX "p", ^(int err, const char * msg){});
+    
+    int num_statements = 2000;
+    atlas_rdf_temporal_statement_t * statements = malloc(sizeof(atlas_rdf_temporal_statement_t) * num_statements);
+    atlas_rdf_term_t * objects = malloc(sizeof(atlas_rdf_term_t) * num_statements);
+    srandom(42);
+    for (int i=0; i<num_statements; i++) {
+        char iri[64];
+        sprintf(iri, EX "o%d", i);
+        objects[i] = atlas_rdf_term_create_iri(iri, ^(int err, const char * msg){});
+        statements[i].subject = a;
+        statements[i].predicate = p;
+        statements[i].object = objects[i];
+        statements[i].valid_from = random() % 10000;
+        statements[i].valid_to = statements[i].valid_from + 1 + random() % 500;
+    }
+    
+    atlas_rdf_temporal_graph_t graph = atlas_rdf_temporal_graph_create(num_statements, statements, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    
+    // compare the index with a scan
+    for (int loop=0; loop<200; loop++) {
+        time_t begin = random() % 11000 - 500;
+        time_t end = begin + random() % 300;
+        int expected = 0;
+        for (int i=0; i<num_statements; i++) {
+            if (statements[i].valid_from <= end && statements[i].valid_to > begin) {
+                expected++;
+            }
+        }
+        fail_unless(atlas_rdf_temporal_graph_during(graph, begin, end, 0) == expected);
+    }
+    
+    lz_release(graph);
+    for (int i=0; i<num_statements; i++) {
+        lz_release(objects[i]);
+    }
+    free(objects);
+    free(statements);
+    lz_release(a);
+    lz_release(p);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark Temporal RDF Graph Suites
+
+Suite * rdf_temporal_suite(void) {
+    Suite *s = suite_create("Temporal RDF Graph");
+    
+    TCase *tc_temporal = tcase_create("Validity Intervals");
+    tcase_add_checked_fixture (tc_temporal, setup, teardown);
+    tcase_add_test(tc_temporal, test_rdf_temporal_graph);
+    tcase_add_test(tc_temporal, test_rdf_temporal_graph_random);
+    
+    suite_add_tcase(s, tc_temporal);
+    
+    return s;
+}
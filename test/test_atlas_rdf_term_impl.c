@@ -26,6 +26,7 @@
 #include <lazy.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include <atlas.h>
 
@@ -624,6 +625,84 @@ START_TEST (test_iri_eq_iri) {
     
 } END_TEST
 
+START_TEST (test_iri_eq_iri_namespaces) {
+    
+    atlas_rdf_term_t term1, term2;
+    
+    // same local name in different namespaces
+    term1 = atlas_rdf_term_create_iri("http://example.com/a#foo", ^(int err, const char * msg){});
+    term2 = atlas_rdf_term_create_iri("http://example.com/b#foo", ^(int err, const char * msg){});
+    fail_if(term1 == 0);
+    fail_if(term2 == 0);
+    if (term1 && term2) {
+        fail_unless(atlas_rdf_term_eq(term1, term2) == 0);
+        lz_release(term1);
+        lz_release(term2);
+    }
+    
+    // same namespace, different local names
+    term1 = atlas_rdf_term_create_iri("http://example.com/a#foo", ^(int err, const char * msg){});
+    term2 = atlas_rdf_term_create_iri("http://example.com/a#fo", ^(int err, const char * msg){});
+    fail_if(term1 == 0);
+    fail_if(term2 == 0);
+    if (term1 && term2) {
+        fail_unless(atlas_rdf_term_eq(term1, term2) == 0);
+        lz_release(term1);
+        lz_release(term2);
+    }
+    
+    // the value and the representation are complete
+    term1 = atlas_rdf_term_create_iri("http://example.com/a#foo", ^(int err, const char * msg){});
+    term2 = atlas_rdf_term_create_iri("http://example.com/a#foo", ^(int err, const char * msg){});
+    fail_if(term1 == 0);
+    fail_if(term2 == 0);
+    if (term1 && term2) {
+        fail_if(atlas_rdf_term_eq(term1, term2) == 0);
+        
+        char * value = atlas_rdf_term_iri_value(term1);
+        fail_unless(strcmp(value, "http://example.com/a#foo") == 0);
+        free(value);
+        
+        char * repr = atlas_rdf_term_repr(term2);
+        fail_unless(strcmp(repr, "<http://example.com/a#foo>") == 0);
+        free(repr);
+        
+        lz_release(term1);
+        lz_release(term2);
+    }
+    
+    // iris with an empty local name or without a namespace
+    term1 = atlas_rdf_term_create_iri("http://example.com/", ^(int err, const char * msg){});
+    term2 = atlas_rdf_term_create_iri("urn:isbn:0451450523", ^(int err, const char * msg){});
+    fail_if(term1 == 0);
+    fail_if(term2 == 0);
+    if (term1 && term2) {
+        char * value = atlas_rdf_term_iri_value(term1);
+        fail_unless(strcmp(value, "http://example.com/") == 0);
+        free(value);
+        
+        value = atlas_rdf_term_iri_value(term2);
+        fail_unless(strcmp(value, "urn:isbn:0451450523") == 0);
+        free(value);
+        
+        lz_release(term1);
+        lz_release(term2);
+    }
+    
+    // the datatypes are recognized by their namespace and local name
+    term1 = atlas_rdf_term_create_iri(INTEGER_DATATYPE_IRI, ^(int err, const char * msg){});
+    term2 = atlas_rdf_term_create_typed("42", term1, ^(int err, const char * msg){});
+    fail_if(term2 == 0);
+    if (term2) {
+        fail_unless(atlas_rdf_term_type(term2) == INTEGER_LITERAL);
+        lz_release(term2);
+    }
+    lz_release(term1);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
 START_TEST (test_blank_node_eq_blank_node) {
     
     atlas_rdf_term_t term1, term2;
@@ -1851,6 +1930,49 @@ START_TEST (test_double_eq_decimal) {
     
 } END_TEST
 
+#pragma mark -
+#pragma mark Effective Boolean Value
+
+START_TEST (test_rdf_term_ebv) {
+    
+    atlas_error_handler err = ^(int e, const char * msg){};
+    mpz_t zero, one;
+    mpz_init_set_ui(zero, 0);
+    mpz_init_set_ui(one, 1);
+    mpf_t f;
+    mpf_init_set_str(f, "0.5", 10);
+    
+    atlas_rdf_term_t terms[] = {
+        atlas_rdf_term_create_boolean(1, err),
+        atlas_rdf_term_create_boolean(0, err),
+        atlas_rdf_term_create_string("abc", 0, err),
+        atlas_rdf_term_create_string("", 0, err),
+        atlas_rdf_term_create_string("abc", "en", err),
+        atlas_rdf_term_create_integer(one, err),
+        atlas_rdf_term_create_integer(zero, err),
+        atlas_rdf_term_create_double(2.5, err),
+        atlas_rdf_term_create_double(0, err),
+        atlas_rdf_term_create_double(NAN, err),
+        atlas_rdf_term_create_decimal(f, err),
+        atlas_rdf_term_create_iri("http://example.com/a", err),
+        atlas_rdf_term_create_blank_node("a", err),
+        atlas_rdf_term_create_datetime(0, err)
+    };
+    int expected[] = {1, 0, 1, 0, 1, 1, 0, 1, 0, 0, 1, -1, -1, -1};
+    
+    for (int i=0; i<14; i++) {
+        fail_if(terms[i] == 0);
+        fail_unless(atlas_rdf_term_ebv(terms[i]) == expected[i]);
+        lz_release(terms[i]);
+    }
+    
+    mpz_clear(zero);
+    mpz_clear(one);
+    mpf_clear(f);
+    lz_wait_for_completion();
+    
+} END_TEST
+
 #pragma mark -
 #pragma mark Fixtures
 
@@ -1889,6 +2011,7 @@ Suite * rdf_term_suite(void) {
     tcase_add_checked_fixture (tc_eq, setup, teardown);
     
     tcase_add_test(tc_eq, test_iri_eq_iri);
+    tcase_add_test(tc_eq, test_iri_eq_iri_namespaces);
 	tcase_add_test(tc_eq, test_blank_node_eq_blank_node);
     tcase_add_test(tc_eq, test_str_eq_str);
 	tcase_add_test(tc_eq, test_typed_literal_eq_typed_literal);
@@ -1944,5 +2067,10 @@ Suite * rdf_term_suite(void) {
 
     suite_add_tcase(s, tc_eq);
     
+    TCase *tc_ebv = tcase_create("Effective Boolean Value");
+    tcase_add_checked_fixture (tc_ebv, setup, teardown);
+    tcase_add_test(tc_ebv, test_rdf_term_ebv);
+    suite_add_tcase(s, tc_ebv);
+    
     return s;
 }
@@ -688,6 +688,281 @@ START_TEST (test_create_rdf_term_set_difference_identical) {
     
 } END_TEST
 
+#pragma mark test_create_rdf_term_set_union_n
+
+START_TEST (test_create_rdf_term_set_union_n) {
+    
+    // terms contained in the sets
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * 4);
+    assert(terms);
+    terms[0] = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    terms[1] = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    terms[2] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    terms[3] = atlas_rdf_term_create_string("Hallo Atlas!", "de-de", ^(int err, const char * msg){});
+    
+    // create three overlapping sets: {0, 1}, {1, 2} and {2, 3, 0}
+    atlas_rdf_term_t terms_set3[3] = { terms[2], terms[3], terms[0] };
+    atlas_rdf_term_set_t sets[3];
+    sets[0] = atlas_rdf_term_set_create(2, terms, ^(int err, const char * msg){});
+    sets[1] = atlas_rdf_term_set_create(2, terms + 1, ^(int err, const char * msg){});
+    sets[2] = atlas_rdf_term_set_create(3, terms_set3, ^(int err, const char * msg){});
+    fail_if(sets[0] == 0);
+    fail_if(sets[1] == 0);
+    fail_if(sets[2] == 0);
+    
+    if (sets[0] && sets[1] && sets[2]) {
+        
+        // union of all sets
+        atlas_rdf_term_set_t set = atlas_rdf_term_set_create_union_n(3, sets, ^(int err, const char * msg){});
+        fail_if(set == 0);
+        
+        if (set) {
+            fail_unless(atlas_rdf_term_set_length(set) == 4);
+            
+            // each term should be once in the union
+            int * check = calloc(sizeof(int), 4);
+            assert(check);
+            atlas_rdf_term_set_apply_seq(set, ^(atlas_rdf_term_t term){
+                for (int i=0; i<4; i++) {
+                    if (atlas_rdf_term_eq(terms[i], term)) {
+                        check[i]++;
+                    }
+                }
+            });
+            
+            fail_unless(check[0] == 1);
+            fail_unless(check[1] == 1);
+            fail_unless(check[2] == 1);
+            fail_unless(check[3] == 1);
+            
+            free(check);
+            lz_release(set);
+        }
+        
+        // the union of a single set is the set itself
+        set = atlas_rdf_term_set_create_union_n(1, sets, ^(int err, const char * msg){});
+        fail_unless(lz_obj_same(set, sets[0]));
+        lz_release(set);
+        
+        lz_release(sets[0]);
+        lz_release(sets[1]);
+        lz_release(sets[2]);
+    }
+    
+    for (int i=0; i<4; i++) {
+        lz_release(terms[i]);
+    }
+    free(terms);
+    
+    lz_wait_for_completion();
+} END_TEST
+
+#pragma mark test_create_rdf_term_set_intersection_n
+
+START_TEST (test_create_rdf_term_set_intersection_n) {
+    
+    // terms contained in the sets
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * 4);
+    assert(terms);
+    terms[0] = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    terms[1] = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    terms[2] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    terms[3] = atlas_rdf_term_create_string("Hallo Atlas!", "de-de", ^(int err, const char * msg){});
+    
+    // create three overlapping sets: {0, 1, 2, 3}, {1, 2, 3} and {2, 1}
+    atlas_rdf_term_t terms_set3[2] = { terms[2], terms[1] };
+    atlas_rdf_term_set_t sets[3];
+    sets[0] = atlas_rdf_term_set_create(4, terms, ^(int err, const char * msg){});
+    sets[1] = atlas_rdf_term_set_create(3, terms + 1, ^(int err, const char * msg){});
+    sets[2] = atlas_rdf_term_set_create(2, terms_set3, ^(int err, const char * msg){});
+    fail_if(sets[0] == 0);
+    fail_if(sets[1] == 0);
+    fail_if(sets[2] == 0);
+    
+    if (sets[0] && sets[1] && sets[2]) {
+        
+        // intersection of all sets
+        atlas_rdf_term_set_t set = atlas_rdf_term_set_create_intersection_n(3, sets, ^(int err, const char * msg){});
+        fail_if(set == 0);
+        
+        if (set) {
+            fail_unless(atlas_rdf_term_set_length(set) == 2);
+            
+            // only the terms 1 and 2 should be in the intersection
+            int * check = calloc(sizeof(int), 4);
+            assert(check);
+            atlas_rdf_term_set_apply_seq(set, ^(atlas_rdf_term_t term){
+                for (int i=0; i<4; i++) {
+                    if (atlas_rdf_term_eq(terms[i], term)) {
+                        check[i]++;
+                    }
+                }
+            });
+            
+            fail_unless(check[0] == 0);
+            fail_unless(check[1] == 1);
+            fail_unless(check[2] == 1);
+            fail_unless(check[3] == 0);
+            
+            free(check);
+            lz_release(set);
+        }
+        
+        lz_release(sets[0]);
+        lz_release(sets[1]);
+        lz_release(sets[2]);
+    }
+    
+    for (int i=0; i<4; i++) {
+        lz_release(terms[i]);
+    }
+    free(terms);
+    
+    lz_wait_for_completion();
+} END_TEST
+
+START_TEST (test_create_rdf_term_set_intersection_n_disjoint) {
+    
+    // terms contained in the sets
+    atlas_rdf_term_t terms[3];
+    terms[0] = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    terms[1] = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    terms[2] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    // create the sets {0, 1}, {2} and {0, 1, 2}, where the
+    // first two sets are disjoint
+    atlas_rdf_term_set_t sets[3];
+    sets[0] = atlas_rdf_term_set_create(2, terms, ^(int err, const char * msg){});
+    sets[1] = atlas_rdf_term_set_create(1, terms + 2, ^(int err, const char * msg){});
+    sets[2] = atlas_rdf_term_set_create(3, terms, ^(int err, const char * msg){});
+    fail_if(sets[0] == 0);
+    fail_if(sets[1] == 0);
+    fail_if(sets[2] == 0);
+    
+    if (sets[0] && sets[1] && sets[2]) {
+        
+        // intersection of all sets
+        atlas_rdf_term_set_t set = atlas_rdf_term_set_create_intersection_n(3, sets, ^(int err, const char * msg){});
+        fail_if(set == 0);
+        
+        if (set) {
+            fail_unless(atlas_rdf_term_set_length(set) == 0);
+            lz_release(set);
+        }
+        
+        lz_release(sets[0]);
+        lz_release(sets[1]);
+        lz_release(sets[2]);
+    }
+    
+    for (int i=0; i<3; i++) {
+        lz_release(terms[i]);
+    }
+    
+    lz_wait_for_completion();
+} END_TEST
+
+#pragma mark -
+#pragma mark Test Access RDF Term Set
+
+#pragma mark test_rdf_term_set_apply_chunked
+
+START_TEST (test_rdf_term_set_apply_chunked) {
+    
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * 5);
+    assert(terms);
+    terms[0] = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    terms[1] = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    terms[2] = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    terms[3] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    terms[4] = atlas_rdf_term_create_string("Hallo Atlas!", "de-de", ^(int err, const char * msg){});
+    
+    atlas_rdf_term_set_t set = atlas_rdf_term_set_create(5, terms, ^(int err, const char * msg){});
+    fail_if(set == 0);
+    if (set) {
+        
+        // count the IRIs in the set with different grain sizes,
+        // each worker counts in its own state and the states are
+        // summed up sequentially
+        for (int grain_size=0; grain_size<7; grain_size++) {
+            __block int num_states = 0;
+            __block int num_iris = 0;
+            atlas_rdf_term_set_apply_chunked(set, grain_size, ^{
+                return (void *)calloc(1, sizeof(int));
+            }, ^(void * state, atlas_rdf_term_t term){
+                if (atlas_rdf_term_type(term) == IRI) {
+                    (*(int *)state)++;
+                }
+            }, ^(void * state){
+                num_states++;
+                num_iris += *(int *)state;
+                free(state);
+            });
+            
+            fail_unless(num_states >= 1);
+            fail_unless(num_iris == 2);
+        }
+        
+        // without states
+        __block int num_iris = 0;
+        atlas_rdf_term_set_apply_chunked(set, 1, 0, ^(void * state, atlas_rdf_term_t term){
+            fail_unless(state == 0);
+            if (atlas_rdf_term_type(term) == IRI) {
+                __sync_fetch_and_add(&num_iris, 1);
+            }
+        }, 0);
+        fail_unless(num_iris == 2);
+        
+        lz_release(set);
+    }
+    
+    for (int i=0; i<5; i++) {
+        lz_release(terms[i]);
+    }
+    free(terms);
+    
+    lz_wait_for_completion();
+} END_TEST
+
+#pragma mark test_rdf_term_set_reduce
+
+START_TEST (test_rdf_term_set_reduce) {
+    
+    atlas_rdf_term_t * terms = malloc(sizeof(atlas_rdf_term_t) * 4);
+    assert(terms);
+    terms[0] = atlas_rdf_term_create_blank_node("foo", ^(int err, const char * msg){});
+    terms[1] = atlas_rdf_term_create_iri("http://example.com/bar", ^(int err, const char * msg){});
+    terms[2] = atlas_rdf_term_create_iri("http://example.com/baz", ^(int err, const char * msg){});
+    terms[3] = atlas_rdf_term_create_boolean(1, ^(int err, const char * msg){});
+    
+    atlas_rdf_term_set_t set = atlas_rdf_term_set_create(4, terms, ^(int err, const char * msg){});
+    fail_if(set == 0);
+    if (set) {
+        
+        // count the IRIs in the set
+        intptr_t num_iris = (intptr_t)atlas_rdf_term_set_reduce(set, ^{
+            return (void *)0;
+        }, ^(void * acc, atlas_rdf_term_t term){
+            if (atlas_rdf_term_type(term) == IRI) {
+                return (void *)((intptr_t)acc + 1);
+            }
+            return acc;
+        }, ^(void * acc1, void * acc2){
+            return (void *)((intptr_t)acc1 + (intptr_t)acc2);
+        });
+        fail_unless(num_iris == 2);
+        
+        lz_release(set);
+    }
+    
+    for (int i=0; i<4; i++) {
+        lz_release(terms[i]);
+    }
+    free(terms);
+    
+    lz_wait_for_completion();
+} END_TEST
+
 #pragma mark -
 #pragma mark Fixtures
 
@@ -717,8 +992,17 @@ Suite * rdf_term_set_suite(void) {
     tcase_add_test(tc_create, test_create_rdf_term_set_difference_disjoint);
 	tcase_add_test(tc_create, test_create_rdf_term_set_difference_identical);
     tcase_add_test(tc_create, test_create_rdf_term_set_difference_overlapping);
+    tcase_add_test(tc_create, test_create_rdf_term_set_union_n);
+    tcase_add_test(tc_create, test_create_rdf_term_set_intersection_n);
+    tcase_add_test(tc_create, test_create_rdf_term_set_intersection_n_disjoint);
+    
+    TCase *tc_access = tcase_create("Access");
+    tcase_add_checked_fixture (tc_access, setup, teardown);
+    tcase_add_test(tc_access, test_rdf_term_set_apply_chunked);
+    tcase_add_test(tc_access, test_rdf_term_set_reduce);
     
     suite_add_tcase(s, tc_create);
+    suite_add_tcase(s, tc_access);
     
     return s;
 }
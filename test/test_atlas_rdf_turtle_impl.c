@@ -0,0 +1,268 @@
+/*
+ *  test_atlas_rdf_turtle_impl.c
+ *  atlas
+ *
+ *  This file is part of atlas.
+ *	
+ *  atlas is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *	
+ *  atlas is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with atlas.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_atlas_rdf_turtle_impl.h"
+
+#include <lazy.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <dispatch/dispatch.h>
+
+#include <atlas.h>
+
+
+#pragma mark -
+#pragma mark Test Parse Turtle
+
+#pragma mark test_rdf_turtle_parse
+
+START_TEST (test_rdf_turtle_parse) {
+    
+    const char * turtle =
+        "@prefix ex: <http://example.com/> .\n"
+        "@prefix xsd: <http://www.w3.org/2001/XMLSchema#> .\n"
+        "PREFIX : <http://example.com/default#>\n"
+        "@base <http://example.com/base/> .\n"
+        "\n"
+        "# predicate and object lists\n"
+        "ex:a ex:p ex:b, <c>, :d ;\n"
+        "     a ex:Class ;\n"
+        "     ex:q \"foo\"@en, 'bar', \"\"\"multi\n"
+        "line\"\"\", \"x\"^^xsd:string, \"y\"^^ex:type ; .\n"
+        "\n"
+        "# numeric and boolean literals\n"
+        "ex:a ex:n 42, -7, 1.5, 2e3, true, false .\n"
+        "\n"
+        "# blank nodes\n"
+        "_:x ex:p [ ex:q ex:r ; ex:s [] ] .\n"
+        "[ ex:p ex:o ] .\n"
+        "\n"
+        "# collections\n"
+        "ex:a ex:list ( 1 ex:b ) .\n"
+        "ex:a ex:empty () .\n";
+    
+    const char * ntriples =
+        "<http://example.com/a> <http://example.com/p> <http://example.com/b> .\n"
+        "<http://example.com/a> <http://example.com/p> <http://example.com/base/c> .\n"
+        "<http://example.com/a> <http://example.com/p> <http://example.com/default#d> .\n"
+        "<http://example.com/a> <http://www.w3.org/1999/02/22-rdf-syntax-ns#type> <http://example.com/Class> .\n"
+        "<http://example.com/a> <http://example.com/q> \"foo\"@en .\n"
+        "<http://example.com/a> <http://example.com/q> \"bar\" .\n"
+        "<http://example.com/a> <http://example.com/q> \"multi\\nline\" .\n"
+        "<http://example.com/a> <http://example.com/q> \"x\" .\n"
+        "<http://example.com/a> <http://example.com/q> \"y\"^^<http://example.com/type> .\n"
+        "<http://example.com/a> <http://example.com/n> \"42\"^^<http://www.w3.org/2001/XMLSchema#integer> .\n"
+        "<http://example.com/a> <http://example.com/n> \"-7\"^^<http://www.w3.org/2001/XMLSchema#integer> .\n"
+        "<http://example.com/a> <http://example.com/n> \"1.5\"^^<http://www.w3.org/2001/XMLSchema#decimal> .\n"
+        "<http://example.com/a> <http://example.com/n> \"2e3\"^^<http://www.w3.org/2001/XMLSchema#double> .\n"
+        "<http://example.com/a> <http://example.com/n> \"1\"^^<http://www.w3.org/2001/XMLSchema#boolean> .\n"
+        "<http://example.com/a> <http://example.com/n> \"0\"^^<http://www.w3.org/2001/XMLSchema#boolean> .\n"
+        "_:x <http://example.com/p> _:genid1 .\n"
+        "_:genid1 <http://example.com/q> <http://example.com/r> .\n"
+        "_:genid1 <http://example.com/s> _:genid2 .\n"
+        "_:genid3 <http://example.com/p> <http://example.com/o> .\n"
+        "<http://example.com/a> <http://example.com/list> _:genid4 .\n"
+        "_:genid4 <http://www.w3.org/1999/02/22-rdf-syntax-ns#first> \"1\"^^<http://www.w3.org/2001/XMLSchema#integer> .\n"
+        "_:genid4 <http://www.w3.org/1999/02/22-rdf-syntax-ns#rest> _:genid5 .\n"
+        "_:genid5 <http://www.w3.org/1999/02/22-rdf-syntax-ns#first> <http://example.com/b> .\n"
+        "_:genid5 <http://www.w3.org/1999/02/22-rdf-syntax-ns#rest> <http://www.w3.org/1999/02/22-rdf-syntax-ns#nil> .\n"
+        "<http://example.com/a> <http://example.com/empty> <http://www.w3.org/1999/02/22-rdf-syntax-ns#nil> .\n";
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    atlas_rdf_graph_t expected = atlas_rdf_graph_create_from_ntriples(ntriples, strlen(ntriples), ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(expected == 0);
+    
+    fail_unless(atlas_rdf_graph_length(graph) == 25);
+    
+    atlas_rdf_graph_t diff1 = atlas_rdf_graph_create_difference(graph, expected, ^(int err, const char * msg){});
+    atlas_rdf_graph_t diff2 = atlas_rdf_graph_create_difference(expected, graph, ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_length(diff1) == 0);
+    fail_unless(atlas_rdf_graph_length(diff2) == 0);
+    lz_release(diff1);
+    lz_release(diff2);
+    
+    // the numbers are represented by the literal types
+    __block int num_integers = 0;
+    __block int num_doubles = 0;
+    atlas_rdf_graph_apply_chunked(graph, 1, 0, ^(void * state,
+                                                 atlas_rdf_term_t subject,
+                                                 atlas_rdf_term_t predicate,
+                                                 atlas_rdf_term_t object){
+        if (atlas_rdf_term_type(object) == INTEGER_LITERAL) {
+            __sync_fetch_and_add(&num_integers, 1);
+        }
+        if (atlas_rdf_term_type(object) == DOUBLE_LITERAL) {
+            __sync_fetch_and_add(&num_doubles, 1);
+        }
+    }, 0);
+    fail_unless(num_integers == 3);
+    fail_unless(num_doubles == 1);
+    
+    lz_release(expected);
+    lz_release(graph);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_turtle_blank_node_labels
+
+START_TEST (test_rdf_turtle_blank_node_labels) {
+    
+    // a label starting with "genid" does not clash with a generated label
+    const char * turtle =
+        "@prefix ex: <http://example.com/> .\n"
+        "_:genid1 ex:p [] .\n";
+    
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    
+    atlas_rdf_term_t s = atlas_rdf_term_create_blank_node("genid-genid1", ^(int err, const char * msg){});
+    atlas_rdf_term_t p = atlas_rdf_term_create_iri("http://example.com/p", ^(int err, const char * msg){});
+    atlas_rdf_term_t o = atlas_rdf_term_create_blank_node("genid1", ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_contains(graph, s, p, o));
+    lz_release(s);
+    lz_release(p);
+    lz_release(o);
+    
+    lz_release(graph);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_turtle_invalid
+
+START_TEST (test_rdf_turtle_invalid) {
+    
+    const char * invalid[] = {
+        "<http://example.com/a> <http://example.com/p> <http://example.com/b>",
+        "ex:a <http://example.com/p> <http://example.com/b> .",
+        "<a> <http://example.com/p> <http://example.com/b> .",
+        "<http://example.com/a> <http://example.com/p> [ .",
+        "<http://example.com/a> <http://example.com/p> ( 1 2 .",
+        "<http://example.com/a> <http://example.com/p> \"foo .",
+        "<http://example.com/a> \"p\" <http://example.com/b> .",
+        "@foo <http://example.com/> ."
+    };
+    
+    for (int k=0; k<8; k++) {
+        __block int error_called = 0;
+        atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(invalid[k], strlen(invalid[k]), 0, ^(int err, const char * msg){
+            error_called = 1;
+        });
+        fail_unless(graph == 0, invalid[k]);
+        fail_unless(error_called, invalid[k]);
+    }
+    
+    // the line of the error is reported
+    const char * turtle =
+        "@prefix ex: <http://example.com/> .\n"
+        "ex:a ex:p \"\"\"foo\n"
+        "bar\"\"\" .\n"
+        "ex:a ex:p ex:b ex:c .\n";
+    __block int error_called = 0;
+    atlas_rdf_graph_t graph = atlas_rdf_graph_create_from_turtle(turtle, strlen(turtle), 0, ^(int err, const char * msg){
+        fail_unless(strncmp(msg, "Syntax error in line 4:", 23) == 0, msg);
+        error_called = 1;
+    });
+    fail_unless(graph == 0);
+    fail_unless(error_called);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark test_rdf_turtle_file
+
+START_TEST (test_rdf_turtle_file) {
+    
+    char path[] = "/tmp/atlas_test_turtle_XXXXXX";
+    int fd = mkstemp(path);
+    fail_if(fd < 0);
+    const char * text = "<a> <b> <c> .\n";
+    write(fd, text, strlen(text));
+    close(fd);
+    
+    // relative IRIs are resolved against the file
+    atlas_rdf_graph_t graph = atlas_rdf_graph_open_turtle(path, 0, ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    fail_if(graph == 0);
+    fail_unless(atlas_rdf_graph_length(graph) == 1);
+    lz_release(graph);
+    
+    graph = atlas_rdf_graph_open_turtle(path, "http://example.com/", ^(int err, const char * msg){
+        fail_if(1, msg);
+    });
+    atlas_rdf_term_t s = atlas_rdf_term_create_iri("http://example.com/a", ^(int err, const char * msg){});
+    atlas_rdf_term_t p = atlas_rdf_term_create_iri("http://example.com/b", ^(int err, const char * msg){});
+    atlas_rdf_term_t o = atlas_rdf_term_create_iri("http://example.com/c", ^(int err, const char * msg){});
+    fail_unless(atlas_rdf_graph_contains(graph, s, p, o));
+    lz_release(s);
+    lz_release(p);
+    lz_release(o);
+    lz_release(graph);
+    
+    unlink(path);
+    
+    lz_wait_for_completion();
+    
+} END_TEST
+
+#pragma mark -
+#pragma mark Fixtures
+
+static void setup() {
+    //printf(">>>\n");
+}
+
+static void teardown() {
+    //printf("<<<\n");
+}
+
+#pragma mark -
+#pragma mark RDF Turtle Suites
+
+Suite * rdf_turtle_suite(void) {
+    Suite *s = suite_create("RDF Turtle");
+    
+    TCase *tc_parse = tcase_create("Parse");
+    tcase_add_checked_fixture (tc_parse, setup, teardown);
+    tcase_add_test(tc_parse, test_rdf_turtle_parse);
+    tcase_add_test(tc_parse, test_rdf_turtle_blank_node_labels);
+    tcase_add_test(tc_parse, test_rdf_turtle_invalid);
+    tcase_add_test(tc_parse, test_rdf_turtle_file);
+    
+    suite_add_tcase(s, tc_parse);
+    
+    return s;
+}